@@ -0,0 +1,291 @@
+#include "Engine/Core/AtlasPacker.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/EngineCommon.h"
+#include <algorithm>
+#include <climits>
+// -----------------------------------------------------------------------------
+static bool IsRectInsideRect(AtlasRect const& inner, AtlasRect const& outer)
+{
+	return inner.m_mins.x >= outer.m_mins.x && inner.m_mins.y >= outer.m_mins.y
+		&& inner.m_mins.x + inner.m_dims.x <= outer.m_mins.x + outer.m_dims.x
+		&& inner.m_mins.y + inner.m_dims.y <= outer.m_mins.y + outer.m_dims.y;
+}
+// -----------------------------------------------------------------------------
+static bool DoRectsOverlap(AtlasRect const& rectA, AtlasRect const& rectB)
+{
+	return rectA.m_mins.x < rectB.m_mins.x + rectB.m_dims.x && rectB.m_mins.x < rectA.m_mins.x + rectA.m_dims.x
+		&& rectA.m_mins.y < rectB.m_mins.y + rectB.m_dims.y && rectB.m_mins.y < rectA.m_mins.y + rectA.m_dims.y;
+}
+// -----------------------------------------------------------------------------
+void AtlasRegion::GetCornerUVs(Vec2& out_bottomLeft, Vec2& out_bottomRight, Vec2& out_topRight, Vec2& out_topLeft) const
+{
+	Vec2 const& mins = m_uvs.m_mins;
+	Vec2 const& maxs = m_uvs.m_maxs;
+	if (!m_isRotated)
+	{
+		out_bottomLeft = mins;
+		out_bottomRight = Vec2(maxs.x, mins.y);
+		out_topRight = maxs;
+		out_topLeft = Vec2(mins.x, maxs.y);
+		return;
+	}
+
+	out_bottomLeft = Vec2(maxs.x, mins.y);
+	out_bottomRight = maxs;
+	out_topRight = Vec2(mins.x, maxs.y);
+	out_topLeft = mins;
+}
+// -----------------------------------------------------------------------------
+AtlasPacker::AtlasPacker(AtlasPackerSettings const& settings)
+	:m_settings(settings)
+	,m_atlasImage(settings.m_atlasDimensions, Rgba8(0, 0, 0, 0))
+{
+	GUARANTEE_OR_DIE(settings.m_atlasDimensions.x > 0 && settings.m_atlasDimensions.y > 0, "Atlas dimensions must be positive");
+	GUARANTEE_OR_DIE(settings.m_padding >= 0, "Atlas padding cannot be negative");
+
+	AtlasRect wholeAtlas;
+	wholeAtlas.m_dims = settings.m_atlasDimensions;
+	m_freeRects.push_back(wholeAtlas);
+}
+
+AtlasRegion AtlasPacker::InsertImage(Image const& image)
+{
+	AtlasRegion region;
+	IntVec2 imageDimensions = image.GetDimensions();
+	if (imageDimensions.x <= 0 || imageDimensions.y <= 0)
+	{
+		return region;
+	}
+
+	IntVec2 paddedDims(imageDimensions.x + 2 * m_settings.m_padding, imageDimensions.y + 2 * m_settings.m_padding);
+	AtlasRect usedRect;
+	bool isRotated = false;
+	if (!FindFreeRect(paddedDims, usedRect, isRotated))
+	{
+		return region;
+	}
+	PlaceRect(usedRect);
+	m_usedTexelCount += static_cast<long long>(usedRect.m_dims.x) * usedRect.m_dims.y;
+
+	region.m_isPacked = true;
+	region.m_isRotated = isRotated;
+	region.m_texelMins = IntVec2(usedRect.m_mins.x + m_settings.m_padding, usedRect.m_mins.y + m_settings.m_padding);
+	region.m_texelDims = isRotated ? IntVec2(imageDimensions.y, imageDimensions.x) : imageDimensions;
+
+	// Same inward nudge as SpriteSheet so sampling right at the edge stays inside the region
+	float atlasWidth = static_cast<float>(m_settings.m_atlasDimensions.x);
+	float atlasHeight = static_cast<float>(m_settings.m_atlasDimensions.y);
+	float uNudge = 1.f / (atlasWidth * 128.f);
+	float vNudge = 1.f / (atlasHeight * 128.f);
+	region.m_uvs.m_mins = Vec2(static_cast<float>(region.m_texelMins.x) / atlasWidth + uNudge, static_cast<float>(region.m_texelMins.y) / atlasHeight + vNudge);
+	region.m_uvs.m_maxs = Vec2(static_cast<float>(region.m_texelMins.x + region.m_texelDims.x) / atlasWidth - uNudge, static_cast<float>(region.m_texelMins.y + region.m_texelDims.y) / atlasHeight - vNudge);
+
+	CopyImageIntoAtlas(image, region);
+	return region;
+}
+
+bool AtlasPacker::InsertImages(std::vector<Image> const& images, std::vector<AtlasRegion>& out_regions)
+{
+	int numImages = static_cast<int>(images.size());
+	out_regions.clear();
+	out_regions.resize(numImages);
+
+	// Largest first, by longer side and then area, leaves the small images to fill the gaps
+	std::vector<int> insertionOrder(numImages);
+	for (int imageIndex = 0; imageIndex < numImages; ++imageIndex)
+	{
+		insertionOrder[imageIndex] = imageIndex;
+	}
+	std::stable_sort(insertionOrder.begin(), insertionOrder.end(), [&images](int indexA, int indexB)
+	{
+		IntVec2 dimsA = images[indexA].GetDimensions();
+		IntVec2 dimsB = images[indexB].GetDimensions();
+		int longSideA = std::max(dimsA.x, dimsA.y);
+		int longSideB = std::max(dimsB.x, dimsB.y);
+		if (longSideA != longSideB)
+		{
+			return longSideA > longSideB;
+		}
+		return dimsA.x * dimsA.y > dimsB.x * dimsB.y;
+	});
+
+	bool didPackAll = true;
+	for (int orderIndex = 0; orderIndex < numImages; ++orderIndex)
+	{
+		int imageIndex = insertionOrder[orderIndex];
+		out_regions[imageIndex] = InsertImage(images[imageIndex]);
+		didPackAll = didPackAll && out_regions[imageIndex].m_isPacked;
+	}
+	return didPackAll;
+}
+
+Image const& AtlasPacker::GetAtlasImage() const
+{
+	return m_atlasImage;
+}
+
+float AtlasPacker::GetOccupancy() const
+{
+	long long totalTexelCount = static_cast<long long>(m_settings.m_atlasDimensions.x) * m_settings.m_atlasDimensions.y;
+	return static_cast<float>(static_cast<double>(m_usedTexelCount) / static_cast<double>(totalTexelCount));
+}
+
+bool AtlasPacker::FindFreeRect(IntVec2 const& paddedDims, AtlasRect& out_rect, bool& out_isRotated) const
+{
+	int bestShortSideFit = INT_MAX;
+	int bestLongSideFit = INT_MAX;
+	bool didFind = false;
+
+	int numOrientations = (m_settings.m_allowRotation && paddedDims.x != paddedDims.y) ? 2 : 1;
+	for (int orientation = 0; orientation < numOrientations; ++orientation)
+	{
+		bool isRotated = orientation == 1;
+		IntVec2 dims = isRotated ? IntVec2(paddedDims.y, paddedDims.x) : paddedDims;
+
+		for (int freeIndex = 0; freeIndex < static_cast<int>(m_freeRects.size()); ++freeIndex)
+		{
+			AtlasRect const& freeRect = m_freeRects[freeIndex];
+			if (dims.x > freeRect.m_dims.x || dims.y > freeRect.m_dims.y)
+			{
+				continue;
+			}
+
+			int leftoverX = freeRect.m_dims.x - dims.x;
+			int leftoverY = freeRect.m_dims.y - dims.y;
+			int shortSideFit = std::min(leftoverX, leftoverY);
+			int longSideFit = std::max(leftoverX, leftoverY);
+			if (shortSideFit < bestShortSideFit || (shortSideFit == bestShortSideFit && longSideFit < bestLongSideFit))
+			{
+				bestShortSideFit = shortSideFit;
+				bestLongSideFit = longSideFit;
+				out_rect.m_mins = freeRect.m_mins;
+				out_rect.m_dims = dims;
+				out_isRotated = isRotated;
+				didFind = true;
+			}
+		}
+	}
+	return didFind;
+}
+
+void AtlasPacker::PlaceRect(AtlasRect const& usedRect)
+{
+	// Every free rect the new one overlaps is replaced by up to four maximal rects around it
+	std::vector<AtlasRect> splitRects;
+	for (int freeIndex = 0; freeIndex < static_cast<int>(m_freeRects.size());)
+	{
+		AtlasRect freeRect = m_freeRects[freeIndex];
+		if (!DoRectsOverlap(freeRect, usedRect))
+		{
+			++freeIndex;
+			continue;
+		}
+
+		int freeMaxX = freeRect.m_mins.x + freeRect.m_dims.x;
+		int freeMaxY = freeRect.m_mins.y + freeRect.m_dims.y;
+		int usedMaxX = usedRect.m_mins.x + usedRect.m_dims.x;
+		int usedMaxY = usedRect.m_mins.y + usedRect.m_dims.y;
+
+		if (usedRect.m_mins.x > freeRect.m_mins.x)
+		{
+			AtlasRect leftRect = freeRect;
+			leftRect.m_dims.x = usedRect.m_mins.x - freeRect.m_mins.x;
+			splitRects.push_back(leftRect);
+		}
+		if (usedMaxX < freeMaxX)
+		{
+			AtlasRect rightRect = freeRect;
+			rightRect.m_mins.x = usedMaxX;
+			rightRect.m_dims.x = freeMaxX - usedMaxX;
+			splitRects.push_back(rightRect);
+		}
+		if (usedRect.m_mins.y > freeRect.m_mins.y)
+		{
+			AtlasRect bottomRect = freeRect;
+			bottomRect.m_dims.y = usedRect.m_mins.y - freeRect.m_mins.y;
+			splitRects.push_back(bottomRect);
+		}
+		if (usedMaxY < freeMaxY)
+		{
+			AtlasRect topRect = freeRect;
+			topRect.m_mins.y = usedMaxY;
+			topRect.m_dims.y = freeMaxY - usedMaxY;
+			splitRects.push_back(topRect);
+		}
+
+		m_freeRects[freeIndex] = m_freeRects.back();
+		m_freeRects.pop_back();
+	}
+
+	// Only the new rects can be redundant, the untouched free rects were already maximal against each other
+	for (int splitIndex = 0; splitIndex < static_cast<int>(splitRects.size()); ++splitIndex)
+	{
+		AtlasRect const& splitRect = splitRects[splitIndex];
+		bool isContained = false;
+		for (int otherIndex = 0; otherIndex < static_cast<int>(splitRects.size()) && !isContained; ++otherIndex)
+		{
+			if (otherIndex == splitIndex || !IsRectInsideRect(splitRect, splitRects[otherIndex]))
+			{
+				continue;
+			}
+			// Identical rects keep the first copy only
+			bool isIdentical = IsRectInsideRect(splitRects[otherIndex], splitRect);
+			isContained = !isIdentical || otherIndex < splitIndex;
+		}
+		for (int freeIndex = 0; freeIndex < static_cast<int>(m_freeRects.size()) && !isContained; ++freeIndex)
+		{
+			isContained = IsRectInsideRect(splitRect, m_freeRects[freeIndex]);
+		}
+		if (!isContained)
+		{
+			m_freeRects.push_back(splitRect);
+		}
+	}
+}
+
+void AtlasPacker::CopyImageIntoAtlas(Image const& image, AtlasRegion const& region)
+{
+	IntVec2 imageDimensions = image.GetDimensions();
+	if (!region.m_isRotated)
+	{
+		m_atlasImage.CopyTexelsFrom(image, region.m_texelMins);
+	}
+	else
+	{
+		// Turned counterclockwise, image texel (x, y) lands at region texel (height - 1 - y, x)
+		for (int texelY = 0; texelY < imageDimensions.y; ++texelY)
+		{
+			for (int texelX = 0; texelX < imageDimensions.x; ++texelX)
+			{
+				IntVec2 atlasCoords(region.m_texelMins.x + imageDimensions.y - 1 - texelY, region.m_texelMins.y + texelX);
+				m_atlasImage.SetTexelColor(atlasCoords, image.GetTexelColor(texelX, texelY));
+			}
+		}
+	}
+
+	int padding = m_settings.m_padding;
+	if (!m_settings.m_extrudeEdges || padding == 0)
+	{
+		return;
+	}
+
+	// Clamp every texel of the padding ring onto the nearest stored texel, corners included
+	IntVec2 const& mins = region.m_texelMins;
+	IntVec2 maxs(mins.x + region.m_texelDims.x - 1, mins.y + region.m_texelDims.y - 1);
+	for (int atlasY = mins.y - padding; atlasY <= maxs.y + padding; ++atlasY)
+	{
+		int sourceY = std::clamp(atlasY, mins.y, maxs.y);
+		bool isInsideRow = atlasY == sourceY;
+		for (int atlasX = mins.x - padding; atlasX <= maxs.x + padding; ++atlasX)
+		{
+			if (isInsideRow && atlasX == mins.x)
+			{
+				atlasX = maxs.x;
+				continue;
+			}
+			int sourceX = std::clamp(atlasX, mins.x, maxs.x);
+			m_atlasImage.SetTexelColor(atlasX, atlasY, m_atlasImage.GetTexelColor(sourceX, sourceY));
+		}
+	}
+}
+// -----------------------------------------------------------------------------
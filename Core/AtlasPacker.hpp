@@ -0,0 +1,57 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+#include "Engine/Math/AABB2.h"
+#include "Engine/Math/IntVec2.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+struct AtlasPackerSettings
+{
+	IntVec2 m_atlasDimensions = IntVec2(2048, 2048);
+	int		m_padding = 2;				// Texels kept free around every image so bilinear and mip filtering never bleed
+	bool	m_extrudeEdges = true;		// Fill that padding with copies of the image's border texels
+	bool	m_allowRotation = false;	// Lets images be stored turned 90 degrees, see AtlasRegion::m_isRotated
+};
+// -----------------------------------------------------------------------------
+struct AtlasRegion
+{
+	bool	m_isPacked = false;
+	bool	m_isRotated = false;			// Stored turned 90 degrees counterclockwise, the image's bottom edge runs up the region's right side
+	IntVec2 m_texelMins = IntVec2(0, 0);	// Where the image itself starts in the atlas, padding excluded
+	IntVec2 m_texelDims = IntVec2(0, 0);	// Size as stored in the atlas, so width and height are swapped when rotated
+	AABB2	m_uvs = AABB2::ZERO_TO_ONE;
+
+	void GetCornerUVs(Vec2& out_bottomLeft, Vec2& out_bottomRight, Vec2& out_topRight, Vec2& out_topLeft) const; // UVs for the image's own corners, rotation undone
+};
+// -----------------------------------------------------------------------------
+struct AtlasRect
+{
+	IntVec2 m_mins = IntVec2(0, 0);
+	IntVec2 m_dims = IntVec2(0, 0);
+};
+// -----------------------------------------------------------------------------
+// MaxRects bin packer (best short side fit) that copies each image into one atlas Image as it goes, so images can keep
+// being inserted after earlier ones are already in use. Batches are inserted largest first for tighter packing.
+// -----------------------------------------------------------------------------
+class AtlasPacker
+{
+public:
+	explicit AtlasPacker(AtlasPackerSettings const& settings = AtlasPackerSettings());
+
+	AtlasRegion InsertImage(Image const& image); // Check m_isPacked, false when there was no room left
+	bool		InsertImages(std::vector<Image> const& images, std::vector<AtlasRegion>& out_regions); // Returns false if any image did not fit
+
+	Image const& GetAtlasImage() const;
+	float		 GetOccupancy() const; // Fraction of atlas texels used, padding included
+
+private:
+	bool FindFreeRect(IntVec2 const& paddedDims, AtlasRect& out_rect, bool& out_isRotated) const;
+	void PlaceRect(AtlasRect const& usedRect);
+	void CopyImageIntoAtlas(Image const& image, AtlasRegion const& region);
+
+private:
+	AtlasPackerSettings	   m_settings;
+	Image				   m_atlasImage;
+	std::vector<AtlasRect> m_freeRects;
+	long long			   m_usedTexelCount = 0;
+};
+// -----------------------------------------------------------------------------
@@ -0,0 +1,1167 @@
+#include "Engine/Core/BlockCompression.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <limits>
+// -----------------------------------------------------------------------------
+constexpr int BLOCK_COMPRESSION_BLOCK_ROWS_PER_JOB = 4;
+constexpr int BLOCK_TEXEL_COUNT = 16;
+// -----------------------------------------------------------------------------
+static int const s_bc7Weights2[4] = { 0, 21, 43, 64 };
+static int const s_bc7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static int const s_bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+// -----------------------------------------------------------------------------
+struct BlockTexels
+{
+	float m_values[BLOCK_TEXEL_COUNT][4];	// 0 to 255, RGBA unless a BC7 rotation swapped alpha into a color channel
+	int	  m_numTexels = 0;
+};
+// -----------------------------------------------------------------------------
+struct BC7ChannelFit
+{
+	int	  m_codes[2][4] = {};				// Quantized endpoint codes, only the fitted channels are used
+	int	  m_pBits[2] = {};
+	int	  m_indexes[BLOCK_TEXEL_COUNT] = {};
+	float m_error = FLT_MAX;
+};
+// -----------------------------------------------------------------------------
+struct BlockBitWriter
+{
+	explicit BlockBitWriter(unsigned char* out_block) : m_block(out_block) {}
+
+	void Write(unsigned int value, int numBits)
+	{
+		for (int bitIndex = 0; bitIndex < numBits; ++bitIndex, ++m_bitPosition)
+		{
+			if ((value >> bitIndex) & 1)
+			{
+				m_block[m_bitPosition >> 3] |= static_cast<unsigned char>(1 << (m_bitPosition & 7));
+			}
+		}
+	}
+
+	unsigned char* m_block = nullptr;
+	int			   m_bitPosition = 0;
+};
+// -----------------------------------------------------------------------------
+struct BlockBitReader
+{
+	explicit BlockBitReader(unsigned char const* block) : m_block(block) {}
+
+	int Read(int numBits)
+	{
+		int value = 0;
+		for (int bitIndex = 0; bitIndex < numBits; ++bitIndex, ++m_bitPosition)
+		{
+			value |= ((m_block[m_bitPosition >> 3] >> (m_bitPosition & 7)) & 1) << bitIndex;
+		}
+		return value;
+	}
+
+	unsigned char const* m_block = nullptr;
+	int					 m_bitPosition = 0;
+};
+// -----------------------------------------------------------------------------
+static int GetNumRefinements(BlockCompressionQuality quality)
+{
+	switch (quality)
+	{
+		case BlockCompressionQuality::FAST:	  return 0;
+		case BlockCompressionQuality::NORMAL: return 2;
+		default:							  return 4;
+	}
+}
+// -----------------------------------------------------------------------------
+static void ComputePrincipalAxis(BlockTexels const& texels, int firstChannel, int numChannels, float out_mean[4], float out_axis[4])
+{
+	for (int channel = 0; channel < 4; ++channel)
+	{
+		out_mean[channel] = 0.f;
+		out_axis[channel] = 0.f;
+	}
+	if (texels.m_numTexels == 0)
+	{
+		return;
+	}
+
+	for (int texelIndex = 0; texelIndex < texels.m_numTexels; ++texelIndex)
+	{
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			out_mean[channel] += texels.m_values[texelIndex][channel];
+		}
+	}
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		out_mean[channel] /= static_cast<float>(texels.m_numTexels);
+	}
+
+	float covariance[4][4] = {};
+	for (int texelIndex = 0; texelIndex < texels.m_numTexels; ++texelIndex)
+	{
+		for (int row = firstChannel; row < firstChannel + numChannels; ++row)
+		{
+			float rowDelta = texels.m_values[texelIndex][row] - out_mean[row];
+			for (int column = firstChannel; column < firstChannel + numChannels; ++column)
+			{
+				covariance[row][column] += rowDelta * (texels.m_values[texelIndex][column] - out_mean[column]);
+			}
+		}
+	}
+
+	// Power iteration, seeded with the covariance row of the widest channel so it never starts orthogonal to the answer
+	int widestChannel = firstChannel;
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		if (covariance[channel][channel] > covariance[widestChannel][widestChannel])
+		{
+			widestChannel = channel;
+		}
+	}
+	float axis[4] = {};
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		axis[channel] = covariance[widestChannel][channel];
+	}
+
+	for (int iteration = 0; iteration < 8; ++iteration)
+	{
+		float nextAxis[4] = {};
+		float largest = 0.f;
+		for (int row = firstChannel; row < firstChannel + numChannels; ++row)
+		{
+			for (int column = firstChannel; column < firstChannel + numChannels; ++column)
+			{
+				nextAxis[row] += covariance[row][column] * axis[column];
+			}
+			largest = std::max(largest, fabsf(nextAxis[row]));
+		}
+		if (largest < 1e-6f)
+		{
+			break;
+		}
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			axis[channel] = nextAxis[channel] / largest;
+		}
+	}
+
+	float lengthSquared = 0.f;
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		lengthSquared += axis[channel] * axis[channel];
+	}
+	if (lengthSquared < 1e-12f)
+	{
+		// Every texel is the same color, any direction will do
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			out_axis[channel] = 1.f / sqrtf(static_cast<float>(numChannels));
+		}
+		return;
+	}
+	float inverseLength = 1.f / sqrtf(lengthSquared);
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		out_axis[channel] = axis[channel] * inverseLength;
+	}
+}
+// -----------------------------------------------------------------------------
+static void FitEndpointsToAxis(BlockTexels const& texels, int firstChannel, int numChannels, float out_endpoint0[4], float out_endpoint1[4])
+{
+	float mean[4];
+	float axis[4];
+	ComputePrincipalAxis(texels, firstChannel, numChannels, mean, axis);
+
+	float minProjection = 0.f;
+	float maxProjection = 0.f;
+	for (int texelIndex = 0; texelIndex < texels.m_numTexels; ++texelIndex)
+	{
+		float projection = 0.f;
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			projection += (texels.m_values[texelIndex][channel] - mean[channel]) * axis[channel];
+		}
+		minProjection = std::min(minProjection, projection);
+		maxProjection = std::max(maxProjection, projection);
+	}
+
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		out_endpoint0[channel] = GetClamped(mean[channel] + axis[channel] * minProjection, 0.f, 255.f);
+		out_endpoint1[channel] = GetClamped(mean[channel] + axis[channel] * maxProjection, 0.f, 255.f);
+	}
+}
+// -----------------------------------------------------------------------------
+// Best endpoints for fixed per texel blend factors, one 2x2 normal equation shared by every channel
+static bool SolveEndpointsLeastSquares(BlockTexels const& texels, int firstChannel, int numChannels, float const blendFactors[BLOCK_TEXEL_COUNT], float out_endpoint0[4], float out_endpoint1[4])
+{
+	float sumAA = 0.f;
+	float sumAB = 0.f;
+	float sumBB = 0.f;
+	float sumAX[4] = {};
+	float sumBX[4] = {};
+	for (int texelIndex = 0; texelIndex < texels.m_numTexels; ++texelIndex)
+	{
+		float b = blendFactors[texelIndex];
+		float a = 1.f - b;
+		sumAA += a * a;
+		sumAB += a * b;
+		sumBB += b * b;
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			sumAX[channel] += a * texels.m_values[texelIndex][channel];
+			sumBX[channel] += b * texels.m_values[texelIndex][channel];
+		}
+	}
+
+	float determinant = sumAA * sumBB - sumAB * sumAB;
+	if (fabsf(determinant) < 1e-6f)
+	{
+		return false;
+	}
+	float inverseDeterminant = 1.f / determinant;
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		out_endpoint0[channel] = GetClamped((sumBB * sumAX[channel] - sumAB * sumBX[channel]) * inverseDeterminant, 0.f, 255.f);
+		out_endpoint1[channel] = GetClamped((sumAA * sumBX[channel] - sumAB * sumAX[channel]) * inverseDeterminant, 0.f, 255.f);
+	}
+	return true;
+}
+// -----------------------------------------------------------------------------
+static void GatherBlock(Rgba8 out_texels[BLOCK_TEXEL_COUNT], Rgba8 const* texels, IntVec2 const& dimensions, int blockX, int blockY)
+{
+	for (int rowInBlock = 0; rowInBlock < 4; ++rowInBlock)
+	{
+		int texelY = std::min(blockY * 4 + rowInBlock, dimensions.y - 1);
+		for (int columnInBlock = 0; columnInBlock < 4; ++columnInBlock)
+		{
+			int texelX = std::min(blockX * 4 + columnInBlock, dimensions.x - 1);
+			out_texels[rowInBlock * 4 + columnInBlock] = texels[static_cast<size_t>(texelY) * dimensions.x + texelX];
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+// BC1 color
+// -----------------------------------------------------------------------------
+static int PackRgb565(float const color[4])
+{
+	int red = GetClamped(static_cast<int>(color[0] * (31.f / 255.f) + 0.5f), 0, 31);
+	int green = GetClamped(static_cast<int>(color[1] * (63.f / 255.f) + 0.5f), 0, 63);
+	int blue = GetClamped(static_cast<int>(color[2] * (31.f / 255.f) + 0.5f), 0, 31);
+	return (red << 11) | (green << 5) | blue;
+}
+
+static void UnpackRgb565(int packedColor, int out_color[3])
+{
+	int red = (packedColor >> 11) & 31;
+	int green = (packedColor >> 5) & 63;
+	int blue = packedColor & 31;
+	out_color[0] = (red << 3) | (red >> 2);
+	out_color[1] = (green << 2) | (green >> 4);
+	out_color[2] = (blue << 3) | (blue >> 2);
+}
+
+// Index 3 of the three color palette is transparent black, the caller handles its alpha
+static void MakeBC1Palette(int color0, int color1, bool isFourColor, int out_palette[4][3])
+{
+	UnpackRgb565(color0, out_palette[0]);
+	UnpackRgb565(color1, out_palette[1]);
+	for (int channel = 0; channel < 3; ++channel)
+	{
+		int value0 = out_palette[0][channel];
+		int value1 = out_palette[1][channel];
+		if (isFourColor)
+		{
+			out_palette[2][channel] = (2 * value0 + value1 + 1) / 3;
+			out_palette[3][channel] = (value0 + 2 * value1 + 1) / 3;
+		}
+		else
+		{
+			out_palette[2][channel] = (value0 + value1 + 1) / 2;
+			out_palette[3][channel] = 0;
+		}
+	}
+}
+
+static float AssignBC1Indexes(BlockTexels const& texels, int const palette[4][3], int numColors, int out_indexes[BLOCK_TEXEL_COUNT])
+{
+	float totalError = 0.f;
+	for (int texelIndex = 0; texelIndex < texels.m_numTexels; ++texelIndex)
+	{
+		float bestError = FLT_MAX;
+		for (int colorIndex = 0; colorIndex < numColors; ++colorIndex)
+		{
+			float error = 0.f;
+			for (int channel = 0; channel < 3; ++channel)
+			{
+				float delta = texels.m_values[texelIndex][channel] - static_cast<float>(palette[colorIndex][channel]);
+				error += delta * delta;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				out_indexes[texelIndex] = colorIndex;
+			}
+		}
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+static void EncodeBC1ColorBlock(unsigned char* out_block, Rgba8 const sourceTexels[BLOCK_TEXEL_COUNT], bool allowTransparency, int numRefinements)
+{
+	// Texels below half alpha become transparent black through the three color mode, only the rest are fitted
+	BlockTexels texels;
+	int fittedTexelIndexes[BLOCK_TEXEL_COUNT] = {};
+	bool isTransparent[BLOCK_TEXEL_COUNT] = {};
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		isTransparent[texelIndex] = allowTransparency && sourceTexels[texelIndex].a < 128;
+		if (!isTransparent[texelIndex])
+		{
+			float* values = texels.m_values[texels.m_numTexels];
+			values[0] = static_cast<float>(sourceTexels[texelIndex].r);
+			values[1] = static_cast<float>(sourceTexels[texelIndex].g);
+			values[2] = static_cast<float>(sourceTexels[texelIndex].b);
+			values[3] = 255.f;
+			fittedTexelIndexes[texels.m_numTexels++] = texelIndex;
+		}
+	}
+	bool isFourColor = texels.m_numTexels == BLOCK_TEXEL_COUNT;
+	int numColors = isFourColor ? 4 : 3;
+	float const blendForIndex[4] = { 0.f, 1.f, isFourColor ? 1.f / 3.f : 0.5f, 2.f / 3.f };
+
+	int bestColor0 = 0;
+	int bestColor1 = 0;
+	int bestIndexes[BLOCK_TEXEL_COUNT] = {};
+	if (texels.m_numTexels > 0)
+	{
+		float endpoint0[4];
+		float endpoint1[4];
+		FitEndpointsToAxis(texels, 0, 3, endpoint0, endpoint1);
+
+		float bestError = FLT_MAX;
+		for (int pass = 0; pass <= numRefinements; ++pass)
+		{
+			int color0 = PackRgb565(endpoint0);
+			int color1 = PackRgb565(endpoint1);
+			int palette[4][3];
+			MakeBC1Palette(color0, color1, isFourColor, palette);
+			int indexes[BLOCK_TEXEL_COUNT];
+			float error = AssignBC1Indexes(texels, palette, numColors, indexes);
+			if (error < bestError)
+			{
+				bestError = error;
+				bestColor0 = color0;
+				bestColor1 = color1;
+				memcpy(bestIndexes, indexes, sizeof(indexes));
+			}
+			if (bestError == 0.f || pass == numRefinements)
+			{
+				break;
+			}
+
+			float blendFactors[BLOCK_TEXEL_COUNT];
+			for (int texelIndex = 0; texelIndex < texels.m_numTexels; ++texelIndex)
+			{
+				blendFactors[texelIndex] = blendForIndex[indexes[texelIndex]];
+			}
+			if (!SolveEndpointsLeastSquares(texels, 0, 3, blendFactors, endpoint0, endpoint1))
+			{
+				break;
+			}
+		}
+	}
+
+	// The endpoint order picks the mode, so swap them (and the indexes with them) to get the mode we fitted for
+	bool needsSwap = isFourColor ? bestColor0 < bestColor1 : bestColor0 > bestColor1;
+	if (needsSwap)
+	{
+		std::swap(bestColor0, bestColor1);
+		for (int texelIndex = 0; texelIndex < texels.m_numTexels; ++texelIndex)
+		{
+			int const swappedIndex[4] = { 1, 0, isFourColor ? 3 : 2, 2 };
+			bestIndexes[texelIndex] = swappedIndex[bestIndexes[texelIndex]];
+		}
+	}
+	if (isFourColor && bestColor0 == bestColor1)
+	{
+		// Equal endpoints read back as the three color mode, where index 3 would turn transparent
+		for (int texelIndex = 0; texelIndex < texels.m_numTexels; ++texelIndex)
+		{
+			bestIndexes[texelIndex] = 0;
+		}
+	}
+
+	unsigned int indexBits = 0;
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		if (isTransparent[texelIndex])
+		{
+			indexBits |= 3u << (texelIndex * 2);
+		}
+	}
+	for (int fittedIndex = 0; fittedIndex < texels.m_numTexels; ++fittedIndex)
+	{
+		indexBits |= static_cast<unsigned int>(bestIndexes[fittedIndex]) << (fittedTexelIndexes[fittedIndex] * 2);
+	}
+
+	out_block[0] = static_cast<unsigned char>(bestColor0 & 0xFF);
+	out_block[1] = static_cast<unsigned char>(bestColor0 >> 8);
+	out_block[2] = static_cast<unsigned char>(bestColor1 & 0xFF);
+	out_block[3] = static_cast<unsigned char>(bestColor1 >> 8);
+	for (int byteIndex = 0; byteIndex < 4; ++byteIndex)
+	{
+		out_block[4 + byteIndex] = static_cast<unsigned char>(indexBits >> (byteIndex * 8));
+	}
+}
+
+static void DecodeBC1ColorBlock(Rgba8 out_texels[BLOCK_TEXEL_COUNT], unsigned char const* block, bool isAlwaysFourColor)
+{
+	int color0 = block[0] | (block[1] << 8);
+	int color1 = block[2] | (block[3] << 8);
+	bool isFourColor = isAlwaysFourColor || color0 > color1;
+	int palette[4][3];
+	MakeBC1Palette(color0, color1, isFourColor, palette);
+
+	unsigned int indexBits = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<unsigned int>(block[7]) << 24);
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		int colorIndex = (indexBits >> (texelIndex * 2)) & 3;
+		bool isTransparent = !isFourColor && colorIndex == 3;
+		out_texels[texelIndex] = Rgba8(static_cast<unsigned char>(palette[colorIndex][0]), static_cast<unsigned char>(palette[colorIndex][1]),
+			static_cast<unsigned char>(palette[colorIndex][2]), isTransparent ? 0 : 255);
+	}
+}
+// -----------------------------------------------------------------------------
+// BC3 alpha
+// -----------------------------------------------------------------------------
+static void MakeBC3AlphaPalette(int alpha0, int alpha1, int out_palette[8])
+{
+	out_palette[0] = alpha0;
+	out_palette[1] = alpha1;
+	if (alpha0 > alpha1)
+	{
+		for (int paletteIndex = 2; paletteIndex < 8; ++paletteIndex)
+		{
+			out_palette[paletteIndex] = ((8 - paletteIndex) * alpha0 + (paletteIndex - 1) * alpha1 + 3) / 7;
+		}
+	}
+	else
+	{
+		for (int paletteIndex = 2; paletteIndex < 6; ++paletteIndex)
+		{
+			out_palette[paletteIndex] = ((6 - paletteIndex) * alpha0 + (paletteIndex - 1) * alpha1 + 2) / 5;
+		}
+		out_palette[6] = 0;
+		out_palette[7] = 255;
+	}
+}
+
+static int AssignBC3AlphaIndexes(Rgba8 const texels[BLOCK_TEXEL_COUNT], int alpha0, int alpha1, int out_indexes[BLOCK_TEXEL_COUNT])
+{
+	int palette[8];
+	MakeBC3AlphaPalette(alpha0, alpha1, palette);
+	int totalError = 0;
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		int bestError = INT_MAX;
+		for (int paletteIndex = 0; paletteIndex < 8; ++paletteIndex)
+		{
+			int delta = static_cast<int>(texels[texelIndex].a) - palette[paletteIndex];
+			if (delta * delta < bestError)
+			{
+				bestError = delta * delta;
+				out_indexes[texelIndex] = paletteIndex;
+			}
+		}
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+static void EncodeBC3AlphaBlock(unsigned char* out_block, Rgba8 const texels[BLOCK_TEXEL_COUNT], BlockCompressionQuality quality)
+{
+	int minAlpha = 255;
+	int maxAlpha = 0;
+	int minInnerAlpha = 255;	// Ignoring 0 and 255, which the six value mode stores exactly
+	int maxInnerAlpha = 0;
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		int alpha = texels[texelIndex].a;
+		minAlpha = std::min(minAlpha, alpha);
+		maxAlpha = std::max(maxAlpha, alpha);
+		if (alpha != 0 && alpha != 255)
+		{
+			minInnerAlpha = std::min(minInnerAlpha, alpha);
+			maxInnerAlpha = std::max(maxInnerAlpha, alpha);
+		}
+	}
+	if (minInnerAlpha > maxInnerAlpha)
+	{
+		minInnerAlpha = maxInnerAlpha = minAlpha;
+	}
+
+	int bestAlpha0 = maxAlpha;
+	int bestAlpha1 = minAlpha;
+	int bestIndexes[BLOCK_TEXEL_COUNT];
+	int bestError = AssignBC3AlphaIndexes(texels, bestAlpha0, bestAlpha1, bestIndexes);
+
+	int indexes[BLOCK_TEXEL_COUNT];
+	auto tryEndpoints = [&](int alpha0, int alpha1)
+	{
+		int error = AssignBC3AlphaIndexes(texels, alpha0, alpha1, indexes);
+		if (error < bestError)
+		{
+			bestError = error;
+			bestAlpha0 = alpha0;
+			bestAlpha1 = alpha1;
+			memcpy(bestIndexes, indexes, sizeof(indexes));
+		}
+	};
+	if (bestError > 0)
+	{
+		tryEndpoints(minInnerAlpha, maxInnerAlpha);
+	}
+	if (bestError > 0 && quality == BlockCompressionQuality::HIGH)
+	{
+		// Pulling the eight value endpoints in a little often lands the in between values closer
+		for (int maxInset = 0; maxInset <= 3; ++maxInset)
+		{
+			for (int minInset = 0; minInset <= 3; ++minInset)
+			{
+				int alpha0 = maxAlpha - maxInset;
+				int alpha1 = minAlpha + minInset;
+				if (alpha0 > alpha1)
+				{
+					tryEndpoints(alpha0, alpha1);
+				}
+			}
+		}
+	}
+
+	out_block[0] = static_cast<unsigned char>(bestAlpha0);
+	out_block[1] = static_cast<unsigned char>(bestAlpha1);
+	unsigned long long indexBits = 0;
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		indexBits |= static_cast<unsigned long long>(bestIndexes[texelIndex]) << (texelIndex * 3);
+	}
+	for (int byteIndex = 0; byteIndex < 6; ++byteIndex)
+	{
+		out_block[2 + byteIndex] = static_cast<unsigned char>(indexBits >> (byteIndex * 8));
+	}
+}
+
+static void DecodeBC3AlphaBlock(Rgba8 out_texels[BLOCK_TEXEL_COUNT], unsigned char const* block)
+{
+	int palette[8];
+	MakeBC3AlphaPalette(block[0], block[1], palette);
+	unsigned long long indexBits = 0;
+	for (int byteIndex = 0; byteIndex < 6; ++byteIndex)
+	{
+		indexBits |= static_cast<unsigned long long>(block[2 + byteIndex]) << (byteIndex * 8);
+	}
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		out_texels[texelIndex].a = static_cast<unsigned char>(palette[(indexBits >> (texelIndex * 3)) & 7]);
+	}
+}
+// -----------------------------------------------------------------------------
+// BC7, single subset modes 4, 5 and 6
+// -----------------------------------------------------------------------------
+static int const* GetBC7Weights(int indexBits)
+{
+	return indexBits == 2 ? s_bc7Weights2 : (indexBits == 3 ? s_bc7Weights3 : s_bc7Weights4);
+}
+
+static int ExpandBC7Bits(int value, int numBits)
+{
+	return (value << (8 - numBits)) | (value >> (2 * numBits - 8));
+}
+
+static int GetBC7EndpointValue(int code, int pBit, int endpointBits)
+{
+	return pBit < 0 ? ExpandBC7Bits(code, endpointBits) : ExpandBC7Bits((code << 1) | pBit, endpointBits + 1);
+}
+
+static int QuantizeBC7Channel(float value, int endpointBits, int pBit)
+{
+	int totalBits = endpointBits + (pBit < 0 ? 0 : 1);
+	int maxCode = (1 << endpointBits) - 1;
+	int nearestCode = static_cast<int>(value * static_cast<float>((1 << totalBits) - 1) / 255.f + 0.5f);
+	nearestCode = pBit < 0 ? nearestCode : (nearestCode >> 1);
+
+	int bestCode = 0;
+	float bestError = FLT_MAX;
+	for (int code = std::max(0, nearestCode - 1); code <= std::min(maxCode, nearestCode + 1); ++code)
+	{
+		float error = fabsf(static_cast<float>(GetBC7EndpointValue(code, pBit, endpointBits)) - value);
+		if (error < bestError)
+		{
+			bestError = error;
+			bestCode = code;
+		}
+	}
+	return bestCode;
+}
+
+static float AssignBC7Indexes(BlockTexels const& texels, int firstChannel, int numChannels, int const endpointValues[2][4], int indexBits, int out_indexes[BLOCK_TEXEL_COUNT])
+{
+	int const* weights = GetBC7Weights(indexBits);
+	int numIndexes = 1 << indexBits;
+	int palette[16][4];
+	for (int paletteIndex = 0; paletteIndex < numIndexes; ++paletteIndex)
+	{
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			palette[paletteIndex][channel] = ((64 - weights[paletteIndex]) * endpointValues[0][channel] + weights[paletteIndex] * endpointValues[1][channel] + 32) >> 6;
+		}
+	}
+
+	// Projecting onto the endpoint line lands within one palette entry of the nearest, so only three are compared
+	float lineDirection[4] = {};
+	float lineLengthSquared = 0.f;
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		lineDirection[channel] = static_cast<float>(endpointValues[1][channel] - endpointValues[0][channel]);
+		lineLengthSquared += lineDirection[channel] * lineDirection[channel];
+	}
+	float projectionScale = lineLengthSquared > 0.f ? static_cast<float>(numIndexes - 1) / lineLengthSquared : 0.f;
+
+	float totalError = 0.f;
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		float projection = 0.f;
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			projection += (texels.m_values[texelIndex][channel] - static_cast<float>(endpointValues[0][channel])) * lineDirection[channel];
+		}
+		int nearestIndex = GetClamped(static_cast<int>(projection * projectionScale + 0.5f), 0, numIndexes - 1);
+
+		float bestError = FLT_MAX;
+		for (int paletteIndex = std::max(0, nearestIndex - 1); paletteIndex <= std::min(numIndexes - 1, nearestIndex + 1); ++paletteIndex)
+		{
+			float error = 0.f;
+			for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+			{
+				float delta = texels.m_values[texelIndex][channel] - static_cast<float>(palette[paletteIndex][channel]);
+				error += delta * delta;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				out_indexes[texelIndex] = paletteIndex;
+			}
+		}
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+static void EvaluateBC7Endpoints(BC7ChannelFit& inout_bestFit, BlockTexels const& texels, int firstChannel, int numChannels, float const endpoints[2][4], int endpointBits, int const pBits[2], int indexBits)
+{
+	BC7ChannelFit fit;
+	int endpointValues[2][4] = {};
+	for (int endpointIndex = 0; endpointIndex < 2; ++endpointIndex)
+	{
+		fit.m_pBits[endpointIndex] = pBits[endpointIndex];
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			int code = QuantizeBC7Channel(endpoints[endpointIndex][channel], endpointBits, pBits[endpointIndex]);
+			fit.m_codes[endpointIndex][channel] = code;
+			endpointValues[endpointIndex][channel] = GetBC7EndpointValue(code, pBits[endpointIndex], endpointBits);
+		}
+	}
+	fit.m_error = AssignBC7Indexes(texels, firstChannel, numChannels, endpointValues, indexBits, fit.m_indexes);
+	if (fit.m_error < inout_bestFit.m_error)
+	{
+		inout_bestFit = fit;
+	}
+}
+
+// Picks the p-bit each endpoint rounds best with on its own, instead of trying every pair
+static int ChooseBC7PBit(float const endpoint[4], int firstChannel, int numChannels, int endpointBits)
+{
+	float errors[2] = {};
+	for (int pBit = 0; pBit < 2; ++pBit)
+	{
+		for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+		{
+			int code = QuantizeBC7Channel(endpoint[channel], endpointBits, pBit);
+			float delta = static_cast<float>(GetBC7EndpointValue(code, pBit, endpointBits)) - endpoint[channel];
+			errors[pBit] += delta * delta;
+		}
+	}
+	return errors[1] < errors[0] ? 1 : 0;
+}
+
+static void FitBC7Channels(BC7ChannelFit& out_fit, BlockTexels const& texels, int firstChannel, int numChannels, int endpointBits, bool hasPBits, int indexBits, BlockCompressionQuality quality)
+{
+	float endpoints[2][4] = {};
+	FitEndpointsToAxis(texels, firstChannel, numChannels, endpoints[0], endpoints[1]);
+	int const* weights = GetBC7Weights(indexBits);
+
+	out_fit = BC7ChannelFit();
+	int numRefinements = GetNumRefinements(quality);
+	for (int pass = 0; pass <= numRefinements; ++pass)
+	{
+		float previousError = out_fit.m_error;
+		if (!hasPBits)
+		{
+			int const noPBits[2] = { -1, -1 };
+			EvaluateBC7Endpoints(out_fit, texels, firstChannel, numChannels, endpoints, endpointBits, noPBits, indexBits);
+		}
+		else if (quality == BlockCompressionQuality::HIGH)
+		{
+			for (int pBitPair = 0; pBitPair < 4; ++pBitPair)
+			{
+				int const pBits[2] = { pBitPair & 1, pBitPair >> 1 };
+				EvaluateBC7Endpoints(out_fit, texels, firstChannel, numChannels, endpoints, endpointBits, pBits, indexBits);
+			}
+		}
+		else
+		{
+			int const pBits[2] = { ChooseBC7PBit(endpoints[0], firstChannel, numChannels, endpointBits), ChooseBC7PBit(endpoints[1], firstChannel, numChannels, endpointBits) };
+			EvaluateBC7Endpoints(out_fit, texels, firstChannel, numChannels, endpoints, endpointBits, pBits, indexBits);
+		}
+		// A refinement that did not help means the next one would start from the same indexes
+		if (out_fit.m_error == 0.f || out_fit.m_error >= previousError || pass == numRefinements)
+		{
+			break;
+		}
+
+		float blendFactors[BLOCK_TEXEL_COUNT];
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+		{
+			blendFactors[texelIndex] = static_cast<float>(weights[out_fit.m_indexes[texelIndex]]) / 64.f;
+		}
+		if (!SolveEndpointsLeastSquares(texels, firstChannel, numChannels, blendFactors, endpoints[0], endpoints[1]))
+		{
+			break;
+		}
+	}
+}
+
+// The first texel's index loses its top bit, so it has to sit in the lower half of the palette
+static void FixBC7AnchorIndex(BC7ChannelFit& inout_fit, int firstChannel, int numChannels, int indexBits)
+{
+	int maxIndex = (1 << indexBits) - 1;
+	if (inout_fit.m_indexes[0] <= maxIndex / 2)
+	{
+		return;
+	}
+	for (int channel = firstChannel; channel < firstChannel + numChannels; ++channel)
+	{
+		std::swap(inout_fit.m_codes[0][channel], inout_fit.m_codes[1][channel]);
+	}
+	std::swap(inout_fit.m_pBits[0], inout_fit.m_pBits[1]);
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		inout_fit.m_indexes[texelIndex] = maxIndex - inout_fit.m_indexes[texelIndex];
+	}
+}
+
+static void WriteBC7Indexes(BlockBitWriter& writer, int const indexes[BLOCK_TEXEL_COUNT], int indexBits)
+{
+	writer.Write(indexes[0], indexBits - 1);
+	for (int texelIndex = 1; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		writer.Write(indexes[texelIndex], indexBits);
+	}
+}
+
+static void WriteBC7Mode6(unsigned char* out_block, BC7ChannelFit fit)
+{
+	FixBC7AnchorIndex(fit, 0, 4, 4);
+	memset(out_block, 0, 16);
+	BlockBitWriter writer(out_block);
+	writer.Write(1 << 6, 7);
+	for (int channel = 0; channel < 4; ++channel)
+	{
+		writer.Write(fit.m_codes[0][channel], 7);
+		writer.Write(fit.m_codes[1][channel], 7);
+	}
+	writer.Write(fit.m_pBits[0], 1);
+	writer.Write(fit.m_pBits[1], 1);
+	WriteBC7Indexes(writer, fit.m_indexes, 4);
+}
+
+// Modes 4 and 5 fit color and alpha separately, after swapping alpha with the channel named by the rotation
+static void WriteBC7Mode4Or5(unsigned char* out_block, int mode, int rotation, int indexSelection, BC7ChannelFit colorFit, BC7ChannelFit alphaFit)
+{
+	int colorBits = mode == 4 ? 5 : 7;
+	int alphaBits = mode == 4 ? 6 : 8;
+	int colorIndexBits = (mode == 4 && indexSelection == 1) ? 3 : 2;
+	int alphaIndexBits = (mode == 4 && indexSelection == 0) ? 3 : 2;
+	FixBC7AnchorIndex(colorFit, 0, 3, colorIndexBits);
+	FixBC7AnchorIndex(alphaFit, 3, 1, alphaIndexBits);
+
+	memset(out_block, 0, 16);
+	BlockBitWriter writer(out_block);
+	writer.Write(1 << mode, mode + 1);
+	writer.Write(rotation, 2);
+	if (mode == 4)
+	{
+		writer.Write(indexSelection, 1);
+	}
+	for (int channel = 0; channel < 3; ++channel)
+	{
+		writer.Write(colorFit.m_codes[0][channel], colorBits);
+		writer.Write(colorFit.m_codes[1][channel], colorBits);
+	}
+	writer.Write(alphaFit.m_codes[0][3], alphaBits);
+	writer.Write(alphaFit.m_codes[1][3], alphaBits);
+
+	// The 2 bit index field always comes first
+	bool isColorFirst = colorIndexBits == 2;
+	WriteBC7Indexes(writer, isColorFirst ? colorFit.m_indexes : alphaFit.m_indexes, 2);
+	WriteBC7Indexes(writer, isColorFirst ? alphaFit.m_indexes : colorFit.m_indexes, isColorFirst ? alphaIndexBits : colorIndexBits);
+}
+
+static void EncodeBC7Block(unsigned char* out_block, Rgba8 const sourceTexels[BLOCK_TEXEL_COUNT], BlockCompressionQuality quality)
+{
+	BlockTexels texels;
+	texels.m_numTexels = BLOCK_TEXEL_COUNT;
+	bool isAlphaConstant = true;
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		texels.m_values[texelIndex][0] = static_cast<float>(sourceTexels[texelIndex].r);
+		texels.m_values[texelIndex][1] = static_cast<float>(sourceTexels[texelIndex].g);
+		texels.m_values[texelIndex][2] = static_cast<float>(sourceTexels[texelIndex].b);
+		texels.m_values[texelIndex][3] = static_cast<float>(sourceTexels[texelIndex].a);
+		isAlphaConstant = isAlphaConstant && sourceTexels[texelIndex].a == sourceTexels[0].a;
+	}
+
+	BC7ChannelFit mode6Fit;
+	FitBC7Channels(mode6Fit, texels, 0, 4, 7, true, 4, quality);
+	if (quality == BlockCompressionQuality::FAST || mode6Fit.m_error == 0.f || (quality == BlockCompressionQuality::NORMAL && isAlphaConstant))
+	{
+		WriteBC7Mode6(out_block, mode6Fit);
+		return;
+	}
+
+	float bestError = mode6Fit.m_error;
+	int bestMode = 6;
+	int bestRotation = 0;
+	int bestIndexSelection = 0;
+	BC7ChannelFit bestColorFit;
+	BC7ChannelFit bestAlphaFit;
+
+	int numRotations = quality == BlockCompressionQuality::HIGH ? 4 : 1;
+	for (int rotation = 0; rotation < numRotations; ++rotation)
+	{
+		BlockTexels rotatedTexels = texels;
+		if (rotation > 0)
+		{
+			for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+			{
+				std::swap(rotatedTexels.m_values[texelIndex][3], rotatedTexels.m_values[texelIndex][rotation - 1]);
+			}
+		}
+
+		int firstMode = quality == BlockCompressionQuality::HIGH ? 4 : 5;
+		for (int mode = firstMode; mode <= 5; ++mode)
+		{
+			int numIndexSelections = mode == 4 ? 2 : 1;
+			for (int indexSelection = 0; indexSelection < numIndexSelections; ++indexSelection)
+			{
+				int colorIndexBits = (mode == 4 && indexSelection == 1) ? 3 : 2;
+				int alphaIndexBits = (mode == 4 && indexSelection == 0) ? 3 : 2;
+				BC7ChannelFit colorFit;
+				BC7ChannelFit alphaFit;
+				FitBC7Channels(colorFit, rotatedTexels, 0, 3, mode == 4 ? 5 : 7, false, colorIndexBits, quality);
+				FitBC7Channels(alphaFit, rotatedTexels, 3, 1, mode == 4 ? 6 : 8, false, alphaIndexBits, quality);
+				float error = colorFit.m_error + alphaFit.m_error;
+				if (error < bestError)
+				{
+					bestError = error;
+					bestMode = mode;
+					bestRotation = rotation;
+					bestIndexSelection = indexSelection;
+					bestColorFit = colorFit;
+					bestAlphaFit = alphaFit;
+				}
+			}
+		}
+	}
+
+	if (bestMode == 6)
+	{
+		WriteBC7Mode6(out_block, mode6Fit);
+	}
+	else
+	{
+		WriteBC7Mode4Or5(out_block, bestMode, bestRotation, bestIndexSelection, bestColorFit, bestAlphaFit);
+	}
+}
+
+static void DecodeBC7Block(Rgba8 out_texels[BLOCK_TEXEL_COUNT], unsigned char const* block)
+{
+	int mode = 0;
+	while (mode < 8 && ((block[0] >> mode) & 1) == 0)
+	{
+		++mode;
+	}
+	if (mode < 4 || mode > 6)
+	{
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+		{
+			out_texels[texelIndex] = Rgba8(0, 0, 0, 0);
+		}
+		return;
+	}
+
+	BlockBitReader reader(block);
+	reader.Read(mode + 1);
+	int rotation = 0;
+	int indexSelection = 0;
+	if (mode != 6)
+	{
+		rotation = reader.Read(2);
+	}
+	if (mode == 4)
+	{
+		indexSelection = reader.Read(1);
+	}
+
+	int colorBits = mode == 4 ? 5 : 7;
+	int alphaBits = mode == 4 ? 6 : (mode == 5 ? 8 : 7);
+	int codes[2][4] = {};
+	for (int channel = 0; channel < 3; ++channel)
+	{
+		codes[0][channel] = reader.Read(colorBits);
+		codes[1][channel] = reader.Read(colorBits);
+	}
+	codes[0][3] = reader.Read(alphaBits);
+	codes[1][3] = reader.Read(alphaBits);
+
+	int endpointValues[2][4] = {};
+	if (mode == 6)
+	{
+		int pBits[2] = { reader.Read(1), reader.Read(1) };
+		for (int endpointIndex = 0; endpointIndex < 2; ++endpointIndex)
+		{
+			for (int channel = 0; channel < 4; ++channel)
+			{
+				endpointValues[endpointIndex][channel] = GetBC7EndpointValue(codes[endpointIndex][channel], pBits[endpointIndex], 7);
+			}
+		}
+	}
+	else
+	{
+		for (int endpointIndex = 0; endpointIndex < 2; ++endpointIndex)
+		{
+			for (int channel = 0; channel < 4; ++channel)
+			{
+				endpointValues[endpointIndex][channel] = ExpandBC7Bits(codes[endpointIndex][channel], channel < 3 ? colorBits : alphaBits);
+			}
+		}
+	}
+
+	int firstIndexes[BLOCK_TEXEL_COUNT] = {};
+	int secondIndexes[BLOCK_TEXEL_COUNT] = {};
+	int firstIndexBits = mode == 6 ? 4 : 2;
+	int secondIndexBits = mode == 4 ? 3 : 2;
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		firstIndexes[texelIndex] = reader.Read(texelIndex == 0 ? firstIndexBits - 1 : firstIndexBits);
+	}
+	if (mode != 6)
+	{
+		for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+		{
+			secondIndexes[texelIndex] = reader.Read(texelIndex == 0 ? secondIndexBits - 1 : secondIndexBits);
+		}
+	}
+
+	for (int texelIndex = 0; texelIndex < BLOCK_TEXEL_COUNT; ++texelIndex)
+	{
+		int colorWeight = 0;
+		int alphaWeight = 0;
+		if (mode == 6)
+		{
+			colorWeight = alphaWeight = s_bc7Weights4[firstIndexes[texelIndex]];
+		}
+		else if (indexSelection == 0)
+		{
+			colorWeight = s_bc7Weights2[firstIndexes[texelIndex]];
+			alphaWeight = GetBC7Weights(secondIndexBits)[secondIndexes[texelIndex]];
+		}
+		else
+		{
+			colorWeight = s_bc7Weights3[secondIndexes[texelIndex]];
+			alphaWeight = s_bc7Weights2[firstIndexes[texelIndex]];
+		}
+
+		int values[4];
+		for (int channel = 0; channel < 4; ++channel)
+		{
+			int weight = channel < 3 ? colorWeight : alphaWeight;
+			values[channel] = ((64 - weight) * endpointValues[0][channel] + weight * endpointValues[1][channel] + 32) >> 6;
+		}
+		if (rotation > 0)
+		{
+			std::swap(values[3], values[rotation - 1]);
+		}
+		out_texels[texelIndex] = Rgba8(static_cast<unsigned char>(values[0]), static_cast<unsigned char>(values[1]), static_cast<unsigned char>(values[2]), static_cast<unsigned char>(values[3]));
+	}
+}
+// -----------------------------------------------------------------------------
+static void CompressBlockRows(unsigned char* out_blocks, Rgba8 const* texels, IntVec2 const& dimensions, BlockCompressionSettings const& settings, int startBlockRow, int endBlockRow)
+{
+	IntVec2 blockCounts = GetBlockCompressionBlockCounts(dimensions);
+	int bytesPerBlock = GetBlockCompressionBytesPerBlock(settings.m_format);
+	int numRefinements = GetNumRefinements(settings.m_quality);
+	Rgba8 blockTexels[BLOCK_TEXEL_COUNT];
+	for (int blockY = startBlockRow; blockY < endBlockRow; ++blockY)
+	{
+		for (int blockX = 0; blockX < blockCounts.x; ++blockX)
+		{
+			GatherBlock(blockTexels, texels, dimensions, blockX, blockY);
+			unsigned char* block = out_blocks + (static_cast<size_t>(blockY) * blockCounts.x + blockX) * bytesPerBlock;
+			switch (settings.m_format)
+			{
+				case BlockCompressionFormat::BC1:
+					EncodeBC1ColorBlock(block, blockTexels, true, numRefinements);
+					break;
+				case BlockCompressionFormat::BC3:
+					EncodeBC3AlphaBlock(block, blockTexels, settings.m_quality);
+					EncodeBC1ColorBlock(block + 8, blockTexels, false, numRefinements);
+					break;
+				default:
+					EncodeBC7Block(block, blockTexels, settings.m_quality);
+					break;
+			}
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+int GetBlockCompressionBytesPerBlock(BlockCompressionFormat format)
+{
+	return format == BlockCompressionFormat::BC1 ? 8 : 16;
+}
+
+IntVec2 GetBlockCompressionBlockCounts(IntVec2 const& dimensions)
+{
+	return IntVec2((dimensions.x + 3) / 4, (dimensions.y + 3) / 4);
+}
+
+void CompressImage(CompressedImage& out_image, Image const& sourceImage, BlockCompressionSettings const& settings, JobSystem* jobSystem)
+{
+	IntVec2 dimensions = sourceImage.GetDimensions();
+	GUARANTEE_OR_DIE(dimensions.x > 0 && dimensions.y > 0, Stringf("Cannot block compress the empty image \"%s\"", sourceImage.GetImageFilePath().c_str()));
+	IntVec2 blockCounts = GetBlockCompressionBlockCounts(dimensions);
+
+	out_image.m_format = settings.m_format;
+	out_image.m_dimensions = dimensions;
+	out_image.m_imageFilePath = sourceImage.GetImageFilePath();
+	out_image.m_blocks.assign(static_cast<size_t>(blockCounts.x) * blockCounts.y * GetBlockCompressionBytesPerBlock(settings.m_format), 0);
+
+	unsigned char* blocks = out_image.m_blocks.data();
+	Rgba8 const* texels = static_cast<Rgba8 const*>(sourceImage.GetRawData());
+	int numJobs = (blockCounts.y + BLOCK_COMPRESSION_BLOCK_ROWS_PER_JOB - 1) / BLOCK_COMPRESSION_BLOCK_ROWS_PER_JOB;
+	auto jobFunction = [&](int startJob, int endJob)
+	{
+		int startBlockRow = startJob * BLOCK_COMPRESSION_BLOCK_ROWS_PER_JOB;
+		int endBlockRow = std::min(endJob * BLOCK_COMPRESSION_BLOCK_ROWS_PER_JOB, blockCounts.y);
+		CompressBlockRows(blocks, texels, dimensions, settings, startBlockRow, endBlockRow);
+	};
+
+	if (jobSystem != nullptr)
+	{
+		jobSystem->ExecuteParallelFor(numJobs, 1, jobFunction);
+	}
+	else
+	{
+		jobFunction(0, numJobs);
+	}
+}
+
+void CompressImageMipChain(std::vector<CompressedImage>& out_mipChain, std::vector<Image> const& mipChain, BlockCompressionSettings const& settings, JobSystem* jobSystem)
+{
+	out_mipChain.clear();
+	out_mipChain.resize(mipChain.size());
+	for (int levelIndex = 0; levelIndex < static_cast<int>(mipChain.size()); ++levelIndex)
+	{
+		CompressImage(out_mipChain[levelIndex], mipChain[levelIndex], settings, jobSystem);
+	}
+}
+
+void DecompressImage(Image& out_image, CompressedImage const& compressedImage)
+{
+	IntVec2 dimensions = compressedImage.m_dimensions;
+	IntVec2 blockCounts = GetBlockCompressionBlockCounts(dimensions);
+	int bytesPerBlock = GetBlockCompressionBytesPerBlock(compressedImage.m_format);
+	GUARANTEE_OR_DIE(compressedImage.m_blocks.size() == static_cast<size_t>(blockCounts.x) * blockCounts.y * bytesPerBlock,
+		Stringf("Compressed image \"%s\" has the wrong block data size", compressedImage.m_imageFilePath.c_str()));
+
+	std::vector<Rgba8> texels(static_cast<size_t>(dimensions.x) * dimensions.y);
+	Rgba8 blockTexels[BLOCK_TEXEL_COUNT];
+	for (int blockY = 0; blockY < blockCounts.y; ++blockY)
+	{
+		for (int blockX = 0; blockX < blockCounts.x; ++blockX)
+		{
+			unsigned char const* block = compressedImage.m_blocks.data() + (static_cast<size_t>(blockY) * blockCounts.x + blockX) * bytesPerBlock;
+			switch (compressedImage.m_format)
+			{
+				case BlockCompressionFormat::BC1:
+					DecodeBC1ColorBlock(blockTexels, block, false);
+					break;
+				case BlockCompressionFormat::BC3:
+					DecodeBC1ColorBlock(blockTexels, block + 8, true);
+					DecodeBC3AlphaBlock(blockTexels, block);
+					break;
+				default:
+					DecodeBC7Block(blockTexels, block);
+					break;
+			}
+
+			for (int rowInBlock = 0; rowInBlock < 4 && blockY * 4 + rowInBlock < dimensions.y; ++rowInBlock)
+			{
+				for (int columnInBlock = 0; columnInBlock < 4 && blockX * 4 + columnInBlock < dimensions.x; ++columnInBlock)
+				{
+					size_t texelIndex = static_cast<size_t>(blockY * 4 + rowInBlock) * dimensions.x + blockX * 4 + columnInBlock;
+					texels[texelIndex] = blockTexels[rowInBlock * 4 + columnInBlock];
+				}
+			}
+		}
+	}
+
+	out_image = Image(dimensions, std::move(texels));
+}
+// -----------------------------------------------------------------------------
+float ComputeImagePSNR(Image const& imageA, Image const& imageB, bool includeAlpha)
+{
+	IntVec2 dimensions = imageA.GetDimensions();
+	GUARANTEE_OR_DIE(dimensions == imageB.GetDimensions(), "ComputeImagePSNR needs images of the same size");
+
+	Rgba8 const* texelsA = static_cast<Rgba8 const*>(imageA.GetRawData());
+	Rgba8 const* texelsB = static_cast<Rgba8 const*>(imageB.GetRawData());
+	size_t numTexels = static_cast<size_t>(dimensions.x) * dimensions.y;
+	double squaredErrorSum = 0.0;
+	for (size_t texelIndex = 0; texelIndex < numTexels; ++texelIndex)
+	{
+		int deltaR = texelsA[texelIndex].r - texelsB[texelIndex].r;
+		int deltaG = texelsA[texelIndex].g - texelsB[texelIndex].g;
+		int deltaB = texelsA[texelIndex].b - texelsB[texelIndex].b;
+		int deltaA = includeAlpha ? texelsA[texelIndex].a - texelsB[texelIndex].a : 0;
+		squaredErrorSum += static_cast<double>(deltaR * deltaR + deltaG * deltaG + deltaB * deltaB + deltaA * deltaA);
+	}
+
+	double numSamples = static_cast<double>(numTexels) * (includeAlpha ? 4.0 : 3.0);
+	double meanSquaredError = squaredErrorSum / numSamples;
+	if (meanSquaredError == 0.0)
+	{
+		return std::numeric_limits<float>::infinity();
+	}
+	return static_cast<float>(10.0 * log10((255.0 * 255.0) / meanSquaredError));
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,47 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+class JobSystem;
+// -----------------------------------------------------------------------------
+enum class BlockCompressionFormat
+{
+	BC1,	// 8 bytes per 4x4 block, RGB with 1 bit alpha
+	BC3,	// 16 bytes per block, BC1 color plus an interpolated alpha block
+	BC7,	// 16 bytes per block, RGBA at the best quality of the three
+	COUNT
+};
+// -----------------------------------------------------------------------------
+enum class BlockCompressionQuality
+{
+	FAST,	// Principal axis endpoints with no refinement, BC7 only tries mode 6
+	NORMAL,	// Two least squares refinements, BC7 adds mode 5 for blocks whose alpha varies
+	HIGH,	// Four refinements, every BC7 p-bit pair, channel rotations and mode 4
+	COUNT
+};
+// -----------------------------------------------------------------------------
+struct BlockCompressionSettings
+{
+	BlockCompressionFormat	m_format = BlockCompressionFormat::BC7;
+	BlockCompressionQuality m_quality = BlockCompressionQuality::NORMAL;
+};
+// -----------------------------------------------------------------------------
+struct CompressedImage
+{
+	BlockCompressionFormat	   m_format = BlockCompressionFormat::BC7;
+	IntVec2					   m_dimensions = IntVec2(0, 0);	// In texels, need not be a multiple of 4
+	std::string				   m_imageFilePath;
+	std::vector<unsigned char> m_blocks;						// Block rows in the same order as the Image rows they came from
+};
+// -----------------------------------------------------------------------------
+// Blocks are independent, so the block rows are split across the job system when one is given.
+// Edge blocks of sizes that are not a multiple of 4 repeat the last row and column.
+int		GetBlockCompressionBytesPerBlock(BlockCompressionFormat format);
+IntVec2 GetBlockCompressionBlockCounts(IntVec2 const& dimensions);
+void	CompressImage(CompressedImage& out_image, Image const& sourceImage, BlockCompressionSettings const& settings = BlockCompressionSettings(), JobSystem* jobSystem = nullptr);
+void	CompressImageMipChain(std::vector<CompressedImage>& out_mipChain, std::vector<Image> const& mipChain, BlockCompressionSettings const& settings = BlockCompressionSettings(), JobSystem* jobSystem = nullptr);
+void	DecompressImage(Image& out_image, CompressedImage const& compressedImage); // BC7 covers the single subset modes 4 to 6 this encoder writes, other modes decode to zero
+// -----------------------------------------------------------------------------
+float		ComputeImagePSNR(Image const& imageA, Image const& imageB, bool includeAlpha = false); // In dB, infinite for identical images
+// -----------------------------------------------------------------------------
@@ -2,6 +2,8 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include <filesystem>
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
 
 int FileReadToBuffer(std::vector<uint8_t>& outBuffer, std::string const& filename)
 {
@@ -95,6 +97,35 @@ int WriteBufferToFile(std::vector<uint8_t>& inBuffer, std::string const& filenam
 	return FILE_SUCCESS;
 }
 
+int WriteBufferToFileReplacing(std::vector<uint8_t> const& inBuffer, std::string const& filename)
+{
+	std::string tempFilename = filename + ".tmp";
+
+	FILE* file = nullptr;
+	if (fopen_s(&file, tempFilename.c_str(), "wb") != 0 || file == nullptr)
+	{
+		return FILE_OPEN_ERROR;
+	}
+
+	size_t writeBytes = fwrite(inBuffer.data(), 1, inBuffer.size(), file);
+	int closeResult = fclose(file);
+	if (writeBytes != inBuffer.size() || closeResult != 0)
+	{
+		std::filesystem::remove(tempFilename);
+		return FILE_WRITE_ERROR;
+	}
+
+	// Replaces any existing file in one step, a crash or a full disk leaves the old file or the temp file behind, never half a file
+	std::error_code renameError;
+	std::filesystem::rename(tempFilename, filename, renameError);
+	if (renameError)
+	{
+		std::filesystem::remove(tempFilename, renameError);
+		return FILE_WRITE_ERROR;
+	}
+	return FILE_SUCCESS;
+}
+
 bool DoesFileExist(std::string const& filename)
 {
 	return std::filesystem::exists(filename);
@@ -115,3 +146,105 @@ bool CreateFolder(std::string const& folderName)
 	return true;
 }
 
+bool OpenMappedFileView(MappedFileView& out_view, std::string const& filename)
+{
+	out_view = MappedFileView();
+
+	HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	// Empty files cannot be mapped
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle == nullptr)
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	void const* mappedData = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (mappedData == nullptr)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	out_view.m_data = mappedData;
+	out_view.m_size = static_cast<size_t>(fileSize.QuadPart);
+	out_view.m_fileHandle = fileHandle;
+	out_view.m_mappingHandle = mappingHandle;
+	return true;
+}
+
+void CloseMappedFileView(MappedFileView& view)
+{
+	if (view.m_data != nullptr)
+	{
+		UnmapViewOfFile(view.m_data);
+	}
+	if (view.m_mappingHandle != nullptr)
+	{
+		CloseHandle(view.m_mappingHandle);
+	}
+	if (view.m_fileHandle != nullptr)
+	{
+		CloseHandle(view.m_fileHandle);
+	}
+	view = MappedFileView();
+}
+
+bool GetFileTimestampAndSize(std::string const& filename, int64_t& out_lastWriteTime, uint64_t& out_fileSizeBytes)
+{
+	std::error_code errorCode;
+	std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(filename, errorCode);
+	if (errorCode)
+	{
+		return false;
+	}
+
+	uintmax_t fileSize = std::filesystem::file_size(filename, errorCode);
+	if (errorCode)
+	{
+		return false;
+	}
+
+	out_lastWriteTime = static_cast<int64_t>(lastWriteTime.time_since_epoch().count());
+	out_fileSizeBytes = static_cast<uint64_t>(fileSize);
+	return true;
+}
+
+bool GetFileContentHash(std::string const& filename, uint64_t& out_contentHash)
+{
+	MappedFileView fileView;
+	if (!OpenMappedFileView(fileView, filename))
+	{
+		return false;
+	}
+
+	out_contentHash = GetBufferHash(fileView.m_data, fileView.m_size);
+	CloseMappedFileView(fileView);
+	return true;
+}
+
+uint64_t GetBufferHash(void const* data, size_t numBytes, uint64_t seedHash)
+{
+	constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+	uint64_t hash = seedHash;
+	unsigned char const* bytes = static_cast<unsigned char const*>(data);
+	for (size_t byteIndex = 0; byteIndex < numBytes; ++byteIndex)
+	{
+		hash = (hash ^ bytes[byteIndex]) * FNV_PRIME;
+	}
+	return hash;
+}
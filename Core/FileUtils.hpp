@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <cstdint>
 // -----------------------------------------------------------------------------
 // Defining error constants for readability
 const int FILE_SUCCESS = 0;
@@ -13,7 +14,23 @@ const int FILE_WRITE_ERROR = 5;
 int FileReadToBuffer(std::vector<uint8_t>& outBuffer, std::string const& filename);
 int FileReadToString(std::string& out_string, std::string const& filename);
 int WriteBufferToFile(std::vector<uint8_t>& inBuffer, std::string const& filename);
+int WriteBufferToFileReplacing(std::vector<uint8_t> const& inBuffer, std::string const& filename); // Writes a temp file and renames it over filename, so readers never see a partial file. Fails quietly, for caches
 bool DoesFileExist(std::string const& filename);
 bool DoesFolderExist(std::string const& folderName);
 bool CreateFolder(std::string const& folderName);
+// -----------------------------------------------------------------------------
+// Read-only memory mapped view of a whole file, used by the binary asset caches.
+// Opening fails quietly since a missing cache file is expected, not an error.
+struct MappedFileView
+{
+	void const* m_data = nullptr;
+	size_t		m_size = 0;
+	void*		m_fileHandle = nullptr;
+	void*		m_mappingHandle = nullptr;
+};
+bool OpenMappedFileView(MappedFileView& out_view, std::string const& filename);
+void CloseMappedFileView(MappedFileView& view);
+bool GetFileTimestampAndSize(std::string const& filename, int64_t& out_lastWriteTime, uint64_t& out_fileSizeBytes);
+bool GetFileContentHash(std::string const& filename, uint64_t& out_contentHash); // 64 bit FNV-1a of the file bytes
+uint64_t GetBufferHash(void const* data, size_t numBytes, uint64_t seedHash = 14695981039346656037ull);
 // -----------------------------------------------------------------------------
\ No newline at end of file
@@ -3,44 +3,111 @@
 #include "Engine/Core/Image.hpp"
 #include "Engine/Core/Rgba8.h"
 #include "Engine/Core/EngineCommon.h"
-
-Image::Image()
+#include "Engine/Core/JobSystem.hpp"
+#include <tmmintrin.h>
+#include <cstring>
+// -----------------------------------------------------------------------------
+static_assert(sizeof(Rgba8) == 4, "Image texel copies assume Rgba8 is tightly packed RGBA");
+// -----------------------------------------------------------------------------
+static void CopyRGBRowToRGBA_SSSE3(Rgba8* out_texels, unsigned char const* sourceRow, int numTexels)
 {
+	// Four 3 byte texels per 16 byte load, the loop stops early enough that the load never reads past the row
+	__m128i const spreadRGB = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	__m128i const opaqueAlpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+	int texelIndex = 0;
+	for (; texelIndex + 6 <= numTexels; texelIndex += 4)
+	{
+		__m128i sourceBytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(sourceRow + texelIndex * 3));
+		__m128i texels = _mm_or_si128(_mm_shuffle_epi8(sourceBytes, spreadRGB), opaqueAlpha);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out_texels + texelIndex), texels);
+	}
+	for (; texelIndex < numTexels; ++texelIndex)
+	{
+		unsigned char const* sourceTexel = sourceRow + texelIndex * 3;
+		out_texels[texelIndex] = Rgba8(sourceTexel[0], sourceTexel[1], sourceTexel[2], 255);
+	}
 }
 
-Image::~Image()
+static void CopyGreyRowToRGBA_SSSE3(Rgba8* out_texels, unsigned char const* sourceRow, int numTexels)
 {
+	__m128i const spreadGrey = _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+	__m128i const opaqueAlpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+	int texelIndex = 0;
+	for (; texelIndex + 4 <= numTexels; texelIndex += 4)
+	{
+		int fourGreys = 0;
+		memcpy(&fourGreys, sourceRow + texelIndex, sizeof(fourGreys));
+		__m128i texels = _mm_or_si128(_mm_shuffle_epi8(_mm_cvtsi32_si128(fourGreys), spreadGrey), opaqueAlpha);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out_texels + texelIndex), texels);
+	}
+	for (; texelIndex < numTexels; ++texelIndex)
+	{
+		out_texels[texelIndex] = Rgba8(sourceRow[texelIndex], sourceRow[texelIndex], sourceRow[texelIndex], 255);
+	}
 }
 
-Image::Image(char const* imageFilePath)
-	:m_imageFilePath(imageFilePath)
+static void CopyTexelRow(Rgba8* out_texels, unsigned char const* sourceRow, int numTexels, int numComponents)
 {
-	int texelSizeX = 0;
-	int texelSizeY = 0;
-	int colorComponents = 0;
-
-	// Load the image and check if the image was loaded
-	stbi_set_flip_vertically_on_load(1);
-	unsigned char* imageData = stbi_load(imageFilePath, &texelSizeX, &texelSizeY, &colorComponents, STBI_rgb_alpha);
-	GUARANTEE_OR_DIE(imageData, Stringf("Failed to load image \"%s\"", imageFilePath));
-
-	// Set dimensions and resize vector
-	m_dimensions = IntVec2(texelSizeX, texelSizeY);
-	m_rgbaTexels.resize(texelSizeX * texelSizeY);
-
-	for (int y = 0; y < texelSizeY; ++y)
+	// The engine always builds with /arch:AVX2, so the SSSE3 expansions need no runtime check
+	switch (numComponents)
 	{
-		for (int x = 0; x < texelSizeX; ++x)
+		case 4:
+		{
+			// Already exactly our layout
+			memcpy(out_texels, sourceRow, numTexels * sizeof(Rgba8));
+			break;
+		}
+		case 3:
+		{
+			CopyRGBRowToRGBA_SSSE3(out_texels, sourceRow, numTexels);
+			break;
+		}
+		case 2:
+		{
+			for (int texelIndex = 0; texelIndex < numTexels; ++texelIndex)
+			{
+				unsigned char grey = sourceRow[texelIndex * 2];
+				out_texels[texelIndex] = Rgba8(grey, grey, grey, sourceRow[texelIndex * 2 + 1]);
+			}
+			break;
+		}
+		default:
 		{
-			int texelIndex = (y * texelSizeX + x) * 4;
-			unsigned char r = imageData[texelIndex];
-			unsigned char g = imageData[texelIndex + 1];
-			unsigned char b = imageData[texelIndex + 2];
-			unsigned char a = imageData[texelIndex + 3];
-			m_rgbaTexels[y * texelSizeX + x] = Rgba8(r, g, b, a);
+			CopyGreyRowToRGBA_SSSE3(out_texels, sourceRow, numTexels);
+			break;
 		}
 	}
-	stbi_image_free(imageData);
+}
+
+static void CopyTexelsFlipped(std::vector<Rgba8>& out_texels, unsigned char const* sourceData, IntVec2 const& dimensions, int numComponents)
+{
+	// Textures are bottom-up, so source row y lands on row (height - 1 - y)
+	out_texels.resize(static_cast<size_t>(dimensions.x) * dimensions.y);
+	size_t sourceRowBytes = static_cast<size_t>(dimensions.x) * numComponents;
+	for (int rowIndex = 0; rowIndex < dimensions.y; ++rowIndex)
+	{
+		Rgba8* destinationRow = out_texels.data() + static_cast<size_t>(dimensions.y - 1 - rowIndex) * dimensions.x;
+		CopyTexelRow(destinationRow, sourceData + rowIndex * sourceRowBytes, dimensions.x, numComponents);
+	}
+}
+// -----------------------------------------------------------------------------
+Rgba8* ImageView::GetRow(int rowIndex) const
+{
+	return m_texels + static_cast<size_t>(rowIndex) * m_rowStride;
+}
+// -----------------------------------------------------------------------------
+Image::Image()
+{
+}
+
+Image::~Image()
+{
+}
+
+Image::Image(char const* imageFilePath)
+{
+	bool didLoad = LoadFromFile(imageFilePath);
+	GUARANTEE_OR_DIE(didLoad, Stringf("Failed to load image \"%s\"", imageFilePath));
 }
 
 Image::Image(IntVec2 size, Rgba8 color)
@@ -50,6 +117,33 @@ Image::Image(IntVec2 size, Rgba8 color)
 	m_rgbaTexels.resize(numPixels, color);
 }
 
+Image::Image(IntVec2 const& dimensions, std::vector<Rgba8>&& rgbaTexels)
+	:m_dimensions(dimensions)
+	,m_rgbaTexels(std::move(rgbaTexels))
+{
+	GUARANTEE_OR_DIE(static_cast<int>(m_rgbaTexels.size()) == dimensions.x * dimensions.y, "Image texel count does not match its dimensions");
+}
+
+bool Image::LoadFromFile(char const* imageFilePath)
+{
+	m_imageFilePath = imageFilePath;
+
+	// Keep stb's native channel count and expand it ourselves while flipping, stb's global flip flag is not thread safe
+	int texelSizeX = 0;
+	int texelSizeY = 0;
+	int colorComponents = 0;
+	unsigned char* imageData = stbi_load(imageFilePath, &texelSizeX, &texelSizeY, &colorComponents, 0);
+	if (imageData == nullptr)
+	{
+		return false;
+	}
+
+	m_dimensions = IntVec2(texelSizeX, texelSizeY);
+	CopyTexelsFlipped(m_rgbaTexels, imageData, m_dimensions, colorComponents);
+	stbi_image_free(imageData);
+	return true;
+}
+
 std::string const& Image::GetImageFilePath() const
 {
 	return m_imageFilePath;
@@ -87,8 +181,65 @@ void Image::SetTexelColor(IntVec2 const& texelCoords, Rgba8 const& newColor)
 	SetTexelColor(texelCoords.x, texelCoords.y, newColor);
 }
 
+void Image::CopyTexelsFrom(Image const& sourceImage, IntVec2 const& destMins)
+{
+	IntVec2 sourceDimensions = sourceImage.GetDimensions();
+	GUARANTEE_OR_DIE(destMins.x >= 0 && destMins.y >= 0 && destMins.x + sourceDimensions.x <= m_dimensions.x && destMins.y + sourceDimensions.y <= m_dimensions.y, "Copied image does not fit inside the destination image");
+
+	size_t rowSizeBytes = static_cast<size_t>(sourceDimensions.x) * sizeof(Rgba8);
+	for (int rowIndex = 0; rowIndex < sourceDimensions.y; ++rowIndex)
+	{
+		Rgba8 const* sourceRow = &sourceImage.m_rgbaTexels[static_cast<size_t>(rowIndex) * sourceDimensions.x];
+		Rgba8* destRow = &m_rgbaTexels[static_cast<size_t>(destMins.y + rowIndex) * m_dimensions.x + destMins.x];
+		memcpy(destRow, sourceRow, rowSizeBytes);
+	}
+}
+
+Rgba8* Image::GetRowTexels(int rowIndex)
+{
+	return m_rgbaTexels.data() + static_cast<size_t>(rowIndex) * m_dimensions.x;
+}
 
+Rgba8 const* Image::GetRowTexels(int rowIndex) const
+{
+	return m_rgbaTexels.data() + static_cast<size_t>(rowIndex) * m_dimensions.x;
+}
 
+ImageView Image::GetView()
+{
+	return GetView(IntVec2(0, 0), m_dimensions);
+}
 
+ImageView Image::GetView(IntVec2 const& mins, IntVec2 const& dimensions)
+{
+	GUARANTEE_OR_DIE(mins.x >= 0 && mins.y >= 0 && dimensions.x >= 0 && dimensions.y >= 0 && mins.x + dimensions.x <= m_dimensions.x && mins.y + dimensions.y <= m_dimensions.y,
+		Stringf("Image view does not fit inside image \"%s\"", m_imageFilePath.c_str()));
+
+	ImageView view;
+	view.m_texels = m_rgbaTexels.data() + static_cast<size_t>(mins.y) * m_dimensions.x + mins.x;
+	view.m_dimensions = dimensions;
+	view.m_rowStride = m_dimensions.x;
+	return view;
+}
+// -----------------------------------------------------------------------------
+void LoadImagesParallel(JobSystem& jobSystem, std::vector<std::string> const& imageFilePaths, std::vector<Image>& out_images)
+{
+	int numImages = static_cast<int>(imageFilePaths.size());
+	out_images.clear();
+	out_images.resize(numImages);
+	std::vector<char> didLoad(numImages, 0);
 
+	// One image per job, decode cost varies far too much between files to batch them
+	jobSystem.ExecuteParallelFor(numImages, 1, [&](int startIndex, int endIndex)
+	{
+		for (int imageIndex = startIndex; imageIndex < endIndex; ++imageIndex)
+		{
+			didLoad[imageIndex] = out_images[imageIndex].LoadFromFile(imageFilePaths[imageIndex].c_str()) ? 1 : 0;
+		}
+	});
 
+	for (int imageIndex = 0; imageIndex < numImages; ++imageIndex)
+	{
+		GUARANTEE_OR_DIE(didLoad[imageIndex] != 0, Stringf("Failed to load image \"%s\"", imageFilePaths[imageIndex].c_str()));
+	}
+}
@@ -4,6 +4,18 @@
 #include <vector>
 // -----------------------------------------------------------------------------
 struct Rgba8;
+class JobSystem;
+// -----------------------------------------------------------------------------
+// A rectangle of some Image's texels, rows are m_rowStride texels apart. Does not own the texels and
+// is only valid while the image it came from keeps its size.
+struct ImageView
+{
+	Rgba8*	m_texels = nullptr;				// Bottom left texel of the rectangle
+	IntVec2 m_dimensions = IntVec2(0, 0);
+	int		m_rowStride = 0;
+
+	Rgba8* GetRow(int rowIndex) const;
+};
 // -----------------------------------------------------------------------------
 class Image
 {
@@ -12,6 +24,13 @@ public:
 	~Image();
 	Image(char const* imageFilePath);
 	Image(IntVec2 size, Rgba8 color);
+	Image(IntVec2 const& dimensions, std::vector<Rgba8>&& rgbaTexels); // Adopts the texels without copying them
+	Image(Image const& copyFrom) = default;
+	Image(Image&& moveFrom) = default;
+	Image& operator=(Image const& copyFrom) = default;
+	Image& operator=(Image&& moveFrom) = default;
+
+	bool			   LoadFromFile(char const* imageFilePath); // Returns false instead of dying, safe to call from job threads
 
 	std::string const& GetImageFilePath() const;
 	IntVec2			   GetDimensions() const;
@@ -21,9 +40,18 @@ public:
 	Rgba8			   GetTexelColor(IntVec2 const& texelCoords) const;
 	void			   SetTexelColor(int texelX, int texelY, Rgba8 const& newColor);
 	void			   SetTexelColor(IntVec2 const& texelCoords, Rgba8 const& newColor);
+	void			   CopyTexelsFrom(Image const& sourceImage, IntVec2 const& destMins); // Row copies the whole source in, it must fit
+
+	Rgba8*			   GetRowTexels(int rowIndex); // Row 0 is the bottom, each row is GetDimensions().x tightly packed texels
+	Rgba8 const*	   GetRowTexels(int rowIndex) const;
+	ImageView		   GetView();
+	ImageView		   GetView(IntVec2 const& mins, IntVec2 const& dimensions); // Must lie inside the image
 
 private:
 	std::string			 m_imageFilePath;
 	IntVec2				 m_dimensions = IntVec2(0, 0);
 	std::vector<Rgba8>   m_rgbaTexels;  
 };
+// -----------------------------------------------------------------------------
+void		LoadImagesParallel(JobSystem& jobSystem, std::vector<std::string> const& imageFilePaths, std::vector<Image>& out_images); // Decodes every file across the job system, dies on any that fail
+// -----------------------------------------------------------------------------
@@ -0,0 +1,389 @@
+#include "Engine/Core/ImageKernels.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/MathUtils.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr float IMAGE_KERNEL_PI = 3.14159265358979f;
+// -----------------------------------------------------------------------------
+// How one axis of the destination samples the source, m_numTaps source texels per destination texel
+// with their indexes already clamped to the edge and their weights summing to 1.
+struct ResampleAxis
+{
+	int				   m_numTaps = 0;
+	std::vector<int>   m_sourceIndexes;
+	std::vector<float> m_weights;
+};
+// -----------------------------------------------------------------------------
+static float EvaluateResizeFilter(ImageResizeFilter filter, float distance)
+{
+	distance = fabsf(distance);
+	if (filter == ImageResizeFilter::BILINEAR)
+	{
+		return std::max(0.f, 1.f - distance);
+	}
+
+	if (distance < 1e-5f)
+	{
+		return 1.f;
+	}
+	if (distance >= 3.f)
+	{
+		return 0.f;
+	}
+	float piDistance = IMAGE_KERNEL_PI * distance;
+	return 3.f * sinf(piDistance) * sinf(piDistance / 3.f) / (piDistance * piDistance);
+}
+
+static void NormalizeResampleAxis(ResampleAxis& axis, int numDestTexels)
+{
+	for (int destIndex = 0; destIndex < numDestTexels; ++destIndex)
+	{
+		float* weights = &axis.m_weights[static_cast<size_t>(destIndex) * axis.m_numTaps];
+		float weightSum = 0.f;
+		for (int tapIndex = 0; tapIndex < axis.m_numTaps; ++tapIndex)
+		{
+			weightSum += weights[tapIndex];
+		}
+		float inverseSum = weightSum != 0.f ? 1.f / weightSum : 0.f;
+		for (int tapIndex = 0; tapIndex < axis.m_numTaps; ++tapIndex)
+		{
+			weights[tapIndex] *= inverseSum;
+		}
+	}
+}
+
+static ResampleAxis MakeResizeAxis(int sourceSize, int destSize, ImageResizeFilter filter)
+{
+	// Shrinking stretches the filter over the source so no texel is skipped
+	float sourcePerDest = static_cast<float>(sourceSize) / static_cast<float>(destSize);
+	float filterScale = std::max(1.f, sourcePerDest);
+	float support = (filter == ImageResizeFilter::BILINEAR ? 1.f : 3.f) * filterScale;
+
+	ResampleAxis axis;
+	axis.m_numTaps = static_cast<int>(ceilf(support * 2.f)) + 1;
+	axis.m_sourceIndexes.resize(static_cast<size_t>(destSize) * axis.m_numTaps);
+	axis.m_weights.resize(static_cast<size_t>(destSize) * axis.m_numTaps);
+	for (int destIndex = 0; destIndex < destSize; ++destIndex)
+	{
+		float sourceCenter = (static_cast<float>(destIndex) + 0.5f) * sourcePerDest - 0.5f;
+		int firstSource = static_cast<int>(floorf(sourceCenter - support));
+		for (int tapIndex = 0; tapIndex < axis.m_numTaps; ++tapIndex)
+		{
+			int sourceIndex = firstSource + tapIndex;
+			size_t tableIndex = static_cast<size_t>(destIndex) * axis.m_numTaps + tapIndex;
+			axis.m_sourceIndexes[tableIndex] = GetClamped(sourceIndex, 0, sourceSize - 1);
+			axis.m_weights[tableIndex] = EvaluateResizeFilter(filter, (static_cast<float>(sourceIndex) - sourceCenter) / filterScale);
+		}
+	}
+	NormalizeResampleAxis(axis, destSize);
+	return axis;
+}
+
+static ResampleAxis MakeGaussianAxis(int size, float sigma)
+{
+	int radius = std::max(1, static_cast<int>(ceilf(sigma * 3.f)));
+	ResampleAxis axis;
+	axis.m_numTaps = radius * 2 + 1;
+	axis.m_sourceIndexes.resize(static_cast<size_t>(size) * axis.m_numTaps);
+	axis.m_weights.resize(static_cast<size_t>(size) * axis.m_numTaps);
+	for (int destIndex = 0; destIndex < size; ++destIndex)
+	{
+		for (int tapIndex = 0; tapIndex < axis.m_numTaps; ++tapIndex)
+		{
+			float offset = static_cast<float>(tapIndex - radius);
+			size_t tableIndex = static_cast<size_t>(destIndex) * axis.m_numTaps + tapIndex;
+			axis.m_sourceIndexes[tableIndex] = GetClamped(destIndex + tapIndex - radius, 0, size - 1);
+			axis.m_weights[tableIndex] = expf(-(offset * offset) / (2.f * sigma * sigma));
+		}
+	}
+	NormalizeResampleAxis(axis, size);
+	return axis;
+}
+// -----------------------------------------------------------------------------
+static void DecodeRow(float* out_row, Rgba8 const* sourceRow, int width)
+{
+	// Four texels per iteration, bytes widened to ints and converted
+	__m128i const zero = _mm_setzero_si128();
+	int texelIndex = 0;
+	for (; texelIndex + 4 <= width; texelIndex += 4)
+	{
+		__m128i texels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(sourceRow + texelIndex));
+		__m128i lowWords = _mm_unpacklo_epi8(texels, zero);
+		__m128i highWords = _mm_unpackhi_epi8(texels, zero);
+		_mm_storeu_ps(out_row + texelIndex * 4, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lowWords, zero)));
+		_mm_storeu_ps(out_row + texelIndex * 4 + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lowWords, zero)));
+		_mm_storeu_ps(out_row + texelIndex * 4 + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(highWords, zero)));
+		_mm_storeu_ps(out_row + texelIndex * 4 + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(highWords, zero)));
+	}
+	for (; texelIndex < width; ++texelIndex)
+	{
+		out_row[texelIndex * 4] = static_cast<float>(sourceRow[texelIndex].r);
+		out_row[texelIndex * 4 + 1] = static_cast<float>(sourceRow[texelIndex].g);
+		out_row[texelIndex * 4 + 2] = static_cast<float>(sourceRow[texelIndex].b);
+		out_row[texelIndex * 4 + 3] = static_cast<float>(sourceRow[texelIndex].a);
+	}
+}
+
+static void EncodeRow(Rgba8* out_row, float const* sourceRow, int width)
+{
+	// The saturating packs clamp Lanczos overshoot to 0..255 for free
+	int texelIndex = 0;
+	for (; texelIndex + 4 <= width; texelIndex += 4)
+	{
+		__m128i texel0 = _mm_cvtps_epi32(_mm_loadu_ps(sourceRow + texelIndex * 4));
+		__m128i texel1 = _mm_cvtps_epi32(_mm_loadu_ps(sourceRow + texelIndex * 4 + 4));
+		__m128i texel2 = _mm_cvtps_epi32(_mm_loadu_ps(sourceRow + texelIndex * 4 + 8));
+		__m128i texel3 = _mm_cvtps_epi32(_mm_loadu_ps(sourceRow + texelIndex * 4 + 12));
+		__m128i packed = _mm_packus_epi16(_mm_packs_epi32(texel0, texel1), _mm_packs_epi32(texel2, texel3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out_row + texelIndex), packed);
+	}
+	for (; texelIndex < width; ++texelIndex)
+	{
+		__m128i texel = _mm_cvtps_epi32(_mm_loadu_ps(sourceRow + texelIndex * 4));
+		__m128i packed = _mm_packus_epi16(_mm_packs_epi32(texel, texel), texel);
+		int packedTexel = _mm_cvtsi128_si32(packed);
+		memcpy(out_row + texelIndex, &packedTexel, sizeof(Rgba8));
+	}
+}
+
+static void FilterRowHorizontal(float* out_row, float const* sourceRow, int destWidth, ResampleAxis const& axis)
+{
+	// One RGBA texel per SSE register
+	for (int destIndex = 0; destIndex < destWidth; ++destIndex)
+	{
+		int const* sourceIndexes = &axis.m_sourceIndexes[static_cast<size_t>(destIndex) * axis.m_numTaps];
+		float const* weights = &axis.m_weights[static_cast<size_t>(destIndex) * axis.m_numTaps];
+		__m128 sum = _mm_setzero_ps();
+		for (int tapIndex = 0; tapIndex < axis.m_numTaps; ++tapIndex)
+		{
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tapIndex]), _mm_loadu_ps(sourceRow + sourceIndexes[tapIndex] * 4)));
+		}
+		_mm_storeu_ps(out_row + destIndex * 4, sum);
+	}
+}
+
+static void FilterRowsVertical_AVX(float* out_row, float const* const* tapRows, float const* weights, int numTaps, int numFloats, int& out_floatsDone)
+{
+	int floatIndex = 0;
+	for (; floatIndex + 8 <= numFloats; floatIndex += 8)
+	{
+		__m256 sum = _mm256_setzero_ps();
+		for (int tapIndex = 0; tapIndex < numTaps; ++tapIndex)
+		{
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(weights[tapIndex]), _mm256_loadu_ps(tapRows[tapIndex] + floatIndex)));
+		}
+		_mm256_storeu_ps(out_row + floatIndex, sum);
+	}
+	_mm256_zeroupper();
+	out_floatsDone = floatIndex;
+}
+
+static void FilterRowsVertical(float* out_row, float const* const* tapRows, float const* weights, int numTaps, int numFloats)
+{
+	int floatIndex = 0;
+	FilterRowsVertical_AVX(out_row, tapRows, weights, numTaps, numFloats, floatIndex);
+	for (; floatIndex < numFloats; floatIndex += 4)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for (int tapIndex = 0; tapIndex < numTaps; ++tapIndex)
+		{
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tapIndex]), _mm_loadu_ps(tapRows[tapIndex] + floatIndex)));
+		}
+		_mm_storeu_ps(out_row + floatIndex, sum);
+	}
+}
+
+static void ResampleRows(Image& out_image, Image const& sourceImage, ResampleAxis const& horizontalAxis, ResampleAxis const& verticalAxis, int startRow, int endRow)
+{
+	IntVec2 sourceDims = sourceImage.GetDimensions();
+	IntVec2 destDims = out_image.GetDimensions();
+	int destFloatsPerRow = destDims.x * 4;
+
+	// Every source row the tile touches is decoded and horizontally filtered once, then shared by the destination rows that need it
+	int firstSourceRow = sourceDims.y;
+	int lastSourceRow = -1;
+	for (size_t tableIndex = static_cast<size_t>(startRow) * verticalAxis.m_numTaps; tableIndex < static_cast<size_t>(endRow) * verticalAxis.m_numTaps; ++tableIndex)
+	{
+		firstSourceRow = std::min(firstSourceRow, verticalAxis.m_sourceIndexes[tableIndex]);
+		lastSourceRow = std::max(lastSourceRow, verticalAxis.m_sourceIndexes[tableIndex]);
+	}
+	int numTileRows = lastSourceRow - firstSourceRow + 1;
+	std::vector<float> decodedRow(static_cast<size_t>(sourceDims.x) * 4);
+	std::vector<float> filteredRows(static_cast<size_t>(numTileRows) * destFloatsPerRow);
+	for (int tileRow = 0; tileRow < numTileRows; ++tileRow)
+	{
+		DecodeRow(decodedRow.data(), sourceImage.GetRowTexels(firstSourceRow + tileRow), sourceDims.x);
+		FilterRowHorizontal(&filteredRows[static_cast<size_t>(tileRow) * destFloatsPerRow], decodedRow.data(), destDims.x, horizontalAxis);
+	}
+
+	std::vector<float> destRow(destFloatsPerRow);
+	std::vector<float const*> tapRows(verticalAxis.m_numTaps);
+	for (int destRowIndex = startRow; destRowIndex < endRow; ++destRowIndex)
+	{
+		size_t tableStart = static_cast<size_t>(destRowIndex) * verticalAxis.m_numTaps;
+		for (int tapIndex = 0; tapIndex < verticalAxis.m_numTaps; ++tapIndex)
+		{
+			int tileRow = verticalAxis.m_sourceIndexes[tableStart + tapIndex] - firstSourceRow;
+			tapRows[tapIndex] = &filteredRows[static_cast<size_t>(tileRow) * destFloatsPerRow];
+		}
+		FilterRowsVertical(destRow.data(), tapRows.data(), &verticalAxis.m_weights[tableStart], verticalAxis.m_numTaps, destFloatsPerRow);
+		EncodeRow(out_image.GetRowTexels(destRowIndex), destRow.data(), destDims.x);
+	}
+}
+
+static void ForEachRowTile(int numRows, JobSystem* jobSystem, std::function<void(int, int)> const& rowFunction)
+{
+	int numTiles = (numRows + IMAGE_KERNEL_ROWS_PER_TILE - 1) / IMAGE_KERNEL_ROWS_PER_TILE;
+	auto tileFunction = [&](int startTile, int endTile)
+	{
+		rowFunction(startTile * IMAGE_KERNEL_ROWS_PER_TILE, std::min(endTile * IMAGE_KERNEL_ROWS_PER_TILE, numRows));
+	};
+
+	if (jobSystem != nullptr)
+	{
+		jobSystem->ExecuteParallelFor(numTiles, 1, tileFunction);
+	}
+	else
+	{
+		tileFunction(0, numTiles);
+	}
+}
+
+static void ResampleImage(Image& out_image, Image const& sourceImage, IntVec2 const& destDims, ResampleAxis const& horizontalAxis, ResampleAxis const& verticalAxis, JobSystem* jobSystem)
+{
+	Image destImage(destDims, Rgba8(0, 0, 0, 0));
+	ForEachRowTile(destDims.y, jobSystem, [&](int startRow, int endRow)
+	{
+		ResampleRows(destImage, sourceImage, horizontalAxis, verticalAxis, startRow, endRow);
+	});
+	out_image = std::move(destImage);
+}
+// -----------------------------------------------------------------------------
+static void SwizzleRow_SSSE3(Rgba8* inout_row, int numTexels, __m128i const& shuffleMask, __m128i const& onesMask)
+{
+	int texelIndex = 0;
+	for (; texelIndex + 4 <= numTexels; texelIndex += 4)
+	{
+		__m128i* texels = reinterpret_cast<__m128i*>(inout_row + texelIndex);
+		__m128i swizzled = _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(texels), shuffleMask), onesMask);
+		_mm_storeu_si128(texels, swizzled);
+	}
+	for (; texelIndex < numTexels; ++texelIndex)
+	{
+		// Same shuffle on a single texel, through a register so the tail needs no scalar special cases
+		int texelBits = 0;
+		memcpy(&texelBits, inout_row + texelIndex, sizeof(Rgba8));
+		__m128i swizzled = _mm_or_si128(_mm_shuffle_epi8(_mm_cvtsi32_si128(texelBits), shuffleMask), onesMask);
+		texelBits = _mm_cvtsi128_si32(swizzled);
+		memcpy(inout_row + texelIndex, &texelBits, sizeof(Rgba8));
+	}
+}
+
+static void PremultiplyRow(Rgba8* inout_row, int numTexels)
+{
+	// Two texels per 16 bit lane group: t = c * a + 128, result = (t + (t >> 8)) >> 8, which is an exact rounded divide by 255
+	__m128i const zero = _mm_setzero_si128();
+	__m128i const roundingBias = _mm_set1_epi16(128);
+	__m128i const alphaBytes = _mm_set1_epi32(static_cast<int>(0xFF000000));
+	int texelIndex = 0;
+	for (; texelIndex + 4 <= numTexels; texelIndex += 4)
+	{
+		__m128i* texelPointer = reinterpret_cast<__m128i*>(inout_row + texelIndex);
+		__m128i texels = _mm_loadu_si128(texelPointer);
+		__m128i halves[2] = { _mm_unpacklo_epi8(texels, zero), _mm_unpackhi_epi8(texels, zero) };
+		for (int halfIndex = 0; halfIndex < 2; ++halfIndex)
+		{
+			__m128i alphas = _mm_shufflehi_epi16(_mm_shufflelo_epi16(halves[halfIndex], _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m128i products = _mm_add_epi16(_mm_mullo_epi16(halves[halfIndex], alphas), roundingBias);
+			halves[halfIndex] = _mm_srli_epi16(_mm_add_epi16(products, _mm_srli_epi16(products, 8)), 8);
+		}
+		__m128i premultiplied = _mm_packus_epi16(halves[0], halves[1]);
+		premultiplied = _mm_or_si128(_mm_andnot_si128(alphaBytes, premultiplied), _mm_and_si128(alphaBytes, texels));
+		_mm_storeu_si128(texelPointer, premultiplied);
+	}
+	for (; texelIndex < numTexels; ++texelIndex)
+	{
+		Rgba8& texel = inout_row[texelIndex];
+		int alpha = texel.a;
+		texel.r = static_cast<unsigned char>((texel.r * alpha + 127) / 255);
+		texel.g = static_cast<unsigned char>((texel.g * alpha + 127) / 255);
+		texel.b = static_cast<unsigned char>((texel.b * alpha + 127) / 255);
+	}
+}
+// -----------------------------------------------------------------------------
+void ResizeImage(Image& out_image, Image const& sourceImage, IntVec2 const& newDimensions, ImageResizeFilter filter, JobSystem* jobSystem)
+{
+	IntVec2 sourceDims = sourceImage.GetDimensions();
+	GUARANTEE_OR_DIE(sourceDims.x > 0 && sourceDims.y > 0 && newDimensions.x > 0 && newDimensions.y > 0,
+		Stringf("Cannot resize image \"%s\" from %dx%d to %dx%d", sourceImage.GetImageFilePath().c_str(), sourceDims.x, sourceDims.y, newDimensions.x, newDimensions.y));
+
+	ResampleAxis horizontalAxis = MakeResizeAxis(sourceDims.x, newDimensions.x, filter);
+	ResampleAxis verticalAxis = MakeResizeAxis(sourceDims.y, newDimensions.y, filter);
+	ResampleImage(out_image, sourceImage, newDimensions, horizontalAxis, verticalAxis, jobSystem);
+}
+
+void BlurImage(Image& out_image, Image const& sourceImage, float sigmaTexels, JobSystem* jobSystem)
+{
+	IntVec2 dims = sourceImage.GetDimensions();
+	if (sigmaTexels <= 0.f || dims.x == 0 || dims.y == 0)
+	{
+		out_image = sourceImage;
+		return;
+	}
+
+	ResampleAxis horizontalAxis = MakeGaussianAxis(dims.x, sigmaTexels);
+	ResampleAxis verticalAxis = MakeGaussianAxis(dims.y, sigmaTexels);
+	ResampleImage(out_image, sourceImage, dims, horizontalAxis, verticalAxis, jobSystem);
+}
+
+void SwizzleImageChannels(ImageView const& view, ImageChannel redSource, ImageChannel greenSource, ImageChannel blueSource, ImageChannel alphaSource, JobSystem* jobSystem)
+{
+	// Byte 0x80 in a shuffle mask writes zero, ONE is then ORed in
+	ImageChannel const sources[4] = { redSource, greenSource, blueSource, alphaSource };
+	alignas(16) unsigned char shuffleBytes[16];
+	alignas(16) unsigned char onesBytes[16];
+	for (int byteIndex = 0; byteIndex < 16; ++byteIndex)
+	{
+		ImageChannel source = sources[byteIndex & 3];
+		bool isChannel = source <= ImageChannel::ALPHA;
+		shuffleBytes[byteIndex] = isChannel ? static_cast<unsigned char>((byteIndex & ~3) + static_cast<int>(source)) : 0x80;
+		onesBytes[byteIndex] = source == ImageChannel::ONE ? 0xFF : 0x00;
+	}
+	__m128i shuffleMask = _mm_load_si128(reinterpret_cast<__m128i const*>(shuffleBytes));
+	__m128i onesMask = _mm_load_si128(reinterpret_cast<__m128i const*>(onesBytes));
+	ForEachRowTile(view.m_dimensions.y, jobSystem, [&](int startRow, int endRow)
+	{
+		for (int rowIndex = startRow; rowIndex < endRow; ++rowIndex)
+		{
+			SwizzleRow_SSSE3(view.GetRow(rowIndex), view.m_dimensions.x, shuffleMask, onesMask);
+		}
+	});
+}
+
+void SwizzleImageChannels(Image& image, ImageChannel redSource, ImageChannel greenSource, ImageChannel blueSource, ImageChannel alphaSource, JobSystem* jobSystem)
+{
+	SwizzleImageChannels(image.GetView(), redSource, greenSource, blueSource, alphaSource, jobSystem);
+}
+
+void PremultiplyImageAlpha(ImageView const& view, JobSystem* jobSystem)
+{
+	ForEachRowTile(view.m_dimensions.y, jobSystem, [&](int startRow, int endRow)
+	{
+		for (int rowIndex = startRow; rowIndex < endRow; ++rowIndex)
+		{
+			PremultiplyRow(view.GetRow(rowIndex), view.m_dimensions.x);
+		}
+	});
+}
+
+void PremultiplyImageAlpha(Image& image, JobSystem* jobSystem)
+{
+	PremultiplyImageAlpha(image.GetView(), jobSystem);
+}
+// -----------------------------------------------------------------------------
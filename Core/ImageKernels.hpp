@@ -0,0 +1,36 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+// -----------------------------------------------------------------------------
+class JobSystem;
+// -----------------------------------------------------------------------------
+constexpr int IMAGE_KERNEL_ROWS_PER_TILE = 32;
+// -----------------------------------------------------------------------------
+enum class ImageResizeFilter
+{
+	BILINEAR,	// Tent filter, widened when shrinking so every source texel still counts
+	LANCZOS3,	// Sharper, with slight ringing at hard edges
+	COUNT
+};
+// -----------------------------------------------------------------------------
+enum class ImageChannel
+{
+	RED,
+	GREEN,
+	BLUE,
+	ALPHA,
+	ZERO,
+	ONE,		// 255
+	COUNT
+};
+// -----------------------------------------------------------------------------
+// Filters work on the stored 8 bit values as they are, which is what heightmaps and masks want. Resize and blur
+// run a separable SSE horizontal pass and an AVX vertical pass over tiles of destination rows, and the
+// tiles are spread over the job system when one is given. The in place kernels take a view so they can work on
+// part of an image, the Image overloads cover all of it.
+void ResizeImage(Image& out_image, Image const& sourceImage, IntVec2 const& newDimensions, ImageResizeFilter filter = ImageResizeFilter::BILINEAR, JobSystem* jobSystem = nullptr);
+void BlurImage(Image& out_image, Image const& sourceImage, float sigmaTexels, JobSystem* jobSystem = nullptr); // Gaussian, edges clamp
+void SwizzleImageChannels(ImageView const& view, ImageChannel redSource, ImageChannel greenSource, ImageChannel blueSource, ImageChannel alphaSource, JobSystem* jobSystem = nullptr);
+void SwizzleImageChannels(Image& image, ImageChannel redSource, ImageChannel greenSource, ImageChannel blueSource, ImageChannel alphaSource, JobSystem* jobSystem = nullptr);
+void PremultiplyImageAlpha(ImageView const& view, JobSystem* jobSystem = nullptr); // Rounds exactly like (color * alpha + 127) / 255
+void PremultiplyImageAlpha(Image& image, JobSystem* jobSystem = nullptr);
+// -----------------------------------------------------------------------------
@@ -0,0 +1,302 @@
+#include "Engine/Core/ImageMips.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/MathUtils.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+// -----------------------------------------------------------------------------
+constexpr int IMAGE_MIP_MAX_TAPS = 8;
+constexpr int LINEAR_TO_SRGB_TABLE_SIZE = 65536;
+// -----------------------------------------------------------------------------
+struct MipFilterKernel
+{
+	// Destination texel x reads source texels 2x + m_firstTapOffset onward, the same in both directions
+	int	  m_firstTapOffset = 0;
+	int	  m_numTaps = 0;
+	float m_weights[IMAGE_MIP_MAX_TAPS] = {};
+};
+// -----------------------------------------------------------------------------
+struct ColorConversionTables
+{
+	ColorConversionTables();
+
+	float		  m_unormToFloat[256];
+	float		  m_srgbToLinear[256];
+	unsigned char m_linearToSRGB[LINEAR_TO_SRGB_TABLE_SIZE]; // Indexed by linear * 65535, fine enough that no two sRGB codes share a slot
+};
+// -----------------------------------------------------------------------------
+ColorConversionTables::ColorConversionTables()
+{
+	for (int byteValue = 0; byteValue < 256; ++byteValue)
+	{
+		double encoded = static_cast<double>(byteValue) / 255.0;
+		m_unormToFloat[byteValue] = static_cast<float>(encoded);
+		m_srgbToLinear[byteValue] = static_cast<float>((encoded <= 0.04045) ? encoded / 12.92 : pow((encoded + 0.055) / 1.055, 2.4));
+	}
+
+	for (int tableIndex = 0; tableIndex < LINEAR_TO_SRGB_TABLE_SIZE; ++tableIndex)
+	{
+		double linear = static_cast<double>(tableIndex) / static_cast<double>(LINEAR_TO_SRGB_TABLE_SIZE - 1);
+		double encoded = (linear <= 0.0031308) ? linear * 12.92 : 1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+		m_linearToSRGB[tableIndex] = static_cast<unsigned char>(GetClamped(static_cast<int>(encoded * 255.0 + 0.5), 0, 255));
+	}
+}
+// -----------------------------------------------------------------------------
+static ColorConversionTables const& GetColorConversionTables()
+{
+	static ColorConversionTables const s_tables;
+	return s_tables;
+}
+
+static double GetBesselI0(double x)
+{
+	// Power series, converges quickly for the small arguments a Kaiser window uses
+	double sum = 1.0;
+	double term = 1.0;
+	double halfXSquared = (x * 0.5) * (x * 0.5);
+	for (int k = 1; k < 32 && term > 1e-12 * sum; ++k)
+	{
+		term *= halfXSquared / static_cast<double>(k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static MipFilterKernel MakeMipFilterKernel(ImageMipSettings const& settings)
+{
+	MipFilterKernel kernel;
+	if (settings.m_filter == ImageMipFilter::BOX)
+	{
+		kernel.m_firstTapOffset = 0;
+		kernel.m_numTaps = 2;
+		kernel.m_weights[0] = 0.5f;
+		kernel.m_weights[1] = 0.5f;
+		return kernel;
+	}
+
+	// Sinc at the destination rate, windowed over two destination texels either side of the center
+	constexpr double KAISER_RADIUS = 2.0;
+	kernel.m_firstTapOffset = -3;
+	kernel.m_numTaps = IMAGE_MIP_MAX_TAPS;
+	double alpha = static_cast<double>(settings.m_kaiserAlpha);
+	double weightSum = 0.0;
+	double weights[IMAGE_MIP_MAX_TAPS] = {};
+	for (int tapIndex = 0; tapIndex < kernel.m_numTaps; ++tapIndex)
+	{
+		double sourceOffset = static_cast<double>(kernel.m_firstTapOffset + tapIndex) + 0.5 - 1.0;
+		double destOffset = sourceOffset * 0.5;
+		double sinc = (destOffset == 0.0) ? 1.0 : sin(3.14159265358979323846 * destOffset) / (3.14159265358979323846 * destOffset);
+		double windowPosition = destOffset / KAISER_RADIUS;
+		double window = GetBesselI0(alpha * sqrt(std::max(0.0, 1.0 - windowPosition * windowPosition))) / GetBesselI0(alpha);
+		weights[tapIndex] = sinc * window;
+		weightSum += weights[tapIndex];
+	}
+	for (int tapIndex = 0; tapIndex < kernel.m_numTaps; ++tapIndex)
+	{
+		kernel.m_weights[tapIndex] = static_cast<float>(weights[tapIndex] / weightSum);
+	}
+	return kernel;
+}
+
+static void DecodeRow(float* out_row, Rgba8 const* sourceRow, int width, bool isSRGB, ColorConversionTables const& tables)
+{
+	float const* colorTable = isSRGB ? tables.m_srgbToLinear : tables.m_unormToFloat;
+	for (int texelIndex = 0; texelIndex < width; ++texelIndex)
+	{
+		Rgba8 const& texel = sourceRow[texelIndex];
+		out_row[texelIndex * 4] = colorTable[texel.r];
+		out_row[texelIndex * 4 + 1] = colorTable[texel.g];
+		out_row[texelIndex * 4 + 2] = colorTable[texel.b];
+		out_row[texelIndex * 4 + 3] = tables.m_unormToFloat[texel.a];
+	}
+}
+
+static void EncodeRow(Rgba8* out_row, float const* sourceRow, int width, bool isSRGB, ColorConversionTables const& tables)
+{
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const one = _mm_set1_ps(1.f);
+	__m128 const scale = isSRGB ? _mm_setr_ps(65535.f, 65535.f, 65535.f, 255.f) : _mm_set1_ps(255.f);
+	alignas(16) int quantized[4];
+	for (int texelIndex = 0; texelIndex < width; ++texelIndex)
+	{
+		// Kaiser lobes can overshoot, so clamp before quantizing
+		__m128 texel = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(sourceRow + texelIndex * 4), zero), one);
+		_mm_store_si128(reinterpret_cast<__m128i*>(quantized), _mm_cvtps_epi32(_mm_mul_ps(texel, scale)));
+		if (isSRGB)
+		{
+			out_row[texelIndex] = Rgba8(tables.m_linearToSRGB[quantized[0]], tables.m_linearToSRGB[quantized[1]], tables.m_linearToSRGB[quantized[2]],
+				static_cast<unsigned char>(quantized[3]));
+		}
+		else
+		{
+			out_row[texelIndex] = Rgba8(static_cast<unsigned char>(quantized[0]), static_cast<unsigned char>(quantized[1]),
+				static_cast<unsigned char>(quantized[2]), static_cast<unsigned char>(quantized[3]));
+		}
+	}
+}
+
+static void FilterBoxRowHorizontal_AVX(float* out_row, float const* sourceRow, int destWidth, int& out_texelsDone)
+{
+	// Two destination texels per iteration: [s0 s1] [s2 s3] -> [s0 s2] + [s1 s3]
+	__m256 const half = _mm256_set1_ps(0.5f);
+	int destIndex = 0;
+	for (; destIndex + 2 <= destWidth; destIndex += 2)
+	{
+		__m256 sourceA = _mm256_loadu_ps(sourceRow + destIndex * 8);
+		__m256 sourceB = _mm256_loadu_ps(sourceRow + destIndex * 8 + 8);
+		__m256 evenTexels = _mm256_permute2f128_ps(sourceA, sourceB, 0x20);
+		__m256 oddTexels = _mm256_permute2f128_ps(sourceA, sourceB, 0x31);
+		_mm256_storeu_ps(out_row + destIndex * 4, _mm256_mul_ps(_mm256_add_ps(evenTexels, oddTexels), half));
+	}
+	_mm256_zeroupper();
+	out_texelsDone = destIndex;
+}
+
+static void FilterRowHorizontal(float* out_row, float const* sourceRow, int sourceWidth, int destWidth, MipFilterKernel const& kernel)
+{
+	int destIndex = 0;
+	if (kernel.m_numTaps == 2 && kernel.m_firstTapOffset == 0)
+	{
+		FilterBoxRowHorizontal_AVX(out_row, sourceRow, destWidth, destIndex);
+	}
+
+	// One RGBA texel per SSE register, taps past either edge clamp to it
+	for (; destIndex < destWidth; ++destIndex)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for (int tapIndex = 0; tapIndex < kernel.m_numTaps; ++tapIndex)
+		{
+			int sourceIndex = GetClamped(destIndex * 2 + kernel.m_firstTapOffset + tapIndex, 0, sourceWidth - 1);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.m_weights[tapIndex]), _mm_loadu_ps(sourceRow + sourceIndex * 4)));
+		}
+		_mm_storeu_ps(out_row + destIndex * 4, sum);
+	}
+}
+
+static void FilterRowsVertical_AVX(float* out_row, float const* const* tapRows, MipFilterKernel const& kernel, int numFloats, int& out_floatsDone)
+{
+	int floatIndex = 0;
+	for (; floatIndex + 8 <= numFloats; floatIndex += 8)
+	{
+		__m256 sum = _mm256_setzero_ps();
+		for (int tapIndex = 0; tapIndex < kernel.m_numTaps; ++tapIndex)
+		{
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(kernel.m_weights[tapIndex]), _mm256_loadu_ps(tapRows[tapIndex] + floatIndex)));
+		}
+		_mm256_storeu_ps(out_row + floatIndex, sum);
+	}
+	_mm256_zeroupper();
+	out_floatsDone = floatIndex;
+}
+
+static void FilterRowsVertical(float* out_row, float const* const* tapRows, MipFilterKernel const& kernel, int numFloats)
+{
+	// Rows are contiguous, so this pass is a plain weighted sum of whole rows, with SSE finishing the last few floats
+	int floatIndex = 0;
+	FilterRowsVertical_AVX(out_row, tapRows, kernel, numFloats, floatIndex);
+	for (; floatIndex < numFloats; floatIndex += 4)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for (int tapIndex = 0; tapIndex < kernel.m_numTaps; ++tapIndex)
+		{
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.m_weights[tapIndex]), _mm_loadu_ps(tapRows[tapIndex] + floatIndex)));
+		}
+		_mm_storeu_ps(out_row + floatIndex, sum);
+	}
+}
+
+static void DownsampleRows(Rgba8* out_texels, IntVec2 const& destDims, Rgba8 const* sourceTexels, IntVec2 const& sourceDims, MipFilterKernel const& kernel,
+	bool isSRGB, int startRow, int endRow)
+{
+	ColorConversionTables const& tables = GetColorConversionTables();
+	int destFloatsPerRow = destDims.x * 4;
+
+	// Every source row the tile touches is decoded and horizontally filtered once, then shared by the destination rows that need it
+	int firstSourceRow = startRow * 2 + kernel.m_firstTapOffset;
+	int lastSourceRow = (endRow - 1) * 2 + kernel.m_firstTapOffset + kernel.m_numTaps - 1;
+	int numTileRows = lastSourceRow - firstSourceRow + 1;
+	std::vector<float> decodedRow(static_cast<size_t>(sourceDims.x) * 4);
+	std::vector<float> filteredRows(static_cast<size_t>(numTileRows) * destFloatsPerRow);
+	for (int tileRow = 0; tileRow < numTileRows; ++tileRow)
+	{
+		int sourceRow = GetClamped(firstSourceRow + tileRow, 0, sourceDims.y - 1);
+		DecodeRow(decodedRow.data(), sourceTexels + static_cast<size_t>(sourceRow) * sourceDims.x, sourceDims.x, isSRGB, tables);
+		FilterRowHorizontal(&filteredRows[static_cast<size_t>(tileRow) * destFloatsPerRow], decodedRow.data(), sourceDims.x, destDims.x, kernel);
+	}
+
+	std::vector<float> destRow(destFloatsPerRow);
+	float const* tapRows[IMAGE_MIP_MAX_TAPS] = {};
+	for (int destRowIndex = startRow; destRowIndex < endRow; ++destRowIndex)
+	{
+		for (int tapIndex = 0; tapIndex < kernel.m_numTaps; ++tapIndex)
+		{
+			int tileRow = destRowIndex * 2 + kernel.m_firstTapOffset + tapIndex - firstSourceRow;
+			tapRows[tapIndex] = &filteredRows[static_cast<size_t>(tileRow) * destFloatsPerRow];
+		}
+		FilterRowsVertical(destRow.data(), tapRows, kernel, destFloatsPerRow);
+		EncodeRow(out_texels + static_cast<size_t>(destRowIndex) * destDims.x, destRow.data(), destDims.x, isSRGB, tables);
+	}
+}
+// -----------------------------------------------------------------------------
+int GetFullMipLevelCount(IntVec2 const& dimensions)
+{
+	int numLevels = 1;
+	IntVec2 levelDims = dimensions;
+	while (levelDims.x > 1 || levelDims.y > 1)
+	{
+		levelDims = IntVec2(std::max(1, levelDims.x / 2), std::max(1, levelDims.y / 2));
+		++numLevels;
+	}
+	return numLevels;
+}
+
+void DownsampleImage(Image& out_image, Image const& sourceImage, ImageMipSettings const& settings, JobSystem* jobSystem)
+{
+	// Odd sizes round down and drop the last source row or column from the box, same as GenerateMips
+	IntVec2 sourceDims = sourceImage.GetDimensions();
+	IntVec2 destDims(std::max(1, sourceDims.x / 2), std::max(1, sourceDims.y / 2));
+	std::vector<Rgba8> destTexels(static_cast<size_t>(destDims.x) * destDims.y);
+	Rgba8 const* sourceTexels = static_cast<Rgba8 const*>(sourceImage.GetRawData());
+	MipFilterKernel kernel = MakeMipFilterKernel(settings);
+
+	int numTiles = (destDims.y + IMAGE_MIP_ROWS_PER_TILE - 1) / IMAGE_MIP_ROWS_PER_TILE;
+	auto tileFunction = [&](int startTile, int endTile)
+	{
+		int startRow = startTile * IMAGE_MIP_ROWS_PER_TILE;
+		int endRow = std::min(endTile * IMAGE_MIP_ROWS_PER_TILE, destDims.y);
+		DownsampleRows(destTexels.data(), destDims, sourceTexels, sourceDims, kernel, settings.m_isSRGB, startRow, endRow);
+	};
+
+	if (jobSystem != nullptr)
+	{
+		jobSystem->ExecuteParallelFor(numTiles, 1, tileFunction);
+	}
+	else
+	{
+		tileFunction(0, numTiles);
+	}
+
+	out_image = Image(destDims, std::move(destTexels));
+}
+
+void GenerateImageMipChain(std::vector<Image>& out_mipChain, Image const& baseImage, ImageMipSettings const& settings, JobSystem* jobSystem)
+{
+	int numLevels = GetFullMipLevelCount(baseImage.GetDimensions());
+	if (settings.m_maxLevels > 0)
+	{
+		numLevels = std::min(numLevels, settings.m_maxLevels);
+	}
+
+	// Reserved up front so the level being read from never moves while the next one is written
+	out_mipChain.clear();
+	out_mipChain.reserve(numLevels);
+	out_mipChain.push_back(baseImage);
+	for (int levelIndex = 1; levelIndex < numLevels; ++levelIndex)
+	{
+		Image mipImage;
+		DownsampleImage(mipImage, out_mipChain.back(), settings, jobSystem);
+		out_mipChain.push_back(std::move(mipImage));
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Engine/Core/Image.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+class JobSystem;
+// -----------------------------------------------------------------------------
+constexpr int IMAGE_MIP_ROWS_PER_TILE = 32;
+// -----------------------------------------------------------------------------
+enum class ImageMipFilter
+{
+	BOX,	// 2x2 average, cheapest and a little soft
+	KAISER,	// 8 tap Kaiser windowed sinc, keeps distant detail sharper at the cost of slight ringing
+	COUNT
+};
+// -----------------------------------------------------------------------------
+struct ImageMipSettings
+{
+	ImageMipFilter m_filter = ImageMipFilter::BOX;
+	bool		   m_isSRGB = true;		  // Color is filtered in linear space and re-encoded, alpha is always linear
+	int			   m_maxLevels = 0;		  // Including the base level, 0 builds the full chain down to 1x1
+	float		   m_kaiserAlpha = 4.f;	  // Higher trades sharpness for less ringing
+};
+// -----------------------------------------------------------------------------
+// Every level is filtered from the one above it. Within a level the destination rows are split into tiles across
+// the job system, and each tile runs the SSE horizontal pass and the AVX vertical pass over its own rows.
+int	 GetFullMipLevelCount(IntVec2 const& dimensions);
+void DownsampleImage(Image& out_image, Image const& sourceImage, ImageMipSettings const& settings = ImageMipSettings(), JobSystem* jobSystem = nullptr);
+void GenerateImageMipChain(std::vector<Image>& out_mipChain, Image const& baseImage, ImageMipSettings const& settings = ImageMipSettings(), JobSystem* jobSystem = nullptr); // Level 0 is a copy of baseImage
+// -----------------------------------------------------------------------------
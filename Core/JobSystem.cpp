@@ -1,5 +1,50 @@
 #include "Engine/Core/JobSystem.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+
+ParallelForJob::ParallelForJob(int startIndex, int endIndex, std::function<void(int, int)> const* rangeFunction)
+	:m_startIndex(startIndex),
+	 m_endIndex(endIndex),
+	 m_rangeFunction(rangeFunction)
+{
+}
+
+void ParallelForJob::Execute()
+{
+	(*m_rangeFunction)(m_startIndex, m_endIndex);
+}
+// -----------------------------------------------------------------------------
+bool JobCounter::IsDone() const
+{
+	// Locked so a job still inside FinishJob holds off an owner that would destroy the counter
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return m_numUnfinishedJobs == 0;
+}
+
+void JobCounter::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [this]()
+	{
+		return m_numUnfinishedJobs == 0;
+	});
+}
+
+void JobCounter::AddJobs(int numJobs)
+{
+	m_numUnfinishedJobs += numJobs;
+}
+
+void JobCounter::FinishJob()
+{
+	// Notify under the lock, the waiter may destroy the counter as soon as it sees zero
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (--m_numUnfinishedJobs == 0)
+	{
+		m_doneCondition.notify_all();
+	}
+}
+// -----------------------------------------------------------------------------
 
 JobWorkerThread::JobWorkerThread(unsigned int workerThreadID, JobSystem* jobSystem)
 	:m_jobWorkerID(workerThreadID),
@@ -52,7 +97,10 @@ void JobWorkerThread::ThreadMain()
 		{
 			job->Execute();
 
-			// Move job from executing to completed
+			// Read before the job leaves executing, its owner may delete it as soon as the counter finishes
+			JobCounter* counter = job->m_counter;
+
+			// Move job from executing to completed, unless its owner tracks it with a counter
 			{
 				std::unique_lock<std::mutex> lock(m_jobSystem->m_jobMutex);
 
@@ -66,7 +114,15 @@ void JobWorkerThread::ThreadMain()
 				}
 
 				// Add to completed job queue
-				m_jobSystem->m_completedJobs.push_back(job);
+				if (counter == nullptr)
+				{
+					m_jobSystem->m_completedJobs.push_back(job);
+				}
+			}
+
+			if (counter != nullptr)
+			{
+				counter->FinishJob();
 			}
 
 			// Yield to let any other threads run
@@ -133,8 +189,14 @@ void JobSystem::EndFrame()
 {
 }
 
-void JobSystem::AddJobToSystem(Job* job)
+void JobSystem::AddJobToSystem(Job* job, JobCounter* counter)
 {
+	job->m_counter = counter;
+	if (counter != nullptr)
+	{
+		counter->AddJobs(1);
+	}
+
 	// Lock pending jobs mutex
 	std::unique_lock<std::mutex> lock(m_jobMutex);
 
@@ -161,13 +223,120 @@ Job* JobSystem::RetreiveCompletedJob()
 	return job;
 }
 
-void JobSystem::CancelPendingJob(Job* job)
+bool JobSystem::CancelPendingJob(Job* job)
 {
 	std::unique_lock<std::mutex> lock(m_jobMutex);
 
 	auto foundJob = std::find(m_pendingJobs.begin(), m_pendingJobs.end(), job);
-	if (foundJob != m_pendingJobs.end())
+	if (foundJob == m_pendingJobs.end())
+	{
+		return false;
+	}
+
+	m_pendingJobs.erase(foundJob);
+	lock.unlock();
+
+	// It never runs, so its counter would otherwise never reach zero
+	if (job->m_counter != nullptr)
+	{
+		job->m_counter->FinishJob();
+	}
+	return true;
+}
+
+int JobSystem::GetNumWorkers() const
+{
+	return static_cast<int>(m_workerThreads.size());
+}
+
+void JobSystem::AddJobsToSystem(std::vector<Job*> const& jobs, JobCounter* counter)
+{
+	if (counter != nullptr)
 	{
-		m_pendingJobs.erase(foundJob);
+		counter->AddJobs(static_cast<int>(jobs.size()));
 	}
+
+	// Lock once for the whole batch rather than once per job
+	std::unique_lock<std::mutex> lock(m_jobMutex);
+
+	for (int jobIndex = 0; jobIndex < static_cast<int>(jobs.size()); ++jobIndex)
+	{
+		jobs[jobIndex]->m_counter = counter;
+		m_pendingJobs.push_back(jobs[jobIndex]);
+	}
+
+	m_jobAvailableCondition.notify_all();
+}
+
+void JobSystem::WaitForCounter(JobCounter& counter)
+{
+	// Help out with the counter's jobs that no worker has claimed yet, newest first since workers take from the front
+	for (;;)
+	{
+		Job* jobToExecuteHere = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_jobMutex);
+
+			for (auto pendingJob = m_pendingJobs.rbegin(); pendingJob != m_pendingJobs.rend(); ++pendingJob)
+			{
+				if ((*pendingJob)->m_counter == &counter)
+				{
+					jobToExecuteHere = *pendingJob;
+					m_pendingJobs.erase(std::next(pendingJob).base());
+					break;
+				}
+			}
+		}
+
+		if (jobToExecuteHere == nullptr)
+		{
+			break;
+		}
+
+		jobToExecuteHere->Execute();
+		counter.FinishJob();
+	}
+
+	// The rest are executing on workers
+	counter.Wait();
+}
+
+void JobSystem::ExecuteParallelFor(int numItems, int minItemsPerJob, std::function<void(int startIndex, int endIndex)> const& rangeFunction)
+{
+	if (numItems <= 0)
+	{
+		return;
+	}
+
+	// Not worth splitting up, or nobody to split it with
+	minItemsPerJob = std::max(minItemsPerJob, 1);
+	if (GetNumWorkers() == 0 || numItems <= minItemsPerJob)
+	{
+		rangeFunction(0, numItems);
+		return;
+	}
+
+	// A few more ranges than threads so uneven ranges still balance out
+	int maxNumJobs = (GetNumWorkers() + 1) * 4;
+	int numJobs = std::min((numItems + minItemsPerJob - 1) / minItemsPerJob, maxNumJobs);
+	int itemsPerJob = (numItems + numJobs - 1) / numJobs;
+
+	std::vector<ParallelForJob> rangeJobs;
+	std::vector<Job*> jobs;
+	rangeJobs.reserve(numJobs);
+	jobs.reserve(numJobs);
+	for (int startIndex = 0; startIndex < numItems; startIndex += itemsPerJob)
+	{
+		int endIndex = std::min(startIndex + itemsPerJob, numItems);
+		rangeJobs.emplace_back(startIndex, endIndex, &rangeFunction);
+	}
+	for (int jobIndex = 0; jobIndex < static_cast<int>(rangeJobs.size()); ++jobIndex)
+	{
+		jobs.push_back(&rangeJobs[jobIndex]);
+	}
+
+	// Counted, so none of these go through the completed queue where RetreiveCompletedJob callers could take them
+	JobCounter counter;
+	AddJobsToSystem(jobs, &counter);
+	WaitForCounter(counter);
 }
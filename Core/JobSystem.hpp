@@ -2,6 +2,9 @@
 #include <vector>
 #include <deque>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 // -----------------------------------------------------------------------------
 class JobSystem;
 // -----------------------------------------------------------------------------
@@ -10,11 +13,55 @@ struct JobSystemConfig
 	int m_numJobWorkers = -1;
 };
 // -----------------------------------------------------------------------------
+class JobCounter;
+// -----------------------------------------------------------------------------
 class Job
 {
+	friend class JobSystem;
+	friend class JobWorkerThread;
+
 public:
 	virtual ~Job() = default;
 	virtual void Execute() = 0;
+
+private:
+	JobCounter* m_counter = nullptr; // Set for jobs added with a counter, which skip the completed queue
+};
+// -----------------------------------------------------------------------------
+// Counts down as its jobs finish. Jobs added with a counter never reach m_completedJobs, so RetreiveCompletedJob
+// callers cannot take them and only the counter's owner knows when they are done.
+class JobCounter
+{
+	friend class JobSystem;
+	friend class JobWorkerThread;
+
+public:
+	JobCounter() = default;
+	JobCounter(JobCounter const& copy) = delete;
+
+	bool IsDone() const;
+	void Wait(); // Blocks without helping, see JobSystem::WaitForCounter
+
+private:
+	void AddJobs(int numJobs);
+	void FinishJob();
+
+private:
+	std::atomic<int>		m_numUnfinishedJobs = 0;
+	mutable std::mutex		m_mutex;
+	std::condition_variable m_doneCondition;
+};
+// -----------------------------------------------------------------------------
+class ParallelForJob : public Job
+{
+public:
+	ParallelForJob(int startIndex, int endIndex, std::function<void(int, int)> const* rangeFunction);
+	virtual void Execute() override;
+
+private:
+	int m_startIndex = 0;
+	int m_endIndex = 0;
+	std::function<void(int, int)> const* m_rangeFunction = nullptr;
 };
 // -----------------------------------------------------------------------------
 class JobWorkerThread
@@ -38,9 +85,14 @@ public:
 	void BeginFrame();
 	void EndFrame();
 
-	void AddJobToSystem(Job* job);
+	void AddJobToSystem(Job* job, JobCounter* counter = nullptr);
 	Job* RetreiveCompletedJob();
-	void CancelPendingJob(Job* job);
+	bool CancelPendingJob(Job* job); // False if a worker has already claimed it. A cancelled job counts as finished for its counter
+
+	int  GetNumWorkers() const;
+	void AddJobsToSystem(std::vector<Job*> const& jobs, JobCounter* counter = nullptr);
+	void WaitForCounter(JobCounter& counter); // Runs the counter's jobs no worker has claimed yet on the calling thread, then blocks until the rest finish
+	void ExecuteParallelFor(int numItems, int minItemsPerJob, std::function<void(int startIndex, int endIndex)> const& rangeFunction); // Splits [0, numItems) into ranges across the workers and waits for them all
 
 public:
 	JobSystemConfig m_config;
@@ -0,0 +1,427 @@
+#include "Engine/Core/MeshBVH.hpp"
+#include "Engine/Core/MeshUtils.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/SIMDMath.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+// -----------------------------------------------------------------------------
+#if defined( ENGINE_SIMD_SCALAR )
+constexpr int MESH_BVH_CORNER_PADDING = 0;
+#else
+constexpr int MESH_BVH_CORNER_PADDING = SIMD_WIDE_NUM_LANES;
+#endif
+// -----------------------------------------------------------------------------
+// The ray in the sheared space of the watertight test, set up the same way as RaycastVsTriangle3D
+struct WatertightRay3D
+{
+	float m_start[3] = {};
+	int	  m_kx = 0;
+	int	  m_ky = 1;
+	int	  m_kz = 2;
+	float m_shearX = 0.f;
+	float m_shearY = 0.f;
+	float m_shearZ = 0.f;
+};
+
+static WatertightRay3D const GetWatertightRay(Vec3 const& rayStart, Vec3 const& fwdNormal)
+{
+	WatertightRay3D ray;
+	ray.m_start[0] = rayStart.x;
+	ray.m_start[1] = rayStart.y;
+	ray.m_start[2] = rayStart.z;
+
+	float const fwd[3] = { fwdNormal.x, fwdNormal.y, fwdNormal.z };
+	ray.m_kz = (fabsf(fwd[0]) > fabsf(fwd[1])) ? ((fabsf(fwd[0]) > fabsf(fwd[2])) ? 0 : 2) : ((fabsf(fwd[1]) > fabsf(fwd[2])) ? 1 : 2);
+	ray.m_kx = (ray.m_kz + 1) % 3;
+	ray.m_ky = (ray.m_kx + 1) % 3;
+	if (fwd[ray.m_kz] < 0.f)
+	{
+		std::swap(ray.m_kx, ray.m_ky);
+	}
+	ray.m_shearX = fwd[ray.m_kx] / fwd[ray.m_kz];
+	ray.m_shearY = fwd[ray.m_ky] / fwd[ray.m_kz];
+	ray.m_shearZ = 1.f / fwd[ray.m_kz];
+	return ray;
+}
+// -----------------------------------------------------------------------------
+void MeshBVH::Build(std::vector<Vertex_PCUTBN> const& meshVerts, JobSystem* jobSystem)
+{
+	GUARANTEE_OR_DIE(meshVerts.size() % 3 == 0, Stringf("MeshBVH::Build needs whole triangles, got %d verts", static_cast<int>(meshVerts.size())));
+	std::vector<Vec3> cornerPositions(meshVerts.size());
+	for (int vertIndex = 0; vertIndex < static_cast<int>(meshVerts.size()); ++vertIndex)
+	{
+		cornerPositions[vertIndex] = meshVerts[vertIndex].m_position;
+	}
+	BuildFromTriangleCorners(cornerPositions, jobSystem);
+}
+
+void MeshBVH::Build(std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes, JobSystem* jobSystem)
+{
+	GUARANTEE_OR_DIE(meshIndexes.size() % 3 == 0, Stringf("MeshBVH::Build needs whole triangles, got %d indexes", static_cast<int>(meshIndexes.size())));
+	std::vector<Vec3> cornerPositions(meshIndexes.size());
+	for (int cornerIndex = 0; cornerIndex < static_cast<int>(meshIndexes.size()); ++cornerIndex)
+	{
+		cornerPositions[cornerIndex] = meshVerts[meshIndexes[cornerIndex]].m_position;
+	}
+	BuildFromTriangleCorners(cornerPositions, jobSystem);
+}
+
+void MeshBVH::BuildFromTriangleCorners(std::vector<Vec3> const& cornerPositions, JobSystem* jobSystem)
+{
+	Clear();
+	int numTris = static_cast<int>(cornerPositions.size()) / 3;
+	if (numTris == 0)
+	{
+		return;
+	}
+
+	auto runRange = [&](int numItems, std::function<void(int, int)> const& rangeFunction)
+	{
+		if (jobSystem != nullptr)
+		{
+			jobSystem->ExecuteParallelFor(numItems, MESH_ITEMS_PER_JOB, rangeFunction);
+		}
+		else
+		{
+			rangeFunction(0, numItems);
+		}
+	};
+
+	std::vector<AABB3> triBounds(numTris);
+	runRange(numTris, [&](int startTri, int endTri)
+	{
+		for (int triIndex = startTri; triIndex < endTri; ++triIndex)
+		{
+			Vec3 const& corner0 = cornerPositions[triIndex * 3 + 0];
+			Vec3 const& corner1 = cornerPositions[triIndex * 3 + 1];
+			Vec3 const& corner2 = cornerPositions[triIndex * 3 + 2];
+			Vec3 mins(std::min(corner0.x, std::min(corner1.x, corner2.x)), std::min(corner0.y, std::min(corner1.y, corner2.y)), std::min(corner0.z, std::min(corner1.z, corner2.z)));
+			Vec3 maxs(std::max(corner0.x, std::max(corner1.x, corner2.x)), std::max(corner0.y, std::max(corner1.y, corner2.y)), std::max(corner0.z, std::max(corner1.z, corner2.z)));
+			triBounds[triIndex] = AABB3(mins, maxs);
+		}
+	});
+
+	// Only the tree shape is kept, the bounds copy the BVH3D holds goes away with it
+	{
+		BVH3D triangleTree;
+		triangleTree.Build(triBounds, jobSystem);
+		m_nodes = triangleTree.GetNodes();
+		m_triangleIndices = triangleTree.GetPrimitiveIndices();
+	}
+
+	for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+	{
+		for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+		{
+			m_cornerCoords[cornerIndex][axisIndex].assign(numTris + MESH_BVH_CORNER_PADDING, 0.f);
+		}
+	}
+	runRange(numTris, [&](int startSlot, int endSlot)
+	{
+		for (int slotIndex = startSlot; slotIndex < endSlot; ++slotIndex)
+		{
+			int triIndex = m_triangleIndices[slotIndex];
+			for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+			{
+				Vec3 const& corner = cornerPositions[triIndex * 3 + cornerIndex];
+				m_cornerCoords[cornerIndex][0][slotIndex] = corner.x;
+				m_cornerCoords[cornerIndex][1][slotIndex] = corner.y;
+				m_cornerCoords[cornerIndex][2][slotIndex] = corner.z;
+			}
+		}
+	});
+}
+
+void MeshBVH::Clear()
+{
+	m_nodes.clear();
+	m_triangleIndices.clear();
+	for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+	{
+		for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+		{
+			m_cornerCoords[cornerIndex][axisIndex].clear();
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+// Nearest triangle a leaf's slots so far, in the watertight test's scaled form until the end
+struct MeshLeafImpact
+{
+	int	  m_slotIndex = -1;
+	int	  m_triangleIndex = INT_MAX;
+	float m_impactDist = FLT_MAX;
+	float m_u = 0.f;
+	float m_v = 0.f;
+	float m_w = 0.f;
+	float m_determinant = 1.f;
+};
+
+// Keeps the nearer impact, equal distances go to the lower source triangle so results never depend on the tree
+static bool UpdateNearestImpact(MeshLeafImpact& nearestImpact, int slotIndex, int triangleIndex, float impactDist, float u, float v, float w, float determinant)
+{
+	if (impactDist > nearestImpact.m_impactDist || (impactDist == nearestImpact.m_impactDist && triangleIndex > nearestImpact.m_triangleIndex))
+	{
+		return false;
+	}
+	nearestImpact.m_slotIndex = slotIndex;
+	nearestImpact.m_triangleIndex = triangleIndex;
+	nearestImpact.m_impactDist = impactDist;
+	nearestImpact.m_u = u;
+	nearestImpact.m_v = v;
+	nearestImpact.m_w = w;
+	nearestImpact.m_determinant = determinant;
+	return true;
+}
+
+#if defined( ENGINE_SIMD_SCALAR )
+static bool RaycastLeafTriangles(std::vector<float> const (&cornerCoords)[3][3], std::vector<int> const& triangleIndices, int firstSlot, int numSlots,
+	WatertightRay3D const& ray, float rayLength, bool stopAtFirstImpact, MeshLeafImpact& nearestImpact)
+{
+	bool didImpact = false;
+	for (int slotIndex = firstSlot; slotIndex < firstSlot + numSlots; ++slotIndex)
+	{
+		float a[3];
+		float b[3];
+		float c[3];
+		for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+		{
+			a[axisIndex] = cornerCoords[0][axisIndex][slotIndex] - ray.m_start[axisIndex];
+			b[axisIndex] = cornerCoords[1][axisIndex][slotIndex] - ray.m_start[axisIndex];
+			c[axisIndex] = cornerCoords[2][axisIndex][slotIndex] - ray.m_start[axisIndex];
+		}
+		float aX = a[ray.m_kx] - ray.m_shearX * a[ray.m_kz];
+		float aY = a[ray.m_ky] - ray.m_shearY * a[ray.m_kz];
+		float bX = b[ray.m_kx] - ray.m_shearX * b[ray.m_kz];
+		float bY = b[ray.m_ky] - ray.m_shearY * b[ray.m_kz];
+		float cX = c[ray.m_kx] - ray.m_shearX * c[ray.m_kz];
+		float cY = c[ray.m_ky] - ray.m_shearY * c[ray.m_kz];
+		float u = cX * bY - cY * bX;
+		float v = aX * cY - aY * cX;
+		float w = bX * aY - bY * aX;
+		if ((u < 0.f || v < 0.f || w < 0.f) && (u > 0.f || v > 0.f || w > 0.f))
+		{
+			continue;
+		}
+
+		float determinant = u + v + w;
+		if (determinant == 0.f)
+		{
+			continue;
+		}
+		float scaledDist = u * (ray.m_shearZ * a[ray.m_kz]) + v * (ray.m_shearZ * b[ray.m_kz]) + w * (ray.m_shearZ * c[ray.m_kz]);
+		if (determinant < 0.f)
+		{
+			scaledDist = -scaledDist;
+			determinant = -determinant;
+		}
+		if (scaledDist < 0.f || scaledDist > rayLength * determinant)
+		{
+			continue;
+		}
+
+		didImpact |= UpdateNearestImpact(nearestImpact, slotIndex, triangleIndices[slotIndex], scaledDist / determinant, u, v, w, determinant);
+		if (stopAtFirstImpact)
+		{
+			return true;
+		}
+	}
+	return didImpact;
+}
+#else
+// Tests SIMD_WIDE_NUM_LANES of the leaf's triangles at once, same operations in the same order as the scalar
+// test so every lane's impact distance matches RaycastVsTriangle3D bit for bit
+static bool RaycastLeafTriangles(std::vector<float> const (&cornerCoords)[3][3], std::vector<int> const& triangleIndices, int firstSlot, int numSlots,
+	WatertightRay3D const& ray, float rayLength, bool stopAtFirstImpact, MeshLeafImpact& nearestImpact)
+{
+	SIMDFloatWide zero = SIMDSplatWide(0.f);
+	SIMDFloatWide signBits = SIMDSplatWide(-0.f);
+	SIMDFloatWide shearX = SIMDSplatWide(ray.m_shearX);
+	SIMDFloatWide shearY = SIMDSplatWide(ray.m_shearY);
+	SIMDFloatWide shearZ = SIMDSplatWide(ray.m_shearZ);
+	SIMDFloatWide maxLength = SIMDSplatWide(rayLength);
+	SIMDFloatWide startX = SIMDSplatWide(ray.m_start[ray.m_kx]);
+	SIMDFloatWide startY = SIMDSplatWide(ray.m_start[ray.m_ky]);
+	SIMDFloatWide startZ = SIMDSplatWide(ray.m_start[ray.m_kz]);
+
+	bool didImpact = false;
+	for (int laneSlot = firstSlot; laneSlot < firstSlot + numSlots; laneSlot += SIMD_WIDE_NUM_LANES)
+	{
+		int numLanes = std::min(SIMD_WIDE_NUM_LANES, firstSlot + numSlots - laneSlot);
+		int laneBits = (1 << numLanes) - 1;
+
+		SIMDFloatWide aZ = SIMDSubtract(SIMDLoadWide(&cornerCoords[0][ray.m_kz][laneSlot]), startZ);
+		SIMDFloatWide bZ = SIMDSubtract(SIMDLoadWide(&cornerCoords[1][ray.m_kz][laneSlot]), startZ);
+		SIMDFloatWide cZ = SIMDSubtract(SIMDLoadWide(&cornerCoords[2][ray.m_kz][laneSlot]), startZ);
+		SIMDFloatWide aX = SIMDSubtract(SIMDSubtract(SIMDLoadWide(&cornerCoords[0][ray.m_kx][laneSlot]), startX), SIMDMultiply(shearX, aZ));
+		SIMDFloatWide aY = SIMDSubtract(SIMDSubtract(SIMDLoadWide(&cornerCoords[0][ray.m_ky][laneSlot]), startY), SIMDMultiply(shearY, aZ));
+		SIMDFloatWide bX = SIMDSubtract(SIMDSubtract(SIMDLoadWide(&cornerCoords[1][ray.m_kx][laneSlot]), startX), SIMDMultiply(shearX, bZ));
+		SIMDFloatWide bY = SIMDSubtract(SIMDSubtract(SIMDLoadWide(&cornerCoords[1][ray.m_ky][laneSlot]), startY), SIMDMultiply(shearY, bZ));
+		SIMDFloatWide cX = SIMDSubtract(SIMDSubtract(SIMDLoadWide(&cornerCoords[2][ray.m_kx][laneSlot]), startX), SIMDMultiply(shearX, cZ));
+		SIMDFloatWide cY = SIMDSubtract(SIMDSubtract(SIMDLoadWide(&cornerCoords[2][ray.m_ky][laneSlot]), startY), SIMDMultiply(shearY, cZ));
+
+		SIMDFloatWide u = SIMDSubtract(SIMDMultiply(cX, bY), SIMDMultiply(cY, bX));
+		SIMDFloatWide v = SIMDSubtract(SIMDMultiply(aX, cY), SIMDMultiply(aY, cX));
+		SIMDFloatWide w = SIMDSubtract(SIMDMultiply(bX, aY), SIMDMultiply(bY, aX));
+		int anyNegativeBits = SIMDGetMaskBits(SIMDOr(SIMDLess(u, zero), SIMDOr(SIMDLess(v, zero), SIMDLess(w, zero))));
+		int anyPositiveBits = SIMDGetMaskBits(SIMDOr(SIMDLess(zero, u), SIMDOr(SIMDLess(zero, v), SIMDLess(zero, w))));
+		laneBits &= ~(anyNegativeBits & anyPositiveBits);
+		if (laneBits == 0)
+		{
+			continue;
+		}
+
+		SIMDFloatWide determinant = SIMDAdd(SIMDAdd(u, v), w);
+		SIMDFloatWide determinantSign = SIMDAnd(determinant, signBits);
+		SIMDFloatWide scaledDist = SIMDAdd(SIMDAdd(SIMDMultiply(u, SIMDMultiply(shearZ, aZ)), SIMDMultiply(v, SIMDMultiply(shearZ, bZ))), SIMDMultiply(w, SIMDMultiply(shearZ, cZ)));
+		scaledDist = SIMDFlipSigns(scaledDist, determinantSign);
+		determinant = SIMDFlipSigns(determinant, determinantSign);
+		laneBits &= SIMDGetMaskBits(SIMDLess(zero, determinant));
+		laneBits &= ~SIMDGetMaskBits(SIMDOr(SIMDLess(scaledDist, zero), SIMDLess(SIMDMultiply(maxLength, determinant), scaledDist)));
+		if (laneBits == 0)
+		{
+			continue;
+		}
+
+		float laneScaledDists[SIMD_WIDE_NUM_LANES];
+		float laneDeterminants[SIMD_WIDE_NUM_LANES];
+		float laneU[SIMD_WIDE_NUM_LANES];
+		float laneV[SIMD_WIDE_NUM_LANES];
+		float laneW[SIMD_WIDE_NUM_LANES];
+		SIMDStoreWide(laneScaledDists, scaledDist);
+		SIMDStoreWide(laneDeterminants, determinant);
+		SIMDStoreWide(laneU, u);
+		SIMDStoreWide(laneV, v);
+		SIMDStoreWide(laneW, w);
+		for (int laneIndex = 0; laneIndex < numLanes; ++laneIndex)
+		{
+			if ((laneBits & (1 << laneIndex)) == 0)
+			{
+				continue;
+			}
+			int slotIndex = laneSlot + laneIndex;
+			didImpact |= UpdateNearestImpact(nearestImpact, slotIndex, triangleIndices[slotIndex], laneScaledDists[laneIndex] / laneDeterminants[laneIndex],
+				laneU[laneIndex], laneV[laneIndex], laneW[laneIndex], laneDeterminants[laneIndex]);
+			if (stopAtFirstImpact)
+			{
+				return true;
+			}
+		}
+	}
+	return didImpact;
+}
+#endif
+// -----------------------------------------------------------------------------
+MeshRaycastResult3D MeshBVH::RaycastClosest(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength) const
+{
+	return Raycast(rayStart, fwdNormal, rayLength, false);
+}
+
+MeshRaycastResult3D MeshBVH::RaycastAny(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength) const
+{
+	return Raycast(rayStart, fwdNormal, rayLength, true);
+}
+
+MeshRaycastResult3D MeshBVH::Raycast(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength, bool stopAtFirstImpact) const
+{
+	MeshRaycastResult3D raycastResult;
+	raycastResult.m_rayStartPosition = rayStart;
+	raycastResult.m_rayFwdNormal = fwdNormal;
+	raycastResult.m_rayDirection = fwdNormal * rayLength;
+	raycastResult.m_rayLength = rayLength;
+
+	float entryDist = 0.f;
+	Vec3 inverseFwd(1.f / fwdNormal.x, 1.f / fwdNormal.y, 1.f / fwdNormal.z);
+	if (m_nodes.empty() || !DoesRayEnterBounds(m_nodes[0].m_bounds, rayStart, inverseFwd, rayLength, entryDist))
+	{
+		return raycastResult;
+	}
+
+	WatertightRay3D watertightRay = GetWatertightRay(rayStart, fwdNormal);
+	MeshLeafImpact nearestImpact;
+	int nodeStack[BVH_MAX_DEPTH + 1];
+	float entryDistStack[BVH_MAX_DEPTH + 1];
+	int stackSize = 0;
+	nodeStack[stackSize] = 0;
+	entryDistStack[stackSize] = entryDist;
+	++stackSize;
+
+	float maxDist = rayLength;
+	while (stackSize > 0)
+	{
+		--stackSize;
+		BVHNode3D const& node = m_nodes[nodeStack[stackSize]];
+		if (entryDistStack[stackSize] > maxDist)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			if (RaycastLeafTriangles(m_cornerCoords, m_triangleIndices, node.m_firstIndex, node.m_numPrimitives, watertightRay, rayLength, stopAtFirstImpact, nearestImpact))
+			{
+				maxDist = nearestImpact.m_impactDist;
+				if (stopAtFirstImpact)
+				{
+					break;
+				}
+			}
+			continue;
+		}
+
+		float leftEntryDist = 0.f;
+		float rightEntryDist = 0.f;
+		bool entersLeft = DoesRayEnterBounds(m_nodes[node.m_firstIndex].m_bounds, rayStart, inverseFwd, maxDist, leftEntryDist);
+		bool entersRight = DoesRayEnterBounds(m_nodes[node.m_firstIndex + 1].m_bounds, rayStart, inverseFwd, maxDist, rightEntryDist);
+		if (entersLeft && entersRight)
+		{
+			bool isLeftNearer = leftEntryDist <= rightEntryDist;
+			nodeStack[stackSize] = isLeftNearer ? node.m_firstIndex + 1 : node.m_firstIndex;
+			entryDistStack[stackSize] = isLeftNearer ? rightEntryDist : leftEntryDist;
+			++stackSize;
+			nodeStack[stackSize] = isLeftNearer ? node.m_firstIndex : node.m_firstIndex + 1;
+			entryDistStack[stackSize] = isLeftNearer ? leftEntryDist : rightEntryDist;
+			++stackSize;
+		}
+		else if (entersLeft || entersRight)
+		{
+			nodeStack[stackSize] = entersLeft ? node.m_firstIndex : node.m_firstIndex + 1;
+			entryDistStack[stackSize] = entersLeft ? leftEntryDist : rightEntryDist;
+			++stackSize;
+		}
+	}
+
+	if (nearestImpact.m_slotIndex < 0)
+	{
+		return raycastResult;
+	}
+
+	int slotIndex = nearestImpact.m_slotIndex;
+	Vec3 corner0(m_cornerCoords[0][0][slotIndex], m_cornerCoords[0][1][slotIndex], m_cornerCoords[0][2][slotIndex]);
+	Vec3 corner1(m_cornerCoords[1][0][slotIndex], m_cornerCoords[1][1][slotIndex], m_cornerCoords[1][2][slotIndex]);
+	Vec3 corner2(m_cornerCoords[2][0][slotIndex], m_cornerCoords[2][1][slotIndex], m_cornerCoords[2][2][slotIndex]);
+	Vec3 impactNormal = CrossProduct3D(corner1 - corner0, corner2 - corner0).GetNormalized();
+	float inverseDeterminant = 1.f / nearestImpact.m_determinant;
+
+	raycastResult.m_didImpact = true;
+	raycastResult.m_impactDist = nearestImpact.m_impactDist;
+	raycastResult.m_impactPos = rayStart + fwdNormal * nearestImpact.m_impactDist;
+	raycastResult.m_impactNormal = DotProduct3D(impactNormal, fwdNormal) > 0.f ? -impactNormal : impactNormal;
+	raycastResult.m_triangleIndex = nearestImpact.m_triangleIndex;
+	raycastResult.m_barycentricCoords = Vec3(fabsf(nearestImpact.m_u) * inverseDeterminant, fabsf(nearestImpact.m_v) * inverseDeterminant, fabsf(nearestImpact.m_w) * inverseDeterminant);
+	return raycastResult;
+}
+// -----------------------------------------------------------------------------
+bool MeshBVH::IsEmpty() const
+{
+	return m_nodes.empty();
+}
+
+int MeshBVH::GetNumTriangles() const
+{
+	return static_cast<int>(m_triangleIndices.size());
+}
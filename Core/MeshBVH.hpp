@@ -0,0 +1,42 @@
+#pragma once
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/BVH3D.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+class JobSystem;
+// -----------------------------------------------------------------------------
+struct MeshRaycastResult3D : public RaycastResult3D
+{
+	int	 m_triangleIndex = -1;		// Triangle n is verts (or indexes) 3n to 3n + 2 of the mesh the BVH was built from
+	Vec3 m_barycentricCoords;		// Weights of the triangle's three corners at the impact, for interpolating uvs or vertex normals
+};
+// -----------------------------------------------------------------------------
+// Static triangle mesh BVH for picking and line of sight against loaded geometry. Keeps only the tree and a copy
+// of the triangle corners in leaf order, so the source verts can be freed or handed to the GPU after building.
+// m_impactNormal is the face normal, turned to face the ray.
+class MeshBVH
+{
+public:
+	MeshBVH() = default;
+	~MeshBVH() = default;
+
+	void Build(std::vector<Vertex_PCUTBN> const& meshVerts, JobSystem* jobSystem = nullptr);
+	void Build(std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes, JobSystem* jobSystem = nullptr);
+	void Clear();
+
+	MeshRaycastResult3D RaycastClosest(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength) const;
+	MeshRaycastResult3D RaycastAny(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength) const; // Stops at the first triangle hit, for line of sight checks
+
+	bool IsEmpty() const;
+	int	 GetNumTriangles() const;
+
+private:
+	void			   BuildFromTriangleCorners(std::vector<Vec3> const& cornerPositions, JobSystem* jobSystem);
+	MeshRaycastResult3D Raycast(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength, bool stopAtFirstImpact) const;
+
+private:
+	std::vector<BVHNode3D> m_nodes;
+	std::vector<int>	   m_triangleIndices;		// Source triangle of each leaf order slot
+	std::vector<float>	   m_cornerCoords[3][3];	// [corner][axis] in leaf order, padded so a full SIMD load never reads past the end
+};
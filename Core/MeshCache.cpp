@@ -0,0 +1,202 @@
+#include "Engine/Core/MeshCache.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include <algorithm>
+#include <cstring>
+// -----------------------------------------------------------------------------
+static uint64_t GetAlignedOffset(uint64_t offset)
+{
+	return (offset + (MESH_CACHE_DATA_ALIGNMENT - 1)) & ~static_cast<uint64_t>(MESH_CACHE_DATA_ALIGNMENT - 1);
+}
+
+static bool IsMeshCacheHeaderValid(MeshCacheHeader const& header, size_t fileSize, char const* sourceFilePath, MeshCacheValidation validation, unsigned int requiredFlags)
+{
+	// Format checks, anything written by an older or different build is simply rebuilt
+	MeshCacheHeader const defaultHeader;
+	if (memcmp(header.m_fourCC, defaultHeader.m_fourCC, sizeof(header.m_fourCC)) != 0 ||
+		header.m_version != MESH_CACHE_VERSION ||
+		header.m_headerSize != sizeof(MeshCacheHeader) ||
+		header.m_vertexLayout != static_cast<unsigned int>(MeshCacheVertexLayout::VERTEX_PCUTBN) ||
+		header.m_vertexStride != sizeof(Vertex_PCUTBN) ||
+		header.m_indexStride != sizeof(unsigned int))
+	{
+		return false;
+	}
+
+	// Written before a processing pass the caller relies on, e.g. OptimizeMesh
+	if ((header.m_flags & requiredFlags) != requiredFlags)
+	{
+		return false;
+	}
+
+	// Truncated or corrupt files fail here. The counts are capped first so no size below can overflow, and each block
+	// is checked against the bytes left after its offset rather than by adding to an offset that could wrap
+	if (header.m_numVerts > 0xFFFFFFFFull || header.m_numIndexes > 0xFFFFFFFFull)
+	{
+		return false;
+	}
+	uint64_t vertexDataSize = header.m_numVerts * header.m_vertexStride;
+	uint64_t indexDataSize = header.m_numIndexes * header.m_indexStride;
+	if (header.m_vertexDataOffset < sizeof(MeshCacheHeader) || header.m_vertexDataOffset > fileSize || header.m_vertexDataOffset % MESH_CACHE_DATA_ALIGNMENT != 0 ||
+		vertexDataSize > fileSize - header.m_vertexDataOffset)
+	{
+		return false;
+	}
+	uint64_t vertexDataEnd = header.m_vertexDataOffset + vertexDataSize;
+	if (header.m_indexDataOffset < vertexDataEnd || header.m_indexDataOffset > fileSize || header.m_indexDataOffset % MESH_CACHE_DATA_ALIGNMENT != 0 ||
+		indexDataSize > fileSize - header.m_indexDataOffset)
+	{
+		return false;
+	}
+
+	// Shipping builds may not have the sources at all, in which case the cache is all there is
+	if (sourceFilePath == nullptr || validation == MeshCacheValidation::NONE || !DoesFileExist(sourceFilePath))
+	{
+		return true;
+	}
+
+	if (validation == MeshCacheValidation::HASH)
+	{
+		uint64_t contentHash = 0;
+		return GetFileContentHash(sourceFilePath, contentHash) && contentHash == header.m_sourceContentHash;
+	}
+
+	int64_t lastWriteTime = 0;
+	uint64_t fileSizeBytes = 0;
+	return GetFileTimestampAndSize(sourceFilePath, lastWriteTime, fileSizeBytes) &&
+		   lastWriteTime == header.m_sourceLastWriteTime && fileSizeBytes == header.m_sourceFileSize;
+}
+// -----------------------------------------------------------------------------
+std::string GetMeshCacheFilePath(char const* sourceFilePath, bool isIndexed)
+{
+	// De-indexed meshes get their own cache since their normals are generated differently
+	return Stringf("%s%s", sourceFilePath, isIndexed ? ".wmesh" : ".verts.wmesh");
+}
+
+bool WriteMeshCacheFile(char const* cacheFilePath, std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes,
+	char const* sourceFilePath, unsigned int extraFlags)
+{
+	MeshCacheHeader header;
+	header.m_headerSize = sizeof(MeshCacheHeader);
+	header.m_flags = extraFlags | (meshIndexes.empty() ? MESH_CACHE_FLAG_NONE : MESH_CACHE_FLAG_INDEXED);
+	header.m_vertexStride = sizeof(Vertex_PCUTBN);
+	header.m_indexStride = sizeof(unsigned int);
+	header.m_numVerts = meshVerts.size();
+	header.m_numIndexes = meshIndexes.size();
+	header.m_vertexDataOffset = GetAlignedOffset(sizeof(MeshCacheHeader));
+	header.m_indexDataOffset = GetAlignedOffset(header.m_vertexDataOffset + header.m_numVerts * sizeof(Vertex_PCUTBN));
+
+	if (sourceFilePath != nullptr)
+	{
+		GetFileTimestampAndSize(sourceFilePath, header.m_sourceLastWriteTime, header.m_sourceFileSize);
+		GetFileContentHash(sourceFilePath, header.m_sourceContentHash);
+	}
+
+	AABB3 bounds = GetMeshBounds(meshVerts);
+	header.m_boundsMins[0] = bounds.m_mins.x;
+	header.m_boundsMins[1] = bounds.m_mins.y;
+	header.m_boundsMins[2] = bounds.m_mins.z;
+	header.m_boundsMaxs[0] = bounds.m_maxs.x;
+	header.m_boundsMaxs[1] = bounds.m_maxs.y;
+	header.m_boundsMaxs[2] = bounds.m_maxs.z;
+
+	size_t vertexBytes = meshVerts.size() * sizeof(Vertex_PCUTBN);
+	size_t indexBytes = meshIndexes.size() * sizeof(unsigned int);
+	std::vector<uint8_t> fileBuffer(static_cast<size_t>(header.m_indexDataOffset) + indexBytes, 0);
+	memcpy(fileBuffer.data(), &header, sizeof(MeshCacheHeader));
+	if (vertexBytes > 0)
+	{
+		memcpy(fileBuffer.data() + header.m_vertexDataOffset, meshVerts.data(), vertexBytes);
+	}
+	if (indexBytes > 0)
+	{
+		memcpy(fileBuffer.data() + header.m_indexDataOffset, meshIndexes.data(), indexBytes);
+	}
+
+	return WriteBufferToFileReplacing(fileBuffer, cacheFilePath) == FILE_SUCCESS;
+}
+
+bool OpenMeshCacheView(MeshCacheView& out_view, char const* cacheFilePath, char const* sourceFilePath, MeshCacheValidation validation, unsigned int requiredFlags)
+{
+	out_view = MeshCacheView();
+	if (!OpenMappedFileView(out_view.m_fileView, cacheFilePath))
+	{
+		return false;
+	}
+
+	uint8_t const* fileBytes = static_cast<uint8_t const*>(out_view.m_fileView.m_data);
+	MeshCacheHeader const* header = reinterpret_cast<MeshCacheHeader const*>(fileBytes);
+	if (out_view.m_fileView.m_size < sizeof(MeshCacheHeader) || !IsMeshCacheHeaderValid(*header, out_view.m_fileView.m_size, sourceFilePath, validation, requiredFlags))
+	{
+		CloseMeshCacheView(out_view);
+		return false;
+	}
+
+	out_view.m_header = header;
+	out_view.m_verts = reinterpret_cast<Vertex_PCUTBN const*>(fileBytes + header->m_vertexDataOffset);
+	out_view.m_indexes = reinterpret_cast<unsigned int const*>(fileBytes + header->m_indexDataOffset);
+	out_view.m_numVerts = static_cast<unsigned int>(header->m_numVerts);
+	out_view.m_numIndexes = static_cast<unsigned int>(header->m_numIndexes);
+	out_view.m_bounds = AABB3(header->m_boundsMins[0], header->m_boundsMins[1], header->m_boundsMins[2],
+							  header->m_boundsMaxs[0], header->m_boundsMaxs[1], header->m_boundsMaxs[2]);
+	return true;
+}
+
+void CloseMeshCacheView(MeshCacheView& view)
+{
+	CloseMappedFileView(view.m_fileView);
+	view = MeshCacheView();
+}
+
+bool ReadMeshCacheFile(std::vector<Vertex_PCUTBN>& out_meshVerts, std::vector<unsigned int>& out_meshIndexes, AABB3& out_bounds, char const* cacheFilePath,
+	char const* sourceFilePath, MeshCacheValidation validation, unsigned int requiredFlags)
+{
+	MeshCacheView cacheView;
+	if (!OpenMeshCacheView(cacheView, cacheFilePath, sourceFilePath, validation, requiredFlags))
+	{
+		return false;
+	}
+
+	// Bulk copies straight out of the mapping, no per vertex parsing or fix up
+	out_meshVerts.resize(cacheView.m_numVerts);
+	out_meshIndexes.resize(cacheView.m_numIndexes);
+	if (cacheView.m_numVerts > 0)
+	{
+		memcpy(out_meshVerts.data(), cacheView.m_verts, cacheView.m_numVerts * sizeof(Vertex_PCUTBN));
+	}
+	if (cacheView.m_numIndexes > 0)
+	{
+		memcpy(out_meshIndexes.data(), cacheView.m_indexes, cacheView.m_numIndexes * sizeof(unsigned int));
+	}
+	out_bounds = cacheView.m_bounds;
+	unsigned int numVerts = cacheView.m_numVerts;
+	CloseMeshCacheView(cacheView);
+
+	// The section sizes passed, but a corrupt index would still send the tangent, BVH and simplifier code past the vertexes
+	unsigned int maxIndex = 0;
+	for (int indexIndex = 0; indexIndex < static_cast<int>(out_meshIndexes.size()); ++indexIndex)
+	{
+		maxIndex = std::max(maxIndex, out_meshIndexes[indexIndex]);
+	}
+	if (!out_meshIndexes.empty() && maxIndex >= numVerts)
+	{
+		out_meshVerts.clear();
+		out_meshIndexes.clear();
+		return false;
+	}
+	return true;
+}
+
+AABB3 GetMeshBounds(std::vector<Vertex_PCUTBN> const& meshVerts)
+{
+	if (meshVerts.empty())
+	{
+		return AABB3(Vec3::ZERO, Vec3::ZERO);
+	}
+
+	AABB3 bounds(meshVerts[0].m_position, meshVerts[0].m_position);
+	for (int vertIndex = 1; vertIndex < static_cast<int>(meshVerts.size()); ++vertIndex)
+	{
+		bounds.StretchToIncludePoint(meshVerts[vertIndex].m_position);
+	}
+	return bounds;
+}
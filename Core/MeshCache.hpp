@@ -0,0 +1,88 @@
+#pragma once
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Binary mesh cache (.wmesh), written beside the source asset so later runs skip parsing entirely.
+//
+// Layout: MeshCacheHeader, then the Vertex_PCUTBN array, then the index array, each starting at the
+// offset stored in the header. Everything is stored exactly as it sits in memory, so loading is a
+// single file mapping plus bulk copies (or no copy at all through a MeshCacheView).
+//
+// Validation checks the source asset's timestamp or hash, but only when the source exists. Without it the cache is
+// trusted as it is, so builds can ship the caches alone, and a cache left beside a deleted source is still loaded.
+// -----------------------------------------------------------------------------
+constexpr unsigned int MESH_CACHE_VERSION = 1;
+constexpr unsigned int MESH_CACHE_DATA_ALIGNMENT = 16;
+// -----------------------------------------------------------------------------
+enum class MeshCacheVertexLayout : unsigned int
+{
+	VERTEX_PCUTBN = 1
+};
+// -----------------------------------------------------------------------------
+enum class MeshCacheValidation
+{
+	NONE,		// Trust any cache whose header is intact
+	TIMESTAMP,	// Source last write time and size must match, cheap
+	HASH,		// Source content hash must match, reads the source but never parses it
+	COUNT
+};
+// -----------------------------------------------------------------------------
+enum MeshCacheFlags : unsigned int
+{
+	MESH_CACHE_FLAG_NONE			 = 0,
+	MESH_CACHE_FLAG_INDEXED			 = 1 << 0,
+	MESH_CACHE_FLAG_HAS_TANGENTS	 = 1 << 1,
+	MESH_CACHE_FLAG_OPTIMIZED		 = 1 << 2,	// Triangle and vertex order went through OptimizeMesh
+};
+// -----------------------------------------------------------------------------
+struct MeshCacheHeader
+{
+	char		 m_fourCC[4] = { 'W', 'M', 'S', 'H' };
+	unsigned int m_version = MESH_CACHE_VERSION;
+	unsigned int m_headerSize = 0;
+	unsigned int m_flags = MESH_CACHE_FLAG_NONE;
+
+	unsigned int m_vertexLayout = static_cast<unsigned int>(MeshCacheVertexLayout::VERTEX_PCUTBN);
+	unsigned int m_vertexStride = 0;
+	unsigned int m_indexStride = 0;
+	unsigned int m_padding0 = 0;
+
+	uint64_t	 m_numVerts = 0;
+	uint64_t	 m_numIndexes = 0;
+	uint64_t	 m_vertexDataOffset = 0;
+	uint64_t	 m_indexDataOffset = 0;
+
+	int64_t		 m_sourceLastWriteTime = 0;
+	uint64_t	 m_sourceFileSize = 0;
+	uint64_t	 m_sourceContentHash = 0;
+
+	float		 m_boundsMins[3] = {};
+	float		 m_boundsMaxs[3] = {};
+};
+static_assert(sizeof(MeshCacheHeader) == 112, "MeshCacheHeader layout is part of the file format, bump MESH_CACHE_VERSION when changing it");
+// -----------------------------------------------------------------------------
+struct MeshCacheView
+{
+	// Points straight into the mapped file, valid until CloseMeshCacheView
+	MeshCacheHeader const* m_header = nullptr;
+	Vertex_PCUTBN const*   m_verts = nullptr;
+	unsigned int const*	   m_indexes = nullptr;
+	unsigned int		   m_numVerts = 0;
+	unsigned int		   m_numIndexes = 0;
+	AABB3				   m_bounds;
+	MappedFileView		   m_fileView;
+};
+// -----------------------------------------------------------------------------
+std::string GetMeshCacheFilePath(char const* sourceFilePath, bool isIndexed = true);
+bool WriteMeshCacheFile(char const* cacheFilePath, std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes,
+	char const* sourceFilePath = nullptr, unsigned int extraFlags = MESH_CACHE_FLAG_HAS_TANGENTS);
+bool ReadMeshCacheFile(std::vector<Vertex_PCUTBN>& out_meshVerts, std::vector<unsigned int>& out_meshIndexes, AABB3& out_bounds, char const* cacheFilePath,
+	char const* sourceFilePath = nullptr, MeshCacheValidation validation = MeshCacheValidation::TIMESTAMP, unsigned int requiredFlags = MESH_CACHE_FLAG_NONE); // Replaces the contents of both arrays, fails on any index past the last vertex
+bool OpenMeshCacheView(MeshCacheView& out_view, char const* cacheFilePath, char const* sourceFilePath = nullptr, MeshCacheValidation validation = MeshCacheValidation::TIMESTAMP,
+	unsigned int requiredFlags = MESH_CACHE_FLAG_NONE); // Index values are not checked
+void CloseMeshCacheView(MeshCacheView& view);
+AABB3 GetMeshBounds(std::vector<Vertex_PCUTBN> const& meshVerts);
+// -----------------------------------------------------------------------------
@@ -0,0 +1,389 @@
+#include "Engine/Core/MeshOptimizer.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+// -----------------------------------------------------------------------------
+// Forsyth scoring constants, see "Linear-Speed Vertex Cache Optimisation" (Tom Forsyth, 2006)
+constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+constexpr float FORSYTH_LAST_TRI_SCORE = 0.75f;
+constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+constexpr int	FORSYTH_MAX_VALENCE_TABLE = 64;
+// -----------------------------------------------------------------------------
+struct ForsythScoreTables
+{
+	float m_cacheScores[MESH_OPTIMIZER_MAX_CACHE_SIZE + 3] = {};
+	float m_valenceScores[FORSYTH_MAX_VALENCE_TABLE] = {};
+};
+// -----------------------------------------------------------------------------
+static void BuildForsythScoreTables(ForsythScoreTables& out_tables, int cacheSize)
+{
+	for (int cachePosition = 0; cachePosition < cacheSize + 3; ++cachePosition)
+	{
+		// The three most recent vertexes were just used by the last triangle, so slightly discourage reusing them right away
+		if (cachePosition < 3)
+		{
+			out_tables.m_cacheScores[cachePosition] = FORSYTH_LAST_TRI_SCORE;
+			continue;
+		}
+
+		// Scaled over the positions after those three, so the score falls from 1 at position 3 towards 0 at the end of the cache
+		float fractionAlongCache = static_cast<float>(cachePosition - 3) / static_cast<float>(cacheSize - 3);
+		out_tables.m_cacheScores[cachePosition] = (cachePosition < cacheSize) ? powf(1.f - fractionAlongCache, FORSYTH_CACHE_DECAY_POWER) : 0.f;
+	}
+
+	for (int valence = 1; valence < FORSYTH_MAX_VALENCE_TABLE; ++valence)
+	{
+		out_tables.m_valenceScores[valence] = FORSYTH_VALENCE_BOOST_SCALE * powf(static_cast<float>(valence), -FORSYTH_VALENCE_BOOST_POWER);
+	}
+}
+
+static float GetForsythVertexScore(ForsythScoreTables const& tables, int cachePosition, int numRemainingTris)
+{
+	// Vertexes with nothing left to draw should never attract a triangle
+	if (numRemainingTris == 0)
+	{
+		return -1.f;
+	}
+
+	float score = (cachePosition >= 0) ? tables.m_cacheScores[cachePosition] : 0.f;
+	if (numRemainingTris < FORSYTH_MAX_VALENCE_TABLE)
+	{
+		score += tables.m_valenceScores[numRemainingTris];
+	}
+	else
+	{
+		score += FORSYTH_VALENCE_BOOST_SCALE * powf(static_cast<float>(numRemainingTris), -FORSYTH_VALENCE_BOOST_POWER);
+	}
+	return score;
+}
+
+static int CountFIFOCacheMisses(unsigned int const* triIndexes, std::vector<unsigned int>& vertTimestamps, unsigned int& timestamp, int cacheSize)
+{
+	// A vertex is still cached if fewer than cacheSize misses happened since it was last loaded
+	int numMisses = 0;
+	for (int triCorner = 0; triCorner < 3; ++triCorner)
+	{
+		unsigned int vertIndex = triIndexes[triCorner];
+		if (timestamp - vertTimestamps[vertIndex] > static_cast<unsigned int>(cacheSize))
+		{
+			vertTimestamps[vertIndex] = ++timestamp;
+			++numMisses;
+		}
+	}
+	return numMisses;
+}
+// -----------------------------------------------------------------------------
+void OptimizeMeshVertexCache(std::vector<unsigned int>& meshIndexes, int numVerts, int cacheSize)
+{
+	int numTris = static_cast<int>(meshIndexes.size()) / 3;
+	if (numTris == 0 || numVerts == 0)
+	{
+		return;
+	}
+	cacheSize = GetClamped(cacheSize, 4, MESH_OPTIMIZER_MAX_CACHE_SIZE);
+
+	ForsythScoreTables scoreTables;
+	BuildForsythScoreTables(scoreTables, cacheSize);
+
+	// Triangles per vertex as one flat array, each vertex's active triangles are kept at the front of its span
+	std::vector<int> numRemainingTris(numVerts, 0);
+	for (int cornerIndex = 0; cornerIndex < numTris * 3; ++cornerIndex)
+	{
+		++numRemainingTris[meshIndexes[cornerIndex]];
+	}
+	std::vector<int> vertTriStarts(numVerts + 1, 0);
+	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	{
+		vertTriStarts[vertIndex + 1] = vertTriStarts[vertIndex] + numRemainingTris[vertIndex];
+	}
+	std::vector<int> vertTris(numTris * 3);
+	std::vector<int> vertTriWriteIndexes(vertTriStarts.begin(), vertTriStarts.end() - 1);
+	for (int triIndex = 0; triIndex < numTris; ++triIndex)
+	{
+		for (int triCorner = 0; triCorner < 3; ++triCorner)
+		{
+			vertTris[vertTriWriteIndexes[meshIndexes[triIndex * 3 + triCorner]]++] = triIndex;
+		}
+	}
+
+	// Initial scores with an empty cache
+	std::vector<int> vertCachePositions(numVerts, -1);
+	std::vector<float> vertScores(numVerts);
+	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	{
+		vertScores[vertIndex] = GetForsythVertexScore(scoreTables, -1, numRemainingTris[vertIndex]);
+	}
+
+	std::vector<float> triScores(numTris);
+	std::vector<bool> isTriEmitted(numTris, false);
+	int bestTri = -1;
+	float bestTriScore = -1.f;
+	for (int triIndex = 0; triIndex < numTris; ++triIndex)
+	{
+		unsigned int const* triIndexes = &meshIndexes[triIndex * 3];
+		triScores[triIndex] = vertScores[triIndexes[0]] + vertScores[triIndexes[1]] + vertScores[triIndexes[2]];
+		if (triScores[triIndex] > bestTriScore)
+		{
+			bestTriScore = triScores[triIndex];
+			bestTri = triIndex;
+		}
+	}
+
+	std::vector<unsigned int> optimizedIndexes;
+	optimizedIndexes.reserve(numTris * 3);
+
+	int cache[MESH_OPTIMIZER_MAX_CACHE_SIZE + 3];
+	int newCache[MESH_OPTIMIZER_MAX_CACHE_SIZE + 3];
+	int cacheCount = 0;
+	int inputOrderCursor = 0;
+
+	for (int numEmitted = 0; numEmitted < numTris; ++numEmitted)
+	{
+		// Nothing in the cache touches a remaining triangle, so continue from the next one in input order
+		if (bestTri < 0)
+		{
+			while (isTriEmitted[inputOrderCursor])
+			{
+				++inputOrderCursor;
+			}
+			bestTri = inputOrderCursor;
+		}
+
+		unsigned int const* triIndexes = &meshIndexes[bestTri * 3];
+		optimizedIndexes.push_back(triIndexes[0]);
+		optimizedIndexes.push_back(triIndexes[1]);
+		optimizedIndexes.push_back(triIndexes[2]);
+		isTriEmitted[bestTri] = true;
+
+		// Retire the triangle from its vertexes' active lists
+		for (int triCorner = 0; triCorner < 3; ++triCorner)
+		{
+			int vertIndex = static_cast<int>(triIndexes[triCorner]);
+			int spanStart = vertTriStarts[vertIndex];
+			int spanEnd = spanStart + numRemainingTris[vertIndex];
+			for (int spanIndex = spanStart; spanIndex < spanEnd; ++spanIndex)
+			{
+				if (vertTris[spanIndex] == bestTri)
+				{
+					std::swap(vertTris[spanIndex], vertTris[spanEnd - 1]);
+					--numRemainingTris[vertIndex];
+					break;
+				}
+			}
+		}
+
+		// Push the triangle's vertexes to the front of the LRU cache, everything else shifts back
+		int newCacheCount = 0;
+		for (int triCorner = 0; triCorner < 3; ++triCorner)
+		{
+			newCache[newCacheCount++] = static_cast<int>(triIndexes[triCorner]);
+		}
+		for (int cacheIndex = 0; cacheIndex < cacheCount; ++cacheIndex)
+		{
+			int vertIndex = cache[cacheIndex];
+			if (vertIndex != newCache[0] && vertIndex != newCache[1] && vertIndex != newCache[2])
+			{
+				newCache[newCacheCount++] = vertIndex;
+			}
+		}
+
+		// Entries past the real cache size fall out, but still get rescored below
+		for (int cacheIndex = 0; cacheIndex < newCacheCount; ++cacheIndex)
+		{
+			int vertIndex = newCache[cacheIndex];
+			vertCachePositions[vertIndex] = (cacheIndex < cacheSize) ? cacheIndex : -1;
+			vertScores[vertIndex] = GetForsythVertexScore(scoreTables, vertCachePositions[vertIndex], numRemainingTris[vertIndex]);
+		}
+
+		// Rescore every remaining triangle that touches the cache and pick the best of them
+		bestTri = -1;
+		bestTriScore = -1.f;
+		for (int cacheIndex = 0; cacheIndex < newCacheCount; ++cacheIndex)
+		{
+			int vertIndex = newCache[cacheIndex];
+			int spanStart = vertTriStarts[vertIndex];
+			int spanEnd = spanStart + numRemainingTris[vertIndex];
+			for (int spanIndex = spanStart; spanIndex < spanEnd; ++spanIndex)
+			{
+				int triIndex = vertTris[spanIndex];
+				unsigned int const* candidateIndexes = &meshIndexes[triIndex * 3];
+				float triScore = vertScores[candidateIndexes[0]] + vertScores[candidateIndexes[1]] + vertScores[candidateIndexes[2]];
+				triScores[triIndex] = triScore;
+				if (triScore > bestTriScore)
+				{
+					bestTriScore = triScore;
+					bestTri = triIndex;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCacheCount, cacheSize);
+		for (int cacheIndex = 0; cacheIndex < cacheCount; ++cacheIndex)
+		{
+			cache[cacheIndex] = newCache[cacheIndex];
+		}
+	}
+
+	meshIndexes.swap(optimizedIndexes);
+}
+
+void OptimizeMeshOverdraw(std::vector<unsigned int>& meshIndexes, std::vector<Vertex_PCUTBN> const& meshVerts, float maxACMRGrowth)
+{
+	int numTris = static_cast<int>(meshIndexes.size()) / 3;
+	int numVerts = static_cast<int>(meshVerts.size());
+	if (numTris < 2)
+	{
+		return;
+	}
+
+	// Split the cache optimized order into clusters wherever a triangle misses on all three vertexes,
+	// those are the points where reordering costs the least cache efficiency
+	std::vector<int> clusterStarts;
+	std::vector<unsigned int> vertTimestamps(numVerts, 0);
+	unsigned int timestamp = MESH_ANALYZE_CACHE_SIZE + 1;
+	for (int triIndex = 0; triIndex < numTris; ++triIndex)
+	{
+		int numMisses = CountFIFOCacheMisses(&meshIndexes[triIndex * 3], vertTimestamps, timestamp, MESH_ANALYZE_CACHE_SIZE);
+		if (triIndex == 0 || numMisses == 3)
+		{
+			clusterStarts.push_back(triIndex);
+		}
+	}
+	clusterStarts.push_back(numTris);
+	int numClusters = static_cast<int>(clusterStarts.size()) - 1;
+	if (numClusters < 2)
+	{
+		return;
+	}
+
+	// Clusters facing away from the middle of the mesh are most likely to occlude the rest, so draw them first
+	Vec3 meshCentroid = Vec3::ZERO;
+	float meshArea = 0.f;
+	std::vector<Vec3> clusterCentroids(numClusters);
+	std::vector<Vec3> clusterNormals(numClusters);
+	for (int clusterIndex = 0; clusterIndex < numClusters; ++clusterIndex)
+	{
+		Vec3 centroidSum = Vec3::ZERO;
+		Vec3 normalSum = Vec3::ZERO;
+		float clusterArea = 0.f;
+		for (int triIndex = clusterStarts[clusterIndex]; triIndex < clusterStarts[clusterIndex + 1]; ++triIndex)
+		{
+			Vec3 const& p0 = meshVerts[meshIndexes[triIndex * 3]].m_position;
+			Vec3 const& p1 = meshVerts[meshIndexes[triIndex * 3 + 1]].m_position;
+			Vec3 const& p2 = meshVerts[meshIndexes[triIndex * 3 + 2]].m_position;
+			Vec3 areaNormal = CrossProduct3D(p1 - p0, p2 - p0);
+			float triArea = areaNormal.GetLength() * 0.5f;
+
+			centroidSum += (p0 + p1 + p2) * (triArea / 3.f);
+			normalSum += areaNormal;
+			clusterArea += triArea;
+		}
+
+		clusterCentroids[clusterIndex] = (clusterArea > 0.f) ? centroidSum / clusterArea : meshVerts[meshIndexes[clusterStarts[clusterIndex] * 3]].m_position;
+		clusterNormals[clusterIndex] = normalSum.GetNormalized();
+		meshCentroid += centroidSum;
+		meshArea += clusterArea;
+	}
+	if (meshArea > 0.f)
+	{
+		meshCentroid /= meshArea;
+	}
+
+	std::vector<float> clusterSortKeys(numClusters);
+	std::vector<int> clusterOrder(numClusters);
+	for (int clusterIndex = 0; clusterIndex < numClusters; ++clusterIndex)
+	{
+		clusterSortKeys[clusterIndex] = DotProduct3D(clusterCentroids[clusterIndex] - meshCentroid, clusterNormals[clusterIndex]);
+		clusterOrder[clusterIndex] = clusterIndex;
+	}
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](int clusterA, int clusterB)
+	{
+		return clusterSortKeys[clusterA] > clusterSortKeys[clusterB];
+	});
+
+	std::vector<unsigned int> sortedIndexes;
+	sortedIndexes.reserve(meshIndexes.size());
+	for (int orderIndex = 0; orderIndex < numClusters; ++orderIndex)
+	{
+		int clusterIndex = clusterOrder[orderIndex];
+		sortedIndexes.insert(sortedIndexes.end(), meshIndexes.begin() + clusterStarts[clusterIndex] * 3, meshIndexes.begin() + clusterStarts[clusterIndex + 1] * 3);
+	}
+
+	// Keep the cache order if the sort cost more vertex transforms than we are willing to pay
+	float acmrBefore = AnalyzeMeshVertexCache(meshIndexes, numVerts).m_acmr;
+	float acmrAfter = AnalyzeMeshVertexCache(sortedIndexes, numVerts).m_acmr;
+	if (acmrAfter <= acmrBefore * maxACMRGrowth)
+	{
+		meshIndexes.swap(sortedIndexes);
+	}
+}
+
+int OptimizeMeshVertexFetch(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes)
+{
+	// Lay vertexes out in the order the index buffer first touches them
+	constexpr unsigned int UNUSED_VERT = 0xFFFFFFFFu;
+	std::vector<unsigned int> newIndexForVert(meshVerts.size(), UNUSED_VERT);
+	std::vector<Vertex_PCUTBN> reorderedVerts;
+	reorderedVerts.reserve(meshVerts.size());
+
+	for (int cornerIndex = 0; cornerIndex < static_cast<int>(meshIndexes.size()); ++cornerIndex)
+	{
+		unsigned int oldVertIndex = meshIndexes[cornerIndex];
+		if (newIndexForVert[oldVertIndex] == UNUSED_VERT)
+		{
+			newIndexForVert[oldVertIndex] = static_cast<unsigned int>(reorderedVerts.size());
+			reorderedVerts.push_back(meshVerts[oldVertIndex]);
+		}
+		meshIndexes[cornerIndex] = newIndexForVert[oldVertIndex];
+	}
+
+	meshVerts.swap(reorderedVerts);
+	return static_cast<int>(meshVerts.size());
+}
+
+void OptimizeMesh(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes)
+{
+	OptimizeMeshVertexCache(meshIndexes, static_cast<int>(meshVerts.size()));
+	OptimizeMeshOverdraw(meshIndexes, meshVerts);
+	OptimizeMeshVertexFetch(meshVerts, meshIndexes);
+}
+// -----------------------------------------------------------------------------
+MeshVertexCacheStats AnalyzeMeshVertexCache(std::vector<unsigned int> const& meshIndexes, int numVerts, int cacheSize)
+{
+	MeshVertexCacheStats stats;
+	stats.m_numTriangles = static_cast<int>(meshIndexes.size()) / 3;
+	if (stats.m_numTriangles == 0 || numVerts == 0)
+	{
+		return stats;
+	}
+
+	// Timestamps start far enough back that every vertex begins uncached
+	std::vector<unsigned int> vertTimestamps(numVerts, 0);
+	std::vector<bool> isVertUsed(numVerts, false);
+	unsigned int timestamp = static_cast<unsigned int>(cacheSize) + 1;
+	for (int triIndex = 0; triIndex < stats.m_numTriangles; ++triIndex)
+	{
+		stats.m_numVertTransforms += CountFIFOCacheMisses(&meshIndexes[triIndex * 3], vertTimestamps, timestamp, cacheSize);
+		for (int triCorner = 0; triCorner < 3; ++triCorner)
+		{
+			unsigned int vertIndex = meshIndexes[triIndex * 3 + triCorner];
+			if (!isVertUsed[vertIndex])
+			{
+				isVertUsed[vertIndex] = true;
+				++stats.m_numUniqueVerts;
+			}
+		}
+	}
+
+	stats.m_acmr = static_cast<float>(stats.m_numVertTransforms) / static_cast<float>(stats.m_numTriangles);
+	stats.m_atvr = static_cast<float>(stats.m_numVertTransforms) / static_cast<float>(stats.m_numUniqueVerts);
+	return stats;
+}
+
+std::string GetMeshVertexCacheReport(MeshVertexCacheStats const& beforeStats, MeshVertexCacheStats const& afterStats)
+{
+	return Stringf("Mesh vertex cache: %d tris, %d verts | ACMR %.3f -> %.3f | ATVR %.3f -> %.3f | transforms %d -> %d",
+		afterStats.m_numTriangles, afterStats.m_numUniqueVerts, beforeStats.m_acmr, afterStats.m_acmr,
+		beforeStats.m_atvr, afterStats.m_atvr, beforeStats.m_numVertTransforms, afterStats.m_numVertTransforms);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int MESH_OPTIMIZER_CACHE_SIZE = 32;	// Cache the Forsyth scores are tuned for, modern GPUs behave about like this
+constexpr int MESH_ANALYZE_CACHE_SIZE = 16;		// FIFO size used when reporting ACMR/ATVR, the classic post transform cache
+constexpr int MESH_OPTIMIZER_MAX_CACHE_SIZE = 64;
+// -----------------------------------------------------------------------------
+struct MeshVertexCacheStats
+{
+	int   m_numTriangles = 0;
+	int   m_numUniqueVerts = 0;
+	int   m_numVertTransforms = 0;
+	float m_acmr = 0.f;	// Average cache miss ratio, vertex transforms per triangle. 0.5 is ideal, 3.0 is worst
+	float m_atvr = 0.f;	// Average transform to vertex ratio, vertex transforms per unique vertex. 1.0 is ideal
+};
+// -----------------------------------------------------------------------------
+// Offline or load-time optimization passes for indexed triangle lists, run in this order:
+//	1. OptimizeMeshVertexCache	- Tom Forsyth's linear speed vertex cache reordering of the triangles
+//	2. OptimizeMeshOverdraw		- Sorts cache friendly triangle clusters outside-in, as long as ACMR barely moves
+//	3. OptimizeMeshVertexFetch	- Reorders vertexes by first use, dropping unreferenced ones
+void OptimizeMeshVertexCache(std::vector<unsigned int>& meshIndexes, int numVerts, int cacheSize = MESH_OPTIMIZER_CACHE_SIZE);
+void OptimizeMeshOverdraw(std::vector<unsigned int>& meshIndexes, std::vector<Vertex_PCUTBN> const& meshVerts, float maxACMRGrowth = 1.05f);
+int  OptimizeMeshVertexFetch(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes); // Returns the new vertex count
+void OptimizeMesh(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes);
+// -----------------------------------------------------------------------------
+MeshVertexCacheStats AnalyzeMeshVertexCache(std::vector<unsigned int> const& meshIndexes, int numVerts, int cacheSize = MESH_ANALYZE_CACHE_SIZE);
+std::string			 GetMeshVertexCacheReport(MeshVertexCacheStats const& beforeStats, MeshVertexCacheStats const& afterStats);
+// -----------------------------------------------------------------------------
@@ -0,0 +1,690 @@
+#include "Engine/Core/MeshSimplifier.hpp"
+#include "Engine/Core/MeshUtils.hpp"
+#include "Engine/Core/MeshOptimizer.hpp"
+#include "Engine/Core/MeshCache.hpp"
+#include "Engine/Renderer/Camera.h"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+// -----------------------------------------------------------------------------
+constexpr float SIMPLIFY_BORDER_WEIGHT = 10.f;	// How strongly open borders resist moving, relative to the faces beside them
+constexpr float SIMPLIFY_NORMAL_WEIGHT = 0.01f; // Squared relative error charged for collapsing onto a vertex whose normal is 90 degrees off
+constexpr float SIMPLIFY_MIN_FLIP_DOT = 0.25f;	// Collapses that rotate any surviving face by more than ~75 degrees are rejected
+// -----------------------------------------------------------------------------
+enum class SimplifyVertexKind
+{
+	MANIFOLD,	// Interior vertex with a single set of attributes, free to collapse onto any neighbor
+	BORDER,		// On an open edge, only collapses along that edge
+	SEAM,		// One of exactly two vertexes sharing a position, only collapses along the seam together with its sibling
+	LOCKED,		// Corners, seam junctions and anything non-manifold never move
+	COUNT
+};
+// -----------------------------------------------------------------------------
+struct MeshQuadric
+{
+	// Upper triangle of the symmetric 4x4 plane quadric, plus the total weight for normalizing the error
+	double m_xx = 0.0, m_xy = 0.0, m_xz = 0.0, m_xw = 0.0;
+	double m_yy = 0.0, m_yz = 0.0, m_yw = 0.0;
+	double m_zz = 0.0, m_zw = 0.0;
+	double m_ww = 0.0;
+	double m_weight = 0.0;
+};
+// -----------------------------------------------------------------------------
+struct SimplifyAdjacency
+{
+	// Triangles touching each key (a vertex or a position group) as one flat array
+	std::vector<int> m_triStarts;
+	std::vector<int> m_tris;
+};
+// -----------------------------------------------------------------------------
+struct SimplifyCollapse
+{
+	int	  m_fromVert = 0;
+	int	  m_toVert = 0;
+	float m_error = 0.f; // Squared, relative to the bounding radius
+};
+// -----------------------------------------------------------------------------
+static MeshQuadric MakePlaneQuadric(Vec3 const& planeNormal, Vec3 const& pointOnPlane, float weight)
+{
+	double a = planeNormal.x;
+	double b = planeNormal.y;
+	double c = planeNormal.z;
+	double d = -static_cast<double>(DotProduct3D(planeNormal, pointOnPlane));
+
+	MeshQuadric quadric;
+	quadric.m_xx = weight * a * a; quadric.m_xy = weight * a * b; quadric.m_xz = weight * a * c; quadric.m_xw = weight * a * d;
+	quadric.m_yy = weight * b * b; quadric.m_yz = weight * b * c; quadric.m_yw = weight * b * d;
+	quadric.m_zz = weight * c * c; quadric.m_zw = weight * c * d;
+	quadric.m_ww = weight * d * d;
+	quadric.m_weight = weight;
+	return quadric;
+}
+
+static void AddQuadric(MeshQuadric& quadric, MeshQuadric const& quadricToAdd)
+{
+	quadric.m_xx += quadricToAdd.m_xx; quadric.m_xy += quadricToAdd.m_xy; quadric.m_xz += quadricToAdd.m_xz; quadric.m_xw += quadricToAdd.m_xw;
+	quadric.m_yy += quadricToAdd.m_yy; quadric.m_yz += quadricToAdd.m_yz; quadric.m_yw += quadricToAdd.m_yw;
+	quadric.m_zz += quadricToAdd.m_zz; quadric.m_zw += quadricToAdd.m_zw;
+	quadric.m_ww += quadricToAdd.m_ww;
+	quadric.m_weight += quadricToAdd.m_weight;
+}
+
+static double GetQuadricError(MeshQuadric const& quadric, Vec3 const& position)
+{
+	// Weighted mean squared distance from position to every plane folded into the quadric
+	double x = position.x;
+	double y = position.y;
+	double z = position.z;
+	double error = quadric.m_xx * x * x + 2.0 * quadric.m_xy * x * y + 2.0 * quadric.m_xz * x * z + 2.0 * quadric.m_xw * x
+				 + quadric.m_yy * y * y + 2.0 * quadric.m_yz * y * z + 2.0 * quadric.m_yw * y
+				 + quadric.m_zz * z * z + 2.0 * quadric.m_zw * z
+				 + quadric.m_ww;
+	return (quadric.m_weight > 0.0) ? fabs(error) / quadric.m_weight : 0.0;
+}
+
+static void BuildSimplifyAdjacency(SimplifyAdjacency& out_adjacency, std::vector<unsigned int> const& meshIndexes, std::vector<int> const& keyForVert, int numKeys)
+{
+	int numCorners = static_cast<int>(meshIndexes.size());
+	out_adjacency.m_triStarts.assign(numKeys + 1, 0);
+	for (int cornerIndex = 0; cornerIndex < numCorners; ++cornerIndex)
+	{
+		++out_adjacency.m_triStarts[keyForVert[meshIndexes[cornerIndex]] + 1];
+	}
+	for (int keyIndex = 0; keyIndex < numKeys; ++keyIndex)
+	{
+		out_adjacency.m_triStarts[keyIndex + 1] += out_adjacency.m_triStarts[keyIndex];
+	}
+
+	out_adjacency.m_tris.resize(numCorners);
+	std::vector<int> writeIndexes(out_adjacency.m_triStarts.begin(), out_adjacency.m_triStarts.end() - 1);
+	for (int cornerIndex = 0; cornerIndex < numCorners; ++cornerIndex)
+	{
+		out_adjacency.m_tris[writeIndexes[keyForVert[meshIndexes[cornerIndex]]]++] = cornerIndex / 3;
+	}
+}
+
+static bool HasHalfEdge(SimplifyAdjacency const& adjacency, std::vector<unsigned int> const& meshIndexes, std::vector<int> const& keyForVert, int fromKey, int toKey)
+{
+	// Valences are small, so scanning the few triangles around fromKey beats any hash lookup
+	for (int spanIndex = adjacency.m_triStarts[fromKey]; spanIndex < adjacency.m_triStarts[fromKey + 1]; ++spanIndex)
+	{
+		unsigned int const* triIndexes = &meshIndexes[adjacency.m_tris[spanIndex] * 3];
+		for (int triCorner = 0; triCorner < 3; ++triCorner)
+		{
+			if (keyForVert[triIndexes[triCorner]] == fromKey && keyForVert[triIndexes[(triCorner + 1) % 3]] == toKey)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static bool IsEdgeOpen(SimplifyAdjacency const& adjacency, std::vector<unsigned int> const& meshIndexes, std::vector<int> const& keyForVert, int keyA, int keyB)
+{
+	// An edge is open when only one of its two half edges exists
+	return HasHalfEdge(adjacency, meshIndexes, keyForVert, keyA, keyB) != HasHalfEdge(adjacency, meshIndexes, keyForVert, keyB, keyA);
+}
+
+static void GetMeshBoundingSphere(std::vector<Vertex_PCUTBN> const& meshVerts, Vec3& out_center, float& out_radius)
+{
+	AABB3 bounds = GetMeshBounds(meshVerts);
+	out_center = (bounds.m_mins + bounds.m_maxs) * 0.5f;
+
+	float radiusSquared = 0.f;
+	for (int vertIndex = 0; vertIndex < static_cast<int>(meshVerts.size()); ++vertIndex)
+	{
+		radiusSquared = std::max(radiusSquared, (meshVerts[vertIndex].m_position - out_center).GetLengthSquared());
+	}
+	out_radius = sqrtf(radiusSquared);
+}
+
+static bool IsCollapseFlipFree(std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes, std::vector<int> const& groupForVert,
+	SimplifyAdjacency const& vertAdjacency, int fromVert, int toVert)
+{
+	Vec3 const& toPos = meshVerts[toVert].m_position;
+	int toGroup = groupForVert[toVert];
+
+	for (int spanIndex = vertAdjacency.m_triStarts[fromVert]; spanIndex < vertAdjacency.m_triStarts[fromVert + 1]; ++spanIndex)
+	{
+		unsigned int const* triIndexes = &meshIndexes[vertAdjacency.m_tris[spanIndex] * 3];
+
+		// Triangles touching both ends disappear with the collapse
+		if (groupForVert[triIndexes[0]] == toGroup || groupForVert[triIndexes[1]] == toGroup || groupForVert[triIndexes[2]] == toGroup)
+		{
+			continue;
+		}
+
+		Vec3 const& p0 = meshVerts[triIndexes[0]].m_position;
+		Vec3 const& p1 = meshVerts[triIndexes[1]].m_position;
+		Vec3 const& p2 = meshVerts[triIndexes[2]].m_position;
+		Vec3 normalBefore = CrossProduct3D(p1 - p0, p2 - p0);
+
+		Vec3 q0 = (static_cast<int>(triIndexes[0]) == fromVert) ? toPos : p0;
+		Vec3 q1 = (static_cast<int>(triIndexes[1]) == fromVert) ? toPos : p1;
+		Vec3 q2 = (static_cast<int>(triIndexes[2]) == fromVert) ? toPos : p2;
+		Vec3 normalAfter = CrossProduct3D(q1 - q0, q2 - q0);
+
+		if (DotProduct3D(normalBefore, normalAfter) < SIMPLIFY_MIN_FLIP_DOT * normalBefore.GetLength() * normalAfter.GetLength())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static float GetNormalCollapseError(Vertex_PCUTBN const& fromVert, Vertex_PCUTBN const& toVert)
+{
+	// Meshes without normals yet simply pay nothing here
+	if (fromVert.m_normal == Vec3::ZERO || toVert.m_normal == Vec3::ZERO)
+	{
+		return 0.f;
+	}
+	return SIMPLIFY_NORMAL_WEIGHT * std::max(0.f, 1.f - DotProduct3D(fromVert.m_normal, toVert.m_normal));
+}
+
+static float GetDistanceSquaredToTriangle3D(Vec3 const& referencePos, Vec3 const& p0, Vec3 const& p1, Vec3 const& p2)
+{
+	// Voronoi region walk from Real-Time Collision Detection 5.1.5, only the distance is needed
+	Vec3 edge01 = p1 - p0;
+	Vec3 edge02 = p2 - p0;
+	Vec3 toRef0 = referencePos - p0;
+	float d1 = DotProduct3D(edge01, toRef0);
+	float d2 = DotProduct3D(edge02, toRef0);
+	if (d1 <= 0.f && d2 <= 0.f)
+	{
+		return toRef0.GetLengthSquared();
+	}
+
+	Vec3 toRef1 = referencePos - p1;
+	float d3 = DotProduct3D(edge01, toRef1);
+	float d4 = DotProduct3D(edge02, toRef1);
+	if (d3 >= 0.f && d4 <= d3)
+	{
+		return toRef1.GetLengthSquared();
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+	{
+		return (referencePos - (p0 + edge01 * (d1 / (d1 - d3)))).GetLengthSquared();
+	}
+
+	Vec3 toRef2 = referencePos - p2;
+	float d5 = DotProduct3D(edge01, toRef2);
+	float d6 = DotProduct3D(edge02, toRef2);
+	if (d6 >= 0.f && d5 <= d6)
+	{
+		return toRef2.GetLengthSquared();
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+	{
+		return (referencePos - (p0 + edge02 * (d2 / (d2 - d6)))).GetLengthSquared();
+	}
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+	{
+		return (referencePos - (p1 + (p2 - p1) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))))).GetLengthSquared();
+	}
+
+	float denominator = va + vb + vc;
+	if (denominator <= 0.f)
+	{
+		return toRef0.GetLengthSquared(); // Degenerate sliver, the corners are close enough
+	}
+	Vec3 nearestPoint = p0 + edge01 * (vb / denominator) + edge02 * (vc / denominator);
+	return (referencePos - nearestPoint).GetLengthSquared();
+}
+// -----------------------------------------------------------------------------
+std::vector<unsigned int> SimplifyMesh(std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes, int targetIndexCount,
+	float maxError, float* out_resultError)
+{
+	int numVerts = static_cast<int>(meshVerts.size());
+
+	std::vector<int> groupForVert;
+	int numGroups = WeldMeshVertexes(meshVerts, false, groupForVert);
+
+	// Triangles that are already degenerate in position space carry nothing, drop them up front
+	std::vector<unsigned int> resultIndexes;
+	resultIndexes.reserve(meshIndexes.size());
+	for (int cornerIndex = 0; cornerIndex + 2 < static_cast<int>(meshIndexes.size()); cornerIndex += 3)
+	{
+		int group0 = groupForVert[meshIndexes[cornerIndex]];
+		int group1 = groupForVert[meshIndexes[cornerIndex + 1]];
+		int group2 = groupForVert[meshIndexes[cornerIndex + 2]];
+		if (group0 != group1 && group1 != group2 && group2 != group0)
+		{
+			resultIndexes.insert(resultIndexes.end(), meshIndexes.begin() + cornerIndex, meshIndexes.begin() + cornerIndex + 3);
+		}
+	}
+
+	// Errors are measured relative to the bounding radius so maxError means the same thing at any scale
+	Vec3 boundsCenter;
+	float boundsRadius = 0.f;
+	GetMeshBoundingSphere(meshVerts, boundsCenter, boundsRadius);
+	float invRadiusSquared = (boundsRadius > 0.f) ? 1.f / (boundsRadius * boundsRadius) : 1.f;
+	float maxErrorSquared = maxError * maxError;
+
+	// Every input vertex remembers which surviving vertex it was collapsed into, for measuring the result afterwards
+	std::vector<bool> isVertInput(numVerts, false);
+	std::vector<int> survivorForVert(numVerts);
+	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	{
+		survivorForVert[vertIndex] = vertIndex;
+	}
+	for (unsigned int index : resultIndexes)
+	{
+		isVertInput[index] = true;
+	}
+
+	// Siblings sharing a position form a circular list
+	std::vector<int> wedgeNext(numVerts);
+	std::vector<int> firstVertForGroup(numGroups, -1);
+	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	{
+		int& firstVert = firstVertForGroup[groupForVert[vertIndex]];
+		if (firstVert < 0)
+		{
+			firstVert = vertIndex;
+			wedgeNext[vertIndex] = vertIndex;
+		}
+		else
+		{
+			wedgeNext[vertIndex] = wedgeNext[firstVert];
+			wedgeNext[firstVert] = vertIndex;
+		}
+	}
+
+	// Area weighted face planes per position, plus planes standing up along open borders to hold the silhouette
+	std::vector<MeshQuadric> groupQuadrics(numGroups);
+	SimplifyAdjacency groupAdjacency;
+	BuildSimplifyAdjacency(groupAdjacency, resultIndexes, groupForVert, numGroups);
+	for (int triIndex = 0; triIndex < static_cast<int>(resultIndexes.size()) / 3; ++triIndex)
+	{
+		Vec3 const& p0 = meshVerts[resultIndexes[triIndex * 3]].m_position;
+		Vec3 const& p1 = meshVerts[resultIndexes[triIndex * 3 + 1]].m_position;
+		Vec3 const& p2 = meshVerts[resultIndexes[triIndex * 3 + 2]].m_position;
+		Vec3 areaNormal = CrossProduct3D(p1 - p0, p2 - p0);
+		float doubleArea = areaNormal.GetLength();
+		if (doubleArea <= 0.f)
+		{
+			continue;
+		}
+		Vec3 faceNormal = areaNormal / doubleArea;
+
+		MeshQuadric faceQuadric = MakePlaneQuadric(faceNormal, p0, doubleArea * 0.5f);
+		for (int triCorner = 0; triCorner < 3; ++triCorner)
+		{
+			int group = groupForVert[resultIndexes[triIndex * 3 + triCorner]];
+			AddQuadric(groupQuadrics[group], faceQuadric);
+
+			int nextGroup = groupForVert[resultIndexes[triIndex * 3 + (triCorner + 1) % 3]];
+			if (!HasHalfEdge(groupAdjacency, resultIndexes, groupForVert, nextGroup, group))
+			{
+				Vec3 const& edgeStart = meshVerts[resultIndexes[triIndex * 3 + triCorner]].m_position;
+				Vec3 edge = meshVerts[resultIndexes[triIndex * 3 + (triCorner + 1) % 3]].m_position - edgeStart;
+				Vec3 borderNormal = CrossProduct3D(edge, faceNormal).GetNormalized();
+				MeshQuadric borderQuadric = MakePlaneQuadric(borderNormal, edgeStart, edge.GetLengthSquared() * SIMPLIFY_BORDER_WEIGHT);
+				AddQuadric(groupQuadrics[group], borderQuadric);
+				AddQuadric(groupQuadrics[nextGroup], borderQuadric);
+			}
+		}
+	}
+
+	std::vector<SimplifyVertexKind> vertKinds(numVerts);
+	std::vector<int> numLiveVertsInGroup(numGroups);
+	std::vector<int> openGroupOut(numGroups);
+	std::vector<int> openGroupIn(numGroups);
+	std::vector<int> openVertOut(numVerts);
+	std::vector<int> openVertIn(numVerts);
+	std::vector<bool> isVertLive(numVerts);
+	std::vector<bool> isGroupLocked(numGroups);
+	std::vector<int> collapseRemap(numVerts);
+	std::vector<int> vertForVert(numVerts);
+	std::vector<SimplifyCollapse> collapses;
+	SimplifyAdjacency vertAdjacency;
+	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	{
+		vertForVert[vertIndex] = vertIndex;
+	}
+
+	// Each pass collapses a batch of cheap, non-overlapping edges, then rebuilds topology for the next pass
+	while (static_cast<int>(resultIndexes.size()) > targetIndexCount)
+	{
+		int numTris = static_cast<int>(resultIndexes.size()) / 3;
+
+		BuildSimplifyAdjacency(vertAdjacency, resultIndexes, vertForVert, numVerts);
+		BuildSimplifyAdjacency(groupAdjacency, resultIndexes, groupForVert, numGroups);
+		std::fill(numLiveVertsInGroup.begin(), numLiveVertsInGroup.end(), 0);
+		std::fill(openGroupOut.begin(), openGroupOut.end(), 0);
+		std::fill(openGroupIn.begin(), openGroupIn.end(), 0);
+		std::fill(openVertOut.begin(), openVertOut.end(), 0);
+		std::fill(openVertIn.begin(), openVertIn.end(), 0);
+		std::fill(isVertLive.begin(), isVertLive.end(), false);
+
+		for (int cornerIndex = 0; cornerIndex < numTris * 3; ++cornerIndex)
+		{
+			int vertIndex = static_cast<int>(resultIndexes[cornerIndex]);
+			int nextVert = static_cast<int>(resultIndexes[(cornerIndex % 3 == 2) ? cornerIndex - 2 : cornerIndex + 1]);
+			if (!isVertLive[vertIndex])
+			{
+				isVertLive[vertIndex] = true;
+				++numLiveVertsInGroup[groupForVert[vertIndex]];
+			}
+			if (!HasHalfEdge(vertAdjacency, resultIndexes, vertForVert, nextVert, vertIndex))
+			{
+				++openVertOut[vertIndex];
+				++openVertIn[nextVert];
+			}
+			if (!HasHalfEdge(groupAdjacency, resultIndexes, groupForVert, groupForVert[nextVert], groupForVert[vertIndex]))
+			{
+				++openGroupOut[groupForVert[vertIndex]];
+				++openGroupIn[groupForVert[nextVert]];
+			}
+		}
+
+		for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+		{
+			int group = groupForVert[vertIndex];
+			bool isOnBorder = openGroupOut[group] > 0 || openGroupIn[group] > 0;
+			SimplifyVertexKind kind = SimplifyVertexKind::LOCKED;
+			if (numLiveVertsInGroup[group] == 1)
+			{
+				if (!isOnBorder)
+				{
+					kind = SimplifyVertexKind::MANIFOLD;
+				}
+				else if (openGroupOut[group] == 1 && openGroupIn[group] == 1)
+				{
+					kind = SimplifyVertexKind::BORDER;
+				}
+			}
+			else if (numLiveVertsInGroup[group] == 2 && !isOnBorder && openVertOut[vertIndex] == 1 && openVertIn[vertIndex] == 1)
+			{
+				kind = SimplifyVertexKind::SEAM;
+			}
+			vertKinds[vertIndex] = kind;
+		}
+
+		// Score both directions of every edge that is allowed to collapse
+		collapses.clear();
+		for (int cornerIndex = 0; cornerIndex < numTris * 3; ++cornerIndex)
+		{
+			int vertA = static_cast<int>(resultIndexes[cornerIndex]);
+			int vertB = static_cast<int>(resultIndexes[(cornerIndex % 3 == 2) ? cornerIndex - 2 : cornerIndex + 1]);
+
+			// Interior edges show up once per side, only score them from the lower index
+			if (vertA > vertB && HasHalfEdge(vertAdjacency, resultIndexes, vertForVert, vertB, vertA))
+			{
+				continue;
+			}
+
+			for (int direction = 0; direction < 2; ++direction)
+			{
+				int fromVert = (direction == 0) ? vertA : vertB;
+				int toVert = (direction == 0) ? vertB : vertA;
+				int fromGroup = groupForVert[fromVert];
+				int toGroup = groupForVert[toVert];
+
+				SimplifyVertexKind fromKind = vertKinds[fromVert];
+				bool canCollapse = (fromKind == SimplifyVertexKind::MANIFOLD) ||
+								   (fromKind == SimplifyVertexKind::BORDER && IsEdgeOpen(groupAdjacency, resultIndexes, groupForVert, fromGroup, toGroup)) ||
+								   (fromKind == SimplifyVertexKind::SEAM && IsEdgeOpen(vertAdjacency, resultIndexes, vertForVert, fromVert, toVert));
+				if (!canCollapse)
+				{
+					continue;
+				}
+
+				MeshQuadric mergedQuadric = groupQuadrics[fromGroup];
+				AddQuadric(mergedQuadric, groupQuadrics[toGroup]);
+
+				SimplifyCollapse collapse;
+				collapse.m_fromVert = fromVert;
+				collapse.m_toVert = toVert;
+				collapse.m_error = static_cast<float>(GetQuadricError(mergedQuadric, meshVerts[toVert].m_position)) * invRadiusSquared
+								 + GetNormalCollapseError(meshVerts[fromVert], meshVerts[toVert]);
+				collapses.push_back(collapse);
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](SimplifyCollapse const& collapseA, SimplifyCollapse const& collapseB)
+		{
+			return collapseA.m_error < collapseB.m_error;
+		});
+
+		// Every collapse removes about two triangles
+		int collapseGoal = std::max(1, (numTris - targetIndexCount / 3) / 2);
+		int numCollapses = 0;
+		std::fill(isGroupLocked.begin(), isGroupLocked.end(), false);
+		for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+		{
+			collapseRemap[vertIndex] = vertIndex;
+		}
+
+		for (int collapseIndex = 0; collapseIndex < static_cast<int>(collapses.size()) && numCollapses < collapseGoal; ++collapseIndex)
+		{
+			SimplifyCollapse const& collapse = collapses[collapseIndex];
+			if (collapse.m_error > maxErrorSquared)
+			{
+				break;
+			}
+
+			int fromVert = collapse.m_fromVert;
+			int toVert = collapse.m_toVert;
+			int fromGroup = groupForVert[fromVert];
+			int toGroup = groupForVert[toVert];
+			if (isGroupLocked[fromGroup] || isGroupLocked[toGroup])
+			{
+				continue;
+			}
+
+			// A seam vertex drags its sibling along the matching seam edge on the other side
+			int siblingFromVert = -1;
+			int siblingToVert = -1;
+			if (vertKinds[fromVert] == SimplifyVertexKind::SEAM)
+			{
+				for (int wedgeVert = wedgeNext[fromVert]; wedgeVert != fromVert; wedgeVert = wedgeNext[wedgeVert])
+				{
+					if (isVertLive[wedgeVert])
+					{
+						siblingFromVert = wedgeVert;
+						break;
+					}
+				}
+				if (siblingFromVert < 0 || vertKinds[siblingFromVert] != SimplifyVertexKind::SEAM)
+				{
+					continue;
+				}
+
+				for (int wedgeVert = wedgeNext[toVert]; wedgeVert != toVert; wedgeVert = wedgeNext[wedgeVert])
+				{
+					if (isVertLive[wedgeVert] && IsEdgeOpen(vertAdjacency, resultIndexes, vertForVert, siblingFromVert, wedgeVert))
+					{
+						siblingToVert = wedgeVert;
+						break;
+					}
+				}
+				if (siblingToVert < 0)
+				{
+					continue;
+				}
+			}
+
+			if (!IsCollapseFlipFree(meshVerts, resultIndexes, groupForVert, vertAdjacency, fromVert, toVert) ||
+				(siblingFromVert >= 0 && !IsCollapseFlipFree(meshVerts, resultIndexes, groupForVert, vertAdjacency, siblingFromVert, siblingToVert)))
+			{
+				continue;
+			}
+
+			collapseRemap[fromVert] = toVert;
+			if (siblingFromVert >= 0)
+			{
+				collapseRemap[siblingFromVert] = siblingToVert;
+			}
+			AddQuadric(groupQuadrics[toGroup], groupQuadrics[fromGroup]);
+			++numCollapses;
+
+			// Lock the whole one ring so later flip tests in this pass still see the positions they test against
+			isGroupLocked[fromGroup] = true;
+			isGroupLocked[toGroup] = true;
+			for (int wedgeVert = fromVert; ; )
+			{
+				for (int spanIndex = vertAdjacency.m_triStarts[wedgeVert]; spanIndex < vertAdjacency.m_triStarts[wedgeVert + 1]; ++spanIndex)
+				{
+					int triIndex = vertAdjacency.m_tris[spanIndex];
+					isGroupLocked[groupForVert[resultIndexes[triIndex * 3]]] = true;
+					isGroupLocked[groupForVert[resultIndexes[triIndex * 3 + 1]]] = true;
+					isGroupLocked[groupForVert[resultIndexes[triIndex * 3 + 2]]] = true;
+				}
+				wedgeVert = wedgeNext[wedgeVert];
+				if (wedgeVert == fromVert)
+				{
+					break;
+				}
+			}
+		}
+
+		if (numCollapses == 0)
+		{
+			break;
+		}
+
+		// Apply the batch and throw away triangles that collapsed to a line
+		int writeIndex = 0;
+		for (int triIndex = 0; triIndex < numTris; ++triIndex)
+		{
+			unsigned int index0 = static_cast<unsigned int>(collapseRemap[resultIndexes[triIndex * 3]]);
+			unsigned int index1 = static_cast<unsigned int>(collapseRemap[resultIndexes[triIndex * 3 + 1]]);
+			unsigned int index2 = static_cast<unsigned int>(collapseRemap[resultIndexes[triIndex * 3 + 2]]);
+			if (groupForVert[index0] == groupForVert[index1] || groupForVert[index1] == groupForVert[index2] || groupForVert[index2] == groupForVert[index0])
+			{
+				continue;
+			}
+			resultIndexes[writeIndex++] = index0;
+			resultIndexes[writeIndex++] = index1;
+			resultIndexes[writeIndex++] = index2;
+		}
+		resultIndexes.resize(writeIndex);
+
+		// Targets are never collapsed in the same batch, so one step keeps every survivor current
+		for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+		{
+			survivorForVert[vertIndex] = collapseRemap[survivorForVert[vertIndex]];
+		}
+	}
+
+	if (out_resultError != nullptr)
+	{
+		// The collapse costs only rank and cap collapses, the reported error is measured: the farthest any removed vertex
+		// ended up from the simplified triangles around the vertex it collapsed into
+		BuildSimplifyAdjacency(groupAdjacency, resultIndexes, groupForVert, numGroups);
+		float resultErrorSquared = 0.f;
+		for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+		{
+			int survivorGroup = groupForVert[survivorForVert[vertIndex]];
+			if (!isVertInput[vertIndex] || survivorGroup == groupForVert[vertIndex])
+			{
+				continue;
+			}
+
+			Vec3 const& position = meshVerts[vertIndex].m_position;
+			float distanceSquared = (meshVerts[survivorForVert[vertIndex]].m_position - position).GetLengthSquared();
+			for (int spanIndex = groupAdjacency.m_triStarts[survivorGroup]; spanIndex < groupAdjacency.m_triStarts[survivorGroup + 1]; ++spanIndex)
+			{
+				unsigned int const* triIndexes = &resultIndexes[groupAdjacency.m_tris[spanIndex] * 3];
+				distanceSquared = std::min(distanceSquared, GetDistanceSquaredToTriangle3D(position, meshVerts[triIndexes[0]].m_position,
+					meshVerts[triIndexes[1]].m_position, meshVerts[triIndexes[2]].m_position));
+			}
+			resultErrorSquared = std::max(resultErrorSquared, distanceSquared);
+		}
+		*out_resultError = sqrtf(resultErrorSquared * invRadiusSquared);
+	}
+	return resultIndexes;
+}
+
+void GenerateMeshLODs(MeshLODChain& out_chain, std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes,
+	int numLODs, float reductionPerLOD, float maxError)
+{
+	out_chain = MeshLODChain();
+	GetMeshBoundingSphere(meshVerts, out_chain.m_boundsCenter, out_chain.m_boundsRadius);
+	numLODs = GetClamped(numLODs, 1, MESH_LOD_MAX_LEVELS);
+
+	MeshLOD fullDetailLOD;
+	fullDetailLOD.m_indexes = meshIndexes;
+	out_chain.m_lods.push_back(fullDetailLOD);
+
+	// Every level simplifies level 0 directly, so its measured error is its deviation from the full mesh rather than a sum
+	// of per level estimates
+	for (int lodIndex = 1; lodIndex < numLODs; ++lodIndex)
+	{
+		MeshLOD const& previousLOD = out_chain.m_lods.back();
+		int previousIndexCount = static_cast<int>(previousLOD.m_indexes.size());
+		int targetIndexCount = static_cast<int>(static_cast<float>(previousIndexCount / 3) * reductionPerLOD) * 3;
+		if (targetIndexCount < 3)
+		{
+			break;
+		}
+
+		MeshLOD lod;
+		float levelError = 0.f;
+		lod.m_indexes = SimplifyMesh(meshVerts, meshIndexes, targetIndexCount, maxError, &levelError);
+
+		// Not worth a level of its own if the error budget stopped it early
+		if (lod.m_indexes.empty() || static_cast<int>(lod.m_indexes.size()) > previousIndexCount * 9 / 10)
+		{
+			break;
+		}
+
+		OptimizeMeshVertexCache(lod.m_indexes, static_cast<int>(meshVerts.size()));
+		lod.m_error = std::max(previousLOD.m_error, levelError); // Kept non-decreasing so SelectMeshLOD can stop at the first level too coarse
+		out_chain.m_lods.push_back(lod);
+	}
+}
+// -----------------------------------------------------------------------------
+float GetProjectedScreenSize(Camera const& camera, Vec3 const& worldCenter, float worldRadius)
+{
+	Vec3 cameraCenter = camera.GetWorldToCameraTransform().TransformPosition3D(worldCenter);
+	Vec3 renderCenter = camera.GetCameraToRenderTransform().TransformPosition3D(cameraCenter);
+
+	Mat44 projection = camera.GetProjectionMatrix();
+	float const* values = projection.m_values;
+	float clipW = values[Mat44::Iw] * renderCenter.x + values[Mat44::Jw] * renderCenter.y + values[Mat44::Kw] * renderCenter.z + values[Mat44::Tw];
+
+	// Perspective camera inside the sphere, or the sphere behind it, counts as filling the screen
+	if (clipW <= worldRadius * values[Mat44::Kw] || clipW <= 0.f)
+	{
+		return FLT_MAX;
+	}
+
+	// Diameter in NDC is 2r * Jy / w and the viewport is 2 NDC units tall
+	return worldRadius * values[Mat44::Jy] / clipW;
+}
+
+int SelectMeshLOD(MeshLODChain const& chain, Camera const& camera, Mat44 const& modelToWorld, float maxScreenError)
+{
+	if (chain.m_lods.empty())
+	{
+		return 0;
+	}
+
+	Vec3 worldCenter = modelToWorld.TransformPosition3D(chain.m_boundsCenter);
+	float maxScale = std::max(modelToWorld.GetIBasis3D().GetLength(), std::max(modelToWorld.GetJBasis3D().GetLength(), modelToWorld.GetKBasis3D().GetLength()));
+	float screenSize = GetProjectedScreenSize(camera, worldCenter, chain.m_boundsRadius * maxScale);
+
+	// Level errors are relative to the radius, which projects to half the screen size
+	int selectedLOD = 0;
+	for (int lodIndex = 1; lodIndex < static_cast<int>(chain.m_lods.size()); ++lodIndex)
+	{
+		if (chain.m_lods[lodIndex].m_error * screenSize * 0.5f > maxScreenError)
+		{
+			break;
+		}
+		selectedLOD = lodIndex;
+	}
+	return selectedLOD;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+class Camera;
+// -----------------------------------------------------------------------------
+constexpr int	MESH_LOD_MAX_LEVELS = 8;
+constexpr float MESH_LOD_DEFAULT_SCREEN_ERROR = 1.f / 1080.f; // About one pixel of a 1080p viewport's height
+// -----------------------------------------------------------------------------
+struct MeshLOD
+{
+	std::vector<unsigned int> m_indexes;	// Indexes into the chain's shared vertex array
+	float					  m_error = 0.f; // Measured deviation from level 0, relative to the mesh's bounding radius
+};
+// -----------------------------------------------------------------------------
+struct MeshLODChain
+{
+	// Every level draws from the same vertex buffer, only the index buffer changes per level
+	std::vector<MeshLOD> m_lods;
+	Vec3				 m_boundsCenter = Vec3::ZERO;
+	float				 m_boundsRadius = 0.f;
+};
+// -----------------------------------------------------------------------------
+// Quadric error metric simplification (Garland & Heckbert) with half-edge collapses, so the surviving vertexes keep
+// their exact attributes. Open borders only collapse along themselves, and uv/normal seams only collapse along the seam
+// with both sides moving together, so neither ever tears. Returns new indexes into the unchanged meshVerts.
+// maxError caps each collapse's quadric cost (plus a small normal penalty), so it is a heuristic budget. out_resultError is
+// measured afterwards: the farthest any removed vertex lies from the simplified triangles around the vertex it collapsed into.
+// Both are relative to the mesh's bounding radius.
+std::vector<unsigned int> SimplifyMesh(std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes, int targetIndexCount,
+	float maxError = 0.05f, float* out_resultError = nullptr);
+// -----------------------------------------------------------------------------
+// Level 0 is the full mesh, each later level simplifies level 0 down to reductionPerLOD of the previous level's triangles
+// until maxError stops it
+void GenerateMeshLODs(MeshLODChain& out_chain, std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes,
+	int numLODs = 4, float reductionPerLOD = 0.5f, float maxError = 0.05f);
+// -----------------------------------------------------------------------------
+float GetProjectedScreenSize(Camera const& camera, Vec3 const& worldCenter, float worldRadius); // Bounding sphere diameter as a fraction of viewport height
+int   SelectMeshLOD(MeshLODChain const& chain, Camera const& camera, Mat44 const& modelToWorld, float maxScreenError = MESH_LOD_DEFAULT_SCREEN_ERROR);
+// -----------------------------------------------------------------------------
@@ -0,0 +1,394 @@
+#include "Engine/Core/MeshUtils.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <unordered_map>
+#include <cstring>
+// -----------------------------------------------------------------------------
+struct MeshWeldKey
+{
+	// Raw float bits of whatever vertex attributes are being welded together
+	unsigned int m_bits[8] = {};
+
+	bool operator==(MeshWeldKey const& compare) const
+	{
+		return memcmp(m_bits, compare.m_bits, sizeof(m_bits)) == 0;
+	}
+};
+// -----------------------------------------------------------------------------
+struct MeshWeldKeyHash
+{
+	size_t operator()(MeshWeldKey const& weldKey) const
+	{
+		// FNV-1a over the eight attribute words
+		size_t hash = 2166136261u;
+		for (int wordIndex = 0; wordIndex < 8; ++wordIndex)
+		{
+			hash = (hash ^ weldKey.m_bits[wordIndex]) * 16777619u;
+		}
+		return hash;
+	}
+};
+// -----------------------------------------------------------------------------
+static unsigned int GetWeldBits(float value)
+{
+	// Adding zero turns -0 into +0 so both weld together
+	value += 0.f;
+	unsigned int bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+int WeldMeshVertexes(std::vector<Vertex_PCUTBN> const& meshVerts, bool includeUVsAndNormals, std::vector<int>& out_groupForVert)
+{
+	std::unordered_map<MeshWeldKey, int, MeshWeldKeyHash> groupForKey;
+	groupForKey.reserve(meshVerts.size());
+	out_groupForVert.resize(meshVerts.size());
+
+	for (int vertIndex = 0; vertIndex < static_cast<int>(meshVerts.size()); ++vertIndex)
+	{
+		Vertex_PCUTBN const& vert = meshVerts[vertIndex];
+
+		MeshWeldKey weldKey;
+		weldKey.m_bits[0] = GetWeldBits(vert.m_position.x);
+		weldKey.m_bits[1] = GetWeldBits(vert.m_position.y);
+		weldKey.m_bits[2] = GetWeldBits(vert.m_position.z);
+		if (includeUVsAndNormals)
+		{
+			weldKey.m_bits[3] = GetWeldBits(vert.m_uvTexCoords.x);
+			weldKey.m_bits[4] = GetWeldBits(vert.m_uvTexCoords.y);
+			weldKey.m_bits[5] = GetWeldBits(vert.m_normal.x);
+			weldKey.m_bits[6] = GetWeldBits(vert.m_normal.y);
+			weldKey.m_bits[7] = GetWeldBits(vert.m_normal.z);
+		}
+
+		auto insertResult = groupForKey.emplace(weldKey, static_cast<int>(groupForKey.size()));
+		out_groupForVert[vertIndex] = insertResult.first->second;
+	}
+
+	return static_cast<int>(groupForKey.size());
+}
+
+static void RunMeshRange(JobSystem* jobSystem, int numItems, std::function<void(int, int)> const& rangeFunction)
+{
+	if (jobSystem == nullptr)
+	{
+		rangeFunction(0, numItems);
+		return;
+	}
+	jobSystem->ExecuteParallelFor(numItems, MESH_ITEMS_PER_JOB, rangeFunction);
+}
+
+static void BuildCornerListsByGroup(std::vector<int> const& groupForCorner, int numGroups, std::vector<int>& out_groupStarts, std::vector<int>& out_cornersByGroup)
+{
+	// Counting sort of the corners by group, so each group can gather its corners without any locking
+	out_groupStarts.assign(numGroups + 1, 0);
+	for (int cornerIndex = 0; cornerIndex < static_cast<int>(groupForCorner.size()); ++cornerIndex)
+	{
+		++out_groupStarts[groupForCorner[cornerIndex] + 1];
+	}
+	for (int groupIndex = 0; groupIndex < numGroups; ++groupIndex)
+	{
+		out_groupStarts[groupIndex + 1] += out_groupStarts[groupIndex];
+	}
+
+	std::vector<int> groupWriteIndexes(out_groupStarts.begin(), out_groupStarts.end() - 1);
+	out_cornersByGroup.resize(groupForCorner.size());
+	for (int cornerIndex = 0; cornerIndex < static_cast<int>(groupForCorner.size()); ++cornerIndex)
+	{
+		out_cornersByGroup[groupWriteIndexes[groupForCorner[cornerIndex]]++] = cornerIndex;
+	}
+}
+
+static float GetCornerAngleRadians(Vec3 const& cornerPos, Vec3 const& nextPos, Vec3 const& prevPos)
+{
+	Vec3 toNext = (nextPos - cornerPos).GetNormalized();
+	Vec3 toPrev = (prevPos - cornerPos).GetNormalized();
+	return acosf(GetClamped(DotProduct3D(toNext, toPrev), -1.f, 1.f));
+}
+
+static unsigned int GetCornerVertIndex(unsigned int const* meshIndexes, int cornerIndex)
+{
+	return (meshIndexes != nullptr) ? meshIndexes[cornerIndex] : static_cast<unsigned int>(cornerIndex);
+}
+
+static Vec3 GetAnyTangentForNormal(Vec3 const& normal)
+{
+	// Pick whichever world axis is least parallel to the normal
+	Vec3 referenceAxis = (fabsf(normal.z) < 0.9f) ? Vec3::ZAXE : Vec3::XAXE;
+	return CrossProduct3D(referenceAxis, normal).GetNormalized();
+}
+// -----------------------------------------------------------------------------
+static void ComputeMeshNormalsInternal(JobSystem* jobSystem, std::vector<Vertex_PCUTBN>& meshVerts, unsigned int const* meshIndexes, int numCorners,
+	MeshNormalMode normalMode, bool onlyMissingNormals)
+{
+	int numVerts = static_cast<int>(meshVerts.size());
+	int numTris = numCorners / 3;
+	numCorners = numTris * 3;
+
+	// Vertexes in the same group end up with the same normal
+	std::vector<int> groupForVert;
+	int numGroups = numVerts;
+	if (normalMode == MeshNormalMode::SMOOTH)
+	{
+		numGroups = WeldMeshVertexes(meshVerts, false, groupForVert);
+	}
+	else
+	{
+		groupForVert.resize(numVerts);
+		for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+		{
+			groupForVert[vertIndex] = vertIndex;
+		}
+	}
+
+	// Angle weighted face normal for every triangle corner
+	std::vector<Vec3> cornerNormals(numCorners);
+	std::vector<int> groupForCorner(numCorners);
+	RunMeshRange(jobSystem, numTris, [&](int startTri, int endTri)
+	{
+		for (int triIndex = startTri; triIndex < endTri; ++triIndex)
+		{
+			int firstCorner = triIndex * 3;
+			unsigned int triVertIndexes[3];
+			for (int triCorner = 0; triCorner < 3; ++triCorner)
+			{
+				triVertIndexes[triCorner] = GetCornerVertIndex(meshIndexes, firstCorner + triCorner);
+				groupForCorner[firstCorner + triCorner] = groupForVert[triVertIndexes[triCorner]];
+			}
+
+			Vec3 const& p0 = meshVerts[triVertIndexes[0]].m_position;
+			Vec3 const& p1 = meshVerts[triVertIndexes[1]].m_position;
+			Vec3 const& p2 = meshVerts[triVertIndexes[2]].m_position;
+			Vec3 faceNormal = CrossProduct3D(p1 - p0, p2 - p0).GetNormalized();
+
+			cornerNormals[firstCorner] = faceNormal * GetCornerAngleRadians(p0, p1, p2);
+			cornerNormals[firstCorner + 1] = faceNormal * GetCornerAngleRadians(p1, p2, p0);
+			cornerNormals[firstCorner + 2] = faceNormal * GetCornerAngleRadians(p2, p0, p1);
+		}
+	});
+
+	// Gather the corner normals for each group
+	std::vector<int> groupStarts;
+	std::vector<int> cornersByGroup;
+	BuildCornerListsByGroup(groupForCorner, numGroups, groupStarts, cornersByGroup);
+
+	std::vector<Vec3> groupNormals(numGroups);
+	RunMeshRange(jobSystem, numGroups, [&](int startGroup, int endGroup)
+	{
+		for (int groupIndex = startGroup; groupIndex < endGroup; ++groupIndex)
+		{
+			Vec3 normalSum = Vec3::ZERO;
+			for (int listIndex = groupStarts[groupIndex]; listIndex < groupStarts[groupIndex + 1]; ++listIndex)
+			{
+				normalSum += cornerNormals[cornersByGroup[listIndex]];
+			}
+			groupNormals[groupIndex] = normalSum.GetNormalized();
+		}
+	});
+
+	RunMeshRange(jobSystem, numVerts, [&](int startVert, int endVert)
+	{
+		for (int vertIndex = startVert; vertIndex < endVert; ++vertIndex)
+		{
+			Vertex_PCUTBN& vert = meshVerts[vertIndex];
+			if (onlyMissingNormals && vert.m_normal != Vec3::ZERO)
+			{
+				continue;
+			}
+			vert.m_normal = groupNormals[groupForVert[vertIndex]];
+		}
+	});
+}
+
+static void ComputeMeshTangentsInternal(JobSystem* jobSystem, std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>* meshIndexes)
+{
+	unsigned int const* indexes = (meshIndexes != nullptr) ? meshIndexes->data() : nullptr;
+	int numCorners = (meshIndexes != nullptr) ? static_cast<int>(meshIndexes->size()) : static_cast<int>(meshVerts.size());
+	int numTris = numCorners / 3;
+	numCorners = numTris * 3;
+
+	// Corners share tangent space when they share a vertex. De-indexed meshes weld corners with identical
+	// position, uv and normal the same way MikkTSpace does.
+	std::vector<int> keyForCorner;
+	int numKeys = static_cast<int>(meshVerts.size());
+	if (indexes != nullptr)
+	{
+		keyForCorner.resize(numCorners);
+		for (int cornerIndex = 0; cornerIndex < numCorners; ++cornerIndex)
+		{
+			keyForCorner[cornerIndex] = static_cast<int>(indexes[cornerIndex]);
+		}
+	}
+	else
+	{
+		numKeys = WeldMeshVertexes(meshVerts, true, keyForCorner);
+		keyForCorner.resize(numCorners);
+	}
+
+	// Per corner tangent projected onto the vertex normal. Each key gets two groups, one per uv handedness,
+	// so tangents are never averaged across a mirror seam.
+	std::vector<Vec3> cornerTangents(numCorners);
+	std::vector<int> groupForCorner(numCorners);
+	RunMeshRange(jobSystem, numTris, [&](int startTri, int endTri)
+	{
+		for (int triIndex = startTri; triIndex < endTri; ++triIndex)
+		{
+			int firstCorner = triIndex * 3;
+			Vertex_PCUTBN const& v0 = meshVerts[GetCornerVertIndex(indexes, firstCorner)];
+			Vertex_PCUTBN const& v1 = meshVerts[GetCornerVertIndex(indexes, firstCorner + 1)];
+			Vertex_PCUTBN const& v2 = meshVerts[GetCornerVertIndex(indexes, firstCorner + 2)];
+			Vertex_PCUTBN const* triVerts[3] = { &v0, &v1, &v2 };
+
+			// Edges and deltas
+			Vec3 edge0 = v1.m_position - v0.m_position;
+			Vec3 edge1 = v2.m_position - v0.m_position;
+			float deltaU0 = v1.m_uvTexCoords.x - v0.m_uvTexCoords.x;
+			float deltaV0 = v1.m_uvTexCoords.y - v0.m_uvTexCoords.y;
+			float deltaU1 = v2.m_uvTexCoords.x - v0.m_uvTexCoords.x;
+			float deltaV1 = v2.m_uvTexCoords.y - v0.m_uvTexCoords.y;
+
+			// Degenerate uvs contribute nothing, those vertexes fall back to a tangent built from the normal
+			float determinant = deltaU0 * deltaV1 - deltaU1 * deltaV0;
+			bool hasTangentSpace = fabsf(determinant) > 1e-20f;
+			Vec3 faceTangent = Vec3::ZERO;
+			Vec3 faceBitangent = Vec3::ZERO;
+			if (hasTangentSpace)
+			{
+				float r = 1.f / determinant;
+				faceTangent = r * (deltaV1 * edge0 - deltaV0 * edge1);
+				faceBitangent = r * (deltaU0 * edge1 - deltaU1 * edge0);
+			}
+
+			for (int triCorner = 0; triCorner < 3; ++triCorner)
+			{
+				int cornerIndex = firstCorner + triCorner;
+				Vertex_PCUTBN const& vert = *triVerts[triCorner];
+				Vec3 const& N = vert.m_normal;
+
+				Vec3 projectedTangent = (faceTangent - DotProduct3D(N, faceTangent) * N).GetNormalized();
+				bool isMirrored = hasTangentSpace && DotProduct3D(CrossProduct3D(N, projectedTangent), faceBitangent) < 0.f;
+				float cornerAngle = GetCornerAngleRadians(vert.m_position, triVerts[(triCorner + 1) % 3]->m_position, triVerts[(triCorner + 2) % 3]->m_position);
+
+				cornerTangents[cornerIndex] = projectedTangent * cornerAngle;
+				groupForCorner[cornerIndex] = keyForCorner[cornerIndex] * 2 + (isMirrored ? 1 : 0);
+			}
+		}
+	});
+
+	int numGroups = numKeys * 2;
+	std::vector<int> groupStarts;
+	std::vector<int> cornersByGroup;
+	BuildCornerListsByGroup(groupForCorner, numGroups, groupStarts, cornersByGroup);
+
+	// Indexed vertexes used with both handednesses get split, the mirrored corners move to a copy
+	std::vector<unsigned int> vertForGroup;
+	if (meshIndexes != nullptr)
+	{
+		vertForGroup.resize(numGroups);
+		for (int vertIndex = 0; vertIndex < numKeys; ++vertIndex)
+		{
+			int regularGroup = vertIndex * 2;
+			int mirroredGroup = regularGroup + 1;
+			bool isUsedRegular = groupStarts[regularGroup + 1] > groupStarts[regularGroup];
+			bool isUsedMirrored = groupStarts[mirroredGroup + 1] > groupStarts[mirroredGroup];
+
+			vertForGroup[regularGroup] = static_cast<unsigned int>(vertIndex);
+			vertForGroup[mirroredGroup] = static_cast<unsigned int>(vertIndex);
+			if (isUsedRegular && isUsedMirrored)
+			{
+				unsigned int splitVertIndex = static_cast<unsigned int>(meshVerts.size());
+				meshVerts.push_back(meshVerts[vertIndex]);
+				vertForGroup[mirroredGroup] = splitVertIndex;
+				for (int listIndex = groupStarts[mirroredGroup]; listIndex < groupStarts[mirroredGroup + 1]; ++listIndex)
+				{
+					(*meshIndexes)[cornersByGroup[listIndex]] = splitVertIndex;
+				}
+			}
+		}
+	}
+
+	// Average each group and write the final orthonormal basis
+	RunMeshRange(jobSystem, numGroups, [&](int startGroup, int endGroup)
+	{
+		for (int groupIndex = startGroup; groupIndex < endGroup; ++groupIndex)
+		{
+			int firstListIndex = groupStarts[groupIndex];
+			int endListIndex = groupStarts[groupIndex + 1];
+			if (firstListIndex == endListIndex)
+			{
+				continue;
+			}
+
+			Vec3 tangentSum = Vec3::ZERO;
+			for (int listIndex = firstListIndex; listIndex < endListIndex; ++listIndex)
+			{
+				tangentSum += cornerTangents[cornersByGroup[listIndex]];
+			}
+
+			bool isMirrored = (groupIndex % 2) == 1;
+			unsigned int firstVertIndex = GetCornerVertIndex(indexes, cornersByGroup[firstListIndex]);
+			Vec3 N = meshVerts[(meshIndexes != nullptr) ? vertForGroup[groupIndex] : firstVertIndex].m_normal;
+			Vec3 T = (tangentSum - DotProduct3D(N, tangentSum) * N).GetNormalized();
+			if (T == Vec3::ZERO)
+			{
+				T = GetAnyTangentForNormal(N);
+			}
+			Vec3 B = isMirrored ? -CrossProduct3D(N, T) : CrossProduct3D(N, T);
+
+			if (meshIndexes != nullptr)
+			{
+				Vertex_PCUTBN& vert = meshVerts[vertForGroup[groupIndex]];
+				vert.m_tangent = T;
+				vert.m_bitangent = B;
+				continue;
+			}
+
+			for (int listIndex = firstListIndex; listIndex < endListIndex; ++listIndex)
+			{
+				Vertex_PCUTBN& vert = meshVerts[cornersByGroup[listIndex]];
+				vert.m_tangent = T;
+				vert.m_bitangent = B;
+			}
+		}
+	});
+}
+// -----------------------------------------------------------------------------
+void ComputeMeshNormals(std::vector<Vertex_PCUTBN>& meshVerts, MeshNormalMode normalMode, bool onlyMissingNormals)
+{
+	ComputeMeshNormalsInternal(nullptr, meshVerts, nullptr, static_cast<int>(meshVerts.size()), normalMode, onlyMissingNormals);
+}
+
+void ComputeMeshNormals(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int> const& meshIndexes, MeshNormalMode normalMode, bool onlyMissingNormals)
+{
+	ComputeMeshNormalsInternal(nullptr, meshVerts, meshIndexes.data(), static_cast<int>(meshIndexes.size()), normalMode, onlyMissingNormals);
+}
+
+void ComputeMeshNormalsParallel(JobSystem& jobSystem, std::vector<Vertex_PCUTBN>& meshVerts, MeshNormalMode normalMode, bool onlyMissingNormals)
+{
+	ComputeMeshNormalsInternal(&jobSystem, meshVerts, nullptr, static_cast<int>(meshVerts.size()), normalMode, onlyMissingNormals);
+}
+
+void ComputeMeshNormalsParallel(JobSystem& jobSystem, std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int> const& meshIndexes, MeshNormalMode normalMode, bool onlyMissingNormals)
+{
+	ComputeMeshNormalsInternal(&jobSystem, meshVerts, meshIndexes.data(), static_cast<int>(meshIndexes.size()), normalMode, onlyMissingNormals);
+}
+
+void ComputeMeshTangents(std::vector<Vertex_PCUTBN>& meshVerts)
+{
+	ComputeMeshTangentsInternal(nullptr, meshVerts, nullptr);
+}
+
+void ComputeMeshTangents(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes)
+{
+	ComputeMeshTangentsInternal(nullptr, meshVerts, &meshIndexes);
+}
+
+void ComputeMeshTangentsParallel(JobSystem& jobSystem, std::vector<Vertex_PCUTBN>& meshVerts)
+{
+	ComputeMeshTangentsInternal(&jobSystem, meshVerts, nullptr);
+}
+
+void ComputeMeshTangentsParallel(JobSystem& jobSystem, std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes)
+{
+	ComputeMeshTangentsInternal(&jobSystem, meshVerts, &meshIndexes);
+}
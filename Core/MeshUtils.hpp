@@ -0,0 +1,31 @@
+#pragma once
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+class JobSystem;
+// -----------------------------------------------------------------------------
+constexpr int MESH_ITEMS_PER_JOB = 4096;
+// -----------------------------------------------------------------------------
+enum class MeshNormalMode
+{
+	SMOOTH, // Averages every face touching the same position, straight across uv seams
+	FLAT,	// Only averages faces sharing the exact same vertex, so de-indexed meshes get face normals
+	COUNT
+};
+// -----------------------------------------------------------------------------
+// Normal generation, angle weighted and linear in the number of triangles
+void ComputeMeshNormals(std::vector<Vertex_PCUTBN>& meshVerts, MeshNormalMode normalMode = MeshNormalMode::FLAT, bool onlyMissingNormals = false);
+void ComputeMeshNormals(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int> const& meshIndexes, MeshNormalMode normalMode = MeshNormalMode::SMOOTH, bool onlyMissingNormals = false);
+void ComputeMeshNormalsParallel(JobSystem& jobSystem, std::vector<Vertex_PCUTBN>& meshVerts, MeshNormalMode normalMode = MeshNormalMode::FLAT, bool onlyMissingNormals = false);
+void ComputeMeshNormalsParallel(JobSystem& jobSystem, std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int> const& meshIndexes, MeshNormalMode normalMode = MeshNormalMode::SMOOTH, bool onlyMissingNormals = false);
+// -----------------------------------------------------------------------------
+// Tangent generation, MikkTSpace style: per corner tangents projected onto the vertex normal, angle weighted,
+// and never averaged across a uv mirror seam. Bitangent is always sign * cross(N, T) so shaders can rebuild it.
+void ComputeMeshTangents(std::vector<Vertex_PCUTBN>& meshVerts);
+void ComputeMeshTangents(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes); // May split vertexes used by both uv handednesses, appending verts and rewriting meshIndexes
+void ComputeMeshTangentsParallel(JobSystem& jobSystem, std::vector<Vertex_PCUTBN>& meshVerts);
+void ComputeMeshTangentsParallel(JobSystem& jobSystem, std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes);
+// -----------------------------------------------------------------------------
+// Groups vertexes with bit identical positions (and optionally uvs and normals), returns the number of groups
+int WeldMeshVertexes(std::vector<Vertex_PCUTBN> const& meshVerts, bool includeUVsAndNormals, std::vector<int>& out_groupForVert);
+// -----------------------------------------------------------------------------
@@ -2,10 +2,31 @@
 #include "Engine/Core/EngineCommon.h"
 #include "Engine/Core/VertexUtils.h"
 #include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/MeshUtils.hpp"
+#include "Engine/Core/MeshCache.hpp"
+#include "Engine/Core/MeshOptimizer.hpp"
 #include "Engine/Math/MathUtils.h"
+#include <unordered_map>
 
-bool LoadOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath)
+bool LoadOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath, bool useMeshCache)
 {
+	// The cache holds exactly one mesh, so it only applies when we are not appending
+	std::vector<unsigned int> noIndexes;
+	std::string cacheFilePath = GetMeshCacheFilePath(objFilePath, false);
+	useMeshCache = useMeshCache && meshVerts.empty();
+	AABB3 cachedBounds;
+	if (useMeshCache)
+	{
+		if (ReadMeshCacheFile(meshVerts, noIndexes, cachedBounds, cacheFilePath.c_str(), objFilePath) && noIndexes.empty())
+		{
+			return true;
+		}
+
+		// A rejected cache, or an indexed one under the de-indexed name, may have filled the array, which was empty before the read
+		meshVerts.clear();
+		noIndexes.clear();
+	}
+
 	bool success = ParseOBJMeshFile(meshVerts, objFilePath);
 	GUARANTEE_OR_DIE(success == true, Stringf("Failed to load OBJ file \"%s\"", objFilePath));
 
@@ -13,107 +34,105 @@ bool LoadOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFileP
 	{
 		ComputeMissingNormals(meshVerts);
 		ComputeMissingTangentsAndBitangents(meshVerts);
+
+		if (useMeshCache)
+		{
+			WriteMeshCacheFile(cacheFilePath.c_str(), meshVerts, noIndexes, objFilePath);
+		}
 	}
 
 	return success;
 }
 
-void ComputeMissingNormals(std::vector<Vertex_PCUTBN>& meshVerts)
+bool LoadOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes, char const* objFilePath, bool useMeshCache)
 {
-	for (int vertIndex = 0; vertIndex < static_cast<int>(meshVerts.size()); ++vertIndex)
+	std::string cacheFilePath = GetMeshCacheFilePath(objFilePath, true);
+	useMeshCache = useMeshCache && meshVerts.empty() && meshIndexes.empty();
+	unsigned int const cacheFlags = MESH_CACHE_FLAG_HAS_TANGENTS | MESH_CACHE_FLAG_OPTIMIZED;
+	AABB3 cachedBounds;
+	if (useMeshCache)
+	{
+		// Caches written before the optimizer ran are rebuilt rather than returned unoptimized
+		if (ReadMeshCacheFile(meshVerts, meshIndexes, cachedBounds, cacheFilePath.c_str(), objFilePath, MeshCacheValidation::TIMESTAMP, cacheFlags))
+		{
+			return true;
+		}
+		meshVerts.clear();
+		meshIndexes.clear();
+	}
+
+	// Parsed on its own, so the tangent split and the optimizer reorder only this file's mesh and never one the caller already loaded
+	std::vector<Vertex_PCUTBN> fileVerts;
+	std::vector<unsigned int> fileIndexes;
+	bool success = ParseOBJMeshFile(fileVerts, fileIndexes, objFilePath);
+	GUARANTEE_OR_DIE(success == true, Stringf("Failed to load OBJ file \"%s\"", objFilePath));
+
+	if (success)
 	{
-		Vertex_PCUTBN& vert = meshVerts[vertIndex];
+		ComputeMissingNormals(fileVerts, fileIndexes);
+		ComputeMissingTangentsAndBitangents(fileVerts, fileIndexes);
+		OptimizeMesh(fileVerts, fileIndexes);
 
-		// Check if our obj has a normal or not
-		if (vert.m_normal == Vec3::ZERO)
+		if (useMeshCache)
 		{
-			Vec3 newNormal = Vec3::ZERO;
-			for (int faceIndex = 0; faceIndex < static_cast<int>(meshVerts.size()); faceIndex += 3)
-			{
-				Vec3 p0 = meshVerts[faceIndex].m_position;
-				Vec3 p1 = meshVerts[faceIndex + 1].m_position;
-				Vec3 p2 = meshVerts[faceIndex + 2].m_position;
-
-				Vec3 triSide1 = p1 - p0;
-				Vec3 triSide2 = p2 - p0;
-				Vec3 triNormal = CrossProduct3D(triSide1, triSide2).GetNormalized();
-
-				for (int objTriIndex = 0; objTriIndex < 3; ++objTriIndex)
-				{
-					if (meshVerts[faceIndex + objTriIndex].m_normal == Vec3::ZERO)
-					{
-						meshVerts[faceIndex + objTriIndex].m_normal += triNormal;
-					}
-				}
-			}
-			vert.m_normal = newNormal.GetNormalized();
+			WriteMeshCacheFile(cacheFilePath.c_str(), fileVerts, fileIndexes, objFilePath, cacheFlags);
+		}
+
+		unsigned int firstVertIndex = static_cast<unsigned int>(meshVerts.size());
+		meshVerts.insert(meshVerts.end(), fileVerts.begin(), fileVerts.end());
+		meshIndexes.reserve(meshIndexes.size() + fileIndexes.size());
+		for (int indexIndex = 0; indexIndex < static_cast<int>(fileIndexes.size()); ++indexIndex)
+		{
+			meshIndexes.push_back(firstVertIndex + fileIndexes[indexIndex]);
 		}
 	}
+
+	return success;
+}
+
+void ComputeMissingNormals(std::vector<Vertex_PCUTBN>& meshVerts)
+{
+	// De-indexed triangles share no vertexes, so every missing normal becomes its face normal
+	ComputeMeshNormals(meshVerts, MeshNormalMode::FLAT, true);
+}
+
+void ComputeMissingNormals(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int> const& meshIndexes)
+{
+	ComputeMeshNormals(meshVerts, meshIndexes, MeshNormalMode::SMOOTH, true);
 }
 
 void ComputeMissingTangentsAndBitangents(std::vector<Vertex_PCUTBN>& meshVerts)
 {
-	// Iterate over the triangles.
-	for (int vertIndex = 0; vertIndex < static_cast<int>(meshVerts.size()); vertIndex += 3)
+	ComputeMeshTangents(meshVerts);
+}
+
+void ComputeMissingTangentsAndBitangents(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes)
+{
+	ComputeMeshTangents(meshVerts, meshIndexes);
+}
+
+static void ParseOBJFaceCorner(std::string const& cornerArg, int& positionIndex, int& uvIndex, int& normalIndex)
+{
+	// Corner format is v, v/vt, v//vn or v/vt/vn with 1 based indexes
+	Strings cornerIndexes = SplitStringOnDelimiter(cornerArg, '/');
+
+	// Positions
+	positionIndex = CreateIntFromStrings(cornerIndexes[0]) - 1;
+
+	// Uvs
+	if (cornerIndexes.size() > 1 && !cornerIndexes[1].empty())
 	{
-		Vertex_PCUTBN& v0 = meshVerts[vertIndex];
-		Vertex_PCUTBN& v1 = meshVerts[vertIndex + 1];
-		Vertex_PCUTBN& v2 = meshVerts[vertIndex + 2];
-
-		// Positions
-		Vec3 p0 = v0.m_position;
-		Vec3 p1 = v1.m_position;
-		Vec3 p2 = v2.m_position;
-
-		// UVs
-		Vec2 uv0 = v0.m_uvTexCoords;
-		Vec2 uv1 = v1.m_uvTexCoords;
-		Vec2 uv2 = v2.m_uvTexCoords;
-
-		// Edges and deltas
-		Vec3 edge0 = p1 - p0;
-		Vec3 edge1 = p2 - p0;
-		float deltaU0 = uv1.x - uv0.x;
-		float deltaV0 = uv1.y - uv0.y;
-		float deltaU1 = uv2.x - uv0.x;
-		float deltaV1 = uv2.y - uv0.y;
-
-		// Calculate the reciprocal r of our determinant
-		float r = 1.f / (deltaU0 * deltaV1 - deltaU1 * deltaV0);
-
-		// Tangent
-		Vec3 tangent = r * (deltaV1 * edge0 - deltaV0 * edge1).GetNormalized();
-
-		// Bitangent
-		Vec3 biTangent = r * (deltaU0 * edge1 - deltaU1 * edge0).GetNormalized();
-
-		// Normalize add T and B to all three vertex tangents and biTangents.
-		v0.m_tangent = tangent;
-		v0.m_bitangent = biTangent;
-
-		v1.m_tangent = tangent;
-		v1.m_bitangent = biTangent;
-
-		v2.m_tangent = tangent;
-		v2.m_bitangent = biTangent;
+		uvIndex = CreateIntFromStrings(cornerIndexes[1]) - 1;
 	}
 
-	for (int vertIndex = 0; vertIndex < static_cast<int>(meshVerts.size()); ++vertIndex)
+	// Normals
+	if (cornerIndexes.size() > 2 && !cornerIndexes[2].empty())
 	{
-		Vertex_PCUTBN& vert = meshVerts[vertIndex];
-
-		// TBN basis vectors
-		Vec3& T = vert.m_tangent;
-		Vec3& B = vert.m_bitangent;
-		Vec3& N = vert.m_normal;
-
-		// Apply GramSchmidt orthonormalization keeping N unchanged.
-		T = (T - DotProduct3D(N, T) * N).GetNormalized();
-		B = CrossProduct3D(N, T);
+		normalIndex = CreateIntFromStrings(cornerIndexes[2]) - 1;
 	}
 }
 
-bool ParseOBJWithSplitStrings(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath)
+static void ParseOBJFileData(std::vector<Vec3>& positions, std::vector<Vec2>& uvs, std::vector<Vec3>& normals, std::vector<OBJTriIndexes>& triIndexes, char const* objFilePath)
 {
 	std::string fileText;
 	int result = FileReadToString(fileText, objFilePath);
@@ -121,13 +140,7 @@ bool ParseOBJWithSplitStrings(std::vector<Vertex_PCUTBN>& meshVerts, char const*
 
 	Strings textLines = SplitStringOnDelimiter(fileText, '\n');
 
-	std::vector<Vec3> positions;
-	std::vector<Vec2> uvs;
-	std::vector<Vec3> normals;
-	std::vector<OBJTriIndexes> triIndexes;
-
 	size_t numLines = textLines.size();
-	meshVerts.reserve(numLines / 2);
 	positions.reserve(numLines / 4);
 	uvs.reserve(numLines / 4);
 	normals.reserve(numLines / 4);
@@ -171,92 +184,104 @@ bool ParseOBJWithSplitStrings(std::vector<Vertex_PCUTBN>& meshVerts, char const*
 			int numVerts = static_cast<int>(args.size()) - 1;
 			GUARANTEE_OR_DIE(numVerts >= 3, Stringf("Malformed face in OBJ \"%s\": \"%s\"", objFilePath, line.c_str()));
 
+			// Parse the shared first corner once, then fan triangulate the rest of the polygon
+			OBJTriIndexes firstCorner;
+			ParseOBJFaceCorner(args[1], firstCorner.v1[0], firstCorner.v2[0], firstCorner.v3[0]);
+
 			for (int startIndex = 1; startIndex < numVerts - 1; ++startIndex)
 			{
 				OBJTriIndexes tris;
-				for (int triIndex = 0; triIndex < 3; ++triIndex)
-				{
-					Strings fTris0 = SplitStringOnDelimiter(args[1], '/');
-
-					// Positions
-					tris.v1[triIndex] = CreateIntFromStrings(fTris0[0]) - 1;
-
-					// Uvs
-					if (fTris0.size() > 1 && !fTris0[1].empty())
-					{
-						tris.v2[triIndex] = CreateIntFromStrings(fTris0[1]) - 1;
-					}
-
-					// Normals
-					if (fTris0.size() > 2 && !fTris0[2].empty())
-					{
-						tris.v3[triIndex] = CreateIntFromStrings(fTris0[2]) - 1;
-					}
-				}
-
-				Strings fTris1 = SplitStringOnDelimiter(args[startIndex + 1], '/');
-
-				// Positions
-				tris.v1[0] = CreateIntFromStrings(fTris1[0]) - 1;
-
-				// Uvs
-				if (fTris1.size() > 1 && !fTris1[1].empty())
-				{
-					tris.v2[0] = CreateIntFromStrings(fTris1[1]) - 1;
-				}
-
-				// Normals
-				if (fTris1.size() > 2 && !fTris1[2].empty())
-				{
-					tris.v3[0] = CreateIntFromStrings(fTris1[2]) - 1;
-				}
-
-				Strings fTris2 = SplitStringOnDelimiter(args[startIndex + 2], '/');
-
-				// Positions
-				tris.v1[1] = CreateIntFromStrings(fTris2[0]) - 1;
-
-				// Uvs
-				if (fTris2.size() > 1 && !fTris2[1].empty())
-				{
-					tris.v2[1] = CreateIntFromStrings(fTris2[1]) - 1;
-				}
-
-				// Normals
-				if (fTris2.size() > 2 && !fTris2[2].empty())
-				{
-					tris.v3[1] = CreateIntFromStrings(fTris2[2]) - 1;
-				}
-
+				tris.v1[0] = firstCorner.v1[0];
+				tris.v2[0] = firstCorner.v2[0];
+				tris.v3[0] = firstCorner.v3[0];
+				ParseOBJFaceCorner(args[startIndex + 1], tris.v1[1], tris.v2[1], tris.v3[1]);
+				ParseOBJFaceCorner(args[startIndex + 2], tris.v1[2], tris.v2[2], tris.v3[2]);
 				triIndexes.push_back(tris);
 			}
 		}
 	}
+}
 
+static Vertex_PCUTBN MakeOBJCornerVertex(OBJTriIndexes const& tri, int cornerIndex, std::vector<Vec3> const& positions, std::vector<Vec2> const& uvs, std::vector<Vec3> const& normals)
+{
+	// Positions
+	Vec3 position = positions[tri.v1[cornerIndex]];
+
+	// UVs
+	Vec2 uv = Vec2::ZERO;
+	if (tri.v2[cornerIndex] >= 0 && tri.v2[cornerIndex] < static_cast<int>(uvs.size()))
+	{
+		uv = uvs[tri.v2[cornerIndex]];
+	}
+
+	// Normals
+	Vec3 normal = Vec3::ZERO;
+	if (tri.v3[cornerIndex] >= 0 && tri.v3[cornerIndex] < static_cast<int>(normals.size()))
+	{
+		normal = normals[tri.v3[cornerIndex]];
+	}
+
+	return Vertex_PCUTBN(position, Rgba8::WHITE, uv, Vec3::ZERO, Vec3::ZERO, normal);
+}
+
+bool ParseOBJWithSplitStrings(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath)
+{
+	std::vector<Vec3> positions;
+	std::vector<Vec2> uvs;
+	std::vector<Vec3> normals;
+	std::vector<OBJTriIndexes> triIndexes;
+	ParseOBJFileData(positions, uvs, normals, triIndexes, objFilePath);
+
+	meshVerts.reserve(meshVerts.size() + triIndexes.size() * 3);
 	for (int objTriIndex = 0; objTriIndex < static_cast<int>(triIndexes.size()); ++objTriIndex)
 	{
 		OBJTriIndexes const& tri = triIndexes[objTriIndex];
 
 		for (int numTris = 0; numTris < 3; ++numTris)
 		{
-			// Positions
-			Vec3 position = positions[tri.v1[numTris]];
+			meshVerts.push_back(MakeOBJCornerVertex(tri, numTris, positions, uvs, normals));
+		}
+	}
 
-			// UVs
-			Vec2 uv = Vec2::ZERO;
-			if (tri.v2[numTris] >= 0 && tri.v2[numTris] < static_cast<int>(uvs.size()))
-			{
-				uv = uvs[tri.v2[numTris]];
-			}
+	return true;
+}
+
+bool ParseOBJWithSplitStrings(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes, char const* objFilePath)
+{
+	std::vector<Vec3> positions;
+	std::vector<Vec2> uvs;
+	std::vector<Vec3> normals;
+	std::vector<OBJTriIndexes> triIndexes;
+	ParseOBJFileData(positions, uvs, normals, triIndexes, objFilePath);
 
-			// Normals
-			Vec3 normal = Vec3::ZERO;
-			if (tri.v3[numTris] >= 0 && tri.v3[numTris] < static_cast<int>(normals.size()))
+	// Every unique v/vt/vn corner becomes exactly one vertex, repeated corners only add an index
+	std::unordered_map<OBJCornerKey, unsigned int, OBJCornerKeyHash> vertIndexForCorner;
+	vertIndexForCorner.reserve(positions.size() * 2);
+	meshVerts.reserve(meshVerts.size() + positions.size() * 2);
+	meshIndexes.reserve(meshIndexes.size() + triIndexes.size() * 3);
+
+	for (int objTriIndex = 0; objTriIndex < static_cast<int>(triIndexes.size()); ++objTriIndex)
+	{
+		OBJTriIndexes const& tri = triIndexes[objTriIndex];
+
+		for (int numTris = 0; numTris < 3; ++numTris)
+		{
+			OBJCornerKey cornerKey;
+			cornerKey.m_positionIndex = tri.v1[numTris];
+			cornerKey.m_uvIndex = tri.v2[numTris];
+			cornerKey.m_normalIndex = tri.v3[numTris];
+
+			auto foundCorner = vertIndexForCorner.find(cornerKey);
+			if (foundCorner != vertIndexForCorner.end())
 			{
-				normal = normals[tri.v3[numTris]];
+				meshIndexes.push_back(foundCorner->second);
+				continue;
 			}
 
-			meshVerts.push_back(Vertex_PCUTBN(position, Rgba8::WHITE, uv, Vec3::ZERO, Vec3::ZERO, normal));
+			unsigned int newVertIndex = static_cast<unsigned int>(meshVerts.size());
+			meshVerts.push_back(MakeOBJCornerVertex(tri, numTris, positions, uvs, normals));
+			vertIndexForCorner.emplace(cornerKey, newVertIndex);
+			meshIndexes.push_back(newVertIndex);
 		}
 	}
 
@@ -267,3 +292,27 @@ bool ParseOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFile
 {
 	return ParseOBJWithSplitStrings(meshVerts, objFilePath);
 }
+
+bool ParseOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes, char const* objFilePath)
+{
+	return ParseOBJWithSplitStrings(meshVerts, meshIndexes, objFilePath);
+}
+
+bool ConvertIndexesTo16Bit(std::vector<unsigned short>& out16BitIndexes, std::vector<unsigned int> const& meshIndexes)
+{
+	out16BitIndexes.clear();
+	out16BitIndexes.reserve(meshIndexes.size());
+
+	for (int indexIndex = 0; indexIndex < static_cast<int>(meshIndexes.size()); ++indexIndex)
+	{
+		unsigned int vertIndex = meshIndexes[indexIndex];
+		if (vertIndex > 0xFFFF)
+		{
+			out16BitIndexes.clear();
+			return false;
+		}
+		out16BitIndexes.push_back(static_cast<unsigned short>(vertIndex));
+	}
+
+	return true;
+}
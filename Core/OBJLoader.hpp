@@ -20,8 +20,38 @@ struct OBJTriIndexes
 	};
 };
 // -----------------------------------------------------------------------------
-bool LoadOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath); // This is what gets called from Game, calls ParseOBJMeshFile
+struct OBJCornerKey
+{
+	// One face corner in v/vt/vn form, identical corners share a single vertex in indexed meshes
+	int m_positionIndex = -1;
+	int m_uvIndex = -1;
+	int m_normalIndex = -1;
+
+	bool operator==(OBJCornerKey const& compare) const
+	{
+		return m_positionIndex == compare.m_positionIndex && m_uvIndex == compare.m_uvIndex && m_normalIndex == compare.m_normalIndex;
+	}
+};
+// -----------------------------------------------------------------------------
+struct OBJCornerKeyHash
+{
+	size_t operator()(OBJCornerKey const& cornerKey) const
+	{
+		size_t hash = static_cast<size_t>(static_cast<unsigned int>(cornerKey.m_positionIndex)) * 73856093u;
+		hash ^= static_cast<size_t>(static_cast<unsigned int>(cornerKey.m_uvIndex)) * 19349663u;
+		hash ^= static_cast<size_t>(static_cast<unsigned int>(cornerKey.m_normalIndex)) * 83492791u;
+		return hash;
+	}
+};
+// -----------------------------------------------------------------------------
+bool LoadOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath, bool useMeshCache = true); // This is what gets called from Game, calls ParseOBJMeshFile unless a valid .wmesh cache sits beside the file
+bool LoadOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes, char const* objFilePath, bool useMeshCache = true); // Indexed version, one vertex per unique v/vt/vn corner, reordered by OptimizeMesh
 void ComputeMissingNormals(std::vector<Vertex_PCUTBN>& meshVerts);
+void ComputeMissingNormals(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int> const& meshIndexes);
 void ComputeMissingTangentsAndBitangents(std::vector<Vertex_PCUTBN>& meshVerts);
+void ComputeMissingTangentsAndBitangents(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes); // May split mirrored uv vertexes, see ComputeMeshTangents
 bool ParseOBJWithSplitStrings(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath); // This is doing most of the work, may need more arguments
-bool ParseOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath); // This will only be one to two lines calling ParseOBJWithSplitStrings
\ No newline at end of file
+bool ParseOBJWithSplitStrings(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes, char const* objFilePath);
+bool ParseOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, char const* objFilePath); // This will only be one to two lines calling ParseOBJWithSplitStrings
+bool ParseOBJMeshFile(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes, char const* objFilePath);
+bool ConvertIndexesTo16Bit(std::vector<unsigned short>& out16BitIndexes, std::vector<unsigned int> const& meshIndexes); // False if any index is above 65535
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "Engine/Core/TextureCache.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/EngineCommon.h"
+#include <algorithm>
+#include <cstring>
+// -----------------------------------------------------------------------------
+static uint64_t GetAlignedOffset(uint64_t offset)
+{
+	return (offset + (TEXTURE_CACHE_DATA_ALIGNMENT - 1)) & ~static_cast<uint64_t>(TEXTURE_CACHE_DATA_ALIGNMENT - 1);
+}
+
+static bool IsTextureCacheHeaderValid(TextureCacheHeader const& header, size_t fileSize, char const* sourceFilePath)
+{
+	// Format checks, anything written by an older or different build is simply rebuilt
+	TextureCacheHeader const defaultHeader;
+	if (memcmp(header.m_fourCC, defaultHeader.m_fourCC, sizeof(header.m_fourCC)) != 0 ||
+		header.m_version != TEXTURE_CACHE_VERSION ||
+		header.m_headerSize != sizeof(TextureCacheHeader) ||
+		header.m_levelStride != sizeof(TextureCacheLevel) ||
+		header.m_format < static_cast<unsigned int>(TextureCacheFormat::RGBA8) ||
+		header.m_format > static_cast<unsigned int>(TextureCacheFormat::BC7) ||
+		header.m_numMipLevels == 0 || header.m_width == 0 || header.m_height == 0 ||
+		header.m_numMipLevels > 32 || (std::max(header.m_width, header.m_height) >> (header.m_numMipLevels - 1)) == 0)
+	{
+		return false;
+	}
+
+	// Checked against the bytes left after the offset so a huge offset cannot wrap around
+	uint64_t levelTableSize = static_cast<uint64_t>(header.m_numMipLevels) * sizeof(TextureCacheLevel);
+	if (header.m_levelTableOffset < sizeof(TextureCacheHeader) || header.m_levelTableOffset % alignof(TextureCacheLevel) != 0 ||
+		header.m_levelTableOffset > fileSize || levelTableSize > fileSize - header.m_levelTableOffset)
+	{
+		return false;
+	}
+
+	// Shipping builds may not have the sources at all, in which case the cache is all there is
+	if (sourceFilePath == nullptr || !DoesFileExist(sourceFilePath))
+	{
+		return true;
+	}
+
+	int64_t lastWriteTime = 0;
+	uint64_t fileSizeBytes = 0;
+	return GetFileTimestampAndSize(sourceFilePath, lastWriteTime, fileSizeBytes) &&
+		   lastWriteTime == header.m_sourceLastWriteTime && fileSizeBytes == header.m_sourceFileSize;
+}
+
+// The level pointers go straight to the GPU, so every level must be exactly the size its mip dimensions call for and
+// lie entirely inside the file
+static bool AreTextureCacheLevelsValid(TextureCacheHeader const& header, TextureCacheLevel const* levels, size_t fileSize)
+{
+	TextureCacheFormat format = static_cast<TextureCacheFormat>(header.m_format);
+	uint64_t bytesPerBlock = (format == TextureCacheFormat::BC1) ? 8 : 16;
+
+	for (unsigned int levelIndex = 0; levelIndex < header.m_numMipLevels; ++levelIndex)
+	{
+		TextureCacheLevel const& level = levels[levelIndex];
+		unsigned int width = std::max(header.m_width >> levelIndex, 1u);
+		unsigned int height = std::max(header.m_height >> levelIndex, 1u);
+		if (level.m_width != width || level.m_height != height)
+		{
+			return false;
+		}
+
+		uint64_t rowPitch = static_cast<uint64_t>(width) * sizeof(Rgba8);
+		uint64_t numRows = height;
+		if (format != TextureCacheFormat::RGBA8)
+		{
+			rowPitch = ((width + 3) / 4) * bytesPerBlock;
+			numRows = (height + 3) / 4;
+		}
+		if (level.m_rowPitch != rowPitch || static_cast<uint64_t>(level.m_rowPitch) * numRows > level.m_dataSize)
+		{
+			return false;
+		}
+
+		if (level.m_dataOffset % TEXTURE_CACHE_DATA_ALIGNMENT != 0 || level.m_dataOffset > fileSize || level.m_dataSize > fileSize - level.m_dataOffset)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Every level is already laid out the way it goes to the GPU, so writing is the same for texels and blocks
+static bool WriteTextureCacheLevels(char const* cacheFilePath, TextureCacheFormat format, std::vector<TextureCacheLevel>& levels, std::vector<void const*> const& levelData,
+	char const* sourceFilePath, unsigned int flags)
+{
+	TextureCacheHeader header;
+	header.m_headerSize = sizeof(TextureCacheHeader);
+	header.m_format = static_cast<unsigned int>(format);
+	header.m_flags = flags;
+	header.m_width = levels[0].m_width;
+	header.m_height = levels[0].m_height;
+	header.m_numMipLevels = static_cast<unsigned int>(levels.size());
+	header.m_levelStride = sizeof(TextureCacheLevel);
+	header.m_levelTableOffset = sizeof(TextureCacheHeader);
+	if (sourceFilePath != nullptr)
+	{
+		GetFileTimestampAndSize(sourceFilePath, header.m_sourceLastWriteTime, header.m_sourceFileSize);
+	}
+
+	uint64_t dataOffset = GetAlignedOffset(header.m_levelTableOffset + levels.size() * sizeof(TextureCacheLevel));
+	for (int levelIndex = 0; levelIndex < static_cast<int>(levels.size()); ++levelIndex)
+	{
+		levels[levelIndex].m_dataOffset = dataOffset;
+		dataOffset = GetAlignedOffset(dataOffset + levels[levelIndex].m_dataSize);
+	}
+
+	std::vector<uint8_t> fileBuffer(static_cast<size_t>(dataOffset), 0);
+	memcpy(fileBuffer.data(), &header, sizeof(TextureCacheHeader));
+	memcpy(fileBuffer.data() + header.m_levelTableOffset, levels.data(), levels.size() * sizeof(TextureCacheLevel));
+	for (int levelIndex = 0; levelIndex < static_cast<int>(levels.size()); ++levelIndex)
+	{
+		memcpy(fileBuffer.data() + levels[levelIndex].m_dataOffset, levelData[levelIndex], static_cast<size_t>(levels[levelIndex].m_dataSize));
+	}
+
+	return WriteBufferToFileReplacing(fileBuffer, cacheFilePath) == FILE_SUCCESS;
+}
+// -----------------------------------------------------------------------------
+std::string GetTextureCacheFilePath(char const* sourceFilePath)
+{
+	return Stringf("%s.wtex", sourceFilePath);
+}
+
+TextureCacheFormat GetTextureCacheFormat(BlockCompressionFormat format)
+{
+	switch (format)
+	{
+		case BlockCompressionFormat::BC1: return TextureCacheFormat::BC1;
+		case BlockCompressionFormat::BC3: return TextureCacheFormat::BC3;
+		default:						  return TextureCacheFormat::BC7;
+	}
+}
+
+bool WriteTextureCacheFile(char const* cacheFilePath, std::vector<Image> const& mipChain, char const* sourceFilePath, unsigned int flags)
+{
+	GUARANTEE_OR_DIE(!mipChain.empty(), Stringf("No mip levels given for texture cache \"%s\"", cacheFilePath));
+
+	int numLevels = static_cast<int>(mipChain.size());
+	std::vector<TextureCacheLevel> levels(numLevels);
+	std::vector<void const*> levelData(numLevels);
+	for (int levelIndex = 0; levelIndex < numLevels; ++levelIndex)
+	{
+		IntVec2 dimensions = mipChain[levelIndex].GetDimensions();
+		levels[levelIndex].m_width = dimensions.x;
+		levels[levelIndex].m_height = dimensions.y;
+		levels[levelIndex].m_rowPitch = dimensions.x * sizeof(Rgba8);
+		levels[levelIndex].m_dataSize = static_cast<uint64_t>(levels[levelIndex].m_rowPitch) * dimensions.y;
+		levelData[levelIndex] = mipChain[levelIndex].GetRawData();
+	}
+	return WriteTextureCacheLevels(cacheFilePath, TextureCacheFormat::RGBA8, levels, levelData, sourceFilePath, flags);
+}
+
+bool WriteTextureCacheFile(char const* cacheFilePath, std::vector<CompressedImage> const& mipChain, char const* sourceFilePath, unsigned int flags)
+{
+	GUARANTEE_OR_DIE(!mipChain.empty(), Stringf("No mip levels given for texture cache \"%s\"", cacheFilePath));
+
+	int numLevels = static_cast<int>(mipChain.size());
+	std::vector<TextureCacheLevel> levels(numLevels);
+	std::vector<void const*> levelData(numLevels);
+	for (int levelIndex = 0; levelIndex < numLevels; ++levelIndex)
+	{
+		CompressedImage const& levelImage = mipChain[levelIndex];
+		GUARANTEE_OR_DIE(levelImage.m_format == mipChain[0].m_format, Stringf("Texture cache \"%s\" mixes block formats between mip levels", cacheFilePath));
+		levels[levelIndex].m_width = levelImage.m_dimensions.x;
+		levels[levelIndex].m_height = levelImage.m_dimensions.y;
+		levels[levelIndex].m_rowPitch = GetBlockCompressionBlockCounts(levelImage.m_dimensions).x * GetBlockCompressionBytesPerBlock(levelImage.m_format);
+		levels[levelIndex].m_dataSize = levelImage.m_blocks.size();
+		levelData[levelIndex] = levelImage.m_blocks.data();
+	}
+	return WriteTextureCacheLevels(cacheFilePath, GetTextureCacheFormat(mipChain[0].m_format), levels, levelData, sourceFilePath, flags);
+}
+
+bool OpenTextureCacheView(TextureCacheView& out_view, char const* cacheFilePath, char const* sourceFilePath)
+{
+	out_view = TextureCacheView();
+	if (!OpenMappedFileView(out_view.m_fileView, cacheFilePath))
+	{
+		return false;
+	}
+
+	uint8_t const* fileBytes = static_cast<uint8_t const*>(out_view.m_fileView.m_data);
+	TextureCacheHeader const* header = reinterpret_cast<TextureCacheHeader const*>(fileBytes);
+	if (out_view.m_fileView.m_size < sizeof(TextureCacheHeader) || !IsTextureCacheHeaderValid(*header, out_view.m_fileView.m_size, sourceFilePath))
+	{
+		CloseTextureCacheView(out_view);
+		return false;
+	}
+
+	// Truncated or corrupt files fail here
+	TextureCacheLevel const* levels = reinterpret_cast<TextureCacheLevel const*>(fileBytes + header->m_levelTableOffset);
+	if (!AreTextureCacheLevelsValid(*header, levels, out_view.m_fileView.m_size))
+	{
+		CloseTextureCacheView(out_view);
+		return false;
+	}
+
+	out_view.m_header = header;
+	out_view.m_levels = levels;
+	out_view.m_fileBytes = fileBytes;
+	return true;
+}
+
+void CloseTextureCacheView(TextureCacheView& view)
+{
+	CloseMappedFileView(view.m_fileView);
+	view = TextureCacheView();
+}
+
+void const* GetTextureCacheLevelData(TextureCacheView const& view, int levelIndex)
+{
+	return view.m_fileBytes + view.m_levels[levelIndex].m_dataOffset;
+}
+// -----------------------------------------------------------------------------
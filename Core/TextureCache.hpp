@@ -0,0 +1,77 @@
+#pragma once
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/BlockCompression.hpp"
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Binary texture cache (.wtex), written beside the source image so later runs skip decoding entirely.
+//
+// Layout: TextureCacheHeader, then one TextureCacheLevel per mip level, then every level's texels or
+// blocks exactly as the GPU takes them, each starting at the offset in its level entry. A warm start
+// is one file mapping with the level pointers handed straight to the texture creation call.
+// -----------------------------------------------------------------------------
+constexpr unsigned int TEXTURE_CACHE_VERSION = 1;
+constexpr unsigned int TEXTURE_CACHE_DATA_ALIGNMENT = 16;
+// -----------------------------------------------------------------------------
+enum class TextureCacheFormat : unsigned int
+{
+	RGBA8 = 1,
+	BC1,
+	BC3,
+	BC7
+};
+// -----------------------------------------------------------------------------
+enum TextureCacheFlags : unsigned int
+{
+	TEXTURE_CACHE_FLAG_NONE = 0,
+	TEXTURE_CACHE_FLAG_SRGB = 1 << 0,	// Mips were filtered as sRGB color, otherwise as linear values
+};
+// -----------------------------------------------------------------------------
+struct TextureCacheHeader
+{
+	char		 m_fourCC[4] = { 'W', 'T', 'E', 'X' };
+	unsigned int m_version = TEXTURE_CACHE_VERSION;
+	unsigned int m_headerSize = 0;
+	unsigned int m_format = static_cast<unsigned int>(TextureCacheFormat::RGBA8);
+
+	unsigned int m_width = 0;
+	unsigned int m_height = 0;
+	unsigned int m_numMipLevels = 0;
+	unsigned int m_levelStride = 0;
+
+	uint64_t	 m_levelTableOffset = 0;
+	uint64_t	 m_sourceFileSize = 0;
+	int64_t		 m_sourceLastWriteTime = 0;
+	unsigned int m_flags = TEXTURE_CACHE_FLAG_NONE;
+	unsigned int m_padding0 = 0;
+};
+static_assert(sizeof(TextureCacheHeader) == 64, "TextureCacheHeader layout is part of the file format, bump TEXTURE_CACHE_VERSION when changing it");
+// -----------------------------------------------------------------------------
+struct TextureCacheLevel
+{
+	unsigned int m_width = 0;
+	unsigned int m_height = 0;
+	unsigned int m_rowPitch = 0;	// Bytes per texel row, or per block row for the BCn formats
+	unsigned int m_padding0 = 0;
+	uint64_t	 m_dataOffset = 0;
+	uint64_t	 m_dataSize = 0;
+};
+static_assert(sizeof(TextureCacheLevel) == 32, "TextureCacheLevel layout is part of the file format, bump TEXTURE_CACHE_VERSION when changing it");
+// -----------------------------------------------------------------------------
+struct TextureCacheView
+{
+	// Points straight into the mapped file, valid until CloseTextureCacheView
+	TextureCacheHeader const* m_header = nullptr;
+	TextureCacheLevel const*  m_levels = nullptr;
+	uint8_t const*			  m_fileBytes = nullptr;
+	MappedFileView			  m_fileView;
+};
+// -----------------------------------------------------------------------------
+std::string		   GetTextureCacheFilePath(char const* sourceFilePath);
+TextureCacheFormat GetTextureCacheFormat(BlockCompressionFormat format);
+bool			   WriteTextureCacheFile(char const* cacheFilePath, std::vector<Image> const& mipChain, char const* sourceFilePath = nullptr, unsigned int flags = TEXTURE_CACHE_FLAG_NONE);
+bool			   WriteTextureCacheFile(char const* cacheFilePath, std::vector<CompressedImage> const& mipChain, char const* sourceFilePath = nullptr, unsigned int flags = TEXTURE_CACHE_FLAG_NONE);
+bool			   OpenTextureCacheView(TextureCacheView& out_view, char const* cacheFilePath, char const* sourceFilePath = nullptr); // Source last write time and size must match when the source exists
+void			   CloseTextureCacheView(TextureCacheView& view);
+void const*		   GetTextureCacheLevelData(TextureCacheView const& view, int levelIndex);
+// -----------------------------------------------------------------------------
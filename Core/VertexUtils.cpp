@@ -1,34 +1,319 @@
 #include "Engine/Core/VertexUtils.h"
 #include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
 #include "Engine/Math/MathUtils.h"
+#include "Engine/Math/IntVec2.h"
 #include "Engine/Math/AABB3.hpp"
 #include "Engine/Math/OBB3.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <cstring>
+// -----------------------------------------------------------------------------
+constexpr int VERTEX_TRANSFORM_VERTS_PER_CHUNK = 256;
+// -----------------------------------------------------------------------------
+// Batched Vec3 transforms over strided arrays. Each batch loads 16 bytes per Vec3 and transposes them into x, y and z
+// registers, so the 4 bytes after the last element would be read too; the last element of the array is therefore
+// always left to the scalar tail. Every batch operation does the scalar operations in the scalar order, so results
+// match the per vertex functions bit for bit.
+struct AffineVec3Batch
+{
+	float m_values[16];
+	bool  m_addTranslation = true;	// False transforms directions (w = 0)
+	bool  m_normalize = false;		// Same as GetNormalized() on the result, zero length stays zero
+
+	AffineVec3Batch(Mat44 const& transform, bool addTranslation, bool normalize = false)
+		: m_addTranslation(addTranslation)
+		, m_normalize(normalize)
+	{
+		memcpy(m_values, transform.m_values, sizeof(m_values));
+	}
+
+	void operator()(float& x, float& y, float& z) const
+	{
+		float const* m = m_values;
+		float resultX = (m[Mat44::Ix] * x) + (m[Mat44::Jx] * y) + (m[Mat44::Kx] * z);
+		float resultY = (m[Mat44::Iy] * x) + (m[Mat44::Jy] * y) + (m[Mat44::Ky] * z);
+		float resultZ = (m[Mat44::Iz] * x) + (m[Mat44::Jz] * y) + (m[Mat44::Kz] * z);
+		x = m_addTranslation ? resultX + m[Mat44::Tx] : resultX;
+		y = m_addTranslation ? resultY + m[Mat44::Ty] : resultY;
+		z = m_addTranslation ? resultZ + m[Mat44::Tz] : resultZ;
+		if (m_normalize)
+		{
+			float length = sqrtf((x * x) + (y * y) + (z * z));
+			x = length > 0.f ? x / length : 0.f;
+			y = length > 0.f ? y / length : 0.f;
+			z = length > 0.f ? z / length : 0.f;
+		}
+	}
+
+	void operator()(__m128& x, __m128& y, __m128& z) const
+	{
+		__m128 results[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			__m128 sum = _mm_mul_ps(_mm_set1_ps(m_values[Mat44::Ix + axis]), x);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(m_values[Mat44::Jx + axis]), y));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(m_values[Mat44::Kx + axis]), z));
+			results[axis] = m_addTranslation ? _mm_add_ps(sum, _mm_set1_ps(m_values[Mat44::Tx + axis])) : sum;
+		}
+		x = results[0];
+		y = results[1];
+		z = results[2];
+		if (m_normalize)
+		{
+			__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+			__m128 isNonZero = _mm_cmpgt_ps(length, _mm_setzero_ps());
+			x = _mm_and_ps(_mm_div_ps(x, length), isNonZero);
+			y = _mm_and_ps(_mm_div_ps(y, length), isNonZero);
+			z = _mm_and_ps(_mm_div_ps(z, length), isNonZero);
+		}
+	}
+
+	void operator()(__m256& x, __m256& y, __m256& z) const
+	{
+		__m256 results[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			__m256 sum = _mm256_mul_ps(_mm256_set1_ps(m_values[Mat44::Ix + axis]), x);
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(m_values[Mat44::Jx + axis]), y));
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(m_values[Mat44::Kx + axis]), z));
+			results[axis] = m_addTranslation ? _mm256_add_ps(sum, _mm256_set1_ps(m_values[Mat44::Tx + axis])) : sum;
+		}
+		x = results[0];
+		y = results[1];
+		z = results[2];
+		if (m_normalize)
+		{
+			__m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+			__m256 isNonZero = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ);
+			x = _mm256_and_ps(_mm256_div_ps(x, length), isNonZero);
+			y = _mm256_and_ps(_mm256_div_ps(y, length), isNonZero);
+			z = _mm256_and_ps(_mm256_div_ps(z, length), isNonZero);
+		}
+	}
+};
+
+// Same steps as TransformPositionXY3D, with the sine and cosine taken once for the whole array
+struct PositionXYBatch
+{
+	float m_scale = 1.f;
+	float m_cos = 1.f;
+	float m_sin = 0.f;
+	Vec2  m_translation;
+
+	void operator()(float& x, float& y, float& z) const
+	{
+		UNUSED(z);
+		float scaledX = x * m_scale;
+		float scaledY = y * m_scale;
+		x = (scaledX * m_cos - scaledY * m_sin) + m_translation.x;
+		y = (scaledX * m_sin + scaledY * m_cos) + m_translation.y;
+	}
+
+	void operator()(__m128& x, __m128& y, __m128& z) const
+	{
+		UNUSED(z);
+		__m128 scaledX = _mm_mul_ps(x, _mm_set1_ps(m_scale));
+		__m128 scaledY = _mm_mul_ps(y, _mm_set1_ps(m_scale));
+		x = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(scaledX, _mm_set1_ps(m_cos)), _mm_mul_ps(scaledY, _mm_set1_ps(m_sin))), _mm_set1_ps(m_translation.x));
+		y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(scaledX, _mm_set1_ps(m_sin)), _mm_mul_ps(scaledY, _mm_set1_ps(m_cos))), _mm_set1_ps(m_translation.y));
+	}
+
+	void operator()(__m256& x, __m256& y, __m256& z) const
+	{
+		UNUSED(z);
+		__m256 scaledX = _mm256_mul_ps(x, _mm256_set1_ps(m_scale));
+		__m256 scaledY = _mm256_mul_ps(y, _mm256_set1_ps(m_scale));
+		x = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(scaledX, _mm256_set1_ps(m_cos)), _mm256_mul_ps(scaledY, _mm256_set1_ps(m_sin))), _mm256_set1_ps(m_translation.x));
+		y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(scaledX, _mm256_set1_ps(m_sin)), _mm256_mul_ps(scaledY, _mm256_set1_ps(m_cos))), _mm256_set1_ps(m_translation.y));
+	}
+};
+
+static void StoreVec3(unsigned char* out_vec3, __m128 xyzw)
+{
+	// Only 12 bytes, whatever follows the Vec3 in the vertex is left alone
+	_mm_storel_pi(reinterpret_cast<__m64*>(out_vec3), xyzw);
+	_mm_store_ss(reinterpret_cast<float*>(out_vec3) + 2, _mm_movehl_ps(xyzw, xyzw));
+}
+
+template <typename BatchOperation>
+static int TransformVec3Batches_AVX(unsigned char* firstVec3, size_t stride, int startIndex, int endIndex, BatchOperation const& operation)
+{
+	int index = startIndex;
+	for (; index + 8 <= endIndex; index += 8)
+	{
+		unsigned char* batch = firstVec3 + stride * index;
+		__m256 rows[4];
+		for (int rowIndex = 0; rowIndex < 4; ++rowIndex)
+		{
+			__m128 lowVec3 = _mm_loadu_ps(reinterpret_cast<float const*>(batch + stride * rowIndex));
+			__m128 highVec3 = _mm_loadu_ps(reinterpret_cast<float const*>(batch + stride * (rowIndex + 4)));
+			rows[rowIndex] = _mm256_insertf128_ps(_mm256_castps128_ps256(lowVec3), highVec3, 1);
+		}
+
+		// _MM_TRANSPOSE4_PS on both 128 bit halves at once
+		__m256 xy01 = _mm256_shuffle_ps(rows[0], rows[1], _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 zw01 = _mm256_shuffle_ps(rows[0], rows[1], _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 xy23 = _mm256_shuffle_ps(rows[2], rows[3], _MM_SHUFFLE(1, 0, 1, 0));
+		__m256 zw23 = _mm256_shuffle_ps(rows[2], rows[3], _MM_SHUFFLE(3, 2, 3, 2));
+		__m256 x = _mm256_shuffle_ps(xy01, xy23, _MM_SHUFFLE(2, 0, 2, 0));
+		__m256 y = _mm256_shuffle_ps(xy01, xy23, _MM_SHUFFLE(3, 1, 3, 1));
+		__m256 z = _mm256_shuffle_ps(zw01, zw23, _MM_SHUFFLE(2, 0, 2, 0));
+		__m256 w = _mm256_shuffle_ps(zw01, zw23, _MM_SHUFFLE(3, 1, 3, 1));
+
+		operation(x, y, z);
+
+		xy01 = _mm256_unpacklo_ps(x, y);
+		xy23 = _mm256_unpackhi_ps(x, y);
+		zw01 = _mm256_unpacklo_ps(z, w);
+		zw23 = _mm256_unpackhi_ps(z, w);
+		rows[0] = _mm256_shuffle_ps(xy01, zw01, _MM_SHUFFLE(1, 0, 1, 0));
+		rows[1] = _mm256_shuffle_ps(xy01, zw01, _MM_SHUFFLE(3, 2, 3, 2));
+		rows[2] = _mm256_shuffle_ps(xy23, zw23, _MM_SHUFFLE(1, 0, 1, 0));
+		rows[3] = _mm256_shuffle_ps(xy23, zw23, _MM_SHUFFLE(3, 2, 3, 2));
+		for (int rowIndex = 0; rowIndex < 4; ++rowIndex)
+		{
+			StoreVec3(batch + stride * rowIndex, _mm256_castps256_ps128(rows[rowIndex]));
+			StoreVec3(batch + stride * (rowIndex + 4), _mm256_extractf128_ps(rows[rowIndex], 1));
+		}
+	}
+	_mm256_zeroupper();
+	return index;
+}
 
-void TransformVertexArrayXY3D(int numVerts, Vertex_PCU* verts, float uniformScaleXY, float rotationDegreesAboutZ, Vec2 const& translationXY)
+template <typename BatchOperation>
+static void TransformVec3Range(unsigned char* firstVec3, size_t stride, int numVec3s, int startIndex, int endIndex, BatchOperation const& operation)
 {
-	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	// The engine always builds with /arch:AVX2, the SSE batch and the scalar loop only pick up what is left over
+	int lastBatchEnd = std::min(endIndex, numVec3s - 1);
+	int index = TransformVec3Batches_AVX(firstVec3, stride, startIndex, lastBatchEnd, operation);
+	for (; index + 4 <= lastBatchEnd; index += 4)
 	{
-		Vec3& pos = verts[vertIndex].m_position;
-		TransformPositionXY3D(pos, uniformScaleXY, rotationDegreesAboutZ, translationXY);
+		unsigned char* batch = firstVec3 + stride * index;
+		__m128 x = _mm_loadu_ps(reinterpret_cast<float const*>(batch));
+		__m128 y = _mm_loadu_ps(reinterpret_cast<float const*>(batch + stride));
+		__m128 z = _mm_loadu_ps(reinterpret_cast<float const*>(batch + stride * 2));
+		__m128 w = _mm_loadu_ps(reinterpret_cast<float const*>(batch + stride * 3));
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		operation(x, y, z);
+
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		StoreVec3(batch, x);
+		StoreVec3(batch + stride, y);
+		StoreVec3(batch + stride * 2, z);
+		StoreVec3(batch + stride * 3, w);
+	}
+	for (; index < endIndex; ++index)
+	{
+		float* vec3 = reinterpret_cast<float*>(firstVec3 + stride * index);
+		operation(vec3[0], vec3[1], vec3[2]);
 	}
 }
 
-void TransformVertexArray3D(std::vector<Vertex_PCU>& verts, Mat44 const& transform)
+template <typename BatchOperation>
+static void TransformVec3Array(void* firstVec3, size_t stride, int numVec3s, BatchOperation const& operation, JobSystem* jobSystem)
+{
+	unsigned char* firstByte = static_cast<unsigned char*>(firstVec3);
+	auto rangeFunction = [&](int startIndex, int endIndex)
+	{
+		TransformVec3Range(firstByte, stride, numVec3s, startIndex, endIndex, operation);
+	};
+
+	if (jobSystem != nullptr)
+	{
+		jobSystem->ExecuteParallelFor(numVec3s, VERTEX_TRANSFORM_MIN_VERTS_PER_JOB, rangeFunction);
+	}
+	else
+	{
+		rangeFunction(0, numVec3s);
+	}
+}
+// -----------------------------------------------------------------------------
+void TransformVertexArrayXY3D(int numVerts, Vertex_PCU* verts, float uniformScaleXY, float rotationDegreesAboutZ, Vec2 const& translationXY, JobSystem* jobSystem)
 {
-	for (int vertIndex = 0; vertIndex < (int)verts.size(); ++vertIndex)
+	if (numVerts <= 0)
 	{
-		Vec3& pos = verts[vertIndex].m_position;
-		pos = transform.TransformPosition3D(pos);
+		return;
 	}
+
+	PositionXYBatch operation;
+	operation.m_scale = uniformScaleXY;
+	operation.m_cos = CosDegrees(rotationDegreesAboutZ);
+	operation.m_sin = SinDegrees(rotationDegreesAboutZ);
+	operation.m_translation = translationXY;
+	TransformVec3Array(&verts[0].m_position, sizeof(Vertex_PCU), numVerts, operation, jobSystem);
 }
 
-void TransformVertexArrayTBN3D(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform)
+void TransformVertexArray3D(std::vector<Vertex_PCU>& verts, Mat44 const& transform, JobSystem* jobSystem)
 {
-	for (int vertIndex = 0; vertIndex < (int)verts.size(); ++vertIndex)
+	if (verts.empty())
 	{
-		Vec3& pos = verts[vertIndex].m_position;
-		pos = transform.TransformPosition3D(pos);
+		return;
 	}
+
+	TransformVec3Array(&verts[0].m_position, sizeof(Vertex_PCU), static_cast<int>(verts.size()), AffineVec3Batch(transform, true), jobSystem);
+}
+
+void TransformVertexArrayTBN3D(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform, JobSystem* jobSystem)
+{
+	if (verts.empty())
+	{
+		return;
+	}
+
+	// Tangent and bitangent lie in the surface and follow the matrix, the normal follows its inverse transpose so it
+	// stays perpendicular to them under non-uniform scale. All three come out unit length.
+	Vec3 iBasis = transform.GetIBasis3D();
+	Vec3 jBasis = transform.GetJBasis3D();
+	Vec3 kBasis = transform.GetKBasis3D();
+	Vec3 jCrossK = CrossProduct3D(jBasis, kBasis);
+	Vec3 kCrossI = CrossProduct3D(kBasis, iBasis);
+	Vec3 iCrossJ = CrossProduct3D(iBasis, jBasis);
+	float determinant = DotProduct3D(iBasis, jCrossK);
+	GUARANTEE_OR_DIE(determinant != 0.f, "TransformVertexArrayTBN3D needs an invertible transform to carry normals");
+	Mat44 normalTransform;
+	normalTransform.SetIJK3D(jCrossK / determinant, kCrossI / determinant, iCrossJ / determinant);
+
+	int numVerts = static_cast<int>(verts.size());
+	AffineVec3Batch positionOperation(transform, true);
+	AffineVec3Batch directionOperation(transform, false, true);
+	AffineVec3Batch normalOperation(normalTransform, false, true);
+	unsigned char* firstPosition = reinterpret_cast<unsigned char*>(&verts[0].m_position);
+	unsigned char* firstTangent = reinterpret_cast<unsigned char*>(&verts[0].m_tangent);
+	unsigned char* firstBitangent = reinterpret_cast<unsigned char*>(&verts[0].m_bitangent);
+	unsigned char* firstNormal = reinterpret_cast<unsigned char*>(&verts[0].m_normal);
+	auto rangeFunction = [&](int startIndex, int endIndex)
+	{
+		// All four vectors of a chunk while its vertexes are still in cache, rather than four passes over the array
+		for (int chunkStart = startIndex; chunkStart < endIndex; chunkStart += VERTEX_TRANSFORM_VERTS_PER_CHUNK)
+		{
+			int chunkEnd = std::min(chunkStart + VERTEX_TRANSFORM_VERTS_PER_CHUNK, endIndex);
+			TransformVec3Range(firstPosition, sizeof(Vertex_PCUTBN), numVerts, chunkStart, chunkEnd, positionOperation);
+			TransformVec3Range(firstTangent, sizeof(Vertex_PCUTBN), numVerts, chunkStart, chunkEnd, directionOperation);
+			TransformVec3Range(firstBitangent, sizeof(Vertex_PCUTBN), numVerts, chunkStart, chunkEnd, directionOperation);
+			TransformVec3Range(firstNormal, sizeof(Vertex_PCUTBN), numVerts, chunkStart, chunkEnd, normalOperation);
+		}
+	};
+
+	if (jobSystem != nullptr)
+	{
+		jobSystem->ExecuteParallelFor(numVerts, VERTEX_TRANSFORM_MIN_VERTS_PER_JOB, rangeFunction);
+	}
+	else
+	{
+		rangeFunction(0, numVerts);
+	}
+}
+
+void TransformPositionArray3D(int numPositions, Vec3* positions, Mat44 const& transform, JobSystem* jobSystem)
+{
+	if (numPositions <= 0)
+	{
+		return;
+	}
+
+	TransformVec3Array(positions, sizeof(Vec3), numPositions, AffineVec3Batch(transform, true), jobSystem);
 }
 
 AABB2 GetVertexBounds(std::vector<Vertex_PCU> const& verts)
@@ -1165,4 +1450,49 @@ void AddVertsForCylinderOriented3D(std::vector<Vertex_PCUTBN>& vertexes, std::ve
 		indexes.push_back(base + 13);
 		indexes.push_back(base + 14);
     }
-}
\ No newline at end of file
+}
+
+void AddVertsForHeightfield3D(std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indexes, float const* heights, IntVec2 const& numQuads, Vec2 const& mins, float quadSize, Rgba8 const& color, AABB2 const& UVs)
+{
+	int numVertsX = numQuads.x + 1;
+	int numVertsY = numQuads.y + 1;
+	int heightsPitch = numQuads.x + 3;
+	unsigned int firstVertIndex = static_cast<unsigned int>(vertexes.size());
+	vertexes.reserve(vertexes.size() + static_cast<size_t>(numVertsX) * numVertsY);
+	indexes.reserve(indexes.size() + static_cast<size_t>(numQuads.x) * numQuads.y * 6);
+
+	float twoQuadSizes = 2.f * quadSize;
+	for (int vertY = 0; vertY < numVertsY; ++vertY)
+	{
+		float v = RangeMap(static_cast<float>(vertY), 0.f, static_cast<float>(numQuads.y), UVs.m_mins.y, UVs.m_maxs.y);
+		float const* sample = heights + (vertY + 1) * heightsPitch + 1;
+		for (int vertX = 0; vertX < numVertsX; ++vertX, ++sample)
+		{
+			// Rise over two quads along each axis, the tangent and bitangent follow the surface and the normal is their cross product
+			float riseX = sample[1] - sample[-1];
+			float riseY = sample[heightsPitch] - sample[-heightsPitch];
+			Vec3 tangent = Vec3(twoQuadSizes, 0.f, riseX).GetNormalized();
+			Vec3 bitangent = Vec3(0.f, twoQuadSizes, riseY).GetNormalized();
+			Vec3 normal = Vec3(-riseX, -riseY, twoQuadSizes).GetNormalized();
+
+			Vec3 position(mins.x + static_cast<float>(vertX) * quadSize, mins.y + static_cast<float>(vertY) * quadSize, *sample);
+			float u = RangeMap(static_cast<float>(vertX), 0.f, static_cast<float>(numQuads.x), UVs.m_mins.x, UVs.m_maxs.x);
+			vertexes.push_back(Vertex_PCUTBN(position, color, Vec2(u, v), tangent, bitangent, normal));
+		}
+	}
+
+	for (int quadY = 0; quadY < numQuads.y; ++quadY)
+	{
+		for (int quadX = 0; quadX < numQuads.x; ++quadX)
+		{
+			unsigned int bottomLeft = firstVertIndex + static_cast<unsigned int>(quadY * numVertsX + quadX);
+			unsigned int topLeft = bottomLeft + static_cast<unsigned int>(numVertsX);
+			indexes.push_back(bottomLeft);
+			indexes.push_back(bottomLeft + 1);
+			indexes.push_back(topLeft + 1);
+			indexes.push_back(bottomLeft);
+			indexes.push_back(topLeft + 1);
+			indexes.push_back(topLeft);
+		}
+	}
+}
@@ -7,8 +7,10 @@
 constexpr int NUM_CAPSULE_SLICES = 16;
 constexpr float DEGREES_PER_CAPSULESLICE = 180.f / (static_cast<float>(NUM_CAPSULE_SLICES));
 constexpr int NUM_DISC_SLICES = 30;
+constexpr int VERTEX_TRANSFORM_MIN_VERTS_PER_JOB = 8192;
 // -----------------------------------------------------------------------------
 class  Mat44;
+class  JobSystem;
 struct AABB3;
 struct OBB2;
 struct OBB3;
@@ -16,10 +18,14 @@ struct LineSegment2;
 struct Capsule2;
 struct Triangle2;
 struct Disc2;
+struct IntVec2;
 // -----------------------------------------------------------------------------
-void TransformVertexArrayXY3D(int numVerts, Vertex_PCU* verts, float uniformScaleXY, float rotationDegreesAboutZ, Vec2 const& translationXY);
-void TransformVertexArray3D(std::vector<Vertex_PCU>& verts, Mat44 const& transform);
-void TransformVertexArrayTBN3D(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform);
+// The transforms run 4 vertexes at a time (8 with AVX) with results identical to transforming them one by one.
+// With a job system, arrays over VERTEX_TRANSFORM_MIN_VERTS_PER_JOB vertexes are split across the workers.
+void TransformVertexArrayXY3D(int numVerts, Vertex_PCU* verts, float uniformScaleXY, float rotationDegreesAboutZ, Vec2 const& translationXY, JobSystem* jobSystem = nullptr);
+void TransformVertexArray3D(std::vector<Vertex_PCU>& verts, Mat44 const& transform, JobSystem* jobSystem = nullptr);
+void TransformVertexArrayTBN3D(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform, JobSystem* jobSystem = nullptr); // Normal by the inverse transpose, tangent frame renormalized
+void TransformPositionArray3D(int numPositions, Vec3* positions, Mat44 const& transform, JobSystem* jobSystem = nullptr);
 AABB2 GetVertexBounds(std::vector<Vertex_PCU> const& verts);
 Vec2  GetDiscUV(Vec3 const& position, Vec3 const& center, Vec3 const& jBasis, Vec3 const& kBasis, float radius);
 // -----------------------------------------------------------------------------
@@ -74,4 +80,9 @@ void AddVertsForCylinderZ3D(std::vector<Vertex_PCUTBN>& vertexes, std::vector<un
 void AddVertsForCylinder3D(std::vector<Vertex_PCUTBN>& vertexes, Vec3 const& start, Vec3 const& end, float radius,
 	Rgba8 const& color = Rgba8::WHITE, AABB2 const& UVs = AABB2::ZERO_TO_ONE, int numSlices = 8);
 void AddVertsForCylinderOriented3D(std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indexes, Vec3 const& start, Vec3 const& end, float radius, Rgba8 const& color, AABB2 const& UVs, int numSlices);
+// A z-up grid of numQuads.x by numQuads.y quads from mins, with normals and tangents from central differences. Heights
+// holds (numQuads.x + 3) * (numQuads.y + 3) samples row major starting one quad below mins on both axes, the grid's
+// own points plus a one sample border, so neighbouring grids built from the same samples get identical edge normals.
+void AddVertsForHeightfield3D(std::vector<Vertex_PCUTBN>& vertexes, std::vector<unsigned int>& indexes, float const* heights, IntVec2 const& numQuads, Vec2 const& mins, float quadSize,
+	Rgba8 const& color = Rgba8::WHITE, AABB2 const& UVs = AABB2::ZERO_TO_ONE);
 // -----------------------------------------------------------------------------
@@ -0,0 +1,512 @@
+#include "Engine/Math/BVH3D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include <algorithm>
+#include <cfloat>
+// -----------------------------------------------------------------------------
+// A node still to be split, nodes are allocated by their parent and filled in when their task runs
+struct BVHBuildTask
+{
+	int m_nodeIndex = 0;
+	int m_firstIndex = 0;
+	int m_numPrimitives = 0;
+	int m_depth = 0;
+};
+
+struct BVHBuildContext
+{
+	std::vector<AABB3> const* m_primitiveBounds = nullptr;
+	std::vector<Vec3>		  m_centroids;
+	std::vector<int>*		  m_primitiveIndices = nullptr;
+};
+// -----------------------------------------------------------------------------
+static AABB3 const GetEmptyBounds()
+{
+	return AABB3(Vec3(FLT_MAX, FLT_MAX, FLT_MAX), Vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+}
+
+static void StretchToIncludeBounds(AABB3& bounds, AABB3 const& boundsToInclude)
+{
+	bounds.m_mins.x = std::min(bounds.m_mins.x, boundsToInclude.m_mins.x);
+	bounds.m_mins.y = std::min(bounds.m_mins.y, boundsToInclude.m_mins.y);
+	bounds.m_mins.z = std::min(bounds.m_mins.z, boundsToInclude.m_mins.z);
+	bounds.m_maxs.x = std::max(bounds.m_maxs.x, boundsToInclude.m_maxs.x);
+	bounds.m_maxs.y = std::max(bounds.m_maxs.y, boundsToInclude.m_maxs.y);
+	bounds.m_maxs.z = std::max(bounds.m_maxs.z, boundsToInclude.m_maxs.z);
+}
+
+static float GetHalfSurfaceArea(AABB3 const& bounds)
+{
+	Vec3 dimensions = bounds.m_maxs - bounds.m_mins;
+	return (dimensions.x * dimensions.y) + (dimensions.y * dimensions.z) + (dimensions.z * dimensions.x);
+}
+
+static float GetAxisValue(Vec3 const& vector, int axisIndex)
+{
+	return axisIndex == 0 ? vector.x : (axisIndex == 1 ? vector.y : vector.z);
+}
+// -----------------------------------------------------------------------------
+// Finds the cheapest binned SAH split of the task's primitives, returns false when keeping them as a leaf is cheaper
+// or the centroids are all in one spot
+static bool FindBestSAHSplit(BVHBuildContext const& context, BVHBuildTask const& task, AABB3 const& nodeBounds, AABB3 const& centroidBounds,
+	int& out_axisIndex, float& out_splitPosition)
+{
+	float leafCost = static_cast<float>(task.m_numPrimitives);
+	float bestCost = FLT_MAX;
+	float nodeArea = GetHalfSurfaceArea(nodeBounds);
+	int const* primitiveIndices = context.m_primitiveIndices->data() + task.m_firstIndex;
+
+	for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+	{
+		float centroidMin = GetAxisValue(centroidBounds.m_mins, axisIndex);
+		float centroidExtent = GetAxisValue(centroidBounds.m_maxs, axisIndex) - centroidMin;
+		if (centroidExtent <= 0.f)
+		{
+			continue;
+		}
+
+		AABB3 binBounds[BVH_NUM_SAH_BINS];
+		int binCounts[BVH_NUM_SAH_BINS] = {};
+		for (int binIndex = 0; binIndex < BVH_NUM_SAH_BINS; ++binIndex)
+		{
+			binBounds[binIndex] = GetEmptyBounds();
+		}
+
+		float binScale = static_cast<float>(BVH_NUM_SAH_BINS) / centroidExtent;
+		for (int index = 0; index < task.m_numPrimitives; ++index)
+		{
+			int primitiveIndex = primitiveIndices[index];
+			int binIndex = static_cast<int>((GetAxisValue(context.m_centroids[primitiveIndex], axisIndex) - centroidMin) * binScale);
+			binIndex = std::min(binIndex, BVH_NUM_SAH_BINS - 1);
+			++binCounts[binIndex];
+			StretchToIncludeBounds(binBounds[binIndex], (*context.m_primitiveBounds)[primitiveIndex]);
+		}
+
+		// Sweep from the right to get the cost of everything past each split plane, then from the left
+		float rightAreas[BVH_NUM_SAH_BINS];
+		int rightCounts[BVH_NUM_SAH_BINS];
+		AABB3 rightBounds = GetEmptyBounds();
+		int rightCount = 0;
+		for (int binIndex = BVH_NUM_SAH_BINS - 1; binIndex > 0; --binIndex)
+		{
+			StretchToIncludeBounds(rightBounds, binBounds[binIndex]);
+			rightCount += binCounts[binIndex];
+			rightAreas[binIndex] = GetHalfSurfaceArea(rightBounds);
+			rightCounts[binIndex] = rightCount;
+		}
+
+		AABB3 leftBounds = GetEmptyBounds();
+		int leftCount = 0;
+		for (int binIndex = 0; binIndex < BVH_NUM_SAH_BINS - 1; ++binIndex)
+		{
+			StretchToIncludeBounds(leftBounds, binBounds[binIndex]);
+			leftCount += binCounts[binIndex];
+			if (leftCount == 0 || rightCounts[binIndex + 1] == 0)
+			{
+				continue;
+			}
+
+			float cost = 1.f + ((GetHalfSurfaceArea(leftBounds) * static_cast<float>(leftCount)) + (rightAreas[binIndex + 1] * static_cast<float>(rightCounts[binIndex + 1]))) / nodeArea;
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				out_axisIndex = axisIndex;
+				out_splitPosition = centroidMin + static_cast<float>(binIndex + 1) / binScale;
+			}
+		}
+	}
+
+	if (bestCost == FLT_MAX)
+	{
+		return false;
+	}
+	return bestCost < leafCost || task.m_numPrimitives > BVH_MAX_LEAF_PRIMITIVES;
+}
+// -----------------------------------------------------------------------------
+// Splits tasks until every node is a leaf. Tasks over maxSerialPrimitives are handed back through
+// out_deferredTasks instead, when it is given.
+static void BuildBVHNodes(BVHBuildContext const& context, std::vector<BVHNode3D>& nodes, std::vector<BVHBuildTask>& tasks,
+	int maxSerialPrimitives, std::vector<BVHBuildTask>* out_deferredTasks)
+{
+	std::vector<int>& primitiveIndices = *context.m_primitiveIndices;
+	std::vector<AABB3> const& primitiveBounds = *context.m_primitiveBounds;
+	while (!tasks.empty())
+	{
+		BVHBuildTask task = tasks.back();
+		tasks.pop_back();
+		if (out_deferredTasks != nullptr && task.m_numPrimitives > 0 && task.m_numPrimitives <= maxSerialPrimitives)
+		{
+			out_deferredTasks->push_back(task);
+			continue;
+		}
+
+		AABB3 nodeBounds = GetEmptyBounds();
+		AABB3 centroidBounds = GetEmptyBounds();
+		for (int index = task.m_firstIndex; index < task.m_firstIndex + task.m_numPrimitives; ++index)
+		{
+			int primitiveIndex = primitiveIndices[index];
+			Vec3 const& centroid = context.m_centroids[primitiveIndex];
+			StretchToIncludeBounds(nodeBounds, primitiveBounds[primitiveIndex]);
+			StretchToIncludeBounds(centroidBounds, AABB3(centroid, centroid));
+		}
+
+		BVHNode3D& node = nodes[task.m_nodeIndex];
+		node.m_bounds = nodeBounds;
+		node.m_firstIndex = task.m_firstIndex;
+		node.m_numPrimitives = task.m_numPrimitives;
+
+		int axisIndex = 0;
+		float splitPosition = 0.f;
+		if (task.m_numPrimitives <= 2 || task.m_depth >= BVH_MAX_DEPTH - 1 || !FindBestSAHSplit(context, task, nodeBounds, centroidBounds, axisIndex, splitPosition))
+		{
+			// Leaf, unless identical centroids left too many primitives for one
+			if (task.m_numPrimitives <= BVH_MAX_LEAF_PRIMITIVES || task.m_depth >= BVH_MAX_DEPTH - 1 || centroidBounds.m_mins != centroidBounds.m_maxs)
+			{
+				continue;
+			}
+			axisIndex = -1;
+		}
+
+		int* first = primitiveIndices.data() + task.m_firstIndex;
+		int* last = first + task.m_numPrimitives;
+		int* middle = first + task.m_numPrimitives / 2;
+		if (axisIndex >= 0)
+		{
+			middle = std::partition(first, last, [&](int primitiveIndex)
+			{
+				return GetAxisValue(context.m_centroids[primitiveIndex], axisIndex) < splitPosition;
+			});
+		}
+
+		int numLeftPrimitives = static_cast<int>(middle - first);
+		int leftNodeIndex = static_cast<int>(nodes.size());
+		nodes.resize(nodes.size() + 2);
+		nodes[task.m_nodeIndex].m_firstIndex = leftNodeIndex;
+		nodes[task.m_nodeIndex].m_numPrimitives = 0;
+
+		BVHBuildTask leftTask = { leftNodeIndex, task.m_firstIndex, numLeftPrimitives, task.m_depth + 1 };
+		BVHBuildTask rightTask = { leftNodeIndex + 1, task.m_firstIndex + numLeftPrimitives, task.m_numPrimitives - numLeftPrimitives, task.m_depth + 1 };
+		tasks.push_back(rightTask);
+		tasks.push_back(leftTask);
+	}
+}
+// -----------------------------------------------------------------------------
+void BVH3D::Build(std::vector<AABB3> const& primitiveBounds, JobSystem* jobSystem)
+{
+	Clear();
+	int numPrimitives = static_cast<int>(primitiveBounds.size());
+	if (numPrimitives == 0)
+	{
+		return;
+	}
+
+	m_primitiveBounds = primitiveBounds;
+	m_primitiveIndices.resize(numPrimitives);
+	BVHBuildContext context;
+	context.m_primitiveBounds = &m_primitiveBounds;
+	context.m_primitiveIndices = &m_primitiveIndices;
+	context.m_centroids.resize(numPrimitives);
+	for (int primitiveIndex = 0; primitiveIndex < numPrimitives; ++primitiveIndex)
+	{
+		m_primitiveIndices[primitiveIndex] = primitiveIndex;
+		context.m_centroids[primitiveIndex] = (primitiveBounds[primitiveIndex].m_mins + primitiveBounds[primitiveIndex].m_maxs) * 0.5f;
+	}
+
+	m_nodes.reserve(2 * numPrimitives);
+	m_nodes.resize(1);
+	std::vector<BVHBuildTask> tasks;
+	tasks.push_back(BVHBuildTask{ 0, 0, numPrimitives, 0 });
+
+	bool isParallel = jobSystem != nullptr && jobSystem->GetNumWorkers() > 0 && numPrimitives > BVH_MIN_PRIMITIVES_PER_BUILD_JOB;
+	if (!isParallel)
+	{
+		BuildBVHNodes(context, m_nodes, tasks, 0, nullptr);
+		return;
+	}
+
+	// Split the top of the tree here until the subtrees are small enough to spread over the workers, then build
+	// each subtree into its own node list and splice them in after
+	int maxSubtreePrimitives = std::max(BVH_MIN_PRIMITIVES_PER_BUILD_JOB, numPrimitives / ((jobSystem->GetNumWorkers() + 1) * 4));
+	std::vector<BVHBuildTask> subtreeTasks;
+	BuildBVHNodes(context, m_nodes, tasks, maxSubtreePrimitives, &subtreeTasks);
+
+	int numSubtrees = static_cast<int>(subtreeTasks.size());
+	std::vector<std::vector<BVHNode3D>> subtreeNodes(numSubtrees);
+	jobSystem->ExecuteParallelFor(numSubtrees, 1, [&](int startIndex, int endIndex)
+	{
+		std::vector<BVHBuildTask> localTasks;
+		for (int subtreeIndex = startIndex; subtreeIndex < endIndex; ++subtreeIndex)
+		{
+			BVHBuildTask localRootTask = subtreeTasks[subtreeIndex];
+			localRootTask.m_nodeIndex = 0;
+			subtreeNodes[subtreeIndex].reserve(2 * localRootTask.m_numPrimitives);
+			subtreeNodes[subtreeIndex].resize(1);
+			localTasks.push_back(localRootTask);
+			BuildBVHNodes(context, subtreeNodes[subtreeIndex], localTasks, 0, nullptr);
+		}
+	});
+
+	// Local node n > 0 lands at base + n - 1, the local root replaces the node its parent allocated
+	for (int subtreeIndex = 0; subtreeIndex < numSubtrees; ++subtreeIndex)
+	{
+		std::vector<BVHNode3D>& localNodes = subtreeNodes[subtreeIndex];
+		int baseIndex = static_cast<int>(m_nodes.size());
+		for (int localIndex = 0; localIndex < static_cast<int>(localNodes.size()); ++localIndex)
+		{
+			BVHNode3D node = localNodes[localIndex];
+			if (!node.IsLeaf())
+			{
+				node.m_firstIndex += baseIndex - 1;
+			}
+
+			if (localIndex == 0)
+			{
+				m_nodes[subtreeTasks[subtreeIndex].m_nodeIndex] = node;
+			}
+			else
+			{
+				m_nodes.push_back(node);
+			}
+		}
+	}
+}
+
+void BVH3D::Refit(std::vector<AABB3> const& primitiveBounds)
+{
+	GUARANTEE_OR_DIE(primitiveBounds.size() == m_primitiveBounds.size(), Stringf("BVH3D::Refit given %d bounds for a tree of %d primitives", static_cast<int>(primitiveBounds.size()), GetNumPrimitives()));
+	m_primitiveBounds = primitiveBounds;
+
+	// Children always come after their parent, so walking backwards sees both children before the parent
+	for (int nodeIndex = static_cast<int>(m_nodes.size()) - 1; nodeIndex >= 0; --nodeIndex)
+	{
+		BVHNode3D& node = m_nodes[nodeIndex];
+		AABB3 bounds = GetEmptyBounds();
+		if (node.IsLeaf())
+		{
+			for (int index = node.m_firstIndex; index < node.m_firstIndex + node.m_numPrimitives; ++index)
+			{
+				StretchToIncludeBounds(bounds, m_primitiveBounds[m_primitiveIndices[index]]);
+			}
+		}
+		else
+		{
+			StretchToIncludeBounds(bounds, m_nodes[node.m_firstIndex].m_bounds);
+			StretchToIncludeBounds(bounds, m_nodes[node.m_firstIndex + 1].m_bounds);
+		}
+		node.m_bounds = bounds;
+	}
+}
+
+void BVH3D::Clear()
+{
+	m_nodes.clear();
+	m_primitiveIndices.clear();
+	m_primitiveBounds.clear();
+}
+// -----------------------------------------------------------------------------
+bool DoesRayEnterBounds(AABB3 const& bounds, Vec3 const& rayStart, Vec3 const& inverseFwd, float maxDist, float& out_entryDist)
+{
+	float tX1 = (bounds.m_mins.x - rayStart.x) * inverseFwd.x;
+	float tX2 = (bounds.m_maxs.x - rayStart.x) * inverseFwd.x;
+	float tY1 = (bounds.m_mins.y - rayStart.y) * inverseFwd.y;
+	float tY2 = (bounds.m_maxs.y - rayStart.y) * inverseFwd.y;
+	float tZ1 = (bounds.m_mins.z - rayStart.z) * inverseFwd.z;
+	float tZ2 = (bounds.m_maxs.z - rayStart.z) * inverseFwd.z;
+	float tMin = std::max(std::max(std::min(tX1, tX2), std::min(tY1, tY2)), std::max(std::min(tZ1, tZ2), 0.f));
+	float tMax = std::min(std::min(std::max(tX1, tX2), std::max(tY1, tY2)), std::min(std::max(tZ1, tZ2), maxDist));
+	out_entryDist = tMin;
+	return tMin <= tMax;
+}
+
+BVHRaycastResult3D BVH3D::RaycastClosest(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength, BVHPrimitiveRaycast const& raycastPrimitive) const
+{
+	return Raycast(rayStart, fwdNormal, rayLength, raycastPrimitive, false);
+}
+
+BVHRaycastResult3D BVH3D::RaycastAny(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength, BVHPrimitiveRaycast const& raycastPrimitive) const
+{
+	return Raycast(rayStart, fwdNormal, rayLength, raycastPrimitive, true);
+}
+
+// Visits the nearer child first and skips nodes entered past the nearest impact so far. Equal distance impacts
+// go to the lower primitive index, matching a brute force loop over the primitives.
+BVHRaycastResult3D BVH3D::Raycast(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength, BVHPrimitiveRaycast const& raycastPrimitive, bool stopAtFirstImpact) const
+{
+	BVHRaycastResult3D nearestResult;
+	nearestResult.m_rayStartPosition = rayStart;
+	nearestResult.m_rayFwdNormal = fwdNormal;
+	nearestResult.m_rayDirection = fwdNormal * rayLength;
+	nearestResult.m_rayLength = rayLength;
+
+	float entryDist = 0.f;
+	Vec3 inverseFwd(1.f / fwdNormal.x, 1.f / fwdNormal.y, 1.f / fwdNormal.z);
+	if (m_nodes.empty() || !DoesRayEnterBounds(m_nodes[0].m_bounds, rayStart, inverseFwd, rayLength, entryDist))
+	{
+		return nearestResult;
+	}
+
+	int nodeStack[BVH_MAX_DEPTH + 1];
+	float entryDistStack[BVH_MAX_DEPTH + 1];
+	int stackSize = 0;
+	nodeStack[stackSize] = 0;
+	entryDistStack[stackSize] = entryDist;
+	++stackSize;
+
+	float maxDist = rayLength;
+	while (stackSize > 0)
+	{
+		--stackSize;
+		BVHNode3D const& node = m_nodes[nodeStack[stackSize]];
+		if (entryDistStack[stackSize] > maxDist)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			for (int index = node.m_firstIndex; index < node.m_firstIndex + node.m_numPrimitives; ++index)
+			{
+				int primitiveIndex = m_primitiveIndices[index];
+				RaycastResult3D result = raycastPrimitive ? raycastPrimitive(primitiveIndex, rayStart, fwdNormal, rayLength)
+					: RaycastVsAABB3D(rayStart, fwdNormal, rayLength, m_primitiveBounds[primitiveIndex]);
+				if (!result.m_didImpact)
+				{
+					continue;
+				}
+
+				bool isNearer = !nearestResult.m_didImpact || result.m_impactDist < nearestResult.m_impactDist
+					|| (result.m_impactDist == nearestResult.m_impactDist && primitiveIndex < nearestResult.m_primitiveIndex);
+				if (isNearer)
+				{
+					static_cast<RaycastResult3D&>(nearestResult) = result;
+					nearestResult.m_rayStartPosition = rayStart;
+					nearestResult.m_rayFwdNormal = fwdNormal;
+					nearestResult.m_rayDirection = fwdNormal * rayLength;
+					nearestResult.m_rayLength = rayLength;
+					nearestResult.m_primitiveIndex = primitiveIndex;
+					maxDist = result.m_impactDist;
+					if (stopAtFirstImpact)
+					{
+						return nearestResult;
+					}
+				}
+			}
+			continue;
+		}
+
+		float leftEntryDist = 0.f;
+		float rightEntryDist = 0.f;
+		bool entersLeft = DoesRayEnterBounds(m_nodes[node.m_firstIndex].m_bounds, rayStart, inverseFwd, maxDist, leftEntryDist);
+		bool entersRight = DoesRayEnterBounds(m_nodes[node.m_firstIndex + 1].m_bounds, rayStart, inverseFwd, maxDist, rightEntryDist);
+		if (entersLeft && entersRight)
+		{
+			// Push the far child first so the near one is popped next
+			bool isLeftNearer = leftEntryDist <= rightEntryDist;
+			nodeStack[stackSize] = isLeftNearer ? node.m_firstIndex + 1 : node.m_firstIndex;
+			entryDistStack[stackSize] = isLeftNearer ? rightEntryDist : leftEntryDist;
+			++stackSize;
+			nodeStack[stackSize] = isLeftNearer ? node.m_firstIndex : node.m_firstIndex + 1;
+			entryDistStack[stackSize] = isLeftNearer ? leftEntryDist : rightEntryDist;
+			++stackSize;
+		}
+		else if (entersLeft || entersRight)
+		{
+			nodeStack[stackSize] = entersLeft ? node.m_firstIndex : node.m_firstIndex + 1;
+			entryDistStack[stackSize] = entersLeft ? leftEntryDist : rightEntryDist;
+			++stackSize;
+		}
+	}
+	return nearestResult;
+}
+// -----------------------------------------------------------------------------
+void BVH3D::GetPrimitivesOverlappingSphere(Vec3 const& sphereCenter, float sphereRadius, std::vector<int>& out_primitiveIndices) const
+{
+	if (m_nodes.empty())
+	{
+		return;
+	}
+
+	int nodeStack[BVH_MAX_DEPTH + 1];
+	int stackSize = 0;
+	nodeStack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		BVHNode3D const& node = m_nodes[nodeStack[--stackSize]];
+		if (!DoSpheresAndAABBOverlap3D(sphereCenter, sphereRadius, node.m_bounds))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			for (int index = node.m_firstIndex; index < node.m_firstIndex + node.m_numPrimitives; ++index)
+			{
+				int primitiveIndex = m_primitiveIndices[index];
+				if (DoSpheresAndAABBOverlap3D(sphereCenter, sphereRadius, m_primitiveBounds[primitiveIndex]))
+				{
+					out_primitiveIndices.push_back(primitiveIndex);
+				}
+			}
+			continue;
+		}
+		nodeStack[stackSize++] = node.m_firstIndex + 1;
+		nodeStack[stackSize++] = node.m_firstIndex;
+	}
+}
+
+void BVH3D::GetPrimitivesOverlappingAABB3(AABB3 const& box, std::vector<int>& out_primitiveIndices) const
+{
+	if (m_nodes.empty())
+	{
+		return;
+	}
+
+	int nodeStack[BVH_MAX_DEPTH + 1];
+	int stackSize = 0;
+	nodeStack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		BVHNode3D const& node = m_nodes[nodeStack[--stackSize]];
+		if (!node.m_bounds.Intersects(box))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			for (int index = node.m_firstIndex; index < node.m_firstIndex + node.m_numPrimitives; ++index)
+			{
+				int primitiveIndex = m_primitiveIndices[index];
+				if (m_primitiveBounds[primitiveIndex].Intersects(box))
+				{
+					out_primitiveIndices.push_back(primitiveIndex);
+				}
+			}
+			continue;
+		}
+		nodeStack[stackSize++] = node.m_firstIndex + 1;
+		nodeStack[stackSize++] = node.m_firstIndex;
+	}
+}
+// -----------------------------------------------------------------------------
+bool BVH3D::IsEmpty() const
+{
+	return m_nodes.empty();
+}
+
+int BVH3D::GetNumPrimitives() const
+{
+	return static_cast<int>(m_primitiveBounds.size());
+}
+
+std::vector<BVHNode3D> const& BVH3D::GetNodes() const
+{
+	return m_nodes;
+}
+
+std::vector<int> const& BVH3D::GetPrimitiveIndices() const
+{
+	return m_primitiveIndices;
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+#pragma once
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+#include <functional>
+#include <vector>
+// -----------------------------------------------------------------------------
+class JobSystem;
+// -----------------------------------------------------------------------------
+constexpr int BVH_MAX_LEAF_PRIMITIVES = 8;		// Leaves stop splitting once SAH finds no cheaper split below this
+constexpr int BVH_MAX_DEPTH = 48;				// Deeper nodes are forced to be leaves, keeps the traversal stacks fixed size
+constexpr int BVH_NUM_SAH_BINS = 12;
+constexpr int BVH_MIN_PRIMITIVES_PER_BUILD_JOB = 1024;
+// -----------------------------------------------------------------------------
+struct BVHNode3D
+{
+	AABB3 m_bounds;
+	int	  m_firstIndex = 0;		// Interior nodes: left child, the right child follows it. Leaves: first entry in the primitive index list
+	int	  m_numPrimitives = 0;	// 0 for interior nodes
+
+	bool IsLeaf() const { return m_numPrimitives > 0; }
+};
+// -----------------------------------------------------------------------------
+struct BVHRaycastResult3D : public RaycastResult3D
+{
+	int m_primitiveIndex = -1;
+};
+// -----------------------------------------------------------------------------
+// Raycasts one primitive, called for the primitives in the leaves the ray reaches. The BVH casts against
+// the primitive bounds themselves when none is given.
+typedef std::function<RaycastResult3D(int primitiveIndex, Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength)> BVHPrimitiveRaycast;
+// -----------------------------------------------------------------------------
+// Bounding volume hierarchy over a list of AABB3 bounds, one per primitive. Primitive indices are indices
+// into the bounds list the tree was built from.
+class BVH3D
+{
+public:
+	BVH3D() = default;
+	~BVH3D() = default;
+
+	void Build(std::vector<AABB3> const& primitiveBounds, JobSystem* jobSystem = nullptr); // Binned SAH, subtrees are built across the job system when one is given
+	void Refit(std::vector<AABB3> const& primitiveBounds); // Same primitives with new bounds, keeps the tree shape so rebuild once they have moved far
+	void Clear();
+
+	BVHRaycastResult3D RaycastClosest(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength, BVHPrimitiveRaycast const& raycastPrimitive = nullptr) const;
+	BVHRaycastResult3D RaycastAny(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength, BVHPrimitiveRaycast const& raycastPrimitive = nullptr) const; // Stops at the first impact found, for line of sight checks
+
+	// Append the primitives whose bounds overlap the query shape
+	void GetPrimitivesOverlappingSphere(Vec3 const& sphereCenter, float sphereRadius, std::vector<int>& out_primitiveIndices) const;
+	void GetPrimitivesOverlappingAABB3(AABB3 const& box, std::vector<int>& out_primitiveIndices) const;
+
+	bool							IsEmpty() const;
+	int								GetNumPrimitives() const;
+	std::vector<BVHNode3D> const&	GetNodes() const;
+	std::vector<int> const&			GetPrimitiveIndices() const; // Leaves refer to ranges of this list
+
+private:
+	BVHRaycastResult3D Raycast(Vec3 const& rayStart, Vec3 const& fwdNormal, float rayLength, BVHPrimitiveRaycast const& raycastPrimitive, bool stopAtFirstImpact) const;
+
+private:
+	std::vector<BVHNode3D>	m_nodes;				// Root first, children always come after their parent
+	std::vector<int>		m_primitiveIndices;
+	std::vector<AABB3>		m_primitiveBounds;
+};
+// -----------------------------------------------------------------------------
+bool DoesRayEnterBounds(AABB3 const& bounds, Vec3 const& rayStart, Vec3 const& inverseFwd, float maxDist, float& out_entryDist); // Slab test clipped to [0, maxDist], used by the BVH traversals
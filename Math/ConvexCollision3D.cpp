@@ -0,0 +1,958 @@
+#include "Engine/Math/ConvexCollision3D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int	GJK_MAX_ITERATIONS = 32;
+constexpr float GJK_RELATIVE_TOLERANCE = 1e-5f;		// Of the squared distance, when the next support point stops helping
+constexpr float GJK_TOUCHING_DISTANCE = 1e-5f;		// Cores this close are handed to EPA
+constexpr int	EPA_MAX_ITERATIONS = 64;
+constexpr float EPA_RELATIVE_TOLERANCE = 1e-4f;
+constexpr int	EPA_MAX_VERTICES = 4 + EPA_MAX_ITERATIONS;
+constexpr int	EPA_MAX_FACES = 2 * EPA_MAX_VERTICES;
+constexpr int	EPA_MAX_HORIZON_EDGES = 3 * EPA_MAX_FACES;
+constexpr float SAT_EDGE_AXIS_MIN_LENGTH_SQUARED = 1e-6f;	// Edge cross products of nearly parallel edges are skipped
+constexpr float SAT_RELATIVE_TOLERANCE = 0.95f;				// A later axis needs this much less overlap to replace a face axis
+constexpr float SAT_ABSOLUTE_TOLERANCE = 1e-3f;
+// -----------------------------------------------------------------------------
+ConvexShape3D const ConvexShape3D::MakeSphere(Vec3 const& sphereCenter, float sphereRadius)
+{
+	ConvexShape3D sphere;
+	sphere.m_type = ConvexShapeType3D::SPHERE;
+	sphere.m_center = sphereCenter;
+	sphere.m_radius = sphereRadius;
+	return sphere;
+}
+
+ConvexShape3D const ConvexShape3D::MakeCapsule(Vec3 const& boneStart, Vec3 const& boneEnd, float capsuleRadius)
+{
+	ConvexShape3D capsule;
+	capsule.m_type = ConvexShapeType3D::CAPSULE;
+	capsule.m_center = (boneStart + boneEnd) * 0.5f;
+	Vec3 bone = boneEnd - boneStart;
+	float boneLength = bone.GetLength();
+	capsule.m_axes[2] = boneLength > 0.f ? bone / boneLength : Vec3::ZAXE;
+	capsule.m_halfDimensions = Vec3(0.f, 0.f, boneLength * 0.5f);
+	capsule.m_radius = capsuleRadius;
+	return capsule;
+}
+
+ConvexShape3D const ConvexShape3D::MakeZCylinder(Vec3 const& cylinderStart, float cylinderRadius, float cylinderHeight)
+{
+	ConvexShape3D cylinder;
+	cylinder.m_type = ConvexShapeType3D::Z_CYLINDER;
+	cylinder.m_center = cylinderStart + Vec3(0.f, 0.f, cylinderHeight * 0.5f);
+	cylinder.m_halfDimensions = Vec3(cylinderRadius, cylinderRadius, cylinderHeight * 0.5f);
+	return cylinder;
+}
+
+ConvexShape3D const ConvexShape3D::MakeOBB3(OBB3 const& orientedBox)
+{
+	ConvexShape3D box;
+	box.m_type = ConvexShapeType3D::OBB;
+	box.m_center = orientedBox.m_center;
+	box.m_axes[0] = orientedBox.m_iBasis;
+	box.m_axes[1] = orientedBox.m_jBasis;
+	box.m_axes[2] = orientedBox.m_kBasis;
+	box.m_halfDimensions = orientedBox.m_halfDimensions;
+	return box;
+}
+
+Vec3 ConvexShape3D::GetCoreSupportPoint(Vec3 const& direction) const
+{
+	switch (m_type)
+	{
+		case ConvexShapeType3D::SPHERE:
+		{
+			return m_center;
+		}
+		case ConvexShapeType3D::CAPSULE:
+		{
+			float alongBone = DotProduct3D(direction, m_axes[2]);
+			return m_center + m_axes[2] * (alongBone >= 0.f ? m_halfDimensions.z : -m_halfDimensions.z);
+		}
+		case ConvexShapeType3D::Z_CYLINDER:
+		{
+			Vec3 support = m_center;
+			float directionLengthXY = sqrtf(direction.x * direction.x + direction.y * direction.y);
+			if (directionLengthXY > 0.f)
+			{
+				support.x += direction.x * (m_halfDimensions.x / directionLengthXY);
+				support.y += direction.y * (m_halfDimensions.x / directionLengthXY);
+			}
+			support.z += direction.z >= 0.f ? m_halfDimensions.z : -m_halfDimensions.z;
+			return support;
+		}
+		case ConvexShapeType3D::OBB:
+		{
+			Vec3 support = m_center;
+			support += m_axes[0] * (DotProduct3D(direction, m_axes[0]) >= 0.f ? m_halfDimensions.x : -m_halfDimensions.x);
+			support += m_axes[1] * (DotProduct3D(direction, m_axes[1]) >= 0.f ? m_halfDimensions.y : -m_halfDimensions.y);
+			support += m_axes[2] * (DotProduct3D(direction, m_axes[2]) >= 0.f ? m_halfDimensions.z : -m_halfDimensions.z);
+			return support;
+		}
+	}
+	return m_center;
+}
+
+Vec3 ConvexShape3D::GetSupportPoint(Vec3 const& direction) const
+{
+	Vec3 support = GetCoreSupportPoint(direction);
+	float directionLength = direction.GetLength();
+	if (m_radius > 0.f && directionLength > 0.f)
+	{
+		support += direction * (m_radius / directionLength);
+	}
+	return support;
+}
+// -----------------------------------------------------------------------------
+// A point of the Minkowski difference A - B, with the two support points that made it
+struct ConvexSupportVertex
+{
+	Vec3 m_point;
+	Vec3 m_pointOnA;
+	Vec3 m_pointOnB;
+};
+
+static ConvexSupportVertex GetMinkowskiSupport(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, Vec3 const& direction, bool includeRadii)
+{
+	ConvexSupportVertex vertex;
+	vertex.m_pointOnA = includeRadii ? shapeA.GetSupportPoint(direction) : shapeA.GetCoreSupportPoint(direction);
+	vertex.m_pointOnB = includeRadii ? shapeB.GetSupportPoint(-direction) : shapeB.GetCoreSupportPoint(-direction);
+	vertex.m_point = vertex.m_pointOnA - vertex.m_pointOnB;
+	return vertex;
+}
+// -----------------------------------------------------------------------------
+struct GJKSimplex
+{
+	ConvexSupportVertex m_vertices[4];
+	float				m_weights[4] = {};	// Barycentric weights of the point closest to the origin
+	int					m_numVertices = 0;
+};
+
+// Keeps only the listed vertices of the simplex, with their weights
+static void ReduceSimplex(GJKSimplex& simplex, int numKept, int const* keptIndices, float const* keptWeights)
+{
+	ConvexSupportVertex keptVertices[4];
+	for (int keptIndex = 0; keptIndex < numKept; ++keptIndex)
+	{
+		keptVertices[keptIndex] = simplex.m_vertices[keptIndices[keptIndex]];
+	}
+	for (int keptIndex = 0; keptIndex < numKept; ++keptIndex)
+	{
+		simplex.m_vertices[keptIndex] = keptVertices[keptIndex];
+		simplex.m_weights[keptIndex] = keptWeights[keptIndex];
+	}
+	simplex.m_numVertices = numKept;
+}
+
+struct SimplexRegion
+{
+	int	  m_numVertices = 0;
+	int	  m_indices[3] = {};
+	float m_weights[3] = {};
+	Vec3  m_closestPoint;
+};
+
+static SimplexRegion GetClosestRegionOfSegmentToOrigin(Vec3 const* points, int indexA, int indexB)
+{
+	SimplexRegion region;
+	Vec3 const& a = points[indexA];
+	Vec3 const& b = points[indexB];
+	Vec3 ab = b - a;
+	float abLengthSquared = ab.GetLengthSquared();
+	float t = abLengthSquared > 0.f ? -DotProduct3D(a, ab) / abLengthSquared : 0.f;
+	if (t <= 0.f)
+	{
+		region.m_numVertices = 1;
+		region.m_indices[0] = indexA;
+		region.m_weights[0] = 1.f;
+		region.m_closestPoint = a;
+	}
+	else if (t >= 1.f)
+	{
+		region.m_numVertices = 1;
+		region.m_indices[0] = indexB;
+		region.m_weights[0] = 1.f;
+		region.m_closestPoint = b;
+	}
+	else
+	{
+		region.m_numVertices = 2;
+		region.m_indices[0] = indexA;
+		region.m_indices[1] = indexB;
+		region.m_weights[0] = 1.f - t;
+		region.m_weights[1] = t;
+		region.m_closestPoint = a + ab * t;
+	}
+	return region;
+}
+
+// Voronoi region walk from Ericson's Real-Time Collision Detection, ClosestPtPointTriangle with the point at the origin
+static SimplexRegion GetClosestRegionOfTriangleToOrigin(Vec3 const* points, int indexA, int indexB, int indexC)
+{
+	Vec3 const& a = points[indexA];
+	Vec3 const& b = points[indexB];
+	Vec3 const& c = points[indexC];
+	Vec3 ab = b - a;
+	Vec3 ac = c - a;
+
+	SimplexRegion region;
+	float d1 = -DotProduct3D(ab, a);
+	float d2 = -DotProduct3D(ac, a);
+	if (d1 <= 0.f && d2 <= 0.f)
+	{
+		region.m_numVertices = 1;
+		region.m_indices[0] = indexA;
+		region.m_weights[0] = 1.f;
+		region.m_closestPoint = a;
+		return region;
+	}
+
+	float d3 = -DotProduct3D(ab, b);
+	float d4 = -DotProduct3D(ac, b);
+	if (d3 >= 0.f && d4 <= d3)
+	{
+		region.m_numVertices = 1;
+		region.m_indices[0] = indexB;
+		region.m_weights[0] = 1.f;
+		region.m_closestPoint = b;
+		return region;
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+	{
+		return GetClosestRegionOfSegmentToOrigin(points, indexA, indexB);
+	}
+
+	float d5 = -DotProduct3D(ab, c);
+	float d6 = -DotProduct3D(ac, c);
+	if (d6 >= 0.f && d5 <= d6)
+	{
+		region.m_numVertices = 1;
+		region.m_indices[0] = indexC;
+		region.m_weights[0] = 1.f;
+		region.m_closestPoint = c;
+		return region;
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+	{
+		return GetClosestRegionOfSegmentToOrigin(points, indexA, indexC);
+	}
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+	{
+		return GetClosestRegionOfSegmentToOrigin(points, indexB, indexC);
+	}
+
+	float areaSum = va + vb + vc;
+	if (areaSum <= FLT_MIN)
+	{
+		// Collinear points that slipped through the edge tests, the closest of the three edges will do
+		SimplexRegion edgeRegions[3] = {
+			GetClosestRegionOfSegmentToOrigin(points, indexA, indexB),
+			GetClosestRegionOfSegmentToOrigin(points, indexA, indexC),
+			GetClosestRegionOfSegmentToOrigin(points, indexB, indexC) };
+		int closestEdge = 0;
+		for (int edgeIndex = 1; edgeIndex < 3; ++edgeIndex)
+		{
+			if (edgeRegions[edgeIndex].m_closestPoint.GetLengthSquared() < edgeRegions[closestEdge].m_closestPoint.GetLengthSquared())
+			{
+				closestEdge = edgeIndex;
+			}
+		}
+		return edgeRegions[closestEdge];
+	}
+
+	float v = vb / areaSum;
+	float w = vc / areaSum;
+	region.m_numVertices = 3;
+	region.m_indices[0] = indexA;
+	region.m_indices[1] = indexB;
+	region.m_indices[2] = indexC;
+	region.m_weights[0] = 1.f - v - w;
+	region.m_weights[1] = v;
+	region.m_weights[2] = w;
+	region.m_closestPoint = a + ab * v + ac * w;
+	return region;
+}
+
+// Whether the origin is on the other side of face abc from d. Faces of a flat tetrahedron count as facing the origin
+// so that they still get searched.
+static bool IsOriginOutsideFace(Vec3 const& a, Vec3 const& b, Vec3 const& c, Vec3 const& d)
+{
+	Vec3 normal = CrossProduct3D(b - a, c - a);
+	float originSide = -DotProduct3D(a, normal);
+	float otherSide = DotProduct3D(d - a, normal);
+	if (otherSide * otherSide <= 1e-6f * normal.GetLengthSquared() * (d - a).GetLengthSquared())
+	{
+		return true;
+	}
+	return originSide * otherSide < 0.f;
+}
+
+// Moves the simplex to the smallest face holding the point closest to the origin, returns false if the origin is inside
+static bool UpdateSimplexToClosestRegion(GJKSimplex& simplex, Vec3& out_closestPoint)
+{
+	Vec3 points[4];
+	for (int vertexIndex = 0; vertexIndex < simplex.m_numVertices; ++vertexIndex)
+	{
+		points[vertexIndex] = simplex.m_vertices[vertexIndex].m_point;
+	}
+
+	SimplexRegion region;
+	if (simplex.m_numVertices == 1)
+	{
+		simplex.m_weights[0] = 1.f;
+		out_closestPoint = points[0];
+		return true;
+	}
+	else if (simplex.m_numVertices == 2)
+	{
+		region = GetClosestRegionOfSegmentToOrigin(points, 0, 1);
+	}
+	else if (simplex.m_numVertices == 3)
+	{
+		region = GetClosestRegionOfTriangleToOrigin(points, 0, 1, 2);
+	}
+	else
+	{
+		static int const s_faceIndices[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+		float closestDistanceSquared = FLT_MAX;
+		bool isOriginInside = true;
+		for (int faceIndex = 0; faceIndex < 4; ++faceIndex)
+		{
+			int const* face = s_faceIndices[faceIndex];
+			if (IsOriginOutsideFace(points[face[0]], points[face[1]], points[face[2]], points[face[3]]))
+			{
+				isOriginInside = false;
+				SimplexRegion faceRegion = GetClosestRegionOfTriangleToOrigin(points, face[0], face[1], face[2]);
+				float distanceSquared = faceRegion.m_closestPoint.GetLengthSquared();
+				if (distanceSquared < closestDistanceSquared)
+				{
+					closestDistanceSquared = distanceSquared;
+					region = faceRegion;
+				}
+			}
+		}
+		if (isOriginInside)
+		{
+			for (int vertexIndex = 0; vertexIndex < 4; ++vertexIndex)
+			{
+				simplex.m_weights[vertexIndex] = 0.25f;
+			}
+			out_closestPoint = Vec3::ZERO;
+			return false;
+		}
+	}
+
+	ReduceSimplex(simplex, region.m_numVertices, region.m_indices, region.m_weights);
+	out_closestPoint = region.m_closestPoint;
+	return true;
+}
+// -----------------------------------------------------------------------------
+struct GJKResult
+{
+	bool	   m_areCoresTouching = false;	// Overlapping or closer than GJK_TOUCHING_DISTANCE
+	bool	   m_isBeyondRadii = false;		// Only set when stopping early, the core distance is then a lower bound
+	float	   m_coreDistance = 0.f;
+	Vec3	   m_coreOffset;				// Closest point of the core difference A - B to the origin
+	Vec3	   m_closestPointOnB;
+	GJKSimplex m_simplex;
+};
+
+// Distance between the cores of two shapes. With stopBeyondRadii it returns as soon as the cores are known to be
+// further apart than the two radii, which is all an overlap test needs.
+static GJKResult RunGJK(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, bool stopBeyondRadii)
+{
+	GJKResult result;
+	GJKSimplex& simplex = result.m_simplex;
+	float radiusSum = shapeA.m_radius + shapeB.m_radius;
+
+	Vec3 initialDirection = shapeB.m_center - shapeA.m_center;
+	if (initialDirection.GetLengthSquared() <= 0.f)
+	{
+		initialDirection = Vec3::XAXE;
+	}
+	simplex.m_vertices[0] = GetMinkowskiSupport(shapeA, shapeB, -initialDirection, false);
+	simplex.m_weights[0] = 1.f;
+	simplex.m_numVertices = 1;
+	Vec3 closestPoint = simplex.m_vertices[0].m_point;
+	float touchingDistanceSquared = GJK_TOUCHING_DISTANCE * GJK_TOUCHING_DISTANCE;
+
+	for (int iteration = 0; iteration < GJK_MAX_ITERATIONS; ++iteration)
+	{
+		float closestDistanceSquared = closestPoint.GetLengthSquared();
+		if (closestDistanceSquared <= touchingDistanceSquared)
+		{
+			result.m_areCoresTouching = true;
+			return result;
+		}
+
+		ConvexSupportVertex newVertex = GetMinkowskiSupport(shapeA, shapeB, -closestPoint, false);
+		float progress = DotProduct3D(closestPoint, newVertex.m_point);
+		if (stopBeyondRadii && progress > 0.f && progress * progress > radiusSum * radiusSum * closestDistanceSquared)
+		{
+			// The plane through the new support point separates the cores by more than the radii
+			result.m_isBeyondRadii = true;
+			result.m_coreDistance = progress / sqrtf(closestDistanceSquared);
+			return result;
+		}
+		if (closestDistanceSquared - progress <= GJK_RELATIVE_TOLERANCE * closestDistanceSquared)
+		{
+			break;
+		}
+		bool isDuplicate = false;
+		for (int vertexIndex = 0; vertexIndex < simplex.m_numVertices; ++vertexIndex)
+		{
+			isDuplicate = isDuplicate || (simplex.m_vertices[vertexIndex].m_point - newVertex.m_point).GetLengthSquared() <= 1e-12f;
+		}
+		if (isDuplicate)
+		{
+			break;
+		}
+
+		GJKSimplex previousSimplex = simplex;
+		Vec3 previousClosestPoint = closestPoint;
+		simplex.m_vertices[simplex.m_numVertices] = newVertex;
+		++simplex.m_numVertices;
+		if (!UpdateSimplexToClosestRegion(simplex, closestPoint))
+		{
+			result.m_areCoresTouching = true;
+			return result;
+		}
+		if (closestPoint.GetLengthSquared() >= closestDistanceSquared)
+		{
+			// Rounding stopped the descent, the previous simplex was as close as it gets
+			simplex = previousSimplex;
+			closestPoint = previousClosestPoint;
+			break;
+		}
+	}
+
+	result.m_coreDistance = closestPoint.GetLength();
+	result.m_coreOffset = closestPoint;
+	if (result.m_coreDistance <= GJK_TOUCHING_DISTANCE)
+	{
+		result.m_areCoresTouching = true;
+		return result;
+	}
+	result.m_closestPointOnB = Vec3::ZERO;
+	for (int vertexIndex = 0; vertexIndex < simplex.m_numVertices; ++vertexIndex)
+	{
+		result.m_closestPointOnB += simplex.m_vertices[vertexIndex].m_pointOnB * simplex.m_weights[vertexIndex];
+	}
+	return result;
+}
+// -----------------------------------------------------------------------------
+struct EPAFace
+{
+	int	  m_vertexIndices[3];	// Wound so the normal faces out of the polytope
+	Vec3  m_normal;
+	float m_distance = 0.f;		// From the origin to the face's plane
+};
+
+struct EPAEdge
+{
+	int m_startIndex;
+	int m_endIndex;
+};
+
+static bool MakeEPAFace(std::vector<ConvexSupportVertex> const& vertices, int indexA, int indexB, int indexC, EPAFace& out_face)
+{
+	Vec3 const& a = vertices[indexA].m_point;
+	Vec3 normal = CrossProduct3D(vertices[indexB].m_point - a, vertices[indexC].m_point - a);
+	float normalLength = normal.GetLength();
+	if (normalLength <= 1e-12f)
+	{
+		return false;
+	}
+	out_face.m_vertexIndices[0] = indexA;
+	out_face.m_vertexIndices[1] = indexB;
+	out_face.m_vertexIndices[2] = indexC;
+	out_face.m_normal = normal / normalLength;
+	out_face.m_distance = DotProduct3D(out_face.m_normal, a);
+	return true;
+}
+
+static bool IsNewSupportVertex(std::vector<ConvexSupportVertex> const& vertices, ConvexSupportVertex const& newVertex)
+{
+	for (int vertexIndex = 0; vertexIndex < static_cast<int>(vertices.size()); ++vertexIndex)
+	{
+		if ((vertices[vertexIndex].m_point - newVertex.m_point).GetLengthSquared() <= 1e-12f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Grows whatever GJK stopped with into a tetrahedron around the origin. Returns false if the core difference is flat,
+// like the cores of two crossed capsules, leaving the vertices that show how.
+static bool BuildEPATetrahedron(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, GJKSimplex const& simplex, std::vector<ConvexSupportVertex>& out_vertices)
+{
+	out_vertices.clear();
+	for (int vertexIndex = 0; vertexIndex < simplex.m_numVertices; ++vertexIndex)
+	{
+		out_vertices.push_back(simplex.m_vertices[vertexIndex]);
+	}
+
+	static Vec3 const s_searchDirections[6] = { Vec3::XAXE, -Vec3::XAXE, Vec3::YAXE, -Vec3::YAXE, Vec3::ZAXE, -Vec3::ZAXE };
+	if (out_vertices.size() == 1)
+	{
+		for (int directionIndex = 0; directionIndex < 6 && out_vertices.size() == 1; ++directionIndex)
+		{
+			ConvexSupportVertex newVertex = GetMinkowskiSupport(shapeA, shapeB, s_searchDirections[directionIndex], false);
+			if (IsNewSupportVertex(out_vertices, newVertex))
+			{
+				out_vertices.push_back(newVertex);
+			}
+		}
+	}
+	if (out_vertices.size() == 2)
+	{
+		Vec3 line = out_vertices[1].m_point - out_vertices[0].m_point;
+		Vec3 leastAlignedAxis = fabsf(line.x) <= fabsf(line.y) ? (fabsf(line.x) <= fabsf(line.z) ? Vec3::XAXE : Vec3::ZAXE) : (fabsf(line.y) <= fabsf(line.z) ? Vec3::YAXE : Vec3::ZAXE);
+		Vec3 perpendicularI = CrossProduct3D(line, leastAlignedAxis).GetNormalized();
+		Vec3 perpendicularJ = CrossProduct3D(line, perpendicularI).GetNormalized();
+		Vec3 perpendiculars[4] = { perpendicularI, -perpendicularI, perpendicularJ, -perpendicularJ };
+		float lineLengthSquared = line.GetLengthSquared();
+		for (int directionIndex = 0; directionIndex < 4 && out_vertices.size() == 2; ++directionIndex)
+		{
+			ConvexSupportVertex newVertex = GetMinkowskiSupport(shapeA, shapeB, perpendiculars[directionIndex], false);
+			Vec3 area = CrossProduct3D(line, newVertex.m_point - out_vertices[0].m_point);
+			if (area.GetLengthSquared() > 1e-10f * lineLengthSquared * lineLengthSquared)
+			{
+				out_vertices.push_back(newVertex);
+			}
+		}
+	}
+	if (out_vertices.size() == 3)
+	{
+		Vec3 const& a = out_vertices[0].m_point;
+		Vec3 normal = CrossProduct3D(out_vertices[1].m_point - a, out_vertices[2].m_point - a);
+		float normalLength = normal.GetLength();
+		for (int sideIndex = 0; sideIndex < 2 && out_vertices.size() == 3; ++sideIndex)
+		{
+			ConvexSupportVertex newVertex = GetMinkowskiSupport(shapeA, shapeB, sideIndex == 0 ? normal : -normal, false);
+			if (fabsf(DotProduct3D(newVertex.m_point - a, normal)) > 1e-5f * normalLength * sqrtf(normalLength))
+			{
+				out_vertices.push_back(newVertex);
+			}
+		}
+	}
+	return out_vertices.size() == 4;
+}
+
+// A flat core difference has no depth across itself, so that is the way out and all the depth comes from the radii
+static Vec3 GetFlatCoreNormal(std::vector<ConvexSupportVertex> const& vertices, Vec3 const& centerOffset)
+{
+	Vec3 normal = centerOffset;
+	if (vertices.size() >= 3)
+	{
+		normal = CrossProduct3D(vertices[1].m_point - vertices[0].m_point, vertices[2].m_point - vertices[0].m_point);
+		normal = DotProduct3D(normal, centerOffset) >= 0.f ? normal : -normal;
+	}
+	else if (vertices.size() == 2)
+	{
+		Vec3 lineDirection = (vertices[1].m_point - vertices[0].m_point).GetNormalized();
+		normal = centerOffset - lineDirection * DotProduct3D(centerOffset, lineDirection);
+		if (normal.GetLengthSquared() <= 1e-12f)
+		{
+			Vec3 leastAlignedAxis = fabsf(lineDirection.x) <= fabsf(lineDirection.y) ? (fabsf(lineDirection.x) <= fabsf(lineDirection.z) ? Vec3::XAXE : Vec3::ZAXE) : (fabsf(lineDirection.y) <= fabsf(lineDirection.z) ? Vec3::YAXE : Vec3::ZAXE);
+			normal = CrossProduct3D(lineDirection, leastAlignedAxis);
+		}
+	}
+	return normal.GetLengthSquared() > 1e-12f ? normal.GetNormalized() : Vec3::ZAXE;
+}
+
+struct EPAResult
+{
+	float m_depth = 0.f;
+	Vec3  m_normal;
+	Vec3  m_pointOnA;
+	Vec3  m_pointOnB;
+};
+
+static void GetFlatCoreContact(GJKSimplex const& simplex, Vec3 const& normal, EPAResult& out_result)
+{
+	out_result.m_depth = 0.f;
+	out_result.m_normal = normal;
+	out_result.m_pointOnB = Vec3::ZERO;
+	for (int vertexIndex = 0; vertexIndex < simplex.m_numVertices; ++vertexIndex)
+	{
+		out_result.m_pointOnB += simplex.m_vertices[vertexIndex].m_pointOnB * simplex.m_weights[vertexIndex];
+	}
+	out_result.m_pointOnA = out_result.m_pointOnB;
+}
+
+// Expands a polytope inside the core difference towards the boundary face closest to the origin, which is the shortest
+// way out. Rounding a shape only moves that boundary out by its radius, so the cores are all EPA needs.
+static void RunEPA(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, GJKSimplex const& simplex, EPAResult& out_result)
+{
+	std::vector<ConvexSupportVertex> vertices;
+	vertices.reserve(EPA_MAX_VERTICES);
+	if (!BuildEPATetrahedron(shapeA, shapeB, simplex, vertices))
+	{
+		GetFlatCoreContact(simplex, GetFlatCoreNormal(vertices, shapeB.m_center - shapeA.m_center), out_result);
+		return;
+	}
+
+	// Wind the tetrahedron's faces away from the vertex opposite each
+	EPAFace faces[EPA_MAX_FACES];
+	int numFaces = 0;
+	static int const s_tetrahedronFaces[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+	for (int faceIndex = 0; faceIndex < 4; ++faceIndex)
+	{
+		int const* face = s_tetrahedronFaces[faceIndex];
+		int indexB = face[1];
+		int indexC = face[2];
+		Vec3 normal = CrossProduct3D(vertices[indexB].m_point - vertices[face[0]].m_point, vertices[indexC].m_point - vertices[face[0]].m_point);
+		if (DotProduct3D(normal, vertices[face[3]].m_point - vertices[face[0]].m_point) > 0.f)
+		{
+			std::swap(indexB, indexC);
+		}
+		if (!MakeEPAFace(vertices, face[0], indexB, indexC, faces[numFaces]))
+		{
+			GetFlatCoreContact(simplex, GetFlatCoreNormal(vertices, shapeB.m_center - shapeA.m_center), out_result);
+			return;
+		}
+		++numFaces;
+	}
+
+	// A full buffer stops the expansion early, with the closest face found so far
+	EPAEdge horizon[EPA_MAX_HORIZON_EDGES];
+	EPAFace closestFace;
+	bool canExpand = true;
+	for (int iteration = 0; iteration < EPA_MAX_ITERATIONS && canExpand; ++iteration)
+	{
+		int closestFaceIndex = 0;
+		for (int faceIndex = 1; faceIndex < numFaces; ++faceIndex)
+		{
+			if (faces[faceIndex].m_distance < faces[closestFaceIndex].m_distance)
+			{
+				closestFaceIndex = faceIndex;
+			}
+		}
+		closestFace = faces[closestFaceIndex];
+		ConvexSupportVertex newVertex = GetMinkowskiSupport(shapeA, shapeB, closestFace.m_normal, false);
+		float supportDistance = DotProduct3D(newVertex.m_point, closestFace.m_normal);
+		if (supportDistance - closestFace.m_distance <= EPA_RELATIVE_TOLERANCE * std::max(1.f, closestFace.m_distance))
+		{
+			break;
+		}
+		if (static_cast<int>(vertices.size()) >= EPA_MAX_VERTICES || !IsNewSupportVertex(vertices, newVertex))
+		{
+			break;
+		}
+
+		// Remove every face the new vertex can see, keeping the edges around the hole
+		int numHorizonEdges = 0;
+		for (int faceIndex = 0; faceIndex < numFaces; )
+		{
+			EPAFace const& face = faces[faceIndex];
+			if (DotProduct3D(face.m_normal, newVertex.m_point - vertices[face.m_vertexIndices[0]].m_point) <= 0.f)
+			{
+				++faceIndex;
+				continue;
+			}
+			for (int edgeIndex = 0; edgeIndex < 3; ++edgeIndex)
+			{
+				EPAEdge edge = { face.m_vertexIndices[edgeIndex], face.m_vertexIndices[(edgeIndex + 1) % 3] };
+				bool isShared = false;
+				for (int horizonIndex = 0; horizonIndex < numHorizonEdges; ++horizonIndex)
+				{
+					if (horizon[horizonIndex].m_startIndex == edge.m_endIndex && horizon[horizonIndex].m_endIndex == edge.m_startIndex)
+					{
+						horizon[horizonIndex] = horizon[numHorizonEdges - 1];
+						--numHorizonEdges;
+						isShared = true;
+						break;
+					}
+				}
+				if (!isShared && numHorizonEdges < EPA_MAX_HORIZON_EDGES)
+				{
+					horizon[numHorizonEdges] = edge;
+					++numHorizonEdges;
+				}
+			}
+			faces[faceIndex] = faces[numFaces - 1];
+			--numFaces;
+		}
+
+		int newVertexIndex = static_cast<int>(vertices.size());
+		vertices.push_back(newVertex);
+		// A new vertex in line with a horizon edge makes a face with no area, which the faces either side already close
+		for (int horizonIndex = 0; horizonIndex < numHorizonEdges && canExpand; ++horizonIndex)
+		{
+			canExpand = numFaces < EPA_MAX_FACES;
+			numFaces += canExpand && MakeEPAFace(vertices, horizon[horizonIndex].m_startIndex, horizon[horizonIndex].m_endIndex, newVertexIndex, faces[numFaces]) ? 1 : 0;
+		}
+	}
+
+	// Barycentric coordinates of the origin's projection onto the closest face carry over to the support points
+	ConvexSupportVertex const& a = vertices[closestFace.m_vertexIndices[0]];
+	ConvexSupportVertex const& b = vertices[closestFace.m_vertexIndices[1]];
+	ConvexSupportVertex const& c = vertices[closestFace.m_vertexIndices[2]];
+	Vec3 projection = closestFace.m_normal * closestFace.m_distance;
+	Vec3 ab = b.m_point - a.m_point;
+	Vec3 ac = c.m_point - a.m_point;
+	Vec3 ap = projection - a.m_point;
+	float abab = DotProduct3D(ab, ab);
+	float abac = DotProduct3D(ab, ac);
+	float acac = DotProduct3D(ac, ac);
+	float apab = DotProduct3D(ap, ab);
+	float apac = DotProduct3D(ap, ac);
+	float denominator = abab * acac - abac * abac;
+	float v = denominator > 0.f ? (acac * apab - abac * apac) / denominator : 0.f;
+	float w = denominator > 0.f ? (abab * apac - abac * apab) / denominator : 0.f;
+	float u = 1.f - v - w;
+
+	out_result.m_depth = closestFace.m_distance;
+	out_result.m_normal = closestFace.m_normal;
+	out_result.m_pointOnB = a.m_pointOnB * u + b.m_pointOnB * v + c.m_pointOnB * w;
+	out_result.m_pointOnA = out_result.m_pointOnB + closestFace.m_normal * closestFace.m_distance;
+}
+// -----------------------------------------------------------------------------
+bool DoConvexShapesOverlap3D(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB)
+{
+	if (shapeA.m_type == ConvexShapeType3D::OBB && shapeB.m_type == ConvexShapeType3D::OBB)
+	{
+		ConvexContact3D contact;
+		OBB3 boxA(shapeA.m_center, shapeA.m_axes[0], shapeA.m_axes[1], shapeA.m_axes[2], shapeA.m_halfDimensions);
+		OBB3 boxB(shapeB.m_center, shapeB.m_axes[0], shapeB.m_axes[1], shapeB.m_axes[2], shapeB.m_halfDimensions);
+		return GetOBB3sContact3D(boxA, boxB, contact);
+	}
+
+	GJKResult gjk = RunGJK(shapeA, shapeB, true);
+	if (gjk.m_areCoresTouching)
+	{
+		return true;
+	}
+	return !gjk.m_isBeyondRadii && gjk.m_coreDistance < shapeA.m_radius + shapeB.m_radius;
+}
+
+bool GetConvexShapesContact3D(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, ConvexContact3D& out_contact)
+{
+	if (shapeA.m_type == ConvexShapeType3D::OBB && shapeB.m_type == ConvexShapeType3D::OBB)
+	{
+		OBB3 boxA(shapeA.m_center, shapeA.m_axes[0], shapeA.m_axes[1], shapeA.m_axes[2], shapeA.m_halfDimensions);
+		OBB3 boxB(shapeB.m_center, shapeB.m_axes[0], shapeB.m_axes[1], shapeB.m_axes[2], shapeB.m_halfDimensions);
+		if (GetOBB3sContact3D(boxA, boxB, out_contact))
+		{
+			return true;
+		}
+		// SAT only bounds the gap, GJK finds the closest points
+	}
+	return GetConvexShapesContactGJK3D(shapeA, shapeB, out_contact);
+}
+
+bool GetConvexShapesContactGJK3D(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, ConvexContact3D& out_contact)
+{
+	GJKResult gjk = RunGJK(shapeA, shapeB, false);
+	if (!gjk.m_areCoresTouching)
+	{
+		// The rounding sits on the closest core points, so the contact follows from them directly
+		Vec3 normal = -gjk.m_coreOffset / gjk.m_coreDistance;
+		out_contact.m_penetrationDepth = shapeA.m_radius + shapeB.m_radius - gjk.m_coreDistance;
+		out_contact.m_isOverlapping = out_contact.m_penetrationDepth > 0.f;
+		out_contact.m_normal = normal;
+		out_contact.m_pointOnB = gjk.m_closestPointOnB - normal * shapeB.m_radius;
+		out_contact.m_pointOnA = out_contact.m_pointOnB + normal * out_contact.m_penetrationDepth;
+		return out_contact.m_isOverlapping;
+	}
+
+	EPAResult epa;
+	RunEPA(shapeA, shapeB, gjk.m_simplex, epa);
+	out_contact.m_isOverlapping = true;
+	out_contact.m_penetrationDepth = epa.m_depth + shapeA.m_radius + shapeB.m_radius;
+	out_contact.m_normal = epa.m_normal;
+	out_contact.m_pointOnA = epa.m_pointOnA + epa.m_normal * shapeA.m_radius;
+	out_contact.m_pointOnB = epa.m_pointOnB - epa.m_normal * shapeB.m_radius;
+	return true;
+}
+// -----------------------------------------------------------------------------
+static Vec3 GetOBB3SupportPoint(OBB3 const& box, Vec3 const& direction)
+{
+	Vec3 support = box.m_center;
+	support += box.m_iBasis * (DotProduct3D(direction, box.m_iBasis) >= 0.f ? box.m_halfDimensions.x : -box.m_halfDimensions.x);
+	support += box.m_jBasis * (DotProduct3D(direction, box.m_jBasis) >= 0.f ? box.m_halfDimensions.y : -box.m_halfDimensions.y);
+	support += box.m_kBasis * (DotProduct3D(direction, box.m_kBasis) >= 0.f ? box.m_halfDimensions.z : -box.m_halfDimensions.z);
+	return support;
+}
+
+// The box edge along axisIndex that is furthest along direction
+static void GetOBB3SupportEdge(OBB3 const& box, Vec3 const& direction, int axisIndex, Vec3& out_edgeStart, Vec3& out_edgeEnd)
+{
+	Vec3 const axes[3] = { box.m_iBasis, box.m_jBasis, box.m_kBasis };
+	float const halfDimensions[3] = { box.m_halfDimensions.x, box.m_halfDimensions.y, box.m_halfDimensions.z };
+	Vec3 edgeCenter = box.m_center;
+	for (int otherAxis = 0; otherAxis < 3; ++otherAxis)
+	{
+		if (otherAxis != axisIndex)
+		{
+			edgeCenter += axes[otherAxis] * (DotProduct3D(direction, axes[otherAxis]) >= 0.f ? halfDimensions[otherAxis] : -halfDimensions[otherAxis]);
+		}
+	}
+	out_edgeStart = edgeCenter - axes[axisIndex] * halfDimensions[axisIndex];
+	out_edgeEnd = edgeCenter + axes[axisIndex] * halfDimensions[axisIndex];
+}
+
+static void GetClosestPointsOnSegments3D(Vec3 const& startA, Vec3 const& endA, Vec3 const& startB, Vec3 const& endB, Vec3& out_pointOnA, Vec3& out_pointOnB)
+{
+	Vec3 directionA = endA - startA;
+	Vec3 directionB = endB - startB;
+	Vec3 startOffset = startA - startB;
+	float lengthSquaredA = directionA.GetLengthSquared();
+	float lengthSquaredB = directionB.GetLengthSquared();
+	float alongB = DotProduct3D(directionB, startOffset);
+	float alongA = DotProduct3D(directionA, startOffset);
+	float directionsDot = DotProduct3D(directionA, directionB);
+	float denominator = lengthSquaredA * lengthSquaredB - directionsDot * directionsDot;
+	float s = denominator > 0.f ? GetClamped((directionsDot * alongB - alongA * lengthSquaredB) / denominator, 0.f, 1.f) : 0.f;
+	float t = lengthSquaredB > 0.f ? (directionsDot * s + alongB) / lengthSquaredB : 0.f;
+	if (t < 0.f || t > 1.f)
+	{
+		t = GetClamped(t, 0.f, 1.f);
+		s = lengthSquaredA > 0.f ? GetClamped((directionsDot * t - alongA) / lengthSquaredA, 0.f, 1.f) : 0.f;
+	}
+	out_pointOnA = startA + directionA * s;
+	out_pointOnB = startB + directionB * t;
+}
+
+bool GetOBB3sContact3D(OBB3 const& boxA, OBB3 const& boxB, ConvexContact3D& out_contact)
+{
+	Vec3 const axesA[3] = { boxA.m_iBasis, boxA.m_jBasis, boxA.m_kBasis };
+	Vec3 const axesB[3] = { boxB.m_iBasis, boxB.m_jBasis, boxB.m_kBasis };
+	float const halfDimensionsA[3] = { boxA.m_halfDimensions.x, boxA.m_halfDimensions.y, boxA.m_halfDimensions.z };
+	float const halfDimensionsB[3] = { boxB.m_halfDimensions.x, boxB.m_halfDimensions.y, boxB.m_halfDimensions.z };
+	Vec3 centerOffset = boxB.m_center - boxA.m_center;
+
+	// Rotation of B into A's frame, so face axes of either box project with a few multiplies
+	float rotation[3][3];
+	float absRotation[3][3];
+	for (int axisA = 0; axisA < 3; ++axisA)
+	{
+		for (int axisB = 0; axisB < 3; ++axisB)
+		{
+			rotation[axisA][axisB] = DotProduct3D(axesA[axisA], axesB[axisB]);
+			absRotation[axisA][axisB] = fabsf(rotation[axisA][axisB]);
+		}
+	}
+	float offsetInA[3] = { DotProduct3D(centerOffset, axesA[0]), DotProduct3D(centerOffset, axesA[1]), DotProduct3D(centerOffset, axesA[2]) };
+
+	// Axes 0-2 are A's faces, 3-5 B's and 6-14 the edge pairs, with the edge of A in (axisIndex - 6) / 3 and of B in
+	// (axisIndex - 6) % 3. Everything is measured in A's frame, the way Gottschalk's OBBTree test does it.
+	int bestAxis = -1;
+	float bestOverlap = FLT_MAX;
+	float bestSign = 1.f;
+	float widestGap = -FLT_MAX;
+	for (int axisIndex = 0; axisIndex < 15; ++axisIndex)
+	{
+		float radiusA = 0.f;
+		float radiusB = 0.f;
+		float centerDistance = 0.f;
+		if (axisIndex < 3)
+		{
+			radiusA = halfDimensionsA[axisIndex];
+			radiusB = halfDimensionsB[0] * absRotation[axisIndex][0] + halfDimensionsB[1] * absRotation[axisIndex][1] + halfDimensionsB[2] * absRotation[axisIndex][2];
+			centerDistance = offsetInA[axisIndex];
+		}
+		else if (axisIndex < 6)
+		{
+			int axisB = axisIndex - 3;
+			radiusA = halfDimensionsA[0] * absRotation[0][axisB] + halfDimensionsA[1] * absRotation[1][axisB] + halfDimensionsA[2] * absRotation[2][axisB];
+			radiusB = halfDimensionsB[axisB];
+			centerDistance = offsetInA[0] * rotation[0][axisB] + offsetInA[1] * rotation[1][axisB] + offsetInA[2] * rotation[2][axisB];
+		}
+		else
+		{
+			int axisA = (axisIndex - 6) / 3;
+			int axisB = (axisIndex - 6) % 3;
+			float axisLengthSquared = 1.f - rotation[axisA][axisB] * rotation[axisA][axisB];
+			if (axisLengthSquared < SAT_EDGE_AXIS_MIN_LENGTH_SQUARED)
+			{
+				continue;
+			}
+			int nextA = (axisA + 1) % 3;
+			int lastA = (axisA + 2) % 3;
+			int nextB = (axisB + 1) % 3;
+			int lastB = (axisB + 2) % 3;
+			float inverseAxisLength = 1.f / sqrtf(axisLengthSquared);
+			radiusA = (halfDimensionsA[nextA] * absRotation[lastA][axisB] + halfDimensionsA[lastA] * absRotation[nextA][axisB]) * inverseAxisLength;
+			radiusB = (halfDimensionsB[nextB] * absRotation[axisA][lastB] + halfDimensionsB[lastB] * absRotation[axisA][nextB]) * inverseAxisLength;
+			centerDistance = (offsetInA[lastA] * rotation[nextA][axisB] - offsetInA[nextA] * rotation[lastA][axisB]) * inverseAxisLength;
+		}
+
+		float overlap = radiusA + radiusB - fabsf(centerDistance);
+		if (overlap <= 0.f)
+		{
+			widestGap = std::max(widestGap, -overlap);
+			continue;
+		}
+		// Later axes have to beat earlier ones by a margin, so resting boxes keep a stable face contact
+		bool isBetter = bestAxis < 0 || (axisIndex < 3 ? overlap < bestOverlap : overlap < SAT_RELATIVE_TOLERANCE * bestOverlap - SAT_ABSOLUTE_TOLERANCE);
+		if (isBetter)
+		{
+			bestAxis = axisIndex;
+			bestOverlap = overlap;
+			bestSign = centerDistance >= 0.f ? 1.f : -1.f;
+		}
+	}
+
+	if (widestGap > -FLT_MAX)
+	{
+		out_contact.m_isOverlapping = false;
+		out_contact.m_penetrationDepth = -widestGap;
+		out_contact.m_normal = centerOffset.GetLengthSquared() > 0.f ? centerOffset.GetNormalized() : Vec3::ZAXE;
+		out_contact.m_pointOnA = boxA.m_center;
+		out_contact.m_pointOnB = boxB.m_center;
+		return false;
+	}
+
+	Vec3 bestNormal;
+	if (bestAxis < 3)
+	{
+		bestNormal = axesA[bestAxis] * bestSign;
+	}
+	else if (bestAxis < 6)
+	{
+		bestNormal = axesB[bestAxis - 3] * bestSign;
+	}
+	else
+	{
+		bestNormal = CrossProduct3D(axesA[(bestAxis - 6) / 3], axesB[(bestAxis - 6) % 3]).GetNormalized() * bestSign;
+	}
+	out_contact.m_isOverlapping = true;
+	out_contact.m_penetrationDepth = bestOverlap;
+	out_contact.m_normal = bestNormal;
+	if (bestAxis < 3)
+	{
+		// B's deepest corner is inside A's face
+		out_contact.m_pointOnB = GetOBB3SupportPoint(boxB, -bestNormal);
+		out_contact.m_pointOnA = out_contact.m_pointOnB + bestNormal * bestOverlap;
+	}
+	else if (bestAxis < 6)
+	{
+		out_contact.m_pointOnA = GetOBB3SupportPoint(boxA, bestNormal);
+		out_contact.m_pointOnB = out_contact.m_pointOnA - bestNormal * bestOverlap;
+	}
+	else
+	{
+		Vec3 edgeStartA, edgeEndA, edgeStartB, edgeEndB;
+		GetOBB3SupportEdge(boxA, bestNormal, (bestAxis - 6) / 3, edgeStartA, edgeEndA);
+		GetOBB3SupportEdge(boxB, -bestNormal, (bestAxis - 6) % 3, edgeStartB, edgeEndB);
+		Vec3 pointOnEdgeA, pointOnEdgeB;
+		GetClosestPointsOnSegments3D(edgeStartA, edgeEndA, edgeStartB, edgeEndB, pointOnEdgeA, pointOnEdgeB);
+		Vec3 midpoint = (pointOnEdgeA + pointOnEdgeB) * 0.5f;
+		out_contact.m_pointOnA = midpoint + bestNormal * (bestOverlap * 0.5f);
+		out_contact.m_pointOnB = midpoint - bestNormal * (bestOverlap * 0.5f);
+	}
+	return true;
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,55 @@
+#pragma once
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/OBB3.hpp"
+// -----------------------------------------------------------------------------
+enum class ConvexShapeType3D
+{
+	SPHERE,
+	CAPSULE,
+	Z_CYLINDER,
+	OBB,
+};
+// -----------------------------------------------------------------------------
+// Every convex shape is the same flat record, so arrays of mixed shapes stay uniform and contact code needs only
+// GetSupportPoint. Shapes are a core (point, segment, z-cylinder or box) grown by m_radius, which lets GJK work on
+// the cores and add the rounding exactly afterwards.
+struct ConvexShape3D
+{
+public:
+	ConvexShapeType3D m_type = ConvexShapeType3D::SPHERE;
+	Vec3			  m_center = Vec3::ZERO;
+	Vec3			  m_axes[3] = { Vec3::XAXE, Vec3::YAXE, Vec3::ZAXE }; // Box bases, a capsule's bone direction is m_axes[2]
+	Vec3			  m_halfDimensions = Vec3::ZERO;	// Box half sizes, x is a z-cylinder's radius and z the half height of capsules and z-cylinders
+	float			  m_radius = 0.f;					// Rounding of spheres and capsules
+
+public:
+	static ConvexShape3D const MakeSphere(Vec3 const& sphereCenter, float sphereRadius);
+	static ConvexShape3D const MakeCapsule(Vec3 const& boneStart, Vec3 const& boneEnd, float capsuleRadius);
+	static ConvexShape3D const MakeZCylinder(Vec3 const& cylinderStart, float cylinderRadius, float cylinderHeight); // Same parameters as DoZCylindersOverlap3D
+	static ConvexShape3D const MakeOBB3(OBB3 const& orientedBox);
+
+	Vec3 GetCoreSupportPoint(Vec3 const& direction) const; // Furthest core point along direction, which need not be normalized
+	Vec3 GetSupportPoint(Vec3 const& direction) const;
+};
+// -----------------------------------------------------------------------------
+// m_normal points from A to B: moving B by m_normal * m_penetrationDepth separates the shapes. The points are where
+// each surface is deepest inside the other, so m_pointOnA - m_pointOnB == m_normal * m_penetrationDepth. Separated
+// shapes get the closest points, the gap as a negative depth and the normal from A's closest point to B's.
+struct ConvexContact3D
+{
+	bool  m_isOverlapping = false;
+	float m_penetrationDepth = 0.f;
+	Vec3  m_normal = Vec3::ZAXE;
+	Vec3  m_pointOnA = Vec3::ZERO;
+	Vec3  m_pointOnB = Vec3::ZERO;
+};
+// -----------------------------------------------------------------------------
+bool DoConvexShapesOverlap3D(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB);
+
+// Boxes take the SAT path below, every other pair GJK for the separated or shallow case and EPA for deep overlaps
+bool GetConvexShapesContact3D(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, ConvexContact3D& out_contact);
+bool GetConvexShapesContactGJK3D(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, ConvexContact3D& out_contact); // Skips the box fast path
+
+// Separating axis test over the 15 box axes. Separated boxes only get the widest gap along a separating axis, which
+// may be less than the true distance, and no points.
+bool GetOBB3sContact3D(OBB3 const& boxA, OBB3 const& boxB, ConvexContact3D& out_contact);
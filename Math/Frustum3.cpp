@@ -0,0 +1,228 @@
+#include "Engine/Math/Frustum3.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/SIMDMath.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include <functional>
+// -----------------------------------------------------------------------------
+// Plane of the points where a row combination of the clip transform is >= 0, normalized so distances are in world units
+static Plane3 const MakeFrustumPlane(float a, float b, float c, float d)
+{
+	float inverseLength = 1.f / sqrtf((a * a) + (b * b) + (c * c));
+	return Plane3(Vec3(a * inverseLength, b * inverseLength, c * inverseLength), -d * inverseLength);
+}
+
+// Gribb and Hartmann: with clip = M * world, x >= -w is (row3 + row0) . world >= 0 and so on for the other sides
+Frustum3 const Frustum3::MakeFromWorldToClipTransform(Mat44 const& worldToClip)
+{
+	float const* m = worldToClip.m_values;
+	float const rows[4][4] =
+	{
+		{ m[Mat44::Ix], m[Mat44::Jx], m[Mat44::Kx], m[Mat44::Tx] },
+		{ m[Mat44::Iy], m[Mat44::Jy], m[Mat44::Ky], m[Mat44::Ty] },
+		{ m[Mat44::Iz], m[Mat44::Jz], m[Mat44::Kz], m[Mat44::Tz] },
+		{ m[Mat44::Iw], m[Mat44::Jw], m[Mat44::Kw], m[Mat44::Tw] },
+	};
+
+	Frustum3 frustum;
+	frustum.m_planes[PLANE_LEFT]   = MakeFrustumPlane(rows[3][0] + rows[0][0], rows[3][1] + rows[0][1], rows[3][2] + rows[0][2], rows[3][3] + rows[0][3]);
+	frustum.m_planes[PLANE_RIGHT]  = MakeFrustumPlane(rows[3][0] - rows[0][0], rows[3][1] - rows[0][1], rows[3][2] - rows[0][2], rows[3][3] - rows[0][3]);
+	frustum.m_planes[PLANE_BOTTOM] = MakeFrustumPlane(rows[3][0] + rows[1][0], rows[3][1] + rows[1][1], rows[3][2] + rows[1][2], rows[3][3] + rows[1][3]);
+	frustum.m_planes[PLANE_TOP]	   = MakeFrustumPlane(rows[3][0] - rows[1][0], rows[3][1] - rows[1][1], rows[3][2] - rows[1][2], rows[3][3] - rows[1][3]);
+	frustum.m_planes[PLANE_NEAR]   = MakeFrustumPlane(rows[2][0], rows[2][1], rows[2][2], rows[2][3]);
+	frustum.m_planes[PLANE_FAR]	   = MakeFrustumPlane(rows[3][0] - rows[2][0], rows[3][1] - rows[2][1], rows[3][2] - rows[2][2], rows[3][3] - rows[2][3]);
+	return frustum;
+}
+// -----------------------------------------------------------------------------
+bool Frustum3::IsPointInside(Vec3 const& point) const
+{
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; ++planeIndex)
+	{
+		if (!m_planes[planeIndex].IsPointInFront(point))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum3::DoesOverlapSphere(Vec3 const& sphereCenter, float sphereRadius) const
+{
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; ++planeIndex)
+	{
+		Plane3 const& plane = m_planes[planeIndex];
+		float dist = (plane.m_normal.x * sphereCenter.x + plane.m_normal.y * sphereCenter.y + plane.m_normal.z * sphereCenter.z) - plane.m_distance;
+		if (dist < -sphereRadius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Only the box corner furthest along each plane's normal needs testing
+bool Frustum3::DoesOverlapAABB3(AABB3 const& box) const
+{
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; ++planeIndex)
+	{
+		Plane3 const& plane = m_planes[planeIndex];
+		float cornerX = plane.m_normal.x >= 0.f ? box.m_maxs.x : box.m_mins.x;
+		float cornerY = plane.m_normal.y >= 0.f ? box.m_maxs.y : box.m_mins.y;
+		float cornerZ = plane.m_normal.z >= 0.f ? box.m_maxs.z : box.m_mins.z;
+		if (plane.m_normal.x * cornerX + plane.m_normal.y * cornerY + plane.m_normal.z * cornerZ < plane.m_distance)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+FrustumOverlap Frustum3::GetOverlapWithAABB3(AABB3 const& box) const
+{
+	FrustumOverlap overlap = FrustumOverlap::INSIDE;
+	for (int planeIndex = 0; planeIndex < NUM_PLANES; ++planeIndex)
+	{
+		Plane3 const& plane = m_planes[planeIndex];
+		Vec3 furthestCorner(plane.m_normal.x >= 0.f ? box.m_maxs.x : box.m_mins.x, plane.m_normal.y >= 0.f ? box.m_maxs.y : box.m_mins.y, plane.m_normal.z >= 0.f ? box.m_maxs.z : box.m_mins.z);
+		Vec3 nearestCorner(plane.m_normal.x >= 0.f ? box.m_mins.x : box.m_maxs.x, plane.m_normal.y >= 0.f ? box.m_mins.y : box.m_maxs.y, plane.m_normal.z >= 0.f ? box.m_mins.z : box.m_maxs.z);
+		if (DotProduct3D(plane.m_normal, furthestCorner) < plane.m_distance)
+		{
+			return FrustumOverlap::OUTSIDE;
+		}
+		if (DotProduct3D(plane.m_normal, nearestCorner) < plane.m_distance)
+		{
+			overlap = FrustumOverlap::INTERSECTING;
+		}
+	}
+	return overlap;
+}
+// -----------------------------------------------------------------------------
+static void RunFrustumCullRange(int numItems, JobSystem* jobSystem, std::function<void(int, int)> const& rangeFunction)
+{
+	if (jobSystem != nullptr)
+	{
+		jobSystem->ExecuteParallelFor(numItems, FRUSTUM_CULL_MIN_ITEMS_PER_JOB, rangeFunction);
+	}
+	else
+	{
+		rangeFunction(0, numItems);
+	}
+}
+
+#if !defined( ENGINE_SIMD_SCALAR )
+// Boxes go one per lane. Each plane picks its furthest corner from the signs of its normal, so the lanes only
+// need the mins or maxs on each axis, never a per lane select.
+static void CullAABB3Lanes(Frustum3 const& frustum, AABB3 const* boxes, int numBoxes, unsigned char* out_isVisible)
+{
+	float laneCoords[6][SIMD_WIDE_NUM_LANES];
+	for (int laneIndex = 0; laneIndex < SIMD_WIDE_NUM_LANES; ++laneIndex)
+	{
+		AABB3 const& box = boxes[laneIndex < numBoxes ? laneIndex : numBoxes - 1];
+		laneCoords[0][laneIndex] = box.m_mins.x;
+		laneCoords[1][laneIndex] = box.m_mins.y;
+		laneCoords[2][laneIndex] = box.m_mins.z;
+		laneCoords[3][laneIndex] = box.m_maxs.x;
+		laneCoords[4][laneIndex] = box.m_maxs.y;
+		laneCoords[5][laneIndex] = box.m_maxs.z;
+	}
+	SIMDFloatWide mins[3] = { SIMDLoadWide(laneCoords[0]), SIMDLoadWide(laneCoords[1]), SIMDLoadWide(laneCoords[2]) };
+	SIMDFloatWide maxs[3] = { SIMDLoadWide(laneCoords[3]), SIMDLoadWide(laneCoords[4]), SIMDLoadWide(laneCoords[5]) };
+
+	int outsideBits = 0;
+	for (int planeIndex = 0; planeIndex < Frustum3::NUM_PLANES; ++planeIndex)
+	{
+		Plane3 const& plane = frustum.m_planes[planeIndex];
+		SIMDFloatWide cornerX = plane.m_normal.x >= 0.f ? maxs[0] : mins[0];
+		SIMDFloatWide cornerY = plane.m_normal.y >= 0.f ? maxs[1] : mins[1];
+		SIMDFloatWide cornerZ = plane.m_normal.z >= 0.f ? maxs[2] : mins[2];
+		SIMDFloatWide dist = SIMDAdd(SIMDAdd(SIMDMultiply(SIMDSplatWide(plane.m_normal.x), cornerX), SIMDMultiply(SIMDSplatWide(plane.m_normal.y), cornerY)),
+			SIMDMultiply(SIMDSplatWide(plane.m_normal.z), cornerZ));
+		outsideBits |= SIMDGetMaskBits(SIMDLess(dist, SIMDSplatWide(plane.m_distance)));
+	}
+
+	for (int laneIndex = 0; laneIndex < numBoxes && laneIndex < SIMD_WIDE_NUM_LANES; ++laneIndex)
+	{
+		out_isVisible[laneIndex] = (outsideBits & (1 << laneIndex)) ? 0 : 1;
+	}
+}
+
+static void CullSphere3Lanes(Frustum3 const& frustum, Sphere3 const* spheres, int numSpheres, unsigned char* out_isVisible)
+{
+	float laneValues[4][SIMD_WIDE_NUM_LANES];
+	for (int laneIndex = 0; laneIndex < SIMD_WIDE_NUM_LANES; ++laneIndex)
+	{
+		Sphere3 const& sphere = spheres[laneIndex < numSpheres ? laneIndex : numSpheres - 1];
+		laneValues[0][laneIndex] = sphere.m_center.x;
+		laneValues[1][laneIndex] = sphere.m_center.y;
+		laneValues[2][laneIndex] = sphere.m_center.z;
+		laneValues[3][laneIndex] = -sphere.m_radius;
+	}
+	SIMDFloatWide centerX = SIMDLoadWide(laneValues[0]);
+	SIMDFloatWide centerY = SIMDLoadWide(laneValues[1]);
+	SIMDFloatWide centerZ = SIMDLoadWide(laneValues[2]);
+	SIMDFloatWide negativeRadius = SIMDLoadWide(laneValues[3]);
+
+	int outsideBits = 0;
+	for (int planeIndex = 0; planeIndex < Frustum3::NUM_PLANES; ++planeIndex)
+	{
+		Plane3 const& plane = frustum.m_planes[planeIndex];
+		SIMDFloatWide dot = SIMDAdd(SIMDAdd(SIMDMultiply(SIMDSplatWide(plane.m_normal.x), centerX), SIMDMultiply(SIMDSplatWide(plane.m_normal.y), centerY)),
+			SIMDMultiply(SIMDSplatWide(plane.m_normal.z), centerZ));
+		SIMDFloatWide dist = SIMDSubtract(dot, SIMDSplatWide(plane.m_distance));
+		outsideBits |= SIMDGetMaskBits(SIMDLess(dist, negativeRadius));
+	}
+
+	for (int laneIndex = 0; laneIndex < numSpheres && laneIndex < SIMD_WIDE_NUM_LANES; ++laneIndex)
+	{
+		out_isVisible[laneIndex] = (outsideBits & (1 << laneIndex)) ? 0 : 1;
+	}
+}
+#endif
+// -----------------------------------------------------------------------------
+void CullAABB3sAgainstFrustum(Frustum3 const& frustum, int numBoxes, AABB3 const* boxes, unsigned char* out_isVisible, JobSystem* jobSystem)
+{
+#if defined( ENGINE_SIMD_SCALAR )
+	RunFrustumCullRange(numBoxes, jobSystem, [&](int startIndex, int endIndex)
+	{
+		for (int boxIndex = startIndex; boxIndex < endIndex; ++boxIndex)
+		{
+			out_isVisible[boxIndex] = frustum.DoesOverlapAABB3(boxes[boxIndex]) ? 1 : 0;
+		}
+	});
+#else
+	int numGroups = (numBoxes + SIMD_WIDE_NUM_LANES - 1) / SIMD_WIDE_NUM_LANES;
+	RunFrustumCullRange(numGroups, jobSystem, [&](int startGroup, int endGroup)
+	{
+		for (int groupIndex = startGroup; groupIndex < endGroup; ++groupIndex)
+		{
+			int firstBox = groupIndex * SIMD_WIDE_NUM_LANES;
+			CullAABB3Lanes(frustum, boxes + firstBox, numBoxes - firstBox, out_isVisible + firstBox);
+		}
+	});
+#endif
+}
+
+void CullSphere3sAgainstFrustum(Frustum3 const& frustum, int numSpheres, Sphere3 const* spheres, unsigned char* out_isVisible, JobSystem* jobSystem)
+{
+#if defined( ENGINE_SIMD_SCALAR )
+	RunFrustumCullRange(numSpheres, jobSystem, [&](int startIndex, int endIndex)
+	{
+		for (int sphereIndex = startIndex; sphereIndex < endIndex; ++sphereIndex)
+		{
+			out_isVisible[sphereIndex] = frustum.DoesOverlapSphere(spheres[sphereIndex].m_center, spheres[sphereIndex].m_radius) ? 1 : 0;
+		}
+	});
+#else
+	int numGroups = (numSpheres + SIMD_WIDE_NUM_LANES - 1) / SIMD_WIDE_NUM_LANES;
+	RunFrustumCullRange(numGroups, jobSystem, [&](int startGroup, int endGroup)
+	{
+		for (int groupIndex = startGroup; groupIndex < endGroup; ++groupIndex)
+		{
+			int firstSphere = groupIndex * SIMD_WIDE_NUM_LANES;
+			CullSphere3Lanes(frustum, spheres + firstSphere, numSpheres - firstSphere, out_isVisible + firstSphere);
+		}
+	});
+#endif
+}
+// -----------------------------------------------------------------------------
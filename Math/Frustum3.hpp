@@ -0,0 +1,41 @@
+#pragma once
+#include "Engine/Math/Plane3.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Sphere3.hpp"
+// -----------------------------------------------------------------------------
+class Mat44;
+class JobSystem;
+// -----------------------------------------------------------------------------
+constexpr int FRUSTUM_CULL_MIN_ITEMS_PER_JOB = 16384;
+// -----------------------------------------------------------------------------
+enum class FrustumOverlap
+{
+	OUTSIDE,
+	INTERSECTING,
+	INSIDE,
+};
+// -----------------------------------------------------------------------------
+// Six planes with normals pointing into the volume, a point is inside when it is in front of (or on) all of them
+struct Frustum3
+{
+public:
+	enum { PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, NUM_PLANES };
+	Plane3 m_planes[NUM_PLANES];
+
+public:
+	Frustum3() = default;
+	~Frustum3() = default;
+	Frustum3(Frustum3 const& copyFrom) = default;
+
+	static Frustum3 const MakeFromWorldToClipTransform(Mat44 const& worldToClip); // D3D clip space, 0 <= z <= w
+
+	bool		   IsPointInside(Vec3 const& point) const;
+	bool		   DoesOverlapSphere(Vec3 const& sphereCenter, float sphereRadius) const;
+	bool		   DoesOverlapAABB3(AABB3 const& box) const; // Conservative, boxes near a frustum corner can pass while just outside
+	FrustumOverlap GetOverlapWithAABB3(AABB3 const& box) const;
+};
+// -----------------------------------------------------------------------------
+// Batch culling, writes 1 to out_isVisible for every item DoesOverlapAABB3 / DoesOverlapSphere would pass and 0 for
+// the rest. Items are tested SIMD_WIDE_NUM_LANES at a time and spread across the job system when one is given.
+void CullAABB3sAgainstFrustum(Frustum3 const& frustum, int numBoxes, AABB3 const* boxes, unsigned char* out_isVisible, JobSystem* jobSystem = nullptr);
+void CullSphere3sAgainstFrustum(Frustum3 const& frustum, int numSpheres, Sphere3 const* spheres, unsigned char* out_isVisible, JobSystem* jobSystem = nullptr);
@@ -0,0 +1,294 @@
+#include "Engine/Math/LooseOctree3D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Core/EngineCommon.h"
+#include <algorithm>
+#include <cmath>
+// -----------------------------------------------------------------------------
+static bool DoesBoxContainBox(AABB3 const& outerBox, AABB3 const& innerBox)
+{
+	return outerBox.m_mins.x <= innerBox.m_mins.x && outerBox.m_maxs.x >= innerBox.m_maxs.x
+		&& outerBox.m_mins.y <= innerBox.m_mins.y && outerBox.m_maxs.y >= innerBox.m_maxs.y
+		&& outerBox.m_mins.z <= innerBox.m_mins.z && outerBox.m_maxs.z >= innerBox.m_maxs.z;
+}
+
+static bool DoesSphereContainBox(Vec3 const& sphereCenter, float sphereRadius, AABB3 const& box)
+{
+	float furthestX = std::max(fabsf(sphereCenter.x - box.m_mins.x), fabsf(sphereCenter.x - box.m_maxs.x));
+	float furthestY = std::max(fabsf(sphereCenter.y - box.m_mins.y), fabsf(sphereCenter.y - box.m_maxs.y));
+	float furthestZ = std::max(fabsf(sphereCenter.z - box.m_mins.z), fabsf(sphereCenter.z - box.m_maxs.z));
+	return (furthestX * furthestX) + (furthestY * furthestY) + (furthestZ * furthestZ) < sphereRadius * sphereRadius;
+}
+
+static LooseOctreeNode3D const MakeNode(Vec3 const& cellCenter, Vec3 const& cellHalfDimensions, int parentIndex, int depth)
+{
+	LooseOctreeNode3D node;
+	node.m_cellCenter = cellCenter;
+	node.m_cellHalfDimensions = cellHalfDimensions;
+	node.m_looseBounds = AABB3(cellCenter - cellHalfDimensions * 2.f, cellCenter + cellHalfDimensions * 2.f);
+	node.m_parentIndex = parentIndex;
+	node.m_depth = depth;
+	return node;
+}
+// -----------------------------------------------------------------------------
+LooseOctree3D::LooseOctree3D(AABB3 const& worldBounds, int maxDepth)
+	:m_worldBounds(worldBounds),
+	 m_maxDepth(maxDepth)
+{
+	GUARANTEE_OR_DIE(maxDepth >= 0 && maxDepth <= LOOSE_OCTREE_DEPTH_LIMIT, Stringf("LooseOctree3D max depth must be 0 to %d, got %d", LOOSE_OCTREE_DEPTH_LIMIT, maxDepth));
+	Clear();
+}
+
+int LooseOctree3D::Insert(AABB3 const& bounds)
+{
+	int handle = 0;
+	if (!m_freeHandles.empty())
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_itemBounds[handle] = bounds;
+	}
+	else
+	{
+		handle = static_cast<int>(m_itemBounds.size());
+		m_itemBounds.push_back(bounds);
+		m_itemNodes.push_back(-1);
+		m_itemNext.push_back(-1);
+		m_itemPrev.push_back(-1);
+	}
+	LinkItem(handle, FindOrCreateNodeForBounds(bounds));
+	++m_numItems;
+	return handle;
+}
+
+void LooseOctree3D::Move(int handle, AABB3 const& newBounds)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("LooseOctree3D::Move given invalid handle %d", handle));
+	m_itemBounds[handle] = newBounds;
+	int nodeIndex = FindOrCreateNodeForBounds(newBounds);
+	if (nodeIndex != m_itemNodes[handle])
+	{
+		UnlinkItem(handle);
+		LinkItem(handle, nodeIndex);
+	}
+}
+
+void LooseOctree3D::Remove(int handle)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("LooseOctree3D::Remove given invalid handle %d", handle));
+	UnlinkItem(handle);
+	m_freeHandles.push_back(handle);
+	--m_numItems;
+}
+
+void LooseOctree3D::Clear()
+{
+	m_nodes.clear();
+	m_nodes.push_back(MakeNode(m_worldBounds.GetCenter(), m_worldBounds.GetDimensions() * 0.5f, -1, 0));
+	m_itemBounds.clear();
+	m_itemNodes.clear();
+	m_itemNext.clear();
+	m_itemPrev.clear();
+	m_freeHandles.clear();
+	m_numItems = 0;
+}
+// -----------------------------------------------------------------------------
+void LooseOctree3D::GetItemsInFrustum(Frustum3 const& frustum, std::vector<int>& out_handles) const
+{
+	GatherItems([&](AABB3 const& looseBounds) { return frustum.GetOverlapWithAABB3(looseBounds); },
+		[&](AABB3 const& itemBounds) { return frustum.DoesOverlapAABB3(itemBounds); }, out_handles);
+}
+
+void LooseOctree3D::GetItemsOverlappingAABB3(AABB3 const& box, std::vector<int>& out_handles) const
+{
+	GatherItems([&](AABB3 const& looseBounds)
+	{
+		if (!DoAABB3sOverlap(box, looseBounds))
+		{
+			return FrustumOverlap::OUTSIDE;
+		}
+		return DoesBoxContainBox(box, looseBounds) ? FrustumOverlap::INSIDE : FrustumOverlap::INTERSECTING;
+	}, [&](AABB3 const& itemBounds) { return DoAABB3sOverlap(box, itemBounds); }, out_handles);
+}
+
+void LooseOctree3D::GetItemsOverlappingSphere(Vec3 const& sphereCenter, float sphereRadius, std::vector<int>& out_handles) const
+{
+	GatherItems([&](AABB3 const& looseBounds)
+	{
+		if (!DoSpheresAndAABBOverlap3D(sphereCenter, sphereRadius, looseBounds))
+		{
+			return FrustumOverlap::OUTSIDE;
+		}
+		return DoesSphereContainBox(sphereCenter, sphereRadius, looseBounds) ? FrustumOverlap::INSIDE : FrustumOverlap::INTERSECTING;
+	}, [&](AABB3 const& itemBounds) { return DoSpheresAndAABBOverlap3D(sphereCenter, sphereRadius, itemBounds); }, out_handles);
+}
+
+// The root holds the items outside the world bounds, so it is never culled by its own bounds and its items are always tested
+template <typename ClassifyNodeFunction, typename TestItemFunction>
+void LooseOctree3D::GatherItems(ClassifyNodeFunction const& classifyNode, TestItemFunction const& testItem, std::vector<int>& out_handles) const
+{
+	int nodeStack[8 * (LOOSE_OCTREE_DEPTH_LIMIT + 1)];
+	int stackSize = 0;
+	nodeStack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		int nodeIndex = nodeStack[--stackSize];
+		LooseOctreeNode3D const& node = m_nodes[nodeIndex];
+		if (node.m_numItemsInSubtree == 0)
+		{
+			continue;
+		}
+
+		if (nodeIndex != 0)
+		{
+			FrustumOverlap overlap = classifyNode(node.m_looseBounds);
+			if (overlap == FrustumOverlap::OUTSIDE)
+			{
+				continue;
+			}
+			if (overlap == FrustumOverlap::INSIDE)
+			{
+				AddAllItemsInSubtree(nodeIndex, out_handles);
+				continue;
+			}
+		}
+
+		for (int handle = node.m_firstItem; handle >= 0; handle = m_itemNext[handle])
+		{
+			if (testItem(m_itemBounds[handle]))
+			{
+				out_handles.push_back(handle);
+			}
+		}
+		for (int childSlot = 0; childSlot < 8; ++childSlot)
+		{
+			if (node.m_children[childSlot] >= 0)
+			{
+				nodeStack[stackSize++] = node.m_children[childSlot];
+			}
+		}
+	}
+}
+
+void LooseOctree3D::AddAllItemsInSubtree(int nodeIndex, std::vector<int>& out_handles) const
+{
+	int nodeStack[8 * (LOOSE_OCTREE_DEPTH_LIMIT + 1)];
+	int stackSize = 0;
+	nodeStack[stackSize++] = nodeIndex;
+	while (stackSize > 0)
+	{
+		LooseOctreeNode3D const& node = m_nodes[nodeStack[--stackSize]];
+		if (node.m_numItemsInSubtree == 0)
+		{
+			continue;
+		}
+		for (int handle = node.m_firstItem; handle >= 0; handle = m_itemNext[handle])
+		{
+			out_handles.push_back(handle);
+		}
+		for (int childSlot = 0; childSlot < 8; ++childSlot)
+		{
+			if (node.m_children[childSlot] >= 0)
+			{
+				nodeStack[stackSize++] = node.m_children[childSlot];
+			}
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+AABB3 const& LooseOctree3D::GetItemBounds(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("LooseOctree3D::GetItemBounds given invalid handle %d", handle));
+	return m_itemBounds[handle];
+}
+
+bool LooseOctree3D::IsValidHandle(int handle) const
+{
+	return handle >= 0 && handle < static_cast<int>(m_itemNodes.size()) && m_itemNodes[handle] >= 0;
+}
+
+int LooseOctree3D::GetNumItems() const
+{
+	return m_numItems;
+}
+
+std::vector<LooseOctreeNode3D> const& LooseOctree3D::GetNodes() const
+{
+	return m_nodes;
+}
+// -----------------------------------------------------------------------------
+// Descend while the item is no bigger than the child cell its center falls in, it then fits inside that child's loose bounds
+int LooseOctree3D::FindOrCreateNodeForBounds(AABB3 const& bounds)
+{
+	Vec3 itemCenter = bounds.GetCenter();
+	Vec3 itemHalfDimensions = bounds.GetDimensions() * 0.5f;
+	if (!DoesBoxContainBox(m_worldBounds, AABB3(itemCenter, itemCenter)))
+	{
+		return 0;
+	}
+
+	int nodeIndex = 0;
+	while (m_nodes[nodeIndex].m_depth < m_maxDepth)
+	{
+		Vec3 cellCenter = m_nodes[nodeIndex].m_cellCenter;
+		Vec3 childHalfDimensions = m_nodes[nodeIndex].m_cellHalfDimensions * 0.5f;
+		if (itemHalfDimensions.x > childHalfDimensions.x || itemHalfDimensions.y > childHalfDimensions.y || itemHalfDimensions.z > childHalfDimensions.z)
+		{
+			break;
+		}
+
+		int childSlot = (itemCenter.x >= cellCenter.x ? 1 : 0) | (itemCenter.y >= cellCenter.y ? 2 : 0) | (itemCenter.z >= cellCenter.z ? 4 : 0);
+		int childIndex = m_nodes[nodeIndex].m_children[childSlot];
+		if (childIndex < 0)
+		{
+			Vec3 childCenter(cellCenter.x + ((childSlot & 1) ? childHalfDimensions.x : -childHalfDimensions.x),
+				cellCenter.y + ((childSlot & 2) ? childHalfDimensions.y : -childHalfDimensions.y),
+				cellCenter.z + ((childSlot & 4) ? childHalfDimensions.z : -childHalfDimensions.z));
+			childIndex = static_cast<int>(m_nodes.size());
+			m_nodes.push_back(MakeNode(childCenter, childHalfDimensions, nodeIndex, m_nodes[nodeIndex].m_depth + 1));
+			m_nodes[nodeIndex].m_children[childSlot] = childIndex;
+		}
+		nodeIndex = childIndex;
+	}
+	return nodeIndex;
+}
+
+void LooseOctree3D::LinkItem(int handle, int nodeIndex)
+{
+	LooseOctreeNode3D& node = m_nodes[nodeIndex];
+	m_itemNodes[handle] = nodeIndex;
+	m_itemPrev[handle] = -1;
+	m_itemNext[handle] = node.m_firstItem;
+	if (node.m_firstItem >= 0)
+	{
+		m_itemPrev[node.m_firstItem] = handle;
+	}
+	node.m_firstItem = handle;
+
+	for (int ancestorIndex = nodeIndex; ancestorIndex >= 0; ancestorIndex = m_nodes[ancestorIndex].m_parentIndex)
+	{
+		++m_nodes[ancestorIndex].m_numItemsInSubtree;
+	}
+}
+
+void LooseOctree3D::UnlinkItem(int handle)
+{
+	int nodeIndex = m_itemNodes[handle];
+	if (m_itemPrev[handle] >= 0)
+	{
+		m_itemNext[m_itemPrev[handle]] = m_itemNext[handle];
+	}
+	else
+	{
+		m_nodes[nodeIndex].m_firstItem = m_itemNext[handle];
+	}
+	if (m_itemNext[handle] >= 0)
+	{
+		m_itemPrev[m_itemNext[handle]] = m_itemPrev[handle];
+	}
+	m_itemNodes[handle] = -1;
+
+	for (int ancestorIndex = nodeIndex; ancestorIndex >= 0; ancestorIndex = m_nodes[ancestorIndex].m_parentIndex)
+	{
+		--m_nodes[ancestorIndex].m_numItemsInSubtree;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Frustum3.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int LOOSE_OCTREE_DEPTH_LIMIT = 32;
+// -----------------------------------------------------------------------------
+struct LooseOctreeNode3D
+{
+	AABB3 m_looseBounds;				// Twice the size of the node's cell, any item centered in the cell and no bigger than it fits
+	Vec3  m_cellCenter;
+	Vec3  m_cellHalfDimensions;
+	int	  m_children[8] = { -1, -1, -1, -1, -1, -1, -1, -1 }; // Created on first use, bit 0 is +x, bit 1 is +y and bit 2 is +z
+	int	  m_parentIndex = -1;
+	int	  m_depth = 0;
+	int	  m_firstItem = -1;
+	int	  m_numItemsInSubtree = 0;		// Lets queries skip empty branches
+};
+// -----------------------------------------------------------------------------
+// Loose octree for culling and region queries over moving boxes. Each item lives in exactly one node, picked from its
+// size and center alone, so Move is cheap and nodes never split or merge. Items outside worldBounds stay at the root
+// and are still found by every query.
+//
+// Queries append the handles of the items whose bounds pass Frustum3::DoesOverlapAABB3, DoAABB3sOverlap or
+// DoSpheresAndAABBOverlap3D. Nodes whose loose bounds are fully inside the query volume report their whole subtree
+// without testing it, which gives the same answer since every item is inside its node's loose bounds.
+class LooseOctree3D
+{
+public:
+	explicit LooseOctree3D(AABB3 const& worldBounds, int maxDepth = 8); // maxDepth up to LOOSE_OCTREE_DEPTH_LIMIT
+	~LooseOctree3D() = default;
+
+	int	 Insert(AABB3 const& bounds); // Returns the item's handle, handles of removed items are reused
+	void Move(int handle, AABB3 const& newBounds);
+	void Remove(int handle);
+	void Clear();
+
+	void GetItemsInFrustum(Frustum3 const& frustum, std::vector<int>& out_handles) const;
+	void GetItemsOverlappingAABB3(AABB3 const& box, std::vector<int>& out_handles) const;
+	void GetItemsOverlappingSphere(Vec3 const& sphereCenter, float sphereRadius, std::vector<int>& out_handles) const;
+
+	AABB3 const&						  GetItemBounds(int handle) const;
+	bool								  IsValidHandle(int handle) const;
+	int									  GetNumItems() const;
+	std::vector<LooseOctreeNode3D> const& GetNodes() const;
+
+private:
+	int	 FindOrCreateNodeForBounds(AABB3 const& bounds);
+	void LinkItem(int handle, int nodeIndex);
+	void UnlinkItem(int handle);
+	void AddAllItemsInSubtree(int nodeIndex, std::vector<int>& out_handles) const;
+	template <typename ClassifyNodeFunction, typename TestItemFunction>
+	void GatherItems(ClassifyNodeFunction const& classifyNode, TestItemFunction const& testItem, std::vector<int>& out_handles) const;
+
+private:
+	AABB3							m_worldBounds;
+	int								m_maxDepth = 8;
+	std::vector<LooseOctreeNode3D>	m_nodes;
+	std::vector<AABB3>				m_itemBounds;		// By handle
+	std::vector<int>				m_itemNodes;		// -1 for removed handles
+	std::vector<int>				m_itemNext;
+	std::vector<int>				m_itemPrev;
+	std::vector<int>				m_freeHandles;
+	int								m_numItems = 0;
+};
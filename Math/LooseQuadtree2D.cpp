@@ -0,0 +1,292 @@
+#include "Engine/Math/LooseQuadtree2D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Core/EngineCommon.h"
+#include <algorithm>
+#include <cmath>
+// -----------------------------------------------------------------------------
+enum class QuadtreeNodeOverlap
+{
+	OUTSIDE,
+	INTERSECTING,
+	INSIDE,
+};
+// -----------------------------------------------------------------------------
+static bool DoesBoxContainBox(AABB2 const& outerBox, AABB2 const& innerBox)
+{
+	return outerBox.m_mins.x <= innerBox.m_mins.x && outerBox.m_maxs.x >= innerBox.m_maxs.x
+		&& outerBox.m_mins.y <= innerBox.m_mins.y && outerBox.m_maxs.y >= innerBox.m_maxs.y;
+}
+
+static bool DoesDiscContainBox(Vec2 const& discCenter, float discRadius, AABB2 const& box)
+{
+	float furthestX = std::max(fabsf(discCenter.x - box.m_mins.x), fabsf(discCenter.x - box.m_maxs.x));
+	float furthestY = std::max(fabsf(discCenter.y - box.m_mins.y), fabsf(discCenter.y - box.m_maxs.y));
+	return (furthestX * furthestX) + (furthestY * furthestY) < discRadius * discRadius;
+}
+
+static LooseQuadtreeNode2D const MakeNode(Vec2 const& cellCenter, Vec2 const& cellHalfDimensions, int parentIndex, int depth)
+{
+	LooseQuadtreeNode2D node;
+	node.m_cellCenter = cellCenter;
+	node.m_cellHalfDimensions = cellHalfDimensions;
+	node.m_looseBounds = AABB2(cellCenter - cellHalfDimensions * 2.f, cellCenter + cellHalfDimensions * 2.f);
+	node.m_parentIndex = parentIndex;
+	node.m_depth = depth;
+	return node;
+}
+// -----------------------------------------------------------------------------
+LooseQuadtree2D::LooseQuadtree2D(AABB2 const& worldBounds, int maxDepth)
+	:m_worldBounds(worldBounds),
+	 m_maxDepth(maxDepth)
+{
+	GUARANTEE_OR_DIE(maxDepth >= 0 && maxDepth <= LOOSE_QUADTREE_DEPTH_LIMIT, Stringf("LooseQuadtree2D max depth must be 0 to %d, got %d", LOOSE_QUADTREE_DEPTH_LIMIT, maxDepth));
+	Clear();
+}
+
+int LooseQuadtree2D::Insert(AABB2 const& bounds)
+{
+	int handle = 0;
+	if (!m_freeHandles.empty())
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_itemBounds[handle] = bounds;
+	}
+	else
+	{
+		handle = static_cast<int>(m_itemBounds.size());
+		m_itemBounds.push_back(bounds);
+		m_itemNodes.push_back(-1);
+		m_itemNext.push_back(-1);
+		m_itemPrev.push_back(-1);
+	}
+	LinkItem(handle, FindOrCreateNodeForBounds(bounds));
+	++m_numItems;
+	return handle;
+}
+
+void LooseQuadtree2D::Move(int handle, AABB2 const& newBounds)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("LooseQuadtree2D::Move given invalid handle %d", handle));
+	m_itemBounds[handle] = newBounds;
+	int nodeIndex = FindOrCreateNodeForBounds(newBounds);
+	if (nodeIndex != m_itemNodes[handle])
+	{
+		UnlinkItem(handle);
+		LinkItem(handle, nodeIndex);
+	}
+}
+
+void LooseQuadtree2D::Remove(int handle)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("LooseQuadtree2D::Remove given invalid handle %d", handle));
+	UnlinkItem(handle);
+	m_freeHandles.push_back(handle);
+	--m_numItems;
+}
+
+void LooseQuadtree2D::Clear()
+{
+	m_nodes.clear();
+	m_nodes.push_back(MakeNode(m_worldBounds.GetCenter(), m_worldBounds.GetDimensions() * 0.5f, -1, 0));
+	m_itemBounds.clear();
+	m_itemNodes.clear();
+	m_itemNext.clear();
+	m_itemPrev.clear();
+	m_freeHandles.clear();
+	m_numItems = 0;
+}
+// -----------------------------------------------------------------------------
+void LooseQuadtree2D::GetItemsOverlappingAABB2(AABB2 const& box, std::vector<int>& out_handles) const
+{
+	GatherItems([&](AABB2 const& looseBounds)
+	{
+		if (!DoAABB2sOverlap(box, looseBounds))
+		{
+			return QuadtreeNodeOverlap::OUTSIDE;
+		}
+		return DoesBoxContainBox(box, looseBounds) ? QuadtreeNodeOverlap::INSIDE : QuadtreeNodeOverlap::INTERSECTING;
+	}, [&](AABB2 const& itemBounds) { return DoAABB2sOverlap(box, itemBounds); }, out_handles);
+}
+
+void LooseQuadtree2D::GetItemsOverlappingDisc(Vec2 const& discCenter, float discRadius, std::vector<int>& out_handles) const
+{
+	GatherItems([&](AABB2 const& looseBounds)
+	{
+		if (!DoDiscsOverlapAABB2D(discCenter, discRadius, looseBounds))
+		{
+			return QuadtreeNodeOverlap::OUTSIDE;
+		}
+		return DoesDiscContainBox(discCenter, discRadius, looseBounds) ? QuadtreeNodeOverlap::INSIDE : QuadtreeNodeOverlap::INTERSECTING;
+	}, [&](AABB2 const& itemBounds) { return DoDiscsOverlapAABB2D(discCenter, discRadius, itemBounds); }, out_handles);
+}
+
+// The root holds the items outside the world bounds, so it is never culled by its own bounds and its items are always tested
+template <typename ClassifyNodeFunction, typename TestItemFunction>
+void LooseQuadtree2D::GatherItems(ClassifyNodeFunction const& classifyNode, TestItemFunction const& testItem, std::vector<int>& out_handles) const
+{
+	int nodeStack[4 * (LOOSE_QUADTREE_DEPTH_LIMIT + 1)];
+	int stackSize = 0;
+	nodeStack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		int nodeIndex = nodeStack[--stackSize];
+		LooseQuadtreeNode2D const& node = m_nodes[nodeIndex];
+		if (node.m_numItemsInSubtree == 0)
+		{
+			continue;
+		}
+
+		if (nodeIndex != 0)
+		{
+			QuadtreeNodeOverlap overlap = classifyNode(node.m_looseBounds);
+			if (overlap == QuadtreeNodeOverlap::OUTSIDE)
+			{
+				continue;
+			}
+			if (overlap == QuadtreeNodeOverlap::INSIDE)
+			{
+				AddAllItemsInSubtree(nodeIndex, out_handles);
+				continue;
+			}
+		}
+
+		for (int handle = node.m_firstItem; handle >= 0; handle = m_itemNext[handle])
+		{
+			if (testItem(m_itemBounds[handle]))
+			{
+				out_handles.push_back(handle);
+			}
+		}
+		for (int childSlot = 0; childSlot < 4; ++childSlot)
+		{
+			if (node.m_children[childSlot] >= 0)
+			{
+				nodeStack[stackSize++] = node.m_children[childSlot];
+			}
+		}
+	}
+}
+
+void LooseQuadtree2D::AddAllItemsInSubtree(int nodeIndex, std::vector<int>& out_handles) const
+{
+	int nodeStack[4 * (LOOSE_QUADTREE_DEPTH_LIMIT + 1)];
+	int stackSize = 0;
+	nodeStack[stackSize++] = nodeIndex;
+	while (stackSize > 0)
+	{
+		LooseQuadtreeNode2D const& node = m_nodes[nodeStack[--stackSize]];
+		if (node.m_numItemsInSubtree == 0)
+		{
+			continue;
+		}
+		for (int handle = node.m_firstItem; handle >= 0; handle = m_itemNext[handle])
+		{
+			out_handles.push_back(handle);
+		}
+		for (int childSlot = 0; childSlot < 4; ++childSlot)
+		{
+			if (node.m_children[childSlot] >= 0)
+			{
+				nodeStack[stackSize++] = node.m_children[childSlot];
+			}
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+AABB2 const& LooseQuadtree2D::GetItemBounds(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("LooseQuadtree2D::GetItemBounds given invalid handle %d", handle));
+	return m_itemBounds[handle];
+}
+
+bool LooseQuadtree2D::IsValidHandle(int handle) const
+{
+	return handle >= 0 && handle < static_cast<int>(m_itemNodes.size()) && m_itemNodes[handle] >= 0;
+}
+
+int LooseQuadtree2D::GetNumItems() const
+{
+	return m_numItems;
+}
+
+std::vector<LooseQuadtreeNode2D> const& LooseQuadtree2D::GetNodes() const
+{
+	return m_nodes;
+}
+// -----------------------------------------------------------------------------
+// Descend while the item is no bigger than the child cell its center falls in, it then fits inside that child's loose bounds
+int LooseQuadtree2D::FindOrCreateNodeForBounds(AABB2 const& bounds)
+{
+	Vec2 itemCenter = bounds.GetCenter();
+	Vec2 itemHalfDimensions = bounds.GetDimensions() * 0.5f;
+	if (!DoesBoxContainBox(m_worldBounds, AABB2(itemCenter, itemCenter)))
+	{
+		return 0;
+	}
+
+	int nodeIndex = 0;
+	while (m_nodes[nodeIndex].m_depth < m_maxDepth)
+	{
+		Vec2 cellCenter = m_nodes[nodeIndex].m_cellCenter;
+		Vec2 childHalfDimensions = m_nodes[nodeIndex].m_cellHalfDimensions * 0.5f;
+		if (itemHalfDimensions.x > childHalfDimensions.x || itemHalfDimensions.y > childHalfDimensions.y)
+		{
+			break;
+		}
+
+		int childSlot = (itemCenter.x >= cellCenter.x ? 1 : 0) | (itemCenter.y >= cellCenter.y ? 2 : 0);
+		int childIndex = m_nodes[nodeIndex].m_children[childSlot];
+		if (childIndex < 0)
+		{
+			Vec2 childCenter(cellCenter.x + ((childSlot & 1) ? childHalfDimensions.x : -childHalfDimensions.x),
+				cellCenter.y + ((childSlot & 2) ? childHalfDimensions.y : -childHalfDimensions.y));
+			childIndex = static_cast<int>(m_nodes.size());
+			m_nodes.push_back(MakeNode(childCenter, childHalfDimensions, nodeIndex, m_nodes[nodeIndex].m_depth + 1));
+			m_nodes[nodeIndex].m_children[childSlot] = childIndex;
+		}
+		nodeIndex = childIndex;
+	}
+	return nodeIndex;
+}
+
+void LooseQuadtree2D::LinkItem(int handle, int nodeIndex)
+{
+	LooseQuadtreeNode2D& node = m_nodes[nodeIndex];
+	m_itemNodes[handle] = nodeIndex;
+	m_itemPrev[handle] = -1;
+	m_itemNext[handle] = node.m_firstItem;
+	if (node.m_firstItem >= 0)
+	{
+		m_itemPrev[node.m_firstItem] = handle;
+	}
+	node.m_firstItem = handle;
+
+	for (int ancestorIndex = nodeIndex; ancestorIndex >= 0; ancestorIndex = m_nodes[ancestorIndex].m_parentIndex)
+	{
+		++m_nodes[ancestorIndex].m_numItemsInSubtree;
+	}
+}
+
+void LooseQuadtree2D::UnlinkItem(int handle)
+{
+	int nodeIndex = m_itemNodes[handle];
+	if (m_itemPrev[handle] >= 0)
+	{
+		m_itemNext[m_itemPrev[handle]] = m_itemNext[handle];
+	}
+	else
+	{
+		m_nodes[nodeIndex].m_firstItem = m_itemNext[handle];
+	}
+	if (m_itemNext[handle] >= 0)
+	{
+		m_itemPrev[m_itemNext[handle]] = m_itemPrev[handle];
+	}
+	m_itemNodes[handle] = -1;
+
+	for (int ancestorIndex = nodeIndex; ancestorIndex >= 0; ancestorIndex = m_nodes[ancestorIndex].m_parentIndex)
+	{
+		--m_nodes[ancestorIndex].m_numItemsInSubtree;
+	}
+}
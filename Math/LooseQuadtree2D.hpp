@@ -0,0 +1,63 @@
+#pragma once
+#include "Engine/Math/AABB2.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int LOOSE_QUADTREE_DEPTH_LIMIT = 32;
+// -----------------------------------------------------------------------------
+struct LooseQuadtreeNode2D
+{
+	AABB2 m_looseBounds;				// Twice the size of the node's cell, any item centered in the cell and no bigger than it fits
+	Vec2  m_cellCenter;
+	Vec2  m_cellHalfDimensions;
+	int	  m_children[4] = { -1, -1, -1, -1 };	// Created on first use, bit 0 is +x and bit 1 is +y
+	int	  m_parentIndex = -1;
+	int	  m_depth = 0;
+	int	  m_firstItem = -1;
+	int	  m_numItemsInSubtree = 0;		// Lets queries skip empty branches
+};
+// -----------------------------------------------------------------------------
+// Loose quadtree, the 2D twin of LooseOctree3D. Each item lives in exactly one node, picked from its size and center
+// alone, so Move is cheap and nodes never split or merge. Items outside worldBounds stay at the root and are still
+// found by every query.
+//
+// Queries append the handles of the items whose bounds pass DoAABB2sOverlap or DoDiscsOverlapAABB2D, so culling for a
+// 2D camera is GetItemsOverlappingAABB2(camera.GetOrthoBounds()). Nodes whose loose bounds are fully inside the query
+// report their whole subtree without testing it, which gives the same answer since items are inside their node's loose bounds.
+class LooseQuadtree2D
+{
+public:
+	explicit LooseQuadtree2D(AABB2 const& worldBounds, int maxDepth = 8); // maxDepth up to LOOSE_QUADTREE_DEPTH_LIMIT
+	~LooseQuadtree2D() = default;
+
+	int	 Insert(AABB2 const& bounds); // Returns the item's handle, handles of removed items are reused
+	void Move(int handle, AABB2 const& newBounds);
+	void Remove(int handle);
+	void Clear();
+
+	void GetItemsOverlappingAABB2(AABB2 const& box, std::vector<int>& out_handles) const;
+	void GetItemsOverlappingDisc(Vec2 const& discCenter, float discRadius, std::vector<int>& out_handles) const;
+
+	AABB2 const&							GetItemBounds(int handle) const;
+	bool									IsValidHandle(int handle) const;
+	int										GetNumItems() const;
+	std::vector<LooseQuadtreeNode2D> const& GetNodes() const;
+
+private:
+	int	 FindOrCreateNodeForBounds(AABB2 const& bounds);
+	void LinkItem(int handle, int nodeIndex);
+	void UnlinkItem(int handle);
+	void AddAllItemsInSubtree(int nodeIndex, std::vector<int>& out_handles) const;
+	template <typename ClassifyNodeFunction, typename TestItemFunction>
+	void GatherItems(ClassifyNodeFunction const& classifyNode, TestItemFunction const& testItem, std::vector<int>& out_handles) const;
+
+private:
+	AABB2								m_worldBounds;
+	int									m_maxDepth = 8;
+	std::vector<LooseQuadtreeNode2D>	m_nodes;
+	std::vector<AABB2>					m_itemBounds;		// By handle
+	std::vector<int>					m_itemNodes;		// -1 for removed handles
+	std::vector<int>					m_itemNext;
+	std::vector<int>					m_itemPrev;
+	std::vector<int>					m_freeHandles;
+	int									m_numItems = 0;
+};
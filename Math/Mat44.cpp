@@ -1,5 +1,6 @@
 #include "Engine/Math/Mat44.hpp"
 #include "Engine/Math/MathUtils.h"
+#include "Engine/Math/SIMDMath.hpp"
 #include "Engine/Core/EngineCommon.h"
 
 Mat44::Mat44()
@@ -293,11 +294,21 @@ Vec3 const Mat44::TransformPosition3D(Vec3 const& position3D) const
 Vec4 const Mat44::TransformHomogeneous3D(Vec4 const& homogenousPoint3D) const
 {
 	Vec4 const& p = homogenousPoint3D;
+#if defined( ENGINE_SIMD_SCALAR )
 	float x = (m_values[Ix] * p.x) + (m_values[Jx] * p.y) + (m_values[Kx] * p.z) + (m_values[Tx] * p.w);
 	float y = (m_values[Iy] * p.x) + (m_values[Jy] * p.y) + (m_values[Ky] * p.z) + (m_values[Ty] * p.w);
 	float z = (m_values[Iz] * p.x) + (m_values[Jz] * p.y) + (m_values[Kz] * p.z) + (m_values[Tz] * p.w);
 	float w = (m_values[Iw] * p.x) + (m_values[Jw] * p.y) + (m_values[Kw] * p.z) + (m_values[Tw] * p.w);
 	return Vec4(x, y, z, w);
+#else
+	SIMDFloat4 sum = SIMDMultiply(SIMDLoad(&m_values[Ix]), SIMDSplat(p.x));
+	sum = SIMDAdd(sum, SIMDMultiply(SIMDLoad(&m_values[Jx]), SIMDSplat(p.y)));
+	sum = SIMDAdd(sum, SIMDMultiply(SIMDLoad(&m_values[Kx]), SIMDSplat(p.z)));
+	sum = SIMDAdd(sum, SIMDMultiply(SIMDLoad(&m_values[Tx]), SIMDSplat(p.w)));
+	Vec4 result;
+	SIMDStore(&result.x, sum);
+	return result;
+#endif
 }
 
 // -----------------------------------------------------------------------------
@@ -505,6 +516,7 @@ void Mat44::SetIJKT4D(Vec4 const& iBasis4D, Vec4 const& jBasis4D, Vec4 const& kB
 
 void Mat44::Transpose()
 {
+#if defined( ENGINE_SIMD_SCALAR )
 	Mat44 transposedMatrix;
 
 	transposedMatrix.m_values[Ix] = m_values[Ix];
@@ -528,6 +540,17 @@ void Mat44::Transpose()
 	transposedMatrix.m_values[Tw] = m_values[Tw];
 
 	*this = transposedMatrix;
+#else
+	SIMDFloat4 iBasis = SIMDLoad(&m_values[Ix]);
+	SIMDFloat4 jBasis = SIMDLoad(&m_values[Jx]);
+	SIMDFloat4 kBasis = SIMDLoad(&m_values[Kx]);
+	SIMDFloat4 tBasis = SIMDLoad(&m_values[Tx]);
+	SIMDTranspose(iBasis, jBasis, kBasis, tBasis);
+	SIMDStore(&m_values[Ix], iBasis);
+	SIMDStore(&m_values[Jx], jBasis);
+	SIMDStore(&m_values[Kx], kBasis);
+	SIMDStore(&m_values[Tx], tBasis);
+#endif
 }
 
 void Mat44::Orthonormalize_IFwd_JLeft_KUp()
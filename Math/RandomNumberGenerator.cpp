@@ -1,9 +1,38 @@
 #include "Engine/Math/RandomNumberGenerator.h"
-#include <stdlib.h>
+#include "Engine/Math/RawNoise.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <math.h>
+#include <atomic>
+#include <chrono>
+
+constexpr int RANDOM_STREAM_SEED_ROW = 1;		// Lattice row GetStream hashes stream seeds from, the generator's own rolls are row 0
+constexpr int RANDOM_DIRECTION_BATCH_SIZE = 256;	// Directions rolled per chunk of FillRandomDirections3D
+
+static std::atomic<unsigned int> s_numDefaultSeeds(0);	// Generators made without a seed, so two made in the same tick still differ
+
+RandomNumberGenerator::RandomNumberGenerator()
+{
+    // Wall clock ticks, since GetCurrentTimeSeconds starts from zero every run
+    unsigned long long clockTicks = static_cast<unsigned long long>(std::chrono::system_clock::now().time_since_epoch().count());
+    m_seed = Get2dNoiseUint(static_cast<int>(s_numDefaultSeeds.fetch_add(1)), static_cast<int>(clockTicks >> 32), static_cast<unsigned int>(clockTicks));
+}
+
+RandomNumberGenerator::RandomNumberGenerator(unsigned int seed, unsigned int position)
+    : m_seed(seed)
+    , m_position(position)
+{
+}
+
+unsigned int RandomNumberGenerator::RollRandomUint()
+{
+    unsigned int noise = Get1dNoiseUint(static_cast<int>(m_position), m_seed);
+    ++m_position;
+    return noise;
+}
 
 int RandomNumberGenerator::RollRandomIntLessThan(int maxNotInclusive)
 {
-    return rand() % maxNotInclusive;
+    return static_cast<int>(RollRandomUint() % static_cast<unsigned int>(maxNotInclusive));
 }
 
 int RandomNumberGenerator::RollRandomIntInRange(int minInclusive, int maxInclusive)
@@ -14,7 +43,9 @@ int RandomNumberGenerator::RollRandomIntInRange(int minInclusive, int maxInclusi
 
 float RandomNumberGenerator::RollRandomFloatZeroToOne()
 {
-    return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+    float noise = Get1dNoiseZeroToOne(static_cast<int>(m_position), m_seed);
+    ++m_position;
+    return noise;
 }
 
 float RandomNumberGenerator::RollRandomFloatInRange(float minInclusive, float maxInclusive)
@@ -31,6 +62,22 @@ Vec3 RandomNumberGenerator::RollRandomUnitVector()
     return unitVectors[unitVectorIndex];
 }
 
+// A uniform height and turn around the z axis, which is uniform over the sphere (Archimedes' hat-box theorem)
+static Vec3 GetDirectionFromRolls(float heightRoll, float turnRoll)
+{
+    float z = -1.f + heightRoll * 2.f;
+    float radius = sqrtf(1.f - z * z);
+    float turnDegrees = 360.f * turnRoll;
+    return Vec3(radius * CosDegrees(turnDegrees), radius * SinDegrees(turnDegrees), z);
+}
+
+Vec3 RandomNumberGenerator::RollRandomDirection3D()
+{
+    float heightRoll = RollRandomFloatZeroToOne();
+    float turnRoll = RollRandomFloatZeroToOne();
+    return GetDirectionFromRolls(heightRoll, turnRoll);
+}
+
 bool RandomNumberGenerator::RollRandomChance(float chanceToReturnTrue)
 {
     if (chanceToReturnTrue <= 0.0f)
@@ -45,3 +92,119 @@ bool RandomNumberGenerator::RollRandomChance(float chanceToReturnTrue)
     float randomChance = RollRandomFloatZeroToOne();
     return randomChance <= chanceToReturnTrue;
 }
+
+#if defined( ENGINE_SIMD_WIDE_INT )
+// Positions firstPosition, firstPosition + 1, ... across the lanes
+static SIMDIntWide GetLanePositions(unsigned int firstPosition)
+{
+    int lanePositions[SIMD_WIDE_NUM_LANES];
+    for (int laneIndex = 0; laneIndex < SIMD_WIDE_NUM_LANES; ++laneIndex)
+    {
+        lanePositions[laneIndex] = static_cast<int>(firstPosition + static_cast<unsigned int>(laneIndex));
+    }
+    return SIMDLoadIntWide(lanePositions);
+}
+#endif
+
+void RandomNumberGenerator::FillRandomUints(unsigned int* out_values, int numValues)
+{
+    int valueIndex = 0;
+#if defined( ENGINE_SIMD_WIDE_INT )
+    SIMDIntWide positions = GetLanePositions(m_position);
+    SIMDIntWide positionStep = SIMDSplatIntWide(SIMD_WIDE_NUM_LANES);
+    for (; valueIndex + SIMD_WIDE_NUM_LANES <= numValues; valueIndex += SIMD_WIDE_NUM_LANES)
+    {
+        SIMDStoreIntWide(reinterpret_cast<int*>(out_values + valueIndex), Get1dNoiseUintWide(positions, m_seed));
+        positions = SIMDAdd(positions, positionStep);
+    }
+    m_position += static_cast<unsigned int>(valueIndex);
+#endif
+    for (; valueIndex < numValues; ++valueIndex)
+    {
+        out_values[valueIndex] = RollRandomUint();
+    }
+}
+
+void RandomNumberGenerator::FillRandomIntsInRange(int* out_values, int numValues, int minInclusive, int maxInclusive)
+{
+    // Hashing is the vector part, the modulo stays scalar
+    unsigned int* noiseValues = reinterpret_cast<unsigned int*>(out_values);
+    FillRandomUints(noiseValues, numValues);
+    unsigned int range = static_cast<unsigned int>((maxInclusive - minInclusive) + 1);
+    for (int valueIndex = 0; valueIndex < numValues; ++valueIndex)
+    {
+        out_values[valueIndex] = minInclusive + static_cast<int>(noiseValues[valueIndex] % range);
+    }
+}
+
+void RandomNumberGenerator::FillRandomFloatsZeroToOne(float* out_values, int numValues)
+{
+    int valueIndex = 0;
+#if defined( ENGINE_SIMD_WIDE_INT )
+    SIMDIntWide positions = GetLanePositions(m_position);
+    SIMDIntWide positionStep = SIMDSplatIntWide(SIMD_WIDE_NUM_LANES);
+    for (; valueIndex + SIMD_WIDE_NUM_LANES <= numValues; valueIndex += SIMD_WIDE_NUM_LANES)
+    {
+        SIMDStoreWide(out_values + valueIndex, Get1dNoiseZeroToOneWide(positions, m_seed));
+        positions = SIMDAdd(positions, positionStep);
+    }
+    m_position += static_cast<unsigned int>(valueIndex);
+#endif
+    for (; valueIndex < numValues; ++valueIndex)
+    {
+        out_values[valueIndex] = RollRandomFloatZeroToOne();
+    }
+}
+
+void RandomNumberGenerator::FillRandomFloatsInRange(float* out_values, int numValues, float minInclusive, float maxInclusive)
+{
+    float range = (maxInclusive - minInclusive);
+    int valueIndex = 0;
+#if defined( ENGINE_SIMD_WIDE_INT )
+    SIMDIntWide positions = GetLanePositions(m_position);
+    SIMDIntWide positionStep = SIMDSplatIntWide(SIMD_WIDE_NUM_LANES);
+    SIMDFloatWide mins = SIMDSplatWide(minInclusive);
+    SIMDFloatWide ranges = SIMDSplatWide(range);
+    for (; valueIndex + SIMD_WIDE_NUM_LANES <= numValues; valueIndex += SIMD_WIDE_NUM_LANES)
+    {
+        SIMDStoreWide(out_values + valueIndex, SIMDAdd(mins, SIMDMultiply(Get1dNoiseZeroToOneWide(positions, m_seed), ranges)));
+        positions = SIMDAdd(positions, positionStep);
+    }
+    m_position += static_cast<unsigned int>(valueIndex);
+#endif
+    for (; valueIndex < numValues; ++valueIndex)
+    {
+        out_values[valueIndex] = minInclusive + RollRandomFloatZeroToOne() * range;
+    }
+}
+
+void RandomNumberGenerator::FillRandomDirections3D(Vec3* out_directions, int numDirections)
+{
+    // The rolls fill in SIMD, the trig stays scalar so every direction matches RollRandomDirection3D
+    float rolls[2 * RANDOM_DIRECTION_BATCH_SIZE];
+    for (int firstDirection = 0; firstDirection < numDirections; firstDirection += RANDOM_DIRECTION_BATCH_SIZE)
+    {
+        int numBatchDirections = numDirections - firstDirection < RANDOM_DIRECTION_BATCH_SIZE ? numDirections - firstDirection : RANDOM_DIRECTION_BATCH_SIZE;
+        FillRandomFloatsZeroToOne(rolls, 2 * numBatchDirections);
+        for (int batchIndex = 0; batchIndex < numBatchDirections; ++batchIndex)
+        {
+            out_directions[firstDirection + batchIndex] = GetDirectionFromRolls(rolls[2 * batchIndex], rolls[2 * batchIndex + 1]);
+        }
+    }
+}
+
+RandomNumberGenerator RandomNumberGenerator::GetStream(unsigned int streamIndex) const
+{
+    return RandomNumberGenerator(Get2dNoiseUint(static_cast<int>(streamIndex), RANDOM_STREAM_SEED_ROW, m_seed));
+}
+
+void RandomNumberGenerator::SetSeed(unsigned int seed)
+{
+    m_seed = seed;
+    m_position = 0;
+}
+
+void RandomNumberGenerator::SetPosition(unsigned int position)
+{
+    m_position = position;
+}
@@ -1,18 +1,41 @@
 #pragma once
 #include "Engine/Math/Vec3.h"
 
+// Counter based: roll n is Get1dNoiseUint( position n, seed ), so a generator is only its seed and position. The
+// same seed gives the same sequence on every run and platform, a batch Fill gives the same values as that many
+// single rolls, and generators never share state, so each thread or job owns one (see GetStream).
 class RandomNumberGenerator
 {
 public:
+	RandomNumberGenerator();	// Seeded from the clock and a count of generators made, so each one rolls its own sequence
+	explicit RandomNumberGenerator(unsigned int seed, unsigned int position = 0);
+
+	unsigned int RollRandomUint();
 	int RollRandomIntLessThan(int maxNotInclusive);
 	int RollRandomIntInRange(int minInclusive, int maxInclusive);
-	
+
 	float RollRandomFloatZeroToOne();
 	float RollRandomFloatInRange(float minInclusive, float maxInclusive);
 
 	Vec3 RollRandomUnitVector();
+	Vec3 RollRandomDirection3D();	// Uniform over the sphere, uses two rolls
 	bool RollRandomChance(float chanceToReturnTrue);
 
+	// The rolls above for a whole array, with SIMD hashing in builds that have wide integer lanes
+	void FillRandomUints(unsigned int* out_values, int numValues);
+	void FillRandomIntsInRange(int* out_values, int numValues, int minInclusive, int maxInclusive);
+	void FillRandomFloatsZeroToOne(float* out_values, int numValues);
+	void FillRandomFloatsInRange(float* out_values, int numValues, float minInclusive, float maxInclusive);
+	void FillRandomDirections3D(Vec3* out_directions, int numDirections);
+
+	RandomNumberGenerator GetStream(unsigned int streamIndex) const; // A generator of its own for one thread or job, seeded from this seed and streamIndex
+
+	void		 SetSeed(unsigned int seed);	// Also restarts the sequence
+	void		 SetPosition(unsigned int position);
+	unsigned int GetSeed() const { return m_seed; }
+	unsigned int GetPosition() const { return m_position; }
+
 private:
-	/*unsigned int m_seed = 0;*/
+	unsigned int m_seed = 0;
+	unsigned int m_position = 0;	// Index of the next roll
 };
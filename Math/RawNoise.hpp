@@ -2,6 +2,7 @@
 // RawNoise.hpp
 //
 #pragma once
+#include "Engine/Math/SIMDMath.hpp"		// for the SIMD lane versions at the bottom
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -59,6 +60,18 @@ constexpr float Get2dNoiseNegOneToOne(int indexX, int indexY, unsigned int seed
 constexpr float Get3dNoiseNegOneToOne(int indexX, int indexY, int indexZ, unsigned int seed = 0);
 constexpr float Get4dNoiseNegOneToOne(int indexX, int indexY, int indexZ, int indexT, unsigned int seed = 0);
 
+//-----------------------------------------------------------------------------------------------
+// SIMD lane versions, one index (or index set) per lane, bit-identical to the functions above.
+//	Only in builds with wide integer lanes (see ENGINE_SIMD_WIDE_INT in SIMDMath.hpp).
+//
+#if defined( ENGINE_SIMD_WIDE_INT )
+SIMDIntWide Get1dNoiseUintWide(SIMDIntWide indices, unsigned int seed = 0);
+SIMDIntWide Get2dNoiseUintWide(SIMDIntWide indicesX, SIMDIntWide indicesY, unsigned int seed = 0);
+SIMDIntWide Get3dNoiseUintWide(SIMDIntWide indicesX, SIMDIntWide indicesY, SIMDIntWide indicesZ, unsigned int seed = 0);
+SIMDFloatWide Get1dNoiseZeroToOneWide(SIMDIntWide indices, unsigned int seed = 0);
+SIMDFloatWide GetNoiseUintAsZeroToOneWide(SIMDIntWide noise);	// The mapping Get*dNoiseZeroToOne applies to a noise uint
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // Inline function definitions below
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -173,3 +186,65 @@ constexpr float Get4dNoiseNegOneToOne(int indexX, int indexY, int indexZ, int in
 }
 
 
+//-----------------------------------------------------------------------------------------------
+// SIMD lane versions
+//
+#if defined( ENGINE_SIMD_WIDE_INT )
+//-----------------------------------------------------------------------------------------------
+inline SIMDIntWide Get1dNoiseUintWide(SIMDIntWide indices, unsigned int seed)
+{
+	constexpr unsigned int BIT_NOISE1 = 0xd2a80a23; // Same as Get1dNoiseUint
+	constexpr unsigned int BIT_NOISE2 = 0xa884f197;
+	constexpr unsigned int BIT_NOISE3 = 0x1b56c4e9;
+
+	SIMDIntWide mangledBits = SIMDMultiply(indices, SIMDSplatIntWide((int) BIT_NOISE1));
+	mangledBits = SIMDAdd(mangledBits, SIMDSplatIntWide((int) seed));
+	mangledBits = SIMDXor(mangledBits, SIMDShiftRight<7>(mangledBits));
+	mangledBits = SIMDAdd(mangledBits, SIMDSplatIntWide((int) BIT_NOISE2));
+	mangledBits = SIMDXor(mangledBits, SIMDShiftRight<8>(mangledBits));
+	mangledBits = SIMDMultiply(mangledBits, SIMDSplatIntWide((int) BIT_NOISE3));
+	mangledBits = SIMDXor(mangledBits, SIMDShiftRight<11>(mangledBits));
+	return mangledBits;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline SIMDIntWide Get2dNoiseUintWide(SIMDIntWide indicesX, SIMDIntWide indicesY, unsigned int seed)
+{
+	constexpr int PRIME_NUMBER = 198491317; // Same as Get2dNoiseUint
+	return Get1dNoiseUintWide(SIMDAdd(indicesX, SIMDMultiply(SIMDSplatIntWide(PRIME_NUMBER), indicesY)), seed);
+}
+
+//-----------------------------------------------------------------------------------------------
+inline SIMDIntWide Get3dNoiseUintWide(SIMDIntWide indicesX, SIMDIntWide indicesY, SIMDIntWide indicesZ, unsigned int seed)
+{
+	constexpr int PRIME1 = 198491317; // Same as Get3dNoiseUint
+	constexpr int PRIME2 = 6542989;
+	SIMDIntWide combinedIndices = SIMDAdd(indicesX, SIMDMultiply(SIMDSplatIntWide(PRIME1), indicesY));
+	return Get1dNoiseUintWide(SIMDAdd(combinedIndices, SIMDMultiply(SIMDSplatIntWide(PRIME2), indicesZ)), seed);
+}
+
+//-----------------------------------------------------------------------------------------------
+// The Get*dNoiseZeroToOne mapping without doubles.  Dividing by 0xFFFFFFFF gives noise plus a
+//	fraction of 1 (in units of 2^-32), which rounds the same way as noise + 0.25 once noise is too
+//	big to be exact in a float.  From 2^32 - 1024 up the double rounds that fraction to a whole 1,
+//	and the float rounding after it can tie.  The two 16 bit halves convert exactly, so only the
+//	final sum rounds.  Checked against the scalar mapping for all 2^32 inputs.
+//
+inline SIMDFloatWide GetNoiseUintAsZeroToOneWide(SIMDIntWide noise)
+{
+	SIMDIntWide noiseHighBits = SIMDShiftRight<16>(noise);
+	SIMDFloatWide highBits = SIMDMultiply(SIMDConvertToFloat(noiseHighBits), SIMDSplatWide(65536.f));
+	SIMDFloatWide lowBits = SIMDConvertToFloat(SIMDAnd(noise, SIMDSplatIntWide(0xFFFF)));
+	SIMDFloatWide isInexact = SIMDLessEqual(SIMDSplatWide(16777216.f), highBits);
+	SIMDFloatWide isNearTop = SIMDAnd(SIMDCastToFloat(SIMDEqual(noiseHighBits, SIMDSplatIntWide(0xFFFF))), SIMDLessEqual(SIMDSplatWide(64512.f), lowBits));
+	SIMDFloatWide fraction = SIMDSelect(isNearTop, SIMDSplatWide(1.f), SIMDAnd(isInexact, SIMDSplatWide(0.25f)));
+	SIMDFloatWide noiseAsFloat = SIMDAdd(highBits, SIMDAdd(lowBits, fraction));
+	return SIMDMultiply(noiseAsFloat, SIMDSplatWide(1.f / 4294967296.f));
+}
+
+//-----------------------------------------------------------------------------------------------
+inline SIMDFloatWide Get1dNoiseZeroToOneWide(SIMDIntWide indices, unsigned int seed)
+{
+	return GetNoiseUintAsZeroToOneWide(Get1dNoiseUintWide(indices, seed));
+}
+#endif
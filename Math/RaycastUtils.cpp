@@ -2,6 +2,10 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Math/MathUtils.h"
 #include "Engine/Math/FloatRange.hpp"
+#include "Engine/Math/SIMDMath.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include <cfloat>
 
 RaycastResult2D RaycastVsDisc2D(Vec2 startPos, Vec2 fwdNormal, float maxDist, Vec2 discCenter, float discRadius)
 {
@@ -485,6 +489,82 @@ RaycastResult3D RaycastVsPlane3D(Vec3 rayStart, Vec3 fwdNormal, float rayLength,
 	return raycastResult;
 }
 
+// Watertight ray/triangle test (Woop, Benthin and Wald): shears the triangle into a space where the ray runs
+// along +Z, so edges shared by two triangles give both the exact same edge function and no ray slips between them
+RaycastResult3D RaycastVsTriangle3D(Vec3 rayStart, Vec3 fwdNormal, float rayLength, Vec3 const& vertex0, Vec3 const& vertex1, Vec3 const& vertex2, Vec3* out_barycentricCoords)
+{
+	RaycastResult3D raycastResult;
+	raycastResult.m_rayStartPosition = rayStart;
+	raycastResult.m_rayFwdNormal = fwdNormal;
+	raycastResult.m_rayLength = rayLength;
+
+	// Z is the ray's dominant axis, X and Y swap when it points down Z to keep the winding
+	float const fwd[3] = { fwdNormal.x, fwdNormal.y, fwdNormal.z };
+	int kz = (fabsf(fwd[0]) > fabsf(fwd[1])) ? ((fabsf(fwd[0]) > fabsf(fwd[2])) ? 0 : 2) : ((fabsf(fwd[1]) > fabsf(fwd[2])) ? 1 : 2);
+	int kx = (kz + 1) % 3;
+	int ky = (kx + 1) % 3;
+	if (fwd[kz] < 0.f)
+	{
+		std::swap(kx, ky);
+	}
+	float shearX = fwd[kx] / fwd[kz];
+	float shearY = fwd[ky] / fwd[kz];
+	float shearZ = 1.f / fwd[kz];
+
+	Vec3 startToA = vertex0 - rayStart;
+	Vec3 startToB = vertex1 - rayStart;
+	Vec3 startToC = vertex2 - rayStart;
+	float const a[3] = { startToA.x, startToA.y, startToA.z };
+	float const b[3] = { startToB.x, startToB.y, startToB.z };
+	float const c[3] = { startToC.x, startToC.y, startToC.z };
+	float aX = a[kx] - shearX * a[kz];
+	float aY = a[ky] - shearY * a[kz];
+	float bX = b[kx] - shearX * b[kz];
+	float bY = b[ky] - shearY * b[kz];
+	float cX = c[kx] - shearX * c[kz];
+	float cY = c[ky] - shearY * c[kz];
+
+	// Edge functions, all the same sign when the ray passes inside the triangle
+	float u = cX * bY - cY * bX;
+	float v = aX * cY - aY * cX;
+	float w = bX * aY - bY * aX;
+	if ((u < 0.f || v < 0.f || w < 0.f) && (u > 0.f || v > 0.f || w > 0.f))
+	{
+		return raycastResult;
+	}
+
+	float determinant = u + v + w;
+	if (determinant == 0.f)
+	{
+		return raycastResult;
+	}
+
+	float scaledDist = u * (shearZ * a[kz]) + v * (shearZ * b[kz]) + w * (shearZ * c[kz]);
+	if (determinant < 0.f)
+	{
+		scaledDist = -scaledDist;
+		determinant = -determinant;
+	}
+	if (scaledDist < 0.f || scaledDist > rayLength * determinant)
+	{
+		return raycastResult;
+	}
+
+	float impactDist = scaledDist / determinant;
+	raycastResult.m_didImpact = true;
+	raycastResult.m_impactDist = impactDist;
+	raycastResult.m_impactPos = rayStart + fwdNormal * impactDist;
+
+	Vec3 impactNormal = CrossProduct3D(vertex1 - vertex0, vertex2 - vertex0).GetNormalized();
+	raycastResult.m_impactNormal = DotProduct3D(impactNormal, fwdNormal) > 0.f ? -impactNormal : impactNormal;
+	if (out_barycentricCoords != nullptr)
+	{
+		float inverseDeterminant = 1.f / determinant;
+		*out_barycentricCoords = Vec3(fabsf(u) * inverseDeterminant, fabsf(v) * inverseDeterminant, fabsf(w) * inverseDeterminant);
+	}
+	return raycastResult;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 RaycastResult2D GetNearestImpactOnBounds(RaycastResult2D const& raycastResult1, RaycastResult2D raycastResult2, RaycastResult2D raycastResult3, RaycastResult2D raycastResult4)
@@ -535,4 +615,283 @@ Ray2::Ray2(Vec2 const& startPos, Vec2 const& endPos)
 Ray2::Ray2(Vec2 const& startPos, Vec2 const& fwdNormal, float maxLength)
 	:m_startPos(startPos), m_fwdNormal(fwdNormal), m_maxLength(maxLength)
 {
-}
\ No newline at end of file
+}
+
+Ray3::Ray3(Vec3 const& startPos, Vec3 const& fwdNormal, float maxLength)
+	:m_startPos(startPos), m_fwdNormal(fwdNormal), m_maxLength(maxLength)
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+// Batch raycasting
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// Reference path, one single ray raycast per ray and primitive. Used when SIMD is disabled.
+template <typename SingleRaycast>
+static void RaycastBatchScalar(int numRays, Ray3 const* rays, int numPrimitives, RaycastHit3D* out_hits, RaycastBatchMode mode, SingleRaycast const& singleRaycast)
+{
+	for (int rayIndex = 0; rayIndex < numRays; ++rayIndex)
+	{
+		RaycastHit3D nearestHit;
+		for (int primitiveIndex = 0; primitiveIndex < numPrimitives; ++primitiveIndex)
+		{
+			RaycastResult3D result = singleRaycast(rays[rayIndex], primitiveIndex);
+			if (result.m_didImpact && (!nearestHit.DidImpact() || result.m_impactDist < nearestHit.m_impactDist))
+			{
+				nearestHit.m_primitiveIndex = primitiveIndex;
+				nearestHit.m_impactDist = result.m_impactDist;
+				if (mode == RaycastBatchMode::ANY_HIT)
+				{
+					break;
+				}
+			}
+		}
+		out_hits[rayIndex] = nearestHit;
+	}
+}
+
+#if !defined( ENGINE_SIMD_SCALAR )
+// -----------------------------------------------------------------------------
+// Up to SIMD_WIDE_NUM_LANES rays in structure of arrays form, one ray per lane. Short packets repeat
+// their last ray so every lane holds a real ray.
+struct RayPacket3D
+{
+	SIMDFloatWide m_startX;
+	SIMDFloatWide m_startY;
+	SIMDFloatWide m_startZ;
+	SIMDFloatWide m_fwdX;
+	SIMDFloatWide m_fwdY;
+	SIMDFloatWide m_fwdZ;
+	SIMDFloatWide m_inverseFwdX;
+	SIMDFloatWide m_inverseFwdY;
+	SIMDFloatWide m_inverseFwdZ;
+	SIMDFloatWide m_maxLength;
+};
+
+static void LoadRayPacket(RayPacket3D& out_packet, Ray3 const* rays, int numRays)
+{
+	float lanes[10][SIMD_WIDE_NUM_LANES];
+	for (int laneIndex = 0; laneIndex < SIMD_WIDE_NUM_LANES; ++laneIndex)
+	{
+		Ray3 const& ray = rays[laneIndex < numRays ? laneIndex : numRays - 1];
+		lanes[0][laneIndex] = ray.m_startPos.x;
+		lanes[1][laneIndex] = ray.m_startPos.y;
+		lanes[2][laneIndex] = ray.m_startPos.z;
+		lanes[3][laneIndex] = ray.m_fwdNormal.x;
+		lanes[4][laneIndex] = ray.m_fwdNormal.y;
+		lanes[5][laneIndex] = ray.m_fwdNormal.z;
+		lanes[6][laneIndex] = 1.f / ray.m_fwdNormal.x;
+		lanes[7][laneIndex] = 1.f / ray.m_fwdNormal.y;
+		lanes[8][laneIndex] = 1.f / ray.m_fwdNormal.z;
+		lanes[9][laneIndex] = ray.m_maxLength;
+	}
+	out_packet.m_startX = SIMDLoadWide(lanes[0]);
+	out_packet.m_startY = SIMDLoadWide(lanes[1]);
+	out_packet.m_startZ = SIMDLoadWide(lanes[2]);
+	out_packet.m_fwdX = SIMDLoadWide(lanes[3]);
+	out_packet.m_fwdY = SIMDLoadWide(lanes[4]);
+	out_packet.m_fwdZ = SIMDLoadWide(lanes[5]);
+	out_packet.m_inverseFwdX = SIMDLoadWide(lanes[6]);
+	out_packet.m_inverseFwdY = SIMDLoadWide(lanes[7]);
+	out_packet.m_inverseFwdZ = SIMDLoadWide(lanes[8]);
+	out_packet.m_maxLength = SIMDLoadWide(lanes[9]);
+}
+
+// Slab test shared by the box kernels, a start inside the box gives tMin < 0 and reports an impact at 0
+static SIMDFloatWide GetSlabImpactMask(SIMDFloatWide tX1, SIMDFloatWide tX2, SIMDFloatWide tY1, SIMDFloatWide tY2, SIMDFloatWide tZ1, SIMDFloatWide tZ2,
+	SIMDFloatWide maxLength, SIMDFloatWide& out_impactDist)
+{
+	SIMDFloatWide zero = SIMDSplatWide(0.f);
+	SIMDFloatWide tMin = SIMDMax(SIMDMin(tX1, tX2), SIMDMax(SIMDMin(tY1, tY2), SIMDMin(tZ1, tZ2)));
+	SIMDFloatWide tMax = SIMDMin(SIMDMax(tX1, tX2), SIMDMin(SIMDMax(tY1, tY2), SIMDMax(tZ1, tZ2)));
+	out_impactDist = SIMDMax(tMin, zero);
+	return SIMDAnd(SIMDLessEqual(tMin, tMax), SIMDAnd(SIMDLessEqual(zero, tMax), SIMDLessEqual(tMin, maxLength)));
+}
+// -----------------------------------------------------------------------------
+// Packet kernels, each returns a mask of the lanes whose ray hits the primitive and their impact distances
+struct AABB3PacketRaycast
+{
+	AABB3 const* m_boxes = nullptr;
+
+	SIMDFloatWide operator()(RayPacket3D const& packet, int boxIndex, SIMDFloatWide& out_impactDist) const
+	{
+		AABB3 const& box = m_boxes[boxIndex];
+		SIMDFloatWide tX1 = SIMDMultiply(SIMDSubtract(SIMDSplatWide(box.m_mins.x), packet.m_startX), packet.m_inverseFwdX);
+		SIMDFloatWide tX2 = SIMDMultiply(SIMDSubtract(SIMDSplatWide(box.m_maxs.x), packet.m_startX), packet.m_inverseFwdX);
+		SIMDFloatWide tY1 = SIMDMultiply(SIMDSubtract(SIMDSplatWide(box.m_mins.y), packet.m_startY), packet.m_inverseFwdY);
+		SIMDFloatWide tY2 = SIMDMultiply(SIMDSubtract(SIMDSplatWide(box.m_maxs.y), packet.m_startY), packet.m_inverseFwdY);
+		SIMDFloatWide tZ1 = SIMDMultiply(SIMDSubtract(SIMDSplatWide(box.m_mins.z), packet.m_startZ), packet.m_inverseFwdZ);
+		SIMDFloatWide tZ2 = SIMDMultiply(SIMDSubtract(SIMDSplatWide(box.m_maxs.z), packet.m_startZ), packet.m_inverseFwdZ);
+		return GetSlabImpactMask(tX1, tX2, tY1, tY2, tZ1, tZ2, packet.m_maxLength, out_impactDist);
+	}
+};
+
+struct Sphere3PacketRaycast
+{
+	Sphere3 const* m_spheres = nullptr;
+
+	SIMDFloatWide operator()(RayPacket3D const& packet, int sphereIndex, SIMDFloatWide& out_impactDist) const
+	{
+		Sphere3 const& sphere = m_spheres[sphereIndex];
+		SIMDFloatWide zero = SIMDSplatWide(0.f);
+		SIMDFloatWide radius = SIMDSplatWide(sphere.m_radius);
+		SIMDFloatWide radiusSquared = SIMDSplatWide(sphere.m_radius * sphere.m_radius);
+		SIMDFloatWide startToCenterX = SIMDSubtract(SIMDSplatWide(sphere.m_center.x), packet.m_startX);
+		SIMDFloatWide startToCenterY = SIMDSubtract(SIMDSplatWide(sphere.m_center.y), packet.m_startY);
+		SIMDFloatWide startToCenterZ = SIMDSubtract(SIMDSplatWide(sphere.m_center.z), packet.m_startZ);
+		SIMDFloatWide startToCenterLengthSquared = SIMDAdd(SIMDAdd(SIMDMultiply(startToCenterX, startToCenterX), SIMDMultiply(startToCenterY, startToCenterY)), SIMDMultiply(startToCenterZ, startToCenterZ));
+		SIMDFloatWide projection = SIMDAdd(SIMDAdd(SIMDMultiply(startToCenterX, packet.m_fwdX), SIMDMultiply(startToCenterY, packet.m_fwdY)), SIMDMultiply(startToCenterZ, packet.m_fwdZ));
+
+		// Squared distance from the center to the ray line, found the same way as RaycastVsSphere3D
+		SIMDFloatWide perpendicularX = SIMDSubtract(startToCenterX, SIMDMultiply(projection, packet.m_fwdX));
+		SIMDFloatWide perpendicularY = SIMDSubtract(startToCenterY, SIMDMultiply(projection, packet.m_fwdY));
+		SIMDFloatWide perpendicularZ = SIMDSubtract(startToCenterZ, SIMDMultiply(projection, packet.m_fwdZ));
+		SIMDFloatWide perpendicularLengthSquared = SIMDAdd(SIMDAdd(SIMDMultiply(perpendicularX, perpendicularX), SIMDMultiply(perpendicularY, perpendicularY)), SIMDMultiply(perpendicularZ, perpendicularZ));
+		SIMDFloatWide impactDist = SIMDSubtract(projection, SIMDSqrt(SIMDMax(SIMDSubtract(radiusSquared, perpendicularLengthSquared), zero)));
+
+		SIMDFloatWide isStartInside = SIMDLessEqual(startToCenterLengthSquared, radiusSquared);
+		SIMDFloatWide isImpactAhead = SIMDAnd(SIMDAnd(SIMDLess(zero, projection), SIMDLess(projection, SIMDAdd(packet.m_maxLength, radius))),
+			SIMDAnd(SIMDLess(perpendicularLengthSquared, radiusSquared), SIMDLess(impactDist, packet.m_maxLength)));
+		out_impactDist = SIMDSelect(isStartInside, zero, impactDist);
+		return SIMDOr(isStartInside, isImpactAhead);
+	}
+};
+
+// Moves the packet into each box's local space and runs the same slab test as the AABB kernel
+struct OBB3PacketRaycast
+{
+	OBB3 const* m_boxes = nullptr;
+
+	SIMDFloatWide operator()(RayPacket3D const& packet, int boxIndex, SIMDFloatWide& out_impactDist) const
+	{
+		OBB3 const& box = m_boxes[boxIndex];
+		SIMDFloatWide centerToStartX = SIMDSubtract(packet.m_startX, SIMDSplatWide(box.m_center.x));
+		SIMDFloatWide centerToStartY = SIMDSubtract(packet.m_startY, SIMDSplatWide(box.m_center.y));
+		SIMDFloatWide centerToStartZ = SIMDSubtract(packet.m_startZ, SIMDSplatWide(box.m_center.z));
+
+		Vec3 const* bases[3] = { &box.m_iBasis, &box.m_jBasis, &box.m_kBasis };
+		float const halfDimensions[3] = { box.m_halfDimensions.x, box.m_halfDimensions.y, box.m_halfDimensions.z };
+		SIMDFloatWide tNear[3];
+		SIMDFloatWide tFar[3];
+		for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+		{
+			SIMDFloatWide basisX = SIMDSplatWide(bases[axisIndex]->x);
+			SIMDFloatWide basisY = SIMDSplatWide(bases[axisIndex]->y);
+			SIMDFloatWide basisZ = SIMDSplatWide(bases[axisIndex]->z);
+			SIMDFloatWide localStart = SIMDAdd(SIMDAdd(SIMDMultiply(centerToStartX, basisX), SIMDMultiply(centerToStartY, basisY)), SIMDMultiply(centerToStartZ, basisZ));
+			SIMDFloatWide localFwd = SIMDAdd(SIMDAdd(SIMDMultiply(packet.m_fwdX, basisX), SIMDMultiply(packet.m_fwdY, basisY)), SIMDMultiply(packet.m_fwdZ, basisZ));
+			SIMDFloatWide halfDimension = SIMDSplatWide(halfDimensions[axisIndex]);
+			tNear[axisIndex] = SIMDDivide(SIMDSubtract(SIMDSplatWide(-halfDimensions[axisIndex]), localStart), localFwd);
+			tFar[axisIndex] = SIMDDivide(SIMDSubtract(halfDimension, localStart), localFwd);
+		}
+		return GetSlabImpactMask(tNear[0], tFar[0], tNear[1], tFar[1], tNear[2], tFar[2], packet.m_maxLength, out_impactDist);
+	}
+};
+// -----------------------------------------------------------------------------
+// Tests every packet of rays against every primitive, keeping the nearest hit per lane. Primitive indices
+// ride along as floats, exact up to 2^24.
+template <typename PacketRaycast>
+static void RaycastBatchPackets(int numRays, Ray3 const* rays, int numPrimitives, RaycastHit3D* out_hits, RaycastBatchMode mode, JobSystem* jobSystem, PacketRaycast const& packetRaycast)
+{
+	GUARANTEE_OR_DIE(numPrimitives <= (1 << 24), Stringf("Batch raycast supports at most %d primitives, got %d", 1 << 24, numPrimitives));
+
+	int numPackets = (numRays + SIMD_WIDE_NUM_LANES - 1) / SIMD_WIDE_NUM_LANES;
+	int allLaneBits = (1 << SIMD_WIDE_NUM_LANES) - 1;
+	auto rangeFunction = [&](int startPacket, int endPacket)
+	{
+		for (int packetIndex = startPacket; packetIndex < endPacket; ++packetIndex)
+		{
+			int firstRayIndex = packetIndex * SIMD_WIDE_NUM_LANES;
+			int numPacketRays = std::min(SIMD_WIDE_NUM_LANES, numRays - firstRayIndex);
+			RayPacket3D packet;
+			LoadRayPacket(packet, rays + firstRayIndex, numPacketRays);
+
+			SIMDFloatWide nearestDist = SIMDSplatWide(FLT_MAX);
+			SIMDFloatWide nearestIndex = SIMDSplatWide(-1.f);
+			int impactLaneBits = 0;
+			for (int primitiveIndex = 0; primitiveIndex < numPrimitives; ++primitiveIndex)
+			{
+				SIMDFloatWide impactDist;
+				SIMDFloatWide didImpact = packetRaycast(packet, primitiveIndex, impactDist);
+				SIMDFloatWide isNearer = SIMDAnd(didImpact, SIMDLess(impactDist, nearestDist));
+				nearestDist = SIMDSelect(isNearer, impactDist, nearestDist);
+				nearestIndex = SIMDSelect(isNearer, SIMDSplatWide(static_cast<float>(primitiveIndex)), nearestIndex);
+				if (mode == RaycastBatchMode::ANY_HIT)
+				{
+					impactLaneBits |= SIMDGetMaskBits(didImpact);
+					if (impactLaneBits == allLaneBits)
+					{
+						break;
+					}
+				}
+			}
+
+			float laneDists[SIMD_WIDE_NUM_LANES];
+			float laneIndices[SIMD_WIDE_NUM_LANES];
+			SIMDStoreWide(laneDists, nearestDist);
+			SIMDStoreWide(laneIndices, nearestIndex);
+			for (int laneIndex = 0; laneIndex < numPacketRays; ++laneIndex)
+			{
+				RaycastHit3D& hit = out_hits[firstRayIndex + laneIndex];
+				hit.m_primitiveIndex = static_cast<int>(laneIndices[laneIndex]);
+				hit.m_impactDist = hit.DidImpact() ? laneDists[laneIndex] : 0.f;
+			}
+		}
+	};
+
+	if (jobSystem != nullptr)
+	{
+		int minPacketsPerJob = (RAYCAST_BATCH_MIN_RAYS_PER_JOB + SIMD_WIDE_NUM_LANES - 1) / SIMD_WIDE_NUM_LANES;
+		jobSystem->ExecuteParallelFor(numPackets, minPacketsPerJob, rangeFunction);
+	}
+	else
+	{
+		rangeFunction(0, numPackets);
+	}
+}
+#endif
+// -----------------------------------------------------------------------------
+void RaycastBatchVsAABB3Ds(int numRays, Ray3 const* rays, int numBoxes, AABB3 const* boxes, RaycastHit3D* out_hits, RaycastBatchMode mode, JobSystem* jobSystem)
+{
+#if defined( ENGINE_SIMD_SCALAR )
+	UNUSED(jobSystem);
+	RaycastBatchScalar(numRays, rays, numBoxes, out_hits, mode, [&](Ray3 const& ray, int boxIndex)
+	{
+		return RaycastVsAABB3D(ray.m_startPos, ray.m_fwdNormal, ray.m_maxLength, boxes[boxIndex]);
+	});
+#else
+	AABB3PacketRaycast packetRaycast;
+	packetRaycast.m_boxes = boxes;
+	RaycastBatchPackets(numRays, rays, numBoxes, out_hits, mode, jobSystem, packetRaycast);
+#endif
+}
+
+void RaycastBatchVsSphere3Ds(int numRays, Ray3 const* rays, int numSpheres, Sphere3 const* spheres, RaycastHit3D* out_hits, RaycastBatchMode mode, JobSystem* jobSystem)
+{
+#if defined( ENGINE_SIMD_SCALAR )
+	UNUSED(jobSystem);
+	RaycastBatchScalar(numRays, rays, numSpheres, out_hits, mode, [&](Ray3 const& ray, int sphereIndex)
+	{
+		return RaycastVsSphere3D(ray.m_startPos, ray.m_fwdNormal, ray.m_maxLength, spheres[sphereIndex].m_center, spheres[sphereIndex].m_radius);
+	});
+#else
+	Sphere3PacketRaycast packetRaycast;
+	packetRaycast.m_spheres = spheres;
+	RaycastBatchPackets(numRays, rays, numSpheres, out_hits, mode, jobSystem, packetRaycast);
+#endif
+}
+
+void RaycastBatchVsOBB3Ds(int numRays, Ray3 const* rays, int numBoxes, OBB3 const* boxes, RaycastHit3D* out_hits, RaycastBatchMode mode, JobSystem* jobSystem)
+{
+#if defined( ENGINE_SIMD_SCALAR )
+	UNUSED(jobSystem);
+	RaycastBatchScalar(numRays, rays, numBoxes, out_hits, mode, [&](Ray3 const& ray, int boxIndex)
+	{
+		return RaycastVsOBB3D(ray.m_startPos, ray.m_fwdNormal, ray.m_maxLength, boxes[boxIndex]);
+	});
+#else
+	OBB3PacketRaycast packetRaycast;
+	packetRaycast.m_boxes = boxes;
+	RaycastBatchPackets(numRays, rays, numBoxes, out_hits, mode, jobSystem, packetRaycast);
+#endif
+}
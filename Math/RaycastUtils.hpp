@@ -6,6 +6,9 @@
 #include "Engine/Math/OBB3.hpp"
 #include "Engine/Math/FloatRange.hpp"
 #include "Engine/Math/Plane3.hpp"
+#include "Engine/Math/Sphere3.hpp"
+// -----------------------------------------------------------------------------
+class JobSystem;
 // -----------------------------------------------------------------------------
 struct RaycastResult2D
 {
@@ -45,6 +48,32 @@ struct Ray2
 	float m_maxLength = 1.f;
 };
 // -----------------------------------------------------------------------------
+struct Ray3
+{
+	Ray3() = default;
+	Ray3(Vec3 const& startPos, Vec3 const& fwdNormal, float maxLength);
+
+	Vec3 m_startPos;
+	Vec3 m_fwdNormal;	// Must be normalized
+	float m_maxLength = 1.f;
+};
+// -----------------------------------------------------------------------------
+// Compact per ray result of the batch raycasts. Rerun the single ray function on the primitive that
+// was hit when the impact position or normal is needed.
+struct RaycastHit3D
+{
+	int	  m_primitiveIndex = -1;	// -1 when the ray hit nothing
+	float m_impactDist = 0.f;
+
+	bool DidImpact() const { return m_primitiveIndex >= 0; }
+};
+// -----------------------------------------------------------------------------
+enum class RaycastBatchMode
+{
+	NEAREST_HIT,	// Closest primitive along each ray
+	ANY_HIT,		// First primitive found to block each ray, cheaper for line of sight checks
+};
+// -----------------------------------------------------------------------------
 // Raycasting methods 2D
 RaycastResult2D RaycastVsDisc2D(Vec2 startPos, Vec2 fwdNormal, float maxDist, Vec2 discCenter, float discRadius);
 RaycastResult2D RaycastVsLineSegment2D(Vec2 startPos, Vec2 fwdNormal, float maxDist, Vec2 lineStart, Vec2 lineEnd);
@@ -56,6 +85,15 @@ RaycastResult3D RaycastVsAABB3D(Vec3 rayStart, Vec3 fwdNormal, float rayLength,
 RaycastResult3D RaycastVsCylinder3D(Vec3 rayStart, Vec3 fwdNormal, float rayLength, Vec3 cylinderStart, float cylinderRadius, float cylinderHeight);
 RaycastResult3D RaycastVsOBB3D(Vec3 rayStart, Vec3 fwdNormal, float rayLength, OBB3 const& box);
 RaycastResult3D RaycastVsPlane3D(Vec3 rayStart, Vec3 fwdNormal, float rayLength, Plane3 const& plane);
+RaycastResult3D RaycastVsTriangle3D(Vec3 rayStart, Vec3 fwdNormal, float rayLength, Vec3 const& vertex0, Vec3 const& vertex1, Vec3 const& vertex2, Vec3* out_barycentricCoords = nullptr); // Watertight, two sided
+// -----------------------------------------------------------------------------
+// Batch raycasting, every ray against every primitive, writing one hit per ray to out_hits. Rays are tested
+// in SIMD packets of SIMD_WIDE_NUM_LANES and the packets are split across the job system when one is given.
+constexpr int RAYCAST_BATCH_MIN_RAYS_PER_JOB = 64;
+
+void RaycastBatchVsAABB3Ds(int numRays, Ray3 const* rays, int numBoxes, AABB3 const* boxes, RaycastHit3D* out_hits, RaycastBatchMode mode = RaycastBatchMode::NEAREST_HIT, JobSystem* jobSystem = nullptr);
+void RaycastBatchVsSphere3Ds(int numRays, Ray3 const* rays, int numSpheres, Sphere3 const* spheres, RaycastHit3D* out_hits, RaycastBatchMode mode = RaycastBatchMode::NEAREST_HIT, JobSystem* jobSystem = nullptr);
+void RaycastBatchVsOBB3Ds(int numRays, Ray3 const* rays, int numBoxes, OBB3 const* boxes, RaycastHit3D* out_hits, RaycastBatchMode mode = RaycastBatchMode::NEAREST_HIT, JobSystem* jobSystem = nullptr);
 // -----------------------------------------------------------------------------
 // Raycast helpers
 RaycastResult2D GetNearestImpactOnBounds(RaycastResult2D const& raycastResult1, RaycastResult2D raycastResult2, RaycastResult2D raycastResult3, RaycastResult2D raycastResult4);
@@ -0,0 +1,177 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// Four wide float vector for the Mat44 members that measurably beat their scalar code (Transpose and
+// TransformHomogeneous3D). Quat, Vec4, the Mat44 multiply and the Vec3 transforms stay scalar, the
+// vector versions did not measurably win. SSE on x86/x64, which Engine.vcxproj always builds with
+// /arch:AVX2, NEON on ARM64, and the original scalar code when ENGINE_DISABLE_SIMD is defined.
+//
+// Lane wise kernels (ray packets and the like) use SIMDFloatWide instead, eight lanes on x86/x64 and four on
+// NEON. Comparisons return masks with every bit of a passing lane set.
+//
+// SIMDFloatWide is part of some public structs, so an x86/x64 project including these headers without AVX2
+// would disagree with the engine about their layout. That is a compile error rather than a silent mismatch.
+//
+// The vector paths do exactly the scalar multiplies and adds in the scalar order, never fused, so their
+// results are bit identical to the scalar code. Tests/Math/SIMDMathTests.cpp checks that.
+// -----------------------------------------------------------------------------
+#if defined( ENGINE_DISABLE_SIMD )
+	#define ENGINE_SIMD_SCALAR
+#elif defined( _M_X64 ) || defined( _M_IX86 ) || defined( __SSE2__ )
+	#define ENGINE_SIMD_SSE
+	#include <immintrin.h>
+#elif defined( _M_ARM64 ) || defined( __ARM_NEON )
+	#define ENGINE_SIMD_NEON
+	#include <arm_neon.h>
+#else
+	#define ENGINE_SIMD_SCALAR
+#endif
+
+#if defined( ENGINE_SIMD_SSE ) && !defined( __AVX2__ )
+	#error "Build with /arch:AVX2 like Engine.vcxproj, or define ENGINE_DISABLE_SIMD here and in the engine for the scalar code"
+#endif
+// -----------------------------------------------------------------------------
+#if defined( ENGINE_SIMD_SSE )
+typedef __m128 SIMDFloat4;
+
+inline SIMDFloat4 SIMDLoad(float const* fourValues)						{ return _mm_loadu_ps(fourValues); }
+inline void		  SIMDStore(float* out_fourValues, SIMDFloat4 vector)	{ _mm_storeu_ps(out_fourValues, vector); }
+inline SIMDFloat4 SIMDSet(float x, float y, float z, float w)			{ return _mm_setr_ps(x, y, z, w); }
+inline SIMDFloat4 SIMDSplat(float value)								{ return _mm_set1_ps(value); }
+inline SIMDFloat4 SIMDAdd(SIMDFloat4 a, SIMDFloat4 b)					{ return _mm_add_ps(a, b); }
+inline SIMDFloat4 SIMDSubtract(SIMDFloat4 a, SIMDFloat4 b)				{ return _mm_sub_ps(a, b); }
+inline SIMDFloat4 SIMDMultiply(SIMDFloat4 a, SIMDFloat4 b)				{ return _mm_mul_ps(a, b); }
+inline SIMDFloat4 SIMDDivide(SIMDFloat4 a, SIMDFloat4 b)				{ return _mm_div_ps(a, b); }
+inline SIMDFloat4 SIMDNegate(SIMDFloat4 a)								{ return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+inline SIMDFloat4 SIMDFlipSigns(SIMDFloat4 a, SIMDFloat4 signs)			{ return _mm_xor_ps(a, signs); } // Lanes where signs is -0 are negated
+inline SIMDFloat4 SIMDMin(SIMDFloat4 a, SIMDFloat4 b)					{ return _mm_min_ps(a, b); }
+inline SIMDFloat4 SIMDMax(SIMDFloat4 a, SIMDFloat4 b)					{ return _mm_max_ps(a, b); }
+inline SIMDFloat4 SIMDSqrt(SIMDFloat4 a)								{ return _mm_sqrt_ps(a); }
+inline SIMDFloat4 SIMDLess(SIMDFloat4 a, SIMDFloat4 b)					{ return _mm_cmplt_ps(a, b); }
+inline SIMDFloat4 SIMDLessEqual(SIMDFloat4 a, SIMDFloat4 b)				{ return _mm_cmple_ps(a, b); }
+inline SIMDFloat4 SIMDAnd(SIMDFloat4 a, SIMDFloat4 b)					{ return _mm_and_ps(a, b); }
+inline SIMDFloat4 SIMDOr(SIMDFloat4 a, SIMDFloat4 b)					{ return _mm_or_ps(a, b); }
+inline SIMDFloat4 SIMDSelect(SIMDFloat4 mask, SIMDFloat4 a, SIMDFloat4 b)	{ return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); } // a where mask is set
+inline int		  SIMDGetMaskBits(SIMDFloat4 mask)						{ return _mm_movemask_ps(mask); } // Lane n is bit n
+
+template <int X, int Y, int Z, int W>
+inline SIMDFloat4 SIMDSwizzle(SIMDFloat4 vector)						{ return _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(W, Z, Y, X)); }
+
+inline void SIMDTranspose(SIMDFloat4& row0, SIMDFloat4& row1, SIMDFloat4& row2, SIMDFloat4& row3)
+{
+	_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+}
+#elif defined( ENGINE_SIMD_NEON )
+typedef float32x4_t SIMDFloat4;
+
+inline SIMDFloat4 SIMDLoad(float const* fourValues)						{ return vld1q_f32(fourValues); }
+inline void		  SIMDStore(float* out_fourValues, SIMDFloat4 vector)	{ vst1q_f32(out_fourValues, vector); }
+inline SIMDFloat4 SIMDSet(float x, float y, float z, float w)			{ float const values[4] = { x, y, z, w }; return vld1q_f32(values); }
+inline SIMDFloat4 SIMDSplat(float value)								{ return vdupq_n_f32(value); }
+inline SIMDFloat4 SIMDAdd(SIMDFloat4 a, SIMDFloat4 b)					{ return vaddq_f32(a, b); }
+inline SIMDFloat4 SIMDSubtract(SIMDFloat4 a, SIMDFloat4 b)				{ return vsubq_f32(a, b); }
+inline SIMDFloat4 SIMDMultiply(SIMDFloat4 a, SIMDFloat4 b)				{ return vmulq_f32(a, b); }
+inline SIMDFloat4 SIMDDivide(SIMDFloat4 a, SIMDFloat4 b)				{ return vdivq_f32(a, b); }
+inline SIMDFloat4 SIMDNegate(SIMDFloat4 a)								{ return vnegq_f32(a); }
+inline SIMDFloat4 SIMDFlipSigns(SIMDFloat4 a, SIMDFloat4 signs)			{ return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(signs))); }
+inline SIMDFloat4 SIMDMin(SIMDFloat4 a, SIMDFloat4 b)					{ return vminq_f32(a, b); }
+inline SIMDFloat4 SIMDMax(SIMDFloat4 a, SIMDFloat4 b)					{ return vmaxq_f32(a, b); }
+inline SIMDFloat4 SIMDSqrt(SIMDFloat4 a)								{ return vsqrtq_f32(a); }
+inline SIMDFloat4 SIMDLess(SIMDFloat4 a, SIMDFloat4 b)					{ return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+inline SIMDFloat4 SIMDLessEqual(SIMDFloat4 a, SIMDFloat4 b)				{ return vreinterpretq_f32_u32(vcleq_f32(a, b)); }
+inline SIMDFloat4 SIMDAnd(SIMDFloat4 a, SIMDFloat4 b)					{ return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+inline SIMDFloat4 SIMDOr(SIMDFloat4 a, SIMDFloat4 b)					{ return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+inline SIMDFloat4 SIMDSelect(SIMDFloat4 mask, SIMDFloat4 a, SIMDFloat4 b)	{ return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+inline int		  SIMDGetMaskBits(SIMDFloat4 mask)
+{
+	int32_t const laneShifts[4] = { 0, 1, 2, 3 };
+	uint32x4_t laneBits = vshlq_u32(vshrq_n_u32(vreinterpretq_u32_f32(mask), 31), vld1q_s32(laneShifts));
+	return static_cast<int>(vaddvq_u32(laneBits));
+}
+
+template <int X, int Y, int Z, int W>
+inline SIMDFloat4 SIMDSwizzle(SIMDFloat4 vector)
+{
+	return SIMDSet(vgetq_lane_f32(vector, X), vgetq_lane_f32(vector, Y), vgetq_lane_f32(vector, Z), vgetq_lane_f32(vector, W));
+}
+
+inline void SIMDTranspose(SIMDFloat4& row0, SIMDFloat4& row1, SIMDFloat4& row2, SIMDFloat4& row3)
+{
+	float32x4x2_t rows01 = vtrnq_f32(row0, row1);
+	float32x4x2_t rows23 = vtrnq_f32(row2, row3);
+	row0 = vcombine_f32(vget_low_f32(rows01.val[0]), vget_low_f32(rows23.val[0]));
+	row1 = vcombine_f32(vget_low_f32(rows01.val[1]), vget_low_f32(rows23.val[1]));
+	row2 = vcombine_f32(vget_high_f32(rows01.val[0]), vget_high_f32(rows23.val[0]));
+	row3 = vcombine_f32(vget_high_f32(rows01.val[1]), vget_high_f32(rows23.val[1]));
+}
+#endif
+// -----------------------------------------------------------------------------
+#if defined( ENGINE_SIMD_SSE )
+typedef __m256 SIMDFloatWide;
+constexpr int SIMD_WIDE_NUM_LANES = 8;
+
+inline SIMDFloatWide SIMDLoadWide(float const* values)							{ return _mm256_loadu_ps(values); }
+inline void			 SIMDStoreWide(float* out_values, SIMDFloatWide vector)		{ _mm256_storeu_ps(out_values, vector); }
+inline SIMDFloatWide SIMDSplatWide(float value)									{ return _mm256_set1_ps(value); }
+inline SIMDFloatWide SIMDAdd(SIMDFloatWide a, SIMDFloatWide b)					{ return _mm256_add_ps(a, b); }
+inline SIMDFloatWide SIMDSubtract(SIMDFloatWide a, SIMDFloatWide b)				{ return _mm256_sub_ps(a, b); }
+inline SIMDFloatWide SIMDMultiply(SIMDFloatWide a, SIMDFloatWide b)				{ return _mm256_mul_ps(a, b); }
+inline SIMDFloatWide SIMDDivide(SIMDFloatWide a, SIMDFloatWide b)				{ return _mm256_div_ps(a, b); }
+inline SIMDFloatWide SIMDFlipSigns(SIMDFloatWide a, SIMDFloatWide signs)		{ return _mm256_xor_ps(a, signs); }
+inline SIMDFloatWide SIMDMin(SIMDFloatWide a, SIMDFloatWide b)					{ return _mm256_min_ps(a, b); }
+inline SIMDFloatWide SIMDMax(SIMDFloatWide a, SIMDFloatWide b)					{ return _mm256_max_ps(a, b); }
+inline SIMDFloatWide SIMDSqrt(SIMDFloatWide a)									{ return _mm256_sqrt_ps(a); }
+inline SIMDFloatWide SIMDLess(SIMDFloatWide a, SIMDFloatWide b)					{ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline SIMDFloatWide SIMDLessEqual(SIMDFloatWide a, SIMDFloatWide b)			{ return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline SIMDFloatWide SIMDAnd(SIMDFloatWide a, SIMDFloatWide b)					{ return _mm256_and_ps(a, b); }
+inline SIMDFloatWide SIMDOr(SIMDFloatWide a, SIMDFloatWide b)					{ return _mm256_or_ps(a, b); }
+inline SIMDFloatWide SIMDSelect(SIMDFloatWide mask, SIMDFloatWide a, SIMDFloatWide b)	{ return _mm256_blendv_ps(b, a, mask); }
+inline int			 SIMDGetMaskBits(SIMDFloatWide mask)						{ return _mm256_movemask_ps(mask); }
+#elif defined( ENGINE_SIMD_NEON )
+typedef SIMDFloat4 SIMDFloatWide;
+constexpr int SIMD_WIDE_NUM_LANES = 4;
+
+inline SIMDFloatWide SIMDLoadWide(float const* values)							{ return SIMDLoad(values); }
+inline void			 SIMDStoreWide(float* out_values, SIMDFloatWide vector)		{ SIMDStore(out_values, vector); }
+inline SIMDFloatWide SIMDSplatWide(float value)									{ return SIMDSplat(value); }
+#endif
+// -----------------------------------------------------------------------------
+// 32 bit integer lanes to go with SIMDFloatWide, for hashing kernels. Arithmetic wraps like unsigned ints. Every
+// vector build has them, marked by ENGINE_SIMD_WIDE_INT, and the scalar build keeps its integer work scalar.
+#if defined( ENGINE_SIMD_SSE )
+#define ENGINE_SIMD_WIDE_INT
+typedef __m256i SIMDIntWide;
+
+inline SIMDIntWide	 SIMDLoadIntWide(int const* values)							{ return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(values)); }
+inline void			 SIMDStoreIntWide(int* out_values, SIMDIntWide vector)		{ _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_values), vector); }
+inline SIMDIntWide	 SIMDSplatIntWide(int value)								{ return _mm256_set1_epi32(value); }
+inline SIMDIntWide	 SIMDAdd(SIMDIntWide a, SIMDIntWide b)						{ return _mm256_add_epi32(a, b); }
+inline SIMDIntWide	 SIMDMultiply(SIMDIntWide a, SIMDIntWide b)					{ return _mm256_mullo_epi32(a, b); } // Low 32 bits of each product
+inline SIMDIntWide	 SIMDAnd(SIMDIntWide a, SIMDIntWide b)						{ return _mm256_and_si256(a, b); }
+inline SIMDIntWide	 SIMDXor(SIMDIntWide a, SIMDIntWide b)						{ return _mm256_xor_si256(a, b); }
+inline SIMDIntWide	 SIMDEqual(SIMDIntWide a, SIMDIntWide b)					{ return _mm256_cmpeq_epi32(a, b); }
+template <int BITS>
+inline SIMDIntWide	 SIMDShiftLeft(SIMDIntWide a)								{ return _mm256_slli_epi32(a, BITS); }
+template <int BITS>
+inline SIMDIntWide	 SIMDShiftRight(SIMDIntWide a)								{ return _mm256_srli_epi32(a, BITS); } // Zeros shift in
+inline SIMDFloatWide SIMDConvertToFloat(SIMDIntWide a)							{ return _mm256_cvtepi32_ps(a); } // Signed, rounded to nearest
+inline SIMDFloatWide SIMDCastToFloat(SIMDIntWide a)								{ return _mm256_castsi256_ps(a); } // Same bits, for masks and sign flips
+#elif defined( ENGINE_SIMD_NEON )
+#define ENGINE_SIMD_WIDE_INT
+typedef uint32x4_t SIMDIntWide;
+
+inline SIMDIntWide	 SIMDLoadIntWide(int const* values)							{ return vreinterpretq_u32_s32(vld1q_s32(values)); }
+inline void			 SIMDStoreIntWide(int* out_values, SIMDIntWide vector)		{ vst1q_s32(out_values, vreinterpretq_s32_u32(vector)); }
+inline SIMDIntWide	 SIMDSplatIntWide(int value)								{ return vdupq_n_u32(static_cast<uint32_t>(value)); }
+inline SIMDIntWide	 SIMDAdd(SIMDIntWide a, SIMDIntWide b)						{ return vaddq_u32(a, b); }
+inline SIMDIntWide	 SIMDMultiply(SIMDIntWide a, SIMDIntWide b)					{ return vmulq_u32(a, b); }
+inline SIMDIntWide	 SIMDAnd(SIMDIntWide a, SIMDIntWide b)						{ return vandq_u32(a, b); }
+inline SIMDIntWide	 SIMDXor(SIMDIntWide a, SIMDIntWide b)						{ return veorq_u32(a, b); }
+inline SIMDIntWide	 SIMDEqual(SIMDIntWide a, SIMDIntWide b)					{ return vceqq_u32(a, b); }
+template <int BITS>
+inline SIMDIntWide	 SIMDShiftLeft(SIMDIntWide a)								{ return vshlq_n_u32(a, BITS); }
+template <int BITS>
+inline SIMDIntWide	 SIMDShiftRight(SIMDIntWide a)								{ return vshrq_n_u32(a, BITS); }
+inline SIMDFloatWide SIMDConvertToFloat(SIMDIntWide a)							{ return vcvtq_f32_s32(vreinterpretq_s32_u32(a)); }
+inline SIMDFloatWide SIMDCastToFloat(SIMDIntWide a)								{ return vreinterpretq_f32_u32(a); }
+#endif
+// -----------------------------------------------------------------------------
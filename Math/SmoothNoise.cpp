@@ -6,7 +6,11 @@
 #include "Engine/Math/Vec4.hpp"				// for Vec4( float x,y,z,w ) class/struct
 #include "Engine/Math/Vec3.h"				// for Vec3( float x,y,z ) class/struct
 #include "Engine/Math/Vec2.hpp"				// for Vec2( float x,y ) class/struct
+#include "Engine/Math/SIMDMath.hpp"			// for the grid functions' SIMD lanes
+#include "Engine/Core/JobSystem.hpp"
 #include <math.h>
+#include <algorithm>
+#include <vector>
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
@@ -736,3 +740,547 @@ float Compute4dPerlinNoise(float posX, float posY, float posZ, float posT, float
 	return totalNoise;
 }
 
+
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Grid noise
+//
+// Per-sample calls redo each octave's floors, offsets and weights for every sample, although along
+//	a grid row only x changes.  The grid functions build those once per column/row/slice for every
+//	octave (NoiseGridAxis), then blend tiles of samples octave by octave.  Every float operation is
+//	the single-sample function's, in its order, so the results match bit for bit.
+/////////////////////////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------------------------
+constexpr float fOCTAVE_OFFSET = 0.636764989593174f;	// Same translation/bias as the functions above
+constexpr int NOISE_GRID_SAMPLES_PER_TILE = 4096;		// A tile's running totals stay in L1 across octaves
+
+//-----------------------------------------------------------------------------------------------
+// One grid axis for every octave, indexed [octave * m_numPaddedSamples + sample].  Padding repeats
+//	the last sample so SIMD rows never need a scalar tail.
+//
+struct NoiseGridAxis
+{
+	int m_numSamples = 0;
+	int m_numPaddedSamples = 0;
+	std::vector<int> m_cellMins;			// Lower grid line of the sample's cell
+	std::vector<float> m_fromCellMins;		// Position less the lower grid line
+	std::vector<float> m_fromCellMaxs;		// Position less the upper grid line
+	std::vector<float> m_weightsHigh;		// SmoothStep3( m_fromCellMins ), the upper grid line's weight
+	std::vector<float> m_weightsLow;		// 1 - m_weightsHigh
+};
+
+
+//-----------------------------------------------------------------------------------------------
+static void BuildNoiseGridAxis(NoiseGridAxis& out_axis, int numSamples, int numPaddedSamples, float origin, float sampleSpacing, float scale, unsigned int numOctaves, float octaveScale)
+{
+	int numEntries = numPaddedSamples * static_cast<int>(numOctaves);
+	out_axis.m_numSamples = numSamples;
+	out_axis.m_numPaddedSamples = numPaddedSamples;
+	out_axis.m_cellMins.resize(numEntries);
+	out_axis.m_fromCellMins.resize(numEntries);
+	out_axis.m_fromCellMaxs.resize(numEntries);
+	out_axis.m_weightsHigh.resize(numEntries);
+	out_axis.m_weightsLow.resize(numEntries);
+
+	float invScale = (1.f / scale);
+	for (int sampleIndex = 0; sampleIndex < numPaddedSamples; ++sampleIndex)
+	{
+		float position = origin + static_cast<float>(std::min(sampleIndex, numSamples - 1)) * sampleSpacing;
+		float currentPos = position * invScale;
+		for (unsigned int octaveNum = 0; octaveNum < numOctaves; ++octaveNum)
+		{
+			int entryIndex = static_cast<int>(octaveNum) * numPaddedSamples + sampleIndex;
+			float cellMin = floorf(currentPos);
+			float weightHigh = SmoothStep3(currentPos - cellMin);
+			out_axis.m_cellMins[entryIndex] = (int) cellMin;
+			out_axis.m_fromCellMins[entryIndex] = currentPos - cellMin;
+			out_axis.m_fromCellMaxs[entryIndex] = currentPos - (cellMin + 1.f);
+			out_axis.m_weightsHigh[entryIndex] = weightHigh;
+			out_axis.m_weightsLow[entryIndex] = 1.f - weightHigh;
+
+			currentPos *= octaveScale;
+			currentPos += fOCTAVE_OFFSET;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Same running amplitude as the single-sample functions; returns their totalAmplitude
+//
+static float GetNoiseOctaveAmplitudes(std::vector<float>& out_amplitudes, unsigned int numOctaves, float octavePersistence)
+{
+	out_amplitudes.resize(numOctaves);
+	float totalAmplitude = 0.f;
+	float currentAmplitude = 1.f;
+	for (unsigned int octaveNum = 0; octaveNum < numOctaves; ++octaveNum)
+	{
+		out_amplitudes[octaveNum] = currentAmplitude;
+		totalAmplitude += currentAmplitude;
+		currentAmplitude *= octavePersistence;
+	}
+	return totalAmplitude;
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void RunNoiseGridRange(int numItems, JobSystem* jobSystem, std::function<void(int startIndex, int endIndex)> const& rangeFunction)
+{
+	if (jobSystem != nullptr)
+	{
+		jobSystem->ExecuteParallelFor(numItems, 1, rangeFunction);
+	}
+	else
+	{
+		rangeFunction(0, numItems);
+	}
+}
+
+
+#if defined( ENGINE_SIMD_WIDE_INT )
+//-----------------------------------------------------------------------------------------------
+// Dot product of the 2D Perlin gradient <noise> & 7 picks with a displacement.  Magnitudes alternate
+//	between the two components in the pattern of bit 0 ^ bit 1, x is negative for 2..5 and y for 4..7.
+//
+static SIMDFloatWide GetPerlinGradientDot2dWide(SIMDIntWide noise, SIMDFloatWide displacementX, SIMDFloatWide displacementY)
+{
+	SIMDIntWide signBit = SIMDSplatIntWide((int) 0x80000000);
+	SIMDIntWide one = SIMDSplatIntWide(1);
+	SIMDFloatWide isXMajor = SIMDCastToFloat(SIMDEqual(SIMDAnd(SIMDXor(noise, SIMDShiftRight<1>(noise)), one), SIMDSplatIntWide(0)));
+	SIMDFloatWide major = SIMDSplatWide(0.923879533f);
+	SIMDFloatWide minor = SIMDSplatWide(0.382683432f);
+	SIMDFloatWide signsX = SIMDCastToFloat(SIMDAnd(SIMDShiftLeft<29>(SIMDAdd(noise, SIMDSplatIntWide(2))), signBit));
+	SIMDFloatWide signsY = SIMDCastToFloat(SIMDAnd(SIMDShiftLeft<29>(noise), signBit));
+	SIMDFloatWide dotX = SIMDFlipSigns(SIMDMultiply(SIMDSelect(isXMajor, major, minor), displacementX), signsX);
+	SIMDFloatWide dotY = SIMDFlipSigns(SIMDMultiply(SIMDSelect(isXMajor, minor, major), displacementY), signsY);
+	return SIMDAdd(dotX, dotY);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// The 3D Perlin gradients are cube corners, with bits 0, 1 and 2 negating x, y and z
+//
+static SIMDFloatWide GetPerlinGradientDot3dWide(SIMDIntWide noise, SIMDFloatWide displacementX, SIMDFloatWide displacementY, SIMDFloatWide displacementZ)
+{
+	SIMDIntWide signBit = SIMDSplatIntWide((int) 0x80000000);
+	SIMDFloatWide component = SIMDSplatWide(fSQRT_3_OVER_3);
+	SIMDFloatWide dotX = SIMDFlipSigns(SIMDMultiply(component, displacementX), SIMDCastToFloat(SIMDShiftLeft<31>(noise)));
+	SIMDFloatWide dotY = SIMDFlipSigns(SIMDMultiply(component, displacementY), SIMDCastToFloat(SIMDAnd(SIMDShiftLeft<30>(noise), signBit)));
+	SIMDFloatWide dotZ = SIMDFlipSigns(SIMDMultiply(component, displacementZ), SIMDCastToFloat(SIMDAnd(SIMDShiftLeft<29>(noise), signBit)));
+	return SIMDAdd(SIMDAdd(dotX, dotY), dotZ);
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static SIMDFloatWide GetBlendWide(SIMDFloatWide weightLow, SIMDFloatWide valueLow, SIMDFloatWide weightHigh, SIMDFloatWide valueHigh)
+{
+	return SIMDAdd(SIMDMultiply(weightHigh, valueHigh), SIMDMultiply(weightLow, valueLow));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static SIMDFloatWide SmoothStep3Wide(SIMDFloatWide t)
+{
+	SIMDFloatWide one = SIMDSplatWide(1.f);
+	SIMDFloatWide smoothStart = SIMDMultiply(t, t);
+	SIMDFloatWide oneMinusT = SIMDSubtract(one, t);
+	SIMDFloatWide smoothStop = SIMDSubtract(one, SIMDMultiply(oneMinusT, oneMinusT));
+	return SIMDAdd(smoothStart, SIMDMultiply(SIMDSubtract(smoothStop, smoothStart), t));
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Adds one octave of 2D fractal noise to a row of running totals
+//
+static void Add2dFractalNoiseOctaveRow(float* rowTotals, NoiseGridAxis const& axisX, NoiseGridAxis const& axisY, int sampleY, unsigned int octaveNum, unsigned int seed, float amplitude)
+{
+	constexpr unsigned int PRIME_NUMBER = 198491317; // Get2dNoiseUint's
+	int rowEntry = static_cast<int>(octaveNum) * axisY.m_numPaddedSamples + sampleY;
+	unsigned int southOffset = PRIME_NUMBER * (unsigned int) axisY.m_cellMins[rowEntry];
+	SIMDIntWide indexOffsetSouth = SIMDSplatIntWide((int) southOffset);
+	SIMDIntWide indexOffsetNorth = SIMDSplatIntWide((int) (southOffset + PRIME_NUMBER));
+	SIMDFloatWide weightNorth = SIMDSplatWide(axisY.m_weightsHigh[rowEntry]);
+	SIMDFloatWide weightSouth = SIMDSplatWide(axisY.m_weightsLow[rowEntry]);
+	SIMDFloatWide amplitudes = SIMDSplatWide(amplitude);
+	SIMDIntWide one = SIMDSplatIntWide(1);
+
+	int firstEntry = static_cast<int>(octaveNum) * axisX.m_numPaddedSamples;
+	for (int sampleX = 0; sampleX < axisX.m_numPaddedSamples; sampleX += SIMD_WIDE_NUM_LANES)
+	{
+		int entryIndex = firstEntry + sampleX;
+		SIMDIntWide indexWestX = SIMDLoadIntWide(&axisX.m_cellMins[entryIndex]);
+		SIMDIntWide indexEastX = SIMDAdd(indexWestX, one);
+		SIMDFloatWide valueSouthWest = Get1dNoiseZeroToOneWide(SIMDAdd(indexWestX, indexOffsetSouth), seed);
+		SIMDFloatWide valueSouthEast = Get1dNoiseZeroToOneWide(SIMDAdd(indexEastX, indexOffsetSouth), seed);
+		SIMDFloatWide valueNorthWest = Get1dNoiseZeroToOneWide(SIMDAdd(indexWestX, indexOffsetNorth), seed);
+		SIMDFloatWide valueNorthEast = Get1dNoiseZeroToOneWide(SIMDAdd(indexEastX, indexOffsetNorth), seed);
+
+		SIMDFloatWide weightEast = SIMDLoadWide(&axisX.m_weightsHigh[entryIndex]);
+		SIMDFloatWide weightWest = SIMDLoadWide(&axisX.m_weightsLow[entryIndex]);
+		SIMDFloatWide blendSouth = GetBlendWide(weightWest, valueSouthWest, weightEast, valueSouthEast);
+		SIMDFloatWide blendNorth = GetBlendWide(weightWest, valueNorthWest, weightEast, valueNorthEast);
+		SIMDFloatWide blendTotal = SIMDAdd(SIMDMultiply(weightSouth, blendSouth), SIMDMultiply(weightNorth, blendNorth));
+		SIMDFloatWide noiseThisOctave = SIMDMultiply(SIMDSplatWide(2.f), SIMDSubtract(blendTotal, SIMDSplatWide(0.5f)));
+		SIMDStoreWide(rowTotals + sampleX, SIMDAdd(SIMDLoadWide(rowTotals + sampleX), SIMDMultiply(noiseThisOctave, amplitudes)));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void Add3dFractalNoiseOctaveRow(float* rowTotals, NoiseGridAxis const& axisX, NoiseGridAxis const& axisY, int sampleY, NoiseGridAxis const& axisZ, int sampleZ, unsigned int octaveNum, unsigned int seed, float amplitude)
+{
+	constexpr unsigned int PRIME1 = 198491317; // Get3dNoiseUint's
+	constexpr unsigned int PRIME2 = 6542989;
+	int rowEntry = static_cast<int>(octaveNum) * axisY.m_numPaddedSamples + sampleY;
+	int sliceEntry = static_cast<int>(octaveNum) * axisZ.m_numPaddedSamples + sampleZ;
+	unsigned int belowSouthOffset = (PRIME1 * (unsigned int) axisY.m_cellMins[rowEntry]) + (PRIME2 * (unsigned int) axisZ.m_cellMins[sliceEntry]);
+	SIMDIntWide indexOffsetBelowSouth = SIMDSplatIntWide((int) belowSouthOffset);
+	SIMDIntWide indexOffsetBelowNorth = SIMDSplatIntWide((int) (belowSouthOffset + PRIME1));
+	SIMDIntWide indexOffsetAboveSouth = SIMDSplatIntWide((int) (belowSouthOffset + PRIME2));
+	SIMDIntWide indexOffsetAboveNorth = SIMDSplatIntWide((int) (belowSouthOffset + PRIME1 + PRIME2));
+	SIMDFloatWide weightNorth = SIMDSplatWide(axisY.m_weightsHigh[rowEntry]);
+	SIMDFloatWide weightSouth = SIMDSplatWide(axisY.m_weightsLow[rowEntry]);
+	SIMDFloatWide weightAbove = SIMDSplatWide(axisZ.m_weightsHigh[sliceEntry]);
+	SIMDFloatWide weightBelow = SIMDSplatWide(axisZ.m_weightsLow[sliceEntry]);
+	SIMDFloatWide amplitudes = SIMDSplatWide(amplitude);
+	SIMDIntWide one = SIMDSplatIntWide(1);
+
+	int firstEntry = static_cast<int>(octaveNum) * axisX.m_numPaddedSamples;
+	for (int sampleX = 0; sampleX < axisX.m_numPaddedSamples; sampleX += SIMD_WIDE_NUM_LANES)
+	{
+		int entryIndex = firstEntry + sampleX;
+		SIMDIntWide indexWestX = SIMDLoadIntWide(&axisX.m_cellMins[entryIndex]);
+		SIMDIntWide indexEastX = SIMDAdd(indexWestX, one);
+		SIMDFloatWide aboveSouthWest = Get1dNoiseZeroToOneWide(SIMDAdd(indexWestX, indexOffsetAboveSouth), seed);
+		SIMDFloatWide aboveSouthEast = Get1dNoiseZeroToOneWide(SIMDAdd(indexEastX, indexOffsetAboveSouth), seed);
+		SIMDFloatWide aboveNorthWest = Get1dNoiseZeroToOneWide(SIMDAdd(indexWestX, indexOffsetAboveNorth), seed);
+		SIMDFloatWide aboveNorthEast = Get1dNoiseZeroToOneWide(SIMDAdd(indexEastX, indexOffsetAboveNorth), seed);
+		SIMDFloatWide belowSouthWest = Get1dNoiseZeroToOneWide(SIMDAdd(indexWestX, indexOffsetBelowSouth), seed);
+		SIMDFloatWide belowSouthEast = Get1dNoiseZeroToOneWide(SIMDAdd(indexEastX, indexOffsetBelowSouth), seed);
+		SIMDFloatWide belowNorthWest = Get1dNoiseZeroToOneWide(SIMDAdd(indexWestX, indexOffsetBelowNorth), seed);
+		SIMDFloatWide belowNorthEast = Get1dNoiseZeroToOneWide(SIMDAdd(indexEastX, indexOffsetBelowNorth), seed);
+
+		// 8-way blend (8 -> 4 -> 2 -> 1)
+		SIMDFloatWide weightEast = SIMDLoadWide(&axisX.m_weightsHigh[entryIndex]);
+		SIMDFloatWide weightWest = SIMDLoadWide(&axisX.m_weightsLow[entryIndex]);
+		SIMDFloatWide blendBelowSouth = GetBlendWide(weightWest, belowSouthWest, weightEast, belowSouthEast);
+		SIMDFloatWide blendBelowNorth = GetBlendWide(weightWest, belowNorthWest, weightEast, belowNorthEast);
+		SIMDFloatWide blendAboveSouth = GetBlendWide(weightWest, aboveSouthWest, weightEast, aboveSouthEast);
+		SIMDFloatWide blendAboveNorth = GetBlendWide(weightWest, aboveNorthWest, weightEast, aboveNorthEast);
+		SIMDFloatWide blendBelow = SIMDAdd(SIMDMultiply(weightSouth, blendBelowSouth), SIMDMultiply(weightNorth, blendBelowNorth));
+		SIMDFloatWide blendAbove = SIMDAdd(SIMDMultiply(weightSouth, blendAboveSouth), SIMDMultiply(weightNorth, blendAboveNorth));
+		SIMDFloatWide blendTotal = SIMDAdd(SIMDMultiply(weightBelow, blendBelow), SIMDMultiply(weightAbove, blendAbove));
+		SIMDFloatWide noiseThisOctave = SIMDMultiply(SIMDSplatWide(2.f), SIMDSubtract(blendTotal, SIMDSplatWide(0.5f)));
+		SIMDStoreWide(rowTotals + sampleX, SIMDAdd(SIMDLoadWide(rowTotals + sampleX), SIMDMultiply(noiseThisOctave, amplitudes)));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void Add2dPerlinNoiseOctaveRow(float* rowTotals, NoiseGridAxis const& axisX, NoiseGridAxis const& axisY, int sampleY, unsigned int octaveNum, unsigned int seed, float amplitude)
+{
+	constexpr unsigned int PRIME_NUMBER = 198491317; // Get2dNoiseUint's
+	int rowEntry = static_cast<int>(octaveNum) * axisY.m_numPaddedSamples + sampleY;
+	unsigned int southOffset = PRIME_NUMBER * (unsigned int) axisY.m_cellMins[rowEntry];
+	SIMDIntWide indexOffsetSouth = SIMDSplatIntWide((int) southOffset);
+	SIMDIntWide indexOffsetNorth = SIMDSplatIntWide((int) (southOffset + PRIME_NUMBER));
+	SIMDFloatWide displacementFromSouth = SIMDSplatWide(axisY.m_fromCellMins[rowEntry]);
+	SIMDFloatWide displacementFromNorth = SIMDSplatWide(axisY.m_fromCellMaxs[rowEntry]);
+	SIMDFloatWide weightNorth = SIMDSplatWide(axisY.m_weightsHigh[rowEntry]);
+	SIMDFloatWide weightSouth = SIMDSplatWide(axisY.m_weightsLow[rowEntry]);
+	SIMDFloatWide amplitudes = SIMDSplatWide(amplitude);
+	SIMDIntWide one = SIMDSplatIntWide(1);
+
+	int firstEntry = static_cast<int>(octaveNum) * axisX.m_numPaddedSamples;
+	for (int sampleX = 0; sampleX < axisX.m_numPaddedSamples; sampleX += SIMD_WIDE_NUM_LANES)
+	{
+		int entryIndex = firstEntry + sampleX;
+		SIMDIntWide indexWestX = SIMDLoadIntWide(&axisX.m_cellMins[entryIndex]);
+		SIMDIntWide indexEastX = SIMDAdd(indexWestX, one);
+		SIMDFloatWide displacementFromWest = SIMDLoadWide(&axisX.m_fromCellMins[entryIndex]);
+		SIMDFloatWide displacementFromEast = SIMDLoadWide(&axisX.m_fromCellMaxs[entryIndex]);
+		SIMDFloatWide dotSouthWest = GetPerlinGradientDot2dWide(Get1dNoiseUintWide(SIMDAdd(indexWestX, indexOffsetSouth), seed), displacementFromWest, displacementFromSouth);
+		SIMDFloatWide dotSouthEast = GetPerlinGradientDot2dWide(Get1dNoiseUintWide(SIMDAdd(indexEastX, indexOffsetSouth), seed), displacementFromEast, displacementFromSouth);
+		SIMDFloatWide dotNorthWest = GetPerlinGradientDot2dWide(Get1dNoiseUintWide(SIMDAdd(indexWestX, indexOffsetNorth), seed), displacementFromWest, displacementFromNorth);
+		SIMDFloatWide dotNorthEast = GetPerlinGradientDot2dWide(Get1dNoiseUintWide(SIMDAdd(indexEastX, indexOffsetNorth), seed), displacementFromEast, displacementFromNorth);
+
+		SIMDFloatWide weightEast = SIMDLoadWide(&axisX.m_weightsHigh[entryIndex]);
+		SIMDFloatWide weightWest = SIMDLoadWide(&axisX.m_weightsLow[entryIndex]);
+		SIMDFloatWide blendSouth = GetBlendWide(weightWest, dotSouthWest, weightEast, dotSouthEast);
+		SIMDFloatWide blendNorth = GetBlendWide(weightWest, dotNorthWest, weightEast, dotNorthEast);
+		SIMDFloatWide blendTotal = SIMDAdd(SIMDMultiply(weightSouth, blendSouth), SIMDMultiply(weightNorth, blendNorth));
+		SIMDFloatWide noiseThisOctave = SIMDMultiply(blendTotal, SIMDSplatWide(1.f / 0.662578106f));
+		SIMDStoreWide(rowTotals + sampleX, SIMDAdd(SIMDLoadWide(rowTotals + sampleX), SIMDMultiply(noiseThisOctave, amplitudes)));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void Add3dPerlinNoiseOctaveRow(float* rowTotals, NoiseGridAxis const& axisX, NoiseGridAxis const& axisY, int sampleY, NoiseGridAxis const& axisZ, int sampleZ, unsigned int octaveNum, unsigned int seed, float amplitude)
+{
+	constexpr unsigned int PRIME1 = 198491317; // Get3dNoiseUint's
+	constexpr unsigned int PRIME2 = 6542989;
+	int rowEntry = static_cast<int>(octaveNum) * axisY.m_numPaddedSamples + sampleY;
+	int sliceEntry = static_cast<int>(octaveNum) * axisZ.m_numPaddedSamples + sampleZ;
+	unsigned int belowSouthOffset = (PRIME1 * (unsigned int) axisY.m_cellMins[rowEntry]) + (PRIME2 * (unsigned int) axisZ.m_cellMins[sliceEntry]);
+	SIMDIntWide indexOffsetBelowSouth = SIMDSplatIntWide((int) belowSouthOffset);
+	SIMDIntWide indexOffsetBelowNorth = SIMDSplatIntWide((int) (belowSouthOffset + PRIME1));
+	SIMDIntWide indexOffsetAboveSouth = SIMDSplatIntWide((int) (belowSouthOffset + PRIME2));
+	SIMDIntWide indexOffsetAboveNorth = SIMDSplatIntWide((int) (belowSouthOffset + PRIME1 + PRIME2));
+	SIMDFloatWide displacementFromSouth = SIMDSplatWide(axisY.m_fromCellMins[rowEntry]);
+	SIMDFloatWide displacementFromNorth = SIMDSplatWide(axisY.m_fromCellMaxs[rowEntry]);
+	SIMDFloatWide displacementFromBelow = SIMDSplatWide(axisZ.m_fromCellMins[sliceEntry]);
+	SIMDFloatWide displacementFromAbove = SIMDSplatWide(axisZ.m_fromCellMaxs[sliceEntry]);
+	SIMDFloatWide weightNorth = SIMDSplatWide(axisY.m_weightsHigh[rowEntry]);
+	SIMDFloatWide weightSouth = SIMDSplatWide(axisY.m_weightsLow[rowEntry]);
+	SIMDFloatWide weightAbove = SIMDSplatWide(axisZ.m_weightsHigh[sliceEntry]);
+	SIMDFloatWide weightBelow = SIMDSplatWide(axisZ.m_weightsLow[sliceEntry]);
+	SIMDFloatWide amplitudes = SIMDSplatWide(amplitude);
+	SIMDIntWide one = SIMDSplatIntWide(1);
+
+	int firstEntry = static_cast<int>(octaveNum) * axisX.m_numPaddedSamples;
+	for (int sampleX = 0; sampleX < axisX.m_numPaddedSamples; sampleX += SIMD_WIDE_NUM_LANES)
+	{
+		int entryIndex = firstEntry + sampleX;
+		SIMDIntWide indexWestX = SIMDLoadIntWide(&axisX.m_cellMins[entryIndex]);
+		SIMDIntWide indexEastX = SIMDAdd(indexWestX, one);
+		SIMDFloatWide displacementFromWest = SIMDLoadWide(&axisX.m_fromCellMins[entryIndex]);
+		SIMDFloatWide displacementFromEast = SIMDLoadWide(&axisX.m_fromCellMaxs[entryIndex]);
+		SIMDFloatWide dotBelowSW = GetPerlinGradientDot3dWide(Get1dNoiseUintWide(SIMDAdd(indexWestX, indexOffsetBelowSouth), seed), displacementFromWest, displacementFromSouth, displacementFromBelow);
+		SIMDFloatWide dotBelowSE = GetPerlinGradientDot3dWide(Get1dNoiseUintWide(SIMDAdd(indexEastX, indexOffsetBelowSouth), seed), displacementFromEast, displacementFromSouth, displacementFromBelow);
+		SIMDFloatWide dotBelowNW = GetPerlinGradientDot3dWide(Get1dNoiseUintWide(SIMDAdd(indexWestX, indexOffsetBelowNorth), seed), displacementFromWest, displacementFromNorth, displacementFromBelow);
+		SIMDFloatWide dotBelowNE = GetPerlinGradientDot3dWide(Get1dNoiseUintWide(SIMDAdd(indexEastX, indexOffsetBelowNorth), seed), displacementFromEast, displacementFromNorth, displacementFromBelow);
+		SIMDFloatWide dotAboveSW = GetPerlinGradientDot3dWide(Get1dNoiseUintWide(SIMDAdd(indexWestX, indexOffsetAboveSouth), seed), displacementFromWest, displacementFromSouth, displacementFromAbove);
+		SIMDFloatWide dotAboveSE = GetPerlinGradientDot3dWide(Get1dNoiseUintWide(SIMDAdd(indexEastX, indexOffsetAboveSouth), seed), displacementFromEast, displacementFromSouth, displacementFromAbove);
+		SIMDFloatWide dotAboveNW = GetPerlinGradientDot3dWide(Get1dNoiseUintWide(SIMDAdd(indexWestX, indexOffsetAboveNorth), seed), displacementFromWest, displacementFromNorth, displacementFromAbove);
+		SIMDFloatWide dotAboveNE = GetPerlinGradientDot3dWide(Get1dNoiseUintWide(SIMDAdd(indexEastX, indexOffsetAboveNorth), seed), displacementFromEast, displacementFromNorth, displacementFromAbove);
+
+		// 8-way blend (8 -> 4 -> 2 -> 1)
+		SIMDFloatWide weightEast = SIMDLoadWide(&axisX.m_weightsHigh[entryIndex]);
+		SIMDFloatWide weightWest = SIMDLoadWide(&axisX.m_weightsLow[entryIndex]);
+		SIMDFloatWide blendBelowSouth = GetBlendWide(weightWest, dotBelowSW, weightEast, dotBelowSE);
+		SIMDFloatWide blendBelowNorth = GetBlendWide(weightWest, dotBelowNW, weightEast, dotBelowNE);
+		SIMDFloatWide blendAboveSouth = GetBlendWide(weightWest, dotAboveSW, weightEast, dotAboveSE);
+		SIMDFloatWide blendAboveNorth = GetBlendWide(weightWest, dotAboveNW, weightEast, dotAboveNE);
+		SIMDFloatWide blendBelow = SIMDAdd(SIMDMultiply(weightSouth, blendBelowSouth), SIMDMultiply(weightNorth, blendBelowNorth));
+		SIMDFloatWide blendAbove = SIMDAdd(SIMDMultiply(weightSouth, blendAboveSouth), SIMDMultiply(weightNorth, blendAboveNorth));
+		SIMDFloatWide blendTotal = SIMDAdd(SIMDMultiply(weightBelow, blendBelow), SIMDMultiply(weightAbove, blendAbove));
+		SIMDFloatWide noiseThisOctave = SIMDMultiply(blendTotal, SIMDSplatWide(1.f / 0.793856621f));
+		SIMDStoreWide(rowTotals + sampleX, SIMDAdd(SIMDLoadWide(rowTotals + sampleX), SIMDMultiply(noiseThisOctave, amplitudes)));
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------------
+// Splits the grid's rows into tiles and runs every octave over a tile before moving on.
+//	<addOctaveRow>( rowTotals, rowIndex, octaveNum, octaveSeed, amplitude ) adds one octave to one
+//	row of running totals, which is padded out to axisX.m_numPaddedSamples.
+//
+template <typename AddOctaveRow>
+static void FillNoiseGrid(float* out_noiseValues, NoiseGridAxis const& axisX, int numRows, unsigned int numOctaves, float octavePersistence, bool renormalize, unsigned int seed, JobSystem* jobSystem, AddOctaveRow const& addOctaveRow)
+{
+	std::vector<float> amplitudes;
+	float totalAmplitude = GetNoiseOctaveAmplitudes(amplitudes, numOctaves, octavePersistence);
+	int rowLength = axisX.m_numPaddedSamples;
+	int rowsPerTile = std::max(1, NOISE_GRID_SAMPLES_PER_TILE / rowLength);
+	int numTiles = (numRows + rowsPerTile - 1) / rowsPerTile;
+
+	RunNoiseGridRange(numTiles, jobSystem, [&](int startTile, int endTile)
+	{
+		std::vector<float> tileTotals(static_cast<size_t>(rowsPerTile) * rowLength);
+		for (int tileIndex = startTile; tileIndex < endTile; ++tileIndex)
+		{
+			int firstRow = tileIndex * rowsPerTile;
+			int numTileRows = std::min(rowsPerTile, numRows - firstRow);
+			std::fill(tileTotals.begin(), tileTotals.end(), 0.f);
+			for (unsigned int octaveNum = 0; octaveNum < numOctaves; ++octaveNum)
+			{
+				for (int tileRow = 0; tileRow < numTileRows; ++tileRow)
+				{
+					addOctaveRow(&tileTotals[tileRow * rowLength], firstRow + tileRow, octaveNum, seed + octaveNum, amplitudes[octaveNum]);
+				}
+			}
+
+			// Re-normalize exactly as the single-sample functions do
+			if (renormalize && totalAmplitude > 0.f)
+			{
+				SIMDFloatWide totalAmplitudes = SIMDSplatWide(totalAmplitude);
+				SIMDFloatWide half = SIMDSplatWide(0.5f);
+				SIMDFloatWide two = SIMDSplatWide(2.0f);
+				SIMDFloatWide one = SIMDSplatWide(1.f);
+				for (int sampleIndex = 0; sampleIndex < numTileRows * rowLength; sampleIndex += SIMD_WIDE_NUM_LANES)
+				{
+					SIMDFloatWide totalNoise = SIMDDivide(SIMDLoadWide(&tileTotals[sampleIndex]), totalAmplitudes);
+					totalNoise = SIMDAdd(SIMDMultiply(totalNoise, half), half);
+					totalNoise = SmoothStep3Wide(totalNoise);
+					totalNoise = SIMDSubtract(SIMDMultiply(totalNoise, two), one);
+					SIMDStoreWide(&tileTotals[sampleIndex], totalNoise);
+				}
+			}
+
+			for (int tileRow = 0; tileRow < numTileRows; ++tileRow)
+			{
+				float const* rowTotals = &tileTotals[tileRow * rowLength];
+				std::copy(rowTotals, rowTotals + axisX.m_numSamples, out_noiseValues + static_cast<size_t>(firstRow + tileRow) * axisX.m_numSamples);
+			}
+		}
+	});
+}
+#endif
+
+
+//-----------------------------------------------------------------------------------------------
+// Builds the x axis padded to whole SIMD rows, or fills the grid sample by sample where the build
+//	has no wide integer lanes to hash with
+//
+static int GetNoiseGridPaddedRowLength(int numSamplesX)
+{
+#if defined( ENGINE_SIMD_WIDE_INT )
+	return ((numSamplesX + SIMD_WIDE_NUM_LANES - 1) / SIMD_WIDE_NUM_LANES) * SIMD_WIDE_NUM_LANES;
+#else
+	return numSamplesX;
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Compute2dFractalNoiseGrid(float* out_noiseValues, int numSamplesX, int numSamplesY, Vec2 const& gridOrigin, float sampleSpacing, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed, JobSystem* jobSystem)
+{
+	if (numSamplesX <= 0 || numSamplesY <= 0)
+	{
+		return;
+	}
+#if defined( ENGINE_SIMD_WIDE_INT )
+	NoiseGridAxis axisX;
+	NoiseGridAxis axisY;
+	BuildNoiseGridAxis(axisX, numSamplesX, GetNoiseGridPaddedRowLength(numSamplesX), gridOrigin.x, sampleSpacing, scale, numOctaves, octaveScale);
+	BuildNoiseGridAxis(axisY, numSamplesY, numSamplesY, gridOrigin.y, sampleSpacing, scale, numOctaves, octaveScale);
+	FillNoiseGrid(out_noiseValues, axisX, numSamplesY, numOctaves, octavePersistence, renormalize, seed, jobSystem,
+		[&](float* rowTotals, int rowIndex, unsigned int octaveNum, unsigned int octaveSeed, float amplitude)
+		{
+			Add2dFractalNoiseOctaveRow(rowTotals, axisX, axisY, rowIndex, octaveNum, octaveSeed, amplitude);
+		});
+#else
+	RunNoiseGridRange(numSamplesY, jobSystem, [&](int startRow, int endRow)
+	{
+		for (int sampleY = startRow; sampleY < endRow; ++sampleY)
+		{
+			float posY = gridOrigin.y + static_cast<float>(sampleY) * sampleSpacing;
+			for (int sampleX = 0; sampleX < numSamplesX; ++sampleX)
+			{
+				float posX = gridOrigin.x + static_cast<float>(sampleX) * sampleSpacing;
+				out_noiseValues[sampleY * numSamplesX + sampleX] = Compute2dFractalNoise(posX, posY, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed);
+			}
+		}
+	});
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Compute3dFractalNoiseGrid(float* out_noiseValues, int numSamplesX, int numSamplesY, int numSamplesZ, Vec3 const& gridOrigin, float sampleSpacing, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed, JobSystem* jobSystem)
+{
+	if (numSamplesX <= 0 || numSamplesY <= 0 || numSamplesZ <= 0)
+	{
+		return;
+	}
+#if defined( ENGINE_SIMD_WIDE_INT )
+	NoiseGridAxis axisX;
+	NoiseGridAxis axisY;
+	NoiseGridAxis axisZ;
+	BuildNoiseGridAxis(axisX, numSamplesX, GetNoiseGridPaddedRowLength(numSamplesX), gridOrigin.x, sampleSpacing, scale, numOctaves, octaveScale);
+	BuildNoiseGridAxis(axisY, numSamplesY, numSamplesY, gridOrigin.y, sampleSpacing, scale, numOctaves, octaveScale);
+	BuildNoiseGridAxis(axisZ, numSamplesZ, numSamplesZ, gridOrigin.z, sampleSpacing, scale, numOctaves, octaveScale);
+	FillNoiseGrid(out_noiseValues, axisX, numSamplesY * numSamplesZ, numOctaves, octavePersistence, renormalize, seed, jobSystem,
+		[&](float* rowTotals, int rowIndex, unsigned int octaveNum, unsigned int octaveSeed, float amplitude)
+		{
+			Add3dFractalNoiseOctaveRow(rowTotals, axisX, axisY, rowIndex % numSamplesY, axisZ, rowIndex / numSamplesY, octaveNum, octaveSeed, amplitude);
+		});
+#else
+	RunNoiseGridRange(numSamplesY * numSamplesZ, jobSystem, [&](int startRow, int endRow)
+	{
+		for (int rowIndex = startRow; rowIndex < endRow; ++rowIndex)
+		{
+			float posY = gridOrigin.y + static_cast<float>(rowIndex % numSamplesY) * sampleSpacing;
+			float posZ = gridOrigin.z + static_cast<float>(rowIndex / numSamplesY) * sampleSpacing;
+			for (int sampleX = 0; sampleX < numSamplesX; ++sampleX)
+			{
+				float posX = gridOrigin.x + static_cast<float>(sampleX) * sampleSpacing;
+				out_noiseValues[rowIndex * numSamplesX + sampleX] = Compute3dFractalNoise(posX, posY, posZ, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed);
+			}
+		}
+	});
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Compute2dPerlinNoiseGrid(float* out_noiseValues, int numSamplesX, int numSamplesY, Vec2 const& gridOrigin, float sampleSpacing, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed, JobSystem* jobSystem)
+{
+	if (numSamplesX <= 0 || numSamplesY <= 0)
+	{
+		return;
+	}
+#if defined( ENGINE_SIMD_WIDE_INT )
+	NoiseGridAxis axisX;
+	NoiseGridAxis axisY;
+	BuildNoiseGridAxis(axisX, numSamplesX, GetNoiseGridPaddedRowLength(numSamplesX), gridOrigin.x, sampleSpacing, scale, numOctaves, octaveScale);
+	BuildNoiseGridAxis(axisY, numSamplesY, numSamplesY, gridOrigin.y, sampleSpacing, scale, numOctaves, octaveScale);
+	FillNoiseGrid(out_noiseValues, axisX, numSamplesY, numOctaves, octavePersistence, renormalize, seed, jobSystem,
+		[&](float* rowTotals, int rowIndex, unsigned int octaveNum, unsigned int octaveSeed, float amplitude)
+		{
+			Add2dPerlinNoiseOctaveRow(rowTotals, axisX, axisY, rowIndex, octaveNum, octaveSeed, amplitude);
+		});
+#else
+	RunNoiseGridRange(numSamplesY, jobSystem, [&](int startRow, int endRow)
+	{
+		for (int sampleY = startRow; sampleY < endRow; ++sampleY)
+		{
+			float posY = gridOrigin.y + static_cast<float>(sampleY) * sampleSpacing;
+			for (int sampleX = 0; sampleX < numSamplesX; ++sampleX)
+			{
+				float posX = gridOrigin.x + static_cast<float>(sampleX) * sampleSpacing;
+				out_noiseValues[sampleY * numSamplesX + sampleX] = Compute2dPerlinNoise(posX, posY, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed);
+			}
+		}
+	});
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+void Compute3dPerlinNoiseGrid(float* out_noiseValues, int numSamplesX, int numSamplesY, int numSamplesZ, Vec3 const& gridOrigin, float sampleSpacing, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed, JobSystem* jobSystem)
+{
+	if (numSamplesX <= 0 || numSamplesY <= 0 || numSamplesZ <= 0)
+	{
+		return;
+	}
+#if defined( ENGINE_SIMD_WIDE_INT )
+	NoiseGridAxis axisX;
+	NoiseGridAxis axisY;
+	NoiseGridAxis axisZ;
+	BuildNoiseGridAxis(axisX, numSamplesX, GetNoiseGridPaddedRowLength(numSamplesX), gridOrigin.x, sampleSpacing, scale, numOctaves, octaveScale);
+	BuildNoiseGridAxis(axisY, numSamplesY, numSamplesY, gridOrigin.y, sampleSpacing, scale, numOctaves, octaveScale);
+	BuildNoiseGridAxis(axisZ, numSamplesZ, numSamplesZ, gridOrigin.z, sampleSpacing, scale, numOctaves, octaveScale);
+	FillNoiseGrid(out_noiseValues, axisX, numSamplesY * numSamplesZ, numOctaves, octavePersistence, renormalize, seed, jobSystem,
+		[&](float* rowTotals, int rowIndex, unsigned int octaveNum, unsigned int octaveSeed, float amplitude)
+		{
+			Add3dPerlinNoiseOctaveRow(rowTotals, axisX, axisY, rowIndex % numSamplesY, axisZ, rowIndex / numSamplesY, octaveNum, octaveSeed, amplitude);
+		});
+#else
+	RunNoiseGridRange(numSamplesY * numSamplesZ, jobSystem, [&](int startRow, int endRow)
+	{
+		for (int rowIndex = startRow; rowIndex < endRow; ++rowIndex)
+		{
+			float posY = gridOrigin.y + static_cast<float>(rowIndex % numSamplesY) * sampleSpacing;
+			float posZ = gridOrigin.z + static_cast<float>(rowIndex / numSamplesY) * sampleSpacing;
+			for (int sampleX = 0; sampleX < numSamplesX; ++sampleX)
+			{
+				float posX = gridOrigin.x + static_cast<float>(sampleX) * sampleSpacing;
+				out_noiseValues[rowIndex * numSamplesX + sampleX] = Compute3dPerlinNoise(posX, posY, posZ, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed);
+			}
+		}
+	});
+#endif
+}
+
@@ -3,6 +3,10 @@
 //
 #pragma once
 
+struct Vec2;
+struct Vec3;
+class JobSystem;
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // Squirrel's Smooth Noise utilities (version 3)
 //
@@ -85,3 +89,20 @@ float Compute4dPerlinNoise(float posX, float posY, float posZ, float posT, float
 // #TODO: Implement simplex noise in 2D, 3D, 4D (1D simplex is identical to 1D Perlin, I think?)
 // #TODO: Test actual simplex noise implementation in 2D/3D to compare speeds (branches vs. ops!)
 //
+
+//-----------------------------------------------------------------------------------------------
+// Grid versions of the 2D and 3D functions above (random-access / deterministic)
+//
+// These fill <out_noiseValues> with one sample per point of a regular grid, x fastest, then y, then z.
+//	Sample (x,y,z) sits at ( gridOrigin.x + (float) x * sampleSpacing, ... ) and its value is bit-identical
+//	to the single-sample function called at that position, so grids and single samples can be mixed freely.
+//
+// Each axis only depends on its own coordinate, so every octave's lattice cells and weights are worked out
+//	once per grid column/row rather than per sample.  Samples then go octave by octave through tiles that
+//	stay in cache, hashing lattice points in SIMD lanes where the build has wide integer lanes.  Tiles are
+//	split across the job system when one is given.
+//
+void Compute2dFractalNoiseGrid(float* out_noiseValues, int numSamplesX, int numSamplesY, Vec2 const& gridOrigin, float sampleSpacing, float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0, JobSystem* jobSystem = nullptr);
+void Compute3dFractalNoiseGrid(float* out_noiseValues, int numSamplesX, int numSamplesY, int numSamplesZ, Vec3 const& gridOrigin, float sampleSpacing, float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0, JobSystem* jobSystem = nullptr);
+void Compute2dPerlinNoiseGrid(float* out_noiseValues, int numSamplesX, int numSamplesY, Vec2 const& gridOrigin, float sampleSpacing, float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0, JobSystem* jobSystem = nullptr);
+void Compute3dPerlinNoiseGrid(float* out_noiseValues, int numSamplesX, int numSamplesY, int numSamplesZ, Vec3 const& gridOrigin, float sampleSpacing, float scale = 1.f, unsigned int numOctaves = 1, float octavePersistence = 0.5f, float octaveScale = 2.f, bool renormalize = true, unsigned int seed = 0, JobSystem* jobSystem = nullptr);
@@ -0,0 +1,273 @@
+#include "Engine/Math/SpatialHashGrid2D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Core/EngineCommon.h"
+#include <algorithm>
+#include <cmath>
+// -----------------------------------------------------------------------------
+static bool DoBoundsOverlap(AABB2 const& boxA, AABB2 const& boxB)
+{
+	return boxA.m_mins.x <= boxB.m_maxs.x && boxA.m_maxs.x >= boxB.m_mins.x
+		&& boxA.m_mins.y <= boxB.m_maxs.y && boxA.m_maxs.y >= boxB.m_mins.y;
+}
+
+static AABB2 const GetDiscBounds(Vec2 const& discCenter, float discRadius)
+{
+	return AABB2(discCenter.x - discRadius, discCenter.y - discRadius, discCenter.x + discRadius, discCenter.y + discRadius);
+}
+// -----------------------------------------------------------------------------
+SpatialHashGrid2D::SpatialHashGrid2D(float cellSize)
+	:m_cellSize(cellSize),
+	 m_inverseCellSize(1.f / cellSize)
+{
+	GUARANTEE_OR_DIE(cellSize > 0.f, Stringf("SpatialHashGrid2D cell size must be positive, got %f", cellSize));
+}
+
+int SpatialHashGrid2D::Insert(AABB2 const& bounds)
+{
+	int handle = 0;
+	if (!m_freeHandles.empty())
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_entryBounds[handle] = bounds;
+		m_isEntryInUse[handle] = true;
+	}
+	else
+	{
+		handle = static_cast<int>(m_entryBounds.size());
+		m_entryBounds.push_back(bounds);
+		m_isEntryInUse.push_back(true);
+	}
+	++m_numEntries;
+	m_isDirty = true;
+	return handle;
+}
+
+int SpatialHashGrid2D::InsertDisc(Vec2 const& discCenter, float discRadius)
+{
+	return Insert(GetDiscBounds(discCenter, discRadius));
+}
+
+void SpatialHashGrid2D::Move(int handle, AABB2 const& newBounds)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("SpatialHashGrid2D::Move given invalid handle %d", handle));
+	m_entryBounds[handle] = newBounds;
+	m_isDirty = true;
+}
+
+void SpatialHashGrid2D::MoveDisc(int handle, Vec2 const& discCenter, float discRadius)
+{
+	Move(handle, GetDiscBounds(discCenter, discRadius));
+}
+
+void SpatialHashGrid2D::Remove(int handle)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("SpatialHashGrid2D::Remove given invalid handle %d", handle));
+	m_isEntryInUse[handle] = false;
+	m_freeHandles.push_back(handle);
+	--m_numEntries;
+	m_isDirty = true;
+}
+
+void SpatialHashGrid2D::Clear()
+{
+	m_entryBounds.clear();
+	m_isEntryInUse.clear();
+	m_freeHandles.clear();
+	m_numEntries = 0;
+	m_isDirty = true;
+}
+
+// Counting sort of every (bucket, entry) by bucket: one pass to count, a prefix sum, one pass to scatter
+void SpatialHashGrid2D::Rebuild()
+{
+	std::vector<IntVec2> cellCoords;
+	std::vector<int> cellHandles;
+	cellCoords.reserve(m_numEntries * 2);
+	cellHandles.reserve(m_numEntries * 2);
+
+	int numHandles = static_cast<int>(m_entryBounds.size());
+	for (int handle = 0; handle < numHandles; ++handle)
+	{
+		if (!m_isEntryInUse[handle])
+		{
+			continue;
+		}
+
+		AABB2 const& bounds = m_entryBounds[handle];
+		IntVec2 minCell = GetCellCoords(bounds.m_mins);
+		IntVec2 maxCell = GetCellCoords(bounds.m_maxs);
+		for (int cellY = minCell.y; cellY <= maxCell.y; ++cellY)
+		{
+			for (int cellX = minCell.x; cellX <= maxCell.x; ++cellX)
+			{
+				cellCoords.push_back(IntVec2(cellX, cellY));
+				cellHandles.push_back(handle);
+			}
+		}
+	}
+
+	int numCellEntries = static_cast<int>(cellHandles.size());
+	int numBuckets = 16;
+	while (numBuckets < numCellEntries * 2)
+	{
+		numBuckets *= 2;
+	}
+	m_bucketMask = numBuckets - 1;
+
+	// Hash cells to buckets, dropping an entry's repeats of a bucket its other cells already hashed to
+	std::vector<int> cellBuckets(numCellEntries);
+	int numKept = 0;
+	for (int cellEntryIndex = 0; cellEntryIndex < numCellEntries; )
+	{
+		int handle = cellHandles[cellEntryIndex];
+		int firstKept = numKept;
+		for (; cellEntryIndex < numCellEntries && cellHandles[cellEntryIndex] == handle; ++cellEntryIndex)
+		{
+			int bucketIndex = GetBucketIndex(cellCoords[cellEntryIndex]);
+			bool isRepeat = false;
+			for (int keptIndex = firstKept; keptIndex < numKept && !isRepeat; ++keptIndex)
+			{
+				isRepeat = cellBuckets[keptIndex] == bucketIndex;
+			}
+			if (!isRepeat)
+			{
+				cellBuckets[numKept] = bucketIndex;
+				cellHandles[numKept] = handle;
+				++numKept;
+			}
+		}
+	}
+
+	m_bucketStarts.assign(numBuckets + 1, 0);
+	for (int keptIndex = 0; keptIndex < numKept; ++keptIndex)
+	{
+		++m_bucketStarts[cellBuckets[keptIndex] + 1];
+	}
+	for (int bucketIndex = 0; bucketIndex < numBuckets; ++bucketIndex)
+	{
+		m_bucketStarts[bucketIndex + 1] += m_bucketStarts[bucketIndex];
+	}
+
+	std::vector<int> writeIndices(m_bucketStarts.begin(), m_bucketStarts.end() - 1);
+	m_bucketHandles.resize(numKept);
+	m_bucketBounds.resize(numKept);
+	for (int keptIndex = 0; keptIndex < numKept; ++keptIndex)
+	{
+		int writeIndex = writeIndices[cellBuckets[keptIndex]]++;
+		m_bucketHandles[writeIndex] = cellHandles[keptIndex];
+		m_bucketBounds[writeIndex] = m_entryBounds[cellHandles[keptIndex]];
+	}
+	m_isDirty = false;
+}
+// -----------------------------------------------------------------------------
+// An overlapping entry is reported only from the cell holding the min corner of the overlap, which both lie in
+void SpatialHashGrid2D::GetEntriesOverlappingAABB2(AABB2 const& box, std::vector<int>& out_handles) const
+{
+	GuaranteeIsRebuilt();
+	IntVec2 minCell = GetCellCoords(box.m_mins);
+	IntVec2 maxCell = GetCellCoords(box.m_maxs);
+	for (int cellY = minCell.y; cellY <= maxCell.y; ++cellY)
+	{
+		for (int cellX = minCell.x; cellX <= maxCell.x; ++cellX)
+		{
+			int bucketIndex = GetBucketIndex(IntVec2(cellX, cellY));
+			for (int entryIndex = m_bucketStarts[bucketIndex]; entryIndex < m_bucketStarts[bucketIndex + 1]; ++entryIndex)
+			{
+				AABB2 const& bounds = m_bucketBounds[entryIndex];
+				if (!DoBoundsOverlap(bounds, box))
+				{
+					continue;
+				}
+
+				IntVec2 overlapCell = GetCellCoords(Vec2(std::max(bounds.m_mins.x, box.m_mins.x), std::max(bounds.m_mins.y, box.m_mins.y)));
+				if (overlapCell.x == cellX && overlapCell.y == cellY)
+				{
+					out_handles.push_back(m_bucketHandles[entryIndex]);
+				}
+			}
+		}
+	}
+}
+
+void SpatialHashGrid2D::GetEntriesOverlappingDisc(Vec2 const& discCenter, float discRadius, std::vector<int>& out_handles) const
+{
+	int firstCandidate = static_cast<int>(out_handles.size());
+	GetEntriesOverlappingAABB2(GetDiscBounds(discCenter, discRadius), out_handles);
+
+	int numKept = firstCandidate;
+	for (int candidateIndex = firstCandidate; candidateIndex < static_cast<int>(out_handles.size()); ++candidateIndex)
+	{
+		int handle = out_handles[candidateIndex];
+		if (DoDiscsOverlapAABB2D(discCenter, discRadius, m_entryBounds[handle]))
+		{
+			out_handles[numKept++] = handle;
+		}
+	}
+	out_handles.resize(numKept);
+}
+
+// Pairs come from the bucket of the cell holding the min corner of their overlap, so each shows up once
+void SpatialHashGrid2D::GetOverlappingPairs(std::vector<SpatialHashPair2D>& out_pairs) const
+{
+	GuaranteeIsRebuilt();
+	int numBuckets = m_bucketMask + 1;
+	for (int bucketIndex = 0; bucketIndex < numBuckets; ++bucketIndex)
+	{
+		int bucketEnd = m_bucketStarts[bucketIndex + 1];
+		for (int entryIndexA = m_bucketStarts[bucketIndex]; entryIndexA < bucketEnd; ++entryIndexA)
+		{
+			AABB2 const& boundsA = m_bucketBounds[entryIndexA];
+			for (int entryIndexB = entryIndexA + 1; entryIndexB < bucketEnd; ++entryIndexB)
+			{
+				AABB2 const& boundsB = m_bucketBounds[entryIndexB];
+				if (!DoBoundsOverlap(boundsA, boundsB))
+				{
+					continue;
+				}
+
+				IntVec2 overlapCell = GetCellCoords(Vec2(std::max(boundsA.m_mins.x, boundsB.m_mins.x), std::max(boundsA.m_mins.y, boundsB.m_mins.y)));
+				if (GetBucketIndex(overlapCell) != bucketIndex)
+				{
+					continue;
+				}
+
+				SpatialHashPair2D pair;
+				pair.m_handleA = std::min(m_bucketHandles[entryIndexA], m_bucketHandles[entryIndexB]);
+				pair.m_handleB = std::max(m_bucketHandles[entryIndexA], m_bucketHandles[entryIndexB]);
+				out_pairs.push_back(pair);
+			}
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+IntVec2 SpatialHashGrid2D::GetCellCoords(Vec2 const& position) const
+{
+	return IntVec2(static_cast<int>(floorf(position.x * m_inverseCellSize)), static_cast<int>(floorf(position.y * m_inverseCellSize)));
+}
+
+AABB2 const& SpatialHashGrid2D::GetEntryBounds(int handle) const
+{
+	return m_entryBounds[handle];
+}
+
+bool SpatialHashGrid2D::IsValidHandle(int handle) const
+{
+	return handle >= 0 && handle < static_cast<int>(m_entryBounds.size()) && m_isEntryInUse[handle];
+}
+
+int SpatialHashGrid2D::GetNumEntries() const
+{
+	return m_numEntries;
+}
+
+int SpatialHashGrid2D::GetBucketIndex(IntVec2 const& cellCoords) const
+{
+	unsigned int hash = (static_cast<unsigned int>(cellCoords.x) * 73856093u) ^ (static_cast<unsigned int>(cellCoords.y) * 19349663u);
+	return static_cast<int>(hash & static_cast<unsigned int>(m_bucketMask));
+}
+
+void SpatialHashGrid2D::GuaranteeIsRebuilt() const
+{
+	GUARANTEE_OR_DIE(!m_isDirty && !m_bucketStarts.empty(), "SpatialHashGrid2D queried before Rebuild was called for its latest changes");
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "Engine/Math/AABB2.h"
+#include "Engine/Math/IntVec2.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+struct SpatialHashPair2D
+{
+	int m_handleA = -1;		// Always the lower of the two handles
+	int m_handleB = -1;
+};
+// -----------------------------------------------------------------------------
+// Uniform grid broad phase for 2D discs and boxes. Entries live in every IntVec2 cell their bounds touch, and the
+// cells are hashed into buckets that Rebuild counting sorts into one compact array, so a frame costs O(n) to rebuild
+// and queries walk contiguous memory.
+//
+// Insert, Move and Remove only record the change; call Rebuild once they are done for the frame and before querying.
+// Queries and pairs report entries whose bounds overlap, exact disc tests (DoDiscsOverlap and friends) are up to
+// the caller. Every entry and pair is reported once however many cells it spans.
+class SpatialHashGrid2D
+{
+public:
+	explicit SpatialHashGrid2D(float cellSize = 1.f); // Roughly the size of a typical entry works best
+	~SpatialHashGrid2D() = default;
+
+	int	 Insert(AABB2 const& bounds); // Returns the entry's handle, handles of removed entries are reused
+	int	 InsertDisc(Vec2 const& discCenter, float discRadius);
+	void Move(int handle, AABB2 const& newBounds);
+	void MoveDisc(int handle, Vec2 const& discCenter, float discRadius);
+	void Remove(int handle);
+	void Clear();
+	void Rebuild();
+
+	// Append handles to out_handles
+	void GetEntriesOverlappingAABB2(AABB2 const& box, std::vector<int>& out_handles) const;
+	void GetEntriesOverlappingDisc(Vec2 const& discCenter, float discRadius, std::vector<int>& out_handles) const;
+	void GetOverlappingPairs(std::vector<SpatialHashPair2D>& out_pairs) const;
+
+	IntVec2		 GetCellCoords(Vec2 const& position) const;
+	AABB2 const& GetEntryBounds(int handle) const;
+	bool		 IsValidHandle(int handle) const;
+	int			 GetNumEntries() const;
+
+private:
+	int	 GetBucketIndex(IntVec2 const& cellCoords) const;
+	void GuaranteeIsRebuilt() const;
+
+private:
+	float				m_cellSize = 1.f;
+	float				m_inverseCellSize = 1.f;
+	std::vector<AABB2>	m_entryBounds;			// By handle
+	std::vector<bool>	m_isEntryInUse;
+	std::vector<int>	m_freeHandles;
+	int					m_numEntries = 0;
+	bool				m_isDirty = false;
+
+	// Rebuilt by Rebuild, bucket b's entries are [m_bucketStarts[b], m_bucketStarts[b + 1])
+	int					m_bucketMask = 0;
+	std::vector<int>	m_bucketStarts;
+	std::vector<int>	m_bucketHandles;
+	std::vector<AABB2>	m_bucketBounds;			// Copy of each bucket entry's bounds so the query loops stay in one array
+};
@@ -0,0 +1,13 @@
+#include "Engine/Math/Sphere3.hpp"
+#include "Engine/Math/MathUtils.h"
+
+Sphere3::Sphere3(Vec3 const& center, float radius)
+	:m_center(center),
+	 m_radius(radius)
+{
+}
+
+bool Sphere3::IsPointInside(Vec3 const& point) const
+{
+	return IsPointInsideSphere3D(point, m_center, m_radius);
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "Engine/Math/Vec3.h"
+// -----------------------------------------------------------------------------
+struct Sphere3
+{
+public:
+	Vec3 m_center = Vec3::ZERO;
+	float m_radius = 0.0f;
+
+public:
+	Sphere3() = default;
+	~Sphere3() = default;
+	Sphere3(Sphere3 const& copyFrom) = default;
+	explicit Sphere3(Vec3 const& center, float radius);
+// -----------------------------------------------------------------------------
+	bool IsPointInside(Vec3 const& point) const;
+};
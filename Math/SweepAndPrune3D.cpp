@@ -0,0 +1,387 @@
+#include "Engine/Math/SweepAndPrune3D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/SIMDMath.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include <algorithm>
+#include <cfloat>
+// -----------------------------------------------------------------------------
+constexpr int SWEEP_AND_PRUNE_MAX_INSERTION_SORTED = 64;	// More new bodies than this in one Update and a full sort is cheaper
+constexpr float SWEEP_AND_PRUNE_AXIS_SWITCH_RATIO = 2.f;	// Another axis needs this much more center variance to take over the sweep
+constexpr int SWEEP_AND_PRUNE_PADDING = 8;					// At least SIMD_WIDE_NUM_LANES
+constexpr int SWEEP_AND_PRUNE_PROXIES_PER_JOB = 4096;
+// -----------------------------------------------------------------------------
+static float GetBoundsMin(AABB3 const& bounds, int axis)
+{
+	return axis == 0 ? bounds.m_mins.x : (axis == 1 ? bounds.m_mins.y : bounds.m_mins.z);
+}
+
+static float GetBoundsMax(AABB3 const& bounds, int axis)
+{
+	return axis == 0 ? bounds.m_maxs.x : (axis == 1 ? bounds.m_maxs.y : bounds.m_maxs.z);
+}
+
+static AABB3 const GetZCylinderBounds(Vec3 const& cylinderStart, float cylinderRadius, float cylinderHeight)
+{
+	return AABB3(cylinderStart.x - cylinderRadius, cylinderStart.y - cylinderRadius, cylinderStart.z,
+		cylinderStart.x + cylinderRadius, cylinderStart.y + cylinderRadius, cylinderStart.z + cylinderHeight);
+}
+
+static unsigned long long GetPairKey(SweepAndPrunePair const& pair)
+{
+	return (static_cast<unsigned long long>(pair.m_handleA) << 32) | static_cast<unsigned long long>(pair.m_handleB);
+}
+
+static bool IsPairLess(SweepAndPrunePair const& pairA, SweepAndPrunePair const& pairB)
+{
+	return GetPairKey(pairA) < GetPairKey(pairB);
+}
+// -----------------------------------------------------------------------------
+int SweepAndPrune3D::Insert(AABB3 const& bounds)
+{
+	int handle = 0;
+	if (!m_freeHandles.empty())
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+		m_bodyBounds[handle] = bounds;
+		m_isBodyInUse[handle] = true;
+	}
+	else
+	{
+		handle = static_cast<int>(m_bodyBounds.size());
+		m_bodyBounds.push_back(bounds);
+		m_isBodyInUse.push_back(true);
+	}
+	m_insertedHandles.push_back(handle);
+	++m_numBodies;
+	return handle;
+}
+
+int SweepAndPrune3D::InsertZCylinder(Vec3 const& cylinderStart, float cylinderRadius, float cylinderHeight)
+{
+	return Insert(GetZCylinderBounds(cylinderStart, cylinderRadius, cylinderHeight));
+}
+
+void SweepAndPrune3D::Move(int handle, AABB3 const& newBounds)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("SweepAndPrune3D::Move given invalid handle %d", handle));
+	m_bodyBounds[handle] = newBounds;
+}
+
+void SweepAndPrune3D::MoveZCylinder(int handle, Vec3 const& cylinderStart, float cylinderRadius, float cylinderHeight)
+{
+	Move(handle, GetZCylinderBounds(cylinderStart, cylinderRadius, cylinderHeight));
+}
+
+void SweepAndPrune3D::Remove(int handle)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("SweepAndPrune3D::Remove given invalid handle %d", handle));
+	m_isBodyInUse[handle] = false;
+	m_removedHandles.push_back(handle);
+	--m_numBodies;
+}
+
+void SweepAndPrune3D::Clear()
+{
+	m_bodyBounds.clear();
+	m_isBodyInUse.clear();
+	m_freeHandles.clear();
+	m_insertedHandles.clear();
+	m_removedHandles.clear();
+	m_numBodies = 0;
+	m_proxies.clear();
+	m_pairs.clear();
+	m_foundPairs.clear();
+	m_jobFoundPairs.clear();
+}
+
+void SweepAndPrune3D::Update(JobSystem* jobSystem)
+{
+	// Refresh the sorted proxies in place, dropping removed bodies and appending new ones. The same pass sums the
+	// body centers for ChooseSweepAxis, so the proxies are only read once before sorting.
+	int sweepAxis = m_sweepAxis;
+	Vec3 centerSum;
+	Vec3 centerSquaredSum;
+	int numProxies = 0;
+	for (int proxyIndex = 0; proxyIndex < static_cast<int>(m_proxies.size()); ++proxyIndex)
+	{
+		int handle = m_proxies[proxyIndex].m_handle;
+		if (m_isBodyInUse[handle])
+		{
+			AABB3 const& bounds = m_bodyBounds[handle];
+			SweepAndPruneProxy& proxy = m_proxies[numProxies];
+			proxy.m_bounds = bounds;
+			proxy.m_handle = handle;
+			proxy.m_sweepMin = GetBoundsMin(bounds, sweepAxis);
+			Vec3 center = (bounds.m_mins + bounds.m_maxs) * 0.5f;
+			centerSum += center;
+			centerSquaredSum += center * center;
+			++numProxies;
+		}
+	}
+	m_proxies.resize(numProxies);
+	int numInserted = 0;
+	for (int insertedIndex = 0; insertedIndex < static_cast<int>(m_insertedHandles.size()); ++insertedIndex)
+	{
+		int handle = m_insertedHandles[insertedIndex];
+		if (m_isBodyInUse[handle])
+		{
+			AABB3 const& bounds = m_bodyBounds[handle];
+			m_proxies.push_back(SweepAndPruneProxy{ bounds, handle, GetBoundsMin(bounds, sweepAxis) });
+			Vec3 center = (bounds.m_mins + bounds.m_maxs) * 0.5f;
+			centerSum += center;
+			centerSquaredSum += center * center;
+			++numInserted;
+		}
+	}
+	m_insertedHandles.clear();
+	numProxies = static_cast<int>(m_proxies.size());
+
+	// Last frame's order is nearly right, so insertion sort only moves the bodies that passed each other
+	if (ChooseSweepAxis(centerSum, centerSquaredSum) || numInserted > SWEEP_AND_PRUNE_MAX_INSERTION_SORTED)
+	{
+		sweepAxis = m_sweepAxis;
+		for (SweepAndPruneProxy& proxy : m_proxies)
+		{
+			proxy.m_sweepMin = GetBoundsMin(proxy.m_bounds, sweepAxis);
+		}
+		std::sort(m_proxies.begin(), m_proxies.end(), [](SweepAndPruneProxy const& proxyA, SweepAndPruneProxy const& proxyB)
+		{
+			return proxyA.m_sweepMin < proxyB.m_sweepMin;
+		});
+	}
+	else
+	{
+		for (int proxyIndex = 1; proxyIndex < static_cast<int>(m_proxies.size()); ++proxyIndex)
+		{
+			float proxyMin = m_proxies[proxyIndex].m_sweepMin;
+			int insertIndex = proxyIndex;
+			while (insertIndex > 0 && m_proxies[insertIndex - 1].m_sweepMin > proxyMin)
+			{
+				--insertIndex;
+			}
+			if (insertIndex != proxyIndex)
+			{
+				SweepAndPruneProxy movingProxy = m_proxies[proxyIndex];
+				std::copy_backward(m_proxies.begin() + insertIndex, m_proxies.begin() + proxyIndex, m_proxies.begin() + proxyIndex + 1);
+				m_proxies[insertIndex] = movingProxy;
+			}
+		}
+	}
+
+	FillSweepArrays();
+	m_foundPairs.clear();
+	if (jobSystem != nullptr && numProxies > SWEEP_AND_PRUNE_PROXIES_PER_JOB)
+	{
+		// Each job sweeps its own run of proxies into its own list, so the lists only need joining before the sort
+		int numJobs = (numProxies + SWEEP_AND_PRUNE_PROXIES_PER_JOB - 1) / SWEEP_AND_PRUNE_PROXIES_PER_JOB;
+		m_jobFoundPairs.resize(numJobs);
+		jobSystem->ExecuteParallelFor(numJobs, 1, [&](int startJob, int endJob)
+		{
+			for (int jobIndex = startJob; jobIndex < endJob; ++jobIndex)
+			{
+				m_jobFoundPairs[jobIndex].clear();
+				int startProxy = jobIndex * SWEEP_AND_PRUNE_PROXIES_PER_JOB;
+				SweepForPairs(startProxy, std::min(startProxy + SWEEP_AND_PRUNE_PROXIES_PER_JOB, numProxies), m_jobFoundPairs[jobIndex]);
+			}
+		});
+		for (std::vector<SweepAndPrunePair> const& jobPairs : m_jobFoundPairs)
+		{
+			m_foundPairs.insert(m_foundPairs.end(), jobPairs.begin(), jobPairs.end());
+		}
+	}
+	else
+	{
+		SweepForPairs(0, numProxies, m_foundPairs);
+	}
+	std::sort(m_foundPairs.begin(), m_foundPairs.end(), IsPairLess);
+	ReportPairChanges();
+	m_pairs.swap(m_foundPairs);
+
+	m_freeHandles.insert(m_freeHandles.end(), m_removedHandles.begin(), m_removedHandles.end());
+	m_removedHandles.clear();
+}
+
+void SweepAndPrune3D::SetPairCallbacks(SweepAndPrunePairCallback const& onPairAdded, SweepAndPrunePairCallback const& onPairRemoved)
+{
+	m_onPairAdded = onPairAdded;
+	m_onPairRemoved = onPairRemoved;
+}
+// -----------------------------------------------------------------------------
+std::vector<SweepAndPrunePair> const& SweepAndPrune3D::GetOverlappingPairs() const
+{
+	return m_pairs;
+}
+
+bool SweepAndPrune3D::AreOverlapping(int handleA, int handleB) const
+{
+	SweepAndPrunePair pair{ std::min(handleA, handleB), std::max(handleA, handleB) };
+	return std::binary_search(m_pairs.begin(), m_pairs.end(), pair, IsPairLess);
+}
+
+AABB3 const& SweepAndPrune3D::GetBodyBounds(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("SweepAndPrune3D::GetBodyBounds given invalid handle %d", handle));
+	return m_bodyBounds[handle];
+}
+
+bool SweepAndPrune3D::IsValidHandle(int handle) const
+{
+	return handle >= 0 && handle < static_cast<int>(m_isBodyInUse.size()) && m_isBodyInUse[handle];
+}
+
+int SweepAndPrune3D::GetNumBodies() const
+{
+	return m_numBodies;
+}
+
+int SweepAndPrune3D::GetSweepAxis() const
+{
+	return m_sweepAxis;
+}
+// -----------------------------------------------------------------------------
+// Takes the sums of the proxies' centers and squared centers, returns true when the axis changed and the proxies need a full sort
+bool SweepAndPrune3D::ChooseSweepAxis(Vec3 const& centerSum, Vec3 const& centerSquaredSum)
+{
+	int numProxies = static_cast<int>(m_proxies.size());
+	if (numProxies < 2)
+	{
+		return false;
+	}
+
+	float inverseNumProxies = 1.f / static_cast<float>(numProxies);
+	Vec3 centerMean = centerSum * inverseNumProxies;
+	Vec3 centerVariance = centerSquaredSum * inverseNumProxies - centerMean * centerMean;
+	float axisVariances[3] = { centerVariance.x, centerVariance.y, centerVariance.z };
+
+	int widestAxis = 0;
+	for (int axis = 1; axis < 3; ++axis)
+	{
+		if (axisVariances[axis] > axisVariances[widestAxis])
+		{
+			widestAxis = axis;
+		}
+	}
+	if (widestAxis == m_sweepAxis || axisVariances[widestAxis] < axisVariances[m_sweepAxis] * SWEEP_AND_PRUNE_AXIS_SWITCH_RATIO)
+	{
+		return false;
+	}
+	m_sweepAxis = widestAxis;
+	return true;
+}
+
+// Copies the sorted proxies' bounds into per axis arrays so the sweep's inner loop tests SIMD_WIDE_NUM_LANES bodies at a time
+void SweepAndPrune3D::FillSweepArrays()
+{
+	int numProxies = static_cast<int>(m_proxies.size());
+	int otherAxisB = (m_sweepAxis + 1) % 3;
+	int otherAxisC = (m_sweepAxis + 2) % 3;
+	for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+	{
+		// Padding bounds never start or overlap, so full loads past the last proxy are harmless
+		int axis = axisIndex == 0 ? m_sweepAxis : (axisIndex == 1 ? otherAxisB : otherAxisC);
+		m_sweepMins[axisIndex].resize(numProxies + SWEEP_AND_PRUNE_PADDING, FLT_MAX);
+		m_sweepMaxs[axisIndex].resize(numProxies + SWEEP_AND_PRUNE_PADDING, -FLT_MAX);
+		for (int proxyIndex = 0; proxyIndex < numProxies; ++proxyIndex)
+		{
+			m_sweepMins[axisIndex][proxyIndex] = axisIndex == 0 ? m_proxies[proxyIndex].m_sweepMin : GetBoundsMin(m_proxies[proxyIndex].m_bounds, axis);
+			m_sweepMaxs[axisIndex][proxyIndex] = GetBoundsMax(m_proxies[proxyIndex].m_bounds, axis);
+		}
+		std::fill(m_sweepMins[axisIndex].begin() + numProxies, m_sweepMins[axisIndex].end(), FLT_MAX);
+		std::fill(m_sweepMaxs[axisIndex].begin() + numProxies, m_sweepMaxs[axisIndex].end(), -FLT_MAX);
+	}
+}
+
+// Each body only meets the bodies whose min on the sweep axis lies within its own extent, all later in sorted order
+void SweepAndPrune3D::SweepForPairs(int startProxy, int endProxy, std::vector<SweepAndPrunePair>& out_pairs) const
+{
+	int numProxies = static_cast<int>(m_proxies.size());
+	float const* sweepMins = m_sweepMins[0].data();
+	float const* minsB = m_sweepMins[1].data();
+	float const* maxsB = m_sweepMaxs[1].data();
+	float const* minsC = m_sweepMins[2].data();
+	float const* maxsC = m_sweepMaxs[2].data();
+	for (int proxyIndex = startProxy; proxyIndex < endProxy; ++proxyIndex)
+	{
+		int handle = m_proxies[proxyIndex].m_handle;
+		float proxyMax = m_sweepMaxs[0][proxyIndex];
+		float proxyMinB = minsB[proxyIndex];
+		float proxyMaxB = maxsB[proxyIndex];
+		float proxyMinC = minsC[proxyIndex];
+		float proxyMaxC = maxsC[proxyIndex];
+#if defined( ENGINE_SIMD_SCALAR )
+		for (int otherIndex = proxyIndex + 1; otherIndex < numProxies && sweepMins[otherIndex] <= proxyMax; ++otherIndex)
+		{
+			// Non short circuit &, the separate compares are close to coin flips and would mispredict as branches
+			bool doesOverlap = (minsB[otherIndex] <= proxyMaxB) & (maxsB[otherIndex] >= proxyMinB) & (minsC[otherIndex] <= proxyMaxC) & (maxsC[otherIndex] >= proxyMinC);
+			if (doesOverlap)
+			{
+				int otherHandle = m_proxies[otherIndex].m_handle;
+				out_pairs.push_back(SweepAndPrunePair{ std::min(handle, otherHandle), std::max(handle, otherHandle) });
+			}
+		}
+#else
+		SIMDFloatWide proxyMaxWide = SIMDSplatWide(proxyMax);
+		SIMDFloatWide proxyMinBWide = SIMDSplatWide(proxyMinB);
+		SIMDFloatWide proxyMaxBWide = SIMDSplatWide(proxyMaxB);
+		SIMDFloatWide proxyMinCWide = SIMDSplatWide(proxyMinC);
+		SIMDFloatWide proxyMaxCWide = SIMDSplatWide(proxyMaxC);
+		int allLanesBits = (1 << SIMD_WIDE_NUM_LANES) - 1;
+		for (int otherIndex = proxyIndex + 1; otherIndex < numProxies; otherIndex += SIMD_WIDE_NUM_LANES)
+		{
+			SIMDFloatWide hasStarted = SIMDLessEqual(SIMDLoadWide(sweepMins + otherIndex), proxyMaxWide);
+			SIMDFloatWide overlapsB = SIMDAnd(SIMDLessEqual(SIMDLoadWide(minsB + otherIndex), proxyMaxBWide), SIMDLessEqual(proxyMinBWide, SIMDLoadWide(maxsB + otherIndex)));
+			SIMDFloatWide overlapsC = SIMDAnd(SIMDLessEqual(SIMDLoadWide(minsC + otherIndex), proxyMaxCWide), SIMDLessEqual(proxyMinCWide, SIMDLoadWide(maxsC + otherIndex)));
+			int overlapBits = SIMDGetMaskBits(SIMDAnd(hasStarted, SIMDAnd(overlapsB, overlapsC)));
+			for (int laneIndex = 0; overlapBits != 0; ++laneIndex)
+			{
+				if (overlapBits & (1 << laneIndex))
+				{
+					int otherHandle = m_proxies[otherIndex + laneIndex].m_handle;
+					out_pairs.push_back(SweepAndPrunePair{ std::min(handle, otherHandle), std::max(handle, otherHandle) });
+					overlapBits &= ~(1 << laneIndex);
+				}
+			}
+
+			// Sorted by min, so once a lane has not started none of the later bodies have either
+			if (SIMDGetMaskBits(hasStarted) != allLanesBits)
+			{
+				break;
+			}
+		}
+#endif
+	}
+}
+
+// Both lists are sorted, so one merge pass finds the pairs only last Update had and the pairs only this one has
+void SweepAndPrune3D::ReportPairChanges() const
+{
+	size_t oldIndex = 0;
+	size_t newIndex = 0;
+	while (oldIndex < m_pairs.size() || newIndex < m_foundPairs.size())
+	{
+		if (newIndex == m_foundPairs.size() || (oldIndex < m_pairs.size() && IsPairLess(m_pairs[oldIndex], m_foundPairs[newIndex])))
+		{
+			if (m_onPairRemoved)
+			{
+				m_onPairRemoved(m_pairs[oldIndex].m_handleA, m_pairs[oldIndex].m_handleB);
+			}
+			++oldIndex;
+		}
+		else if (oldIndex == m_pairs.size() || IsPairLess(m_foundPairs[newIndex], m_pairs[oldIndex]))
+		{
+			if (m_onPairAdded)
+			{
+				m_onPairAdded(m_foundPairs[newIndex].m_handleA, m_foundPairs[newIndex].m_handleB);
+			}
+			++newIndex;
+		}
+		else
+		{
+			++oldIndex;
+			++newIndex;
+		}
+	}
+}
+// -----------------------------------------------------------------------------
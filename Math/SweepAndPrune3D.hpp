@@ -0,0 +1,79 @@
+#pragma once
+#include "Engine/Math/AABB3.hpp"
+#include <functional>
+#include <vector>
+// -----------------------------------------------------------------------------
+class JobSystem;
+// -----------------------------------------------------------------------------
+struct SweepAndPrunePair
+{
+	int m_handleA = -1;		// Always the lower of the two handles
+	int m_handleB = -1;
+};
+
+struct SweepAndPruneProxy
+{
+	AABB3 m_bounds;
+	int	  m_handle = -1;
+	float m_sweepMin = 0.f;	// m_bounds min on the sweep axis, the sort key
+};
+
+typedef std::function<void(int handleA, int handleB)> SweepAndPrunePairCallback;
+// -----------------------------------------------------------------------------
+// Sort and sweep broad phase for 3D boxes and z-cylinders with a persistent pair set. Bodies stay sorted by their min
+// on one sweep axis between frames, so Update's insertion sort only does the few swaps that frame's motion caused, and
+// the sweep tests each body against the bodies starting inside it on that axis. The sweep axis is whichever has the
+// widest spread of body centers, since the vertical axis of a level is usually too crowded to sweep.
+//
+// Insert, Move and Remove only record the change; call Update once they are done for the frame. Update fires the
+// added callback for pairs that started overlapping and the removed callback for pairs that stopped, or whose body
+// was removed, with the lower handle first. The pairs found each Update are sorted and merged against the last
+// Update's sorted list to find those changes. Pairs are bounds overlaps, touching bounds included; exact tests
+// (DoZCylindersOverlap3D and friends) are up to the caller.
+class SweepAndPrune3D
+{
+public:
+	SweepAndPrune3D() = default;
+	~SweepAndPrune3D() = default;
+
+	int	 Insert(AABB3 const& bounds); // Returns the body's handle, handles of removed bodies are reused after the next Update
+	int	 InsertZCylinder(Vec3 const& cylinderStart, float cylinderRadius, float cylinderHeight);
+	void Move(int handle, AABB3 const& newBounds);
+	void MoveZCylinder(int handle, Vec3 const& cylinderStart, float cylinderRadius, float cylinderHeight);
+	void Remove(int handle);
+	void Clear(); // No callbacks
+	void Update(JobSystem* jobSystem = nullptr); // The sweep is split across the job system when one is given
+
+	void SetPairCallbacks(SweepAndPrunePairCallback const& onPairAdded, SweepAndPrunePairCallback const& onPairRemoved);
+
+	std::vector<SweepAndPrunePair> const& GetOverlappingPairs() const; // As of the last Update, sorted by handle A then handle B
+	bool								  AreOverlapping(int handleA, int handleB) const;
+	AABB3 const&						  GetBodyBounds(int handle) const;
+	bool								  IsValidHandle(int handle) const;
+	int									  GetNumBodies() const;
+	int									  GetSweepAxis() const; // 0, 1 or 2 for x, y or z
+
+private:
+	bool ChooseSweepAxis(Vec3 const& centerSum, Vec3 const& centerSquaredSum);
+	void FillSweepArrays();
+	void SweepForPairs(int startProxy, int endProxy, std::vector<SweepAndPrunePair>& out_pairs) const;
+	void ReportPairChanges() const;
+
+private:
+	std::vector<AABB3>					m_bodyBounds;			// By handle
+	std::vector<bool>					m_isBodyInUse;
+	std::vector<int>					m_freeHandles;
+	std::vector<int>					m_insertedHandles;		// Not in m_proxies until the next Update
+	std::vector<int>					m_removedHandles;		// Freed by the next Update, once their pairs are reported removed
+	int									m_numBodies = 0;
+	int									m_sweepAxis = 0;
+	std::vector<SweepAndPruneProxy>		m_proxies;				// Sorted by bounds min on the sweep axis as of the last Update
+	std::vector<float>					m_sweepMins[3];			// Proxy bounds per axis in sorted order, the sweep axis first
+	std::vector<float>					m_sweepMaxs[3];
+
+	std::vector<SweepAndPrunePair>					m_pairs;				// Sorted by handles as of the last Update
+	std::vector<SweepAndPrunePair>					m_foundPairs;			// Filled by the sweep, then sorted and merged against m_pairs
+	std::vector<std::vector<SweepAndPrunePair>>		m_jobFoundPairs;		// Per job sweep results when Update is given a job system
+	SweepAndPrunePairCallback						m_onPairAdded;
+	SweepAndPrunePairCallback						m_onPairRemoved;
+};
@@ -0,0 +1,723 @@
+#include "Engine/Math/SweptCollision.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/SIMDMath.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+// -----------------------------------------------------------------------------
+// The cull slab grows each primitive a little past the radius, so rounding in the SIMD transform never rules out
+// a sphere the exact sweep would hit
+constexpr float SWEPT_BATCH_CULL_RADIUS_SCALE = 1.0001f;
+constexpr float SWEPT_BATCH_CULL_RADIUS_PADDING = 0.0001f;
+// -----------------------------------------------------------------------------
+SweptSphere3::SweptSphere3(Vec3 const& start, Vec3 const& displacement, float radius)
+	:m_start(start), m_displacement(displacement), m_radius(radius)
+{
+}
+// -----------------------------------------------------------------------------
+// 2D sweeps
+// -----------------------------------------------------------------------------
+// Fraction of the displacement at which a moving point enters a disc, 0 if it starts inside
+static bool GetSweptPointVsDiscFraction(Vec2 const& start, Vec2 const& displacement, Vec2 const& discCenter, float discRadius, float& out_fraction)
+{
+	Vec2 centerToStart = start - discCenter;
+	float startOutsideAmount = centerToStart.GetLengthSquared() - discRadius * discRadius;
+	if (startOutsideAmount <= 0.f)
+	{
+		out_fraction = 0.f;
+		return true;
+	}
+	float approach = DotProduct2D(centerToStart, displacement);
+	if (approach >= 0.f)
+	{
+		return false;
+	}
+	float displacementLengthSquared = displacement.GetLengthSquared();
+	float discriminant = approach * approach - displacementLengthSquared * startOutsideAmount;
+	if (discriminant < 0.f)
+	{
+		return false;
+	}
+
+	// The smaller root of the quadratic, in the form that does not cancel when the displacement is long
+	float fraction = startOutsideAmount / (-approach + sqrtf(discriminant));
+	if (fraction > 1.f)
+	{
+		return false;
+	}
+	out_fraction = fraction;
+	return true;
+}
+
+static SweptImpact2D MakeSweptImpact2D(Vec2 const& start, Vec2 const& displacement, float fraction, Vec2 const& impactPoint, Vec2 const& fallbackNormal)
+{
+	SweptImpact2D impact;
+	impact.m_didImpact = true;
+	impact.m_impactFraction = fraction;
+	impact.m_impactCenter = start + displacement * fraction;
+	impact.m_impactPoint = impactPoint;
+	Vec2 pointToCenter = impact.m_impactCenter - impactPoint;
+	float distance = pointToCenter.GetLength();
+	impact.m_impactNormal = distance > 0.f ? pointToCenter / distance : fallbackNormal;
+	return impact;
+}
+
+SweptImpact2D SweepDiscVsDisc2D(Vec2 const& discStart, Vec2 const& discDisplacement, float discRadius, Vec2 const& otherDiscStart, Vec2 const& otherDiscDisplacement, float otherDiscRadius)
+{
+	// In the other disc's frame it stands still and only the relative motion matters
+	Vec2 relativeDisplacement = discDisplacement - otherDiscDisplacement;
+	float fraction = 0.f;
+	if (!GetSweptPointVsDiscFraction(discStart - otherDiscStart, relativeDisplacement, Vec2::ZERO, discRadius + otherDiscRadius, fraction))
+	{
+		return SweptImpact2D();
+	}
+
+	Vec2 otherCenter = otherDiscStart + otherDiscDisplacement * fraction;
+	Vec2 discCenter = discStart + discDisplacement * fraction;
+	Vec2 otherToDisc = discCenter - otherCenter;
+	float distance = otherToDisc.GetLength();
+	Vec2 normal = distance > 0.f ? otherToDisc / distance : Vec2(1.f, 0.f);
+	return MakeSweptImpact2D(discStart, discDisplacement, fraction, otherCenter + normal * otherDiscRadius, normal);
+}
+
+SweptImpact2D SweepDiscVsAABB2D(Vec2 const& discStart, Vec2 const& discDisplacement, float discRadius, AABB2 const& box)
+{
+	Vec2 nearestPoint = box.GetNearestPoint(discStart);
+	if ((discStart - nearestPoint).GetLengthSquared() <= discRadius * discRadius)
+	{
+		if (nearestPoint != discStart)
+		{
+			return MakeSweptImpact2D(discStart, discDisplacement, 0.f, nearestPoint, Vec2(1.f, 0.f));
+		}
+
+		// Center inside the box, out through the nearest side
+		float sideDistances[4] = { discStart.x - box.m_mins.x, box.m_maxs.x - discStart.x, discStart.y - box.m_mins.y, box.m_maxs.y - discStart.y };
+		Vec2 const sideNormals[4] = { Vec2(-1.f, 0.f), Vec2(1.f, 0.f), Vec2(0.f, -1.f), Vec2(0.f, 1.f) };
+		int nearestSide = static_cast<int>(std::min_element(sideDistances, sideDistances + 4) - sideDistances);
+		return MakeSweptImpact2D(discStart, discDisplacement, 0.f, discStart - sideNormals[nearestSide] * sideDistances[nearestSide], sideNormals[nearestSide]);
+	}
+
+	// Slab entry into the box grown by the radius
+	float starts[2] = { discStart.x, discStart.y };
+	float displacements[2] = { discDisplacement.x, discDisplacement.y };
+	float mins[2] = { box.m_mins.x - discRadius, box.m_mins.y - discRadius };
+	float maxs[2] = { box.m_maxs.x + discRadius, box.m_maxs.y + discRadius };
+	float entryFraction = 0.f;
+	float exitFraction = 1.f;
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		if (displacements[axis] == 0.f)
+		{
+			if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+			{
+				return SweptImpact2D();
+			}
+			continue;
+		}
+		float inverseDisplacement = 1.f / displacements[axis];
+		float fractionA = (mins[axis] - starts[axis]) * inverseDisplacement;
+		float fractionB = (maxs[axis] - starts[axis]) * inverseDisplacement;
+		entryFraction = std::max(entryFraction, std::min(fractionA, fractionB));
+		exitFraction = std::min(exitFraction, std::max(fractionA, fractionB));
+		if (entryFraction > exitFraction)
+		{
+			return SweptImpact2D();
+		}
+	}
+
+	// Beyond a corner on both axes the grown box is rounded, and only that corner's disc can be hit
+	Vec2 entryCenter = discStart + discDisplacement * entryFraction;
+	bool isBeyondX = entryCenter.x < box.m_mins.x || entryCenter.x > box.m_maxs.x;
+	bool isBeyondY = entryCenter.y < box.m_mins.y || entryCenter.y > box.m_maxs.y;
+	if (isBeyondX && isBeyondY)
+	{
+		Vec2 corner(entryCenter.x < box.m_mins.x ? box.m_mins.x : box.m_maxs.x, entryCenter.y < box.m_mins.y ? box.m_mins.y : box.m_maxs.y);
+		if (!GetSweptPointVsDiscFraction(discStart, discDisplacement, corner, discRadius, entryFraction))
+		{
+			return SweptImpact2D();
+		}
+		return MakeSweptImpact2D(discStart, discDisplacement, entryFraction, corner, Vec2(1.f, 0.f));
+	}
+	return MakeSweptImpact2D(discStart, discDisplacement, entryFraction, box.GetNearestPoint(entryCenter), Vec2(1.f, 0.f));
+}
+
+SweptImpact2D SweepDiscVsLineSegment2D(Vec2 const& discStart, Vec2 const& discDisplacement, float discRadius, Vec2 const& lineStart, Vec2 const& lineEnd)
+{
+	// The segment grown by the radius is a capsule, two flat sides and a disc on each end
+	Vec2 lineDisplacement = lineEnd - lineStart;
+	float lineLength = lineDisplacement.GetLength();
+	Vec2 lineDirection = lineLength > 0.f ? lineDisplacement / lineLength : Vec2(1.f, 0.f);
+	Vec2 sideNormal = lineDirection.GetRotated90Degrees();
+	float startDistance = DotProduct2D(discStart - lineStart, sideNormal);
+	if (startDistance < 0.f)
+	{
+		sideNormal = -sideNormal;
+		startDistance = -startDistance;
+	}
+
+	Vec2 nearestPoint = GetNearestPointOnLineSegment2D(discStart, lineStart, lineEnd);
+	if ((discStart - nearestPoint).GetLengthSquared() <= discRadius * discRadius)
+	{
+		return MakeSweptImpact2D(discStart, discDisplacement, 0.f, nearestPoint, sideNormal);
+	}
+
+	float nearestFraction = 2.f;
+	float approachSpeed = -DotProduct2D(discDisplacement, sideNormal);
+	if (lineLength > 0.f && approachSpeed > 0.f && startDistance >= discRadius)
+	{
+		float fraction = (startDistance - discRadius) / approachSpeed;
+		float alongLine = DotProduct2D(discStart + discDisplacement * fraction - lineStart, lineDirection);
+		if (fraction <= 1.f && alongLine >= 0.f && alongLine <= lineLength)
+		{
+			nearestFraction = fraction;
+		}
+	}
+	if (nearestFraction > 1.f)
+	{
+		float endFraction = 0.f;
+		if (GetSweptPointVsDiscFraction(discStart, discDisplacement, lineStart, discRadius, endFraction))
+		{
+			nearestFraction = endFraction;
+		}
+		if (GetSweptPointVsDiscFraction(discStart, discDisplacement, lineEnd, discRadius, endFraction) && endFraction < nearestFraction)
+		{
+			nearestFraction = endFraction;
+		}
+	}
+	if (nearestFraction > 1.f)
+	{
+		return SweptImpact2D();
+	}
+	Vec2 impactCenter = discStart + discDisplacement * nearestFraction;
+	return MakeSweptImpact2D(discStart, discDisplacement, nearestFraction, GetNearestPointOnLineSegment2D(impactCenter, lineStart, lineEnd), sideNormal);
+}
+// -----------------------------------------------------------------------------
+// 3D sweeps, on float triples so the batch pass runs the same arithmetic as the single sweeps
+// -----------------------------------------------------------------------------
+static bool GetSweptPointVsSphereFraction(float const* start, float const* displacement, float const* sphereCenter, float sphereRadius, float& out_fraction)
+{
+	float centerToStart[3] = { start[0] - sphereCenter[0], start[1] - sphereCenter[1], start[2] - sphereCenter[2] };
+	float startOutsideAmount = centerToStart[0] * centerToStart[0] + centerToStart[1] * centerToStart[1] + centerToStart[2] * centerToStart[2] - sphereRadius * sphereRadius;
+	if (startOutsideAmount <= 0.f)
+	{
+		out_fraction = 0.f;
+		return true;
+	}
+	float approach = centerToStart[0] * displacement[0] + centerToStart[1] * displacement[1] + centerToStart[2] * displacement[2];
+	if (approach >= 0.f)
+	{
+		return false;
+	}
+	float displacementLengthSquared = displacement[0] * displacement[0] + displacement[1] * displacement[1] + displacement[2] * displacement[2];
+	float discriminant = approach * approach - displacementLengthSquared * startOutsideAmount;
+	if (discriminant < 0.f)
+	{
+		return false;
+	}
+	float fraction = startOutsideAmount / (-approach + sqrtf(discriminant));
+	if (fraction > 1.f)
+	{
+		return false;
+	}
+	out_fraction = fraction;
+	return true;
+}
+
+// The capsule around one box edge, which runs along edgeAxis through corner
+static bool GetSweptPointVsEdgeCapsuleFraction(float const* start, float const* displacement, float const* corner, int edgeAxis, float const* mins, float const* maxs, float radius, float& out_fraction)
+{
+	int axisI = (edgeAxis + 1) % 3;
+	int axisJ = (edgeAxis + 2) % 3;
+	float edgeToStartI = start[axisI] - corner[axisI];
+	float edgeToStartJ = start[axisJ] - corner[axisJ];
+	float startOutsideAmount = edgeToStartI * edgeToStartI + edgeToStartJ * edgeToStartJ - radius * radius;
+
+	// Where the point enters the edge's infinite cylinder, already inside it counting as the start
+	float fraction = 0.f;
+	if (startOutsideAmount > 0.f)
+	{
+		float approach = edgeToStartI * displacement[axisI] + edgeToStartJ * displacement[axisJ];
+		if (approach >= 0.f)
+		{
+			return false;
+		}
+		float acrossLengthSquared = displacement[axisI] * displacement[axisI] + displacement[axisJ] * displacement[axisJ];
+		float discriminant = approach * approach - acrossLengthSquared * startOutsideAmount;
+		if (discriminant < 0.f)
+		{
+			return false;
+		}
+		fraction = startOutsideAmount / (-approach + sqrtf(discriminant));
+		if (fraction > 1.f)
+		{
+			return false;
+		}
+	}
+	float alongEdge = start[edgeAxis] + displacement[edgeAxis] * fraction;
+	if (alongEdge >= mins[edgeAxis] && alongEdge <= maxs[edgeAxis])
+	{
+		out_fraction = fraction;
+		return true;
+	}
+
+	// Entered the cylinder past an end of the edge, so only the sphere on that end can be hit
+	float edgeEnd[3] = { corner[0], corner[1], corner[2] };
+	edgeEnd[edgeAxis] = alongEdge < mins[edgeAxis] ? mins[edgeAxis] : maxs[edgeAxis];
+	return GetSweptPointVsSphereFraction(start, displacement, edgeEnd, radius, out_fraction);
+}
+
+// A point moving against the box grown by radius, the shape a sphere sweeps around. The slab entry of the grown box
+// is exact on the faces, and where it lands past an edge or corner of the box the capsules of the edges there
+// decide (Ericson, Real-Time Collision Detection 5.5.7).
+static bool GetSweptPointVsRoundedBoxFraction(float const* start, float const* displacement, float const* mins, float const* maxs, float radius, float& out_fraction)
+{
+	float startDistanceSquared = 0.f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float outsideAmount = start[axis] - GetClamped(start[axis], mins[axis], maxs[axis]);
+		startDistanceSquared += outsideAmount * outsideAmount;
+	}
+	if (startDistanceSquared <= radius * radius)
+	{
+		out_fraction = 0.f;
+		return true;
+	}
+
+	float entryFraction = 0.f;
+	float exitFraction = 1.f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float grownMin = mins[axis] - radius;
+		float grownMax = maxs[axis] + radius;
+		if (displacement[axis] == 0.f)
+		{
+			if (start[axis] < grownMin || start[axis] > grownMax)
+			{
+				return false;
+			}
+			continue;
+		}
+		float inverseDisplacement = 1.f / displacement[axis];
+		float fractionA = (grownMin - start[axis]) * inverseDisplacement;
+		float fractionB = (grownMax - start[axis]) * inverseDisplacement;
+		entryFraction = std::max(entryFraction, std::min(fractionA, fractionB));
+		exitFraction = std::min(exitFraction, std::max(fractionA, fractionB));
+		if (entryFraction > exitFraction)
+		{
+			return false;
+		}
+	}
+
+	float corner[3];
+	int beyondAxes[3];
+	int numBeyondAxes = 0;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float entryCenter = start[axis] + displacement[axis] * entryFraction;
+		corner[axis] = entryCenter < mins[axis] ? mins[axis] : maxs[axis];
+		if (entryCenter < mins[axis] || entryCenter > maxs[axis])
+		{
+			beyondAxes[numBeyondAxes] = axis;
+			++numBeyondAxes;
+		}
+	}
+	if (numBeyondAxes <= 1)
+	{
+		out_fraction = entryFraction;
+		return true;
+	}
+	if (numBeyondAxes == 2)
+	{
+		int edgeAxis = 3 - beyondAxes[0] - beyondAxes[1];
+		return GetSweptPointVsEdgeCapsuleFraction(start, displacement, corner, edgeAxis, mins, maxs, radius, out_fraction);
+	}
+
+	// Past a corner, the earliest of the three edges meeting there
+	bool didImpact = false;
+	float nearestFraction = FLT_MAX;
+	for (int edgeAxis = 0; edgeAxis < 3; ++edgeAxis)
+	{
+		float edgeFraction = 0.f;
+		if (GetSweptPointVsEdgeCapsuleFraction(start, displacement, corner, edgeAxis, mins, maxs, radius, edgeFraction) && edgeFraction < nearestFraction)
+		{
+			nearestFraction = edgeFraction;
+			didImpact = true;
+		}
+	}
+	out_fraction = nearestFraction;
+	return didImpact;
+}
+
+// Impact on a box given in its own frame. A center already inside the box leaves through the nearest face.
+static void GetRoundedBoxImpact(float const* start, float const* displacement, float fraction, float const* mins, float const* maxs, float* out_normal, float* out_impactPoint)
+{
+	float center[3];
+	float pointToCenterLengthSquared = 0.f;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		center[axis] = start[axis] + displacement[axis] * fraction;
+		out_impactPoint[axis] = GetClamped(center[axis], mins[axis], maxs[axis]);
+		out_normal[axis] = center[axis] - out_impactPoint[axis];
+		pointToCenterLengthSquared += out_normal[axis] * out_normal[axis];
+	}
+	if (pointToCenterLengthSquared > 0.f)
+	{
+		float inversePointToCenterLength = 1.f / sqrtf(pointToCenterLengthSquared);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			out_normal[axis] *= inversePointToCenterLength;
+		}
+		return;
+	}
+
+	int nearestAxis = 0;
+	float nearestSign = 1.f;
+	float nearestFaceDistance = FLT_MAX;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		out_normal[axis] = 0.f;
+		if (center[axis] - mins[axis] < nearestFaceDistance)
+		{
+			nearestFaceDistance = center[axis] - mins[axis];
+			nearestAxis = axis;
+			nearestSign = -1.f;
+		}
+		if (maxs[axis] - center[axis] < nearestFaceDistance)
+		{
+			nearestFaceDistance = maxs[axis] - center[axis];
+			nearestAxis = axis;
+			nearestSign = 1.f;
+		}
+	}
+	out_normal[nearestAxis] = nearestSign;
+	out_impactPoint[nearestAxis] = nearestSign > 0.f ? maxs[nearestAxis] : mins[nearestAxis];
+}
+
+static void GetAABB3Sweep(SweptSphere3 const& sphere, AABB3 const& box, float* out_start, float* out_displacement, float* out_mins, float* out_maxs)
+{
+	out_start[0] = sphere.m_start.x;
+	out_start[1] = sphere.m_start.y;
+	out_start[2] = sphere.m_start.z;
+	out_displacement[0] = sphere.m_displacement.x;
+	out_displacement[1] = sphere.m_displacement.y;
+	out_displacement[2] = sphere.m_displacement.z;
+	out_mins[0] = box.m_mins.x;
+	out_mins[1] = box.m_mins.y;
+	out_mins[2] = box.m_mins.z;
+	out_maxs[0] = box.m_maxs.x;
+	out_maxs[1] = box.m_maxs.y;
+	out_maxs[2] = box.m_maxs.z;
+}
+
+// The sweep in the box's frame, summed in the same order as the batch pass's SIMD transform
+static void GetOBB3Sweep(SweptSphere3 const& sphere, OBB3 const& box, float* out_start, float* out_displacement, float* out_mins, float* out_maxs)
+{
+	Vec3 const* bases[3] = { &box.m_iBasis, &box.m_jBasis, &box.m_kBasis };
+	float const halfDimensions[3] = { box.m_halfDimensions.x, box.m_halfDimensions.y, box.m_halfDimensions.z };
+	float centerToStartX = sphere.m_start.x - box.m_center.x;
+	float centerToStartY = sphere.m_start.y - box.m_center.y;
+	float centerToStartZ = sphere.m_start.z - box.m_center.z;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		Vec3 const& basis = *bases[axis];
+		out_start[axis] = (centerToStartX * basis.x + centerToStartY * basis.y) + centerToStartZ * basis.z;
+		out_displacement[axis] = (sphere.m_displacement.x * basis.x + sphere.m_displacement.y * basis.y) + sphere.m_displacement.z * basis.z;
+		out_mins[axis] = -halfDimensions[axis];
+		out_maxs[axis] = halfDimensions[axis];
+	}
+}
+
+static bool GetSweptSphereVsAABB3Fraction(SweptSphere3 const& sphere, AABB3 const& box, float& out_fraction)
+{
+	float start[3];
+	float displacement[3];
+	float mins[3];
+	float maxs[3];
+	GetAABB3Sweep(sphere, box, start, displacement, mins, maxs);
+	return GetSweptPointVsRoundedBoxFraction(start, displacement, mins, maxs, sphere.m_radius, out_fraction);
+}
+
+static bool GetSweptSphereVsOBB3Fraction(SweptSphere3 const& sphere, OBB3 const& box, float& out_fraction)
+{
+	float start[3];
+	float displacement[3];
+	float mins[3];
+	float maxs[3];
+	GetOBB3Sweep(sphere, box, start, displacement, mins, maxs);
+	return GetSweptPointVsRoundedBoxFraction(start, displacement, mins, maxs, sphere.m_radius, out_fraction);
+}
+
+SweptImpact3D SweepSphereVsAABB3D(Vec3 const& sphereStart, Vec3 const& sphereDisplacement, float sphereRadius, AABB3 const& box)
+{
+	SweptImpact3D impact;
+	float start[3];
+	float displacement[3];
+	float mins[3];
+	float maxs[3];
+	GetAABB3Sweep(SweptSphere3(sphereStart, sphereDisplacement, sphereRadius), box, start, displacement, mins, maxs);
+	float fraction = 0.f;
+	if (!GetSweptPointVsRoundedBoxFraction(start, displacement, mins, maxs, sphereRadius, fraction))
+	{
+		return impact;
+	}
+
+	float normal[3];
+	float impactPoint[3];
+	GetRoundedBoxImpact(start, displacement, fraction, mins, maxs, normal, impactPoint);
+	impact.m_didImpact = true;
+	impact.m_impactFraction = fraction;
+	impact.m_impactCenter = sphereStart + sphereDisplacement * fraction;
+	impact.m_impactNormal = Vec3(normal[0], normal[1], normal[2]);
+	impact.m_impactPoint = Vec3(impactPoint[0], impactPoint[1], impactPoint[2]);
+	return impact;
+}
+
+SweptImpact3D SweepSphereVsOBB3D(Vec3 const& sphereStart, Vec3 const& sphereDisplacement, float sphereRadius, OBB3 const& box)
+{
+	SweptImpact3D impact;
+	float start[3];
+	float displacement[3];
+	float mins[3];
+	float maxs[3];
+	GetOBB3Sweep(SweptSphere3(sphereStart, sphereDisplacement, sphereRadius), box, start, displacement, mins, maxs);
+	float fraction = 0.f;
+	if (!GetSweptPointVsRoundedBoxFraction(start, displacement, mins, maxs, sphereRadius, fraction))
+	{
+		return impact;
+	}
+
+	float normal[3];
+	float impactPoint[3];
+	GetRoundedBoxImpact(start, displacement, fraction, mins, maxs, normal, impactPoint);
+	impact.m_didImpact = true;
+	impact.m_impactFraction = fraction;
+	impact.m_impactCenter = sphereStart + sphereDisplacement * fraction;
+	impact.m_impactNormal = box.m_iBasis * normal[0] + box.m_jBasis * normal[1] + box.m_kBasis * normal[2];
+	impact.m_impactPoint = box.m_center + box.m_iBasis * impactPoint[0] + box.m_jBasis * impactPoint[1] + box.m_kBasis * impactPoint[2];
+	return impact;
+}
+// -----------------------------------------------------------------------------
+// Batch sweeps
+// -----------------------------------------------------------------------------
+// Reference path, one single sweep per sphere and primitive. Used when SIMD is disabled.
+template <typename SingleSweep>
+static void SweepSphereBatchScalar(int numSpheres, SweptSphere3 const* spheres, int numPrimitives, SweptHit3D* out_hits, SingleSweep const& singleSweep)
+{
+	for (int sphereIndex = 0; sphereIndex < numSpheres; ++sphereIndex)
+	{
+		SweptHit3D nearestHit;
+		for (int primitiveIndex = 0; primitiveIndex < numPrimitives; ++primitiveIndex)
+		{
+			float fraction = 0.f;
+			if (singleSweep(spheres[sphereIndex], primitiveIndex, fraction) && (!nearestHit.DidImpact() || fraction < nearestHit.m_impactFraction))
+			{
+				nearestHit.m_primitiveIndex = primitiveIndex;
+				nearestHit.m_impactFraction = fraction;
+			}
+		}
+		out_hits[sphereIndex] = nearestHit;
+	}
+}
+
+#if !defined( ENGINE_SIMD_SCALAR )
+// -----------------------------------------------------------------------------
+// Up to SIMD_WIDE_NUM_LANES sweeps in structure of arrays form, one sphere per lane. Short packets repeat their last
+// sphere so every lane holds a real sweep.
+struct SweptSpherePacket3D
+{
+	SIMDFloatWide m_start[3];
+	SIMDFloatWide m_displacement[3];
+	SIMDFloatWide m_inverseDisplacement[3];	// FLT_MAX for a zero displacement, which keeps the slab products finite
+	SIMDFloatWide m_cullRadius;
+};
+
+static SIMDFloatWide GetSafeInverse(SIMDFloatWide value)
+{
+	SIMDFloatWide zero = SIMDSplatWide(0.f);
+	SIMDFloatWide isZero = SIMDAnd(SIMDLessEqual(value, zero), SIMDLessEqual(zero, value));
+	return SIMDSelect(isZero, SIMDSplatWide(FLT_MAX), SIMDDivide(SIMDSplatWide(1.f), value));
+}
+
+static void LoadSweptSpherePacket(SweptSpherePacket3D& out_packet, SweptSphere3 const* spheres, int numSpheres)
+{
+	float lanes[7][SIMD_WIDE_NUM_LANES];
+	for (int laneIndex = 0; laneIndex < SIMD_WIDE_NUM_LANES; ++laneIndex)
+	{
+		SweptSphere3 const& sphere = spheres[laneIndex < numSpheres ? laneIndex : numSpheres - 1];
+		lanes[0][laneIndex] = sphere.m_start.x;
+		lanes[1][laneIndex] = sphere.m_start.y;
+		lanes[2][laneIndex] = sphere.m_start.z;
+		lanes[3][laneIndex] = sphere.m_displacement.x;
+		lanes[4][laneIndex] = sphere.m_displacement.y;
+		lanes[5][laneIndex] = sphere.m_displacement.z;
+		lanes[6][laneIndex] = sphere.m_radius * SWEPT_BATCH_CULL_RADIUS_SCALE + SWEPT_BATCH_CULL_RADIUS_PADDING;
+	}
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		out_packet.m_start[axis] = SIMDLoadWide(lanes[axis]);
+		out_packet.m_displacement[axis] = SIMDLoadWide(lanes[3 + axis]);
+		out_packet.m_inverseDisplacement[axis] = GetSafeInverse(out_packet.m_displacement[axis]);
+	}
+	out_packet.m_cullRadius = SIMDLoadWide(lanes[6]);
+}
+
+// Lanes whose sweep enters the grown box no later than their nearest hit so far, the slab entry being a lower bound
+// on the exact sweep
+static SIMDFloatWide GetGrownSlabCandidateMask(SIMDFloatWide const* starts, SIMDFloatWide const* inverseDisplacements, float const* mins, float const* maxs,
+	SIMDFloatWide cullRadius, SIMDFloatWide nearestFraction)
+{
+	SIMDFloatWide entryFraction = SIMDSplatWide(0.f);
+	SIMDFloatWide exitFraction = SIMDSplatWide(1.f);
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		SIMDFloatWide fractionA = SIMDMultiply(SIMDSubtract(SIMDSubtract(SIMDSplatWide(mins[axis]), cullRadius), starts[axis]), inverseDisplacements[axis]);
+		SIMDFloatWide fractionB = SIMDMultiply(SIMDSubtract(SIMDAdd(SIMDSplatWide(maxs[axis]), cullRadius), starts[axis]), inverseDisplacements[axis]);
+		entryFraction = SIMDMax(entryFraction, SIMDMin(fractionA, fractionB));
+		exitFraction = SIMDMin(exitFraction, SIMDMax(fractionA, fractionB));
+	}
+	return SIMDAnd(SIMDLessEqual(entryFraction, exitFraction), SIMDLessEqual(entryFraction, nearestFraction));
+}
+// -----------------------------------------------------------------------------
+// Packet culls, each returns the lanes still worth an exact sweep against the primitive
+struct AABB3PacketSweepCull
+{
+	AABB3 const* m_boxes = nullptr;
+
+	SIMDFloatWide operator()(SweptSpherePacket3D const& packet, int boxIndex, SIMDFloatWide nearestFraction) const
+	{
+		AABB3 const& box = m_boxes[boxIndex];
+		float const mins[3] = { box.m_mins.x, box.m_mins.y, box.m_mins.z };
+		float const maxs[3] = { box.m_maxs.x, box.m_maxs.y, box.m_maxs.z };
+		return GetGrownSlabCandidateMask(packet.m_start, packet.m_inverseDisplacement, mins, maxs, packet.m_cullRadius, nearestFraction);
+	}
+};
+
+// Moves the packet into each box's local space, then the same grown slab test
+struct OBB3PacketSweepCull
+{
+	OBB3 const* m_boxes = nullptr;
+
+	SIMDFloatWide operator()(SweptSpherePacket3D const& packet, int boxIndex, SIMDFloatWide nearestFraction) const
+	{
+		OBB3 const& box = m_boxes[boxIndex];
+		SIMDFloatWide centerToStartX = SIMDSubtract(packet.m_start[0], SIMDSplatWide(box.m_center.x));
+		SIMDFloatWide centerToStartY = SIMDSubtract(packet.m_start[1], SIMDSplatWide(box.m_center.y));
+		SIMDFloatWide centerToStartZ = SIMDSubtract(packet.m_start[2], SIMDSplatWide(box.m_center.z));
+
+		Vec3 const* bases[3] = { &box.m_iBasis, &box.m_jBasis, &box.m_kBasis };
+		float const maxs[3] = { box.m_halfDimensions.x, box.m_halfDimensions.y, box.m_halfDimensions.z };
+		float const mins[3] = { -maxs[0], -maxs[1], -maxs[2] };
+		SIMDFloatWide localStarts[3];
+		SIMDFloatWide localInverseDisplacements[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			SIMDFloatWide basisX = SIMDSplatWide(bases[axis]->x);
+			SIMDFloatWide basisY = SIMDSplatWide(bases[axis]->y);
+			SIMDFloatWide basisZ = SIMDSplatWide(bases[axis]->z);
+			localStarts[axis] = SIMDAdd(SIMDAdd(SIMDMultiply(centerToStartX, basisX), SIMDMultiply(centerToStartY, basisY)), SIMDMultiply(centerToStartZ, basisZ));
+			SIMDFloatWide localDisplacement = SIMDAdd(SIMDAdd(SIMDMultiply(packet.m_displacement[0], basisX), SIMDMultiply(packet.m_displacement[1], basisY)), SIMDMultiply(packet.m_displacement[2], basisZ));
+			localInverseDisplacements[axis] = GetSafeInverse(localDisplacement);
+		}
+		return GetGrownSlabCandidateMask(localStarts, localInverseDisplacements, mins, maxs, packet.m_cullRadius, nearestFraction);
+	}
+};
+// -----------------------------------------------------------------------------
+// Culls every primitive for a packet at once, then runs the exact single sweep for the lanes left, which keeps the
+// results identical to SweepSphereBatchScalar. Primitive indices ride along as ints in lane arrays.
+template <typename PacketCull, typename SingleSweep>
+static void SweepSphereBatchPackets(int numSpheres, SweptSphere3 const* spheres, int numPrimitives, SweptHit3D* out_hits, JobSystem* jobSystem,
+	PacketCull const& packetCull, SingleSweep const& singleSweep)
+{
+	int numPackets = (numSpheres + SIMD_WIDE_NUM_LANES - 1) / SIMD_WIDE_NUM_LANES;
+	auto rangeFunction = [&](int startPacket, int endPacket)
+	{
+		for (int packetIndex = startPacket; packetIndex < endPacket; ++packetIndex)
+		{
+			int firstSphereIndex = packetIndex * SIMD_WIDE_NUM_LANES;
+			int numPacketSpheres = std::min(SIMD_WIDE_NUM_LANES, numSpheres - firstSphereIndex);
+			SweptSpherePacket3D packet;
+			LoadSweptSpherePacket(packet, spheres + firstSphereIndex, numPacketSpheres);
+
+			float laneFractions[SIMD_WIDE_NUM_LANES];
+			int laneIndices[SIMD_WIDE_NUM_LANES];
+			for (int laneIndex = 0; laneIndex < SIMD_WIDE_NUM_LANES; ++laneIndex)
+			{
+				laneFractions[laneIndex] = FLT_MAX;
+				laneIndices[laneIndex] = -1;
+			}
+			SIMDFloatWide nearestFraction = SIMDSplatWide(FLT_MAX);
+			int realLaneBits = (1 << numPacketSpheres) - 1;
+			for (int primitiveIndex = 0; primitiveIndex < numPrimitives; ++primitiveIndex)
+			{
+				int candidateLaneBits = SIMDGetMaskBits(packetCull(packet, primitiveIndex, nearestFraction)) & realLaneBits;
+				if (candidateLaneBits == 0)
+				{
+					continue;
+				}
+
+				bool isNearestChanged = false;
+				for (int laneIndex = 0; laneIndex < numPacketSpheres; ++laneIndex)
+				{
+					float fraction = 0.f;
+					if ((candidateLaneBits & (1 << laneIndex)) != 0 && singleSweep(spheres[firstSphereIndex + laneIndex], primitiveIndex, fraction) && fraction < laneFractions[laneIndex])
+					{
+						laneFractions[laneIndex] = fraction;
+						laneIndices[laneIndex] = primitiveIndex;
+						isNearestChanged = true;
+					}
+				}
+				if (isNearestChanged)
+				{
+					nearestFraction = SIMDLoadWide(laneFractions);
+				}
+			}
+
+			for (int laneIndex = 0; laneIndex < numPacketSpheres; ++laneIndex)
+			{
+				SweptHit3D& hit = out_hits[firstSphereIndex + laneIndex];
+				hit.m_primitiveIndex = laneIndices[laneIndex];
+				hit.m_impactFraction = hit.DidImpact() ? laneFractions[laneIndex] : 1.f;
+			}
+		}
+	};
+
+	if (jobSystem != nullptr)
+	{
+		int minPacketsPerJob = (SWEPT_BATCH_MIN_SPHERES_PER_JOB + SIMD_WIDE_NUM_LANES - 1) / SIMD_WIDE_NUM_LANES;
+		jobSystem->ExecuteParallelFor(numPackets, minPacketsPerJob, rangeFunction);
+	}
+	else
+	{
+		rangeFunction(0, numPackets);
+	}
+}
+#endif
+// -----------------------------------------------------------------------------
+void SweepSphereBatchVsAABB3Ds(int numSpheres, SweptSphere3 const* spheres, int numBoxes, AABB3 const* boxes, SweptHit3D* out_hits, JobSystem* jobSystem)
+{
+	auto singleSweep = [&](SweptSphere3 const& sphere, int boxIndex, float& out_fraction) { return GetSweptSphereVsAABB3Fraction(sphere, boxes[boxIndex], out_fraction); };
+#if defined( ENGINE_SIMD_SCALAR )
+	UNUSED(jobSystem);
+	SweepSphereBatchScalar(numSpheres, spheres, numBoxes, out_hits, singleSweep);
+#else
+	AABB3PacketSweepCull packetCull;
+	packetCull.m_boxes = boxes;
+	SweepSphereBatchPackets(numSpheres, spheres, numBoxes, out_hits, jobSystem, packetCull, singleSweep);
+#endif
+}
+
+void SweepSphereBatchVsOBB3Ds(int numSpheres, SweptSphere3 const* spheres, int numBoxes, OBB3 const* boxes, SweptHit3D* out_hits, JobSystem* jobSystem)
+{
+	auto singleSweep = [&](SweptSphere3 const& sphere, int boxIndex, float& out_fraction) { return GetSweptSphereVsOBB3Fraction(sphere, boxes[boxIndex], out_fraction); };
+#if defined( ENGINE_SIMD_SCALAR )
+	UNUSED(jobSystem);
+	SweepSphereBatchScalar(numSpheres, spheres, numBoxes, out_hits, singleSweep);
+#else
+	OBB3PacketSweepCull packetCull;
+	packetCull.m_boxes = boxes;
+	SweepSphereBatchPackets(numSpheres, spheres, numBoxes, out_hits, jobSystem, packetCull, singleSweep);
+#endif
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,65 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/AABB2.h"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/OBB3.hpp"
+// -----------------------------------------------------------------------------
+class JobSystem;
+// -----------------------------------------------------------------------------
+// Where a moving disc or sphere first touches a shape over one step. The Push and Bounce helpers in MathUtils only
+// look at where things end up, so a shape moving further than its own size in a step can pass through a thin
+// wall. Sweeping the whole displacement finds the wall, and the caller moves only m_impactFraction of the way.
+struct SweptImpact2D
+{
+	bool  m_didImpact = false;
+	float m_impactFraction = 1.f;	// Of the displacement, 0 when already touching at the start and 1 when nothing is hit
+	Vec2  m_impactCenter;			// The moving disc's center at impact
+	Vec2  m_impactNormal;			// Off the surface hit, toward the moving disc
+	Vec2  m_impactPoint;			// On the surface hit
+};
+
+struct SweptImpact3D
+{
+	bool  m_didImpact = false;
+	float m_impactFraction = 1.f;
+	Vec3  m_impactCenter;
+	Vec3  m_impactNormal;
+	Vec3  m_impactPoint;
+};
+// -----------------------------------------------------------------------------
+// Each sweep is a point moving against the target grown by the radius, so the tests are exact rather than sampled
+SweptImpact2D SweepDiscVsDisc2D(Vec2 const& discStart, Vec2 const& discDisplacement, float discRadius, Vec2 const& otherDiscStart, Vec2 const& otherDiscDisplacement, float otherDiscRadius); // Both moving, impact fields are for the first disc
+SweptImpact2D SweepDiscVsAABB2D(Vec2 const& discStart, Vec2 const& discDisplacement, float discRadius, AABB2 const& box);
+SweptImpact2D SweepDiscVsLineSegment2D(Vec2 const& discStart, Vec2 const& discDisplacement, float discRadius, Vec2 const& lineStart, Vec2 const& lineEnd);
+SweptImpact3D SweepSphereVsAABB3D(Vec3 const& sphereStart, Vec3 const& sphereDisplacement, float sphereRadius, AABB3 const& box);
+SweptImpact3D SweepSphereVsOBB3D(Vec3 const& sphereStart, Vec3 const& sphereDisplacement, float sphereRadius, OBB3 const& box);
+// -----------------------------------------------------------------------------
+struct SweptSphere3
+{
+	SweptSphere3() = default;
+	SweptSphere3(Vec3 const& start, Vec3 const& displacement, float radius);
+
+	Vec3  m_start;
+	Vec3  m_displacement;	// This step's motion
+	float m_radius = 0.f;
+};
+
+// Compact per sphere result of the batch sweeps. Rerun the single sweep on the primitive that was hit when the
+// normal or impact point is needed.
+struct SweptHit3D
+{
+	int	  m_primitiveIndex = -1;	// -1 when the sphere hit nothing
+	float m_impactFraction = 1.f;
+
+	bool DidImpact() const { return m_primitiveIndex >= 0; }
+};
+// -----------------------------------------------------------------------------
+// Batch time of impact pass, the earliest hit of every sphere against every primitive. Spheres go through in SIMD
+// packets that rule out each primitive with the slab test of the primitive grown by their radius, so only the few
+// candidates left run the exact single sweep. Packets are split across the job system when one is given, and the
+// results match the single sweeps exactly.
+constexpr int SWEPT_BATCH_MIN_SPHERES_PER_JOB = 64;
+
+void SweepSphereBatchVsAABB3Ds(int numSpheres, SweptSphere3 const* spheres, int numBoxes, AABB3 const* boxes, SweptHit3D* out_hits, JobSystem* jobSystem = nullptr);
+void SweepSphereBatchVsOBB3Ds(int numSpheres, SweptSphere3 const* spheres, int numBoxes, OBB3 const* boxes, SweptHit3D* out_hits, JobSystem* jobSystem = nullptr);
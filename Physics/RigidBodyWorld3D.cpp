@@ -0,0 +1,927 @@
+#include "Engine/Physics/RigidBodyWorld3D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+// -----------------------------------------------------------------------------
+constexpr float RIGID_BODY_CONTACT_MARGIN = 0.02f;			// Points still this far apart stay in the manifold as speculative contacts
+constexpr float RIGID_BODY_CONTACT_DRIFT_DISTANCE = 0.02f;	// Kept points that slid this far sideways are dropped
+constexpr float RIGID_BODY_CONTACT_MERGE_DISTANCE = 0.02f;	// A new point this close to a kept one replaces it
+constexpr float RIGID_BODY_ALLOWED_PENETRATION = 0.005f;
+constexpr float RIGID_BODY_POSITION_CORRECTION = 0.2f;		// Fraction of the penetration pushed out per step
+constexpr float RIGID_BODY_RESTITUTION_MIN_SPEED = 1.f;		// Slower impacts do not bounce, so resting contacts stay quiet
+constexpr float RIGID_BODY_ANGULAR_DAMPING = 0.05f;			// Per second
+constexpr int	RIGID_BODY_MIN_BODIES_PER_JOB = 256;
+constexpr int	RIGID_BODY_MIN_MANIFOLDS_PER_JOB = 64;
+// -----------------------------------------------------------------------------
+// The velocities of one island body while its island solves. Floats rather than Vec3 keep the iterations inline.
+struct RigidBodySolverBody3D
+{
+	float m_linearVelocity[3] = {};
+	float m_angularVelocity[3] = {};
+};
+
+// One manifold point prepared for the solver, with the impulse directions for the normal and both tangents
+struct RigidBodyContactConstraint3D
+{
+	int	  m_manifoldIndex = 0;
+	int	  m_pointIndex = 0;
+	int	  m_solverBodyA = 0;				// Static bodies share the island's last solver body, which stays at rest
+	int	  m_solverBodyB = 0;
+	float m_inverseMassA = 0.f;
+	float m_inverseMassB = 0.f;
+	float m_friction = 0.f;
+	float m_bias = 0.f;						// Separating speed the normal impulse aims for
+	float m_directions[3][3] = {};			// Normal, then the two tangents
+	float m_armCrossDirectionsA[3][3] = {};	// rA x direction
+	float m_armCrossDirectionsB[3][3] = {};
+	float m_angularImpulsesA[3][3] = {};	// The inverse inertia applied to the above
+	float m_angularImpulsesB[3][3] = {};
+	float m_effectiveMasses[3] = {};
+	float m_impulses[3] = {};				// Accumulated, normal first
+};
+// -----------------------------------------------------------------------------
+static Vec3 RotateByQuat(Quat const& orientation, Vec3 const& vector)
+{
+	Vec3 axis(orientation.m_x, orientation.m_y, orientation.m_z);
+	Vec3 twiceAxisCrossVector = CrossProduct3D(axis, vector) * 2.f;
+	return vector + twiceAxisCrossVector * orientation.m_w + CrossProduct3D(axis, twiceAxisCrossVector);
+}
+
+static Vec3 RotateByInverseQuat(Quat const& orientation, Vec3 const& vector)
+{
+	return RotateByQuat(orientation.ConjugateQuat(), vector);
+}
+
+static Vec3 GetLeastAlignedAxis(Vec3 const& direction)
+{
+	float absX = fabsf(direction.x);
+	float absY = fabsf(direction.y);
+	float absZ = fabsf(direction.z);
+	if (absX <= absY && absX <= absZ)
+	{
+		return Vec3::XAXE;
+	}
+	return absY <= absZ ? Vec3::YAXE : Vec3::ZAXE;
+}
+
+static Quat GetShapeOrientation(ConvexShape3D const& shape)
+{
+	if (shape.m_type == ConvexShapeType3D::OBB)
+	{
+		return Quat::MakeFromMat44(Mat44(shape.m_axes[0], shape.m_axes[1], shape.m_axes[2], Vec3::ZERO)).GetNormalized();
+	}
+	if (shape.m_type == ConvexShapeType3D::CAPSULE)
+	{
+		Vec3 kBasis = shape.m_axes[2];
+		Vec3 iBasis = CrossProduct3D(GetLeastAlignedAxis(kBasis), kBasis).GetNormalized();
+		Vec3 jBasis = CrossProduct3D(kBasis, iBasis);
+		return Quat::MakeFromMat44(Mat44(iBasis, jBasis, kBasis, Vec3::ZERO)).GetNormalized();
+	}
+	return Quat();
+}
+
+// Inertia of the shape about its own axes, as a diagonal
+static Vec3 GetLocalInverseInertia(ConvexShape3D const& localShape, float mass)
+{
+	if (mass <= 0.f)
+	{
+		return Vec3::ZERO;
+	}
+	float radius = localShape.m_radius;
+	Vec3 inertia;
+	switch (localShape.m_type)
+	{
+		case ConvexShapeType3D::SPHERE:
+		{
+			float sphereInertia = 0.4f * mass * radius * radius;
+			inertia = Vec3(sphereInertia, sphereInertia, sphereInertia);
+			break;
+		}
+		case ConvexShapeType3D::CAPSULE:
+		{
+			// A cylinder plus two hemispheres, the mass split by volume
+			float halfLength = localShape.m_halfDimensions.z;
+			float cylinderVolume = 2.f * halfLength * radius * radius;
+			float sphereVolume = (4.f / 3.f) * radius * radius * radius;
+			float cylinderMass = mass * cylinderVolume / (cylinderVolume + sphereVolume);
+			float sphereMass = mass - cylinderMass;
+			float alongAxis = cylinderMass * 0.5f * radius * radius + sphereMass * 0.4f * radius * radius;
+			float acrossAxis = cylinderMass * (3.f * radius * radius + 4.f * halfLength * halfLength) / 12.f + sphereMass * (0.4f * radius * radius + halfLength * halfLength + 0.75f * halfLength * radius);
+			inertia = Vec3(acrossAxis, acrossAxis, alongAxis);
+			break;
+		}
+		case ConvexShapeType3D::Z_CYLINDER:
+		{
+			return Vec3::ZERO;
+		}
+		case ConvexShapeType3D::OBB:
+		{
+			Vec3 dimensionsSquared = localShape.m_halfDimensions * localShape.m_halfDimensions * 4.f;
+			inertia = Vec3(dimensionsSquared.y + dimensionsSquared.z, dimensionsSquared.x + dimensionsSquared.z, dimensionsSquared.x + dimensionsSquared.y) * (mass / 12.f);
+			break;
+		}
+	}
+	return Vec3(inertia.x > 0.f ? 1.f / inertia.x : 0.f, inertia.y > 0.f ? 1.f / inertia.y : 0.f, inertia.z > 0.f ? 1.f / inertia.z : 0.f);
+}
+
+static AABB3 GetShapeBounds(ConvexShape3D const& shape)
+{
+	return AABB3(shape.GetSupportPoint(-Vec3::XAXE).x, shape.GetSupportPoint(-Vec3::YAXE).y, shape.GetSupportPoint(-Vec3::ZAXE).z,
+				 shape.GetSupportPoint(Vec3::XAXE).x, shape.GetSupportPoint(Vec3::YAXE).y, shape.GetSupportPoint(Vec3::ZAXE).z);
+}
+
+static unsigned long long GetBodyPairKey(int bodyA, int bodyB)
+{
+	return (static_cast<unsigned long long>(bodyA) << 32) | static_cast<unsigned int>(bodyB);
+}
+
+static int FindIslandRoot(std::vector<int>& parents, int handle)
+{
+	while (parents[handle] != handle)
+	{
+		parents[handle] = parents[parents[handle]];
+		handle = parents[handle];
+	}
+	return handle;
+}
+// -----------------------------------------------------------------------------
+RigidBodyWorld3D::RigidBodyWorld3D(RigidBodyWorld3DConfig const& config)
+	:m_config(config)
+{
+	GUARANTEE_OR_DIE(m_config.m_fixedStepSeconds > 0.f, "RigidBodyWorld3D needs a positive fixed step");
+}
+
+int RigidBodyWorld3D::AddBody(RigidBody3DConfig const& bodyConfig)
+{
+	GUARANTEE_OR_DIE(bodyConfig.m_mass >= 0.f, Stringf("RigidBodyWorld3D body mass %f is negative", bodyConfig.m_mass));
+	int handle = 0;
+	if (!m_freeHandles.empty())
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+	else
+	{
+		handle = static_cast<int>(m_positions.size());
+		m_positions.emplace_back();
+		m_orientations.emplace_back();
+		m_linearVelocities.emplace_back();
+		m_angularVelocities.emplace_back();
+		m_inverseMasses.push_back(0.f);
+		m_inverseInertias.emplace_back();
+		m_frictions.push_back(0.f);
+		m_restitutions.push_back(0.f);
+		m_localShapes.emplace_back();
+		m_worldShapes.emplace_back();
+		m_broadPhaseHandles.push_back(-1);
+		m_isBodyInUse.push_back(0);
+	}
+
+	ConvexShape3D localShape = bodyConfig.m_shape;
+	localShape.m_center = Vec3::ZERO;
+	localShape.m_axes[0] = Vec3::XAXE;
+	localShape.m_axes[1] = Vec3::YAXE;
+	localShape.m_axes[2] = Vec3::ZAXE;
+
+	m_positions[handle] = bodyConfig.m_shape.m_center;
+	m_orientations[handle] = GetShapeOrientation(bodyConfig.m_shape);
+	m_linearVelocities[handle] = bodyConfig.m_linearVelocity;
+	m_angularVelocities[handle] = bodyConfig.m_angularVelocity;
+	m_inverseMasses[handle] = bodyConfig.m_mass > 0.f ? 1.f / bodyConfig.m_mass : 0.f;
+	m_inverseInertias[handle] = GetLocalInverseInertia(localShape, bodyConfig.m_mass);
+	m_frictions[handle] = bodyConfig.m_friction;
+	m_restitutions[handle] = bodyConfig.m_restitution;
+	m_localShapes[handle] = localShape;
+	m_isBodyInUse[handle] = 1;
+	UpdateWorldShape(handle);
+
+	int broadPhaseHandle = m_broadPhase.Insert(GetShapeBounds(m_worldShapes[handle]));
+	if (broadPhaseHandle >= static_cast<int>(m_broadPhaseBodies.size()))
+	{
+		m_broadPhaseBodies.resize(broadPhaseHandle + 1, -1);
+	}
+	m_broadPhaseBodies[broadPhaseHandle] = handle;
+	m_broadPhaseHandles[handle] = broadPhaseHandle;
+	++m_numBodies;
+	return handle;
+}
+
+void RigidBodyWorld3D::RemoveBody(int handle)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::RemoveBody given invalid handle %d", handle));
+	m_broadPhase.Remove(m_broadPhaseHandles[handle]);
+	m_broadPhaseHandles[handle] = -1;
+	m_isBodyInUse[handle] = 0;
+	m_inverseMasses[handle] = 0.f;
+	m_inverseInertias[handle] = Vec3::ZERO;
+	m_linearVelocities[handle] = Vec3::ZERO;
+	m_angularVelocities[handle] = Vec3::ZERO;
+	m_removedHandles.push_back(handle);
+	--m_numBodies;
+}
+
+void RigidBodyWorld3D::Clear()
+{
+	m_positions.clear();
+	m_orientations.clear();
+	m_linearVelocities.clear();
+	m_angularVelocities.clear();
+	m_inverseMasses.clear();
+	m_inverseInertias.clear();
+	m_frictions.clear();
+	m_restitutions.clear();
+	m_localShapes.clear();
+	m_worldShapes.clear();
+	m_broadPhaseHandles.clear();
+	m_isBodyInUse.clear();
+	m_freeHandles.clear();
+	m_removedHandles.clear();
+	m_numBodies = 0;
+	m_broadPhase.Clear();
+	m_broadPhaseBodies.clear();
+	m_manifolds.clear();
+	m_manifoldIndices.clear();
+	m_islandBodies.clear();
+	m_islandManifolds.clear();
+	m_islandBodyStarts.clear();
+	m_islandManifoldStarts.clear();
+	m_unsteppedSeconds = 0.0;
+}
+// -----------------------------------------------------------------------------
+void RigidBodyWorld3D::Update()
+{
+	Clock const& clock = m_config.m_clock != nullptr ? *m_config.m_clock : Clock::GetSystemClock();
+	double fixedStepSeconds = static_cast<double>(m_config.m_fixedStepSeconds);
+	m_unsteppedSeconds += clock.GetDeltaSeconds();
+	for (int stepIndex = 0; stepIndex < m_config.m_maxStepsPerUpdate && m_unsteppedSeconds >= fixedStepSeconds; ++stepIndex)
+	{
+		Step(m_config.m_fixedStepSeconds);
+		m_unsteppedSeconds -= fixedStepSeconds;
+	}
+	m_unsteppedSeconds = fmod(m_unsteppedSeconds, fixedStepSeconds);
+}
+
+void RigidBodyWorld3D::Step(float deltaSeconds)
+{
+	GUARANTEE_OR_DIE(deltaSeconds > 0.f, Stringf("RigidBodyWorld3D::Step given %f seconds", deltaSeconds));
+
+	Vec3 gravityVelocity = m_config.m_gravity * deltaSeconds;
+	float angularDampingScale = 1.f / (1.f + deltaSeconds * RIGID_BODY_ANGULAR_DAMPING);
+	RunRange(static_cast<int>(m_positions.size()), RIGID_BODY_MIN_BODIES_PER_JOB, [&](int startIndex, int endIndex)
+	{
+		for (int handle = startIndex; handle < endIndex; ++handle)
+		{
+			if (m_inverseMasses[handle] > 0.f)
+			{
+				m_linearVelocities[handle] += gravityVelocity;
+				m_angularVelocities[handle] *= angularDampingScale;
+			}
+		}
+	});
+
+	UpdateBroadPhase(deltaSeconds);
+	UpdateManifolds();
+	BuildIslands();
+	SolveIslands(deltaSeconds);
+	IntegratePositions(deltaSeconds);
+
+	m_freeHandles.insert(m_freeHandles.end(), m_removedHandles.begin(), m_removedHandles.end());
+	m_removedHandles.clear();
+}
+// -----------------------------------------------------------------------------
+void RigidBodyWorld3D::RunRange(int numItems, int minItemsPerJob, std::function<void(int startIndex, int endIndex)> const& rangeFunction) const
+{
+	if (m_config.m_jobSystem != nullptr)
+	{
+		m_config.m_jobSystem->ExecuteParallelFor(numItems, minItemsPerJob, rangeFunction);
+	}
+	else if (numItems > 0)
+	{
+		rangeFunction(0, numItems);
+	}
+}
+
+void RigidBodyWorld3D::UpdateWorldShape(int handle)
+{
+	ConvexShape3D const& localShape = m_localShapes[handle];
+	ConvexShape3D& worldShape = m_worldShapes[handle];
+	worldShape = localShape;
+	worldShape.m_center = m_positions[handle];
+	if (localShape.m_type == ConvexShapeType3D::OBB || localShape.m_type == ConvexShapeType3D::CAPSULE)
+	{
+		Quat const& orientation = m_orientations[handle];
+		worldShape.m_axes[0] = RotateByQuat(orientation, Vec3::XAXE);
+		worldShape.m_axes[1] = RotateByQuat(orientation, Vec3::YAXE);
+		worldShape.m_axes[2] = RotateByQuat(orientation, Vec3::ZAXE);
+	}
+}
+
+void RigidBodyWorld3D::UpdateBroadPhase(float deltaSeconds)
+{
+	// Bounds reach as far as the body will move this step, so pairs show up a step before they touch
+	for (int handle = 0; handle < static_cast<int>(m_positions.size()); ++handle)
+	{
+		Vec3 const& linearVelocity = m_linearVelocities[handle];
+		bool isMoving = m_inverseMasses[handle] > 0.f || linearVelocity != Vec3::ZERO || m_angularVelocities[handle] != Vec3::ZERO;
+		if (!m_isBodyInUse[handle] || !isMoving)
+		{
+			continue;
+		}
+		AABB3 bounds = GetShapeBounds(m_worldShapes[handle]);
+		Vec3 displacement = linearVelocity * deltaSeconds;
+		bounds.m_mins += Vec3(std::min(displacement.x, 0.f), std::min(displacement.y, 0.f), std::min(displacement.z, 0.f)) - Vec3(RIGID_BODY_CONTACT_MARGIN, RIGID_BODY_CONTACT_MARGIN, RIGID_BODY_CONTACT_MARGIN);
+		bounds.m_maxs += Vec3(std::max(displacement.x, 0.f), std::max(displacement.y, 0.f), std::max(displacement.z, 0.f)) + Vec3(RIGID_BODY_CONTACT_MARGIN, RIGID_BODY_CONTACT_MARGIN, RIGID_BODY_CONTACT_MARGIN);
+		m_broadPhase.Move(m_broadPhaseHandles[handle], bounds);
+	}
+	m_broadPhase.Update(m_config.m_jobSystem);
+}
+
+void RigidBodyWorld3D::UpdateManifolds()
+{
+	// Carry over the manifolds of pairs the broad phase still has, then refresh them all in parallel
+	std::vector<SweepAndPrunePair> const& pairs = m_broadPhase.GetOverlappingPairs();
+	std::vector<RigidBodyManifold3D> manifolds;
+	std::unordered_map<unsigned long long, int> manifoldIndices;
+	manifolds.reserve(pairs.size());
+	manifoldIndices.reserve(pairs.size());
+	for (int pairIndex = 0; pairIndex < static_cast<int>(pairs.size()); ++pairIndex)
+	{
+		int bodyA = m_broadPhaseBodies[pairs[pairIndex].m_handleA];
+		int bodyB = m_broadPhaseBodies[pairs[pairIndex].m_handleB];
+		if (bodyA > bodyB)
+		{
+			std::swap(bodyA, bodyB);
+		}
+		if (!m_isBodyInUse[bodyA] || !m_isBodyInUse[bodyB] || (m_inverseMasses[bodyA] == 0.f && m_inverseMasses[bodyB] == 0.f))
+		{
+			continue;
+		}
+
+		unsigned long long pairKey = GetBodyPairKey(bodyA, bodyB);
+		auto foundManifold = m_manifoldIndices.find(pairKey);
+		if (foundManifold != m_manifoldIndices.end())
+		{
+			manifolds.push_back(m_manifolds[foundManifold->second]);
+		}
+		else
+		{
+			RigidBodyManifold3D newManifold;
+			newManifold.m_bodyA = bodyA;
+			newManifold.m_bodyB = bodyB;
+			newManifold.m_friction = sqrtf(m_frictions[bodyA] * m_frictions[bodyB]);
+			newManifold.m_restitution = std::max(m_restitutions[bodyA], m_restitutions[bodyB]);
+			manifolds.push_back(newManifold);
+		}
+		manifoldIndices[pairKey] = static_cast<int>(manifolds.size()) - 1;
+	}
+	m_manifolds.swap(manifolds);
+	m_manifoldIndices.swap(manifoldIndices);
+
+	RunRange(static_cast<int>(m_manifolds.size()), RIGID_BODY_MIN_MANIFOLDS_PER_JOB, [&](int startIndex, int endIndex)
+	{
+		for (int manifoldIndex = startIndex; manifoldIndex < endIndex; ++manifoldIndex)
+		{
+			RefreshManifold(m_manifolds[manifoldIndex]);
+		}
+	});
+}
+
+void RigidBodyWorld3D::RefreshManifold(RigidBodyManifold3D& manifold) const
+{
+	int bodyA = manifold.m_bodyA;
+	int bodyB = manifold.m_bodyB;
+	ConvexShape3D const& shapeA = m_worldShapes[bodyA];
+	ConvexShape3D const& shapeB = m_worldShapes[bodyB];
+	ConvexContact3D contact;
+	if (shapeA.m_type == ConvexShapeType3D::OBB && shapeB.m_type == ConvexShapeType3D::OBB)
+	{
+		// Most box pairs from fattened bounds are diagonal neighbors well apart, and SAT's gap bound rules them out
+		// without the GJK call GetConvexShapesContact3D would make for the closest points
+		OBB3 boxA(shapeA.m_center, shapeA.m_axes[0], shapeA.m_axes[1], shapeA.m_axes[2], shapeA.m_halfDimensions);
+		OBB3 boxB(shapeB.m_center, shapeB.m_axes[0], shapeB.m_axes[1], shapeB.m_axes[2], shapeB.m_halfDimensions);
+		if (!GetOBB3sContact3D(boxA, boxB, contact))
+		{
+			if (contact.m_penetrationDepth <= -RIGID_BODY_CONTACT_MARGIN)
+			{
+				manifold.m_numPoints = 0;
+				return;
+			}
+			GetConvexShapesContactGJK3D(shapeA, shapeB, contact);
+		}
+	}
+	else
+	{
+		GetConvexShapesContact3D(shapeA, shapeB, contact);
+	}
+	Vec3 const& normal = contact.m_normal;
+
+	// Kept points move with their bodies and are measured along the new normal
+	int numKeptPoints = 0;
+	for (int pointIndex = 0; pointIndex < manifold.m_numPoints; ++pointIndex)
+	{
+		RigidBodyContactPoint3D point = manifold.m_points[pointIndex];
+		point.m_pointOnA = m_positions[bodyA] + RotateByQuat(m_orientations[bodyA], point.m_localPointOnA);
+		point.m_pointOnB = m_positions[bodyB] + RotateByQuat(m_orientations[bodyB], point.m_localPointOnB);
+		Vec3 separation = point.m_pointOnA - point.m_pointOnB;
+		point.m_depth = DotProduct3D(separation, normal);
+		Vec3 drift = separation - normal * point.m_depth;
+		if (point.m_depth > -RIGID_BODY_CONTACT_MARGIN && drift.GetLengthSquared() < RIGID_BODY_CONTACT_DRIFT_DISTANCE * RIGID_BODY_CONTACT_DRIFT_DISTANCE)
+		{
+			manifold.m_points[numKeptPoints] = point;
+			++numKeptPoints;
+		}
+	}
+	manifold.m_numPoints = numKeptPoints;
+	manifold.m_normal = normal;
+	if (contact.m_penetrationDepth <= -RIGID_BODY_CONTACT_MARGIN)
+	{
+		return;
+	}
+
+	RigidBodyContactPoint3D newPoint;
+	newPoint.m_pointOnA = contact.m_pointOnA;
+	newPoint.m_pointOnB = contact.m_pointOnB;
+	newPoint.m_localPointOnA = RotateByInverseQuat(m_orientations[bodyA], contact.m_pointOnA - m_positions[bodyA]);
+	newPoint.m_localPointOnB = RotateByInverseQuat(m_orientations[bodyB], contact.m_pointOnB - m_positions[bodyB]);
+	newPoint.m_depth = contact.m_penetrationDepth;
+
+	// Replace a kept point at the same spot, keeping its impulses to warm start from
+	for (int pointIndex = 0; pointIndex < manifold.m_numPoints; ++pointIndex)
+	{
+		RigidBodyContactPoint3D& point = manifold.m_points[pointIndex];
+		if ((point.m_pointOnA - newPoint.m_pointOnA).GetLengthSquared() < RIGID_BODY_CONTACT_MERGE_DISTANCE * RIGID_BODY_CONTACT_MERGE_DISTANCE)
+		{
+			newPoint.m_normalImpulse = point.m_normalImpulse;
+			newPoint.m_tangentImpulses[0] = point.m_tangentImpulses[0];
+			newPoint.m_tangentImpulses[1] = point.m_tangentImpulses[1];
+			point = newPoint;
+			return;
+		}
+	}
+	if (manifold.m_numPoints < RIGID_BODY_MAX_MANIFOLD_POINTS)
+	{
+		manifold.m_points[manifold.m_numPoints] = newPoint;
+		++manifold.m_numPoints;
+		return;
+	}
+
+	// Full, so keep the deepest point and whichever other three span the largest area with the new one
+	int deepestPoint = -1;
+	float deepestDepth = newPoint.m_depth;
+	for (int pointIndex = 0; pointIndex < RIGID_BODY_MAX_MANIFOLD_POINTS; ++pointIndex)
+	{
+		if (manifold.m_points[pointIndex].m_depth > deepestDepth)
+		{
+			deepestDepth = manifold.m_points[pointIndex].m_depth;
+			deepestPoint = pointIndex;
+		}
+	}
+	int replacedPoint = -1;
+	float largestArea = -1.f;
+	for (int pointIndex = 0; pointIndex < RIGID_BODY_MAX_MANIFOLD_POINTS; ++pointIndex)
+	{
+		if (pointIndex == deepestPoint)
+		{
+			continue;
+		}
+		Vec3 corners[RIGID_BODY_MAX_MANIFOLD_POINTS];
+		for (int cornerIndex = 0; cornerIndex < RIGID_BODY_MAX_MANIFOLD_POINTS; ++cornerIndex)
+		{
+			corners[cornerIndex] = cornerIndex == pointIndex ? newPoint.m_pointOnA : manifold.m_points[cornerIndex].m_pointOnA;
+		}
+		float area = CrossProduct3D(corners[0] - corners[1], corners[2] - corners[3]).GetLengthSquared();
+		area = std::max(area, CrossProduct3D(corners[0] - corners[2], corners[1] - corners[3]).GetLengthSquared());
+		area = std::max(area, CrossProduct3D(corners[0] - corners[3], corners[1] - corners[2]).GetLengthSquared());
+		if (area > largestArea)
+		{
+			largestArea = area;
+			replacedPoint = pointIndex;
+		}
+	}
+	manifold.m_points[replacedPoint] = newPoint;
+}
+// -----------------------------------------------------------------------------
+void RigidBodyWorld3D::BuildIslands()
+{
+	// Dynamic bodies in contact share an island, static ones join none since the solver never moves them
+	int numHandles = static_cast<int>(m_positions.size());
+	m_islandParents.resize(numHandles);
+	for (int handle = 0; handle < numHandles; ++handle)
+	{
+		m_islandParents[handle] = handle;
+	}
+	for (int manifoldIndex = 0; manifoldIndex < static_cast<int>(m_manifolds.size()); ++manifoldIndex)
+	{
+		RigidBodyManifold3D const& manifold = m_manifolds[manifoldIndex];
+		if (manifold.m_numPoints > 0 && m_inverseMasses[manifold.m_bodyA] > 0.f && m_inverseMasses[manifold.m_bodyB] > 0.f)
+		{
+			int rootA = FindIslandRoot(m_islandParents, manifold.m_bodyA);
+			int rootB = FindIslandRoot(m_islandParents, manifold.m_bodyB);
+			m_islandParents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+		}
+	}
+
+	// Number the islands that have contacts, then bucket their bodies and manifolds
+	std::vector<int> rootIslands(numHandles, -1);
+	std::vector<int> manifoldIslands(m_manifolds.size(), -1);
+	std::vector<int> islandNumManifolds;
+	for (int manifoldIndex = 0; manifoldIndex < static_cast<int>(m_manifolds.size()); ++manifoldIndex)
+	{
+		RigidBodyManifold3D const& manifold = m_manifolds[manifoldIndex];
+		if (manifold.m_numPoints == 0)
+		{
+			continue;
+		}
+		int dynamicBody = m_inverseMasses[manifold.m_bodyA] > 0.f ? manifold.m_bodyA : manifold.m_bodyB;
+		int root = FindIslandRoot(m_islandParents, dynamicBody);
+		if (rootIslands[root] < 0)
+		{
+			rootIslands[root] = static_cast<int>(islandNumManifolds.size());
+			islandNumManifolds.push_back(0);
+		}
+		manifoldIslands[manifoldIndex] = rootIslands[root];
+		++islandNumManifolds[rootIslands[root]];
+	}
+
+	// Largest islands first so they start solving before the small ones
+	int numIslands = static_cast<int>(islandNumManifolds.size());
+	std::vector<int> islandOrder(numIslands);
+	for (int islandIndex = 0; islandIndex < numIslands; ++islandIndex)
+	{
+		islandOrder[islandIndex] = islandIndex;
+	}
+	std::stable_sort(islandOrder.begin(), islandOrder.end(), [&](int islandA, int islandB) { return islandNumManifolds[islandA] > islandNumManifolds[islandB]; });
+	std::vector<int> islandRanks(numIslands);
+	for (int rank = 0; rank < numIslands; ++rank)
+	{
+		islandRanks[islandOrder[rank]] = rank;
+	}
+
+	m_islandManifoldStarts.assign(numIslands + 1, 0);
+	m_islandBodyStarts.assign(numIslands + 1, 0);
+	for (int manifoldIndex = 0; manifoldIndex < static_cast<int>(m_manifolds.size()); ++manifoldIndex)
+	{
+		if (manifoldIslands[manifoldIndex] >= 0)
+		{
+			++m_islandManifoldStarts[islandRanks[manifoldIslands[manifoldIndex]] + 1];
+		}
+	}
+	for (int handle = 0; handle < numHandles; ++handle)
+	{
+		int island = m_inverseMasses[handle] > 0.f ? rootIslands[FindIslandRoot(m_islandParents, handle)] : -1;
+		if (island >= 0)
+		{
+			++m_islandBodyStarts[islandRanks[island] + 1];
+		}
+	}
+	for (int rank = 0; rank < numIslands; ++rank)
+	{
+		m_islandManifoldStarts[rank + 1] += m_islandManifoldStarts[rank];
+		m_islandBodyStarts[rank + 1] += m_islandBodyStarts[rank];
+	}
+
+	std::vector<int> manifoldCursors(m_islandManifoldStarts.begin(), m_islandManifoldStarts.end() - 1);
+	std::vector<int> bodyCursors(m_islandBodyStarts.begin(), m_islandBodyStarts.end() - 1);
+	m_islandManifolds.resize(m_islandManifoldStarts[numIslands]);
+	m_islandBodies.resize(m_islandBodyStarts[numIslands]);
+	for (int manifoldIndex = 0; manifoldIndex < static_cast<int>(m_manifolds.size()); ++manifoldIndex)
+	{
+		if (manifoldIslands[manifoldIndex] >= 0)
+		{
+			m_islandManifolds[manifoldCursors[islandRanks[manifoldIslands[manifoldIndex]]]++] = manifoldIndex;
+		}
+	}
+	for (int handle = 0; handle < numHandles; ++handle)
+	{
+		int island = m_inverseMasses[handle] > 0.f ? rootIslands[FindIslandRoot(m_islandParents, handle)] : -1;
+		if (island >= 0)
+		{
+			m_islandBodies[bodyCursors[islandRanks[island]]++] = handle;
+		}
+	}
+}
+
+void RigidBodyWorld3D::SolveIslands(float deltaSeconds)
+{
+	m_solverBodyIndices.resize(m_positions.size());
+	RunRange(GetNumIslands(), 1, [&](int startIndex, int endIndex)
+	{
+		std::vector<RigidBodySolverBody3D> solverBodies;
+		std::vector<RigidBodyContactConstraint3D> constraints;
+		for (int islandIndex = startIndex; islandIndex < endIndex; ++islandIndex)
+		{
+			SolveIsland(islandIndex, deltaSeconds, solverBodies, constraints);
+		}
+	});
+}
+
+static void CopyVec3ToFloats(Vec3 const& vector, float* out_floats)
+{
+	out_floats[0] = vector.x;
+	out_floats[1] = vector.y;
+	out_floats[2] = vector.z;
+}
+
+static void ApplySolverImpulse(std::vector<RigidBodySolverBody3D>& solverBodies, RigidBodyContactConstraint3D const& constraint, int directionIndex, float impulse)
+{
+	// Static bodies have no inverse mass or inertia, so their shared solver body never picks up a velocity
+	RigidBodySolverBody3D& bodyA = solverBodies[constraint.m_solverBodyA];
+	RigidBodySolverBody3D& bodyB = solverBodies[constraint.m_solverBodyB];
+	float const* direction = constraint.m_directions[directionIndex];
+	float const* angularImpulseA = constraint.m_angularImpulsesA[directionIndex];
+	float const* angularImpulseB = constraint.m_angularImpulsesB[directionIndex];
+	float linearImpulseA = impulse * constraint.m_inverseMassA;
+	float linearImpulseB = impulse * constraint.m_inverseMassB;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		bodyA.m_linearVelocity[axis] -= direction[axis] * linearImpulseA;
+		bodyA.m_angularVelocity[axis] -= angularImpulseA[axis] * impulse;
+		bodyB.m_linearVelocity[axis] += direction[axis] * linearImpulseB;
+		bodyB.m_angularVelocity[axis] += angularImpulseB[axis] * impulse;
+	}
+}
+
+static float GetSolverRelativeSpeed(std::vector<RigidBodySolverBody3D> const& solverBodies, RigidBodyContactConstraint3D const& constraint, int directionIndex)
+{
+	RigidBodySolverBody3D const& bodyA = solverBodies[constraint.m_solverBodyA];
+	RigidBodySolverBody3D const& bodyB = solverBodies[constraint.m_solverBodyB];
+	float const* direction = constraint.m_directions[directionIndex];
+	float const* armCrossDirectionA = constraint.m_armCrossDirectionsA[directionIndex];
+	float const* armCrossDirectionB = constraint.m_armCrossDirectionsB[directionIndex];
+	// Summed as a shallow tree, since one long chain of adds is most of a row's latency
+	float linearSpeeds[3];
+	float angularSpeeds[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		linearSpeeds[axis] = (bodyB.m_linearVelocity[axis] - bodyA.m_linearVelocity[axis]) * direction[axis];
+		angularSpeeds[axis] = bodyB.m_angularVelocity[axis] * armCrossDirectionB[axis] - bodyA.m_angularVelocity[axis] * armCrossDirectionA[axis];
+	}
+	return ((linearSpeeds[0] + linearSpeeds[1]) + (linearSpeeds[2] + angularSpeeds[0])) + (angularSpeeds[1] + angularSpeeds[2]);
+}
+
+void RigidBodyWorld3D::SolveIsland(int islandIndex, float deltaSeconds, std::vector<RigidBodySolverBody3D>& solverBodies, std::vector<RigidBodyContactConstraint3D>& constraints)
+{
+	// Copy the island's velocities out, with one more solver body at rest for every static body
+	int islandBodyStart = m_islandBodyStarts[islandIndex];
+	int numIslandBodies = m_islandBodyStarts[islandIndex + 1] - islandBodyStart;
+	solverBodies.resize(numIslandBodies + 1);
+	for (int solverBodyIndex = 0; solverBodyIndex < numIslandBodies; ++solverBodyIndex)
+	{
+		int handle = m_islandBodies[islandBodyStart + solverBodyIndex];
+		m_solverBodyIndices[handle] = solverBodyIndex;
+		CopyVec3ToFloats(m_linearVelocities[handle], solverBodies[solverBodyIndex].m_linearVelocity);
+		CopyVec3ToFloats(m_angularVelocities[handle], solverBodies[solverBodyIndex].m_angularVelocity);
+	}
+	solverBodies[numIslandBodies] = RigidBodySolverBody3D();
+
+	// Prepare every point, warm starting from last step's impulses
+	constraints.clear();
+	constraints.reserve((m_islandManifoldStarts[islandIndex + 1] - m_islandManifoldStarts[islandIndex]) * RIGID_BODY_MAX_MANIFOLD_POINTS);
+	float inverseDeltaSeconds = 1.f / deltaSeconds;
+	for (int islandManifoldIndex = m_islandManifoldStarts[islandIndex]; islandManifoldIndex < m_islandManifoldStarts[islandIndex + 1]; ++islandManifoldIndex)
+	{
+		int manifoldIndex = m_islandManifolds[islandManifoldIndex];
+		RigidBodyManifold3D const& manifold = m_manifolds[manifoldIndex];
+		int bodyA = manifold.m_bodyA;
+		int bodyB = manifold.m_bodyB;
+		Vec3 const& normal = manifold.m_normal;
+		Vec3 directions[3];
+		directions[0] = normal;
+		directions[1] = CrossProduct3D(GetLeastAlignedAxis(normal), normal).GetNormalized();
+		directions[2] = CrossProduct3D(normal, directions[1]);
+
+		for (int pointIndex = 0; pointIndex < manifold.m_numPoints; ++pointIndex)
+		{
+			RigidBodyContactPoint3D const& point = manifold.m_points[pointIndex];
+			RigidBodyContactConstraint3D constraint;
+			constraint.m_manifoldIndex = manifoldIndex;
+			constraint.m_pointIndex = pointIndex;
+			constraint.m_inverseMassA = m_inverseMasses[bodyA];
+			constraint.m_inverseMassB = m_inverseMasses[bodyB];
+			constraint.m_solverBodyA = constraint.m_inverseMassA > 0.f ? m_solverBodyIndices[bodyA] : numIslandBodies;
+			constraint.m_solverBodyB = constraint.m_inverseMassB > 0.f ? m_solverBodyIndices[bodyB] : numIslandBodies;
+			constraint.m_friction = manifold.m_friction;
+			constraint.m_impulses[0] = point.m_normalImpulse;
+			constraint.m_impulses[1] = point.m_tangentImpulses[0];
+			constraint.m_impulses[2] = point.m_tangentImpulses[1];
+
+			Vec3 armA = point.m_pointOnA - m_positions[bodyA];
+			Vec3 armB = point.m_pointOnB - m_positions[bodyB];
+			for (int directionIndex = 0; directionIndex < 3; ++directionIndex)
+			{
+				Vec3 const& direction = directions[directionIndex];
+				Vec3 armCrossDirectionA = CrossProduct3D(armA, direction);
+				Vec3 armCrossDirectionB = CrossProduct3D(armB, direction);
+				Vec3 angularImpulseA = ApplyInverseInertia(bodyA, armCrossDirectionA);
+				Vec3 angularImpulseB = ApplyInverseInertia(bodyB, armCrossDirectionB);
+				float inverseEffectiveMass = constraint.m_inverseMassA + constraint.m_inverseMassB + DotProduct3D(armCrossDirectionA, angularImpulseA) + DotProduct3D(armCrossDirectionB, angularImpulseB);
+				constraint.m_effectiveMasses[directionIndex] = inverseEffectiveMass > 0.f ? 1.f / inverseEffectiveMass : 0.f;
+				CopyVec3ToFloats(direction, constraint.m_directions[directionIndex]);
+				CopyVec3ToFloats(armCrossDirectionA, constraint.m_armCrossDirectionsA[directionIndex]);
+				CopyVec3ToFloats(armCrossDirectionB, constraint.m_armCrossDirectionsB[directionIndex]);
+				CopyVec3ToFloats(angularImpulseA, constraint.m_angularImpulsesA[directionIndex]);
+				CopyVec3ToFloats(angularImpulseB, constraint.m_angularImpulsesB[directionIndex]);
+			}
+
+			// Push out part of any penetration, or let a speculative point close its gap within the step
+			if (point.m_depth > 0.f)
+			{
+				constraint.m_bias = RIGID_BODY_POSITION_CORRECTION * inverseDeltaSeconds * std::max(point.m_depth - RIGID_BODY_ALLOWED_PENETRATION, 0.f);
+			}
+			else
+			{
+				constraint.m_bias = point.m_depth * inverseDeltaSeconds;
+			}
+			float normalSpeed = GetSolverRelativeSpeed(solverBodies, constraint, 0);
+			if (normalSpeed < -RIGID_BODY_RESTITUTION_MIN_SPEED)
+			{
+				constraint.m_bias = std::max(constraint.m_bias, -manifold.m_restitution * normalSpeed);
+			}
+			constraints.push_back(constraint);
+		}
+	}
+
+	int numConstraints = static_cast<int>(constraints.size());
+	for (int constraintIndex = 0; constraintIndex < numConstraints; ++constraintIndex)
+	{
+		for (int directionIndex = 0; directionIndex < 3; ++directionIndex)
+		{
+			ApplySolverImpulse(solverBodies, constraints[constraintIndex], directionIndex, constraints[constraintIndex].m_impulses[directionIndex]);
+		}
+	}
+
+	// Friction first so the normal impulse, which bounds it, gets the last word each iteration
+	for (int iteration = 0; iteration < m_config.m_numVelocityIterations; ++iteration)
+	{
+		for (int constraintIndex = 0; constraintIndex < numConstraints; ++constraintIndex)
+		{
+			RigidBodyContactConstraint3D& constraint = constraints[constraintIndex];
+			float maxFrictionImpulse = constraint.m_friction * constraint.m_impulses[0];
+			for (int directionIndex = 1; directionIndex < 3; ++directionIndex)
+			{
+				float impulseChange = -GetSolverRelativeSpeed(solverBodies, constraint, directionIndex) * constraint.m_effectiveMasses[directionIndex];
+				float newImpulse = GetClamped(constraint.m_impulses[directionIndex] + impulseChange, -maxFrictionImpulse, maxFrictionImpulse);
+				impulseChange = newImpulse - constraint.m_impulses[directionIndex];
+				constraint.m_impulses[directionIndex] = newImpulse;
+				ApplySolverImpulse(solverBodies, constraint, directionIndex, impulseChange);
+			}
+
+			float impulseChange = (constraint.m_bias - GetSolverRelativeSpeed(solverBodies, constraint, 0)) * constraint.m_effectiveMasses[0];
+			float newImpulse = std::max(constraint.m_impulses[0] + impulseChange, 0.f);
+			impulseChange = newImpulse - constraint.m_impulses[0];
+			constraint.m_impulses[0] = newImpulse;
+			ApplySolverImpulse(solverBodies, constraint, 0, impulseChange);
+		}
+	}
+
+	for (int constraintIndex = 0; constraintIndex < numConstraints; ++constraintIndex)
+	{
+		RigidBodyContactConstraint3D const& constraint = constraints[constraintIndex];
+		RigidBodyContactPoint3D& point = m_manifolds[constraint.m_manifoldIndex].m_points[constraint.m_pointIndex];
+		point.m_normalImpulse = constraint.m_impulses[0];
+		point.m_tangentImpulses[0] = constraint.m_impulses[1];
+		point.m_tangentImpulses[1] = constraint.m_impulses[2];
+	}
+	for (int solverBodyIndex = 0; solverBodyIndex < numIslandBodies; ++solverBodyIndex)
+	{
+		int handle = m_islandBodies[islandBodyStart + solverBodyIndex];
+		RigidBodySolverBody3D const& solverBody = solverBodies[solverBodyIndex];
+		m_linearVelocities[handle] = Vec3(solverBody.m_linearVelocity[0], solverBody.m_linearVelocity[1], solverBody.m_linearVelocity[2]);
+		m_angularVelocities[handle] = Vec3(solverBody.m_angularVelocity[0], solverBody.m_angularVelocity[1], solverBody.m_angularVelocity[2]);
+	}
+}
+
+void RigidBodyWorld3D::IntegratePositions(float deltaSeconds)
+{
+	RunRange(static_cast<int>(m_positions.size()), RIGID_BODY_MIN_BODIES_PER_JOB, [&](int startIndex, int endIndex)
+	{
+		for (int handle = startIndex; handle < endIndex; ++handle)
+		{
+			Vec3 const& linearVelocity = m_linearVelocities[handle];
+			Vec3 const& angularVelocity = m_angularVelocities[handle];
+			if (!m_isBodyInUse[handle] || (linearVelocity == Vec3::ZERO && angularVelocity == Vec3::ZERO))
+			{
+				continue;
+			}
+			m_positions[handle] += linearVelocity * deltaSeconds;
+
+			// dq/dt = (w, 0) * q / 2
+			Quat& orientation = m_orientations[handle];
+			Vec3 axis(orientation.m_x, orientation.m_y, orientation.m_z);
+			Vec3 axisChange = (angularVelocity * orientation.m_w + CrossProduct3D(angularVelocity, axis)) * (0.5f * deltaSeconds);
+			float realChange = -0.5f * deltaSeconds * DotProduct3D(angularVelocity, axis);
+			orientation = Quat(orientation.m_x + axisChange.x, orientation.m_y + axisChange.y, orientation.m_z + axisChange.z, orientation.m_w + realChange).GetNormalized();
+			UpdateWorldShape(handle);
+		}
+	});
+}
+
+Vec3 RigidBodyWorld3D::ApplyInverseInertia(int handle, Vec3 const& angularImpulse) const
+{
+	Vec3 const& inverseInertia = m_inverseInertias[handle];
+	if (inverseInertia == Vec3::ZERO)
+	{
+		return Vec3::ZERO;
+	}
+	Quat const& orientation = m_orientations[handle];
+	return RotateByQuat(orientation, RotateByInverseQuat(orientation, angularImpulse) * inverseInertia);
+}
+// -----------------------------------------------------------------------------
+void RigidBodyWorld3D::SetBodyTransform(int handle, Vec3 const& position, Quat const& orientation)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::SetBodyTransform given invalid handle %d", handle));
+	m_positions[handle] = position;
+	m_orientations[handle] = orientation.GetNormalized();
+	UpdateWorldShape(handle);
+	m_broadPhase.Move(m_broadPhaseHandles[handle], GetShapeBounds(m_worldShapes[handle]));
+}
+
+void RigidBodyWorld3D::SetBodyLinearVelocity(int handle, Vec3 const& linearVelocity)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::SetBodyLinearVelocity given invalid handle %d", handle));
+	m_linearVelocities[handle] = linearVelocity;
+}
+
+void RigidBodyWorld3D::SetBodyAngularVelocity(int handle, Vec3 const& angularVelocity)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::SetBodyAngularVelocity given invalid handle %d", handle));
+	m_angularVelocities[handle] = angularVelocity;
+}
+
+void RigidBodyWorld3D::ApplyImpulse(int handle, Vec3 const& impulse, Vec3 const& worldPoint)
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::ApplyImpulse given invalid handle %d", handle));
+	m_linearVelocities[handle] += impulse * m_inverseMasses[handle];
+	m_angularVelocities[handle] += ApplyInverseInertia(handle, CrossProduct3D(worldPoint - m_positions[handle], impulse));
+}
+
+Vec3 const& RigidBodyWorld3D::GetBodyPosition(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::GetBodyPosition given invalid handle %d", handle));
+	return m_positions[handle];
+}
+
+Quat const& RigidBodyWorld3D::GetBodyOrientation(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::GetBodyOrientation given invalid handle %d", handle));
+	return m_orientations[handle];
+}
+
+Vec3 const& RigidBodyWorld3D::GetBodyLinearVelocity(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::GetBodyLinearVelocity given invalid handle %d", handle));
+	return m_linearVelocities[handle];
+}
+
+Vec3 const& RigidBodyWorld3D::GetBodyAngularVelocity(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::GetBodyAngularVelocity given invalid handle %d", handle));
+	return m_angularVelocities[handle];
+}
+
+ConvexShape3D const& RigidBodyWorld3D::GetBodyWorldShape(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::GetBodyWorldShape given invalid handle %d", handle));
+	return m_worldShapes[handle];
+}
+
+bool RigidBodyWorld3D::IsBodyStatic(int handle) const
+{
+	GUARANTEE_OR_DIE(IsValidHandle(handle), Stringf("RigidBodyWorld3D::IsBodyStatic given invalid handle %d", handle));
+	return m_inverseMasses[handle] == 0.f;
+}
+
+bool RigidBodyWorld3D::IsValidHandle(int handle) const
+{
+	return handle >= 0 && handle < static_cast<int>(m_isBodyInUse.size()) && m_isBodyInUse[handle] != 0;
+}
+
+int RigidBodyWorld3D::GetNumBodies() const
+{
+	return m_numBodies;
+}
+
+std::vector<RigidBodyManifold3D> const& RigidBodyWorld3D::GetManifolds() const
+{
+	return m_manifolds;
+}
+
+int RigidBodyWorld3D::GetNumIslands() const
+{
+	return m_islandBodyStarts.empty() ? 0 : static_cast<int>(m_islandBodyStarts.size()) - 1;
+}
+
+int RigidBodyWorld3D::GetNumContactPoints() const
+{
+	int numContactPoints = 0;
+	for (int manifoldIndex = 0; manifoldIndex < static_cast<int>(m_manifolds.size()); ++manifoldIndex)
+	{
+		numContactPoints += m_manifolds[manifoldIndex].m_numPoints;
+	}
+	return numContactPoints;
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,144 @@
+#pragma once
+#include "Engine/Math/ConvexCollision3D.hpp"
+#include "Engine/Math/Quat.hpp"
+#include "Engine/Math/SweepAndPrune3D.hpp"
+#include <functional>
+#include <unordered_map>
+#include <vector>
+// -----------------------------------------------------------------------------
+class Clock;
+class JobSystem;
+struct RigidBodyContactConstraint3D;
+struct RigidBodySolverBody3D;
+// -----------------------------------------------------------------------------
+constexpr int RIGID_BODY_MAX_MANIFOLD_POINTS = 4;
+// -----------------------------------------------------------------------------
+struct RigidBodyWorld3DConfig
+{
+	Clock*	   m_clock = nullptr;						// Drives Update, the system clock if null
+	JobSystem* m_jobSystem = nullptr;					// Runs the broad phase sweep, narrow phase, islands and integration in parallel if set
+	Vec3	   m_gravity = Vec3(0.f, 0.f, -9.8f);
+	float	   m_fixedStepSeconds = 1.f / 60.f;
+	int		   m_maxStepsPerUpdate = 4;				// Time beyond this many steps is dropped rather than caught up
+	int		   m_numVelocityIterations = 10;
+};
+
+struct RigidBody3DConfig
+{
+	ConvexShape3D m_shape;					// In world space, its center becomes the body's position and its axes the body's orientation
+	float		  m_mass = 1.f;				// Zero for static bodies
+	float		  m_friction = 0.5f;
+	float		  m_restitution = 0.f;
+	Vec3		  m_linearVelocity;
+	Vec3		  m_angularVelocity;		// Radians per second
+};
+// -----------------------------------------------------------------------------
+struct RigidBodyContactPoint3D
+{
+	Vec3  m_localPointOnA;					// In body A's frame, so the point follows the body between steps
+	Vec3  m_localPointOnB;
+	Vec3  m_pointOnA;
+	Vec3  m_pointOnB;
+	float m_depth = 0.f;					// Negative while the bodies are still apart
+	float m_normalImpulse = 0.f;			// Accumulated over a step, and the next step starts from it
+	float m_tangentImpulses[2] = { 0.f, 0.f };
+};
+
+// The persistent contact between two bodies. GJK/EPA finds one point per step, the manifold keeps the points of the
+// last few steps that still hold, so boxes resting on a face get the corners they need to stay flat.
+struct RigidBodyManifold3D
+{
+	int						m_bodyA = -1;	// The lower handle
+	int						m_bodyB = -1;
+	Vec3					m_normal;		// From A to B
+	float					m_friction = 0.f;
+	float					m_restitution = 0.f;
+	int						m_numPoints = 0;
+	RigidBodyContactPoint3D m_points[RIGID_BODY_MAX_MANIFOLD_POINTS];
+};
+// -----------------------------------------------------------------------------
+// Rigid bodies of one convex shape each, stored as a struct of arrays by handle. A step applies gravity, finds pairs
+// with a SweepAndPrune3D, refreshes contact manifolds with GetConvexShapesContact3D, splits the bodies touching each
+// other into islands and solves each island with sequential impulses before integrating. Islands share no dynamic
+// bodies, so they solve in parallel and give the same result with or without a job system.
+//
+// Z-cylinders keep their z axis up, so their bodies never rotate. Static bodies may still be moved with
+// SetBodyTransform and given a velocity, which makes them kinematic.
+class RigidBodyWorld3D
+{
+public:
+	explicit RigidBodyWorld3D(RigidBodyWorld3DConfig const& config);
+	~RigidBodyWorld3D() = default;
+
+	int	 AddBody(RigidBody3DConfig const& bodyConfig); // Returns the body's handle, handles of removed bodies are reused after the next step
+	void RemoveBody(int handle);
+	void Clear();
+
+	void Update();					// Runs the fixed steps the clock's time since the last Update covers
+	void Step(float deltaSeconds);	// One step, for tests and replays that do without a clock
+
+	void SetBodyTransform(int handle, Vec3 const& position, Quat const& orientation);
+	void SetBodyLinearVelocity(int handle, Vec3 const& linearVelocity);
+	void SetBodyAngularVelocity(int handle, Vec3 const& angularVelocity);
+	void ApplyImpulse(int handle, Vec3 const& impulse, Vec3 const& worldPoint);
+
+	Vec3 const&			 GetBodyPosition(int handle) const;
+	Quat const&			 GetBodyOrientation(int handle) const;
+	Vec3 const&			 GetBodyLinearVelocity(int handle) const;
+	Vec3 const&			 GetBodyAngularVelocity(int handle) const;
+	ConvexShape3D const& GetBodyWorldShape(int handle) const;
+	bool				 IsBodyStatic(int handle) const;
+	bool				 IsValidHandle(int handle) const;
+	int					 GetNumBodies() const;
+
+	std::vector<RigidBodyManifold3D> const& GetManifolds() const;	// As of the last step
+	int										GetNumIslands() const;
+	int										GetNumContactPoints() const;
+
+private:
+	void RunRange(int numItems, int minItemsPerJob, std::function<void(int startIndex, int endIndex)> const& rangeFunction) const;
+	void UpdateWorldShape(int handle);
+	void UpdateBroadPhase(float deltaSeconds);
+	void UpdateManifolds();
+	void RefreshManifold(RigidBodyManifold3D& manifold) const;
+	void BuildIslands();
+	void SolveIslands(float deltaSeconds);
+	void SolveIsland(int islandIndex, float deltaSeconds, std::vector<RigidBodySolverBody3D>& solverBodies, std::vector<RigidBodyContactConstraint3D>& constraints);
+	void IntegratePositions(float deltaSeconds);
+	Vec3 ApplyInverseInertia(int handle, Vec3 const& angularImpulse) const;
+
+private:
+	RigidBodyWorld3DConfig m_config;
+	double				   m_unsteppedSeconds = 0.0;
+
+	// Bodies by handle
+	std::vector<Vec3>			 m_positions;
+	std::vector<Quat>			 m_orientations;
+	std::vector<Vec3>			 m_linearVelocities;
+	std::vector<Vec3>			 m_angularVelocities;
+	std::vector<float>			 m_inverseMasses;
+	std::vector<Vec3>			 m_inverseInertias;		// About the body's own axes, zero for bodies that do not rotate
+	std::vector<float>			 m_frictions;
+	std::vector<float>			 m_restitutions;
+	std::vector<ConvexShape3D>	 m_localShapes;			// Centered on the body with identity axes
+	std::vector<ConvexShape3D>	 m_worldShapes;
+	std::vector<int>			 m_broadPhaseHandles;
+	std::vector<unsigned char>	 m_isBodyInUse;
+	std::vector<int>			 m_freeHandles;
+	std::vector<int>			 m_removedHandles;		// Freed by the next step
+	int							 m_numBodies = 0;
+
+	SweepAndPrune3D				 m_broadPhase;
+	std::vector<int>			 m_broadPhaseBodies;	// Body handle by broad phase handle
+
+	std::vector<RigidBodyManifold3D>			m_manifolds;
+	std::unordered_map<unsigned long long, int> m_manifoldIndices;	// Body pair key to its index in m_manifolds
+
+	// Islands as of the last step, each a range of m_islandBodies and of m_islandManifolds
+	std::vector<int> m_islandParents;		// Union-find by body handle
+	std::vector<int> m_islandBodies;
+	std::vector<int> m_islandManifolds;
+	std::vector<int> m_islandBodyStarts;	// One more than the number of islands
+	std::vector<int> m_islandManifoldStarts;
+	std::vector<int> m_solverBodyIndices;	// By body handle, the body's place in its island while it solves
+};
@@ -150,4 +150,12 @@ Mat44 Camera::GetProjectionMatrix() const
 	}
 
 	return projectionMatrix;
+}
+
+Frustum3 Camera::GetFrustum() const
+{
+	Mat44 worldToClip = GetRenderToClipTransform();
+	worldToClip.Append(GetCameraToRenderTransform());
+	worldToClip.Append(GetWorldToCameraTransform());
+	return Frustum3::MakeFromWorldToClipTransform(worldToClip);
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Engine/Math/Mat44.hpp"
 #include "Engine/Math/AABB2.h"
 #include "Engine/Math/IntVec2.h"
+#include "Engine/Math/Frustum3.hpp"
 // -----------------------------------------------------------------------------
 class Camera 
 {
@@ -44,6 +45,7 @@ public:
 	Mat44 GetOrthographicMatrix() const;
 	Mat44 GetPerspectiveMatrix() const;
 	Mat44 GetProjectionMatrix() const;
+	Frustum3 GetFrustum() const; // World space view volume for culling, matches what the renderer draws
 
 	AABB2 m_normalizedViewport = AABB2::ZERO_TO_ONE;
 protected:
@@ -5,7 +5,8 @@
 IndexBuffer::IndexBuffer(ID3D11Device* device, unsigned int size, unsigned int stride)
 	:m_device(device), m_size(size), m_stride(stride)
 {
-	m_stride = sizeof(unsigned int);
+	// Only 16 and 32 bit indexes are supported, anything else is treated as 32 bit
+	m_stride = (stride == sizeof(unsigned short)) ? sizeof(unsigned short) : sizeof(unsigned int);
 	Create();
 }
 
@@ -21,12 +21,15 @@
 #include "Engine/Math/MathUtils.h"
 #include "Engine/Core/Rgba8.h"
 #include "Engine/Core/Image.hpp"
+#include "Engine/Core/BlockCompression.hpp"
+#include "Engine/Core/ImageMips.hpp"
 #include "Engine/Core/Vertex_PCU.h"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/FileUtils.hpp"
 #include "Engine/Core/EngineCommon.h"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/Time.hpp"
+#include <algorithm>
 // -----------------------------------------------------------------------------
 #if defined(ENGINE_DEBUG_RENDER)
 #include <dxgidebug.h>
@@ -724,6 +727,113 @@ Texture* Renderer::CreateTextureFromImage(Image const& image, unsigned int mipMa
 	return newTexture;
 }
 
+//-----------------------------------------------------------------------------------------------
+Texture* Renderer::CreateTextureFromMipChain(std::vector<Image> const& mipChain)
+{
+	GUARANTEE_OR_DIE(!mipChain.empty(), "CreateTextureFromMipChain needs at least the base level");
+
+	int numLevels = static_cast<int>(mipChain.size());
+	std::vector<TextureCacheLevel> levels(numLevels);
+	std::vector<void const*> levelData(numLevels);
+	for (int levelIndex = 0; levelIndex < numLevels; ++levelIndex)
+	{
+		IntVec2 levelDims = mipChain[levelIndex].GetDimensions();
+		levels[levelIndex].m_width = levelDims.x;
+		levels[levelIndex].m_height = levelDims.y;
+		levels[levelIndex].m_rowPitch = levelDims.x * 4;
+		levelData[levelIndex] = mipChain[levelIndex].GetRawData();
+	}
+	return CreateImmutableTexture(mipChain[0].GetImageFilePath(), TextureCacheFormat::RGBA8, levels, levelData);
+}
+
+//-----------------------------------------------------------------------------------------------
+Texture* Renderer::CreateTextureFromCompressedMipChain(std::vector<CompressedImage> const& mipChain)
+{
+	GUARANTEE_OR_DIE(!mipChain.empty(), "CreateTextureFromCompressedMipChain needs at least the base level");
+	CompressedImage const& baseImage = mipChain[0];
+
+	int numLevels = static_cast<int>(mipChain.size());
+	std::vector<TextureCacheLevel> levels(numLevels);
+	std::vector<void const*> levelData(numLevels);
+	for (int levelIndex = 0; levelIndex < numLevels; ++levelIndex)
+	{
+		CompressedImage const& levelImage = mipChain[levelIndex];
+		GUARANTEE_OR_DIE(levelImage.m_format == baseImage.m_format, Stringf("Compressed mip chain for \"%s\" mixes block formats", baseImage.m_imageFilePath.c_str()));
+		levels[levelIndex].m_width = levelImage.m_dimensions.x;
+		levels[levelIndex].m_height = levelImage.m_dimensions.y;
+		levels[levelIndex].m_rowPitch = GetBlockCompressionBlockCounts(levelImage.m_dimensions).x * GetBlockCompressionBytesPerBlock(levelImage.m_format);
+		levelData[levelIndex] = levelImage.m_blocks.data();
+	}
+	return CreateImmutableTexture(baseImage.m_imageFilePath, GetTextureCacheFormat(baseImage.m_format), levels, levelData);
+}
+
+//-----------------------------------------------------------------------------------------------
+Texture* Renderer::CreateImmutableTexture(std::string const& name, TextureCacheFormat format, std::vector<TextureCacheLevel> const& levels, std::vector<void const*> const& levelData)
+{
+	IntVec2 dims(static_cast<int>(levels[0].m_width), static_cast<int>(levels[0].m_height));
+	unsigned int mipMapLevels = static_cast<unsigned int>(levels.size());
+
+	D3D11_TEXTURE2D_DESC textureDesc = { };
+	textureDesc.Width = dims.x;
+	textureDesc.Height = dims.y;
+	textureDesc.MipLevels = mipMapLevels;
+	textureDesc.ArraySize = 1;
+	switch (format)
+	{
+		case TextureCacheFormat::BC1: textureDesc.Format = DXGI_FORMAT_BC1_UNORM; break;
+		case TextureCacheFormat::BC3: textureDesc.Format = DXGI_FORMAT_BC3_UNORM; break;
+		case TextureCacheFormat::BC7: textureDesc.Format = DXGI_FORMAT_BC7_UNORM; break;
+		default:					  textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; break;
+	}
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+	// D3D11 only accepts block compressed textures whose top level is made of whole blocks
+	if (format != TextureCacheFormat::RGBA8)
+	{
+		GUARANTEE_OR_DIE(dims.x % 4 == 0 && dims.y % 4 == 0, Stringf("\"%s\" is %dx%d, block compressed textures need multiples of 4", name.c_str(), dims.x, dims.y));
+	}
+
+	// Every level goes up with the create call, no GenerateMips and no render target binding needed
+	std::vector<D3D11_SUBRESOURCE_DATA> subresourceData(mipMapLevels);
+	for (unsigned int levelIndex = 0; levelIndex < mipMapLevels; ++levelIndex)
+	{
+		subresourceData[levelIndex].pSysMem = levelData[levelIndex];
+		subresourceData[levelIndex].SysMemPitch = levels[levelIndex].m_rowPitch;
+	}
+
+	ID3D11Texture2D* textureHandle = nullptr;
+	HRESULT hr = m_device->CreateTexture2D(&textureDesc, subresourceData.data(), &textureHandle);
+	if (!SUCCEEDED(hr))
+	{
+		ERROR_AND_DIE(Stringf("CreateImmutableTexture failed for image file \"%s\".", name.c_str()));
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = textureDesc.Format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = mipMapLevels;
+
+	ID3D11ShaderResourceView* srv = nullptr;
+	hr = m_device->CreateShaderResourceView(textureHandle, &srvDesc, &srv);
+	if (!SUCCEEDED(hr))
+	{
+		ERROR_AND_DIE(Stringf("CreateShaderResourceView failed for image file \"%s\".", name.c_str()));
+	}
+
+	Texture* newTexture = new Texture();
+	newTexture->m_name = name;
+	newTexture->m_texture = textureHandle;
+	newTexture->m_shaderResourceView = srv;
+	newTexture->m_dimensions = dims;
+	newTexture->m_mipMapLevels = mipMapLevels;
+
+	m_loadedTextures.push_back(newTexture);
+	return newTexture;
+}
+
 //-----------------------------------------------------------------------------------------------
 void Renderer::BindTexture(Texture* texture, int slot)
 {
@@ -750,6 +860,10 @@ Texture* Renderer::CreateOrGetTextureFromFile(char const* imageFilePath, unsigne
 	}
 
 	// Never seen this texture before!  Let's load it.
+	if (m_config.m_useTextureCache)
+	{
+		return CreateTextureFromCachedFile(imageFilePath, mipMapLevels);
+	}
 	Texture* newTexture = CreateTextureFromFile(imageFilePath, mipMapLevels);
 	return newTexture;
 }
@@ -800,6 +914,62 @@ Texture* Renderer::CreateTextureFromFile(char const* imageFilePath, unsigned int
 	return CreateTextureFromImage(fileImage, mipLevels);
 }
 
+//------------------------------------------------------------------------------------------------
+Texture* Renderer::CreateTextureFromCachedFile(char const* imageFilePath, unsigned int mipMapLevels)
+{
+	std::string cacheFilePath = GetTextureCacheFilePath(imageFilePath);
+	unsigned int cacheFlags = m_config.m_cachedTexturesAreSRGB ? TEXTURE_CACHE_FLAG_SRGB : TEXTURE_CACHE_FLAG_NONE;
+	bool wantsCompression = m_config.m_compressCachedTextures;
+	TextureCacheFormat compressedFormat = GetTextureCacheFormat(m_config.m_cachedTextureCompression.m_format);
+
+	// Warm start: the level data goes from the file mapping straight into the create call, nothing is decoded
+	TextureCacheView cacheView;
+	if (OpenTextureCacheView(cacheView, cacheFilePath.c_str(), imageFilePath))
+	{
+		TextureCacheHeader const& header = *cacheView.m_header;
+		IntVec2 dims(static_cast<int>(header.m_width), static_cast<int>(header.m_height));
+		int fullLevelCount = GetFullMipLevelCount(dims);
+		int wantedLevelCount = mipMapLevels == 0 ? fullLevelCount : std::min(static_cast<int>(mipMapLevels), fullLevelCount);
+		bool canCompress = dims.x % 4 == 0 && dims.y % 4 == 0;
+		TextureCacheFormat wantedFormat = (wantsCompression && canCompress) ? compressedFormat : TextureCacheFormat::RGBA8;
+
+		// A cache built with other settings is rebuilt rather than used
+		if (static_cast<int>(header.m_numMipLevels) == wantedLevelCount && header.m_format == static_cast<unsigned int>(wantedFormat) && header.m_flags == cacheFlags)
+		{
+			std::vector<TextureCacheLevel> levels(cacheView.m_levels, cacheView.m_levels + header.m_numMipLevels);
+			std::vector<void const*> levelData(header.m_numMipLevels);
+			for (int levelIndex = 0; levelIndex < static_cast<int>(header.m_numMipLevels); ++levelIndex)
+			{
+				levelData[levelIndex] = GetTextureCacheLevelData(cacheView, levelIndex);
+			}
+			Texture* cachedTexture = CreateImmutableTexture(imageFilePath, wantedFormat, levels, levelData);
+			CloseTextureCacheView(cacheView);
+			return cachedTexture;
+		}
+		CloseTextureCacheView(cacheView);
+	}
+
+	// Cold start: decode, build the mips on the CPU, optionally compress, then write the cache for next time
+	Image fileImage(imageFilePath);
+	ImageMipSettings mipSettings;
+	mipSettings.m_maxLevels = static_cast<int>(mipMapLevels);
+	mipSettings.m_isSRGB = m_config.m_cachedTexturesAreSRGB;
+	std::vector<Image> mipChain;
+	GenerateImageMipChain(mipChain, fileImage, mipSettings, m_config.m_jobSystem);
+
+	IntVec2 dims = fileImage.GetDimensions();
+	if (wantsCompression && dims.x % 4 == 0 && dims.y % 4 == 0)
+	{
+		std::vector<CompressedImage> compressedMipChain;
+		CompressImageMipChain(compressedMipChain, mipChain, m_config.m_cachedTextureCompression, m_config.m_jobSystem);
+		WriteTextureCacheFile(cacheFilePath.c_str(), compressedMipChain, imageFilePath, cacheFlags);
+		return CreateTextureFromCompressedMipChain(compressedMipChain);
+	}
+
+	WriteTextureCacheFile(cacheFilePath.c_str(), mipChain, imageFilePath, cacheFlags);
+	return CreateTextureFromMipChain(mipChain);
+}
+
 Shader* Renderer::CreateShader(char const* shaderName, char const* shaderSource, VertexType vertexType)
 {
 	// Create a new Shader config and create a new shader with it
@@ -1028,7 +1198,8 @@ void Renderer::DrawIndexedVertexBuffer(VertexBuffer* vbo, IndexBuffer* ibo, unsi
 void Renderer::BindIndexBuffer(IndexBuffer* ibo)
 {
 	UINT offset = 0;
-	m_deviceContext->IASetIndexBuffer(ibo->m_buffer, DXGI_FORMAT_R32_UINT, offset);
+	DXGI_FORMAT indexFormat = (ibo->GetStride() == sizeof(unsigned short)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	m_deviceContext->IASetIndexBuffer(ibo->m_buffer, indexFormat, offset);
 }
 
 void Renderer::SetStatesIfChanged()
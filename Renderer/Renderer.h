@@ -6,6 +6,7 @@
 #include "Engine/Renderer/ConstantBuffer.hpp"
 #include "Engine/Renderer/IndexBuffer.hpp"
 #include "Engine/Math/Mat44.hpp"
+#include "Engine/Core/TextureCache.hpp"
 #include "Game/EngineBuildPreferences.hpp"
 #include <vector>
 // -----------------------------------------------------------------------------
@@ -20,6 +21,7 @@ struct ID3DUserDefinedAnnotation;
 class  Camera;
 class  Window;
 class  Image;
+class  JobSystem;
 // -----------------------------------------------------------------------------
 #define DX_SAFE_RELEASE(dxObject)	\
 {									\
@@ -36,7 +38,12 @@ class  Image;
 //--------------------------------------------------------------------------------------------------------
 struct RendererConfig
 {
-	Window* m_window = nullptr;
+	Window*					 m_window = nullptr;
+	JobSystem*				 m_jobSystem = nullptr;			// Spreads mip generation and block compression when a texture cache is built, inline when null
+	bool					 m_useTextureCache = false;		// Opt in, CreateOrGetTextureFromFile then reads and writes a .wtex beside each image and uploads its CPU built mips as an immutable texture
+	bool					 m_cachedTexturesAreSRGB = false; // Cached mips are filtered as sRGB color, otherwise as linear values like GenerateMips on the uncached path
+	bool					 m_compressCachedTextures = false;
+	BlockCompressionSettings m_cachedTextureCompression;
 };
 //--------------------------------------------------------------------------------------------------------
 struct PerFrameConstants
@@ -181,6 +188,8 @@ public:
 
 public:
 	Texture*		CreateTextureFromImage(Image const& image, unsigned int mipMapLevels = 1);
+	Texture*		CreateTextureFromMipChain(std::vector<Image> const& mipChain); // Uploads CPU built levels as is, see GenerateImageMipChain
+	Texture*		CreateTextureFromCompressedMipChain(std::vector<CompressedImage> const& mipChain); // BCn blocks straight from CompressImageMipChain
 	void			BindTexture(Texture* texture, int slot = 0);
 	Texture*		CreateOrGetTextureFromFile(char const* imageFilePath, unsigned int mipMapLevels = 1);
 	BitmapFont*		CreateOrGetBitmapFont(char const* bitmapFontFilePathWithNoExtension);
@@ -208,6 +217,8 @@ public:
 	void CopyCPUToGPU(const void* data, unsigned int size, IndexBuffer* ibo);
 private:
 	Texture* CreateTextureFromFile(char const* imageFilePath, unsigned int mipLevels = 1);
+	Texture* CreateTextureFromCachedFile(char const* imageFilePath, unsigned int mipMapLevels);
+	Texture* CreateImmutableTexture(std::string const& name, TextureCacheFormat format, std::vector<TextureCacheLevel> const& levels, std::vector<void const*> const& levelData);
 
 private:
 	std::vector<Texture*> m_loadedTextures;
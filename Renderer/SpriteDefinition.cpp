@@ -2,8 +2,8 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Renderer/SpriteSheet.hpp"
 
-SpriteDefinition::SpriteDefinition(SpriteSheet const& spriteSheet, int spriteIndex, Vec2 const& uvAtMins, Vec2 const& uvAtMaxs)
-	:m_spriteSheet(spriteSheet), m_spriteIndex(spriteIndex), m_uvAtMins(uvAtMins), m_uvAtMaxs(uvAtMaxs)
+SpriteDefinition::SpriteDefinition(SpriteSheet const& spriteSheet, int spriteIndex, Vec2 const& uvAtMins, Vec2 const& uvAtMaxs, bool isRotated)
+	:m_spriteSheet(spriteSheet), m_spriteIndex(spriteIndex), m_uvAtMins(uvAtMins), m_uvAtMaxs(uvAtMaxs), m_isRotated(isRotated)
 {
 }
 
@@ -18,6 +18,23 @@ AABB2 SpriteDefinition::GetUVs() const
 	return AABB2(m_uvAtMins, m_uvAtMaxs);
 }
 
+void SpriteDefinition::GetCornerUVs(Vec2& out_bottomLeft, Vec2& out_bottomRight, Vec2& out_topRight, Vec2& out_topLeft) const
+{
+	if (!m_isRotated)
+	{
+		out_bottomLeft = m_uvAtMins;
+		out_bottomRight = Vec2(m_uvAtMaxs.x, m_uvAtMins.y);
+		out_topRight = m_uvAtMaxs;
+		out_topLeft = Vec2(m_uvAtMins.x, m_uvAtMaxs.y);
+		return;
+	}
+
+	out_bottomLeft = Vec2(m_uvAtMaxs.x, m_uvAtMins.y);
+	out_bottomRight = m_uvAtMaxs;
+	out_topRight = Vec2(m_uvAtMins.x, m_uvAtMaxs.y);
+	out_topLeft = m_uvAtMins;
+}
+
 SpriteSheet const& SpriteDefinition::GetSpriteSheet() const
 {
 	return m_spriteSheet;
@@ -31,5 +48,14 @@ Texture& SpriteDefinition::GetTexture() const
 float SpriteDefinition::GetAspect() const
 {
 	Vec2 spriteSheetDimensions = GetUVs().GetDimensions();
+	if (m_isRotated)
+	{
+		return spriteSheetDimensions.y / spriteSheetDimensions.x;
+	}
 	return spriteSheetDimensions.x / spriteSheetDimensions.y;
 }
+
+bool SpriteDefinition::IsRotated() const
+{
+	return m_isRotated;
+}
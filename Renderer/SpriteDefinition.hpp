@@ -9,16 +9,19 @@ class SpriteSheet;
 class SpriteDefinition
 {
 public:
-	explicit SpriteDefinition(SpriteSheet const& spriteSheet, int spriteIndex, Vec2 const& uvAtMins, Vec2 const& uvAtMaxs);
+	explicit SpriteDefinition(SpriteSheet const& spriteSheet, int spriteIndex, Vec2 const& uvAtMins, Vec2 const& uvAtMaxs, bool isRotated = false);
 	void GetUVs(Vec2& out_uvAtMins, Vec2& uv_outAtMaxs) const;
 	AABB2 GetUVs() const;
+	void GetCornerUVs(Vec2& out_bottomLeft, Vec2& out_bottomRight, Vec2& out_topRight, Vec2& out_topLeft) const; // Undoes atlas rotation
 	SpriteSheet const& GetSpriteSheet() const;
 	Texture& GetTexture() const;
 	float GetAspect() const;
+	bool IsRotated() const;
 
 protected:
 	SpriteSheet const& m_spriteSheet;
 	int m_spriteIndex = -1;
 	Vec2 m_uvAtMins = Vec2::ZERO;
 	Vec2 m_uvAtMaxs = Vec2::ONE;
+	bool m_isRotated = false; // Stored turned 90 degrees counterclockwise in an atlas, see AtlasRegion
 };
\ No newline at end of file
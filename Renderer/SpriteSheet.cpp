@@ -1,6 +1,7 @@
 #include "Engine/Renderer/SpriteSheet.hpp"
 #include "Engine/Renderer/Texture.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/AtlasPacker.hpp"
 
 SpriteSheet::SpriteSheet(Texture& texture, IntVec2 const& simpleGridLayout)
 	:m_texture(texture)
@@ -31,6 +32,21 @@ SpriteSheet::SpriteSheet(Texture& texture, IntVec2 const& simpleGridLayout)
 	}
 }
 
+SpriteSheet::SpriteSheet(Texture& atlasTexture, std::vector<AtlasRegion> const& atlasRegions)
+	:m_texture(atlasTexture)
+{
+	int numSprites = static_cast<int>(atlasRegions.size());
+	m_sprites.reserve(numSprites);
+	for (int spriteIndex = 0; spriteIndex < numSprites; ++spriteIndex)
+	{
+		AtlasRegion const& region = atlasRegions[spriteIndex];
+		GUARANTEE_OR_DIE(region.m_isPacked, "SpriteSheet given an atlas region that was never packed");
+
+		SpriteDefinition spriteDefintion(*this, spriteIndex, region.m_uvs.m_mins, region.m_uvs.m_maxs, region.m_isRotated);
+		m_sprites.push_back(spriteDefintion);
+	}
+}
+
 Texture& SpriteSheet::GetTexture() const
 {
 	return m_texture;
@@ -8,11 +8,13 @@
 // ------------------------------------
 class SpriteDefinition;
 class Texture;
+struct AtlasRegion;
 // ------------------------------------
 class SpriteSheet
 {
 public:
 	explicit SpriteSheet(Texture& texture, IntVec2 const& simpleGridLayout);
+	explicit SpriteSheet(Texture& atlasTexture, std::vector<AtlasRegion> const& atlasRegions); // One sprite per region in order, unpacked regions die
 
 	Texture& GetTexture() const;
 	int GetNumSprites() const;
@@ -0,0 +1,472 @@
+#include "Engine/Terrain/TerrainStreamer.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/VertexUtils.h"
+#include "Engine/Math/Frustum3.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/SmoothNoise.hpp"
+#include "Engine/Renderer/Camera.h"
+#include "Engine/Renderer/Renderer.h"
+#include <algorithm>
+#include <math.h>
+#include <numeric>
+// -----------------------------------------------------------------------------
+static unsigned long long GetChunkKey(IntVec2 const& chunkCoords)
+{
+	return (static_cast<unsigned long long>(static_cast<unsigned int>(chunkCoords.x)) << 32) | static_cast<unsigned int>(chunkCoords.y);
+}
+
+// Whole samples times the spacing, so chunks agree exactly on the samples and vertexes they share
+static Vec2 GetChunkMins(TerrainStreamerConfig const& config, IntVec2 const& chunkCoords)
+{
+	return Vec2(static_cast<float>(chunkCoords.x * config.m_quadsPerChunkSide) * config.m_sampleSpacing,
+				static_cast<float>(chunkCoords.y * config.m_quadsPerChunkSide) * config.m_sampleSpacing);
+}
+// -----------------------------------------------------------------------------
+class TerrainChunkJob : public Job
+{
+public:
+	TerrainChunkJob(TerrainStreamerConfig const& config, IntVec2 const& chunkCoords, std::vector<float>& cachedHeights);
+	virtual void Execute() override;
+
+public:
+	TerrainStreamerConfig const& m_config;
+	IntVec2						 m_chunkCoords;
+	std::vector<float>			 m_heights;		// Starts empty unless it came from the noise tile cache
+	std::vector<Vertex_PCUTBN>	 m_verts;
+	std::vector<unsigned int>	 m_indexes;
+	AABB3						 m_bounds;
+	JobCounter					 m_counter;		// Done once a worker has generated the chunk, or the job was cancelled
+};
+
+TerrainChunkJob::TerrainChunkJob(TerrainStreamerConfig const& config, IntVec2 const& chunkCoords, std::vector<float>& cachedHeights)
+	: m_config(config)
+	, m_chunkCoords(chunkCoords)
+{
+	m_heights.swap(cachedHeights);
+}
+
+void TerrainChunkJob::Execute()
+{
+	int numQuads = m_config.m_quadsPerChunkSide;
+	int numSamplesPerSide = numQuads + 3;
+	Vec2 mins = GetChunkMins(m_config, m_chunkCoords);
+
+	if (m_heights.empty())
+	{
+		// Already on a worker, so the grid fill runs single threaded
+		m_heights.resize(static_cast<size_t>(numSamplesPerSide) * numSamplesPerSide);
+		Vec2 gridOrigin = mins - Vec2(m_config.m_sampleSpacing, m_config.m_sampleSpacing);
+		Compute2dPerlinNoiseGrid(m_heights.data(), numSamplesPerSide, numSamplesPerSide, gridOrigin, m_config.m_sampleSpacing, m_config.m_noiseScale,
+			m_config.m_numOctaves, m_config.m_octavePersistence, m_config.m_octaveScale, true, m_config.m_seed);
+		for (int sampleIndex = 0; sampleIndex < static_cast<int>(m_heights.size()); ++sampleIndex)
+		{
+			m_heights[sampleIndex] = m_config.m_baseHeight + m_config.m_heightScale * m_heights[sampleIndex];
+		}
+	}
+
+	// Bounds cover the chunk's own samples, not the border
+	float minHeight = m_heights[numSamplesPerSide + 1];
+	float maxHeight = minHeight;
+	for (int sampleY = 1; sampleY <= numQuads + 1; ++sampleY)
+	{
+		float const* rowHeights = m_heights.data() + sampleY * numSamplesPerSide;
+		for (int sampleX = 1; sampleX <= numQuads + 1; ++sampleX)
+		{
+			minHeight = std::min(minHeight, rowHeights[sampleX]);
+			maxHeight = std::max(maxHeight, rowHeights[sampleX]);
+		}
+	}
+	float chunkSize = static_cast<float>(numQuads) * m_config.m_sampleSpacing;
+	m_bounds = AABB3(Vec3(mins.x, mins.y, minHeight), Vec3(mins.x + chunkSize, mins.y + chunkSize, maxHeight));
+
+	float repeats = m_config.m_textureRepeatsPerChunk;
+	AABB2 UVs(Vec2(static_cast<float>(m_chunkCoords.x), static_cast<float>(m_chunkCoords.y)) * repeats,
+			  Vec2(static_cast<float>(m_chunkCoords.x + 1), static_cast<float>(m_chunkCoords.y + 1)) * repeats);
+	AddVertsForHeightfield3D(m_verts, m_indexes, m_heights.data(), IntVec2(numQuads, numQuads), mins, m_config.m_sampleSpacing, m_config.m_color, UVs);
+}
+// -----------------------------------------------------------------------------
+TerrainStreamer::TerrainStreamer(TerrainStreamerConfig const& config)
+	: m_config(config)
+{
+	GUARANTEE_OR_DIE(m_config.m_quadsPerChunkSide > 0 && m_config.m_sampleSpacing > 0.f, "Terrain chunks need at least one quad and a positive sample spacing");
+	GUARANTEE_OR_DIE(m_config.m_unloadRadius >= m_config.m_loadRadius, "Terrain unload radius must be at least the load radius, or chunks would unload as soon as they load");
+}
+
+TerrainStreamer::~TerrainStreamer()
+{
+	UnloadAllChunks();
+}
+
+void TerrainStreamer::Update(Camera const& camera)
+{
+	double updateStartSeconds = GetCurrentTimeSeconds();
+	Vec3 cameraPosition = camera.GetPosition();
+	m_viewPosition = Vec2(cameraPosition.x, cameraPosition.y);
+
+	FinishGeneratedChunks(updateStartSeconds);
+	UnloadDistantChunks();
+	StartWantedChunks(camera, updateStartSeconds);
+}
+
+void TerrainStreamer::Render(Camera const& camera) const
+{
+	if (m_config.m_renderer == nullptr)
+	{
+		return;
+	}
+
+	std::vector<TerrainChunk const*> uploadedChunks;
+	std::vector<AABB3> chunkBounds;
+	uploadedChunks.reserve(m_chunks.size());
+	chunkBounds.reserve(m_chunks.size());
+	for (auto const& chunkEntry : m_chunks)
+	{
+		TerrainChunk const* chunk = chunkEntry.second;
+		if (chunk->m_vertexBuffer != nullptr)
+		{
+			uploadedChunks.push_back(chunk);
+			chunkBounds.push_back(chunk->m_bounds);
+		}
+	}
+
+	int numChunks = static_cast<int>(uploadedChunks.size());
+	std::vector<unsigned char> isVisible(numChunks);
+	CullAABB3sAgainstFrustum(camera.GetFrustum(), numChunks, chunkBounds.data(), isVisible.data());
+	for (int chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+	{
+		if (isVisible[chunkIndex] != 0)
+		{
+			TerrainChunk const* chunk = uploadedChunks[chunkIndex];
+			m_config.m_renderer->DrawIndexedVertexBuffer(chunk->m_vertexBuffer, chunk->m_indexBuffer, static_cast<unsigned int>(chunk->m_numIndexes));
+		}
+	}
+}
+
+void TerrainStreamer::UnloadAllChunks()
+{
+	// Chunks no worker has claimed are dropped, the rest have to finish first
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(m_generatingChunks.size()); ++chunkIndex)
+	{
+		TerrainChunk* chunk = m_generatingChunks[chunkIndex];
+		if (!m_config.m_jobSystem->CancelPendingJob(chunk->m_job))
+		{
+			m_config.m_jobSystem->WaitForCounter(chunk->m_job->m_counter);
+		}
+		AddNoiseTile(GetChunkKey(chunk->m_coords), chunk->m_job->m_heights);
+		delete chunk->m_job;
+		chunk->m_job = nullptr;
+	}
+	m_generatingChunks.clear();
+
+	for (auto const& chunkEntry : m_chunks)
+	{
+		ReleaseChunk(chunkEntry.second);
+	}
+	m_chunks.clear();
+}
+
+TerrainChunk const* TerrainStreamer::GetChunk(IntVec2 const& chunkCoords) const
+{
+	auto foundChunk = m_chunks.find(GetChunkKey(chunkCoords));
+	if (foundChunk == m_chunks.end() || foundChunk->second->m_job != nullptr)
+	{
+		return nullptr;
+	}
+	return foundChunk->second;
+}
+
+void TerrainStreamer::GetLoadedChunks(std::vector<TerrainChunk const*>& out_chunks) const
+{
+	out_chunks.clear();
+	for (auto const& chunkEntry : m_chunks)
+	{
+		if (chunkEntry.second->m_job == nullptr)
+		{
+			out_chunks.push_back(chunkEntry.second);
+		}
+	}
+}
+
+IntVec2 TerrainStreamer::GetChunkCoordsForPosition(Vec2 const& position) const
+{
+	float chunkSize = GetChunkSize();
+	return IntVec2(RoundDownToInt(position.x / chunkSize), RoundDownToInt(position.y / chunkSize));
+}
+
+AABB2 TerrainStreamer::GetChunkBoundsXY(IntVec2 const& chunkCoords) const
+{
+	return AABB2(GetChunkMins(m_config, chunkCoords), GetChunkMins(m_config, IntVec2(chunkCoords.x + 1, chunkCoords.y + 1)));
+}
+
+float TerrainStreamer::GetChunkSize() const
+{
+	return static_cast<float>(m_config.m_quadsPerChunkSide) * m_config.m_sampleSpacing;
+}
+
+TerrainStreamerStats TerrainStreamer::GetStats() const
+{
+	TerrainStreamerStats stats;
+	stats.m_numChunksInFlight = static_cast<int>(m_generatingChunks.size());
+	stats.m_numLoadedChunks = static_cast<int>(m_chunks.size()) - stats.m_numChunksInFlight;
+	stats.m_numCachedNoiseTiles = static_cast<int>(m_noiseTiles.size());
+	stats.m_numNoiseTileHits = m_numNoiseTileHits;
+	stats.m_numNoiseTileMisses = m_numNoiseTileMisses;
+	stats.m_numCancelledChunks = m_numCancelledChunks;
+	return stats;
+}
+// -----------------------------------------------------------------------------
+bool TerrainStreamer::IsOverUpdateBudget(double updateStartSeconds) const
+{
+	return GetCurrentTimeSeconds() - updateStartSeconds >= m_config.m_maxUpdateSeconds;
+}
+
+void TerrainStreamer::FinishGeneratedChunks(double updateStartSeconds)
+{
+	// Without a job system StartChunk finishes every chunk it starts
+	if (m_config.m_jobSystem == nullptr)
+	{
+		return;
+	}
+
+	int numFinished = 0;
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(m_generatingChunks.size()) && numFinished < m_config.m_maxChunksFinishedPerFrame;)
+	{
+		if (numFinished > 0 && IsOverUpdateBudget(updateStartSeconds))
+		{
+			break;
+		}
+
+		TerrainChunk* chunk = m_generatingChunks[chunkIndex];
+		if (!chunk->m_job->m_counter.IsDone())
+		{
+			++chunkIndex;
+			continue;
+		}
+
+		m_generatingChunks[chunkIndex] = m_generatingChunks.back();
+		m_generatingChunks.pop_back();
+		FinishChunk(chunk);
+		++numFinished;
+	}
+}
+
+void TerrainStreamer::FinishChunk(TerrainChunk* chunk)
+{
+	TerrainChunkJob* job = chunk->m_job;
+	chunk->m_job = nullptr;
+	unsigned long long chunkKey = GetChunkKey(chunk->m_coords);
+	AddNoiseTile(chunkKey, job->m_heights);
+
+	// Left behind while a worker was generating it
+	if (!IsChunkWithinRadius(chunk->m_coords, m_config.m_unloadRadius))
+	{
+		m_chunks.erase(chunkKey);
+		ReleaseChunk(chunk);
+		delete job;
+		return;
+	}
+
+	chunk->m_bounds = job->m_bounds;
+	chunk->m_verts.swap(job->m_verts);
+	chunk->m_indexes.swap(job->m_indexes);
+	chunk->m_numIndexes = static_cast<int>(chunk->m_indexes.size());
+	delete job;
+
+	Renderer* renderer = m_config.m_renderer;
+	if (renderer != nullptr)
+	{
+		unsigned int vertexBytes = static_cast<unsigned int>(chunk->m_verts.size() * sizeof(Vertex_PCUTBN));
+		unsigned int indexBytes = static_cast<unsigned int>(chunk->m_indexes.size() * sizeof(unsigned int));
+		chunk->m_vertexBuffer = renderer->CreateVertexBuffer(vertexBytes, sizeof(Vertex_PCUTBN));
+		chunk->m_indexBuffer = renderer->CreateIndexBuffer(indexBytes, sizeof(unsigned int));
+		renderer->CopyCPUToGPU(chunk->m_verts.data(), vertexBytes, chunk->m_vertexBuffer);
+		renderer->CopyCPUToGPU(chunk->m_indexes.data(), indexBytes, chunk->m_indexBuffer);
+		if (!m_config.m_keepMeshesOnCPU)
+		{
+			std::vector<Vertex_PCUTBN>().swap(chunk->m_verts);
+			std::vector<unsigned int>().swap(chunk->m_indexes);
+		}
+	}
+}
+
+void TerrainStreamer::UnloadDistantChunks()
+{
+	for (auto chunkEntry = m_chunks.begin(); chunkEntry != m_chunks.end();)
+	{
+		TerrainChunk* chunk = chunkEntry->second;
+		if (IsChunkWithinRadius(chunk->m_coords, m_config.m_unloadRadius))
+		{
+			++chunkEntry;
+			continue;
+		}
+
+		if (chunk->m_job != nullptr)
+		{
+			// Claimed chunks are dropped by FinishChunk instead
+			if (!m_config.m_jobSystem->CancelPendingJob(chunk->m_job))
+			{
+				++chunkEntry;
+				continue;
+			}
+
+			AddNoiseTile(chunkEntry->first, chunk->m_job->m_heights);
+			m_generatingChunks.erase(std::find(m_generatingChunks.begin(), m_generatingChunks.end(), chunk));
+			delete chunk->m_job;
+			chunk->m_job = nullptr;
+			++m_numCancelledChunks;
+		}
+
+		ReleaseChunk(chunk);
+		chunkEntry = m_chunks.erase(chunkEntry);
+	}
+}
+
+void TerrainStreamer::StartWantedChunks(Camera const& camera, double updateStartSeconds)
+{
+	int numChunksToStart = m_config.m_maxChunksStartedPerFrame;
+	if (m_config.m_jobSystem != nullptr)
+	{
+		numChunksToStart = std::min(numChunksToStart, m_config.m_maxChunksInFlight - static_cast<int>(m_generatingChunks.size()));
+	}
+	if (numChunksToStart <= 0)
+	{
+		return;
+	}
+
+	// Every missing chunk within the load radius, bounded by the heights the noise can reach
+	float loadRadius = m_config.m_loadRadius;
+	IntVec2 minCoords = GetChunkCoordsForPosition(m_viewPosition - Vec2(loadRadius, loadRadius));
+	IntVec2 maxCoords = GetChunkCoordsForPosition(m_viewPosition + Vec2(loadRadius, loadRadius));
+	float minHeight = m_config.m_baseHeight - fabsf(m_config.m_heightScale);
+	float maxHeight = m_config.m_baseHeight + fabsf(m_config.m_heightScale);
+	m_wantedCoords.clear();
+	m_wantedBounds.clear();
+	m_wantedDistancesSquared.clear();
+	for (int chunkY = minCoords.y; chunkY <= maxCoords.y; ++chunkY)
+	{
+		for (int chunkX = minCoords.x; chunkX <= maxCoords.x; ++chunkX)
+		{
+			IntVec2 chunkCoords(chunkX, chunkY);
+			if (!IsChunkWithinRadius(chunkCoords, loadRadius) || m_chunks.find(GetChunkKey(chunkCoords)) != m_chunks.end())
+			{
+				continue;
+			}
+
+			AABB2 boundsXY = GetChunkBoundsXY(chunkCoords);
+			m_wantedCoords.push_back(chunkCoords);
+			m_wantedBounds.push_back(AABB3(Vec3(boundsXY.m_mins.x, boundsXY.m_mins.y, minHeight), Vec3(boundsXY.m_maxs.x, boundsXY.m_maxs.y, maxHeight)));
+			m_wantedDistancesSquared.push_back(GetDistanceSquared2D(boundsXY.GetCenter(), m_viewPosition));
+		}
+	}
+	int numWanted = static_cast<int>(m_wantedCoords.size());
+	if (numWanted == 0)
+	{
+		return;
+	}
+
+	// Chunks in view first, then nearest first
+	m_wantedIsVisible.resize(numWanted);
+	CullAABB3sAgainstFrustum(camera.GetFrustum(), numWanted, m_wantedBounds.data(), m_wantedIsVisible.data());
+	m_wantedOrder.resize(numWanted);
+	std::iota(m_wantedOrder.begin(), m_wantedOrder.end(), 0);
+	numChunksToStart = std::min(numChunksToStart, numWanted);
+	std::partial_sort(m_wantedOrder.begin(), m_wantedOrder.begin() + numChunksToStart, m_wantedOrder.end(), [this](int indexA, int indexB)
+	{
+		if (m_wantedIsVisible[indexA] != m_wantedIsVisible[indexB])
+		{
+			return m_wantedIsVisible[indexA] > m_wantedIsVisible[indexB];
+		}
+		return m_wantedDistancesSquared[indexA] < m_wantedDistancesSquared[indexB];
+	});
+
+	for (int orderIndex = 0; orderIndex < numChunksToStart; ++orderIndex)
+	{
+		if (orderIndex > 0 && IsOverUpdateBudget(updateStartSeconds))
+		{
+			break;
+		}
+		StartChunk(m_wantedCoords[m_wantedOrder[orderIndex]]);
+	}
+}
+
+void TerrainStreamer::StartChunk(IntVec2 const& chunkCoords)
+{
+	unsigned long long chunkKey = GetChunkKey(chunkCoords);
+	TerrainChunk* chunk = new TerrainChunk();
+	chunk->m_coords = chunkCoords;
+	m_chunks[chunkKey] = chunk;
+
+	std::vector<float> cachedHeights;
+	if (TakeNoiseTile(chunkKey, cachedHeights))
+	{
+		++m_numNoiseTileHits;
+	}
+	else
+	{
+		++m_numNoiseTileMisses;
+	}
+	chunk->m_job = new TerrainChunkJob(m_config, chunkCoords, cachedHeights);
+
+	if (m_config.m_jobSystem == nullptr)
+	{
+		chunk->m_job->Execute();
+		FinishChunk(chunk);
+		return;
+	}
+
+	m_generatingChunks.push_back(chunk);
+	// Counted, so the job never goes through the completed queue where RetreiveCompletedJob callers could take it
+	m_config.m_jobSystem->AddJobToSystem(chunk->m_job, &chunk->m_job->m_counter);
+}
+
+void TerrainStreamer::ReleaseChunk(TerrainChunk* chunk)
+{
+	delete chunk->m_vertexBuffer;
+	delete chunk->m_indexBuffer;
+	delete chunk;
+}
+
+bool TerrainStreamer::IsChunkWithinRadius(IntVec2 const& chunkCoords, float radius) const
+{
+	return GetDistanceSquared2D(GetChunkBoundsXY(chunkCoords).GetCenter(), m_viewPosition) <= radius * radius;
+}
+// -----------------------------------------------------------------------------
+bool TerrainStreamer::TakeNoiseTile(unsigned long long chunkKey, std::vector<float>& out_heights)
+{
+	auto foundTile = m_noiseTileIndices.find(chunkKey);
+	if (foundTile == m_noiseTileIndices.end())
+	{
+		return false;
+	}
+
+	out_heights.swap(foundTile->second->m_heights);
+	m_noiseTiles.erase(foundTile->second);
+	m_noiseTileIndices.erase(foundTile);
+	return true;
+}
+
+void TerrainStreamer::AddNoiseTile(unsigned long long chunkKey, std::vector<float>& heights)
+{
+	if (heights.empty() || m_config.m_maxCachedNoiseTiles <= 0)
+	{
+		return;
+	}
+
+	// Reuses the least recently used tile when the cache is full, so a full cache stops allocating
+	if (static_cast<int>(m_noiseTiles.size()) >= m_config.m_maxCachedNoiseTiles)
+	{
+		m_noiseTileIndices.erase(m_noiseTiles.back().m_chunkKey);
+		m_noiseTiles.splice(m_noiseTiles.begin(), m_noiseTiles, std::prev(m_noiseTiles.end()));
+	}
+	else
+	{
+		m_noiseTiles.emplace_front();
+	}
+
+	NoiseTile& tile = m_noiseTiles.front();
+	tile.m_chunkKey = chunkKey;
+	tile.m_heights.swap(heights);
+	m_noiseTileIndices[chunkKey] = m_noiseTiles.begin();
+}
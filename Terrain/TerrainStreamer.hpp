@@ -0,0 +1,135 @@
+#pragma once
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/AABB2.h"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/IntVec2.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+// -----------------------------------------------------------------------------
+class Camera;
+class IndexBuffer;
+class JobSystem;
+class Renderer;
+class TerrainChunkJob;
+class VertexBuffer;
+// -----------------------------------------------------------------------------
+struct TerrainStreamerConfig
+{
+	JobSystem*	 m_jobSystem = nullptr;			// Generates chunks on the workers, on the calling thread inside Update if null
+	Renderer*	 m_renderer = nullptr;			// Uploads finished chunks to vertex and index buffers for Render if set
+
+	// Layout, a power of two sample spacing keeps the samples and vertexes shared by neighbouring chunks bit identical
+	float		 m_sampleSpacing = 1.f;
+	int			 m_quadsPerChunkSide = 32;
+	float		 m_loadRadius = 256.f;			// Chunks with centers this close to the camera in xy are generated
+	float		 m_unloadRadius = 320.f;		// and kept until they are this far away, so chunks at the edge do not churn
+	float		 m_textureRepeatsPerChunk = 1.f;
+	Rgba8		 m_color = Rgba8::WHITE;
+	bool		 m_keepMeshesOnCPU = true;		// Otherwise the vertexes and indexes are released once uploaded
+
+	// Heights are m_baseHeight + m_heightScale * Compute2dPerlinNoise( x, y, ... )
+	float		 m_baseHeight = 0.f;
+	float		 m_heightScale = 40.f;
+	float		 m_noiseScale = 200.f;
+	unsigned int m_numOctaves = 6;
+	float		 m_octavePersistence = 0.5f;
+	float		 m_octaveScale = 2.f;
+	unsigned int m_seed = 0;
+
+	// Per frame budget for the main thread
+	double		 m_maxUpdateSeconds = 0.002;	// Update stops finishing and starting chunks once over this, but always does at least one of each
+	int			 m_maxChunksStartedPerFrame = 8;
+	int			 m_maxChunksFinishedPerFrame = 8;
+	int			 m_maxChunksInFlight = 16;		// Keeps the job queue short, so chunks the camera leaves behind are still cheap to cancel
+
+	int			 m_maxCachedNoiseTiles = 1024;	// Heightfields kept after their chunk unloads, least recently used go first
+};
+// -----------------------------------------------------------------------------
+struct TerrainChunk
+{
+	IntVec2						m_coords;
+	AABB3						m_bounds;
+	std::vector<Vertex_PCUTBN>	m_verts;
+	std::vector<unsigned int>	m_indexes;
+	int							m_numIndexes = 0;
+	VertexBuffer*				m_vertexBuffer = nullptr;
+	IndexBuffer*				m_indexBuffer = nullptr;
+	TerrainChunkJob*			m_job = nullptr;	// Set while the chunk is being generated
+};
+// -----------------------------------------------------------------------------
+struct TerrainStreamerStats
+{
+	int m_numLoadedChunks = 0;
+	int m_numChunksInFlight = 0;
+	int m_numCachedNoiseTiles = 0;
+	int m_numNoiseTileHits = 0;		// Chunks started from a cached heightfield, since the streamer was made
+	int m_numNoiseTileMisses = 0;
+	int m_numCancelledChunks = 0;	// Left behind before a worker got to them
+};
+// -----------------------------------------------------------------------------
+// Infinite heightfield terrain in square chunks around a camera. Each Update finishes the chunks the job system has
+// generated, unloads chunks beyond the unload radius and starts the missing chunks within the load radius, those in
+// view first and then nearest first, all within the main thread budget in the config. A chunk job fills its heights
+// (its own samples plus a one sample border) with Compute2dPerlinNoiseGrid and builds its mesh with
+// AddVertsForHeightfield3D, so the main thread only moves finished meshes into place and uploads them.
+//
+// Heightfields of unloaded chunks stay in an LRU noise tile cache, so coming back to an area skips the noise.
+class TerrainStreamer
+{
+public:
+	explicit TerrainStreamer(TerrainStreamerConfig const& config);
+	~TerrainStreamer(); // Waits for any chunk a worker is still generating
+	TerrainStreamer(TerrainStreamer const& copy) = delete;
+
+	void Update(Camera const& camera);
+	void Render(Camera const& camera) const; // Draws the uploaded chunks that overlap the camera's frustum, with whatever shader and textures are bound
+	void UnloadAllChunks();
+
+	TerrainChunk const*	 GetChunk(IntVec2 const& chunkCoords) const; // Null unless loaded
+	void				 GetLoadedChunks(std::vector<TerrainChunk const*>& out_chunks) const;
+	IntVec2				 GetChunkCoordsForPosition(Vec2 const& position) const;
+	AABB2				 GetChunkBoundsXY(IntVec2 const& chunkCoords) const;
+	float				 GetChunkSize() const;
+	TerrainStreamerStats GetStats() const;
+
+private:
+	bool IsOverUpdateBudget(double updateStartSeconds) const;
+	void FinishGeneratedChunks(double updateStartSeconds);
+	void FinishChunk(TerrainChunk* chunk);
+	void UnloadDistantChunks();
+	void StartWantedChunks(Camera const& camera, double updateStartSeconds);
+	void StartChunk(IntVec2 const& chunkCoords);
+	void ReleaseChunk(TerrainChunk* chunk);
+	bool IsChunkWithinRadius(IntVec2 const& chunkCoords, float radius) const;
+
+	bool TakeNoiseTile(unsigned long long chunkKey, std::vector<float>& out_heights);
+	void AddNoiseTile(unsigned long long chunkKey, std::vector<float>& heights); // Takes the heights, leaving the array empty
+
+private:
+	struct NoiseTile
+	{
+		unsigned long long m_chunkKey = 0;
+		std::vector<float> m_heights;
+	};
+
+	TerrainStreamerConfig									m_config;
+	Vec2													m_viewPosition;		// Camera xy as of the last Update
+	std::unordered_map<unsigned long long, TerrainChunk*>	m_chunks;			// Loaded and generating, by chunk key
+	std::vector<TerrainChunk*>								m_generatingChunks;
+
+	std::list<NoiseTile>													m_noiseTiles;		// Most recently used first
+	std::unordered_map<unsigned long long, std::list<NoiseTile>::iterator>	m_noiseTileIndices;	// Chunk key to its tile in m_noiseTiles
+
+	// Scratch for StartWantedChunks, kept to save the allocations
+	std::vector<IntVec2>		m_wantedCoords;
+	std::vector<AABB3>			m_wantedBounds;
+	std::vector<float>			m_wantedDistancesSquared;
+	std::vector<unsigned char>	m_wantedIsVisible;
+	std::vector<int>			m_wantedOrder;
+
+	int m_numNoiseTileHits = 0;
+	int m_numNoiseTileMisses = 0;
+	int m_numCancelledChunks = 0;
+};
+// -----------------------------------------------------------------------------
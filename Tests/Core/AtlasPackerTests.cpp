@@ -0,0 +1,122 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/AtlasPacker.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include <algorithm>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int ATLAS_TEST_NUM_IMAGES = 200;
+constexpr int ATLAS_TEST_MIN_IMAGE_SIDE = 4;
+constexpr int ATLAS_TEST_MAX_IMAGE_SIDE = 64;
+constexpr int ATLAS_TEST_PADDING = 2;
+// -----------------------------------------------------------------------------
+// Every texel is unique within its image and images differ in blue, so a misplaced or wrongly turned copy shows up
+static Rgba8 GetAtlasTestTexel(int imageIndex, int texelX, int texelY)
+{
+	return Rgba8(static_cast<unsigned char>(texelX * 4), static_cast<unsigned char>(texelY * 4), static_cast<unsigned char>(imageIndex), 255);
+}
+
+// The image texel a stored region texel came from, undoing the counterclockwise turn
+static IntVec2 GetImageTexelForRegionTexel(AtlasRegion const& region, IntVec2 const& imageDimensions, int regionX, int regionY)
+{
+	if (!region.m_isRotated)
+	{
+		return IntVec2(regionX, regionY);
+	}
+	return IntVec2(regionY, imageDimensions.y - 1 - regionX);
+}
+// -----------------------------------------------------------------------------
+void RunAtlasPackerTests()
+{
+	BeginEngineTestSection("Atlas packer");
+
+	RandomNumberGenerator rng(33);
+	std::vector<Image> images;
+	for (int imageIndex = 0; imageIndex < ATLAS_TEST_NUM_IMAGES; ++imageIndex)
+	{
+		IntVec2 dimensions(rng.RollRandomIntInRange(ATLAS_TEST_MIN_IMAGE_SIDE, ATLAS_TEST_MAX_IMAGE_SIDE), rng.RollRandomIntInRange(ATLAS_TEST_MIN_IMAGE_SIDE, ATLAS_TEST_MAX_IMAGE_SIDE));
+		Image image(dimensions, Rgba8());
+		for (int texelY = 0; texelY < dimensions.y; ++texelY)
+		{
+			for (int texelX = 0; texelX < dimensions.x; ++texelX)
+			{
+				image.SetTexelColor(texelX, texelY, GetAtlasTestTexel(imageIndex, texelX, texelY));
+			}
+		}
+		images.push_back(image);
+	}
+
+	AtlasPackerSettings settings;
+	settings.m_atlasDimensions = IntVec2(1024, 1024);
+	settings.m_padding = ATLAS_TEST_PADDING;
+	settings.m_allowRotation = true;
+	AtlasPacker packer(settings);
+
+	std::vector<AtlasRegion> regions;
+	double startTime = GetCurrentTimeSeconds();
+	bool didPackAll = packer.InsertImages(images, regions);
+	double packSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(didPackAll, "InsertImages could not fit 200 small images into a 1024x1024 atlas");
+
+	// Regions grown by their padding must stay inside the atlas and never touch each other
+	int numOutsideAtlas = 0;
+	int numOverlaps = 0;
+	int numWrongDims = 0;
+	for (int imageIndex = 0; imageIndex < ATLAS_TEST_NUM_IMAGES; ++imageIndex)
+	{
+		AtlasRegion const& region = regions[imageIndex];
+		IntVec2 imageDimensions = images[imageIndex].GetDimensions();
+		IntVec2 expectedDims = region.m_isRotated ? IntVec2(imageDimensions.y, imageDimensions.x) : imageDimensions;
+		numWrongDims += (region.m_texelDims == expectedDims) ? 0 : 1;
+
+		IntVec2 paddedMins(region.m_texelMins.x - ATLAS_TEST_PADDING, region.m_texelMins.y - ATLAS_TEST_PADDING);
+		IntVec2 paddedMaxs(region.m_texelMins.x + region.m_texelDims.x + ATLAS_TEST_PADDING, region.m_texelMins.y + region.m_texelDims.y + ATLAS_TEST_PADDING);
+		numOutsideAtlas += (paddedMins.x >= 0 && paddedMins.y >= 0 && paddedMaxs.x <= settings.m_atlasDimensions.x && paddedMaxs.y <= settings.m_atlasDimensions.y) ? 0 : 1;
+
+		for (int otherIndex = imageIndex + 1; otherIndex < ATLAS_TEST_NUM_IMAGES; ++otherIndex)
+		{
+			AtlasRegion const& otherRegion = regions[otherIndex];
+			IntVec2 otherMins(otherRegion.m_texelMins.x - ATLAS_TEST_PADDING, otherRegion.m_texelMins.y - ATLAS_TEST_PADDING);
+			IntVec2 otherMaxs(otherRegion.m_texelMins.x + otherRegion.m_texelDims.x + ATLAS_TEST_PADDING, otherRegion.m_texelMins.y + otherRegion.m_texelDims.y + ATLAS_TEST_PADDING);
+			bool doOverlap = paddedMins.x < otherMaxs.x && otherMins.x < paddedMaxs.x && paddedMins.y < otherMaxs.y && otherMins.y < paddedMaxs.y;
+			numOverlaps += doOverlap ? 1 : 0;
+		}
+	}
+	ENGINE_TEST_CHECK(numWrongDims == 0, Stringf("%d regions are not their image's size", numWrongDims));
+	ENGINE_TEST_CHECK(numOutsideAtlas == 0, Stringf("%d padded regions reach outside the atlas", numOutsideAtlas));
+	ENGINE_TEST_CHECK(numOverlaps == 0, Stringf("%d pairs of padded regions overlap", numOverlaps));
+
+	// Every stored texel matches its image, and every padding texel repeats the nearest edge texel
+	Image const& atlasImage = packer.GetAtlasImage();
+	int numWrongTexels = 0;
+	int numWrongPaddingTexels = 0;
+	for (int imageIndex = 0; imageIndex < ATLAS_TEST_NUM_IMAGES; ++imageIndex)
+	{
+		AtlasRegion const& region = regions[imageIndex];
+		IntVec2 imageDimensions = images[imageIndex].GetDimensions();
+		for (int regionY = -ATLAS_TEST_PADDING; regionY < region.m_texelDims.y + ATLAS_TEST_PADDING; ++regionY)
+		{
+			for (int regionX = -ATLAS_TEST_PADDING; regionX < region.m_texelDims.x + ATLAS_TEST_PADDING; ++regionX)
+			{
+				int clampedX = std::clamp(regionX, 0, region.m_texelDims.x - 1);
+				int clampedY = std::clamp(regionY, 0, region.m_texelDims.y - 1);
+				IntVec2 imageTexel = GetImageTexelForRegionTexel(region, imageDimensions, clampedX, clampedY);
+				Rgba8 expectedColor = GetAtlasTestTexel(imageIndex, imageTexel.x, imageTexel.y);
+				Rgba8 atlasColor = atlasImage.GetTexelColor(region.m_texelMins.x + regionX, region.m_texelMins.y + regionY);
+				bool isPadding = clampedX != regionX || clampedY != regionY;
+				int& numWrong = isPadding ? numWrongPaddingTexels : numWrongTexels;
+				numWrong += (atlasColor.r == expectedColor.r && atlasColor.g == expectedColor.g && atlasColor.b == expectedColor.b && atlasColor.a == expectedColor.a) ? 0 : 1;
+			}
+		}
+	}
+	ENGINE_TEST_CHECK(numWrongTexels == 0, Stringf("%d atlas texels do not match the image packed there", numWrongTexels));
+	ENGINE_TEST_CHECK(numWrongPaddingTexels == 0, Stringf("%d padding texels are not extruded from the nearest edge", numWrongPaddingTexels));
+
+	AtlasRegion tooBigRegion = packer.InsertImage(Image(IntVec2(1024, 8), Rgba8()));
+	ENGINE_TEST_CHECK(!tooBigRegion.m_isPacked, "An image as wide as the atlas cannot fit once padding is added");
+
+	PrintEngineTestTiming(Stringf("%d images  occupancy %.1f%%  %7.2fms", ATLAS_TEST_NUM_IMAGES, packer.GetOccupancy() * 100.f, packSeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/BlockCompression.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Not a multiple of 4 either way, so the edge blocks that repeat the last row and column are covered
+IntVec2 const BLOCK_COMPRESSION_TEST_DIMENSIONS = IntVec2(514, 258);
+// -----------------------------------------------------------------------------
+// Lowest acceptable PSNR in dB for each format and quality, about 1.5dB under what the encoder reaches on the
+// test image so only a broken encoder or decoder trips them
+static float const s_minColorPSNR[3][3] =
+{
+	{ 37.5f, 38.f, 38.f },	// BC1 fast, normal, high
+	{ 36.5f, 36.5f, 36.5f },	// BC3
+	{ 39.f, 39.f, 42.5f },	// BC7
+};
+static float const s_minRgbaPSNR[3][3] =
+{
+	{ 39.f, 39.f, 39.f },
+	{ 37.5f, 38.f, 38.f },
+	{ 40.f, 40.f, 43.f },
+};
+// -----------------------------------------------------------------------------
+// Smooth gradients with some noise and soft edged alpha, roughly what real textures look like to a block encoder
+static Image MakeBlockCompressionTestImage()
+{
+	RandomNumberGenerator rng(34);
+	IntVec2 dimensions = BLOCK_COMPRESSION_TEST_DIMENSIONS;
+	std::vector<Rgba8> texels(static_cast<size_t>(dimensions.x) * dimensions.y);
+	for (int y = 0; y < dimensions.y; ++y)
+	{
+		for (int x = 0; x < dimensions.x; ++x)
+		{
+			float u = static_cast<float>(x) / static_cast<float>(dimensions.x);
+			float v = static_cast<float>(y) / static_cast<float>(dimensions.y);
+			float noise = rng.RollRandomFloatInRange(-12.f, 12.f);
+			float r = 128.f + 100.f * sinf(u * 9.f) + noise;
+			float g = 255.f * v + noise;
+			float b = 128.f + 90.f * cosf((u + v) * 13.f);
+			float a = 255.f * std::min(1.f, std::max(0.f, 2.f - 4.f * fabsf(u - 0.5f)));
+			auto toByte = [](float value) { return static_cast<unsigned char>(std::min(255.f, std::max(0.f, value))); };
+			texels[static_cast<size_t>(y) * dimensions.x + x] = Rgba8(toByte(r), toByte(g), toByte(b), toByte(a));
+		}
+	}
+	return Image(dimensions, std::move(texels));
+}
+
+// What BC1 can hold at best, texels under half alpha turn transparent black and the rest opaque
+static Image MakeBC1ReferenceImage(Image const& image)
+{
+	IntVec2 dimensions = image.GetDimensions();
+	Rgba8 const* sourceTexels = static_cast<Rgba8 const*>(image.GetRawData());
+	std::vector<Rgba8> texels(sourceTexels, sourceTexels + static_cast<size_t>(dimensions.x) * dimensions.y);
+	for (Rgba8& texel : texels)
+	{
+		texel = texel.a < 128 ? Rgba8(0, 0, 0, 0) : Rgba8(texel.r, texel.g, texel.b, 255);
+	}
+	return Image(dimensions, std::move(texels));
+}
+// -----------------------------------------------------------------------------
+void RunBlockCompressionTests()
+{
+	static char const* const s_formatNames[] = { "BC1", "BC3", "BC7" };
+	static char const* const s_qualityNames[] = { "fast", "normal", "high" };
+
+	BeginEngineTestSection("Block compression");
+
+	Image image = MakeBlockCompressionTestImage();
+	Image bc1ReferenceImage = MakeBC1ReferenceImage(image);
+	IntVec2 dimensions = image.GetDimensions();
+	IntVec2 blockCounts = GetBlockCompressionBlockCounts(dimensions);
+	double megaTexels = static_cast<double>(dimensions.x) * dimensions.y / 1000000.0;
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	for (int formatIndex = 0; formatIndex < static_cast<int>(BlockCompressionFormat::COUNT); ++formatIndex)
+	{
+		for (int qualityIndex = 0; qualityIndex < static_cast<int>(BlockCompressionQuality::COUNT); ++qualityIndex)
+		{
+			BlockCompressionSettings settings;
+			settings.m_format = static_cast<BlockCompressionFormat>(formatIndex);
+			settings.m_quality = static_cast<BlockCompressionQuality>(qualityIndex);
+			std::string settingsName = Stringf("%s %s", s_formatNames[formatIndex], s_qualityNames[qualityIndex]);
+
+			CompressedImage serialImage;
+			double startTime = GetCurrentTimeSeconds();
+			CompressImage(serialImage, image, settings);
+			double serialSeconds = GetCurrentTimeSeconds() - startTime;
+
+			CompressedImage parallelImage;
+			startTime = GetCurrentTimeSeconds();
+			CompressImage(parallelImage, image, settings, &jobSystem);
+			double parallelSeconds = GetCurrentTimeSeconds() - startTime;
+
+			size_t expectedNumBytes = static_cast<size_t>(blockCounts.x) * blockCounts.y * GetBlockCompressionBytesPerBlock(settings.m_format);
+			ENGINE_TEST_CHECK(serialImage.m_blocks.size() == expectedNumBytes, Stringf("%s wrote %d bytes of blocks, expected %d", settingsName.c_str(),
+				static_cast<int>(serialImage.m_blocks.size()), static_cast<int>(expectedNumBytes)));
+			ENGINE_TEST_CHECK(serialImage.m_blocks == parallelImage.m_blocks, Stringf("%s blocks differ between the serial and job system encodes", settingsName.c_str()));
+
+			Image decodedImage;
+			DecompressImage(decodedImage, serialImage);
+			if (!ENGINE_TEST_CHECK(decodedImage.GetDimensions() == dimensions, Stringf("%s decoded to the wrong size", settingsName.c_str())))
+			{
+				continue;
+			}
+			Image const& referenceImage = settings.m_format == BlockCompressionFormat::BC1 ? bc1ReferenceImage : image;
+			float colorPSNR = ComputeImagePSNR(referenceImage, decodedImage, false);
+			float rgbaPSNR = ComputeImagePSNR(referenceImage, decodedImage, true);
+			ENGINE_TEST_CHECK(colorPSNR >= s_minColorPSNR[formatIndex][qualityIndex], Stringf("%s RGB PSNR %.2fdB is under %.2fdB", settingsName.c_str(),
+				colorPSNR, s_minColorPSNR[formatIndex][qualityIndex]));
+			ENGINE_TEST_CHECK(rgbaPSNR >= s_minRgbaPSNR[formatIndex][qualityIndex], Stringf("%s RGBA PSNR %.2fdB is under %.2fdB", settingsName.c_str(),
+				rgbaPSNR, s_minRgbaPSNR[formatIndex][qualityIndex]));
+
+			PrintEngineTestTiming(Stringf("%-10s serial %8.2fms  %d workers %8.2fms %7.2f MTexels/s  PSNR RGB %.2fdB RGBA %.2fdB", settingsName.c_str(),
+				serialSeconds * 1000.0, jobSystem.GetNumWorkers(), parallelSeconds * 1000.0, megaTexels / std::max(parallelSeconds, 1e-9), colorPSNR, rgbaPSNR));
+		}
+	}
+
+	jobSystem.Shutdown();
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,179 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/ImageKernels.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Odd sizes so the vector loops also run their scalar tails, and more rows than one tile
+IntVec2 const IMAGE_KERNEL_TEST_DIMENSIONS = IntVec2(1027, 515);
+// -----------------------------------------------------------------------------
+static Image MakeHashedTestImage(IntVec2 const& dimensions)
+{
+	size_t numTexels = static_cast<size_t>(dimensions.x) * dimensions.y;
+	std::vector<Rgba8> texels(numTexels);
+	for (size_t texelIndex = 0; texelIndex < numTexels; ++texelIndex)
+	{
+		unsigned int bits = static_cast<unsigned int>(texelIndex * 2654435761u);
+		texels[texelIndex] = Rgba8(static_cast<unsigned char>(bits), static_cast<unsigned char>(bits >> 8), static_cast<unsigned char>(bits >> 16), static_cast<unsigned char>(bits >> 24));
+	}
+	return Image(dimensions, std::move(texels));
+}
+
+static bool AreImagesIdentical(Image const& imageA, Image const& imageB)
+{
+	IntVec2 dimensions = imageA.GetDimensions();
+	if (dimensions != imageB.GetDimensions())
+	{
+		return false;
+	}
+	size_t numBytes = static_cast<size_t>(dimensions.x) * dimensions.y * sizeof(Rgba8);
+	return memcmp(imageA.GetRawData(), imageB.GetRawData(), numBytes) == 0;
+}
+
+// Largest difference of any channel of any texel from color
+static int GetMaxDifferenceFromColor(Image const& image, Rgba8 const& color)
+{
+	IntVec2 dimensions = image.GetDimensions();
+	Rgba8 const* texels = static_cast<Rgba8 const*>(image.GetRawData());
+	int maxDifference = 0;
+	for (size_t texelIndex = 0; texelIndex < static_cast<size_t>(dimensions.x) * dimensions.y; ++texelIndex)
+	{
+		maxDifference = std::max(maxDifference, abs(texels[texelIndex].r - color.r));
+		maxDifference = std::max(maxDifference, abs(texels[texelIndex].g - color.g));
+		maxDifference = std::max(maxDifference, abs(texels[texelIndex].b - color.b));
+		maxDifference = std::max(maxDifference, abs(texels[texelIndex].a - color.a));
+	}
+	return maxDifference;
+}
+// -----------------------------------------------------------------------------
+static void TestPremultiplyAndSwizzle(JobSystem& jobSystem, Image const& sourceImage)
+{
+	IntVec2 dimensions = sourceImage.GetDimensions();
+
+	// The per texel loop game code writes, which the row kernel must match exactly
+	Image scalarImage = sourceImage;
+	double startTime = GetCurrentTimeSeconds();
+	for (int texelY = 0; texelY < dimensions.y; ++texelY)
+	{
+		for (int texelX = 0; texelX < dimensions.x; ++texelX)
+		{
+			Rgba8 texel = scalarImage.GetTexelColor(texelX, texelY);
+			texel.r = static_cast<unsigned char>((texel.r * texel.a + 127) / 255);
+			texel.g = static_cast<unsigned char>((texel.g * texel.a + 127) / 255);
+			texel.b = static_cast<unsigned char>((texel.b * texel.a + 127) / 255);
+			scalarImage.SetTexelColor(texelX, texelY, texel);
+		}
+	}
+	double scalarSeconds = GetCurrentTimeSeconds() - startTime;
+
+	Image serialImage = sourceImage;
+	PremultiplyImageAlpha(serialImage);
+	Image kernelImage = sourceImage;
+	startTime = GetCurrentTimeSeconds();
+	PremultiplyImageAlpha(kernelImage, &jobSystem);
+	double kernelSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(AreImagesIdentical(serialImage, scalarImage), "PremultiplyImageAlpha does not round like (color * alpha + 127) / 255");
+	ENGINE_TEST_CHECK(AreImagesIdentical(kernelImage, scalarImage), "PremultiplyImageAlpha across the job system differs from the per texel loop");
+	PrintEngineTestTiming(Stringf("%-24s per texel %7.2fms  kernel %7.2fms", "Premultiply", scalarSeconds * 1000.0, kernelSeconds * 1000.0));
+
+	// Swizzle a view of the middle, everything outside it must stay as it was
+	IntVec2 viewMins(5, 7);
+	IntVec2 viewDimensions(dimensions.x - 13, dimensions.y - 20);
+	Image swizzledImage = sourceImage;
+	startTime = GetCurrentTimeSeconds();
+	SwizzleImageChannels(swizzledImage.GetView(viewMins, viewDimensions), ImageChannel::BLUE, ImageChannel::GREEN, ImageChannel::RED, ImageChannel::ONE, &jobSystem);
+	double swizzleSeconds = GetCurrentTimeSeconds() - startTime;
+
+	int numWrongTexels = 0;
+	for (int texelY = 0; texelY < dimensions.y; ++texelY)
+	{
+		for (int texelX = 0; texelX < dimensions.x; ++texelX)
+		{
+			Rgba8 expected = sourceImage.GetTexelColor(texelX, texelY);
+			bool isInView = texelX >= viewMins.x && texelX < viewMins.x + viewDimensions.x && texelY >= viewMins.y && texelY < viewMins.y + viewDimensions.y;
+			if (isInView)
+			{
+				expected = Rgba8(expected.b, expected.g, expected.r, 255);
+			}
+			Rgba8 swizzled = swizzledImage.GetTexelColor(texelX, texelY);
+			if (memcmp(&expected, &swizzled, sizeof(Rgba8)) != 0)
+			{
+				++numWrongTexels;
+			}
+		}
+	}
+	ENGINE_TEST_CHECK(numWrongTexels == 0, Stringf("SwizzleImageChannels to BGR1 got %d texels wrong", numWrongTexels));
+	PrintEngineTestTiming(Stringf("%-24s %7.2fms", "Swizzle BGR1", swizzleSeconds * 1000.0));
+}
+
+static void TestResizeAndBlur(JobSystem& jobSystem, Image const& sourceImage)
+{
+	static char const* const s_filterNames[] = { "bilinear", "Lanczos3" };
+	IntVec2 dimensions = sourceImage.GetDimensions();
+	IntVec2 halfDimensions(dimensions.x / 2 + 1, dimensions.y / 2 + 1);
+
+	// Normalized weights must leave a flat color flat, up to rounding
+	Rgba8 const flatColor(200, 100, 37, 140);
+	Image flatImage(dimensions, flatColor);
+
+	for (int filterIndex = 0; filterIndex < static_cast<int>(ImageResizeFilter::COUNT); ++filterIndex)
+	{
+		ImageResizeFilter filter = static_cast<ImageResizeFilter>(filterIndex);
+		char const* filterName = s_filterNames[filterIndex];
+
+		Image serialImage;
+		ResizeImage(serialImage, sourceImage, halfDimensions, filter);
+		Image parallelImage;
+		double startTime = GetCurrentTimeSeconds();
+		ResizeImage(parallelImage, sourceImage, halfDimensions, filter, &jobSystem);
+		double resizeSeconds = GetCurrentTimeSeconds() - startTime;
+		ENGINE_TEST_CHECK(parallelImage.GetDimensions() == halfDimensions, Stringf("%s ResizeImage made the wrong size", filterName));
+		ENGINE_TEST_CHECK(AreImagesIdentical(serialImage, parallelImage), Stringf("%s ResizeImage across the job system differs from the serial resize", filterName));
+
+		Image flatHalfImage;
+		ResizeImage(flatHalfImage, flatImage, halfDimensions, filter, &jobSystem);
+		Image flatDoubleImage;
+		ResizeImage(flatDoubleImage, flatImage, IntVec2(dimensions.x * 2 - 1, dimensions.y + 3), filter, &jobSystem);
+		int halfDifference = GetMaxDifferenceFromColor(flatHalfImage, flatColor);
+		int doubleDifference = GetMaxDifferenceFromColor(flatDoubleImage, flatColor);
+		ENGINE_TEST_CHECK(halfDifference <= 1, Stringf("%s shrinking a flat image changed a channel by %d", filterName, halfDifference));
+		ENGINE_TEST_CHECK(doubleDifference <= 1, Stringf("%s growing a flat image changed a channel by %d", filterName, doubleDifference));
+		PrintEngineTestTiming(Stringf("%-24s %7.2fms", Stringf("Resize %s to half", filterName).c_str(), resizeSeconds * 1000.0));
+	}
+
+	Image serialImage;
+	BlurImage(serialImage, sourceImage, 2.f);
+	Image parallelImage;
+	double startTime = GetCurrentTimeSeconds();
+	BlurImage(parallelImage, sourceImage, 2.f, &jobSystem);
+	double blurSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(parallelImage.GetDimensions() == dimensions, "BlurImage changed the image size");
+	ENGINE_TEST_CHECK(AreImagesIdentical(serialImage, parallelImage), "BlurImage across the job system differs from the serial blur");
+
+	Image flatBlurImage;
+	BlurImage(flatBlurImage, flatImage, 2.f, &jobSystem);
+	int blurDifference = GetMaxDifferenceFromColor(flatBlurImage, flatColor);
+	ENGINE_TEST_CHECK(blurDifference <= 1, Stringf("Blurring a flat image changed a channel by %d", blurDifference));
+	PrintEngineTestTiming(Stringf("%-24s %7.2fms", "Blur sigma 2", blurSeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
+void RunImageKernelTests()
+{
+	BeginEngineTestSection("Image kernels");
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	Image sourceImage = MakeHashedTestImage(IMAGE_KERNEL_TEST_DIMENSIONS);
+	TestPremultiplyAndSwizzle(jobSystem, sourceImage);
+	TestResizeAndBlur(jobSystem, sourceImage);
+
+	jobSystem.Shutdown();
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,161 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/ImageMips.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Odd sizes so odd levels drop their last row or column, and enough rows for several tiles
+IntVec2 const IMAGE_MIP_TEST_DIMENSIONS = IntVec2(1027, 515);
+// -----------------------------------------------------------------------------
+static Image MakeHashedMipTestImage(IntVec2 const& dimensions)
+{
+	size_t numTexels = static_cast<size_t>(dimensions.x) * dimensions.y;
+	std::vector<Rgba8> texels(numTexels);
+	for (size_t texelIndex = 0; texelIndex < numTexels; ++texelIndex)
+	{
+		unsigned int bits = static_cast<unsigned int>(texelIndex * 2654435761u);
+		texels[texelIndex] = Rgba8(static_cast<unsigned char>(bits), static_cast<unsigned char>(bits >> 8), static_cast<unsigned char>(bits >> 16), static_cast<unsigned char>(bits >> 24));
+	}
+	return Image(dimensions, std::move(texels));
+}
+
+static bool AreMipChainsIdentical(std::vector<Image> const& chainA, std::vector<Image> const& chainB)
+{
+	if (chainA.size() != chainB.size())
+	{
+		return false;
+	}
+	for (int levelIndex = 0; levelIndex < static_cast<int>(chainA.size()); ++levelIndex)
+	{
+		IntVec2 dimensions = chainA[levelIndex].GetDimensions();
+		size_t numBytes = static_cast<size_t>(dimensions.x) * dimensions.y * sizeof(Rgba8);
+		if (dimensions != chainB[levelIndex].GetDimensions() || memcmp(chainA[levelIndex].GetRawData(), chainB[levelIndex].GetRawData(), numBytes) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+// -----------------------------------------------------------------------------
+static void TestMipChainSizes(Image const& baseImage)
+{
+	// 1027x515 halves down to 1x1 in 11 levels, the narrow side clamping at 1 for the last one
+	int numLevels = GetFullMipLevelCount(baseImage.GetDimensions());
+	ENGINE_TEST_CHECK(numLevels == 11, Stringf("GetFullMipLevelCount gave %d levels for 1027x515, expected 11", numLevels));
+	ENGINE_TEST_CHECK(GetFullMipLevelCount(IntVec2(1, 1)) == 1, "A 1x1 image should have exactly one mip level");
+
+	std::vector<Image> mipChain;
+	GenerateImageMipChain(mipChain, baseImage);
+	ENGINE_TEST_CHECK(static_cast<int>(mipChain.size()) == numLevels, Stringf("GenerateImageMipChain made %d levels, expected %d", static_cast<int>(mipChain.size()), numLevels));
+
+	int numWrongSizes = 0;
+	IntVec2 expectedDims = baseImage.GetDimensions();
+	for (Image const& mipImage : mipChain)
+	{
+		numWrongSizes += (mipImage.GetDimensions() == expectedDims) ? 0 : 1;
+		expectedDims = IntVec2(std::max(1, expectedDims.x / 2), std::max(1, expectedDims.y / 2));
+	}
+	ENGINE_TEST_CHECK(numWrongSizes == 0, Stringf("%d mip levels are not half the size of the level above, rounded down", numWrongSizes));
+	ENGINE_TEST_CHECK(mipChain.back().GetDimensions() == IntVec2(1, 1), "The full mip chain should end at 1x1");
+
+	ImageMipSettings cappedSettings;
+	cappedSettings.m_maxLevels = 3;
+	GenerateImageMipChain(mipChain, baseImage, cappedSettings);
+	ENGINE_TEST_CHECK(mipChain.size() == 3, Stringf("m_maxLevels 3 made %d levels", static_cast<int>(mipChain.size())));
+}
+
+static void TestSRGBFiltering()
+{
+	// Black and white columns average to half the light, which sRGB encodes near 188 rather than 128. Alpha is always linear.
+	std::vector<Rgba8> texels = { Rgba8(0, 0, 0, 0), Rgba8(255, 255, 255, 255), Rgba8(0, 0, 0, 0), Rgba8(255, 255, 255, 255) };
+	Image stripeImage(IntVec2(2, 2), std::move(texels));
+
+	ImageMipSettings srgbSettings;
+	Image srgbMip;
+	DownsampleImage(srgbMip, stripeImage, srgbSettings);
+	Rgba8 srgbTexel = srgbMip.GetTexelColor(0, 0);
+	ENGINE_TEST_CHECK(abs(srgbTexel.r - 188) <= 1 && srgbTexel.g == srgbTexel.r && srgbTexel.b == srgbTexel.r,
+		Stringf("sRGB box filter gave %d,%d,%d for black and white, expected about 188", srgbTexel.r, srgbTexel.g, srgbTexel.b));
+	ENGINE_TEST_CHECK(abs(srgbTexel.a - 128) <= 1, Stringf("sRGB box filter gave alpha %d, alpha should average linearly to about 128", srgbTexel.a));
+
+	ImageMipSettings linearSettings;
+	linearSettings.m_isSRGB = false;
+	Image linearMip;
+	DownsampleImage(linearMip, stripeImage, linearSettings);
+	Rgba8 linearTexel = linearMip.GetTexelColor(0, 0);
+	ENGINE_TEST_CHECK(abs(linearTexel.r - 128) <= 1 && abs(linearTexel.a - 128) <= 1,
+		Stringf("Linear box filter gave %d alpha %d for black and white, expected about 128", linearTexel.r, linearTexel.a));
+
+	// Both filters are normalized, so a flat color comes through every level unchanged in either color space
+	Rgba8 flatColor(200, 100, 50, 180);
+	Image flatImage(IntVec2(64, 48), flatColor);
+	int maxDifference = 0;
+	for (int filterIndex = 0; filterIndex < static_cast<int>(ImageMipFilter::COUNT); ++filterIndex)
+	{
+		for (int colorSpace = 0; colorSpace < 2; ++colorSpace)
+		{
+			ImageMipSettings flatSettings;
+			flatSettings.m_filter = static_cast<ImageMipFilter>(filterIndex);
+			flatSettings.m_isSRGB = colorSpace == 0;
+			std::vector<Image> mipChain;
+			GenerateImageMipChain(mipChain, flatImage, flatSettings);
+			for (Image const& mipImage : mipChain)
+			{
+				IntVec2 dimensions = mipImage.GetDimensions();
+				for (int texelY = 0; texelY < dimensions.y; ++texelY)
+				{
+					for (int texelX = 0; texelX < dimensions.x; ++texelX)
+					{
+						Rgba8 texel = mipImage.GetTexelColor(texelX, texelY);
+						maxDifference = std::max(maxDifference, std::max(std::max(abs(texel.r - flatColor.r), abs(texel.g - flatColor.g)),
+							std::max(abs(texel.b - flatColor.b), abs(texel.a - flatColor.a))));
+					}
+				}
+			}
+		}
+	}
+	ENGINE_TEST_CHECK(maxDifference <= 1, Stringf("Filtering a flat image into mips changed a channel by %d", maxDifference));
+}
+
+static void TestParallelMipChain(JobSystem& jobSystem, Image const& baseImage)
+{
+	ImageMipSettings kaiserSettings;
+	kaiserSettings.m_filter = ImageMipFilter::KAISER;
+
+	std::vector<Image> serialChain;
+	GenerateImageMipChain(serialChain, baseImage, kaiserSettings);
+	std::vector<Image> parallelChain;
+	double startTime = GetCurrentTimeSeconds();
+	GenerateImageMipChain(parallelChain, baseImage, kaiserSettings, &jobSystem);
+	double kaiserSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(AreMipChainsIdentical(serialChain, parallelChain), "The Kaiser mip chain across the job system differs from the serial one");
+
+	startTime = GetCurrentTimeSeconds();
+	GenerateImageMipChain(parallelChain, baseImage, ImageMipSettings(), &jobSystem);
+	double boxSeconds = GetCurrentTimeSeconds() - startTime;
+
+	PrintEngineTestTiming(Stringf("%-24s %7.2fms", "Box sRGB mip chain", boxSeconds * 1000.0));
+	PrintEngineTestTiming(Stringf("%-24s %7.2fms", "Kaiser sRGB mip chain", kaiserSeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
+void RunImageMipTests()
+{
+	BeginEngineTestSection("Image mips");
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	Image baseImage = MakeHashedMipTestImage(IMAGE_MIP_TEST_DIMENSIONS);
+	TestMipChainSizes(baseImage);
+	TestSRGBFiltering();
+	TestParallelMipChain(jobSystem, baseImage);
+
+	jobSystem.Shutdown();
+}
+// -----------------------------------------------------------------------------
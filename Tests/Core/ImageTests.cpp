@@ -0,0 +1,170 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <cstring>
+#include <filesystem>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Odd width so the SSSE3 row conversions also run their scalar tails
+IntVec2 const IMAGE_TEST_DIMENSIONS = IntVec2(2049, 1024);
+constexpr int IMAGE_TEST_NUM_PARALLEL_COPIES = 4;	// Of each test file, for the serial against parallel decode
+// -----------------------------------------------------------------------------
+// The texel Image should hold at (x, y) for a file written by WriteTestImageFile, whose first row is the top
+static Rgba8 GetExpectedTexel(int x, int y, int numComponents)
+{
+	int sourceRow = IMAGE_TEST_DIMENSIONS.y - 1 - y;
+	unsigned char r = static_cast<unsigned char>(x * 7 + sourceRow * 3);
+	unsigned char g = static_cast<unsigned char>(x * 13 + sourceRow * 5);
+	unsigned char b = static_cast<unsigned char>(x * 3 + sourceRow * 11);
+	unsigned char a = static_cast<unsigned char>(x ^ sourceRow);
+	switch (numComponents)
+	{
+		case 1:  return Rgba8(r, r, r, 255);
+		case 3:  return Rgba8(r, g, b, 255);
+		default: return Rgba8(r, g, b, a);
+	}
+}
+
+// Uncompressed TGA, the one format stb_image reads that is simple enough to write here, stored top row first
+static bool WriteTestImageFile(std::string const& filePath, int numComponents)
+{
+	int width = IMAGE_TEST_DIMENSIONS.x;
+	int height = IMAGE_TEST_DIMENSIONS.y;
+	std::vector<uint8_t> fileBytes(18 + static_cast<size_t>(width) * height * numComponents, 0);
+	fileBytes[2] = numComponents == 1 ? 3 : 2;		// Grey or true color
+	fileBytes[12] = static_cast<uint8_t>(width & 0xFF);
+	fileBytes[13] = static_cast<uint8_t>(width >> 8);
+	fileBytes[14] = static_cast<uint8_t>(height & 0xFF);
+	fileBytes[15] = static_cast<uint8_t>(height >> 8);
+	fileBytes[16] = static_cast<uint8_t>(numComponents * 8);
+	fileBytes[17] = static_cast<uint8_t>(0x20 | (numComponents == 4 ? 8 : 0));	// Top left origin, alpha bits
+
+	uint8_t* texelBytes = fileBytes.data() + 18;
+	for (int sourceRow = 0; sourceRow < height; ++sourceRow)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			Rgba8 color = GetExpectedTexel(x, height - 1 - sourceRow, numComponents);
+			if (numComponents == 1)
+			{
+				*texelBytes++ = color.r;
+				continue;
+			}
+			// TGA stores BGR(A)
+			*texelBytes++ = color.b;
+			*texelBytes++ = color.g;
+			*texelBytes++ = color.r;
+			if (numComponents == 4)
+			{
+				*texelBytes++ = color.a;
+			}
+		}
+	}
+	return WriteBufferToFile(fileBytes, filePath) == FILE_SUCCESS;
+}
+
+static int CountWrongTexels(Image const& image, int numComponents)
+{
+	if (image.GetDimensions() != IMAGE_TEST_DIMENSIONS)
+	{
+		return IMAGE_TEST_DIMENSIONS.x * IMAGE_TEST_DIMENSIONS.y;
+	}
+	int numWrongTexels = 0;
+	for (int y = 0; y < IMAGE_TEST_DIMENSIONS.y; ++y)
+	{
+		for (int x = 0; x < IMAGE_TEST_DIMENSIONS.x; ++x)
+		{
+			Rgba8 expected = GetExpectedTexel(x, y, numComponents);
+			Rgba8 loaded = image.GetTexelColor(x, y);
+			if (memcmp(&expected, &loaded, sizeof(Rgba8)) != 0)
+			{
+				++numWrongTexels;
+			}
+		}
+	}
+	return numWrongTexels;
+}
+// -----------------------------------------------------------------------------
+void RunImageTests()
+{
+	BeginEngineTestSection("Image loading");
+
+	std::filesystem::path tempFolder = std::filesystem::temp_directory_path();
+	int const componentCounts[] = { 1, 3, 4 };
+	char const* const formatNames[] = { "grey", "RGB", "RGBA" };
+	std::vector<std::string> filePaths;
+	for (int formatIndex = 0; formatIndex < 3; ++formatIndex)
+	{
+		std::string filePath = (tempFolder / Stringf("EngineTests_Image_%s.tga", formatNames[formatIndex])).string();
+		bool didWrite = WriteTestImageFile(filePath, componentCounts[formatIndex]);
+		if (!ENGINE_TEST_CHECK(didWrite, Stringf("Could not write \"%s\"", filePath.c_str())))
+		{
+			return;
+		}
+		filePaths.push_back(filePath);
+	}
+
+	// Each channel layout decodes to the right texels, bottom row first
+	std::vector<Image> serialImages(3);
+	for (int formatIndex = 0; formatIndex < 3; ++formatIndex)
+	{
+		double startTime = GetCurrentTimeSeconds();
+		bool didLoad = serialImages[formatIndex].LoadFromFile(filePaths[formatIndex].c_str());
+		double loadSeconds = GetCurrentTimeSeconds() - startTime;
+
+		ENGINE_TEST_CHECK(didLoad, Stringf("Could not load the %s test image", formatNames[formatIndex]));
+		int numWrongTexels = didLoad ? CountWrongTexels(serialImages[formatIndex], componentCounts[formatIndex]) : 0;
+		ENGINE_TEST_CHECK(numWrongTexels == 0, Stringf("%d texels of the %s test image are wrong", numWrongTexels, formatNames[formatIndex]));
+		PrintEngineTestTiming(Stringf("Load %-5s %dx%d  %7.2fms", formatNames[formatIndex], IMAGE_TEST_DIMENSIONS.x, IMAGE_TEST_DIMENSIONS.y, loadSeconds * 1000.0));
+	}
+
+	// The job system decodes the same texels as loading one file after another
+	std::vector<std::string> parallelFilePaths;
+	for (int copyIndex = 0; copyIndex < IMAGE_TEST_NUM_PARALLEL_COPIES; ++copyIndex)
+	{
+		parallelFilePaths.insert(parallelFilePaths.end(), filePaths.begin(), filePaths.end());
+	}
+	double startTime = GetCurrentTimeSeconds();
+	for (int imageIndex = 0; imageIndex < static_cast<int>(parallelFilePaths.size()); ++imageIndex)
+	{
+		Image image;
+		image.LoadFromFile(parallelFilePaths[imageIndex].c_str());
+	}
+	double serialSeconds = GetCurrentTimeSeconds() - startTime;
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+	std::vector<Image> parallelImages;
+	startTime = GetCurrentTimeSeconds();
+	LoadImagesParallel(jobSystem, parallelFilePaths, parallelImages);
+	double parallelSeconds = GetCurrentTimeSeconds() - startTime;
+	int numWorkers = jobSystem.GetNumWorkers();
+	jobSystem.Shutdown();
+
+	int numDifferentImages = 0;
+	for (int imageIndex = 0; imageIndex < static_cast<int>(parallelImages.size()); ++imageIndex)
+	{
+		Image const& serialImage = serialImages[imageIndex % 3];
+		Image const& parallelImage = parallelImages[imageIndex];
+		size_t numBytes = static_cast<size_t>(IMAGE_TEST_DIMENSIONS.x) * IMAGE_TEST_DIMENSIONS.y * sizeof(Rgba8);
+		if (serialImage.GetDimensions() != IMAGE_TEST_DIMENSIONS || parallelImage.GetDimensions() != IMAGE_TEST_DIMENSIONS || memcmp(serialImage.GetRawData(), parallelImage.GetRawData(), numBytes) != 0)
+		{
+			++numDifferentImages;
+		}
+	}
+	ENGINE_TEST_CHECK(numDifferentImages == 0, Stringf("%d of %d images loaded in parallel differ from the serial loads", numDifferentImages, static_cast<int>(parallelImages.size())));
+	PrintEngineTestTiming(Stringf("Decode %d files  serial %7.2fms  %d workers %7.2fms", static_cast<int>(parallelFilePaths.size()),
+		serialSeconds * 1000.0, numWorkers, parallelSeconds * 1000.0));
+
+	for (std::string const& filePath : filePaths)
+	{
+		std::error_code removeError;
+		std::filesystem::remove(filePath, removeError);
+	}
+}
+// -----------------------------------------------------------------------------
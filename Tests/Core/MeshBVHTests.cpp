@@ -0,0 +1,172 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/MeshBVH.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int MESH_BVH_TEST_GRID_SIZE = 96;		// Cells per side, two triangles each
+constexpr int MESH_BVH_TEST_NUM_RAYS = 3000;
+// -----------------------------------------------------------------------------
+// Rolling height field, two triangles per cell sharing every edge with their neighbours
+static void MakeHeightFieldMesh(RandomNumberGenerator& rng, std::vector<Vertex_PCUTBN>& out_verts, std::vector<unsigned int>& out_indexes)
+{
+	int numGridVerts = MESH_BVH_TEST_GRID_SIZE + 1;
+	out_verts.resize(numGridVerts * numGridVerts);
+	for (int y = 0; y < numGridVerts; ++y)
+	{
+		for (int x = 0; x < numGridVerts; ++x)
+		{
+			float height = 4.f * sinf(static_cast<float>(x) * 0.11f) * cosf(static_cast<float>(y) * 0.07f) + rng.RollRandomFloatInRange(-0.25f, 0.25f);
+			out_verts[y * numGridVerts + x].m_position = Vec3(static_cast<float>(x), static_cast<float>(y), height);
+		}
+	}
+	out_indexes.clear();
+	for (int y = 0; y < MESH_BVH_TEST_GRID_SIZE; ++y)
+	{
+		for (int x = 0; x < MESH_BVH_TEST_GRID_SIZE; ++x)
+		{
+			unsigned int bottomLeft = static_cast<unsigned int>(y * numGridVerts + x);
+			unsigned int topLeft = bottomLeft + static_cast<unsigned int>(numGridVerts);
+			unsigned int const cellIndexes[6] = { bottomLeft, bottomLeft + 1, topLeft + 1, bottomLeft, topLeft + 1, topLeft };
+			out_indexes.insert(out_indexes.end(), cellIndexes, cellIndexes + 6);
+		}
+	}
+}
+
+static bool AreMeshRaycastResultsEqual(MeshRaycastResult3D const& resultA, MeshRaycastResult3D const& resultB)
+{
+	return resultA.m_didImpact == resultB.m_didImpact && resultA.m_triangleIndex == resultB.m_triangleIndex &&
+		(!resultA.m_didImpact || resultA.m_impactDist == resultB.m_impactDist);
+}
+// -----------------------------------------------------------------------------
+void RunMeshBVHTests()
+{
+	BeginEngineTestSection("MeshBVH");
+
+	RandomNumberGenerator rng(41);
+	std::vector<Vertex_PCUTBN> meshVerts;
+	std::vector<unsigned int> meshIndexes;
+	MakeHeightFieldMesh(rng, meshVerts, meshIndexes);
+	int numTris = static_cast<int>(meshIndexes.size()) / 3;
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+	MeshBVH meshBVH;
+	double startTime = GetCurrentTimeSeconds();
+	meshBVH.Build(meshVerts, meshIndexes, &jobSystem);
+	double buildSeconds = GetCurrentTimeSeconds() - startTime;
+	jobSystem.Shutdown();
+
+	// The same triangles as a plain vertex list
+	std::vector<Vertex_PCUTBN> expandedVerts;
+	expandedVerts.reserve(meshIndexes.size());
+	for (unsigned int index : meshIndexes)
+	{
+		expandedVerts.push_back(meshVerts[index]);
+	}
+	MeshBVH expandedBVH;
+	expandedBVH.Build(expandedVerts);
+	ENGINE_TEST_CHECK(meshBVH.GetNumTriangles() == numTris, Stringf("Indexed build has %d triangles, expected %d", meshBVH.GetNumTriangles(), numTris));
+	ENGINE_TEST_CHECK(expandedBVH.GetNumTriangles() == numTris, Stringf("Vertex list build has %d triangles, expected %d", expandedBVH.GetNumTriangles(), numTris));
+	PrintEngineTestTiming(Stringf("Build %d triangles  %8.2fms", numTris, buildSeconds * 1000.0));
+
+	float gridExtent = static_cast<float>(MESH_BVH_TEST_GRID_SIZE);
+	std::vector<Vec3> rayStarts(MESH_BVH_TEST_NUM_RAYS);
+	std::vector<Vec3> rayFwdNormals(MESH_BVH_TEST_NUM_RAYS);
+	for (int rayIndex = 0; rayIndex < MESH_BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		rayStarts[rayIndex] = Vec3(rng.RollRandomFloatInRange(0.f, gridExtent), rng.RollRandomFloatInRange(0.f, gridExtent), rng.RollRandomFloatInRange(6.f, 20.f));
+		rayFwdNormals[rayIndex] = Vec3(rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, -0.1f)).GetNormalized();
+	}
+	float rayLength = gridExtent;
+
+	int numHits = 0;
+	std::vector<MeshRaycastResult3D> results(MESH_BVH_TEST_NUM_RAYS);
+	startTime = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < MESH_BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		results[rayIndex] = meshBVH.RaycastClosest(rayStarts[rayIndex], rayFwdNormals[rayIndex], rayLength);
+		numHits += results[rayIndex].m_didImpact ? 1 : 0;
+	}
+	double closestSeconds = (GetCurrentTimeSeconds() - startTime) / static_cast<double>(MESH_BVH_TEST_NUM_RAYS);
+
+	int numAnyHitMismatches = 0;
+	int numExpandedMismatches = 0;
+	int numBadBarycentrics = 0;
+	startTime = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < MESH_BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		numAnyHitMismatches += meshBVH.RaycastAny(rayStarts[rayIndex], rayFwdNormals[rayIndex], rayLength).m_didImpact == results[rayIndex].m_didImpact ? 0 : 1;
+	}
+	double anySeconds = (GetCurrentTimeSeconds() - startTime) / static_cast<double>(MESH_BVH_TEST_NUM_RAYS);
+
+	for (int rayIndex = 0; rayIndex < MESH_BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		MeshRaycastResult3D const& result = results[rayIndex];
+		numExpandedMismatches += AreMeshRaycastResultsEqual(result, expandedBVH.RaycastClosest(rayStarts[rayIndex], rayFwdNormals[rayIndex], rayLength)) ? 0 : 1;
+		if (result.m_didImpact)
+		{
+			// The barycentric weights of the hit triangle's corners land back on the impact position
+			Vec3 const& corner0 = meshVerts[meshIndexes[result.m_triangleIndex * 3 + 0]].m_position;
+			Vec3 const& corner1 = meshVerts[meshIndexes[result.m_triangleIndex * 3 + 1]].m_position;
+			Vec3 const& corner2 = meshVerts[meshIndexes[result.m_triangleIndex * 3 + 2]].m_position;
+			Vec3 const& weights = result.m_barycentricCoords;
+			Vec3 weightedPosition = corner0 * weights.x + corner1 * weights.y + corner2 * weights.z;
+			bool weightsAreValid = fabsf(weights.x + weights.y + weights.z - 1.f) < 0.001f && (weightedPosition - result.m_impactPos).GetLength() < 0.01f;
+			numBadBarycentrics += weightsAreValid ? 0 : 1;
+		}
+	}
+
+	// Brute force over every triangle, distances must match exactly
+	int numBruteForceMismatches = 0;
+	startTime = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < MESH_BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		RaycastResult3D nearestResult;
+		int nearestTriIndex = -1;
+		for (int triIndex = 0; triIndex < numTris; ++triIndex)
+		{
+			RaycastResult3D result = RaycastVsTriangle3D(rayStarts[rayIndex], rayFwdNormals[rayIndex], rayLength, meshVerts[meshIndexes[triIndex * 3 + 0]].m_position,
+				meshVerts[meshIndexes[triIndex * 3 + 1]].m_position, meshVerts[meshIndexes[triIndex * 3 + 2]].m_position);
+			if (result.m_didImpact && (nearestTriIndex < 0 || result.m_impactDist < nearestResult.m_impactDist))
+			{
+				nearestResult = result;
+				nearestTriIndex = triIndex;
+			}
+		}
+		if (nearestTriIndex != results[rayIndex].m_triangleIndex || (nearestTriIndex >= 0 && nearestResult.m_impactDist != results[rayIndex].m_impactDist))
+		{
+			++numBruteForceMismatches;
+		}
+	}
+	double bruteForceSeconds = (GetCurrentTimeSeconds() - startTime) / static_cast<double>(MESH_BVH_TEST_NUM_RAYS);
+
+	// Rays straight through shared grid vertexes, where non watertight tests let rays slip between triangles
+	int numGridVerts = MESH_BVH_TEST_GRID_SIZE + 1;
+	int numVertexRays = (numGridVerts - 2) * (numGridVerts - 2);
+	int numLeaks = 0;
+	for (int rayIndex = 0; rayIndex < numVertexRays; ++rayIndex)
+	{
+		int x = 1 + rayIndex % (numGridVerts - 2);
+		int y = 1 + rayIndex / (numGridVerts - 2);
+		Vec3 target = meshVerts[y * numGridVerts + x].m_position;
+		Vec3 rayStart = target + Vec3(0.37f, -0.61f, 9.f);
+		Vec3 fwdNormal = (target - rayStart).GetNormalized();
+		numLeaks += meshBVH.RaycastAny(rayStart, fwdNormal, 20.f).m_didImpact ? 0 : 1;
+	}
+
+	ENGINE_TEST_CHECK(numHits > MESH_BVH_TEST_NUM_RAYS / 2, Stringf("Only %d of %d rays hit the height field", numHits, MESH_BVH_TEST_NUM_RAYS));
+	ENGINE_TEST_CHECK(numBruteForceMismatches == 0, Stringf("RaycastClosest disagrees with brute force for %d of %d rays", numBruteForceMismatches, MESH_BVH_TEST_NUM_RAYS));
+	ENGINE_TEST_CHECK(numAnyHitMismatches == 0, Stringf("RaycastAny and RaycastClosest disagree on hitting for %d of %d rays", numAnyHitMismatches, MESH_BVH_TEST_NUM_RAYS));
+	ENGINE_TEST_CHECK(numExpandedMismatches == 0, Stringf("Indexed and vertex list builds disagree for %d of %d rays", numExpandedMismatches, MESH_BVH_TEST_NUM_RAYS));
+	ENGINE_TEST_CHECK(numBadBarycentrics == 0, Stringf("%d of %d hits have barycentric coords that miss the impact position", numBadBarycentrics, numHits));
+	ENGINE_TEST_CHECK(numLeaks == 0, Stringf("%d of %d rays through shared vertexes slipped between triangles", numLeaks, numVertexRays));
+	PrintEngineTestTiming(Stringf("Closest hit  %8.2fus per ray  brute force %8.2fus per ray  %7.1fx", closestSeconds * 1e6, bruteForceSeconds * 1e6,
+		closestSeconds > 0.0 ? bruteForceSeconds / closestSeconds : 0.0));
+	PrintEngineTestTiming(Stringf("Any hit      %8.2fus per ray", anySeconds * 1e6));
+}
+// -----------------------------------------------------------------------------
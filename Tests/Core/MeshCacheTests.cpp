@@ -0,0 +1,140 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/MeshCache.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int MESH_CACHE_TEST_NUM_VERTS = 20000;
+constexpr int MESH_CACHE_TEST_NUM_TRIS = 40000;
+// -----------------------------------------------------------------------------
+static bool WriteMeshCacheTestSource(std::string const& filePath, char fillByte)
+{
+	std::vector<uint8_t> fileBytes(4096, static_cast<uint8_t>(fillByte));
+	return WriteBufferToFile(fileBytes, filePath) == FILE_SUCCESS;
+}
+
+static bool DoesMeshCacheRead(std::string const& cacheFilePath, std::string const& sourceFilePath, MeshCacheValidation validation)
+{
+	std::vector<Vertex_PCUTBN> meshVerts;
+	std::vector<unsigned int> meshIndexes;
+	AABB3 bounds;
+	return ReadMeshCacheFile(meshVerts, meshIndexes, bounds, cacheFilePath.c_str(), sourceFilePath.c_str(), validation);
+}
+// -----------------------------------------------------------------------------
+// Everything written comes back bit identical, through both the copying read and the mapped view
+static void TestMeshCacheRoundTrip(std::string const& cacheFilePath, std::string const& sourceFilePath, std::vector<Vertex_PCUTBN> const& meshVerts,
+	std::vector<unsigned int> const& meshIndexes)
+{
+	double startTime = GetCurrentTimeSeconds();
+	bool didWrite = WriteMeshCacheFile(cacheFilePath.c_str(), meshVerts, meshIndexes, sourceFilePath.c_str());
+	double writeSeconds = GetCurrentTimeSeconds() - startTime;
+
+	std::vector<Vertex_PCUTBN> readVerts;
+	std::vector<unsigned int> readIndexes;
+	AABB3 readBounds;
+	startTime = GetCurrentTimeSeconds();
+	bool didRead = ReadMeshCacheFile(readVerts, readIndexes, readBounds, cacheFilePath.c_str(), sourceFilePath.c_str());
+	double readSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(didWrite && didRead, "Could not write and read back the mesh cache");
+
+	bool areVertsEqual = readVerts.size() == meshVerts.size() && memcmp(readVerts.data(), meshVerts.data(), meshVerts.size() * sizeof(Vertex_PCUTBN)) == 0;
+	bool areIndexesEqual = readIndexes == meshIndexes;
+	AABB3 expectedBounds = GetMeshBounds(meshVerts);
+	ENGINE_TEST_CHECK(areVertsEqual && areIndexesEqual, "Mesh cache vertexes or indexes differ from what was written");
+	ENGINE_TEST_CHECK(readBounds.m_mins == expectedBounds.m_mins && readBounds.m_maxs == expectedBounds.m_maxs, "Mesh cache bounds differ from the written mesh's bounds");
+
+	MeshCacheView cacheView;
+	bool didOpen = OpenMeshCacheView(cacheView, cacheFilePath.c_str(), sourceFilePath.c_str());
+	bool isViewValid = didOpen && cacheView.m_numVerts == meshVerts.size() && cacheView.m_numIndexes == meshIndexes.size() &&
+		(cacheView.m_header->m_flags & (MESH_CACHE_FLAG_INDEXED | MESH_CACHE_FLAG_HAS_TANGENTS)) == (MESH_CACHE_FLAG_INDEXED | MESH_CACHE_FLAG_HAS_TANGENTS) &&
+		memcmp(cacheView.m_verts, meshVerts.data(), meshVerts.size() * sizeof(Vertex_PCUTBN)) == 0 &&
+		memcmp(cacheView.m_indexes, meshIndexes.data(), meshIndexes.size() * sizeof(unsigned int)) == 0;
+	CloseMeshCacheView(cacheView);
+	ENGINE_TEST_CHECK(isViewValid, "The mapped mesh cache view differs from what was written, or is missing its flags");
+
+	PrintEngineTestTiming(Stringf("%d verts %d indexes  write %7.2fms  read %7.2fms", MESH_CACHE_TEST_NUM_VERTS, MESH_CACHE_TEST_NUM_TRIS * 3,
+		writeSeconds * 1000.0, readSeconds * 1000.0));
+}
+
+// A touched source fails the timestamp check but not the hash, changed contents fail both, and a missing source is trusted
+static void TestMeshCacheStaleness(std::string const& cacheFilePath, std::string const& sourceFilePath)
+{
+	ENGINE_TEST_CHECK(DoesMeshCacheRead(cacheFilePath, sourceFilePath, MeshCacheValidation::TIMESTAMP), "A fresh mesh cache failed the timestamp check");
+
+	std::error_code fileError;
+	std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(sourceFilePath, fileError);
+	std::filesystem::last_write_time(sourceFilePath, lastWriteTime + std::chrono::seconds(10), fileError);
+	ENGINE_TEST_CHECK(!fileError, "Could not touch the mesh cache test source");
+	ENGINE_TEST_CHECK(!DoesMeshCacheRead(cacheFilePath, sourceFilePath, MeshCacheValidation::TIMESTAMP), "A mesh cache older than its source passed the timestamp check");
+	ENGINE_TEST_CHECK(DoesMeshCacheRead(cacheFilePath, sourceFilePath, MeshCacheValidation::HASH), "A touched but unchanged source failed the hash check");
+	ENGINE_TEST_CHECK(DoesMeshCacheRead(cacheFilePath, sourceFilePath, MeshCacheValidation::NONE), "A mesh cache with no validation was rejected");
+
+	WriteMeshCacheTestSource(sourceFilePath, 'b');
+	ENGINE_TEST_CHECK(!DoesMeshCacheRead(cacheFilePath, sourceFilePath, MeshCacheValidation::HASH), "A mesh cache passed the hash check after its source changed");
+
+	std::filesystem::remove(sourceFilePath, fileError);
+	ENGINE_TEST_CHECK(DoesMeshCacheRead(cacheFilePath, sourceFilePath, MeshCacheValidation::TIMESTAMP), "A mesh cache was rejected with its source missing, which it should trust");
+}
+
+// Sections that run past the end of the file, and indexes past the last vertex, are both rejected
+static void TestMeshCacheCorruption(std::string const& cacheFilePath, std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes)
+{
+	std::vector<unsigned int> badIndexes = meshIndexes;
+	badIndexes[badIndexes.size() / 2] = static_cast<unsigned int>(meshVerts.size());
+	WriteMeshCacheFile(cacheFilePath.c_str(), meshVerts, badIndexes);
+	std::vector<Vertex_PCUTBN> readVerts;
+	std::vector<unsigned int> readIndexes;
+	AABB3 readBounds;
+	bool didRead = ReadMeshCacheFile(readVerts, readIndexes, readBounds, cacheFilePath.c_str());
+	ENGINE_TEST_CHECK(!didRead && readVerts.empty() && readIndexes.empty(), "A mesh cache with an index past the last vertex was read, or left data behind");
+
+	WriteMeshCacheFile(cacheFilePath.c_str(), meshVerts, meshIndexes);
+	std::vector<uint8_t> fileBytes;
+	FileReadToBuffer(fileBytes, cacheFilePath);
+	fileBytes.resize(fileBytes.size() - sizeof(unsigned int));
+	WriteBufferToFile(fileBytes, cacheFilePath);
+	didRead = ReadMeshCacheFile(readVerts, readIndexes, readBounds, cacheFilePath.c_str());
+	ENGINE_TEST_CHECK(!didRead, "A truncated mesh cache was read");
+}
+// -----------------------------------------------------------------------------
+void RunMeshCacheTests()
+{
+	BeginEngineTestSection("Mesh cache");
+
+	RandomNumberGenerator rng(28);
+	std::vector<Vertex_PCUTBN> meshVerts(MESH_CACHE_TEST_NUM_VERTS);
+	for (Vertex_PCUTBN& vert : meshVerts)
+	{
+		vert.m_position = Vec3(rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f));
+		vert.m_uvTexCoords = Vec2(rng.RollRandomFloatZeroToOne(), rng.RollRandomFloatZeroToOne());
+		vert.m_normal = Vec3(rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f), 1.f).GetNormalized();
+	}
+	std::vector<unsigned int> meshIndexes(MESH_CACHE_TEST_NUM_TRIS * 3);
+	for (unsigned int& index : meshIndexes)
+	{
+		index = static_cast<unsigned int>(rng.RollRandomIntInRange(0, MESH_CACHE_TEST_NUM_VERTS - 1));
+	}
+
+	std::string sourceFilePath = (std::filesystem::temp_directory_path() / "EngineTests_MeshCacheSource.obj").string();
+	std::string cacheFilePath = GetMeshCacheFilePath(sourceFilePath.c_str());
+	if (!ENGINE_TEST_CHECK(WriteMeshCacheTestSource(sourceFilePath, 'a'), Stringf("Could not write \"%s\"", sourceFilePath.c_str())))
+	{
+		return;
+	}
+
+	TestMeshCacheRoundTrip(cacheFilePath, sourceFilePath, meshVerts, meshIndexes);
+	TestMeshCacheStaleness(cacheFilePath, sourceFilePath);
+	TestMeshCacheCorruption(cacheFilePath, meshVerts, meshIndexes);
+
+	for (std::string const& filePath : { sourceFilePath, cacheFilePath })
+	{
+		std::error_code removeError;
+		std::filesystem::remove(filePath, removeError);
+	}
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,126 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/MeshOptimizer.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int MESH_OPTIMIZER_TEST_GRID_SIZE = 128;		// Quads per side, two triangles each
+constexpr int MESH_OPTIMIZER_TEST_NUM_UNUSED_VERTS = 7;
+// -----------------------------------------------------------------------------
+typedef std::array<float, 9> MeshOptimizerTestTriangle;
+// -----------------------------------------------------------------------------
+// Corner positions starting from the smallest corner, winding kept, so the same triangle compares equal after any reorder
+static void GetTriangleSet(std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes, std::vector<MeshOptimizerTestTriangle>& out_triangles)
+{
+	out_triangles.clear();
+	for (int firstCorner = 0; firstCorner + 2 < static_cast<int>(meshIndexes.size()); firstCorner += 3)
+	{
+		Vec3 const corners[3] = { meshVerts[meshIndexes[firstCorner]].m_position, meshVerts[meshIndexes[firstCorner + 1]].m_position, meshVerts[meshIndexes[firstCorner + 2]].m_position };
+		int firstCornerIndex = 0;
+		for (int cornerIndex = 1; cornerIndex < 3; ++cornerIndex)
+		{
+			Vec3 const& corner = corners[cornerIndex];
+			Vec3 const& first = corners[firstCornerIndex];
+			if (corner.x < first.x || (corner.x == first.x && corner.y < first.y))
+			{
+				firstCornerIndex = cornerIndex;
+			}
+		}
+
+		MeshOptimizerTestTriangle triangle;
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			Vec3 const& corner = corners[(firstCornerIndex + cornerIndex) % 3];
+			triangle[cornerIndex * 3 + 0] = corner.x;
+			triangle[cornerIndex * 3 + 1] = corner.y;
+			triangle[cornerIndex * 3 + 2] = corner.z;
+		}
+		out_triangles.push_back(triangle);
+	}
+	std::sort(out_triangles.begin(), out_triangles.end());
+}
+// -----------------------------------------------------------------------------
+void RunMeshOptimizerTests()
+{
+	BeginEngineTestSection("Mesh optimizer");
+
+	// A grid with its triangles and vertexes shuffled, about the worst order for the vertex cache, plus vertexes nothing uses
+	RandomNumberGenerator rng(29);
+	int numGridVerts = MESH_OPTIMIZER_TEST_GRID_SIZE + 1;
+	std::vector<Vertex_PCUTBN> meshVerts(numGridVerts * numGridVerts + MESH_OPTIMIZER_TEST_NUM_UNUSED_VERTS);
+	std::vector<unsigned int> shuffledVertIndexes(meshVerts.size());
+	for (int vertIndex = 0; vertIndex < static_cast<int>(meshVerts.size()); ++vertIndex)
+	{
+		shuffledVertIndexes[vertIndex] = static_cast<unsigned int>(vertIndex);
+	}
+	for (int vertIndex = static_cast<int>(meshVerts.size()) - 1; vertIndex > 0; --vertIndex)
+	{
+		std::swap(shuffledVertIndexes[vertIndex], shuffledVertIndexes[rng.RollRandomIntInRange(0, vertIndex)]);
+	}
+	for (int vertIndex = 0; vertIndex < static_cast<int>(meshVerts.size()); ++vertIndex)
+	{
+		float x = static_cast<float>(vertIndex % numGridVerts);
+		float y = static_cast<float>(vertIndex / numGridVerts);
+		meshVerts[shuffledVertIndexes[vertIndex]].m_position = Vec3(x, y, 0.25f * static_cast<float>((vertIndex * 7) % 5));
+	}
+
+	std::vector<std::array<unsigned int, 3>> triangles;
+	for (int quadY = 0; quadY < MESH_OPTIMIZER_TEST_GRID_SIZE; ++quadY)
+	{
+		for (int quadX = 0; quadX < MESH_OPTIMIZER_TEST_GRID_SIZE; ++quadX)
+		{
+			unsigned int bottomLeft = shuffledVertIndexes[quadY * numGridVerts + quadX];
+			unsigned int bottomRight = shuffledVertIndexes[quadY * numGridVerts + quadX + 1];
+			unsigned int topLeft = shuffledVertIndexes[(quadY + 1) * numGridVerts + quadX];
+			unsigned int topRight = shuffledVertIndexes[(quadY + 1) * numGridVerts + quadX + 1];
+			triangles.push_back({ bottomLeft, bottomRight, topRight });
+			triangles.push_back({ bottomLeft, topRight, topLeft });
+		}
+	}
+	for (int triIndex = static_cast<int>(triangles.size()) - 1; triIndex > 0; --triIndex)
+	{
+		std::swap(triangles[triIndex], triangles[rng.RollRandomIntInRange(0, triIndex)]);
+	}
+	std::vector<unsigned int> meshIndexes;
+	for (std::array<unsigned int, 3> const& triangle : triangles)
+	{
+		meshIndexes.insert(meshIndexes.end(), triangle.begin(), triangle.end());
+	}
+
+	std::vector<MeshOptimizerTestTriangle> trianglesBefore;
+	GetTriangleSet(meshVerts, meshIndexes, trianglesBefore);
+	MeshVertexCacheStats statsBefore = AnalyzeMeshVertexCache(meshIndexes, static_cast<int>(meshVerts.size()));
+
+	double startTime = GetCurrentTimeSeconds();
+	OptimizeMesh(meshVerts, meshIndexes);
+	double optimizeSeconds = GetCurrentTimeSeconds() - startTime;
+
+	std::vector<MeshOptimizerTestTriangle> trianglesAfter;
+	GetTriangleSet(meshVerts, meshIndexes, trianglesAfter);
+	MeshVertexCacheStats statsAfter = AnalyzeMeshVertexCache(meshIndexes, static_cast<int>(meshVerts.size()));
+	ENGINE_TEST_CHECK(trianglesAfter == trianglesBefore, "OptimizeMesh changed the set of triangles, or their winding");
+	ENGINE_TEST_CHECK(statsAfter.m_acmr < statsBefore.m_acmr * 0.5f, Stringf("OptimizeMesh only took ACMR from %.3f to %.3f", statsBefore.m_acmr, statsAfter.m_acmr));
+
+	// Vertex fetch order is first use order, with the unused vertexes dropped
+	int numUsedVerts = numGridVerts * numGridVerts;
+	unsigned int nextNewVertIndex = 0;
+	int numOutOfOrderIndexes = 0;
+	for (unsigned int index : meshIndexes)
+	{
+		if (index >= nextNewVertIndex)
+		{
+			numOutOfOrderIndexes += index == nextNewVertIndex ? 0 : 1;
+			++nextNewVertIndex;
+		}
+	}
+	ENGINE_TEST_CHECK(static_cast<int>(meshVerts.size()) == numUsedVerts, Stringf("OptimizeMesh left %d vertexes, expected the %d the triangles use",
+		static_cast<int>(meshVerts.size()), numUsedVerts));
+	ENGINE_TEST_CHECK(numOutOfOrderIndexes == 0, Stringf("%d vertexes are not in first use order after OptimizeMesh", numOutOfOrderIndexes));
+
+	PrintEngineTestTiming(Stringf("%d triangles  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f  %7.2fms", statsAfter.m_numTriangles, statsBefore.m_acmr, statsAfter.m_acmr,
+		statsBefore.m_atvr, statsAfter.m_atvr, optimizeSeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,234 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/MeshSimplifier.hpp"
+#include "Engine/Core/MeshUtils.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Renderer/Camera.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int	MESH_SIMPLIFIER_TEST_GRID_SIZE = 32;	// Quads per side of the open grid, with the uv seam down the middle
+constexpr float MESH_SIMPLIFIER_TEST_BUMP_HEIGHT = 0.2f;
+// -----------------------------------------------------------------------------
+// Half edges in position space with no opposite half edge, so any hole or tear shows up here
+static int CountOpenEdges(std::vector<Vertex_PCUTBN> const& meshVerts, std::vector<unsigned int> const& meshIndexes, std::vector<Vec3>& out_edgeMidpoints)
+{
+	std::vector<int> groupForVert;
+	WeldMeshVertexes(meshVerts, false, groupForVert);
+
+	out_edgeMidpoints.clear();
+	int numCorners = static_cast<int>(meshIndexes.size());
+	for (int cornerIndex = 0; cornerIndex < numCorners; ++cornerIndex)
+	{
+		int fromGroup = groupForVert[meshIndexes[cornerIndex]];
+		int toGroup = groupForVert[meshIndexes[(cornerIndex % 3 == 2) ? cornerIndex - 2 : cornerIndex + 1]];
+		bool hasOpposite = false;
+		for (int otherCorner = 0; otherCorner < numCorners && !hasOpposite; ++otherCorner)
+		{
+			hasOpposite = groupForVert[meshIndexes[otherCorner]] == toGroup && groupForVert[meshIndexes[(otherCorner % 3 == 2) ? otherCorner - 2 : otherCorner + 1]] == fromGroup;
+		}
+		if (!hasOpposite)
+		{
+			Vec3 const& edgeStart = meshVerts[meshIndexes[cornerIndex]].m_position;
+			Vec3 const& edgeEnd = meshVerts[meshIndexes[(cornerIndex % 3 == 2) ? cornerIndex - 2 : cornerIndex + 1]].m_position;
+			out_edgeMidpoints.push_back((edgeStart + edgeEnd) * 0.5f);
+		}
+	}
+	return static_cast<int>(out_edgeMidpoints.size());
+}
+
+// Latitude longitude sphere with every position shared, so it is closed and has no seams
+static void AddTestSphere(std::vector<Vertex_PCUTBN>& meshVerts, std::vector<unsigned int>& meshIndexes, int numSlices, int numStacks)
+{
+	Vertex_PCUTBN vert;
+	vert.m_position = Vec3(0.f, 0.f, 1.f);
+	vert.m_normal = vert.m_position;
+	meshVerts.push_back(vert);
+	for (int ringIndex = 1; ringIndex < numStacks; ++ringIndex)
+	{
+		for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+		{
+			float pitchDegrees = 180.f * static_cast<float>(ringIndex) / static_cast<float>(numStacks) - 90.f;
+			float yawDegrees = 360.f * static_cast<float>(sliceIndex) / static_cast<float>(numSlices);
+			vert.m_position = Vec3::MakeFromPolarDegrees(pitchDegrees, yawDegrees, 1.f);
+			vert.m_normal = vert.m_position;
+			meshVerts.push_back(vert);
+		}
+	}
+	vert.m_position = Vec3(0.f, 0.f, -1.f);
+	vert.m_normal = vert.m_position;
+	meshVerts.push_back(vert);
+
+	unsigned int bottomPole = static_cast<unsigned int>(meshVerts.size() - 1);
+	auto getRingVert = [numSlices](int ringIndex, int sliceIndex)
+	{
+		return static_cast<unsigned int>(1 + (ringIndex - 1) * numSlices + sliceIndex % numSlices);
+	};
+	for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+	{
+		meshIndexes.insert(meshIndexes.end(), { 0, getRingVert(1, sliceIndex + 1), getRingVert(1, sliceIndex) });
+		for (int ringIndex = 1; ringIndex + 1 < numStacks; ++ringIndex)
+		{
+			unsigned int topLeft = getRingVert(ringIndex, sliceIndex);
+			unsigned int topRight = getRingVert(ringIndex, sliceIndex + 1);
+			unsigned int bottomLeft = getRingVert(ringIndex + 1, sliceIndex);
+			unsigned int bottomRight = getRingVert(ringIndex + 1, sliceIndex + 1);
+			meshIndexes.insert(meshIndexes.end(), { topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft });
+		}
+		meshIndexes.insert(meshIndexes.end(), { getRingVert(numStacks - 1, sliceIndex), getRingVert(numStacks - 1, sliceIndex + 1), bottomPole });
+	}
+}
+
+static void TestSimplifyClosedMesh()
+{
+	std::vector<Vertex_PCUTBN> meshVerts;
+	std::vector<unsigned int> meshIndexes;
+	AddTestSphere(meshVerts, meshIndexes, 48, 24);
+
+	std::vector<Vec3> openEdgeMidpoints;
+	int numOpenEdgesBefore = CountOpenEdges(meshVerts, meshIndexes, openEdgeMidpoints);
+	ENGINE_TEST_CHECK(numOpenEdgesBefore == 0, Stringf("The test sphere has %d open edges before simplifying", numOpenEdgesBefore));
+
+	int targetIndexCount = static_cast<int>(meshIndexes.size() / 3 / 4) * 3;
+	float resultError = -1.f;
+	std::vector<unsigned int> simplifiedIndexes = SimplifyMesh(meshVerts, meshIndexes, targetIndexCount, 1.f, &resultError);
+	ENGINE_TEST_CHECK(!simplifiedIndexes.empty() && static_cast<int>(simplifiedIndexes.size()) <= targetIndexCount,
+		Stringf("SimplifyMesh stopped at %d indexes on a closed sphere, the target was %d", static_cast<int>(simplifiedIndexes.size()), targetIndexCount));
+
+	int numOpenEdgesAfter = CountOpenEdges(meshVerts, simplifiedIndexes, openEdgeMidpoints);
+	ENGINE_TEST_CHECK(numOpenEdgesAfter == 0, Stringf("SimplifyMesh opened %d edges in a closed sphere", numOpenEdgesAfter));
+
+	// A quarter of the triangles still hugs a unit sphere, so the measured deviation is small but not zero
+	ENGINE_TEST_CHECK(resultError > 0.f && resultError < 0.1f, Stringf("SimplifyMesh measured %.4f deviation on the sphere", resultError));
+}
+
+static void TestSimplifyOpenGridWithSeam()
+{
+	// Two halves of a bumpy grid share the positions down x = half but not their uvs, so the middle column is a uv seam
+	RandomNumberGenerator rng(30);
+	int numGridVerts = MESH_SIMPLIFIER_TEST_GRID_SIZE + 1;
+	int halfGridSize = MESH_SIMPLIFIER_TEST_GRID_SIZE / 2;
+	std::vector<float> heights(numGridVerts * numGridVerts);
+	for (float& height : heights)
+	{
+		height = rng.RollRandomFloatInRange(0.f, MESH_SIMPLIFIER_TEST_BUMP_HEIGHT);
+	}
+
+	std::vector<Vertex_PCUTBN> meshVerts;
+	std::vector<unsigned int> meshIndexes;
+	int numHalfColumns = halfGridSize + 1;
+	for (int half = 0; half < 2; ++half)
+	{
+		unsigned int firstVert = static_cast<unsigned int>(meshVerts.size());
+		for (int y = 0; y < numGridVerts; ++y)
+		{
+			for (int column = 0; column < numHalfColumns; ++column)
+			{
+				int x = half * halfGridSize + column;
+				Vertex_PCUTBN vert;
+				vert.m_position = Vec3(static_cast<float>(x), static_cast<float>(y), heights[y * numGridVerts + x]);
+				vert.m_uvTexCoords = Vec2(static_cast<float>(half) + static_cast<float>(column) / static_cast<float>(halfGridSize), static_cast<float>(y));
+				meshVerts.push_back(vert);
+			}
+		}
+		for (int y = 0; y < MESH_SIMPLIFIER_TEST_GRID_SIZE; ++y)
+		{
+			for (int column = 0; column < halfGridSize; ++column)
+			{
+				unsigned int bottomLeft = firstVert + static_cast<unsigned int>(y * numHalfColumns + column);
+				unsigned int topLeft = bottomLeft + static_cast<unsigned int>(numHalfColumns);
+				meshIndexes.insert(meshIndexes.end(), { bottomLeft, bottomLeft + 1, topLeft + 1, bottomLeft, topLeft + 1, topLeft });
+			}
+		}
+	}
+	unsigned int numLeftVerts = static_cast<unsigned int>(meshVerts.size() / 2);
+
+	int targetIndexCount = static_cast<int>(meshIndexes.size() / 3 / 4) * 3;
+	std::vector<unsigned int> simplifiedIndexes = SimplifyMesh(meshVerts, meshIndexes, targetIndexCount, 1.f);
+	ENGINE_TEST_CHECK(!simplifiedIndexes.empty() && static_cast<int>(simplifiedIndexes.size()) <= targetIndexCount,
+		Stringf("SimplifyMesh stopped at %d indexes on the open grid, the target was %d", static_cast<int>(simplifiedIndexes.size()), targetIndexCount));
+
+	// The outline only ever collapses along itself, so the projected area is still the full square
+	float projectedArea = 0.f;
+	for (int cornerIndex = 0; cornerIndex + 2 < static_cast<int>(simplifiedIndexes.size()); cornerIndex += 3)
+	{
+		Vec3 const& p0 = meshVerts[simplifiedIndexes[cornerIndex]].m_position;
+		Vec3 const& p1 = meshVerts[simplifiedIndexes[cornerIndex + 1]].m_position;
+		Vec3 const& p2 = meshVerts[simplifiedIndexes[cornerIndex + 2]].m_position;
+		projectedArea += 0.5f * ((p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y));
+	}
+	float gridArea = static_cast<float>(MESH_SIMPLIFIER_TEST_GRID_SIZE * MESH_SIMPLIFIER_TEST_GRID_SIZE);
+	ENGINE_TEST_CHECK(fabsf(projectedArea - gridArea) < 0.01f, Stringf("The simplified grid covers %.3f square units, expected %.3f", projectedArea, gridArea));
+
+	// Open edges may only lie on the outer border, one along the seam means it tore
+	std::vector<Vec3> openEdgeMidpoints;
+	CountOpenEdges(meshVerts, simplifiedIndexes, openEdgeMidpoints);
+	int numInteriorOpenEdges = 0;
+	float gridMax = static_cast<float>(MESH_SIMPLIFIER_TEST_GRID_SIZE);
+	for (Vec3 const& midpoint : openEdgeMidpoints)
+	{
+		bool isOnBorder = midpoint.x == 0.f || midpoint.y == 0.f || midpoint.x == gridMax || midpoint.y == gridMax;
+		numInteriorOpenEdges += isOnBorder ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numInteriorOpenEdges == 0, Stringf("SimplifyMesh left %d open edges inside the grid", numInteriorOpenEdges));
+
+	// Each triangle keeps drawing from one side of the seam, or its uvs would smear across it
+	int numMixedTriangles = 0;
+	for (int cornerIndex = 0; cornerIndex + 2 < static_cast<int>(simplifiedIndexes.size()); cornerIndex += 3)
+	{
+		bool isLeft0 = simplifiedIndexes[cornerIndex] < numLeftVerts;
+		bool isLeft1 = simplifiedIndexes[cornerIndex + 1] < numLeftVerts;
+		bool isLeft2 = simplifiedIndexes[cornerIndex + 2] < numLeftVerts;
+		numMixedTriangles += (isLeft0 == isLeft1 && isLeft1 == isLeft2) ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numMixedTriangles == 0, Stringf("%d simplified triangles mix vertexes from both sides of the uv seam", numMixedTriangles));
+}
+
+static void TestSelectMeshLOD()
+{
+	std::vector<Vertex_PCUTBN> meshVerts;
+	std::vector<unsigned int> meshIndexes;
+	AddTestSphere(meshVerts, meshIndexes, 64, 32);
+
+	MeshLODChain chain;
+	GenerateMeshLODs(chain, meshVerts, meshIndexes, 4, 0.5f, 0.2f);
+	int numLODs = static_cast<int>(chain.m_lods.size());
+	ENGINE_TEST_CHECK(numLODs == 4, Stringf("GenerateMeshLODs made %d levels of a sphere, expected 4", numLODs));
+
+	bool areErrorsOrdered = true;
+	for (int lodIndex = 1; lodIndex < numLODs; ++lodIndex)
+	{
+		areErrorsOrdered = areErrorsOrdered && chain.m_lods[lodIndex].m_indexes.size() < chain.m_lods[lodIndex - 1].m_indexes.size() &&
+			chain.m_lods[lodIndex].m_error >= chain.m_lods[lodIndex - 1].m_error;
+	}
+	ENGINE_TEST_CHECK(areErrorsOrdered, "Later LOD levels should have fewer triangles and no less error");
+	for (int lodIndex = 0; lodIndex < numLODs; ++lodIndex)
+	{
+		PrintEngineTestTiming(Stringf("LOD %d  %5d triangles  error %.4f", lodIndex, static_cast<int>(chain.m_lods[lodIndex].m_indexes.size() / 3), chain.m_lods[lodIndex].m_error));
+	}
+
+	Camera camera;
+	camera.SetPerspectiveView(16.f / 9.f, 60.f, 0.1f, 10000.f);
+	camera.SetCameraToRenderTransform(Mat44(Vec3(0.f, 0.f, 1.f), Vec3(-1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3::ZERO));
+
+	int previousLOD = 0;
+	bool isSelectionMonotonic = true;
+	for (float distance = 2.f; distance < 5000.f; distance *= 2.f)
+	{
+		int selectedLOD = SelectMeshLOD(chain, camera, Mat44::MakeTranslation3D(Vec3(distance, 0.f, 0.f)));
+		isSelectionMonotonic = isSelectionMonotonic && selectedLOD >= previousLOD;
+		previousLOD = selectedLOD;
+	}
+	int nearLOD = SelectMeshLOD(chain, camera, Mat44::MakeTranslation3D(Vec3(2.f, 0.f, 0.f)));
+	ENGINE_TEST_CHECK(nearLOD == 0, Stringf("SelectMeshLOD picked level %d for a sphere filling the screen", nearLOD));
+	ENGINE_TEST_CHECK(isSelectionMonotonic, "SelectMeshLOD picked a finer level for a farther sphere");
+	ENGINE_TEST_CHECK(previousLOD == numLODs - 1, Stringf("SelectMeshLOD picked level %d for a sphere a few pixels tall", previousLOD));
+}
+// -----------------------------------------------------------------------------
+void RunMeshSimplifierTests()
+{
+	BeginEngineTestSection("Mesh simplifier");
+	TestSimplifyClosedMesh();
+	TestSimplifyOpenGridWithSeam();
+	TestSelectMeshLOD();
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,86 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/MeshUtils.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/MathUtils.h"
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+static bool IsNearlyEqualVec3(Vec3 const& vecA, Vec3 const& vecB, float tolerance = 1e-5f)
+{
+	return (vecA - vecB).GetLength() <= tolerance;
+}
+
+static Vertex_PCUTBN MakeMeshTestVertex(Vec3 const& position, Vec2 const& uv = Vec2::ZERO, Vec3 const& normal = Vec3::ZERO)
+{
+	return Vertex_PCUTBN(position, Rgba8::WHITE, uv, Vec3::ZERO, Vec3::ZERO, normal);
+}
+// -----------------------------------------------------------------------------
+// Three faces meeting at the origin with normals +x, +y and +z, the +z face split into two 45 degree triangles.
+// Weighting by angle gives each face the same say, counting or weighting by area would lean towards +z.
+static void TestAngleWeightedNormals()
+{
+	std::vector<Vertex_PCUTBN> meshVerts = { MakeMeshTestVertex(Vec3(0.f, 0.f, 0.f)), MakeMeshTestVertex(Vec3(1.f, 0.f, 0.f)), MakeMeshTestVertex(Vec3(1.f, 1.f, 0.f)),
+		MakeMeshTestVertex(Vec3(0.f, 1.f, 0.f)), MakeMeshTestVertex(Vec3(0.f, 0.f, 1.f)) };
+	std::vector<unsigned int> const meshIndexes = { 0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 1 };
+	ComputeMeshNormals(meshVerts, meshIndexes, MeshNormalMode::SMOOTH);
+
+	Vec3 expectedNormal = Vec3(1.f, 1.f, 1.f).GetNormalized();
+	Vec3 const& cornerNormal = meshVerts[0].m_normal;
+	ENGINE_TEST_CHECK(IsNearlyEqualVec3(cornerNormal, expectedNormal), Stringf("Normal where three faces meet is (%.4f, %.4f, %.4f), expected (%.4f, %.4f, %.4f)",
+		cornerNormal.x, cornerNormal.y, cornerNormal.z, expectedNormal.x, expectedNormal.y, expectedNormal.z));
+	ENGINE_TEST_CHECK(IsNearlyEqualVec3(meshVerts[2].m_normal, Vec3(0.f, 0.f, 1.f)), "A vertex used only by the +z face does not get the +z face normal");
+
+	// Normals already set are kept when only missing ones are asked for
+	Vec3 presetNormal = Vec3(0.f, -1.f, 0.f);
+	meshVerts[0].m_normal = presetNormal;
+	meshVerts[2].m_normal = Vec3::ZERO;
+	ComputeMeshNormals(meshVerts, meshIndexes, MeshNormalMode::SMOOTH, true);
+	ENGINE_TEST_CHECK(meshVerts[0].m_normal == presetNormal && IsNearlyEqualVec3(meshVerts[2].m_normal, Vec3(0.f, 0.f, 1.f)),
+		"Computing only missing normals changed a normal that was set, or left a missing one zero");
+}
+
+// Two quads side by side in the xy plane. The right quad's uvs mirror the left's, so the two vertexes on the shared
+// edge are used with both handednesses and have to be split, while continuous uvs split nothing.
+static void TestTangentSeamSplitting()
+{
+	Vec3 const up(0.f, 0.f, 1.f);
+	std::vector<unsigned int> const quadIndexes = { 0, 1, 4, 0, 4, 3, 1, 2, 5, 1, 5, 4 };
+	for (int caseIndex = 0; caseIndex < 2; ++caseIndex)
+	{
+		bool isMirrored = caseIndex == 1;
+		float rightU = isMirrored ? 0.f : 2.f;
+		std::vector<Vertex_PCUTBN> meshVerts = { MakeMeshTestVertex(Vec3(0.f, 0.f, 0.f), Vec2(0.f, 0.f), up), MakeMeshTestVertex(Vec3(1.f, 0.f, 0.f), Vec2(1.f, 0.f), up),
+			MakeMeshTestVertex(Vec3(2.f, 0.f, 0.f), Vec2(rightU, 0.f), up), MakeMeshTestVertex(Vec3(0.f, 1.f, 0.f), Vec2(0.f, 1.f), up),
+			MakeMeshTestVertex(Vec3(1.f, 1.f, 0.f), Vec2(1.f, 1.f), up), MakeMeshTestVertex(Vec3(2.f, 1.f, 0.f), Vec2(rightU, 1.f), up) };
+		std::vector<unsigned int> meshIndexes = quadIndexes;
+		ComputeMeshTangents(meshVerts, meshIndexes);
+
+		int expectedNumVerts = isMirrored ? 8 : 6;
+		ENGINE_TEST_CHECK(static_cast<int>(meshVerts.size()) == expectedNumVerts, Stringf("%s uvs left %d vertexes, expected %d", isMirrored ? "Mirrored" : "Continuous",
+			static_cast<int>(meshVerts.size()), expectedNumVerts));
+
+		// Every corner's tangent follows +u across its own triangle, and the bitangent follows +v with the sign the shader rebuilds
+		int numBadCorners = 0;
+		for (int cornerIndex = 0; cornerIndex < static_cast<int>(meshIndexes.size()); ++cornerIndex)
+		{
+			bool isRightQuad = cornerIndex >= 6;
+			Vec3 expectedTangent = (isMirrored && isRightQuad) ? Vec3(-1.f, 0.f, 0.f) : Vec3(1.f, 0.f, 0.f);
+			Vertex_PCUTBN const& vert = meshVerts[meshIndexes[cornerIndex]];
+			Vec3 rebuiltBitangent = CrossProduct3D(vert.m_normal, vert.m_tangent) * ((isMirrored && isRightQuad) ? -1.f : 1.f);
+			bool isCornerValid = IsNearlyEqualVec3(vert.m_tangent, expectedTangent) && IsNearlyEqualVec3(vert.m_bitangent, Vec3(0.f, 1.f, 0.f)) &&
+				IsNearlyEqualVec3(vert.m_bitangent, rebuiltBitangent) && vert.m_position == meshVerts[quadIndexes[cornerIndex]].m_position;
+			numBadCorners += isCornerValid ? 0 : 1;
+		}
+		ENGINE_TEST_CHECK(numBadCorners == 0, Stringf("%d of %d corners with %s uvs have the wrong tangent basis or moved", numBadCorners,
+			static_cast<int>(meshIndexes.size()), isMirrored ? "mirrored" : "continuous"));
+	}
+}
+// -----------------------------------------------------------------------------
+void RunMeshUtilsTests()
+{
+	BeginEngineTestSection("Mesh normals and tangents");
+
+	TestAngleWeightedNormals();
+	TestTangentSeamSplitting();
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,217 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/OBJLoader.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/MeshCache.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Unit cube of quads, every position shared by three faces with their own uv and normal, so 24 unique corners
+char const* const OBJ_TEST_CUBE_TEXT =
+	"# Engine test cube\n"
+	"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 0 1\nv 1 0 1\nv 1 1 1\nv 0 1 1\n"
+	"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+	"vn 0 0 -1\nvn 0 0 1\nvn 0 -1 0\nvn 1 0 0\nvn 0 1 0\nvn -1 0 0\n"
+	"f 1/1/1 4/2/1 3/3/1 2/4/1\n"
+	"f 5/1/2 6/2/2 7/3/2 8/4/2\n"
+	"f 1/1/3 2/2/3 6/3/3 5/4/3\n"
+	"f 2/1/4 3/2/4 7/3/4 6/4/4\n"
+	"f 3/1/5 4/2/5 8/3/5 7/4/5\n"
+	"f 4/1/6 1/2/6 5/3/6 8/4/6\n";
+constexpr int OBJ_TEST_CUBE_NUM_CORNERS = 24;
+constexpr int OBJ_TEST_CUBE_NUM_TRIS = 12;
+
+// One quad above the cube in v//vn form, for loading a second mesh into the same arrays
+char const* const OBJ_TEST_QUAD_TEXT =
+	"v 0 0 2\nv 1 0 2\nv 0 1 2\nv 1 1 2\n"
+	"vn 0 0 1\n"
+	"f 1//1 2//1 4//1 3//1\n";
+constexpr int OBJ_TEST_QUAD_NUM_TRIS = 2;
+// -----------------------------------------------------------------------------
+static bool WriteTestOBJFile(std::string const& filePath, char const* objText)
+{
+	std::string text(objText);
+	std::vector<uint8_t> fileBytes(text.begin(), text.end());
+	return WriteBufferToFile(fileBytes, filePath) == FILE_SUCCESS;
+}
+
+static bool AreOBJCornersEqual(Vertex_PCUTBN const& vertA, Vertex_PCUTBN const& vertB)
+{
+	return vertA.m_position == vertB.m_position && vertA.m_uvTexCoords == vertB.m_uvTexCoords && vertA.m_normal == vertB.m_normal;
+}
+// -----------------------------------------------------------------------------
+// Every unique v/vt/vn corner becomes one vertex, and the indexed triangles are the de-indexed ones corner for corner
+static void TestOBJCornerDedup(std::string const& cubeFilePath)
+{
+	std::vector<Vertex_PCUTBN> indexedVerts;
+	std::vector<unsigned int> indexes;
+	std::vector<Vertex_PCUTBN> triangleVerts;
+	bool didParseIndexed = ParseOBJMeshFile(indexedVerts, indexes, cubeFilePath.c_str());
+	bool didParse = ParseOBJMeshFile(triangleVerts, cubeFilePath.c_str());
+	ENGINE_TEST_CHECK(didParseIndexed && didParse, "Could not parse the test cube");
+	ENGINE_TEST_CHECK(static_cast<int>(indexedVerts.size()) == OBJ_TEST_CUBE_NUM_CORNERS, Stringf("Indexed cube has %d vertexes, expected one per unique corner, %d",
+		static_cast<int>(indexedVerts.size()), OBJ_TEST_CUBE_NUM_CORNERS));
+	ENGINE_TEST_CHECK(static_cast<int>(indexes.size()) == OBJ_TEST_CUBE_NUM_TRIS * 3 && static_cast<int>(triangleVerts.size()) == OBJ_TEST_CUBE_NUM_TRIS * 3,
+		Stringf("Quads fan into %d indexes and %d vertexes, expected %d of each", static_cast<int>(indexes.size()), static_cast<int>(triangleVerts.size()), OBJ_TEST_CUBE_NUM_TRIS * 3));
+	if (indexes.size() != triangleVerts.size())
+	{
+		return;
+	}
+
+	int numBadCorners = 0;
+	for (int cornerIndex = 0; cornerIndex < static_cast<int>(indexes.size()); ++cornerIndex)
+	{
+		unsigned int vertIndex = indexes[cornerIndex];
+		numBadCorners += vertIndex < indexedVerts.size() && AreOBJCornersEqual(indexedVerts[vertIndex], triangleVerts[cornerIndex]) ? 0 : 1;
+	}
+	int numDuplicateVerts = 0;
+	for (int vertIndexA = 0; vertIndexA < static_cast<int>(indexedVerts.size()); ++vertIndexA)
+	{
+		for (int vertIndexB = vertIndexA + 1; vertIndexB < static_cast<int>(indexedVerts.size()); ++vertIndexB)
+		{
+			numDuplicateVerts += AreOBJCornersEqual(indexedVerts[vertIndexA], indexedVerts[vertIndexB]) ? 1 : 0;
+		}
+	}
+	ENGINE_TEST_CHECK(numBadCorners == 0, Stringf("%d indexed corners differ from the de-indexed triangles", numBadCorners));
+	ENGINE_TEST_CHECK(numDuplicateVerts == 0, Stringf("%d pairs of indexed vertexes have the same position, uv and normal", numDuplicateVerts));
+}
+
+// Loading into an array that already holds a mesh appends, leaving the first mesh as it was
+static void TestOBJAppend(std::string const& cubeFilePath, std::string const& quadFilePath)
+{
+	std::vector<Vertex_PCUTBN> cubeVerts;
+	std::vector<Vertex_PCUTBN> quadVerts;
+	LoadOBJMeshFile(cubeVerts, cubeFilePath.c_str(), false);
+	LoadOBJMeshFile(quadVerts, quadFilePath.c_str(), false);
+
+	// The second load uses the default cache setting, which appending has to turn off rather than start over
+	std::vector<Vertex_PCUTBN> bothVerts;
+	LoadOBJMeshFile(bothVerts, cubeFilePath.c_str(), false);
+	LoadOBJMeshFile(bothVerts, quadFilePath.c_str());
+	int expectedNumVerts = (OBJ_TEST_CUBE_NUM_TRIS + OBJ_TEST_QUAD_NUM_TRIS) * 3;
+	ENGINE_TEST_CHECK(static_cast<int>(bothVerts.size()) == expectedNumVerts, Stringf("Two OBJs loaded into one array left %d vertexes, expected %d",
+		static_cast<int>(bothVerts.size()), expectedNumVerts));
+	if (bothVerts.size() != cubeVerts.size() + quadVerts.size())
+	{
+		return;
+	}
+
+	int numBadVerts = 0;
+	for (int vertIndex = 0; vertIndex < static_cast<int>(bothVerts.size()); ++vertIndex)
+	{
+		int numCubeVerts = static_cast<int>(cubeVerts.size());
+		Vertex_PCUTBN const& expectedVert = vertIndex < numCubeVerts ? cubeVerts[vertIndex] : quadVerts[vertIndex - numCubeVerts];
+		numBadVerts += AreOBJCornersEqual(bothVerts[vertIndex], expectedVert) ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numBadVerts == 0, Stringf("%d vertexes of two OBJs loaded into one array differ from loading each on its own", numBadVerts));
+	ENGINE_TEST_CHECK(!DoesFileExist(GetMeshCacheFilePath(quadFilePath.c_str(), false)), "Appending a mesh wrote a mesh cache holding both meshes");
+}
+
+// Indexed appends offset the new indexes and leave the first mesh's vertex and triangle order alone
+static void TestOBJIndexedAppend(std::string const& cubeFilePath, std::string const& quadFilePath)
+{
+	std::vector<Vertex_PCUTBN> cubeVerts;
+	std::vector<unsigned int> cubeIndexes;
+	std::vector<Vertex_PCUTBN> quadVerts;
+	std::vector<unsigned int> quadIndexes;
+	LoadOBJMeshFile(cubeVerts, cubeIndexes, cubeFilePath.c_str(), false);
+	LoadOBJMeshFile(quadVerts, quadIndexes, quadFilePath.c_str(), false);
+
+	std::vector<Vertex_PCUTBN> bothVerts;
+	std::vector<unsigned int> bothIndexes;
+	LoadOBJMeshFile(bothVerts, bothIndexes, cubeFilePath.c_str(), false);
+	LoadOBJMeshFile(bothVerts, bothIndexes, quadFilePath.c_str());
+	if (!ENGINE_TEST_CHECK(bothVerts.size() == cubeVerts.size() + quadVerts.size() && bothIndexes.size() == cubeIndexes.size() + quadIndexes.size(),
+		Stringf("Two indexed OBJs loaded into one array left %d vertexes and %d indexes, expected %d and %d", static_cast<int>(bothVerts.size()),
+		static_cast<int>(bothIndexes.size()), static_cast<int>(cubeVerts.size() + quadVerts.size()), static_cast<int>(cubeIndexes.size() + quadIndexes.size()))))
+	{
+		return;
+	}
+
+	int numCubeVerts = static_cast<int>(cubeVerts.size());
+	int numCubeIndexes = static_cast<int>(cubeIndexes.size());
+	int numBadVerts = 0;
+	int numBadIndexes = 0;
+	for (int vertIndex = 0; vertIndex < static_cast<int>(bothVerts.size()); ++vertIndex)
+	{
+		Vertex_PCUTBN const& expectedVert = vertIndex < numCubeVerts ? cubeVerts[vertIndex] : quadVerts[vertIndex - numCubeVerts];
+		numBadVerts += AreOBJCornersEqual(bothVerts[vertIndex], expectedVert) && bothVerts[vertIndex].m_tangent == expectedVert.m_tangent ? 0 : 1;
+	}
+	for (int indexIndex = 0; indexIndex < static_cast<int>(bothIndexes.size()); ++indexIndex)
+	{
+		unsigned int expectedIndex = indexIndex < numCubeIndexes ? cubeIndexes[indexIndex] : quadIndexes[indexIndex - numCubeIndexes] + static_cast<unsigned int>(numCubeVerts);
+		numBadIndexes += bothIndexes[indexIndex] == expectedIndex ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numBadVerts == 0 && numBadIndexes == 0, Stringf("%d vertexes and %d indexes of two indexed OBJs loaded into one array differ from loading each on its own",
+		numBadVerts, numBadIndexes));
+}
+
+// An indexed cache written without MESH_CACHE_FLAG_OPTIMIZED is rebuilt from the OBJ, not returned as it is
+static void TestOBJUnoptimizedCache(std::string const& cubeFilePath, std::string const& quadFilePath)
+{
+	std::vector<Vertex_PCUTBN> expectedVerts;
+	std::vector<unsigned int> expectedIndexes;
+	LoadOBJMeshFile(expectedVerts, expectedIndexes, cubeFilePath.c_str(), false);
+
+	// The quad stands in for an old unoptimized cache, so returning it is easy to spot
+	std::vector<Vertex_PCUTBN> staleVerts;
+	std::vector<unsigned int> staleIndexes;
+	ParseOBJMeshFile(staleVerts, staleIndexes, quadFilePath.c_str());
+	std::string cacheFilePath = GetMeshCacheFilePath(cubeFilePath.c_str(), true);
+	WriteMeshCacheFile(cacheFilePath.c_str(), staleVerts, staleIndexes, cubeFilePath.c_str(), MESH_CACHE_FLAG_HAS_TANGENTS);
+
+	std::vector<Vertex_PCUTBN> loadedVerts;
+	std::vector<unsigned int> loadedIndexes;
+	LoadOBJMeshFile(loadedVerts, loadedIndexes, cubeFilePath.c_str());
+	MeshCacheView cacheView;
+	bool isRebuilt = OpenMeshCacheView(cacheView, cacheFilePath.c_str(), cubeFilePath.c_str(), MeshCacheValidation::TIMESTAMP, MESH_CACHE_FLAG_OPTIMIZED);
+	CloseMeshCacheView(cacheView);
+	ENGINE_TEST_CHECK(loadedVerts.size() == expectedVerts.size() && loadedIndexes == expectedIndexes, "LoadOBJMeshFile returned a mesh cache written without MESH_CACHE_FLAG_OPTIMIZED");
+	ENGINE_TEST_CHECK(isRebuilt, "The unoptimized mesh cache was not replaced by an optimized one");
+
+	std::error_code removeError;
+	std::filesystem::remove(cacheFilePath, removeError);
+}
+
+static void TestConvertIndexesTo16Bit()
+{
+	std::vector<unsigned int> const fittingIndexes = { 0, 1, 2, 65535, 7, 65534 };
+	std::vector<unsigned short> converted;
+	bool didConvert = ConvertIndexesTo16Bit(converted, fittingIndexes);
+	bool isEqual = converted.size() == fittingIndexes.size();
+	for (size_t indexIndex = 0; isEqual && indexIndex < converted.size(); ++indexIndex)
+	{
+		isEqual = converted[indexIndex] == fittingIndexes[indexIndex];
+	}
+	ENGINE_TEST_CHECK(didConvert && isEqual, "Indexes up to 65535 do not convert to the same 16 bit indexes");
+
+	std::vector<unsigned int> const overflowingIndexes = { 0, 1, 65536, 2 };
+	didConvert = ConvertIndexesTo16Bit(converted, overflowingIndexes);
+	ENGINE_TEST_CHECK(!didConvert && converted.empty(), "An index of 65536 converted to 16 bits, or left a partial array behind");
+}
+// -----------------------------------------------------------------------------
+void RunOBJLoaderTests()
+{
+	BeginEngineTestSection("OBJ loading");
+
+	std::string cubeFilePath = (std::filesystem::temp_directory_path() / "EngineTests_Cube.obj").string();
+	std::string quadFilePath = (std::filesystem::temp_directory_path() / "EngineTests_Quad.obj").string();
+	if (!ENGINE_TEST_CHECK(WriteTestOBJFile(cubeFilePath, OBJ_TEST_CUBE_TEXT) && WriteTestOBJFile(quadFilePath, OBJ_TEST_QUAD_TEXT), "Could not write the test OBJ files"))
+	{
+		return;
+	}
+
+	TestOBJCornerDedup(cubeFilePath);
+	TestOBJAppend(cubeFilePath, quadFilePath);
+	TestOBJIndexedAppend(cubeFilePath, quadFilePath);
+	TestOBJUnoptimizedCache(cubeFilePath, quadFilePath);
+	TestConvertIndexesTo16Bit();
+
+	for (std::string const& filePath : { cubeFilePath, quadFilePath, GetMeshCacheFilePath(quadFilePath.c_str(), false), GetMeshCacheFilePath(quadFilePath.c_str(), true) })
+	{
+		std::error_code removeError;
+		std::filesystem::remove(filePath, removeError);
+	}
+}
+// -----------------------------------------------------------------------------
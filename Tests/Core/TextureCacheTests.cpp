@@ -0,0 +1,157 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/TextureCache.hpp"
+#include "Engine/Core/ImageMips.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+// -----------------------------------------------------------------------------
+IntVec2 const TEXTURE_CACHE_TEST_DIMENSIONS = IntVec2(256, 128);
+// -----------------------------------------------------------------------------
+static bool WriteTextureCacheTestSource(std::string const& filePath, int numBytes)
+{
+	std::vector<uint8_t> fileBytes(numBytes, static_cast<uint8_t>('t'));
+	return WriteBufferToFile(fileBytes, filePath) == FILE_SUCCESS;
+}
+
+static bool DoesTextureCacheOpen(std::string const& cacheFilePath, std::string const& sourceFilePath)
+{
+	TextureCacheView cacheView;
+	bool didOpen = OpenTextureCacheView(cacheView, cacheFilePath.c_str(), sourceFilePath.c_str());
+	CloseTextureCacheView(cacheView);
+	return didOpen;
+}
+
+// The header describes levelSizes and every level's data is the bytes given, in order
+static bool DoesTextureCacheHold(std::string const& cacheFilePath, std::string const& sourceFilePath, TextureCacheFormat format, unsigned int flags,
+	std::vector<void const*> const& levelData, std::vector<size_t> const& levelSizes)
+{
+	TextureCacheView cacheView;
+	if (!OpenTextureCacheView(cacheView, cacheFilePath.c_str(), sourceFilePath.c_str()))
+	{
+		return false;
+	}
+
+	TextureCacheHeader const& header = *cacheView.m_header;
+	bool isEqual = header.m_format == static_cast<unsigned int>(format) && header.m_flags == flags &&
+		header.m_width == static_cast<unsigned int>(TEXTURE_CACHE_TEST_DIMENSIONS.x) && header.m_height == static_cast<unsigned int>(TEXTURE_CACHE_TEST_DIMENSIONS.y) &&
+		header.m_numMipLevels == levelData.size();
+	for (int levelIndex = 0; isEqual && levelIndex < static_cast<int>(levelData.size()); ++levelIndex)
+	{
+		isEqual = cacheView.m_levels[levelIndex].m_dataSize == levelSizes[levelIndex] &&
+			memcmp(GetTextureCacheLevelData(cacheView, levelIndex), levelData[levelIndex], levelSizes[levelIndex]) == 0;
+	}
+	CloseTextureCacheView(cacheView);
+	return isEqual;
+}
+// -----------------------------------------------------------------------------
+// Both writers come back bit identical with their format and flags, the mip chain as texels and as BC1 blocks
+static void TestTextureCacheHit(std::string const& cacheFilePath, std::string const& sourceFilePath, std::vector<Image> const& mipChain)
+{
+	std::vector<void const*> levelData;
+	std::vector<size_t> levelSizes;
+	for (Image const& mipImage : mipChain)
+	{
+		IntVec2 dimensions = mipImage.GetDimensions();
+		levelData.push_back(mipImage.GetRawData());
+		levelSizes.push_back(static_cast<size_t>(dimensions.x) * dimensions.y * sizeof(Rgba8));
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	bool didWrite = WriteTextureCacheFile(cacheFilePath.c_str(), mipChain, sourceFilePath.c_str(), TEXTURE_CACHE_FLAG_SRGB);
+	double writeSeconds = GetCurrentTimeSeconds() - startTime;
+	startTime = GetCurrentTimeSeconds();
+	bool isHit = DoesTextureCacheHold(cacheFilePath, sourceFilePath, TextureCacheFormat::RGBA8, TEXTURE_CACHE_FLAG_SRGB, levelData, levelSizes);
+	double openSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(didWrite && isHit, "An RGBA8 texture cache did not open, or its header or levels differ from what was written");
+
+	BlockCompressionSettings compressionSettings;
+	compressionSettings.m_format = BlockCompressionFormat::BC1;
+	compressionSettings.m_quality = BlockCompressionQuality::FAST;
+	std::vector<CompressedImage> compressedMipChain;
+	CompressImageMipChain(compressedMipChain, mipChain, compressionSettings);
+	levelData.clear();
+	levelSizes.clear();
+	for (CompressedImage const& compressedImage : compressedMipChain)
+	{
+		levelData.push_back(compressedImage.m_blocks.data());
+		levelSizes.push_back(compressedImage.m_blocks.size());
+	}
+	didWrite = WriteTextureCacheFile(cacheFilePath.c_str(), compressedMipChain, sourceFilePath.c_str(), TEXTURE_CACHE_FLAG_NONE);
+	isHit = DoesTextureCacheHold(cacheFilePath, sourceFilePath, TextureCacheFormat::BC1, TEXTURE_CACHE_FLAG_NONE, levelData, levelSizes);
+	ENGINE_TEST_CHECK(didWrite && isHit, "A BC1 texture cache did not open, or its header or blocks differ from what was written");
+
+	PrintEngineTestTiming(Stringf("%dx%d %d levels RGBA8  write %7.2fms  open %7.2fms", TEXTURE_CACHE_TEST_DIMENSIONS.x, TEXTURE_CACHE_TEST_DIMENSIONS.y,
+		static_cast<int>(mipChain.size()), writeSeconds * 1000.0, openSeconds * 1000.0));
+}
+
+// No file, a touched or resized source and a truncated file all miss, while a missing source is trusted
+static void TestTextureCacheMiss(std::string const& cacheFilePath, std::string const& sourceFilePath, std::vector<Image> const& mipChain)
+{
+	std::error_code fileError;
+	std::filesystem::remove(cacheFilePath, fileError);
+	ENGINE_TEST_CHECK(!DoesTextureCacheOpen(cacheFilePath, sourceFilePath), "A texture cache that does not exist opened");
+
+	WriteTextureCacheFile(cacheFilePath.c_str(), mipChain, sourceFilePath.c_str());
+	ENGINE_TEST_CHECK(DoesTextureCacheOpen(cacheFilePath, sourceFilePath), "A fresh texture cache did not open");
+
+	std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(sourceFilePath, fileError);
+	std::filesystem::last_write_time(sourceFilePath, lastWriteTime + std::chrono::seconds(10), fileError);
+	ENGINE_TEST_CHECK(!fileError, "Could not touch the texture cache test source");
+	ENGINE_TEST_CHECK(!DoesTextureCacheOpen(cacheFilePath, sourceFilePath), "A texture cache older than its source opened");
+
+	WriteTextureCacheFile(cacheFilePath.c_str(), mipChain, sourceFilePath.c_str());
+	lastWriteTime = std::filesystem::last_write_time(sourceFilePath, fileError);
+	WriteTextureCacheTestSource(sourceFilePath, 2048);
+	std::filesystem::last_write_time(sourceFilePath, lastWriteTime, fileError);
+	ENGINE_TEST_CHECK(!DoesTextureCacheOpen(cacheFilePath, sourceFilePath), "A texture cache opened after its source changed size");
+
+	std::filesystem::remove(sourceFilePath, fileError);
+	ENGINE_TEST_CHECK(DoesTextureCacheOpen(cacheFilePath, sourceFilePath), "A texture cache was rejected with its source missing, which it should trust");
+
+	std::vector<uint8_t> fileBytes;
+	FileReadToBuffer(fileBytes, cacheFilePath);
+	fileBytes.resize(fileBytes.size() - 64);
+	WriteBufferToFile(fileBytes, cacheFilePath);
+	ENGINE_TEST_CHECK(!DoesTextureCacheOpen(cacheFilePath, sourceFilePath), "A truncated texture cache opened");
+}
+// -----------------------------------------------------------------------------
+void RunTextureCacheTests()
+{
+	BeginEngineTestSection("Texture cache");
+
+	RandomNumberGenerator rng(35);
+	Image baseImage(TEXTURE_CACHE_TEST_DIMENSIONS, Rgba8());
+	for (int texelY = 0; texelY < TEXTURE_CACHE_TEST_DIMENSIONS.y; ++texelY)
+	{
+		for (int texelX = 0; texelX < TEXTURE_CACHE_TEST_DIMENSIONS.x; ++texelX)
+		{
+			unsigned char shade = static_cast<unsigned char>(rng.RollRandomIntInRange(0, 255));
+			baseImage.SetTexelColor(texelX, texelY, Rgba8(shade, static_cast<unsigned char>(texelX), static_cast<unsigned char>(texelY), 255));
+		}
+	}
+	std::vector<Image> mipChain;
+	GenerateImageMipChain(mipChain, baseImage);
+
+	std::string sourceFilePath = (std::filesystem::temp_directory_path() / "EngineTests_TextureCacheSource.png").string();
+	std::string cacheFilePath = GetTextureCacheFilePath(sourceFilePath.c_str());
+	if (!ENGINE_TEST_CHECK(WriteTextureCacheTestSource(sourceFilePath, 1024), Stringf("Could not write \"%s\"", sourceFilePath.c_str())))
+	{
+		return;
+	}
+
+	TestTextureCacheHit(cacheFilePath, sourceFilePath, mipChain);
+	TestTextureCacheMiss(cacheFilePath, sourceFilePath, mipChain);
+
+	for (std::string const& filePath : { sourceFilePath, cacheFilePath })
+	{
+		std::error_code removeError;
+		std::filesystem::remove(filePath, removeError);
+	}
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,97 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Core/VertexUtils.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int VERTEX_TEST_NUM_VERTS = 20003;		// Several jobs, full AVX batches, an SSE batch and a scalar tail
+// -----------------------------------------------------------------------------
+static bool IsNearlyEqualVec3(Vec3 const& vecA, Vec3 const& vecB, float tolerance = 1e-4f)
+{
+	return (vecA - vecB).GetLength() <= tolerance;
+}
+
+// Unit tangent frames with normal = tangent x bitangent, as ComputeMeshTangents leaves them
+static std::vector<Vertex_PCUTBN> MakeRandomTBNVerts(RandomNumberGenerator& rng)
+{
+	std::vector<Vertex_PCUTBN> verts;
+	verts.reserve(VERTEX_TEST_NUM_VERTS);
+	for (int vertIndex = 0; vertIndex < VERTEX_TEST_NUM_VERTS; ++vertIndex)
+	{
+		Vec3 position(rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f));
+		Vec3 normal = rng.RollRandomDirection3D();
+		Vec3 helperAxis = fabsf(normal.z) < 0.9f ? Vec3(0.f, 0.f, 1.f) : Vec3(1.f, 0.f, 0.f);
+		Vec3 tangent = CrossProduct3D(helperAxis, normal).GetNormalized();
+		Vec3 bitangent = CrossProduct3D(normal, tangent);
+		verts.push_back(Vertex_PCUTBN(position, Rgba8::WHITE, Vec2::ZERO, tangent, bitangent, normal));
+	}
+	return verts;
+}
+// -----------------------------------------------------------------------------
+// Under a non-uniform scale the batched path has to match transforming each vertex on its own: positions by
+// TransformPosition3D, tangent and bitangent by TransformVectorQuantity3D, and the normal rebuilt from the
+// transformed tangent and bitangent, which is what the inverse transpose gives. All three renormalized.
+static void TestTBNUnderNonUniformScale(JobSystem& jobSystem)
+{
+	RandomNumberGenerator rng(38);
+	std::vector<Vertex_PCUTBN> const sourceVerts = MakeRandomTBNVerts(rng);
+
+	Mat44 transform = Mat44::MakeTranslation3D(Vec3(4.f, -7.f, 2.f));
+	transform.AppendZRotation(30.f);
+	transform.AppendXRotation(20.f);
+	transform.AppendScaleNonUniform3D(Vec3(3.f, 0.5f, 1.5f));
+
+	std::vector<Vertex_PCUTBN> serialVerts = sourceVerts;
+	TransformVertexArrayTBN3D(serialVerts, transform);
+	std::vector<Vertex_PCUTBN> parallelVerts = sourceVerts;
+	TransformVertexArrayTBN3D(parallelVerts, transform, &jobSystem);
+
+	int numBadPositions = 0;
+	int numBadTangents = 0;
+	int numBadNormals = 0;
+	int numSkewedRawNormals = 0;
+	for (int vertIndex = 0; vertIndex < VERTEX_TEST_NUM_VERTS; ++vertIndex)
+	{
+		Vertex_PCUTBN const& source = sourceVerts[vertIndex];
+		Vertex_PCUTBN const& result = serialVerts[vertIndex];
+		Vec3 expectedTangent = transform.TransformVectorQuantity3D(source.m_tangent).GetNormalized();
+		Vec3 expectedBitangent = transform.TransformVectorQuantity3D(source.m_bitangent).GetNormalized();
+		Vec3 expectedNormal = CrossProduct3D(expectedTangent, expectedBitangent).GetNormalized();
+
+		numBadPositions += IsNearlyEqualVec3(result.m_position, transform.TransformPosition3D(source.m_position), 1e-3f) ? 0 : 1;
+		numBadTangents += (IsNearlyEqualVec3(result.m_tangent, expectedTangent) && IsNearlyEqualVec3(result.m_bitangent, expectedBitangent)) ? 0 : 1;
+		bool isNormalValid = IsNearlyEqualVec3(result.m_normal, expectedNormal) && fabsf(DotProduct3D(result.m_normal, result.m_tangent)) < 1e-4f &&
+			fabsf(DotProduct3D(result.m_normal, result.m_bitangent)) < 1e-4f;
+		numBadNormals += isNormalValid ? 0 : 1;
+
+		// The raw matrix would tilt the normal off the surface, otherwise this transform proves nothing
+		Vec3 rawNormal = transform.TransformVectorQuantity3D(source.m_normal).GetNormalized();
+		numSkewedRawNormals += fabsf(DotProduct3D(rawNormal, expectedTangent)) > 0.01f ? 1 : 0;
+	}
+	ENGINE_TEST_CHECK(numBadPositions == 0, Stringf("%d of %d positions differ from TransformPosition3D", numBadPositions, VERTEX_TEST_NUM_VERTS));
+	ENGINE_TEST_CHECK(numBadTangents == 0, Stringf("%d of %d tangents or bitangents differ from TransformVectorQuantity3D renormalized", numBadTangents, VERTEX_TEST_NUM_VERTS));
+	ENGINE_TEST_CHECK(numBadNormals == 0, Stringf("%d of %d normals are not the unit inverse transpose normal", numBadNormals, VERTEX_TEST_NUM_VERTS));
+	ENGINE_TEST_CHECK(numSkewedRawNormals > VERTEX_TEST_NUM_VERTS / 2, Stringf("Only %d of %d raw transformed normals were skewed, the test scale is too mild",
+		numSkewedRawNormals, VERTEX_TEST_NUM_VERTS));
+	ENGINE_TEST_CHECK(memcmp(serialVerts.data(), parallelVerts.data(), sizeof(Vertex_PCUTBN) * serialVerts.size()) == 0,
+		"Transforming through the job system gave different vertexes than the serial transform");
+}
+// -----------------------------------------------------------------------------
+void RunVertexUtilsTests()
+{
+	BeginEngineTestSection("Vertex array transforms");
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	TestTBNUnderNonUniformScale(jobSystem);
+
+	jobSystem.Shutdown();
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,37 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include <cstdio>
+// -----------------------------------------------------------------------------
+static int s_numChecks = 0;
+static int s_numFailedChecks = 0;
+// -----------------------------------------------------------------------------
+bool CheckEngineTest(bool passed, char const* conditionText, std::string const& message, char const* filePath, int lineNumber)
+{
+	++s_numChecks;
+	if (!passed)
+	{
+		++s_numFailedChecks;
+		printf("  FAILED %s(%d): %s\n    %s\n", filePath, lineNumber, conditionText, message.c_str());
+	}
+	return passed;
+}
+
+void BeginEngineTestSection(char const* sectionName)
+{
+	printf("%s\n", sectionName);
+}
+
+void PrintEngineTestTiming(std::string const& timingLine)
+{
+	printf("  %s\n", timingLine.c_str());
+}
+
+int GetNumEngineTestChecks()
+{
+	return s_numChecks;
+}
+
+int GetNumFailedEngineTestChecks()
+{
+	return s_numFailedChecks;
+}
+// -----------------------------------------------------------------------------
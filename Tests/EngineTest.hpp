@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+// -----------------------------------------------------------------------------
+// Check and report helpers shared by the engine tests in EngineTests.vcxproj. A failed check prints where it
+// failed and fails the run, timings are printed for reference only and never fail anything.
+// -----------------------------------------------------------------------------
+#define ENGINE_TEST_CHECK( condition, message ) CheckEngineTest( (condition), #condition, (message), __FILE__, __LINE__ )
+// -----------------------------------------------------------------------------
+bool CheckEngineTest(bool passed, char const* conditionText, std::string const& message, char const* filePath, int lineNumber); // Returns passed
+void BeginEngineTestSection(char const* sectionName);
+void PrintEngineTestTiming(std::string const& timingLine);
+int	 GetNumEngineTestChecks();
+int	 GetNumFailedEngineTestChecks();
+// -----------------------------------------------------------------------------
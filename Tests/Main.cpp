@@ -0,0 +1,63 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include <cstdio>
+// -----------------------------------------------------------------------------
+// Each engine area adds its runner here, they are called in this order
+void RunSIMDMathTests();
+void RunImageTests();
+void RunBlockCompressionTests();
+void RunImageKernelTests();
+void RunRaycastBatchTests();
+void RunBVHTests();
+void RunMeshBVHTests();
+void RunSpatialHashGrid2DTests();
+void RunFrustumCullTests();
+void RunSweepAndPruneTests();
+void RunConvexCollisionTests();
+void RunRigidBodyWorldTests();
+void RunSweptCollisionTests();
+void RunSmoothNoiseTests();
+void RunRandomNumberGeneratorTests();
+void RunTerrainStreamerTests();
+void RunOBJLoaderTests();
+void RunMeshUtilsTests();
+void RunMeshCacheTests();
+void RunMeshOptimizerTests();
+void RunMeshSimplifierTests();
+void RunImageMipTests();
+void RunAtlasPackerTests();
+void RunTextureCacheTests();
+void RunVertexUtilsTests();
+// -----------------------------------------------------------------------------
+int main(int, char**)
+{
+	RunSIMDMathTests();
+	RunImageTests();
+	RunBlockCompressionTests();
+	RunImageKernelTests();
+	RunRaycastBatchTests();
+	RunBVHTests();
+	RunMeshBVHTests();
+	RunSpatialHashGrid2DTests();
+	RunFrustumCullTests();
+	RunSweepAndPruneTests();
+	RunConvexCollisionTests();
+	RunRigidBodyWorldTests();
+	RunSweptCollisionTests();
+	RunSmoothNoiseTests();
+	RunRandomNumberGeneratorTests();
+	RunTerrainStreamerTests();
+	RunOBJLoaderTests();
+	RunMeshUtilsTests();
+	RunMeshCacheTests();
+	RunMeshOptimizerTests();
+	RunMeshSimplifierTests();
+	RunImageMipTests();
+	RunAtlasPackerTests();
+	RunTextureCacheTests();
+	RunVertexUtilsTests();
+
+	int numFailedChecks = GetNumFailedEngineTestChecks();
+	printf("\n%d of %d checks passed\n", GetNumEngineTestChecks() - numFailedChecks, GetNumEngineTestChecks());
+	return numFailedChecks == 0 ? 0 : 1;
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,232 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/BVH3D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int	BVH_TEST_NUM_PRIMITIVES = 20000;	// Enough for the build to split across jobs
+constexpr int	BVH_TEST_NUM_RAYS = 2000;
+constexpr float BVH_TEST_WORLD_HALF_SIZE = 100.f;
+constexpr float BVH_TEST_QUERY_RADIUS = 5.f;
+// -----------------------------------------------------------------------------
+static AABB3 const GetRandomTestBounds(RandomNumberGenerator& rng)
+{
+	float halfSize = BVH_TEST_WORLD_HALF_SIZE;
+	Vec3 center(rng.RollRandomFloatInRange(-halfSize, halfSize), rng.RollRandomFloatInRange(-halfSize, halfSize), rng.RollRandomFloatInRange(-halfSize, halfSize));
+	Vec3 halfDimensions(rng.RollRandomFloatInRange(0.1f, 1.f), rng.RollRandomFloatInRange(0.1f, 1.f), rng.RollRandomFloatInRange(0.1f, 1.f));
+	return AABB3(center - halfDimensions, center + halfDimensions);
+}
+
+static bool DoesBoundsContain(AABB3 const& outer, AABB3 const& inner)
+{
+	return outer.m_mins.x <= inner.m_mins.x && outer.m_mins.y <= inner.m_mins.y && outer.m_mins.z <= inner.m_mins.z &&
+		outer.m_maxs.x >= inner.m_maxs.x && outer.m_maxs.y >= inner.m_maxs.y && outer.m_maxs.z >= inner.m_maxs.z;
+}
+
+// Every primitive sits in exactly one leaf, and every node's bounds hold its children and primitives
+static int CountBVHProblems(BVH3D const& bvh, std::vector<AABB3> const& bounds)
+{
+	std::vector<BVHNode3D> const& nodes = bvh.GetNodes();
+	std::vector<int> const& primitiveIndices = bvh.GetPrimitiveIndices();
+	int numProblems = 0;
+	std::vector<int> timesInLeaf(bounds.size(), 0);
+	for (int nodeIndex = 0; nodeIndex < static_cast<int>(nodes.size()); ++nodeIndex)
+	{
+		BVHNode3D const& node = nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			bool childrenAreValid = node.m_firstIndex > nodeIndex && node.m_firstIndex + 1 < static_cast<int>(nodes.size());
+			if (!childrenAreValid || !DoesBoundsContain(node.m_bounds, nodes[node.m_firstIndex].m_bounds) || !DoesBoundsContain(node.m_bounds, nodes[node.m_firstIndex + 1].m_bounds))
+			{
+				++numProblems;
+			}
+			continue;
+		}
+		if (node.m_firstIndex < 0 || node.m_firstIndex + node.m_numPrimitives > static_cast<int>(primitiveIndices.size()))
+		{
+			++numProblems;
+			continue;
+		}
+		for (int index = node.m_firstIndex; index < node.m_firstIndex + node.m_numPrimitives; ++index)
+		{
+			int primitiveIndex = primitiveIndices[index];
+			++timesInLeaf[primitiveIndex];
+			numProblems += DoesBoundsContain(node.m_bounds, bounds[primitiveIndex]) ? 0 : 1;
+		}
+	}
+	for (int count : timesInLeaf)
+	{
+		numProblems += count == 1 ? 0 : 1;
+	}
+	return numProblems;
+}
+
+// Closest hits agree when both missed or both hit at nearly the same distance, ties may pick either primitive
+static int CountClosestHitMismatches(BVH3D const& bvh, std::vector<AABB3> const& bounds, std::vector<Vec3> const& rayStarts, std::vector<Vec3> const& rayFwdNormals, int* out_numHits = nullptr)
+{
+	int numMismatches = 0;
+	int numHits = 0;
+	for (int rayIndex = 0; rayIndex < static_cast<int>(rayStarts.size()); ++rayIndex)
+	{
+		float nearestDist = FLT_MAX;
+		for (AABB3 const& box : bounds)
+		{
+			RaycastResult3D result = RaycastVsAABB3D(rayStarts[rayIndex], rayFwdNormals[rayIndex], BVH_TEST_WORLD_HALF_SIZE, box);
+			if (result.m_didImpact)
+			{
+				nearestDist = std::min(nearestDist, result.m_impactDist);
+			}
+		}
+		BVHRaycastResult3D result = bvh.RaycastClosest(rayStarts[rayIndex], rayFwdNormals[rayIndex], BVH_TEST_WORLD_HALF_SIZE);
+		bool bruteForceDidImpact = nearestDist != FLT_MAX;
+		numHits += bruteForceDidImpact ? 1 : 0;
+		if (result.m_didImpact != bruteForceDidImpact || (bruteForceDidImpact && fabsf(result.m_impactDist - nearestDist) > 0.001f))
+		{
+			++numMismatches;
+		}
+	}
+	if (out_numHits != nullptr)
+	{
+		*out_numHits = numHits;
+	}
+	return numMismatches;
+}
+// -----------------------------------------------------------------------------
+void RunBVHTests()
+{
+	BeginEngineTestSection("BVH3D");
+
+	RandomNumberGenerator rng(40);
+	std::vector<AABB3> bounds(BVH_TEST_NUM_PRIMITIVES);
+	for (AABB3& box : bounds)
+	{
+		box = GetRandomTestBounds(rng);
+	}
+	std::vector<Vec3> rayStarts(BVH_TEST_NUM_RAYS);
+	std::vector<Vec3> rayFwdNormals(BVH_TEST_NUM_RAYS);
+	for (int rayIndex = 0; rayIndex < BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		float halfSize = BVH_TEST_WORLD_HALF_SIZE;
+		rayStarts[rayIndex] = Vec3(rng.RollRandomFloatInRange(-halfSize, halfSize), rng.RollRandomFloatInRange(-halfSize, halfSize), rng.RollRandomFloatInRange(-halfSize, halfSize));
+		rayFwdNormals[rayIndex] = Vec3(rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f)).GetNormalized();
+	}
+
+	// Serial and job system builds
+	BVH3D bvh;
+	double startTime = GetCurrentTimeSeconds();
+	bvh.Build(bounds);
+	double serialBuildSeconds = GetCurrentTimeSeconds() - startTime;
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+	BVH3D parallelBVH;
+	startTime = GetCurrentTimeSeconds();
+	parallelBVH.Build(bounds, &jobSystem);
+	double parallelBuildSeconds = GetCurrentTimeSeconds() - startTime;
+	jobSystem.Shutdown();
+
+	int numProblems = CountBVHProblems(bvh, bounds);
+	int numParallelProblems = CountBVHProblems(parallelBVH, bounds);
+	ENGINE_TEST_CHECK(bvh.GetNumPrimitives() == BVH_TEST_NUM_PRIMITIVES, Stringf("Built over %d primitives, expected %d", bvh.GetNumPrimitives(), BVH_TEST_NUM_PRIMITIVES));
+	ENGINE_TEST_CHECK(numProblems == 0, Stringf("Serial build has %d misplaced primitives or nodes with bounds too small", numProblems));
+	ENGINE_TEST_CHECK(numParallelProblems == 0, Stringf("Job system build has %d misplaced primitives or nodes with bounds too small", numParallelProblems));
+	PrintEngineTestTiming(Stringf("Build %d primitives   serial %8.2fms  %d nodes  job system %8.2fms  %d nodes", BVH_TEST_NUM_PRIMITIVES,
+		serialBuildSeconds * 1000.0, static_cast<int>(bvh.GetNodes().size()), parallelBuildSeconds * 1000.0, static_cast<int>(parallelBVH.GetNodes().size())));
+
+	// Raycasts against brute force
+	startTime = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		bvh.RaycastClosest(rayStarts[rayIndex], rayFwdNormals[rayIndex], BVH_TEST_WORLD_HALF_SIZE);
+	}
+	double closestSeconds = (GetCurrentTimeSeconds() - startTime) / static_cast<double>(BVH_TEST_NUM_RAYS);
+
+	int numAnyHitMismatches = 0;
+	startTime = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		BVHRaycastResult3D anyResult = bvh.RaycastAny(rayStarts[rayIndex], rayFwdNormals[rayIndex], BVH_TEST_WORLD_HALF_SIZE);
+		BVHRaycastResult3D closestResult = bvh.RaycastClosest(rayStarts[rayIndex], rayFwdNormals[rayIndex], BVH_TEST_WORLD_HALF_SIZE);
+		numAnyHitMismatches += anyResult.m_didImpact == closestResult.m_didImpact ? 0 : 1;
+	}
+	double anyAndClosestSeconds = (GetCurrentTimeSeconds() - startTime) / static_cast<double>(BVH_TEST_NUM_RAYS);
+
+	int numHits = 0;
+	startTime = GetCurrentTimeSeconds();
+	int numClosestMismatches = CountClosestHitMismatches(bvh, bounds, rayStarts, rayFwdNormals, &numHits);
+	double bruteForceSeconds = (GetCurrentTimeSeconds() - startTime) / static_cast<double>(BVH_TEST_NUM_RAYS);
+	int numParallelMismatches = CountClosestHitMismatches(parallelBVH, bounds, rayStarts, rayFwdNormals);
+
+	ENGINE_TEST_CHECK(numHits > BVH_TEST_NUM_RAYS / 10 && numHits < BVH_TEST_NUM_RAYS, Stringf("%d of %d rays hit, too few or too many to mean much", numHits, BVH_TEST_NUM_RAYS));
+	ENGINE_TEST_CHECK(numClosestMismatches == 0, Stringf("RaycastClosest disagrees with brute force for %d of %d rays", numClosestMismatches, BVH_TEST_NUM_RAYS));
+	ENGINE_TEST_CHECK(numParallelMismatches == 0, Stringf("RaycastClosest on the job system build disagrees with brute force for %d of %d rays", numParallelMismatches, BVH_TEST_NUM_RAYS));
+	ENGINE_TEST_CHECK(numAnyHitMismatches == 0, Stringf("RaycastAny and RaycastClosest disagree on hitting for %d of %d rays", numAnyHitMismatches, BVH_TEST_NUM_RAYS));
+	PrintEngineTestTiming(Stringf("Closest hit raycast   %8.2fus per ray  brute force %8.2fus per ray", closestSeconds * 1e6, bruteForceSeconds * 1e6));
+	PrintEngineTestTiming(Stringf("Any plus closest hit  %8.2fus per ray", anyAndClosestSeconds * 1e6));
+
+	// Overlap queries against brute force
+	int numSphereMismatches = 0;
+	int numBoxMismatches = 0;
+	std::vector<int> overlaps;
+	std::vector<int> expectedOverlaps;
+	double sphereSeconds = 0.0;
+	for (int rayIndex = 0; rayIndex < BVH_TEST_NUM_RAYS; ++rayIndex)
+	{
+		Vec3 const& center = rayStarts[rayIndex];
+		overlaps.clear();
+		startTime = GetCurrentTimeSeconds();
+		bvh.GetPrimitivesOverlappingSphere(center, BVH_TEST_QUERY_RADIUS, overlaps);
+		sphereSeconds += GetCurrentTimeSeconds() - startTime;
+		expectedOverlaps.clear();
+		for (int primitiveIndex = 0; primitiveIndex < BVH_TEST_NUM_PRIMITIVES; ++primitiveIndex)
+		{
+			if (DoSpheresAndAABBOverlap3D(center, BVH_TEST_QUERY_RADIUS, bounds[primitiveIndex]))
+			{
+				expectedOverlaps.push_back(primitiveIndex);
+			}
+		}
+		std::sort(overlaps.begin(), overlaps.end());
+		numSphereMismatches += overlaps == expectedOverlaps ? 0 : 1;
+
+		Vec3 queryHalfDimensions(BVH_TEST_QUERY_RADIUS, BVH_TEST_QUERY_RADIUS * 0.5f, BVH_TEST_QUERY_RADIUS * 2.f);
+		AABB3 queryBox(center - queryHalfDimensions, center + queryHalfDimensions);
+		overlaps.clear();
+		bvh.GetPrimitivesOverlappingAABB3(queryBox, overlaps);
+		expectedOverlaps.clear();
+		for (int primitiveIndex = 0; primitiveIndex < BVH_TEST_NUM_PRIMITIVES; ++primitiveIndex)
+		{
+			if (bounds[primitiveIndex].Intersects(queryBox))
+			{
+				expectedOverlaps.push_back(primitiveIndex);
+			}
+		}
+		std::sort(overlaps.begin(), overlaps.end());
+		numBoxMismatches += overlaps == expectedOverlaps ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numSphereMismatches == 0, Stringf("GetPrimitivesOverlappingSphere disagrees with brute force for %d of %d queries", numSphereMismatches, BVH_TEST_NUM_RAYS));
+	ENGINE_TEST_CHECK(numBoxMismatches == 0, Stringf("GetPrimitivesOverlappingAABB3 disagrees with brute force for %d of %d queries", numBoxMismatches, BVH_TEST_NUM_RAYS));
+	PrintEngineTestTiming(Stringf("Sphere overlap        %8.2fus per query", sphereSeconds * 1e6 / static_cast<double>(BVH_TEST_NUM_RAYS)));
+
+	// Jiggle everything a little and refit, as a frame of dynamic objects would
+	for (AABB3& box : bounds)
+	{
+		box.Translate(Vec3(rng.RollRandomFloatInRange(-0.5f, 0.5f), rng.RollRandomFloatInRange(-0.5f, 0.5f), rng.RollRandomFloatInRange(-0.5f, 0.5f)));
+	}
+	startTime = GetCurrentTimeSeconds();
+	bvh.Refit(bounds);
+	double refitSeconds = GetCurrentTimeSeconds() - startTime;
+
+	int numRefitProblems = CountBVHProblems(bvh, bounds);
+	int numRefitMismatches = CountClosestHitMismatches(bvh, bounds, rayStarts, rayFwdNormals);
+	ENGINE_TEST_CHECK(numRefitProblems == 0, Stringf("Refit left %d nodes with bounds too small", numRefitProblems));
+	ENGINE_TEST_CHECK(numRefitMismatches == 0, Stringf("RaycastClosest after Refit disagrees with brute force for %d of %d rays", numRefitMismatches, BVH_TEST_NUM_RAYS));
+	PrintEngineTestTiming(Stringf("Refit                 %8.2fms", refitSeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
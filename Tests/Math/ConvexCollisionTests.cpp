@@ -0,0 +1,217 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/ConvexCollision3D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int	CONVEX_TEST_NUM_PAIRS = 20000;
+constexpr float CONVEX_TEST_SPREAD = 1.2f;
+constexpr float CONVEX_TEST_TOUCHING_DEPTH = 1e-4f;	// Pairs this near touching may land either side
+constexpr float CONVEX_TEST_POINT_TOLERANCE = 1e-3f;
+constexpr float CONVEX_TEST_PUSH_MARGIN = 0.01f;
+// -----------------------------------------------------------------------------
+static OBB3 RollRandomOBB3(RandomNumberGenerator& rng, float spread)
+{
+	EulerAngles orientation(rng.RollRandomFloatInRange(0.f, 360.f), rng.RollRandomFloatInRange(-90.f, 90.f), rng.RollRandomFloatInRange(0.f, 360.f));
+	Vec3 iBasis, jBasis, kBasis;
+	orientation.GetAsVectors_IFwd_JLeft_KUp(iBasis, jBasis, kBasis);
+	Vec3 center(rng.RollRandomFloatInRange(-spread, spread), rng.RollRandomFloatInRange(-spread, spread), rng.RollRandomFloatInRange(-spread, spread));
+	Vec3 halfDimensions(rng.RollRandomFloatInRange(0.2f, 1.f), rng.RollRandomFloatInRange(0.2f, 1.f), rng.RollRandomFloatInRange(0.2f, 1.f));
+	return OBB3(center, iBasis, jBasis, kBasis, halfDimensions);
+}
+
+static ConvexShape3D RollRandomConvexShape3D(RandomNumberGenerator& rng, ConvexShapeType3D type, float spread)
+{
+	Vec3 center(rng.RollRandomFloatInRange(-spread, spread), rng.RollRandomFloatInRange(-spread, spread), rng.RollRandomFloatInRange(-spread, spread));
+	switch (type)
+	{
+		case ConvexShapeType3D::SPHERE:		return ConvexShape3D::MakeSphere(center, rng.RollRandomFloatInRange(0.2f, 1.f));
+		case ConvexShapeType3D::CAPSULE:	return ConvexShape3D::MakeCapsule(center, center + rng.RollRandomUnitVector() * rng.RollRandomFloatInRange(0.f, 1.5f), rng.RollRandomFloatInRange(0.2f, 0.7f));
+		case ConvexShapeType3D::Z_CYLINDER:	return ConvexShape3D::MakeZCylinder(center, rng.RollRandomFloatInRange(0.2f, 1.f), rng.RollRandomFloatInRange(0.3f, 2.f));
+		case ConvexShapeType3D::OBB:		return ConvexShape3D::MakeOBB3(RollRandomOBB3(rng, spread));
+	}
+	return ConvexShape3D::MakeSphere(center, 1.f);
+}
+
+static ConvexShape3D GetMovedConvexShape3D(ConvexShape3D const& shape, Vec3 const& displacement)
+{
+	ConvexShape3D movedShape = shape;
+	movedShape.m_center += displacement;
+	return movedShape;
+}
+
+// The documented contact promises: a unit normal, points a depth apart along it, and for overlaps a push of B by the
+// depth that separates the pair. SAT's face axis bias means only EPA's push is also the shortest.
+static bool IsConvexContactValid(ConvexShape3D const& shapeA, ConvexShape3D const& shapeB, ConvexContact3D const& contact, bool isShortestPush)
+{
+	if (fabsf(contact.m_normal.GetLength() - 1.f) > CONVEX_TEST_POINT_TOLERANCE)
+	{
+		return false;
+	}
+	Vec3 pointOffset = contact.m_pointOnA - contact.m_pointOnB - contact.m_normal * contact.m_penetrationDepth;
+	if (pointOffset.GetLength() > CONVEX_TEST_POINT_TOLERANCE)
+	{
+		return false;
+	}
+	if (!contact.m_isOverlapping || contact.m_penetrationDepth < CONVEX_TEST_PUSH_MARGIN * 2.f)
+	{
+		return true;
+	}
+	bool isSeparatedByPush = !DoConvexShapesOverlap3D(shapeA, GetMovedConvexShape3D(shapeB, contact.m_normal * (contact.m_penetrationDepth + CONVEX_TEST_PUSH_MARGIN)));
+	bool isOverlappingShortOfPush = DoConvexShapesOverlap3D(shapeA, GetMovedConvexShape3D(shapeB, contact.m_normal * (contact.m_penetrationDepth - CONVEX_TEST_PUSH_MARGIN)));
+	return isSeparatedByPush && (isOverlappingShortOfPush || !isShortestPush);
+}
+// -----------------------------------------------------------------------------
+// SAT against GJK/EPA on the same boxes
+static void TestOBB3Contacts(RandomNumberGenerator& rng)
+{
+	std::vector<OBB3> boxes(CONVEX_TEST_NUM_PAIRS * 2);
+	std::vector<ConvexShape3D> boxShapes(CONVEX_TEST_NUM_PAIRS * 2);
+	for (int boxIndex = 0; boxIndex < CONVEX_TEST_NUM_PAIRS * 2; ++boxIndex)
+	{
+		boxes[boxIndex] = RollRandomOBB3(rng, CONVEX_TEST_SPREAD);
+		boxShapes[boxIndex] = ConvexShape3D::MakeOBB3(boxes[boxIndex]);
+	}
+
+	std::vector<ConvexContact3D> satContacts(CONVEX_TEST_NUM_PAIRS);
+	std::vector<ConvexContact3D> gjkContacts(CONVEX_TEST_NUM_PAIRS);
+	int numSatOverlaps = 0;
+	double startTime = GetCurrentTimeSeconds();
+	for (int pairIndex = 0; pairIndex < CONVEX_TEST_NUM_PAIRS; ++pairIndex)
+	{
+		numSatOverlaps += GetOBB3sContact3D(boxes[pairIndex * 2], boxes[pairIndex * 2 + 1], satContacts[pairIndex]) ? 1 : 0;
+	}
+	double satSeconds = GetCurrentTimeSeconds() - startTime;
+	startTime = GetCurrentTimeSeconds();
+	for (int pairIndex = 0; pairIndex < CONVEX_TEST_NUM_PAIRS; ++pairIndex)
+	{
+		GetConvexShapesContactGJK3D(boxShapes[pairIndex * 2], boxShapes[pairIndex * 2 + 1], gjkContacts[pairIndex]);
+	}
+	double gjkSeconds = GetCurrentTimeSeconds() - startTime;
+
+	// Both paths must agree on which pairs overlap. SAT's depth can only be deeper than EPA's, by its face axis bias.
+	int numOverlapMismatches = 0;
+	int numShallowerSatDepths = 0;
+	int numBadSatContacts = 0;
+	int numBadGJKContacts = 0;
+	float largestExtraDepth = 0.f;
+	for (int pairIndex = 0; pairIndex < CONVEX_TEST_NUM_PAIRS; ++pairIndex)
+	{
+		ConvexContact3D const& satContact = satContacts[pairIndex];
+		ConvexContact3D const& gjkContact = gjkContacts[pairIndex];
+		if (satContact.m_isOverlapping != gjkContact.m_isOverlapping)
+		{
+			float nearestToTouching = std::min(fabsf(satContact.m_penetrationDepth), fabsf(gjkContact.m_penetrationDepth));
+			numOverlapMismatches += nearestToTouching > CONVEX_TEST_TOUCHING_DEPTH ? 1 : 0;
+			continue;
+		}
+		if (!satContact.m_isOverlapping)
+		{
+			continue;
+		}
+		largestExtraDepth = std::max(largestExtraDepth, satContact.m_penetrationDepth - gjkContact.m_penetrationDepth);
+		numShallowerSatDepths += satContact.m_penetrationDepth < gjkContact.m_penetrationDepth - CONVEX_TEST_POINT_TOLERANCE ? 1 : 0;
+		numBadSatContacts += IsConvexContactValid(boxShapes[pairIndex * 2], boxShapes[pairIndex * 2 + 1], satContact, false) ? 0 : 1;
+		numBadGJKContacts += IsConvexContactValid(boxShapes[pairIndex * 2], boxShapes[pairIndex * 2 + 1], gjkContact, true) ? 0 : 1;
+	}
+
+	ENGINE_TEST_CHECK(numSatOverlaps > CONVEX_TEST_NUM_PAIRS / 10 && numSatOverlaps < CONVEX_TEST_NUM_PAIRS, Stringf("%d of %d box pairs overlap, too few or too many to mean much",
+		numSatOverlaps, CONVEX_TEST_NUM_PAIRS));
+	ENGINE_TEST_CHECK(numOverlapMismatches == 0, Stringf("SAT and GJK/EPA disagree on overlap for %d of %d box pairs", numOverlapMismatches, CONVEX_TEST_NUM_PAIRS));
+	ENGINE_TEST_CHECK(numShallowerSatDepths == 0, Stringf("SAT found a shallower depth than EPA for %d of %d overlapping boxes", numShallowerSatDepths, numSatOverlaps));
+	ENGINE_TEST_CHECK(numBadSatContacts == 0, Stringf("%d of %d SAT box contacts break the normal, point or push promises", numBadSatContacts, numSatOverlaps));
+	ENGINE_TEST_CHECK(numBadGJKContacts == 0, Stringf("%d of %d GJK/EPA box contacts break the normal, point or push promises", numBadGJKContacts, numSatOverlaps));
+	PrintEngineTestTiming(Stringf("%d box pairs, %d overlapping, SAT at most %.5f deeper", CONVEX_TEST_NUM_PAIRS, numSatOverlaps, largestExtraDepth));
+	PrintEngineTestTiming(Stringf("SAT       %8.3fms  %6.1fns per pair", satSeconds * 1000.0, satSeconds * 1e9 / static_cast<double>(CONVEX_TEST_NUM_PAIRS)));
+	PrintEngineTestTiming(Stringf("GJK/EPA   %8.3fms  %6.1fns per pair", gjkSeconds * 1000.0, gjkSeconds * 1e9 / static_cast<double>(CONVEX_TEST_NUM_PAIRS)));
+}
+
+// Spheres have an exact answer to check the GJK path against
+static void TestSphereContacts(RandomNumberGenerator& rng)
+{
+	int numMismatches = 0;
+	for (int pairIndex = 0; pairIndex < CONVEX_TEST_NUM_PAIRS; ++pairIndex)
+	{
+		ConvexShape3D sphereA = RollRandomConvexShape3D(rng, ConvexShapeType3D::SPHERE, CONVEX_TEST_SPREAD);
+		ConvexShape3D sphereB = RollRandomConvexShape3D(rng, ConvexShapeType3D::SPHERE, CONVEX_TEST_SPREAD);
+		Vec3 centerOffset = sphereB.m_center - sphereA.m_center;
+		float centerDist = centerOffset.GetLength();
+		float expectedDepth = sphereA.m_radius + sphereB.m_radius - centerDist;
+		if (centerDist < CONVEX_TEST_PUSH_MARGIN || fabsf(expectedDepth) < CONVEX_TEST_TOUCHING_DEPTH)
+		{
+			continue;
+		}
+
+		ConvexContact3D contact;
+		bool isOverlapping = GetConvexShapesContact3D(sphereA, sphereB, contact);
+		bool isMatch = isOverlapping == (expectedDepth > 0.f) && fabsf(contact.m_penetrationDepth - expectedDepth) < CONVEX_TEST_POINT_TOLERANCE &&
+			(contact.m_normal - centerOffset / centerDist).GetLength() < CONVEX_TEST_POINT_TOLERANCE;
+		numMismatches += isMatch ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numMismatches == 0, Stringf("Sphere contacts differ from the exact depth and normal for %d of %d pairs", numMismatches, CONVEX_TEST_NUM_PAIRS));
+}
+
+// Every shape pairing through the public entry point
+static void TestShapePairingContacts(RandomNumberGenerator& rng)
+{
+	static char const* const s_shapeNames[4] = { "sphere", "capsule", "z-cylinder", "box" };
+	for (int typeIndexA = 0; typeIndexA < 4; ++typeIndexA)
+	{
+		for (int typeIndexB = typeIndexA; typeIndexB < 4; ++typeIndexB)
+		{
+			std::vector<ConvexShape3D> shapes(CONVEX_TEST_NUM_PAIRS * 2);
+			for (int pairIndex = 0; pairIndex < CONVEX_TEST_NUM_PAIRS; ++pairIndex)
+			{
+				shapes[pairIndex * 2] = RollRandomConvexShape3D(rng, static_cast<ConvexShapeType3D>(typeIndexA), CONVEX_TEST_SPREAD);
+				shapes[pairIndex * 2 + 1] = RollRandomConvexShape3D(rng, static_cast<ConvexShapeType3D>(typeIndexB), CONVEX_TEST_SPREAD);
+			}
+			bool areBoxes = static_cast<ConvexShapeType3D>(typeIndexA) == ConvexShapeType3D::OBB && static_cast<ConvexShapeType3D>(typeIndexB) == ConvexShapeType3D::OBB;
+			std::vector<ConvexContact3D> contacts(CONVEX_TEST_NUM_PAIRS);
+			int numOverlaps = 0;
+			double startTime = GetCurrentTimeSeconds();
+			for (int pairIndex = 0; pairIndex < CONVEX_TEST_NUM_PAIRS; ++pairIndex)
+			{
+				numOverlaps += GetConvexShapesContact3D(shapes[pairIndex * 2], shapes[pairIndex * 2 + 1], contacts[pairIndex]) ? 1 : 0;
+			}
+			double pairSeconds = GetCurrentTimeSeconds() - startTime;
+
+			int numOverlapMismatches = 0;
+			int numBadContacts = 0;
+			for (int pairIndex = 0; pairIndex < CONVEX_TEST_NUM_PAIRS; ++pairIndex)
+			{
+				ConvexShape3D const& shapeA = shapes[pairIndex * 2];
+				ConvexShape3D const& shapeB = shapes[pairIndex * 2 + 1];
+				ConvexContact3D const& contact = contacts[pairIndex];
+				if (fabsf(contact.m_penetrationDepth) > CONVEX_TEST_TOUCHING_DEPTH)
+				{
+					numOverlapMismatches += DoConvexShapesOverlap3D(shapeA, shapeB) == contact.m_isOverlapping ? 0 : 1;
+				}
+				numBadContacts += IsConvexContactValid(shapeA, shapeB, contact, !areBoxes) ? 0 : 1;
+			}
+
+			std::string pairingName = Stringf("%s vs %s", s_shapeNames[typeIndexA], s_shapeNames[typeIndexB]);
+			ENGINE_TEST_CHECK(numOverlaps > 0 && numOverlaps < CONVEX_TEST_NUM_PAIRS, Stringf("%s has %d of %d pairs overlapping, too few or too many to mean much",
+				pairingName.c_str(), numOverlaps, CONVEX_TEST_NUM_PAIRS));
+			ENGINE_TEST_CHECK(numOverlapMismatches == 0, Stringf("%s DoConvexShapesOverlap3D disagrees with the contact for %d of %d pairs", pairingName.c_str(), numOverlapMismatches,
+				CONVEX_TEST_NUM_PAIRS));
+			ENGINE_TEST_CHECK(numBadContacts == 0, Stringf("%s has %d of %d contacts breaking the normal, point or push promises", pairingName.c_str(), numBadContacts, CONVEX_TEST_NUM_PAIRS));
+			PrintEngineTestTiming(Stringf("%-24s  %6.1fns per pair, %d overlapping", pairingName.c_str(), pairSeconds * 1e9 / static_cast<double>(CONVEX_TEST_NUM_PAIRS), numOverlaps));
+		}
+	}
+}
+// -----------------------------------------------------------------------------
+void RunConvexCollisionTests()
+{
+	BeginEngineTestSection("ConvexCollision3D");
+
+	RandomNumberGenerator rng(45);
+	TestOBB3Contacts(rng);
+	TestSphereContacts(rng);
+	TestShapePairingContacts(rng);
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,203 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/Frustum3.hpp"
+#include "Engine/Math/LooseOctree3D.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+// Not a multiple of any lane width, so the last group runs with lanes switched off, and more than one job's worth
+constexpr int	FRUSTUM_TEST_NUM_ITEMS = 50021;
+constexpr float FRUSTUM_TEST_WORLD_HALF_SIZE = 500.f;
+constexpr float FRUSTUM_TEST_FAR_DIST = 400.f;
+// -----------------------------------------------------------------------------
+static int CountVisibleMismatches(std::vector<unsigned char> const& expectedVisible, std::vector<unsigned char> const& isVisible)
+{
+	int numMismatches = 0;
+	for (size_t itemIndex = 0; itemIndex < expectedVisible.size(); ++itemIndex)
+	{
+		numMismatches += expectedVisible[itemIndex] != isVisible[itemIndex] ? 1 : 0;
+	}
+	return numMismatches;
+}
+
+// The octree must report exactly the boxes the flat cull passes, each once
+static int CountOctreeMismatches(LooseOctree3D const& octree, Frustum3 const& frustum, std::vector<int> const& handles, std::vector<AABB3> const& boxes)
+{
+	std::vector<int> visibleHandles;
+	octree.GetItemsInFrustum(frustum, visibleHandles);
+	// Removed handles are reused, so every live handle stays below the item count
+	std::vector<unsigned char> numReports(boxes.size(), 0);
+	int numMismatches = 0;
+	for (int handle : visibleHandles)
+	{
+		if (handle < 0 || handle >= static_cast<int>(numReports.size()) || numReports[handle] != 0)
+		{
+			++numMismatches;
+			continue;
+		}
+		numReports[handle] = 1;
+	}
+
+	std::vector<unsigned char> isVisible(boxes.size());
+	CullAABB3sAgainstFrustum(frustum, static_cast<int>(boxes.size()), boxes.data(), isVisible.data());
+	for (size_t itemIndex = 0; itemIndex < boxes.size(); ++itemIndex)
+	{
+		numMismatches += isVisible[itemIndex] != numReports[handles[itemIndex]] ? 1 : 0;
+	}
+	return numMismatches;
+}
+// -----------------------------------------------------------------------------
+void RunFrustumCullTests()
+{
+	BeginEngineTestSection("Frustum culling");
+
+	RandomNumberGenerator rng(43);
+	std::vector<AABB3> boxes(FRUSTUM_TEST_NUM_ITEMS);
+	std::vector<Sphere3> spheres(FRUSTUM_TEST_NUM_ITEMS);
+	for (int itemIndex = 0; itemIndex < FRUSTUM_TEST_NUM_ITEMS; ++itemIndex)
+	{
+		Vec3 center(rng.RollRandomFloatInRange(-FRUSTUM_TEST_WORLD_HALF_SIZE, FRUSTUM_TEST_WORLD_HALF_SIZE),
+			rng.RollRandomFloatInRange(-FRUSTUM_TEST_WORLD_HALF_SIZE, FRUSTUM_TEST_WORLD_HALF_SIZE), rng.RollRandomFloatInRange(-20.f, 20.f));
+		Vec3 halfDimensions(rng.RollRandomFloatInRange(0.2f, 3.f), rng.RollRandomFloatInRange(0.2f, 3.f), rng.RollRandomFloatInRange(0.2f, 3.f));
+		boxes[itemIndex] = AABB3(center - halfDimensions, center + halfDimensions);
+		spheres[itemIndex] = Sphere3(center, halfDimensions.x);
+	}
+
+	// Same transforms the renderer uses: clip = renderToClip * cameraToRender * worldToCamera
+	Vec3 cameraPosition(-300.f, -50.f, 10.f);
+	EulerAngles cameraOrientation(20.f, 5.f, 0.f);
+	Mat44 cameraToWorld = Mat44::MakeTranslation3D(cameraPosition);
+	cameraToWorld.Append(cameraOrientation.GetAsMatrix_IFwd_JLeft_KUp());
+	Mat44 cameraToRender(Vec3(0.f, 0.f, 1.f), Vec3(-1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3::ZERO);
+	Mat44 worldToClip = Mat44::MakePerspectiveProjection(60.f, 16.f / 9.f, 0.1f, FRUSTUM_TEST_FAR_DIST);
+	worldToClip.Append(cameraToRender);
+	worldToClip.Append(cameraToWorld.GetOrthonormalInverse());
+	Frustum3 frustum = Frustum3::MakeFromWorldToClipTransform(worldToClip);
+
+	Vec3 cameraFwd;
+	Vec3 cameraLeft;
+	Vec3 cameraUp;
+	cameraOrientation.GetAsVectors_IFwd_JLeft_KUp(cameraFwd, cameraLeft, cameraUp);
+	ENGINE_TEST_CHECK(frustum.IsPointInside(cameraPosition + cameraFwd * 50.f), "A point straight ahead of the camera is outside the frustum");
+	ENGINE_TEST_CHECK(!frustum.IsPointInside(cameraPosition - cameraFwd * 50.f), "A point behind the camera is inside the frustum");
+	ENGINE_TEST_CHECK(!frustum.IsPointInside(cameraPosition + cameraFwd * (FRUSTUM_TEST_FAR_DIST + 10.f)), "A point past the far plane is inside the frustum");
+	ENGINE_TEST_CHECK(!frustum.IsPointInside(cameraPosition + cameraFwd * 50.f + cameraLeft * 60.f), "A point well left of the 60 degree view is inside the frustum");
+
+	// One by one tests, the answer every batch cull must give
+	std::vector<unsigned char> expectedBoxVisible(FRUSTUM_TEST_NUM_ITEMS);
+	std::vector<unsigned char> expectedSphereVisible(FRUSTUM_TEST_NUM_ITEMS);
+	int numBoxesVisible = 0;
+	int numOverlapMismatches = 0;
+	int numBadInsides = 0;
+	double startTime = GetCurrentTimeSeconds();
+	for (int itemIndex = 0; itemIndex < FRUSTUM_TEST_NUM_ITEMS; ++itemIndex)
+	{
+		expectedBoxVisible[itemIndex] = frustum.DoesOverlapAABB3(boxes[itemIndex]) ? 1 : 0;
+	}
+	double boxScalarSeconds = GetCurrentTimeSeconds() - startTime;
+	startTime = GetCurrentTimeSeconds();
+	for (int itemIndex = 0; itemIndex < FRUSTUM_TEST_NUM_ITEMS; ++itemIndex)
+	{
+		expectedSphereVisible[itemIndex] = frustum.DoesOverlapSphere(spheres[itemIndex].m_center, spheres[itemIndex].m_radius) ? 1 : 0;
+	}
+	double sphereScalarSeconds = GetCurrentTimeSeconds() - startTime;
+
+	for (int itemIndex = 0; itemIndex < FRUSTUM_TEST_NUM_ITEMS; ++itemIndex)
+	{
+		AABB3 const& box = boxes[itemIndex];
+		numBoxesVisible += expectedBoxVisible[itemIndex];
+		FrustumOverlap overlap = frustum.GetOverlapWithAABB3(box);
+		numOverlapMismatches += (overlap != FrustumOverlap::OUTSIDE) == (expectedBoxVisible[itemIndex] != 0) ? 0 : 1;
+		if (overlap == FrustumOverlap::INSIDE)
+		{
+			for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+			{
+				Vec3 corner((cornerIndex & 1) ? box.m_maxs.x : box.m_mins.x, (cornerIndex & 2) ? box.m_maxs.y : box.m_mins.y, (cornerIndex & 4) ? box.m_maxs.z : box.m_mins.z);
+				if (!frustum.IsPointInside(corner))
+				{
+					++numBadInsides;
+					break;
+				}
+			}
+		}
+	}
+	ENGINE_TEST_CHECK(numBoxesVisible > 0 && numBoxesVisible < FRUSTUM_TEST_NUM_ITEMS, Stringf("%d of %d boxes are visible, too few or too many to mean much",
+		numBoxesVisible, FRUSTUM_TEST_NUM_ITEMS));
+	ENGINE_TEST_CHECK(numOverlapMismatches == 0, Stringf("GetOverlapWithAABB3 and DoesOverlapAABB3 disagree on %d boxes", numOverlapMismatches));
+	ENGINE_TEST_CHECK(numBadInsides == 0, Stringf("%d boxes are reported INSIDE with a corner outside the frustum", numBadInsides));
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	std::vector<unsigned char> isVisible(FRUSTUM_TEST_NUM_ITEMS);
+	startTime = GetCurrentTimeSeconds();
+	CullAABB3sAgainstFrustum(frustum, FRUSTUM_TEST_NUM_ITEMS, boxes.data(), isVisible.data());
+	double boxBatchSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(CountVisibleMismatches(expectedBoxVisible, isVisible) == 0, "CullAABB3sAgainstFrustum differs from DoesOverlapAABB3");
+	isVisible.assign(FRUSTUM_TEST_NUM_ITEMS, 2);
+	CullAABB3sAgainstFrustum(frustum, FRUSTUM_TEST_NUM_ITEMS, boxes.data(), isVisible.data(), &jobSystem);
+	ENGINE_TEST_CHECK(CountVisibleMismatches(expectedBoxVisible, isVisible) == 0, "CullAABB3sAgainstFrustum across the job system differs from DoesOverlapAABB3");
+
+	isVisible.assign(FRUSTUM_TEST_NUM_ITEMS, 2);
+	startTime = GetCurrentTimeSeconds();
+	CullSphere3sAgainstFrustum(frustum, FRUSTUM_TEST_NUM_ITEMS, spheres.data(), isVisible.data());
+	double sphereBatchSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(CountVisibleMismatches(expectedSphereVisible, isVisible) == 0, "CullSphere3sAgainstFrustum differs from DoesOverlapSphere");
+	isVisible.assign(FRUSTUM_TEST_NUM_ITEMS, 2);
+	CullSphere3sAgainstFrustum(frustum, FRUSTUM_TEST_NUM_ITEMS, spheres.data(), isVisible.data(), &jobSystem);
+	ENGINE_TEST_CHECK(CountVisibleMismatches(expectedSphereVisible, isVisible) == 0, "CullSphere3sAgainstFrustum across the job system differs from DoesOverlapSphere");
+
+	jobSystem.Shutdown();
+
+	// Loose octree query against the flat cull, then again after moving and replacing some of the boxes
+	AABB3 worldBounds(Vec3(-FRUSTUM_TEST_WORLD_HALF_SIZE, -FRUSTUM_TEST_WORLD_HALF_SIZE, -FRUSTUM_TEST_WORLD_HALF_SIZE),
+		Vec3(FRUSTUM_TEST_WORLD_HALF_SIZE, FRUSTUM_TEST_WORLD_HALF_SIZE, FRUSTUM_TEST_WORLD_HALF_SIZE));
+	LooseOctree3D octree(worldBounds, 6);
+	std::vector<int> handles(FRUSTUM_TEST_NUM_ITEMS);
+	startTime = GetCurrentTimeSeconds();
+	for (int itemIndex = 0; itemIndex < FRUSTUM_TEST_NUM_ITEMS; ++itemIndex)
+	{
+		handles[itemIndex] = octree.Insert(boxes[itemIndex]);
+	}
+	double insertSeconds = GetCurrentTimeSeconds() - startTime;
+
+	std::vector<int> visibleHandles;
+	visibleHandles.reserve(FRUSTUM_TEST_NUM_ITEMS);
+	startTime = GetCurrentTimeSeconds();
+	octree.GetItemsInFrustum(frustum, visibleHandles);
+	double querySeconds = GetCurrentTimeSeconds() - startTime;
+	int numOctreeMismatches = CountOctreeMismatches(octree, frustum, handles, boxes);
+	ENGINE_TEST_CHECK(static_cast<int>(visibleHandles.size()) == numBoxesVisible, Stringf("Octree reports %d visible boxes, the flat cull %d", static_cast<int>(visibleHandles.size()),
+		numBoxesVisible));
+	ENGINE_TEST_CHECK(numOctreeMismatches == 0, Stringf("Octree frustum query differs from the flat cull for %d boxes", numOctreeMismatches));
+
+	for (int itemIndex = 0; itemIndex < FRUSTUM_TEST_NUM_ITEMS; itemIndex += 3)
+	{
+		Vec3 offset(rng.RollRandomFloatInRange(-40.f, 40.f), rng.RollRandomFloatInRange(-40.f, 40.f), rng.RollRandomFloatInRange(-5.f, 5.f));
+		boxes[itemIndex] = AABB3(boxes[itemIndex].m_mins + offset, boxes[itemIndex].m_maxs + offset);
+		if (itemIndex % 2 == 0)
+		{
+			octree.Move(handles[itemIndex], boxes[itemIndex]);
+		}
+		else
+		{
+			octree.Remove(handles[itemIndex]);
+			handles[itemIndex] = octree.Insert(boxes[itemIndex]);
+		}
+	}
+	int numChangedMismatches = CountOctreeMismatches(octree, frustum, handles, boxes);
+	ENGINE_TEST_CHECK(octree.GetNumItems() == FRUSTUM_TEST_NUM_ITEMS, Stringf("Octree holds %d items after Move and Remove, expected %d", octree.GetNumItems(), FRUSTUM_TEST_NUM_ITEMS));
+	ENGINE_TEST_CHECK(numChangedMismatches == 0, Stringf("Octree frustum query after Move and Remove differs from the flat cull for %d boxes", numChangedMismatches));
+
+	PrintEngineTestTiming(Stringf("%-8s one by one %7.3fms  batch %7.3fms  %5.2fx  %d visible", "AABB3", boxScalarSeconds * 1000.0, boxBatchSeconds * 1000.0,
+		boxBatchSeconds > 0.0 ? boxScalarSeconds / boxBatchSeconds : 0.0, numBoxesVisible));
+	PrintEngineTestTiming(Stringf("%-8s one by one %7.3fms  batch %7.3fms  %5.2fx", "Sphere3", sphereScalarSeconds * 1000.0, sphereBatchSeconds * 1000.0,
+		sphereBatchSeconds > 0.0 ? sphereScalarSeconds / sphereBatchSeconds : 0.0));
+	PrintEngineTestTiming(Stringf("%-8s insert %7.3fms  frustum query %7.3fms", "Octree", insertSeconds * 1000.0, querySeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
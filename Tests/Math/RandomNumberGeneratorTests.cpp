@@ -0,0 +1,165 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Math/SIMDMath.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Not a multiple of any lane width or of the direction batch size, so every fill ends part way through a packet
+constexpr int			RANDOM_TEST_NUM_VALUES = (1 << 20) + 3;
+constexpr unsigned int	RANDOM_TEST_SEED = 49;
+// -----------------------------------------------------------------------------
+template <typename ValueType>
+static bool AreValuesBitIdentical(std::vector<ValueType> const& valuesA, std::vector<ValueType> const& valuesB)
+{
+	return valuesA.size() == valuesB.size() && memcmp(valuesA.data(), valuesB.data(), valuesA.size() * sizeof(ValueType)) == 0;
+}
+
+// Rolls one value at a time and fills the same count from a second generator, which must give the same bits and
+// leave both generators at the same position
+template <typename ValueType, typename RollValue, typename FillValues>
+static void TestFillMatchesRolls(char const* valueName, int numValues, RollValue const& rollValue, FillValues const& fillValues)
+{
+	RandomNumberGenerator rollingRng(RANDOM_TEST_SEED, 17);
+	std::vector<ValueType> rolledValues(numValues);
+	double startTime = GetCurrentTimeSeconds();
+	for (ValueType& value : rolledValues)
+	{
+		value = rollValue(rollingRng);
+	}
+	double rollSeconds = GetCurrentTimeSeconds() - startTime;
+
+	RandomNumberGenerator fillingRng(RANDOM_TEST_SEED, 17);
+	std::vector<ValueType> filledValues(numValues);
+	startTime = GetCurrentTimeSeconds();
+	fillValues(fillingRng, filledValues.data(), numValues);
+	double fillSeconds = GetCurrentTimeSeconds() - startTime;
+
+	ENGINE_TEST_CHECK(AreValuesBitIdentical(rolledValues, filledValues), Stringf("Filled %s differ from the same number of single rolls", valueName));
+	ENGINE_TEST_CHECK(fillingRng.GetPosition() == rollingRng.GetPosition(), Stringf("Filling %s left the generator at %u, rolling left it at %u", valueName,
+		fillingRng.GetPosition(), rollingRng.GetPosition()));
+	PrintEngineTestTiming(Stringf("%-10s rolls %6.2fns  fill %6.2fns  %5.2fx", valueName, rollSeconds * 1e9 / static_cast<double>(numValues),
+		fillSeconds * 1e9 / static_cast<double>(numValues), fillSeconds > 0.0 ? rollSeconds / fillSeconds : 0.0));
+}
+
+static void TestFills()
+{
+	TestFillMatchesRolls<unsigned int>("uints", RANDOM_TEST_NUM_VALUES,
+		[](RandomNumberGenerator& rng) { return rng.RollRandomUint(); },
+		[](RandomNumberGenerator& rng, unsigned int* out_values, int numValues) { rng.FillRandomUints(out_values, numValues); });
+	TestFillMatchesRolls<int>("ints", RANDOM_TEST_NUM_VALUES,
+		[](RandomNumberGenerator& rng) { return rng.RollRandomIntInRange(-50, 49); },
+		[](RandomNumberGenerator& rng, int* out_values, int numValues) { rng.FillRandomIntsInRange(out_values, numValues, -50, 49); });
+	TestFillMatchesRolls<float>("floats", RANDOM_TEST_NUM_VALUES,
+		[](RandomNumberGenerator& rng) { return rng.RollRandomFloatInRange(-3.f, 5.f); },
+		[](RandomNumberGenerator& rng, float* out_values, int numValues) { rng.FillRandomFloatsInRange(out_values, numValues, -3.f, 5.f); });
+	TestFillMatchesRolls<Vec3>("directions", RANDOM_TEST_NUM_VALUES / 4,
+		[](RandomNumberGenerator& rng) { return rng.RollRandomDirection3D(); },
+		[](RandomNumberGenerator& rng, Vec3* out_values, int numValues) { rng.FillRandomDirections3D(out_values, numValues); });
+
+	// What the rolls replaced, for scale
+	std::vector<float> randValues(RANDOM_TEST_NUM_VALUES);
+	double startTime = GetCurrentTimeSeconds();
+	for (float& value : randValues)
+	{
+		value = static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+	}
+	double randSeconds = GetCurrentTimeSeconds() - startTime;
+	PrintEngineTestTiming(Stringf("rand()     floats %6.2fns", randSeconds * 1e9 / static_cast<double>(RANDOM_TEST_NUM_VALUES)));
+}
+
+// Ranges are respected and filled evenly, and directions are unit length and centered
+static void TestDistributions()
+{
+	RandomNumberGenerator rng(RANDOM_TEST_SEED);
+	std::vector<int> ints(RANDOM_TEST_NUM_VALUES);
+	rng.FillRandomIntsInRange(ints.data(), RANDOM_TEST_NUM_VALUES, -50, 49);
+	int counts[100] = {};
+	int numIntsOutOfRange = 0;
+	for (int value : ints)
+	{
+		bool isInRange = value >= -50 && value <= 49;
+		numIntsOutOfRange += isInRange ? 0 : 1;
+		counts[isInRange ? value + 50 : 0]++;
+	}
+	int expectedCount = RANDOM_TEST_NUM_VALUES / 100;
+	int numUnevenCounts = 0;
+	for (int count : counts)
+	{
+		numUnevenCounts += abs(count - expectedCount) < expectedCount / 20 ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numIntsOutOfRange == 0, Stringf("%d of %d ints fell outside [-50, 49]", numIntsOutOfRange, RANDOM_TEST_NUM_VALUES));
+	ENGINE_TEST_CHECK(numUnevenCounts == 0, Stringf("%d of 100 int values were rolled more than 5%% away from %d times", numUnevenCounts, expectedCount));
+
+	std::vector<float> floats(RANDOM_TEST_NUM_VALUES);
+	rng.FillRandomFloatsInRange(floats.data(), RANDOM_TEST_NUM_VALUES, -3.f, 5.f);
+	int numFloatsOutOfRange = 0;
+	double floatSum = 0.0;
+	for (float value : floats)
+	{
+		numFloatsOutOfRange += value >= -3.f && value <= 5.f ? 0 : 1;
+		floatSum += static_cast<double>(value);
+	}
+	double floatMean = floatSum / static_cast<double>(RANDOM_TEST_NUM_VALUES);
+	ENGINE_TEST_CHECK(numFloatsOutOfRange == 0, Stringf("%d of %d floats fell outside [-3, 5]", numFloatsOutOfRange, RANDOM_TEST_NUM_VALUES));
+	ENGINE_TEST_CHECK(fabs(floatMean - 1.0) < 0.01, Stringf("Floats in [-3, 5] average %.4f, expected 1", floatMean));
+
+	int numDirections = RANDOM_TEST_NUM_VALUES / 4;
+	std::vector<Vec3> directions(numDirections);
+	rng.FillRandomDirections3D(directions.data(), numDirections);
+	int numNonUnitDirections = 0;
+	Vec3 directionSum;
+	for (Vec3 const& direction : directions)
+	{
+		numNonUnitDirections += fabsf(direction.GetLength() - 1.f) < 1e-4f ? 0 : 1;
+		directionSum += direction;
+	}
+	Vec3 directionMean = directionSum / static_cast<float>(numDirections);
+	ENGINE_TEST_CHECK(numNonUnitDirections == 0, Stringf("%d of %d directions are not unit length", numNonUnitDirections, numDirections));
+	ENGINE_TEST_CHECK(directionMean.GetLength() < 0.01f, Stringf("Directions average (%.4f, %.4f, %.4f), expected about zero", directionMean.x, directionMean.y, directionMean.z));
+}
+
+// Seeds and positions replay sequences, streams and default generators do not share them
+static void TestSeedsAndStreams()
+{
+	RandomNumberGenerator rng(RANDOM_TEST_SEED);
+	unsigned int rolls[8];
+	for (unsigned int& roll : rolls)
+	{
+		roll = rng.RollRandomUint();
+	}
+	RandomNumberGenerator replayRng(RANDOM_TEST_SEED, 5);
+	rng.SetPosition(3);
+	bool doesPositionReplay = replayRng.RollRandomUint() == rolls[5] && rng.RollRandomUint() == rolls[3];
+	rng.SetSeed(RANDOM_TEST_SEED);
+	bool doesSeedRestart = rng.GetPosition() == 0 && rng.RollRandomUint() == rolls[0];
+	ENGINE_TEST_CHECK(doesPositionReplay, "A generator set to a position does not roll what the sequence rolled there");
+	ENGINE_TEST_CHECK(doesSeedRestart, "SetSeed does not restart the sequence");
+
+	RandomNumberGenerator streamA = rng.GetStream(0);
+	RandomNumberGenerator streamB = rng.GetStream(1);
+	RandomNumberGenerator streamARepeat = RandomNumberGenerator(RANDOM_TEST_SEED, 1234).GetStream(0);
+	ENGINE_TEST_CHECK(streamA.GetSeed() != streamB.GetSeed() && streamA.GetSeed() != rng.GetSeed(), "GetStream gave two streams, or a stream and its parent, the same seed");
+	ENGINE_TEST_CHECK(streamA.GetSeed() == streamARepeat.GetSeed() && streamA.GetPosition() == 0, "GetStream depends on more than the seed and stream index");
+
+	RandomNumberGenerator defaultRngA;
+	RandomNumberGenerator defaultRngB;
+	ENGINE_TEST_CHECK(defaultRngA.GetSeed() != defaultRngB.GetSeed(), "Two default generators got the same seed");
+}
+// -----------------------------------------------------------------------------
+void RunRandomNumberGeneratorTests()
+{
+	int numFillLanes = 1;
+#if defined( ENGINE_SIMD_WIDE_INT )
+	numFillLanes = SIMD_WIDE_NUM_LANES;
+#endif
+	BeginEngineTestSection(Stringf("RandomNumberGenerator, %d lane fills", numFillLanes).c_str());
+
+	TestFills();
+	TestDistributions();
+	TestSeedsAndStreams();
+}
+// -----------------------------------------------------------------------------
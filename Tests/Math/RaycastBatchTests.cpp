@@ -0,0 +1,146 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Math/SIMDMath.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Not a multiple of any packet width, so the last packet runs with lanes switched off
+constexpr int RAYCAST_TEST_NUM_RAYS = 4093;
+constexpr int RAYCAST_TEST_NUM_PRIMITIVES = 1024;
+// -----------------------------------------------------------------------------
+// Every ray against every primitive through the single ray function, the answer the batch functions must give
+template <typename SingleRaycast>
+static void RaycastEveryPrimitive(std::vector<Ray3> const& rays, std::vector<RaycastHit3D>& out_hits, SingleRaycast const& singleRaycast)
+{
+	out_hits.assign(rays.size(), RaycastHit3D());
+	for (int rayIndex = 0; rayIndex < static_cast<int>(rays.size()); ++rayIndex)
+	{
+		RaycastHit3D& nearestHit = out_hits[rayIndex];
+		for (int primitiveIndex = 0; primitiveIndex < RAYCAST_TEST_NUM_PRIMITIVES; ++primitiveIndex)
+		{
+			RaycastResult3D result = singleRaycast(rays[rayIndex], primitiveIndex);
+			if (result.m_didImpact && (!nearestHit.DidImpact() || result.m_impactDist < nearestHit.m_impactDist))
+			{
+				nearestHit.m_primitiveIndex = primitiveIndex;
+				nearestHit.m_impactDist = result.m_impactDist;
+			}
+		}
+	}
+}
+
+// Runs one primitive type through both modes, checking each against the single ray results
+template <typename SingleRaycast, typename BatchRaycast>
+static void TestRaycastBatch(char const* primitiveName, std::vector<Ray3> const& rays, SingleRaycast const& singleRaycast, BatchRaycast const& batchRaycast)
+{
+	int numRays = static_cast<int>(rays.size());
+	std::vector<RaycastHit3D> expectedHits;
+	double startTime = GetCurrentTimeSeconds();
+	RaycastEveryPrimitive(rays, expectedHits, singleRaycast);
+	double singleSeconds = GetCurrentTimeSeconds() - startTime;
+
+	std::vector<RaycastHit3D> nearestHits(numRays);
+	startTime = GetCurrentTimeSeconds();
+	batchRaycast(nearestHits.data(), RaycastBatchMode::NEAREST_HIT);
+	double nearestSeconds = GetCurrentTimeSeconds() - startTime;
+
+	std::vector<RaycastHit3D> anyHits(numRays);
+	startTime = GetCurrentTimeSeconds();
+	batchRaycast(anyHits.data(), RaycastBatchMode::ANY_HIT);
+	double anyHitSeconds = GetCurrentTimeSeconds() - startTime;
+
+	// Nearest hits agree when both missed or both hit at nearly the same distance. The primitive may differ where
+	// two are hit at the same distance, and the packet kernels round differently right at grazing hits.
+	int numNearestMismatches = 0;
+	int numAnyHitMismatches = 0;
+	int numExpectedHits = 0;
+	for (int rayIndex = 0; rayIndex < numRays; ++rayIndex)
+	{
+		RaycastHit3D const& expected = expectedHits[rayIndex];
+		RaycastHit3D const& nearest = nearestHits[rayIndex];
+		RaycastHit3D const& anyHit = anyHits[rayIndex];
+		numExpectedHits += expected.DidImpact() ? 1 : 0;
+		if (expected.DidImpact() != nearest.DidImpact() || fabsf(expected.m_impactDist - nearest.m_impactDist) > 0.001f)
+		{
+			++numNearestMismatches;
+		}
+
+		// Any hit only promises some primitive that really blocks the ray
+		bool anyHitIsReal = !anyHit.DidImpact() || singleRaycast(rays[rayIndex], anyHit.m_primitiveIndex).m_didImpact;
+		if (expected.DidImpact() != anyHit.DidImpact() || !anyHitIsReal)
+		{
+			++numAnyHitMismatches;
+		}
+	}
+
+	ENGINE_TEST_CHECK(numExpectedHits > numRays / 20 && numExpectedHits < numRays, Stringf("%s test scene has %d of %d rays hitting, too few or too many to mean much",
+		primitiveName, numExpectedHits, numRays));
+	ENGINE_TEST_CHECK(numNearestMismatches == 0, Stringf("%s nearest hit batch disagrees with the single ray function for %d of %d rays", primitiveName, numNearestMismatches, numRays));
+	ENGINE_TEST_CHECK(numAnyHitMismatches == 0, Stringf("%s any hit batch disagrees with the single ray function for %d of %d rays", primitiveName, numAnyHitMismatches, numRays));
+
+	double numTests = static_cast<double>(numRays) * static_cast<double>(RAYCAST_TEST_NUM_PRIMITIVES);
+	PrintEngineTestTiming(Stringf("%-7s single %7.2fms  batch %7.2fms  %5.2fx  (%.2fns per test)  any hit %7.2fms", primitiveName, singleSeconds * 1000.0,
+		nearestSeconds * 1000.0, nearestSeconds > 0.0 ? singleSeconds / nearestSeconds : 0.0, nearestSeconds * 1e9 / numTests, anyHitSeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
+void RunRaycastBatchTests()
+{
+#if defined( ENGINE_SIMD_SCALAR )
+	int numLanes = 1;
+#else
+	int numLanes = SIMD_WIDE_NUM_LANES;
+#endif
+	BeginEngineTestSection(Stringf("Batch raycasts, %d lane packets", numLanes).c_str());
+
+	RandomNumberGenerator rng(39);
+	std::vector<Ray3> rays(RAYCAST_TEST_NUM_RAYS);
+	for (int rayIndex = 0; rayIndex < RAYCAST_TEST_NUM_RAYS; ++rayIndex)
+	{
+		Vec3 startPos(rng.RollRandomFloatInRange(-60.f, 60.f), rng.RollRandomFloatInRange(-60.f, 60.f), rng.RollRandomFloatInRange(-60.f, 60.f));
+		Vec3 fwdNormal(rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f));
+		rays[rayIndex] = Ray3(startPos, fwdNormal.GetNormalized(), rng.RollRandomFloatInRange(10.f, 80.f));
+	}
+
+	std::vector<AABB3>	 boxes(RAYCAST_TEST_NUM_PRIMITIVES);
+	std::vector<Sphere3> spheres(RAYCAST_TEST_NUM_PRIMITIVES);
+	std::vector<OBB3>	 orientedBoxes(RAYCAST_TEST_NUM_PRIMITIVES);
+	for (int primitiveIndex = 0; primitiveIndex < RAYCAST_TEST_NUM_PRIMITIVES; ++primitiveIndex)
+	{
+		Vec3 center(rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f));
+		Vec3 halfDimensions(rng.RollRandomFloatInRange(0.2f, 2.f), rng.RollRandomFloatInRange(0.2f, 2.f), rng.RollRandomFloatInRange(0.2f, 2.f));
+		boxes[primitiveIndex] = AABB3(center - halfDimensions, center + halfDimensions);
+		spheres[primitiveIndex] = Sphere3(center, halfDimensions.x);
+
+		EulerAngles orientation(rng.RollRandomFloatInRange(0.f, 360.f), rng.RollRandomFloatInRange(-90.f, 90.f), rng.RollRandomFloatInRange(0.f, 360.f));
+		Vec3 iBasis;
+		Vec3 jBasis;
+		Vec3 kBasis;
+		orientation.GetAsVectors_IFwd_JLeft_KUp(iBasis, jBasis, kBasis);
+		orientedBoxes[primitiveIndex] = OBB3(center, iBasis, jBasis, kBasis, halfDimensions);
+	}
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	int numRays = RAYCAST_TEST_NUM_RAYS;
+	int numPrimitives = RAYCAST_TEST_NUM_PRIMITIVES;
+	TestRaycastBatch("AABB3", rays,
+		[&](Ray3 const& ray, int index) { return RaycastVsAABB3D(ray.m_startPos, ray.m_fwdNormal, ray.m_maxLength, boxes[index]); },
+		[&](RaycastHit3D* out_hits, RaycastBatchMode mode) { RaycastBatchVsAABB3Ds(numRays, rays.data(), numPrimitives, boxes.data(), out_hits, mode, &jobSystem); });
+
+	TestRaycastBatch("Sphere3", rays,
+		[&](Ray3 const& ray, int index) { return RaycastVsSphere3D(ray.m_startPos, ray.m_fwdNormal, ray.m_maxLength, spheres[index].m_center, spheres[index].m_radius); },
+		[&](RaycastHit3D* out_hits, RaycastBatchMode mode) { RaycastBatchVsSphere3Ds(numRays, rays.data(), numPrimitives, spheres.data(), out_hits, mode, &jobSystem); });
+
+	TestRaycastBatch("OBB3", rays,
+		[&](Ray3 const& ray, int index) { return RaycastVsOBB3D(ray.m_startPos, ray.m_fwdNormal, ray.m_maxLength, orientedBoxes[index]); },
+		[&](RaycastHit3D* out_hits, RaycastBatchMode mode) { RaycastBatchVsOBB3Ds(numRays, rays.data(), numPrimitives, orientedBoxes.data(), out_hits, mode, &jobSystem); });
+
+	jobSystem.Shutdown();
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,118 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/SIMDMath.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include <cstring>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int MATH_TEST_NUM_INPUTS = 1024;		// Power of two, small enough to stay in cache
+constexpr int MATH_TEST_NUM_ITERATIONS = 200000;
+// -----------------------------------------------------------------------------
+struct MathOperationTiming
+{
+	double m_scalarSeconds = 0.0;
+	double m_simdSeconds = 0.0;
+	int	   m_numMismatches = 0;
+};
+// -----------------------------------------------------------------------------
+// The scalar formulas the vector paths must reproduce bit for bit, kept here so the comparison
+// still means something when the members themselves are built with SIMD enabled
+static Vec4 const TransformHomogeneous3DScalar(Mat44 const& matrix, Vec4 const& p)
+{
+	float const* m = matrix.m_values;
+	float x = (m[Mat44::Ix] * p.x) + (m[Mat44::Jx] * p.y) + (m[Mat44::Kx] * p.z) + (m[Mat44::Tx] * p.w);
+	float y = (m[Mat44::Iy] * p.x) + (m[Mat44::Jy] * p.y) + (m[Mat44::Ky] * p.z) + (m[Mat44::Ty] * p.w);
+	float z = (m[Mat44::Iz] * p.x) + (m[Mat44::Jz] * p.y) + (m[Mat44::Kz] * p.z) + (m[Mat44::Tz] * p.w);
+	float w = (m[Mat44::Iw] * p.x) + (m[Mat44::Jw] * p.y) + (m[Mat44::Kw] * p.z) + (m[Mat44::Tw] * p.w);
+	return Vec4(x, y, z, w);
+}
+// -----------------------------------------------------------------------------
+// Runs both versions over the same inputs, timing each and comparing every result bitwise
+template <typename ResultType, typename ScalarFunction, typename SIMDFunction>
+static MathOperationTiming TimeMathOperation(ScalarFunction const& scalarFunction, SIMDFunction const& simdFunction)
+{
+	MathOperationTiming timing;
+	std::vector<ResultType> scalarResults(MATH_TEST_NUM_INPUTS);
+	std::vector<ResultType> simdResults(MATH_TEST_NUM_INPUTS);
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int iteration = 0; iteration < MATH_TEST_NUM_ITERATIONS; ++iteration)
+	{
+		int inputIndex = iteration & (MATH_TEST_NUM_INPUTS - 1);
+		scalarResults[inputIndex] = scalarFunction(inputIndex);
+	}
+	timing.m_scalarSeconds = GetCurrentTimeSeconds() - startTime;
+
+	startTime = GetCurrentTimeSeconds();
+	for (int iteration = 0; iteration < MATH_TEST_NUM_ITERATIONS; ++iteration)
+	{
+		int inputIndex = iteration & (MATH_TEST_NUM_INPUTS - 1);
+		simdResults[inputIndex] = simdFunction(inputIndex);
+	}
+	timing.m_simdSeconds = GetCurrentTimeSeconds() - startTime;
+
+	for (int inputIndex = 0; inputIndex < MATH_TEST_NUM_INPUTS; ++inputIndex)
+	{
+		if (memcmp(&scalarResults[inputIndex], &simdResults[inputIndex], sizeof(ResultType)) != 0)
+		{
+			++timing.m_numMismatches;
+		}
+	}
+	return timing;
+}
+
+static void CheckMathOperation(char const* operationName, MathOperationTiming const& timing)
+{
+	ENGINE_TEST_CHECK(timing.m_numMismatches == 0, Stringf("%s differs from the scalar formulas for %d of %d inputs", operationName, timing.m_numMismatches, MATH_TEST_NUM_INPUTS));
+
+	double scalarNanoseconds = timing.m_scalarSeconds * 1e9 / static_cast<double>(MATH_TEST_NUM_ITERATIONS);
+	double simdNanoseconds = timing.m_simdSeconds * 1e9 / static_cast<double>(MATH_TEST_NUM_ITERATIONS);
+	PrintEngineTestTiming(Stringf("%-26s scalar %6.2fns  simd %6.2fns  %5.2fx", operationName, scalarNanoseconds, simdNanoseconds,
+		simdNanoseconds > 0.0 ? scalarNanoseconds / simdNanoseconds : 0.0));
+}
+// -----------------------------------------------------------------------------
+void RunSIMDMathTests()
+{
+#if defined( ENGINE_SIMD_SSE )
+	char const* pathName = "SSE";
+#if defined( __AVX__ )
+	pathName = "SSE + AVX";
+#endif
+#elif defined( ENGINE_SIMD_NEON )
+	char const* pathName = "NEON";
+#else
+	char const* pathName = "scalar (SIMD disabled)";
+#endif
+	BeginEngineTestSection(Stringf("SIMD math, %s path", pathName).c_str());
+
+	RandomNumberGenerator rng(37);
+	std::vector<Mat44> matrices(MATH_TEST_NUM_INPUTS);
+	std::vector<Vec4>  vectors(MATH_TEST_NUM_INPUTS);
+	for (int inputIndex = 0; inputIndex < MATH_TEST_NUM_INPUTS; ++inputIndex)
+	{
+		for (int valueIndex = 0; valueIndex < 16; ++valueIndex)
+		{
+			matrices[inputIndex].m_values[valueIndex] = rng.RollRandomFloatInRange(-10.f, 10.f);
+		}
+		vectors[inputIndex] = Vec4(rng.RollRandomFloatInRange(-100.f, 100.f), rng.RollRandomFloatInRange(-100.f, 100.f), rng.RollRandomFloatInRange(-100.f, 100.f), rng.RollRandomFloatInRange(-1.f, 1.f));
+	}
+
+	CheckMathOperation("Mat44 Transpose", TimeMathOperation<Mat44>(
+		[&](int index)
+		{
+			Mat44 transposed;
+			for (int valueIndex = 0; valueIndex < 16; ++valueIndex)
+			{
+				transposed.m_values[(valueIndex & 3) * 4 + (valueIndex >> 2)] = matrices[index].m_values[valueIndex];
+			}
+			return transposed;
+		},
+		[&](int index) { Mat44 matrix = matrices[index]; matrix.Transpose(); return matrix; }));
+
+	CheckMathOperation("TransformHomogeneous3D", TimeMathOperation<Vec4>(
+		[&](int index) { return TransformHomogeneous3DScalar(matrices[index], vectors[index]); },
+		[&](int index) { return matrices[index].TransformHomogeneous3D(vectors[index]); }));
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,150 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/SmoothNoise.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <cstring>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Row lengths that are not a multiple of any lane width, so every row ends in a partial packet
+constexpr int			SMOOTH_NOISE_TEST_GRID_2D_SIZE_X = 253;
+constexpr int			SMOOTH_NOISE_TEST_GRID_2D_SIZE_Y = 256;
+constexpr int			SMOOTH_NOISE_TEST_GRID_3D_SIZE = 47;
+constexpr float			SMOOTH_NOISE_TEST_SAMPLE_SPACING = 0.37f;
+constexpr float			SMOOTH_NOISE_TEST_SCALE = 23.f;
+constexpr unsigned int	SMOOTH_NOISE_TEST_SEED = 48;
+// -----------------------------------------------------------------------------
+// Which grid fill and settings to run, with the single sample function the grid must match bit for bit
+struct SmoothNoiseTestCase
+{
+	char const*	 m_name = nullptr;
+	bool		 m_isPerlin = false;
+	bool		 m_is3d = false;
+	unsigned int m_numOctaves = 6;
+	bool		 m_renormalize = true;
+};
+// -----------------------------------------------------------------------------
+static float GetSingleNoiseSample(SmoothNoiseTestCase const& testCase, Vec3 const& position, unsigned int seed)
+{
+	if (testCase.m_is3d)
+	{
+		return testCase.m_isPerlin ? Compute3dPerlinNoise(position.x, position.y, position.z, SMOOTH_NOISE_TEST_SCALE, testCase.m_numOctaves, 0.5f, 2.f, testCase.m_renormalize, seed) :
+			Compute3dFractalNoise(position.x, position.y, position.z, SMOOTH_NOISE_TEST_SCALE, testCase.m_numOctaves, 0.5f, 2.f, testCase.m_renormalize, seed);
+	}
+	return testCase.m_isPerlin ? Compute2dPerlinNoise(position.x, position.y, SMOOTH_NOISE_TEST_SCALE, testCase.m_numOctaves, 0.5f, 2.f, testCase.m_renormalize, seed) :
+		Compute2dFractalNoise(position.x, position.y, SMOOTH_NOISE_TEST_SCALE, testCase.m_numOctaves, 0.5f, 2.f, testCase.m_renormalize, seed);
+}
+
+static void FillNoiseGrid(SmoothNoiseTestCase const& testCase, Vec3 const& origin, unsigned int seed, float* out_values, JobSystem* jobSystem)
+{
+	int gridSizeX = testCase.m_is3d ? SMOOTH_NOISE_TEST_GRID_3D_SIZE : SMOOTH_NOISE_TEST_GRID_2D_SIZE_X;
+	int gridSizeY = testCase.m_is3d ? SMOOTH_NOISE_TEST_GRID_3D_SIZE : SMOOTH_NOISE_TEST_GRID_2D_SIZE_Y;
+	float spacing = SMOOTH_NOISE_TEST_SAMPLE_SPACING;
+	float scale = SMOOTH_NOISE_TEST_SCALE;
+	unsigned int numOctaves = testCase.m_numOctaves;
+	bool renormalize = testCase.m_renormalize;
+	if (testCase.m_is3d && testCase.m_isPerlin)
+	{
+		Compute3dPerlinNoiseGrid(out_values, gridSizeX, gridSizeY, SMOOTH_NOISE_TEST_GRID_3D_SIZE, origin, spacing, scale, numOctaves, 0.5f, 2.f, renormalize, seed, jobSystem);
+	}
+	else if (testCase.m_is3d)
+	{
+		Compute3dFractalNoiseGrid(out_values, gridSizeX, gridSizeY, SMOOTH_NOISE_TEST_GRID_3D_SIZE, origin, spacing, scale, numOctaves, 0.5f, 2.f, renormalize, seed, jobSystem);
+	}
+	else if (testCase.m_isPerlin)
+	{
+		Compute2dPerlinNoiseGrid(out_values, gridSizeX, gridSizeY, Vec2(origin.x, origin.y), spacing, scale, numOctaves, 0.5f, 2.f, renormalize, seed, jobSystem);
+	}
+	else
+	{
+		Compute2dFractalNoiseGrid(out_values, gridSizeX, gridSizeY, Vec2(origin.x, origin.y), spacing, scale, numOctaves, 0.5f, 2.f, renormalize, seed, jobSystem);
+	}
+}
+
+static int CountDifferentSamples(std::vector<float> const& valuesA, std::vector<float> const& valuesB)
+{
+	int numDifferent = 0;
+	for (size_t sampleIndex = 0; sampleIndex < valuesA.size(); ++sampleIndex)
+	{
+		numDifferent += memcmp(&valuesA[sampleIndex], &valuesB[sampleIndex], sizeof(float)) != 0 ? 1 : 0;
+	}
+	return numDifferent;
+}
+
+static void TestNoiseGrid(SmoothNoiseTestCase const& testCase, JobSystem& jobSystem)
+{
+	Vec3 origin(-41.3f, 1057.9f, -6.1f);
+	int gridSizeX = testCase.m_is3d ? SMOOTH_NOISE_TEST_GRID_3D_SIZE : SMOOTH_NOISE_TEST_GRID_2D_SIZE_X;
+	int gridSizeY = testCase.m_is3d ? SMOOTH_NOISE_TEST_GRID_3D_SIZE : SMOOTH_NOISE_TEST_GRID_2D_SIZE_Y;
+	int gridSizeZ = testCase.m_is3d ? SMOOTH_NOISE_TEST_GRID_3D_SIZE : 1;
+	int numSamples = gridSizeX * gridSizeY * gridSizeZ;
+
+	std::vector<float> singleValues(numSamples);
+	int numOutOfRange = 0;
+	double startTime = GetCurrentTimeSeconds();
+	for (int sampleIndex = 0; sampleIndex < numSamples; ++sampleIndex)
+	{
+		int sampleX = sampleIndex % gridSizeX;
+		int sampleY = (sampleIndex / gridSizeX) % gridSizeY;
+		int sampleZ = sampleIndex / (gridSizeX * gridSizeY);
+		Vec3 position(origin.x + (float) sampleX * SMOOTH_NOISE_TEST_SAMPLE_SPACING, origin.y + (float) sampleY * SMOOTH_NOISE_TEST_SAMPLE_SPACING, origin.z + (float) sampleZ * SMOOTH_NOISE_TEST_SAMPLE_SPACING);
+		singleValues[sampleIndex] = GetSingleNoiseSample(testCase, position, SMOOTH_NOISE_TEST_SEED);
+	}
+	double singleSeconds = GetCurrentTimeSeconds() - startTime;
+	for (float value : singleValues)
+	{
+		numOutOfRange += value >= -1.f && value <= 1.f ? 0 : 1;
+	}
+
+	std::vector<float> gridValues(numSamples);
+	startTime = GetCurrentTimeSeconds();
+	FillNoiseGrid(testCase, origin, SMOOTH_NOISE_TEST_SEED, gridValues.data(), nullptr);
+	double gridSeconds = GetCurrentTimeSeconds() - startTime;
+	std::vector<float> jobGridValues(numSamples);
+	startTime = GetCurrentTimeSeconds();
+	FillNoiseGrid(testCase, origin, SMOOTH_NOISE_TEST_SEED, jobGridValues.data(), &jobSystem);
+	double jobGridSeconds = GetCurrentTimeSeconds() - startTime;
+	std::vector<float> reseededValues(numSamples);
+	FillNoiseGrid(testCase, origin, SMOOTH_NOISE_TEST_SEED + 1, reseededValues.data(), nullptr);
+
+	int numGridMismatches = CountDifferentSamples(singleValues, gridValues);
+	int numJobMismatches = CountDifferentSamples(gridValues, jobGridValues);
+	int numReseededChanges = CountDifferentSamples(gridValues, reseededValues);
+	ENGINE_TEST_CHECK(numGridMismatches == 0, Stringf("%s grid differs from the single samples in %d of %d samples", testCase.m_name, numGridMismatches, numSamples));
+	ENGINE_TEST_CHECK(numJobMismatches == 0, Stringf("%s grid on the job system differs from the serial grid in %d of %d samples", testCase.m_name, numJobMismatches, numSamples));
+	ENGINE_TEST_CHECK(numReseededChanges > numSamples * 9 / 10, Stringf("%s grid changed only %d of %d samples with the next seed", testCase.m_name, numReseededChanges, numSamples));
+	if (testCase.m_renormalize)
+	{
+		ENGINE_TEST_CHECK(numOutOfRange == 0, Stringf("%s has %d of %d renormalized samples outside [-1, 1]", testCase.m_name, numOutOfRange, numSamples));
+	}
+	PrintEngineTestTiming(Stringf("%-22s single %8.2fms  grid %8.2fms  %5.2fx  job system %8.2fms", testCase.m_name, singleSeconds * 1000.0, gridSeconds * 1000.0,
+		gridSeconds > 0.0 ? singleSeconds / gridSeconds : 0.0, jobGridSeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
+void RunSmoothNoiseTests()
+{
+	BeginEngineTestSection("SmoothNoise grids");
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	SmoothNoiseTestCase const testCases[] =
+	{
+		{ "2D fractal",				false,	false,	6,	true },
+		{ "2D Perlin",				true,	false,	6,	true },
+		{ "3D fractal",				false,	true,	6,	true },
+		{ "3D Perlin",				true,	true,	6,	true },
+		{ "2D fractal, 1 octave",	false,	false,	1,	true },
+		{ "3D Perlin, raw sums",	true,	true,	3,	false },
+	};
+	for (SmoothNoiseTestCase const& testCase : testCases)
+	{
+		TestNoiseGrid(testCase, jobSystem);
+	}
+
+	jobSystem.Shutdown();
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,205 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/SpatialHashGrid2D.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int	SPATIAL_HASH_TEST_NUM_DISCS = 5000;
+constexpr float SPATIAL_HASH_TEST_CELL_SIZE = 2.f;
+constexpr float SPATIAL_HASH_TEST_QUERY_RADIUS = 3.f;
+// -----------------------------------------------------------------------------
+struct SpatialHashTestDisc
+{
+	Vec2  m_center;
+	float m_radius = 0.f;
+	int	  m_handle = -1;
+};
+// -----------------------------------------------------------------------------
+static bool DoTestBoundsOverlap(AABB2 const& boxA, AABB2 const& boxB)
+{
+	return boxA.m_mins.x <= boxB.m_maxs.x && boxA.m_maxs.x >= boxB.m_mins.x && boxA.m_mins.y <= boxB.m_maxs.y && boxA.m_maxs.y >= boxB.m_mins.y;
+}
+
+static bool IsPairLess(SpatialHashPair2D const& pairA, SpatialHashPair2D const& pairB)
+{
+	return pairA.m_handleA != pairB.m_handleA ? pairA.m_handleA < pairB.m_handleA : pairA.m_handleB < pairB.m_handleB;
+}
+
+static bool ArePairListsEqual(std::vector<SpatialHashPair2D> const& pairsA, std::vector<SpatialHashPair2D> const& pairsB)
+{
+	if (pairsA.size() != pairsB.size())
+	{
+		return false;
+	}
+	for (size_t pairIndex = 0; pairIndex < pairsA.size(); ++pairIndex)
+	{
+		if (pairsA[pairIndex].m_handleA != pairsB[pairIndex].m_handleA || pairsA[pairIndex].m_handleB != pairsB[pairIndex].m_handleB)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static SpatialHashTestDisc MakeRandomDisc(RandomNumberGenerator& rng, float worldSize)
+{
+	SpatialHashTestDisc disc;
+	disc.m_center = Vec2(rng.RollRandomFloatInRange(-worldSize * 0.5f, worldSize * 0.5f), rng.RollRandomFloatInRange(-worldSize * 0.5f, worldSize * 0.5f));
+	// Mostly cell sized, with one in twenty spanning several cells
+	disc.m_radius = rng.RollRandomIntInRange(0, 19) == 0 ? rng.RollRandomFloatInRange(2.f, 5.f) : rng.RollRandomFloatInRange(0.3f, 1.2f);
+	return disc;
+}
+
+// Every pair the grid reports once with the lower handle first, sorted, against the pairwise loop over the bounds
+static int CountPairMismatches(SpatialHashGrid2D const& grid, std::vector<SpatialHashTestDisc> const& discs, int* out_numPairs = nullptr)
+{
+	std::vector<SpatialHashPair2D> pairs;
+	grid.GetOverlappingPairs(pairs);
+	int numBadOrders = 0;
+	for (SpatialHashPair2D const& pair : pairs)
+	{
+		numBadOrders += pair.m_handleA < pair.m_handleB ? 0 : 1;
+	}
+	std::sort(pairs.begin(), pairs.end(), IsPairLess);
+
+	std::vector<SpatialHashPair2D> expectedPairs;
+	for (int discIndexA = 0; discIndexA < static_cast<int>(discs.size()); ++discIndexA)
+	{
+		for (int discIndexB = discIndexA + 1; discIndexB < static_cast<int>(discs.size()); ++discIndexB)
+		{
+			int handleA = discs[discIndexA].m_handle;
+			int handleB = discs[discIndexB].m_handle;
+			if (DoTestBoundsOverlap(grid.GetEntryBounds(handleA), grid.GetEntryBounds(handleB)))
+			{
+				SpatialHashPair2D pair;
+				pair.m_handleA = std::min(handleA, handleB);
+				pair.m_handleB = std::max(handleA, handleB);
+				expectedPairs.push_back(pair);
+			}
+		}
+	}
+	std::sort(expectedPairs.begin(), expectedPairs.end(), IsPairLess);
+
+	if (out_numPairs != nullptr)
+	{
+		*out_numPairs = static_cast<int>(expectedPairs.size());
+	}
+	return numBadOrders + (ArePairListsEqual(pairs, expectedPairs) ? 0 : 1);
+}
+// -----------------------------------------------------------------------------
+void RunSpatialHashGrid2DTests()
+{
+	BeginEngineTestSection("SpatialHashGrid2D");
+
+	RandomNumberGenerator rng(42);
+	float worldSize = sqrtf(static_cast<float>(SPATIAL_HASH_TEST_NUM_DISCS)) * 4.f;
+	std::vector<SpatialHashTestDisc> discs(SPATIAL_HASH_TEST_NUM_DISCS);
+	SpatialHashGrid2D grid(SPATIAL_HASH_TEST_CELL_SIZE);
+	for (SpatialHashTestDisc& disc : discs)
+	{
+		disc = MakeRandomDisc(rng, worldSize);
+		disc.m_handle = grid.InsertDisc(disc.m_center, disc.m_radius);
+	}
+
+	double startTime = GetCurrentTimeSeconds();
+	for (SpatialHashTestDisc const& disc : discs)
+	{
+		grid.MoveDisc(disc.m_handle, disc.m_center, disc.m_radius);
+	}
+	grid.Rebuild();
+	double rebuildSeconds = GetCurrentTimeSeconds() - startTime;
+
+	std::vector<SpatialHashPair2D> pairs;
+	startTime = GetCurrentTimeSeconds();
+	grid.GetOverlappingPairs(pairs);
+	double gridPairSeconds = GetCurrentTimeSeconds() - startTime;
+
+	int numPairs = 0;
+	startTime = GetCurrentTimeSeconds();
+	int numPairMismatches = CountPairMismatches(grid, discs, &numPairs);
+	double pairwiseSeconds = GetCurrentTimeSeconds() - startTime;
+	ENGINE_TEST_CHECK(grid.GetNumEntries() == SPATIAL_HASH_TEST_NUM_DISCS, Stringf("Grid holds %d entries, expected %d", grid.GetNumEntries(), SPATIAL_HASH_TEST_NUM_DISCS));
+	ENGINE_TEST_CHECK(numPairs > 0, "The test discs never overlap, the pair check means nothing");
+	ENGINE_TEST_CHECK(numPairMismatches == 0, "GetOverlappingPairs differs from the pairwise loop, or reports a pair twice or out of order");
+
+	// Disc and box queries against the brute force sets
+	int numDiscQueryMismatches = 0;
+	int numBoxQueryMismatches = 0;
+	double querySeconds = 0.0;
+	std::vector<int> found;
+	std::vector<int> expected;
+	for (SpatialHashTestDisc const& queryDisc : discs)
+	{
+		found.clear();
+		startTime = GetCurrentTimeSeconds();
+		grid.GetEntriesOverlappingDisc(queryDisc.m_center, SPATIAL_HASH_TEST_QUERY_RADIUS, found);
+		querySeconds += GetCurrentTimeSeconds() - startTime;
+		expected.clear();
+		for (SpatialHashTestDisc const& disc : discs)
+		{
+			if (DoDiscsOverlapAABB2D(queryDisc.m_center, SPATIAL_HASH_TEST_QUERY_RADIUS, grid.GetEntryBounds(disc.m_handle)))
+			{
+				expected.push_back(disc.m_handle);
+			}
+		}
+		std::sort(found.begin(), found.end());
+		std::sort(expected.begin(), expected.end());
+		numDiscQueryMismatches += found == expected ? 0 : 1;
+
+		AABB2 queryBox(queryDisc.m_center.x - 4.f, queryDisc.m_center.y - 1.5f, queryDisc.m_center.x + 2.5f, queryDisc.m_center.y + 3.f);
+		found.clear();
+		grid.GetEntriesOverlappingAABB2(queryBox, found);
+		expected.clear();
+		for (SpatialHashTestDisc const& disc : discs)
+		{
+			if (DoTestBoundsOverlap(queryBox, grid.GetEntryBounds(disc.m_handle)))
+			{
+				expected.push_back(disc.m_handle);
+			}
+		}
+		std::sort(found.begin(), found.end());
+		std::sort(expected.begin(), expected.end());
+		numBoxQueryMismatches += found == expected ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numDiscQueryMismatches == 0, Stringf("GetEntriesOverlappingDisc differs from brute force for %d of %d queries", numDiscQueryMismatches, SPATIAL_HASH_TEST_NUM_DISCS));
+	ENGINE_TEST_CHECK(numBoxQueryMismatches == 0, Stringf("GetEntriesOverlappingAABB2 differs from brute force for %d of %d queries", numBoxQueryMismatches, SPATIAL_HASH_TEST_NUM_DISCS));
+
+	// Remove a third, move the rest and insert replacements, which should reuse the removed handles
+	std::vector<SpatialHashTestDisc> keptDiscs;
+	int numRemoved = 0;
+	for (SpatialHashTestDisc const& disc : discs)
+	{
+		if (rng.RollRandomIntInRange(0, 2) == 0)
+		{
+			grid.Remove(disc.m_handle);
+			++numRemoved;
+			continue;
+		}
+		keptDiscs.push_back(disc);
+		keptDiscs.back().m_center += Vec2(rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f));
+		grid.MoveDisc(disc.m_handle, keptDiscs.back().m_center, disc.m_radius);
+	}
+	int numReusedHandles = 0;
+	for (int insertIndex = 0; insertIndex < numRemoved / 2; ++insertIndex)
+	{
+		SpatialHashTestDisc disc = MakeRandomDisc(rng, worldSize);
+		disc.m_handle = grid.InsertDisc(disc.m_center, disc.m_radius);
+		numReusedHandles += disc.m_handle < SPATIAL_HASH_TEST_NUM_DISCS ? 1 : 0;
+		keptDiscs.push_back(disc);
+	}
+	grid.Rebuild();
+
+	int numChangedPairMismatches = CountPairMismatches(grid, keptDiscs);
+	ENGINE_TEST_CHECK(grid.GetNumEntries() == static_cast<int>(keptDiscs.size()), Stringf("Grid holds %d entries after removals, expected %d", grid.GetNumEntries(), static_cast<int>(keptDiscs.size())));
+	ENGINE_TEST_CHECK(numReusedHandles == numRemoved / 2, Stringf("Only %d of %d new entries reused a removed handle", numReusedHandles, numRemoved / 2));
+	ENGINE_TEST_CHECK(numChangedPairMismatches == 0, "GetOverlappingPairs after Remove, Move and Insert differs from the pairwise loop");
+
+	PrintEngineTestTiming(Stringf("Move + Rebuild        %8.3fms", rebuildSeconds * 1000.0));
+	PrintEngineTestTiming(Stringf("Grid pairs            %8.3fms  %d pairs  pairwise loop %8.3fms", gridPairSeconds * 1000.0, static_cast<int>(pairs.size()), pairwiseSeconds * 1000.0));
+	PrintEngineTestTiming(Stringf("Disc query (r = %.0f)    %8.3fus per query", SPATIAL_HASH_TEST_QUERY_RADIUS, querySeconds * 1e6 / static_cast<double>(SPATIAL_HASH_TEST_NUM_DISCS)));
+}
+// -----------------------------------------------------------------------------
@@ -0,0 +1,305 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/SweepAndPrune3D.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int	SWEEP_AND_PRUNE_TEST_NUM_BODIES = 3000;		// Checked against the pairwise loop every frame
+constexpr int	SWEEP_AND_PRUNE_TEST_NUM_FRAMES = 20;
+constexpr int	SWEEP_AND_PRUNE_TIMING_NUM_BODIES = 50000;
+constexpr int	SWEEP_AND_PRUNE_TIMING_NUM_FRAMES = 30;
+constexpr float SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT = 2.f;
+constexpr float SWEEP_AND_PRUNE_TEST_DELTA_SECONDS = 1.f / 60.f;
+// -----------------------------------------------------------------------------
+struct SweepAndPruneTestBody
+{
+	Vec3  m_cylinderStart;
+	float m_cylinderRadius = 0.f;
+	Vec3  m_velocity;
+	int	  m_handle = -1;
+};
+// -----------------------------------------------------------------------------
+static unsigned long long GetTestPairKey(int handleA, int handleB)
+{
+	return (static_cast<unsigned long long>(handleA) << 32) | static_cast<unsigned long long>(handleB);
+}
+
+static bool DoTestBoundsOverlap(AABB3 const& boxA, AABB3 const& boxB)
+{
+	return boxA.m_mins.x <= boxB.m_maxs.x && boxA.m_maxs.x >= boxB.m_mins.x && boxA.m_mins.y <= boxB.m_maxs.y && boxA.m_maxs.y >= boxB.m_mins.y &&
+		boxA.m_mins.z <= boxB.m_maxs.z && boxA.m_maxs.z >= boxB.m_mins.z;
+}
+
+static std::vector<SweepAndPruneTestBody> MakeRandomBodies(RandomNumberGenerator& rng, int numBodies)
+{
+	float worldHalfSize = 2.f * sqrtf(static_cast<float>(numBodies));
+	std::vector<SweepAndPruneTestBody> bodies(numBodies);
+	for (SweepAndPruneTestBody& body : bodies)
+	{
+		body.m_cylinderStart = Vec3(rng.RollRandomFloatInRange(-worldHalfSize, worldHalfSize), rng.RollRandomFloatInRange(-worldHalfSize, worldHalfSize), rng.RollRandomFloatInRange(0.f, 10.f));
+		body.m_cylinderRadius = rng.RollRandomFloatInRange(0.3f, 1.5f);
+		body.m_velocity = Vec3(rng.RollRandomFloatInRange(-3.f, 3.f), rng.RollRandomFloatInRange(-3.f, 3.f), rng.RollRandomFloatInRange(-0.5f, 0.5f));
+	}
+	return bodies;
+}
+
+static void StepBodies(SweepAndPrune3D& sweepAndPrune, std::vector<SweepAndPruneTestBody>& bodies, float deltaSeconds)
+{
+	for (SweepAndPruneTestBody& body : bodies)
+	{
+		body.m_cylinderStart += body.m_velocity * deltaSeconds;
+		sweepAndPrune.MoveZCylinder(body.m_handle, body.m_cylinderStart, body.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+	}
+}
+
+// The pair list must be every overlapping pair of live bodies, once each with the lower handle first
+static int CountPairMismatches(SweepAndPrune3D const& sweepAndPrune, std::vector<SweepAndPruneTestBody> const& bodies)
+{
+	int numMismatches = 0;
+	std::vector<unsigned long long> pairKeys;
+	for (SweepAndPrunePair const& pair : sweepAndPrune.GetOverlappingPairs())
+	{
+		numMismatches += pair.m_handleA < pair.m_handleB ? 0 : 1;
+		pairKeys.push_back(GetTestPairKey(pair.m_handleA, pair.m_handleB));
+	}
+	std::sort(pairKeys.begin(), pairKeys.end());
+
+	std::vector<unsigned long long> expectedKeys;
+	for (int bodyIndexA = 0; bodyIndexA < static_cast<int>(bodies.size()); ++bodyIndexA)
+	{
+		AABB3 const& boundsA = sweepAndPrune.GetBodyBounds(bodies[bodyIndexA].m_handle);
+		for (int bodyIndexB = bodyIndexA + 1; bodyIndexB < static_cast<int>(bodies.size()); ++bodyIndexB)
+		{
+			if (DoTestBoundsOverlap(boundsA, sweepAndPrune.GetBodyBounds(bodies[bodyIndexB].m_handle)))
+			{
+				int handleA = bodies[bodyIndexA].m_handle;
+				int handleB = bodies[bodyIndexB].m_handle;
+				expectedKeys.push_back(GetTestPairKey(std::min(handleA, handleB), std::max(handleA, handleB)));
+			}
+		}
+	}
+	std::sort(expectedKeys.begin(), expectedKeys.end());
+	return numMismatches + (pairKeys == expectedKeys ? 0 : 1);
+}
+// -----------------------------------------------------------------------------
+// Replays the added and removed callbacks into a set, which must always equal the pair list
+class SweepAndPruneCallbackTracker
+{
+public:
+	explicit SweepAndPruneCallbackTracker(SweepAndPrune3D& sweepAndPrune)
+	{
+		sweepAndPrune.SetPairCallbacks(
+			[this](int handleA, int handleB) { m_numBadCallbacks += (handleA < handleB && m_pairKeys.insert(GetTestPairKey(handleA, handleB)).second) ? 0 : 1; ++m_numAdded; },
+			[this](int handleA, int handleB) { m_numBadCallbacks += (handleA < handleB && m_pairKeys.erase(GetTestPairKey(handleA, handleB)) == 1) ? 0 : 1; ++m_numRemoved; });
+	}
+
+	bool DoesMatch(SweepAndPrune3D const& sweepAndPrune) const
+	{
+		if (m_pairKeys.size() != sweepAndPrune.GetOverlappingPairs().size())
+		{
+			return false;
+		}
+		for (SweepAndPrunePair const& pair : sweepAndPrune.GetOverlappingPairs())
+		{
+			if (m_pairKeys.find(GetTestPairKey(pair.m_handleA, pair.m_handleB)) == m_pairKeys.end())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	std::unordered_set<unsigned long long> m_pairKeys;
+	int									   m_numBadCallbacks = 0;
+	int									   m_numAdded = 0;
+	int									   m_numRemoved = 0;
+};
+// -----------------------------------------------------------------------------
+static void TestPairsAndCallbacks(RandomNumberGenerator& rng)
+{
+	std::vector<SweepAndPruneTestBody> bodies = MakeRandomBodies(rng, SWEEP_AND_PRUNE_TEST_NUM_BODIES);
+	SweepAndPrune3D sweepAndPrune;
+	SweepAndPruneCallbackTracker tracker(sweepAndPrune);
+	for (SweepAndPruneTestBody& body : bodies)
+	{
+		body.m_handle = sweepAndPrune.InsertZCylinder(body.m_cylinderStart, body.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+	}
+	sweepAndPrune.Update();
+	int numInitialPairs = static_cast<int>(sweepAndPrune.GetOverlappingPairs().size());
+	ENGINE_TEST_CHECK(numInitialPairs > 0, "The test bodies never overlap, the pair checks mean nothing");
+	ENGINE_TEST_CHECK(CountPairMismatches(sweepAndPrune, bodies) == 0, "First Update's pairs differ from the pairwise loop");
+
+	// Coherent motion, with everything sped up so pairs come and go every frame
+	int numFrameMismatches = 0;
+	int numTrackerMismatches = 0;
+	for (int frameIndex = 0; frameIndex < SWEEP_AND_PRUNE_TEST_NUM_FRAMES; ++frameIndex)
+	{
+		StepBodies(sweepAndPrune, bodies, SWEEP_AND_PRUNE_TEST_DELTA_SECONDS * 10.f);
+		sweepAndPrune.Update();
+		numFrameMismatches += CountPairMismatches(sweepAndPrune, bodies) == 0 ? 0 : 1;
+		numTrackerMismatches += tracker.DoesMatch(sweepAndPrune) ? 0 : 1;
+	}
+	ENGINE_TEST_CHECK(numFrameMismatches == 0, Stringf("Update's pairs differ from the pairwise loop in %d of %d frames", numFrameMismatches, SWEEP_AND_PRUNE_TEST_NUM_FRAMES));
+	ENGINE_TEST_CHECK(tracker.m_numRemoved > 0 && tracker.m_numAdded > numInitialPairs, Stringf("Motion only added %d and removed %d pairs, too few to mean much",
+		tracker.m_numAdded - numInitialPairs, tracker.m_numRemoved));
+	ENGINE_TEST_CHECK(numTrackerMismatches == 0 && tracker.m_numBadCallbacks == 0, Stringf("Pair callbacks do not replay into the pair list, %d bad callbacks in %d frames",
+		tracker.m_numBadCallbacks, numTrackerMismatches));
+
+	// Remove a third. Their pairs are reported removed, and their handles only come back after the next Update.
+	std::vector<SweepAndPruneTestBody> keptBodies;
+	std::vector<int> removedHandles;
+	for (SweepAndPruneTestBody const& body : bodies)
+	{
+		if (rng.RollRandomIntInRange(0, 2) == 0)
+		{
+			sweepAndPrune.Remove(body.m_handle);
+			removedHandles.push_back(body.m_handle);
+		}
+		else
+		{
+			keptBodies.push_back(body);
+		}
+	}
+	SweepAndPruneTestBody earlyBody = MakeRandomBodies(rng, 1)[0];
+	earlyBody.m_handle = sweepAndPrune.InsertZCylinder(earlyBody.m_cylinderStart, earlyBody.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+	bool isEarlyHandleNew = std::find(removedHandles.begin(), removedHandles.end(), earlyBody.m_handle) == removedHandles.end();
+	keptBodies.push_back(earlyBody);
+	sweepAndPrune.Update();
+
+	int numReusedHandles = 0;
+	for (int insertIndex = 0; insertIndex < static_cast<int>(removedHandles.size()) / 2; ++insertIndex)
+	{
+		SweepAndPruneTestBody body = MakeRandomBodies(rng, 1)[0];
+		body.m_handle = sweepAndPrune.InsertZCylinder(body.m_cylinderStart, body.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+		numReusedHandles += std::find(removedHandles.begin(), removedHandles.end(), body.m_handle) != removedHandles.end() ? 1 : 0;
+		keptBodies.push_back(body);
+	}
+	sweepAndPrune.Update();
+	ENGINE_TEST_CHECK(isEarlyHandleNew, "Insert reused a removed handle before Update reported its pairs removed");
+	ENGINE_TEST_CHECK(numReusedHandles == static_cast<int>(removedHandles.size()) / 2, Stringf("Only %d of %d inserts after Update reused a removed handle", numReusedHandles,
+		static_cast<int>(removedHandles.size()) / 2));
+	ENGINE_TEST_CHECK(sweepAndPrune.GetNumBodies() == static_cast<int>(keptBodies.size()), Stringf("%d bodies after removals, expected %d", sweepAndPrune.GetNumBodies(),
+		static_cast<int>(keptBodies.size())));
+	ENGINE_TEST_CHECK(CountPairMismatches(sweepAndPrune, keptBodies) == 0, "Pairs after Remove and Insert differ from the pairwise loop");
+	ENGINE_TEST_CHECK(tracker.DoesMatch(sweepAndPrune) && tracker.m_numBadCallbacks == 0, "Pair callbacks after Remove and Insert do not replay into the pair list");
+
+	// Stack everything into a tall column, the sweep moves to z and must still find the same pairs
+	int initialSweepAxis = sweepAndPrune.GetSweepAxis();
+	for (int bodyIndex = 0; bodyIndex < static_cast<int>(keptBodies.size()); ++bodyIndex)
+	{
+		SweepAndPruneTestBody& body = keptBodies[bodyIndex];
+		body.m_cylinderStart = Vec3(body.m_cylinderStart.x * 0.01f, body.m_cylinderStart.y * 0.01f, static_cast<float>(bodyIndex) * 0.5f);
+		sweepAndPrune.MoveZCylinder(body.m_handle, body.m_cylinderStart, body.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+	}
+	sweepAndPrune.Update();
+	ENGINE_TEST_CHECK(initialSweepAxis != 2 && sweepAndPrune.GetSweepAxis() == 2, Stringf("Sweep axis went from %d to %d, expected a switch to z", initialSweepAxis,
+		sweepAndPrune.GetSweepAxis()));
+	ENGINE_TEST_CHECK(CountPairMismatches(sweepAndPrune, keptBodies) == 0, "Pairs after switching the sweep axis differ from the pairwise loop");
+	ENGINE_TEST_CHECK(tracker.DoesMatch(sweepAndPrune) && tracker.m_numBadCallbacks == 0, "Pair callbacks after switching the sweep axis do not replay into the pair list");
+
+	sweepAndPrune.Clear();
+	sweepAndPrune.Update();
+	ENGINE_TEST_CHECK(sweepAndPrune.GetNumBodies() == 0 && sweepAndPrune.GetOverlappingPairs().empty(), "Clear left bodies or pairs behind");
+}
+
+// Per frame Update cost at game scale, serial and on the job system, checked against a fresh build that sorts from scratch
+static void TestUpdateAgainstRebuild(RandomNumberGenerator& rng)
+{
+	std::vector<SweepAndPruneTestBody> bodies = MakeRandomBodies(rng, SWEEP_AND_PRUNE_TIMING_NUM_BODIES);
+	SweepAndPrune3D sweepAndPrune;
+	SweepAndPrune3D parallelSweepAndPrune;
+	SweepAndPruneCallbackTracker tracker(sweepAndPrune);
+	SweepAndPruneCallbackTracker parallelTracker(parallelSweepAndPrune);
+	double startTime = GetCurrentTimeSeconds();
+	for (SweepAndPruneTestBody& body : bodies)
+	{
+		body.m_handle = sweepAndPrune.InsertZCylinder(body.m_cylinderStart, body.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+	}
+	sweepAndPrune.Update();
+	double firstUpdateSeconds = GetCurrentTimeSeconds() - startTime;
+	for (SweepAndPruneTestBody const& body : bodies)
+	{
+		parallelSweepAndPrune.InsertZCylinder(body.m_cylinderStart, body.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+	}
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+	parallelSweepAndPrune.Update(&jobSystem);
+
+	double updateSeconds = 0.0;
+	double parallelUpdateSeconds = 0.0;
+	int numParallelMismatches = 0;
+	for (int frameIndex = 0; frameIndex < SWEEP_AND_PRUNE_TIMING_NUM_FRAMES; ++frameIndex)
+	{
+		StepBodies(sweepAndPrune, bodies, SWEEP_AND_PRUNE_TEST_DELTA_SECONDS);
+		startTime = GetCurrentTimeSeconds();
+		sweepAndPrune.Update();
+		updateSeconds += GetCurrentTimeSeconds() - startTime;
+
+		// Same handles in the same order, so the job system must give exactly the same sorted pair list
+		for (SweepAndPruneTestBody const& body : bodies)
+		{
+			parallelSweepAndPrune.MoveZCylinder(body.m_handle, body.m_cylinderStart, body.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+		}
+		startTime = GetCurrentTimeSeconds();
+		parallelSweepAndPrune.Update(&jobSystem);
+		parallelUpdateSeconds += GetCurrentTimeSeconds() - startTime;
+		std::vector<SweepAndPrunePair> const& pairs = sweepAndPrune.GetOverlappingPairs();
+		std::vector<SweepAndPrunePair> const& parallelPairs = parallelSweepAndPrune.GetOverlappingPairs();
+		bool arePairsEqual = pairs.size() == parallelPairs.size();
+		for (size_t pairIndex = 0; arePairsEqual && pairIndex < pairs.size(); ++pairIndex)
+		{
+			arePairsEqual = pairs[pairIndex].m_handleA == parallelPairs[pairIndex].m_handleA && pairs[pairIndex].m_handleB == parallelPairs[pairIndex].m_handleB;
+		}
+		numParallelMismatches += arePairsEqual ? 0 : 1;
+	}
+	updateSeconds /= static_cast<double>(SWEEP_AND_PRUNE_TIMING_NUM_FRAMES);
+	parallelUpdateSeconds /= static_cast<double>(SWEEP_AND_PRUNE_TIMING_NUM_FRAMES);
+	jobSystem.Shutdown();
+	ENGINE_TEST_CHECK(numParallelMismatches == 0, Stringf("Update on the job system differs from the serial Update in %d of %d frames", numParallelMismatches,
+		SWEEP_AND_PRUNE_TIMING_NUM_FRAMES));
+	ENGINE_TEST_CHECK(parallelTracker.DoesMatch(parallelSweepAndPrune) && parallelTracker.m_numBadCallbacks == 0, "Pair callbacks on the job system do not replay into the pair list");
+
+	SweepAndPrune3D rebuilt;
+	for (SweepAndPruneTestBody const& body : bodies)
+	{
+		rebuilt.InsertZCylinder(body.m_cylinderStart, body.m_cylinderRadius, SWEEP_AND_PRUNE_TEST_CYLINDER_HEIGHT);
+	}
+	startTime = GetCurrentTimeSeconds();
+	rebuilt.Update();
+	double rebuildSeconds = GetCurrentTimeSeconds() - startTime;
+
+	// Both inserted the bodies in the same order into empty sets, so the handles are the same
+	int numMismatches = 0;
+	for (SweepAndPrunePair const& pair : rebuilt.GetOverlappingPairs())
+	{
+		numMismatches += sweepAndPrune.AreOverlapping(pair.m_handleA, pair.m_handleB) ? 0 : 1;
+	}
+	int numPairs = static_cast<int>(sweepAndPrune.GetOverlappingPairs().size());
+	int numRebuiltPairs = static_cast<int>(rebuilt.GetOverlappingPairs().size());
+	ENGINE_TEST_CHECK(numPairs == numRebuiltPairs && numMismatches == 0, Stringf("After %d frames Update has %d pairs, a fresh build %d, %d missing",
+		SWEEP_AND_PRUNE_TIMING_NUM_FRAMES, numPairs, numRebuiltPairs, numMismatches));
+	ENGINE_TEST_CHECK(tracker.DoesMatch(sweepAndPrune) && tracker.m_numBadCallbacks == 0, "Pair callbacks do not replay into the pair list");
+
+	PrintEngineTestTiming(Stringf("%d z-cylinders, sweeping axis %d, %d pairs", SWEEP_AND_PRUNE_TIMING_NUM_BODIES, sweepAndPrune.GetSweepAxis(), numPairs));
+	PrintEngineTestTiming(Stringf("First update  %8.3fms", firstUpdateSeconds * 1000.0));
+	PrintEngineTestTiming(Stringf("Update        %8.3fms per frame  job system %8.3fms per frame", updateSeconds * 1000.0, parallelUpdateSeconds * 1000.0));
+	PrintEngineTestTiming(Stringf("Fresh build   %8.3fms", rebuildSeconds * 1000.0));
+}
+// -----------------------------------------------------------------------------
+void RunSweepAndPruneTests()
+{
+	BeginEngineTestSection("SweepAndPrune3D");
+
+	RandomNumberGenerator rng(44);
+	TestPairsAndCallbacks(rng);
+	TestUpdateAgainstRebuild(rng);
+}
+// -----------------------------------------------------------------------------
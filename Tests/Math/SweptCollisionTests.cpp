@@ -0,0 +1,197 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Math/SweptCollision.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Math/SIMDMath.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Not a multiple of any packet width, so the last packet repeats its last sphere
+constexpr int SWEPT_TEST_NUM_SPHERES = 4093;
+constexpr int SWEPT_TEST_NUM_BOXES = 1024;
+// -----------------------------------------------------------------------------
+static bool IsNear(float value, float expectedValue)
+{
+	return fabsf(value - expectedValue) < 1e-4f;
+}
+
+static bool IsNear(Vec2 const& value, Vec2 const& expectedValue)
+{
+	return IsNear(value.x, expectedValue.x) && IsNear(value.y, expectedValue.y);
+}
+
+// A unit disc moving ten along x into shapes whose answers are known
+static void TestSweeps2D()
+{
+	Vec2 discStart(0.f, 0.f);
+	Vec2 discDisplacement(10.f, 0.f);
+
+	SweptImpact2D boxImpact = SweepDiscVsAABB2D(discStart, discDisplacement, 1.f, AABB2(5.f, -1.f, 6.f, 1.f));
+	ENGINE_TEST_CHECK(boxImpact.m_didImpact && IsNear(boxImpact.m_impactFraction, 0.4f) && IsNear(boxImpact.m_impactNormal, Vec2(-1.f, 0.f)) && IsNear(boxImpact.m_impactPoint.x, 5.f),
+		Stringf("Disc into a box hit at %.4f with normal (%.3f, %.3f), expected 0.4 and (-1, 0)", boxImpact.m_impactFraction, boxImpact.m_impactNormal.x, boxImpact.m_impactNormal.y));
+
+	SweptImpact2D cornerImpact = SweepDiscVsAABB2D(discStart, discDisplacement, 1.f, AABB2(5.f, 0.5f, 6.f, 3.f));
+	float cornerCenterX = 5.f - sqrtf(1.f - 0.25f);
+	ENGINE_TEST_CHECK(cornerImpact.m_didImpact && IsNear(cornerImpact.m_impactFraction, cornerCenterX / 10.f) && IsNear(cornerImpact.m_impactPoint, Vec2(5.f, 0.5f)),
+		Stringf("Disc into a box corner hit at %.4f, expected %.4f on the corner", cornerImpact.m_impactFraction, cornerCenterX / 10.f));
+
+	SweptImpact2D missImpact = SweepDiscVsAABB2D(discStart, discDisplacement, 1.f, AABB2(5.f, 1.5f, 6.f, 3.f));
+	SweptImpact2D shortImpact = SweepDiscVsAABB2D(discStart, discDisplacement, 1.f, AABB2(12.f, -1.f, 13.f, 1.f));
+	ENGINE_TEST_CHECK(!missImpact.m_didImpact && !shortImpact.m_didImpact && missImpact.m_impactFraction == 1.f, "Disc sweep hit a box beside its path or beyond its reach");
+
+	SweptImpact2D lineImpact = SweepDiscVsLineSegment2D(discStart, discDisplacement, 1.f, Vec2(5.f, -3.f), Vec2(5.f, 3.f));
+	ENGINE_TEST_CHECK(lineImpact.m_didImpact && IsNear(lineImpact.m_impactFraction, 0.4f) && IsNear(lineImpact.m_impactNormal, Vec2(-1.f, 0.f)) && IsNear(lineImpact.m_impactCenter, Vec2(4.f, 0.f)),
+		Stringf("Disc into a line segment hit at %.4f, expected 0.4", lineImpact.m_impactFraction));
+
+	SweptImpact2D staticDiscImpact = SweepDiscVsDisc2D(discStart, discDisplacement, 1.f, Vec2(8.f, 0.f), Vec2::ZERO, 1.f);
+	SweptImpact2D movingDiscImpact = SweepDiscVsDisc2D(discStart, discDisplacement, 1.f, Vec2(8.f, 0.f), Vec2(-10.f, 0.f), 1.f);
+	ENGINE_TEST_CHECK(staticDiscImpact.m_didImpact && IsNear(staticDiscImpact.m_impactFraction, 0.6f) && IsNear(staticDiscImpact.m_impactPoint, Vec2(7.f, 0.f)),
+		Stringf("Disc into a still disc hit at %.4f, expected 0.6", staticDiscImpact.m_impactFraction));
+	ENGINE_TEST_CHECK(movingDiscImpact.m_didImpact && IsNear(movingDiscImpact.m_impactFraction, 0.3f) && IsNear(movingDiscImpact.m_impactCenter, Vec2(3.f, 0.f)),
+		Stringf("Discs moving head on hit at %.4f, expected 0.3", movingDiscImpact.m_impactFraction));
+
+	SweptImpact2D startImpact = SweepDiscVsAABB2D(Vec2(5.5f, 0.f), discDisplacement, 1.f, AABB2(5.f, -1.f, 6.f, 1.f));
+	ENGINE_TEST_CHECK(startImpact.m_didImpact && startImpact.m_impactFraction == 0.f, "Disc starting inside a box should hit at fraction 0");
+}
+
+// Runs one primitive type through the batch sweep, checking it against the single sweeps and checking where they hit
+template <typename SingleSweep, typename BatchSweep, typename EndOverlap>
+static void TestSweptBatch(char const* primitiveName, std::vector<SweptSphere3> const& spheres, int numPrimitives, SingleSweep const& singleSweep, BatchSweep const& batchSweep,
+	EndOverlap const& doesEndOverlap)
+{
+	int numSpheres = static_cast<int>(spheres.size());
+	std::vector<SweptHit3D> expectedHits(numSpheres);
+	int numBadImpacts = 0;
+	double startTime = GetCurrentTimeSeconds();
+	for (int sphereIndex = 0; sphereIndex < numSpheres; ++sphereIndex)
+	{
+		SweptHit3D& nearestHit = expectedHits[sphereIndex];
+		for (int primitiveIndex = 0; primitiveIndex < numPrimitives; ++primitiveIndex)
+		{
+			SweptImpact3D impact = singleSweep(spheres[sphereIndex], primitiveIndex);
+			if (impact.m_didImpact && (!nearestHit.DidImpact() || impact.m_impactFraction < nearestHit.m_impactFraction))
+			{
+				nearestHit.m_primitiveIndex = primitiveIndex;
+				nearestHit.m_impactFraction = impact.m_impactFraction;
+			}
+		}
+	}
+	double singleSeconds = GetCurrentTimeSeconds() - startTime;
+
+	// At impact the sphere just touches the surface: the impact point is a radius away along the unit normal
+	for (int sphereIndex = 0; sphereIndex < numSpheres; ++sphereIndex)
+	{
+		SweptHit3D const& expected = expectedHits[sphereIndex];
+		if (!expected.DidImpact() || expected.m_impactFraction <= 0.f)
+		{
+			continue;
+		}
+		SweptSphere3 const& sphere = spheres[sphereIndex];
+		SweptImpact3D impact = singleSweep(sphere, expected.m_primitiveIndex);
+		Vec3 expectedCenter = impact.m_impactPoint + impact.m_impactNormal * sphere.m_radius;
+		bool isTouching = fabsf(impact.m_impactNormal.GetLength() - 1.f) < 1e-3f && (impact.m_impactCenter - expectedCenter).GetLength() < 1e-3f &&
+			!doesEndOverlap(sphere.m_start + sphere.m_displacement * (expected.m_impactFraction * 0.99f), sphere.m_radius * 0.99f, expected.m_primitiveIndex);
+		numBadImpacts += isTouching ? 0 : 1;
+	}
+
+	std::vector<SweptHit3D> serialHits(numSpheres);
+	startTime = GetCurrentTimeSeconds();
+	batchSweep(serialHits.data(), false);
+	double serialSeconds = GetCurrentTimeSeconds() - startTime;
+	std::vector<SweptHit3D> jobHits(numSpheres);
+	startTime = GetCurrentTimeSeconds();
+	batchSweep(jobHits.data(), true);
+	double jobSeconds = GetCurrentTimeSeconds() - startTime;
+
+	// Both run the same exact sweep, so any difference at all is a cull that threw away a real hit
+	int numSerialMismatches = 0;
+	int numJobMismatches = 0;
+	int numImpacts = 0;
+	int numTunnels = 0;
+	for (int sphereIndex = 0; sphereIndex < numSpheres; ++sphereIndex)
+	{
+		SweptHit3D const& expected = expectedHits[sphereIndex];
+		SweptHit3D const& serialHit = serialHits[sphereIndex];
+		SweptHit3D const& jobHit = jobHits[sphereIndex];
+		numSerialMismatches += expected.m_primitiveIndex == serialHit.m_primitiveIndex && expected.m_impactFraction == serialHit.m_impactFraction ? 0 : 1;
+		numJobMismatches += serialHit.m_primitiveIndex == jobHit.m_primitiveIndex && serialHit.m_impactFraction == jobHit.m_impactFraction ? 0 : 1;
+		if (expected.DidImpact())
+		{
+			SweptSphere3 const& sphere = spheres[sphereIndex];
+			++numImpacts;
+			numTunnels += doesEndOverlap(sphere.m_start + sphere.m_displacement, sphere.m_radius, expected.m_primitiveIndex) ? 0 : 1;
+		}
+	}
+
+	ENGINE_TEST_CHECK(numImpacts > numSpheres / 20 && numImpacts < numSpheres, Stringf("%s test scene has %d of %d spheres hitting, too few or too many to mean much",
+		primitiveName, numImpacts, numSpheres));
+	ENGINE_TEST_CHECK(numTunnels > 0, Stringf("No %s hit would be missed by an end of step overlap test, the scene does not test tunnelling", primitiveName));
+	ENGINE_TEST_CHECK(numBadImpacts == 0, Stringf("%d of %d %s impacts do not leave the sphere just touching the surface", numBadImpacts, numImpacts, primitiveName));
+	ENGINE_TEST_CHECK(numSerialMismatches == 0, Stringf("%s batch sweep disagrees with the single sweeps for %d of %d spheres", primitiveName, numSerialMismatches, numSpheres));
+	ENGINE_TEST_CHECK(numJobMismatches == 0, Stringf("%s batch sweep on the job system differs from the serial one for %d of %d spheres", primitiveName, numJobMismatches, numSpheres));
+
+	double numTests = static_cast<double>(numSpheres) * static_cast<double>(numPrimitives);
+	PrintEngineTestTiming(Stringf("%-5s single %7.2fms  batch %7.2fms  %5.2fx  (%.2fns per test)  job system %7.2fms  %d of %d impacts missed by an end of step test", primitiveName,
+		singleSeconds * 1000.0, serialSeconds * 1000.0, serialSeconds > 0.0 ? singleSeconds / serialSeconds : 0.0, serialSeconds * 1e9 / numTests, jobSeconds * 1000.0, numTunnels, numImpacts));
+}
+// -----------------------------------------------------------------------------
+void RunSweptCollisionTests()
+{
+#if defined( ENGINE_SIMD_SCALAR )
+	int numLanes = 1;
+#else
+	int numLanes = SIMD_WIDE_NUM_LANES;
+#endif
+	BeginEngineTestSection(Stringf("Swept collision, %d lane packets", numLanes).c_str());
+
+	TestSweeps2D();
+
+	RandomNumberGenerator rng(47);
+	std::vector<SweptSphere3> spheres(SWEPT_TEST_NUM_SPHERES);
+	for (int sphereIndex = 0; sphereIndex < SWEPT_TEST_NUM_SPHERES; ++sphereIndex)
+	{
+		// Projectiles covering several box widths per step, the case an end of step test lets tunnel
+		Vec3 start(rng.RollRandomFloatInRange(-60.f, 60.f), rng.RollRandomFloatInRange(-60.f, 60.f), rng.RollRandomFloatInRange(-60.f, 60.f));
+		Vec3 direction(rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f), rng.RollRandomFloatInRange(-1.f, 1.f));
+		spheres[sphereIndex] = SweptSphere3(start, direction.GetNormalized() * rng.RollRandomFloatInRange(5.f, 40.f), rng.RollRandomFloatInRange(0.05f, 0.5f));
+	}
+
+	std::vector<AABB3> boxes(SWEPT_TEST_NUM_BOXES);
+	std::vector<OBB3>  orientedBoxes(SWEPT_TEST_NUM_BOXES);
+	for (int boxIndex = 0; boxIndex < SWEPT_TEST_NUM_BOXES; ++boxIndex)
+	{
+		Vec3 center(rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f), rng.RollRandomFloatInRange(-50.f, 50.f));
+		Vec3 halfDimensions(rng.RollRandomFloatInRange(0.2f, 2.f), rng.RollRandomFloatInRange(0.2f, 2.f), rng.RollRandomFloatInRange(0.2f, 2.f));
+		boxes[boxIndex] = AABB3(center - halfDimensions, center + halfDimensions);
+
+		EulerAngles orientation(rng.RollRandomFloatInRange(0.f, 360.f), rng.RollRandomFloatInRange(-90.f, 90.f), rng.RollRandomFloatInRange(0.f, 360.f));
+		Vec3 iBasis;
+		Vec3 jBasis;
+		Vec3 kBasis;
+		orientation.GetAsVectors_IFwd_JLeft_KUp(iBasis, jBasis, kBasis);
+		orientedBoxes[boxIndex] = OBB3(center, iBasis, jBasis, kBasis, halfDimensions);
+	}
+
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	int numSpheres = SWEPT_TEST_NUM_SPHERES;
+	int numBoxes = SWEPT_TEST_NUM_BOXES;
+	TestSweptBatch("AABB3", spheres, numBoxes,
+		[&](SweptSphere3 const& sphere, int index) { return SweepSphereVsAABB3D(sphere.m_start, sphere.m_displacement, sphere.m_radius, boxes[index]); },
+		[&](SweptHit3D* out_hits, bool useJobSystem) { SweepSphereBatchVsAABB3Ds(numSpheres, spheres.data(), numBoxes, boxes.data(), out_hits, useJobSystem ? &jobSystem : nullptr); },
+		[&](Vec3 const& sphereCenter, float sphereRadius, int index) { return DoSpheresAndAABBOverlap3D(sphereCenter, sphereRadius, boxes[index]); });
+
+	TestSweptBatch("OBB3", spheres, numBoxes,
+		[&](SweptSphere3 const& sphere, int index) { return SweepSphereVsOBB3D(sphere.m_start, sphere.m_displacement, sphere.m_radius, orientedBoxes[index]); },
+		[&](SweptHit3D* out_hits, bool useJobSystem) { SweepSphereBatchVsOBB3Ds(numSpheres, spheres.data(), numBoxes, orientedBoxes.data(), out_hits, useJobSystem ? &jobSystem : nullptr); },
+		[&](Vec3 const& sphereCenter, float sphereRadius, int index) { return DoOBB3sAndSpheresOverlap3D(orientedBoxes[index], sphereCenter, sphereRadius); });
+
+	jobSystem.Shutdown();
+}
+// -----------------------------------------------------------------------------
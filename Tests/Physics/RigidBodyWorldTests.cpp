@@ -0,0 +1,191 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Physics/RigidBodyWorld3D.hpp"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int	RIGID_BODY_TEST_NUM_PILES = 16;
+constexpr int	RIGID_BODY_TEST_BODIES_PER_PILE = 64;
+constexpr int	RIGID_BODY_TEST_NUM_STEPS = 300;
+constexpr float RIGID_BODY_TEST_STEP_SECONDS = 1.f / 60.f;
+constexpr float RIGID_BODY_TEST_BOX_HALF_SIZE = 0.25f;
+// -----------------------------------------------------------------------------
+static RigidBody3DConfig MakeGroundConfig(float groundHalfSize)
+{
+	RigidBody3DConfig ground;
+	ground.m_shape = ConvexShape3D::MakeOBB3(OBB3(Vec3(0.f, 0.f, -0.5f), Vec3::XAXE, Vec3::YAXE, Vec3::ZAXE, Vec3(groundHalfSize, groundHalfSize, 0.5f)));
+	ground.m_mass = 0.f;
+	return ground;
+}
+
+// Built once and added to every run, so the serial and parallel runs start from the same bodies
+static std::vector<RigidBody3DConfig> MakeTestPiles(RandomNumberGenerator& rng)
+{
+	std::vector<RigidBody3DConfig> bodies;
+	int pilesPerRow = static_cast<int>(ceilf(sqrtf(static_cast<float>(RIGID_BODY_TEST_NUM_PILES))));
+	float pileSpacing = 4.f;
+	float pilesHalfWidth = 0.5f * pileSpacing * static_cast<float>(pilesPerRow);
+	bodies.push_back(MakeGroundConfig(pilesHalfWidth + pileSpacing));
+
+	// Layers of three by three boxes, slightly jittered so the piles are not perfect columns, with a sphere on top
+	float halfSize = RIGID_BODY_TEST_BOX_HALF_SIZE;
+	float cellSize = 2.f * halfSize + 0.02f;
+	int numBoxes = RIGID_BODY_TEST_BODIES_PER_PILE - 1;
+	for (int pileIndex = 0; pileIndex < RIGID_BODY_TEST_NUM_PILES; ++pileIndex)
+	{
+		Vec3 pileCenter((static_cast<float>(pileIndex % pilesPerRow) + 0.5f) * pileSpacing - pilesHalfWidth, (static_cast<float>(pileIndex / pilesPerRow) + 0.5f) * pileSpacing - pilesHalfWidth, halfSize + 0.01f);
+		for (int boxIndex = 0; boxIndex < numBoxes; ++boxIndex)
+		{
+			int column = boxIndex % 3;
+			int row = (boxIndex / 3) % 3;
+			int layer = boxIndex / 9;
+			Vec3 center = pileCenter + Vec3((static_cast<float>(column) - 1.f) * cellSize + rng.RollRandomFloatInRange(-0.02f, 0.02f), (static_cast<float>(row) - 1.f) * cellSize + rng.RollRandomFloatInRange(-0.02f, 0.02f), static_cast<float>(layer) * cellSize);
+			float yawRadians = rng.RollRandomFloatInRange(-0.2f, 0.2f);
+			RigidBody3DConfig box;
+			box.m_shape = ConvexShape3D::MakeOBB3(OBB3(center, Vec3(cosf(yawRadians), sinf(yawRadians), 0.f), Vec3(-sinf(yawRadians), cosf(yawRadians), 0.f), Vec3::ZAXE, Vec3(halfSize, halfSize, halfSize)));
+			bodies.push_back(box);
+		}
+		RigidBody3DConfig sphere;
+		sphere.m_shape = ConvexShape3D::MakeSphere(pileCenter + Vec3(0.f, 0.f, static_cast<float>((numBoxes + 8) / 9) * cellSize), halfSize);
+		bodies.push_back(sphere);
+	}
+	return bodies;
+}
+// -----------------------------------------------------------------------------
+// A lone box falls freely, lands and comes to rest face down on the ground
+static void TestSingleBody()
+{
+	RigidBodyWorld3DConfig config;
+	RigidBodyWorld3D world(config);
+	world.AddBody(MakeGroundConfig(10.f));
+	RigidBody3DConfig boxConfig;
+	float dropHeight = 3.f;
+	boxConfig.m_shape = ConvexShape3D::MakeOBB3(OBB3(Vec3(0.f, 0.f, dropHeight), Vec3::XAXE, Vec3::YAXE, Vec3::ZAXE, Vec3(0.5f, 0.5f, 0.5f)));
+	int boxHandle = world.AddBody(boxConfig);
+
+	// Gravity is added to the velocity before positions move, so after n steps the box has fallen g dt^2 n(n + 1) / 2
+	int numFreeSteps = 20;
+	for (int stepIndex = 0; stepIndex < numFreeSteps; ++stepIndex)
+	{
+		world.Step(RIGID_BODY_TEST_STEP_SECONDS);
+	}
+	float expectedDrop = -config.m_gravity.z * RIGID_BODY_TEST_STEP_SECONDS * RIGID_BODY_TEST_STEP_SECONDS * static_cast<float>(numFreeSteps * (numFreeSteps + 1) / 2);
+	float drop = dropHeight - world.GetBodyPosition(boxHandle).z;
+	ENGINE_TEST_CHECK(fabsf(drop - expectedDrop) < 1e-3f, Stringf("Falling box dropped %.4f in %d steps, expected %.4f", drop, numFreeSteps, expectedDrop));
+	ENGINE_TEST_CHECK(world.GetManifolds().empty(), "Falling box has a contact with the ground before reaching it");
+
+	for (int stepIndex = 0; stepIndex < 180; ++stepIndex)
+	{
+		world.Step(RIGID_BODY_TEST_STEP_SECONDS);
+	}
+	Vec3 const& restPosition = world.GetBodyPosition(boxHandle);
+	float restSpeed = world.GetBodyLinearVelocity(boxHandle).GetLength();
+	// The manifold gains its corners over the first steps of the landing, which may nudge the box sideways a little
+	ENGINE_TEST_CHECK(fabsf(restPosition.z - 0.5f) < 0.02f && fabsf(restPosition.x) < 0.1f && fabsf(restPosition.y) < 0.1f,
+		Stringf("Box came to rest at (%.4f, %.4f, %.4f), expected near (0, 0, 0.5)", restPosition.x, restPosition.y, restPosition.z));
+	ENGINE_TEST_CHECK(restSpeed < 0.01f, Stringf("Box still moves at %.4f after landing", restSpeed));
+	ENGINE_TEST_CHECK(world.GetNumIslands() == 1 && world.GetNumContactPoints() == 4, Stringf("Resting box has %d islands and %d contact points, expected 1 and 4",
+		world.GetNumIslands(), world.GetNumContactPoints()));
+
+	// Removed handles are only reused after the next step
+	world.RemoveBody(boxHandle);
+	int earlyHandle = world.AddBody(boxConfig);
+	world.Step(RIGID_BODY_TEST_STEP_SECONDS);
+	int reusedHandle = world.AddBody(boxConfig);
+	ENGINE_TEST_CHECK(earlyHandle != boxHandle && reusedHandle == boxHandle && world.GetNumBodies() == 3, Stringf("Handles after RemoveBody are %d then %d with %d bodies, expected a new one, %d and 3",
+		earlyHandle, reusedHandle, world.GetNumBodies(), boxHandle));
+	world.Clear();
+	ENGINE_TEST_CHECK(world.GetNumBodies() == 0 && world.GetManifolds().empty(), "Clear left bodies or manifolds behind");
+}
+
+// Box piles with a sphere on top, serial against the job system
+static void TestPiles(RandomNumberGenerator& rng)
+{
+	JobSystemConfig jobSystemConfig;
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	std::vector<RigidBody3DConfig> bodies = MakeTestPiles(rng);
+	double stepSecondsTaken[2] = { 0.0, 0.0 };
+	std::vector<Vec3> finalPositions[2];
+	std::vector<Quat> finalOrientations[2];
+	int numIslands = 0;
+	int numContactPoints = 0;
+	float largestFinalBoxSpeed = 0.f;
+	float lowestBodyBottom = FLT_MAX;
+	for (int runIndex = 0; runIndex < 2; ++runIndex)
+	{
+		RigidBodyWorld3DConfig config;
+		config.m_jobSystem = runIndex == 0 ? nullptr : &jobSystem;
+		RigidBodyWorld3D world(config);
+		for (RigidBody3DConfig const& body : bodies)
+		{
+			world.AddBody(body);
+		}
+		int numHandles = world.GetNumBodies();
+
+		double startTime = GetCurrentTimeSeconds();
+		for (int stepIndex = 0; stepIndex < RIGID_BODY_TEST_NUM_STEPS; ++stepIndex)
+		{
+			world.Step(RIGID_BODY_TEST_STEP_SECONDS);
+		}
+		stepSecondsTaken[runIndex] = (GetCurrentTimeSeconds() - startTime) / static_cast<double>(RIGID_BODY_TEST_NUM_STEPS);
+
+		for (int handle = 0; handle < numHandles; ++handle)
+		{
+			finalPositions[runIndex].push_back(world.GetBodyPosition(handle));
+			finalOrientations[runIndex].push_back(world.GetBodyOrientation(handle));
+		}
+		if (runIndex == 0)
+		{
+			numIslands = world.GetNumIslands();
+			numContactPoints = world.GetNumContactPoints();
+			for (int handle = 1; handle < numHandles; ++handle)
+			{
+				// The spheres roll off their piles and keep rolling, only the boxes should come to rest
+				if (world.GetBodyWorldShape(handle).m_type == ConvexShapeType3D::OBB)
+				{
+					largestFinalBoxSpeed = std::max(largestFinalBoxSpeed, world.GetBodyLinearVelocity(handle).GetLength());
+				}
+				lowestBodyBottom = std::min(lowestBodyBottom, world.GetBodyWorldShape(handle).GetSupportPoint(-Vec3::ZAXE).z);
+			}
+		}
+	}
+	jobSystem.Shutdown();
+
+	// Islands never share a dynamic body, so solving them in parallel must not change a single bit
+	int numMismatchedBodies = 0;
+	for (int handle = 0; handle < static_cast<int>(finalPositions[0].size()); ++handle)
+	{
+		Quat const& serialOrientation = finalOrientations[0][handle];
+		Quat const& jobOrientation = finalOrientations[1][handle];
+		bool areOrientationsEqual = serialOrientation.m_x == jobOrientation.m_x && serialOrientation.m_y == jobOrientation.m_y && serialOrientation.m_z == jobOrientation.m_z &&
+			serialOrientation.m_w == jobOrientation.m_w;
+		numMismatchedBodies += finalPositions[0][handle] == finalPositions[1][handle] && areOrientationsEqual ? 0 : 1;
+	}
+
+	int numBodies = static_cast<int>(bodies.size());
+	ENGINE_TEST_CHECK(numMismatchedBodies == 0, Stringf("%d of %d bodies differ between the serial and job system runs", numMismatchedBodies, numBodies));
+	ENGINE_TEST_CHECK(largestFinalBoxSpeed < 0.05f, Stringf("Piled boxes have not come to rest, the fastest still moves at %.4f", largestFinalBoxSpeed));
+	ENGINE_TEST_CHECK(lowestBodyBottom > -0.02f, Stringf("A body sank %.4f into the ground", -lowestBodyBottom));
+	ENGINE_TEST_CHECK(numIslands >= RIGID_BODY_TEST_NUM_PILES, Stringf("%d piles resting on static ground make only %d islands", RIGID_BODY_TEST_NUM_PILES, numIslands));
+	PrintEngineTestTiming(Stringf("%d piles of %d bodies, %d steps, %d islands, %d contact points", RIGID_BODY_TEST_NUM_PILES, RIGID_BODY_TEST_BODIES_PER_PILE, RIGID_BODY_TEST_NUM_STEPS,
+		numIslands, numContactPoints));
+	PrintEngineTestTiming(Stringf("Serial      %8.3fms per step", stepSecondsTaken[0] * 1000.0));
+	PrintEngineTestTiming(Stringf("Job system  %8.3fms per step", stepSecondsTaken[1] * 1000.0));
+}
+// -----------------------------------------------------------------------------
+void RunRigidBodyWorldTests()
+{
+	BeginEngineTestSection("RigidBodyWorld3D");
+
+	RandomNumberGenerator rng(46);
+	TestSingleBody();
+	TestPiles(rng);
+}
+// -----------------------------------------------------------------------------
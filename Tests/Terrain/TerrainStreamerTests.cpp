@@ -0,0 +1,319 @@
+#include "Engine/Tests/EngineTest.hpp"
+#include "Engine/Terrain/TerrainStreamer.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/RandomNumberGenerator.h"
+#include "Engine/Math/SmoothNoise.hpp"
+#include "Engine/Renderer/Camera.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int	TERRAIN_TEST_MAX_SETTLE_FRAMES = 100000;
+constexpr int	TERRAIN_TEST_NUM_FLIGHT_FRAMES = 300;
+constexpr float TERRAIN_TEST_METERS_PER_FRAME = 4.f;
+constexpr int	TERRAIN_TEST_NUM_JUMPS = 40;
+// -----------------------------------------------------------------------------
+static TerrainStreamerConfig MakeTerrainTestConfig(JobSystem* jobSystem)
+{
+	TerrainStreamerConfig config;
+	config.m_jobSystem = jobSystem;
+	config.m_loadRadius = 160.f;
+	config.m_unloadRadius = 200.f;
+	config.m_seed = 50;
+	return config;
+}
+
+static void MakeTerrainTestCamera(Camera& out_camera)
+{
+	out_camera.SetPerspectiveView(16.f / 9.f, 60.f, 0.1f, 1000.f);
+	out_camera.SetCameraToRenderTransform(Mat44(Vec3(0.f, 0.f, 1.f), Vec3(-1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3::ZERO));
+}
+
+// Updates until nothing is in flight and a frame loads nothing new, returns the number of frames or -1 if it never settles
+static int UpdateUntilSettled(TerrainStreamer& streamer, Camera const& camera)
+{
+	int numLoadedChunks = -1;
+	for (int frameIndex = 0; frameIndex < TERRAIN_TEST_MAX_SETTLE_FRAMES; ++frameIndex)
+	{
+		streamer.Update(camera);
+		TerrainStreamerStats stats = streamer.GetStats();
+		if (stats.m_numChunksInFlight == 0 && stats.m_numLoadedChunks == numLoadedChunks)
+		{
+			return frameIndex;
+		}
+		numLoadedChunks = stats.m_numLoadedChunks;
+	}
+	return -1;
+}
+
+static bool IsChunkCenterWithin(TerrainStreamer const& streamer, IntVec2 const& chunkCoords, Vec2 const& viewPosition, float radius)
+{
+	return GetDistanceSquared2D(streamer.GetChunkBoundsXY(chunkCoords).GetCenter(), viewPosition) <= radius * radius;
+}
+
+// Chunks missing within the load radius plus chunks kept beyond the unload radius
+static int CountMisplacedChunks(TerrainStreamer const& streamer, TerrainStreamerConfig const& config, Vec2 const& viewPosition)
+{
+	int numMisplaced = 0;
+	float loadRadius = config.m_loadRadius;
+	IntVec2 minCoords = streamer.GetChunkCoordsForPosition(viewPosition - Vec2(loadRadius, loadRadius));
+	IntVec2 maxCoords = streamer.GetChunkCoordsForPosition(viewPosition + Vec2(loadRadius, loadRadius));
+	for (int chunkY = minCoords.y; chunkY <= maxCoords.y; ++chunkY)
+	{
+		for (int chunkX = minCoords.x; chunkX <= maxCoords.x; ++chunkX)
+		{
+			IntVec2 chunkCoords(chunkX, chunkY);
+			if (IsChunkCenterWithin(streamer, chunkCoords, viewPosition, loadRadius) && streamer.GetChunk(chunkCoords) == nullptr)
+			{
+				++numMisplaced;
+			}
+		}
+	}
+
+	std::vector<TerrainChunk const*> loadedChunks;
+	streamer.GetLoadedChunks(loadedChunks);
+	for (TerrainChunk const* chunk : loadedChunks)
+	{
+		numMisplaced += IsChunkCenterWithin(streamer, chunk->m_coords, viewPosition, config.m_unloadRadius) ? 0 : 1;
+	}
+	return numMisplaced;
+}
+
+static bool AreTerrainVertsEqual(Vertex_PCUTBN const& vertA, Vertex_PCUTBN const& vertB)
+{
+	return vertA.m_position == vertB.m_position && vertA.m_normal == vertB.m_normal && vertA.m_tangent == vertB.m_tangent && vertA.m_bitangent == vertB.m_bitangent;
+}
+
+// Heights straight from Compute2dPerlinNoise, vertexes inside the chunk bounds, and the edges shared with the +x and +y
+// neighbours bit identical so there are no cracks or lighting seams
+static int CountBadChunkMeshes(TerrainStreamer const& streamer, TerrainStreamerConfig const& config, int* out_numSeamsChecked = nullptr)
+{
+	int numQuads = config.m_quadsPerChunkSide;
+	int numVertsPerSide = numQuads + 1;
+	int numBadMeshes = 0;
+	int numSeamsChecked = 0;
+	std::vector<TerrainChunk const*> loadedChunks;
+	streamer.GetLoadedChunks(loadedChunks);
+	for (TerrainChunk const* chunk : loadedChunks)
+	{
+		if (static_cast<int>(chunk->m_verts.size()) != numVertsPerSide * numVertsPerSide || chunk->m_numIndexes != numQuads * numQuads * 6)
+		{
+			++numBadMeshes;
+			continue;
+		}
+
+		bool isMeshValid = true;
+		AABB2 boundsXY = streamer.GetChunkBoundsXY(chunk->m_coords);
+		for (Vertex_PCUTBN const& vert : chunk->m_verts)
+		{
+			Vec3 const& position = vert.m_position;
+			float expectedHeight = config.m_baseHeight + config.m_heightScale * Compute2dPerlinNoise(position.x, position.y, config.m_noiseScale, config.m_numOctaves,
+				config.m_octavePersistence, config.m_octaveScale, true, config.m_seed);
+			isMeshValid = isMeshValid && position.z == expectedHeight && position.x >= boundsXY.m_mins.x && position.x <= boundsXY.m_maxs.x &&
+				position.y >= boundsXY.m_mins.y && position.y <= boundsXY.m_maxs.y && position.z >= chunk->m_bounds.m_mins.z && position.z <= chunk->m_bounds.m_maxs.z;
+		}
+
+		TerrainChunk const* eastChunk = streamer.GetChunk(IntVec2(chunk->m_coords.x + 1, chunk->m_coords.y));
+		TerrainChunk const* northChunk = streamer.GetChunk(IntVec2(chunk->m_coords.x, chunk->m_coords.y + 1));
+		for (int edgeIndex = 0; edgeIndex < numVertsPerSide; ++edgeIndex)
+		{
+			if (eastChunk != nullptr)
+			{
+				isMeshValid = isMeshValid && AreTerrainVertsEqual(chunk->m_verts[edgeIndex * numVertsPerSide + numQuads], eastChunk->m_verts[edgeIndex * numVertsPerSide]);
+			}
+			if (northChunk != nullptr)
+			{
+				isMeshValid = isMeshValid && AreTerrainVertsEqual(chunk->m_verts[numQuads * numVertsPerSide + edgeIndex], northChunk->m_verts[edgeIndex]);
+			}
+		}
+		numSeamsChecked += (eastChunk != nullptr ? 1 : 0) + (northChunk != nullptr ? 1 : 0);
+		numBadMeshes += isMeshValid ? 0 : 1;
+	}
+
+	if (out_numSeamsChecked != nullptr)
+	{
+		*out_numSeamsChecked = numSeamsChecked;
+	}
+	return numBadMeshes;
+}
+
+// Every chunk loaded by one streamer is loaded by the other with the same bounds and bit identical vertexes and indexes
+static int CountChunkMismatches(TerrainStreamer const& streamerA, TerrainStreamer const& streamerB)
+{
+	std::vector<TerrainChunk const*> chunksA;
+	std::vector<TerrainChunk const*> chunksB;
+	streamerA.GetLoadedChunks(chunksA);
+	streamerB.GetLoadedChunks(chunksB);
+	int numMismatches = chunksA.size() == chunksB.size() ? 0 : 1;
+	for (TerrainChunk const* chunkA : chunksA)
+	{
+		TerrainChunk const* chunkB = streamerB.GetChunk(chunkA->m_coords);
+		if (chunkB == nullptr || chunkA->m_verts.size() != chunkB->m_verts.size() || chunkA->m_indexes != chunkB->m_indexes ||
+			chunkA->m_bounds.m_mins != chunkB->m_bounds.m_mins || chunkA->m_bounds.m_maxs != chunkB->m_bounds.m_maxs)
+		{
+			++numMismatches;
+			continue;
+		}
+		for (size_t vertIndex = 0; vertIndex < chunkA->m_verts.size(); ++vertIndex)
+		{
+			if (!AreTerrainVertsEqual(chunkA->m_verts[vertIndex], chunkB->m_verts[vertIndex]))
+			{
+				++numMismatches;
+				break;
+			}
+		}
+	}
+	return numMismatches;
+}
+// -----------------------------------------------------------------------------
+// Fills around the camera, checks the chunks against the noise and each other, then against the same fill without the job system
+static void TestTerrainFill(JobSystem& jobSystem)
+{
+	Camera camera;
+	MakeTerrainTestCamera(camera);
+	camera.SetPositionAndOrientation(Vec3(0.f, 0.f, 60.f), EulerAngles(0.f, 20.f, 0.f));
+	Vec2 viewPosition(0.f, 0.f);
+
+	TerrainStreamerConfig config = MakeTerrainTestConfig(&jobSystem);
+	TerrainStreamer streamer(config);
+	double startTime = GetCurrentTimeSeconds();
+	int numFillFrames = UpdateUntilSettled(streamer, camera);
+	double fillSeconds = GetCurrentTimeSeconds() - startTime;
+	TerrainStreamerStats stats = streamer.GetStats();
+
+	int numSeamsChecked = 0;
+	int numBadMeshes = CountBadChunkMeshes(streamer, config, &numSeamsChecked);
+	int numMisplacedChunks = CountMisplacedChunks(streamer, config, viewPosition);
+	ENGINE_TEST_CHECK(numFillFrames >= 0, Stringf("Job system fill never settled in %d frames", TERRAIN_TEST_MAX_SETTLE_FRAMES));
+	ENGINE_TEST_CHECK(stats.m_numLoadedChunks > 0 && numSeamsChecked > 0, "Job system fill loaded no neighbouring chunks, the mesh checks mean nothing");
+	ENGINE_TEST_CHECK(numMisplacedChunks == 0, Stringf("%d chunks missing inside the load radius or kept outside the unload radius after the fill", numMisplacedChunks));
+	ENGINE_TEST_CHECK(numBadMeshes == 0, Stringf("%d of %d chunks have heights off the noise, vertexes outside their bounds or seams with their neighbours",
+		numBadMeshes, stats.m_numLoadedChunks));
+
+	// Without a job system each chunk is generated inside Update
+	TerrainStreamerConfig serialConfig = MakeTerrainTestConfig(nullptr);
+	TerrainStreamer serialStreamer(serialConfig);
+	startTime = GetCurrentTimeSeconds();
+	int numSerialFillFrames = UpdateUntilSettled(serialStreamer, camera);
+	double serialFillSeconds = GetCurrentTimeSeconds() - startTime;
+	int numChunkMismatches = CountChunkMismatches(streamer, serialStreamer);
+	ENGINE_TEST_CHECK(numSerialFillFrames >= 0, Stringf("Fill without a job system never settled in %d frames", TERRAIN_TEST_MAX_SETTLE_FRAMES));
+	ENGINE_TEST_CHECK(numChunkMismatches == 0, Stringf("%d chunks differ between the job system and the fill without one", numChunkMismatches));
+
+	// Frames are unpaced, so the job system fill's frame count only says how often Update polled
+	PrintEngineTestTiming(Stringf("Fill %d chunks of %dx%d quads  job system %8.2fms  without %8.2fms over %d frames", stats.m_numLoadedChunks,
+		config.m_quadsPerChunkSide, config.m_quadsPerChunkSide, fillSeconds * 1000.0, serialFillSeconds * 1000.0, numSerialFillFrames));
+}
+
+// Flies out and back, so the return trip comes from the noise tile cache, timing every Update
+static void TestTerrainFlight(JobSystem& jobSystem)
+{
+	Camera camera;
+	MakeTerrainTestCamera(camera);
+	camera.SetPositionAndOrientation(Vec3(0.f, 0.f, 60.f), EulerAngles(0.f, 20.f, 0.f));
+	TerrainStreamerConfig config = MakeTerrainTestConfig(&jobSystem);
+	TerrainStreamer streamer(config);
+	UpdateUntilSettled(streamer, camera);
+
+	double worstUpdateSeconds = 0.0;
+	double totalUpdateSeconds = 0.0;
+	for (int frameIndex = 0; frameIndex < TERRAIN_TEST_NUM_FLIGHT_FRAMES; ++frameIndex)
+	{
+		bool isFlyingBack = frameIndex >= TERRAIN_TEST_NUM_FLIGHT_FRAMES / 2;
+		float distance = TERRAIN_TEST_METERS_PER_FRAME * static_cast<float>(isFlyingBack ? TERRAIN_TEST_NUM_FLIGHT_FRAMES - frameIndex : frameIndex);
+		camera.SetPositionAndOrientation(Vec3(distance, 0.f, 60.f), EulerAngles(isFlyingBack ? 180.f : 0.f, 20.f, 0.f));
+
+		double startTime = GetCurrentTimeSeconds();
+		streamer.Update(camera);
+		double updateSeconds = GetCurrentTimeSeconds() - startTime;
+		worstUpdateSeconds = std::max(worstUpdateSeconds, updateSeconds);
+		totalUpdateSeconds += updateSeconds;
+	}
+
+	camera.SetPositionAndOrientation(Vec3(0.f, 0.f, 60.f), EulerAngles(0.f, 20.f, 0.f));
+	int numSettleFrames = UpdateUntilSettled(streamer, camera);
+	TerrainStreamerStats stats = streamer.GetStats();
+	int numMisplacedChunks = CountMisplacedChunks(streamer, config, Vec2(0.f, 0.f));
+	int numBadMeshes = CountBadChunkMeshes(streamer, config);
+	ENGINE_TEST_CHECK(numSettleFrames >= 0, Stringf("Terrain never settled in %d frames after the flight", TERRAIN_TEST_MAX_SETTLE_FRAMES));
+	ENGINE_TEST_CHECK(numMisplacedChunks == 0, Stringf("%d chunks missing inside the load radius or kept outside the unload radius after the flight", numMisplacedChunks));
+	ENGINE_TEST_CHECK(numBadMeshes == 0, Stringf("%d of %d chunks have bad meshes after the flight", numBadMeshes, stats.m_numLoadedChunks));
+	ENGINE_TEST_CHECK(stats.m_numNoiseTileHits > 0, "Flying back over unloaded chunks never used the noise tile cache");
+	ENGINE_TEST_CHECK(stats.m_numCachedNoiseTiles <= config.m_maxCachedNoiseTiles, Stringf("Noise tile cache holds %d tiles, over its limit of %d",
+		stats.m_numCachedNoiseTiles, config.m_maxCachedNoiseTiles));
+
+	PrintEngineTestTiming(Stringf("Flight at %.0fm per frame  Update %7.3fms per frame  worst %7.3fms  (budget %.3fms)", TERRAIN_TEST_METERS_PER_FRAME,
+		totalUpdateSeconds * 1000.0 / TERRAIN_TEST_NUM_FLIGHT_FRAMES, worstUpdateSeconds * 1000.0, config.m_maxUpdateSeconds * 1000.0));
+	PrintEngineTestTiming(Stringf("Noise tiles  %d hits  %d misses  %d cached  %d chunks cancelled", stats.m_numNoiseTileHits, stats.m_numNoiseTileMisses,
+		stats.m_numCachedNoiseTiles, stats.m_numCancelledChunks));
+}
+
+// Jumps around with chunks in flight, so chunks are left behind, cancelled and unloaded while workers still have them
+static void TestTerrainJumps(JobSystem& jobSystem, RandomNumberGenerator& rng)
+{
+	Camera camera;
+	MakeTerrainTestCamera(camera);
+	TerrainStreamerConfig config = MakeTerrainTestConfig(&jobSystem);
+	config.m_maxCachedNoiseTiles = 20;
+	Vec2 viewPosition;
+	{
+		TerrainStreamer streamer(config);
+		for (int jumpIndex = 0; jumpIndex < TERRAIN_TEST_NUM_JUMPS; ++jumpIndex)
+		{
+			viewPosition = Vec2(rng.RollRandomFloatInRange(-1000.f, 1000.f), rng.RollRandomFloatInRange(-1000.f, 1000.f));
+			camera.SetPositionAndOrientation(Vec3(viewPosition.x, viewPosition.y, 50.f), EulerAngles(rng.RollRandomFloatInRange(0.f, 360.f), 10.f, 0.f));
+			for (int frameIndex = rng.RollRandomIntInRange(1, 20); frameIndex > 0; --frameIndex)
+			{
+				streamer.Update(camera);
+			}
+		}
+
+		int numSettleFrames = UpdateUntilSettled(streamer, camera);
+		TerrainStreamerStats stats = streamer.GetStats();
+		int numMisplacedChunks = CountMisplacedChunks(streamer, config, viewPosition);
+		int numBadMeshes = CountBadChunkMeshes(streamer, config);
+		ENGINE_TEST_CHECK(numSettleFrames >= 0, Stringf("Terrain never settled in %d frames after the jumps", TERRAIN_TEST_MAX_SETTLE_FRAMES));
+		ENGINE_TEST_CHECK(numMisplacedChunks == 0, Stringf("%d chunks missing inside the load radius or kept outside the unload radius after the jumps", numMisplacedChunks));
+		ENGINE_TEST_CHECK(numBadMeshes == 0, Stringf("%d of %d chunks have bad meshes after the jumps", numBadMeshes, stats.m_numLoadedChunks));
+		ENGINE_TEST_CHECK(stats.m_numCachedNoiseTiles <= config.m_maxCachedNoiseTiles, Stringf("Noise tile cache holds %d tiles, over its limit of %d",
+			stats.m_numCachedNoiseTiles, config.m_maxCachedNoiseTiles));
+
+		// Unload with chunks still in flight
+		camera.SetPosition(Vec3(viewPosition.x + 5000.f, viewPosition.y, 50.f));
+		streamer.Update(camera);
+		int numChunksInFlight = streamer.GetStats().m_numChunksInFlight;
+		streamer.UnloadAllChunks();
+		std::vector<TerrainChunk const*> loadedChunks;
+		streamer.GetLoadedChunks(loadedChunks);
+		stats = streamer.GetStats();
+		ENGINE_TEST_CHECK(numChunksInFlight > 0, "No chunks were in flight to unload, the unload check means nothing");
+		ENGINE_TEST_CHECK(loadedChunks.empty() && stats.m_numLoadedChunks == 0 && stats.m_numChunksInFlight == 0,
+			Stringf("UnloadAllChunks left %d chunks loaded and %d in flight", stats.m_numLoadedChunks, stats.m_numChunksInFlight));
+
+		// Destroyed with chunks still in flight, which it has to wait for or cancel
+		streamer.Update(camera);
+	}
+}
+// -----------------------------------------------------------------------------
+void RunTerrainStreamerTests()
+{
+	BeginEngineTestSection("TerrainStreamer");
+
+	// Chunk jobs are only ever run by the workers, so there has to be at least one
+	JobSystemConfig jobSystemConfig;
+	jobSystemConfig.m_numJobWorkers = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+	JobSystem jobSystem(jobSystemConfig);
+	jobSystem.StartUp();
+
+	RandomNumberGenerator rng(50);
+	TestTerrainFill(jobSystem);
+	TestTerrainFlight(jobSystem);
+	TestTerrainJumps(jobSystem, rng);
+
+	jobSystem.Shutdown();
+}
+// -----------------------------------------------------------------------------